@@ -0,0 +1,317 @@
+/*
+ * CalmaOutput.c --
+ *
+ * Buffered output stream for Calma GDS-II stream format.
+ * CalmaWrite.c builds records in the stream's memory buffer;  the
+ * routines here pass the buffer on to a plain file, to a zlib stream,
+ * or, for parallel compression, to a file of independent gzip members
+ * compressed by a pool of threads.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "utils/magic.h"
+#include "utils/malloc.h"
+#include "utils/geometry.h"
+#include "tiles/tile.h"
+#include "utils/hash.h"
+#include "database/database.h"
+#include "utils/workers.h"
+#include "calma/calmaInt.h"
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaStreamInit --
+ *
+ * Set up a stream for writing GDS-II output to 'sink'.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Allocates the stream's buffer.  calmaStreamClose() must be called
+ *	when output is complete.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaStreamInit(
+    CalmaStream *cs,	/* Stream to set up */
+    int kind,		/* CALMA_STREAM_FILE, _GZIP or _PGZIP */
+    ClientData sink,	/* FILE * or gzFile, according to kind */
+    int level,		/* Compression level, for CALMA_STREAM_PGZIP */
+    int nthreads)	/* Threads to use, for CALMA_STREAM_PGZIP */
+{
+    size_t size;
+    int i;
+
+    cs->cs_kind = kind;
+    cs->cs_sink = sink;
+    cs->cs_error = FALSE;
+    cs->cs_level = level;
+    cs->cs_threads = WorkerCount(nthreads);
+    cs->cs_nblocks = 0;
+    cs->cs_blocks = (CalmaBlock *)NULL;
+
+#ifdef HAVE_ZLIB
+    if (kind == CALMA_STREAM_PGZIP)
+    {
+	/* Two blocks per thread, so that each thread has work even	*/
+	/* when blocks compress at different speeds.			*/
+
+	cs->cs_nblocks = 2 * cs->cs_threads;
+	cs->cs_blocks = (CalmaBlock *)mallocMagic(cs->cs_nblocks
+		* sizeof(CalmaBlock));
+	for (i = 0; i < cs->cs_nblocks; i++)
+	{
+	    /* Room for a block that does not compress, plus the	*/
+	    /* gzip header and trailer.					*/
+	    cs->cs_blocks[i].cb_size = compressBound(CALMA_STREAM_BLOCKSIZE) + 32;
+	    cs->cs_blocks[i].cb_out = (unsigned char *)mallocMagic(
+			cs->cs_blocks[i].cb_size);
+	}
+	size = (size_t)cs->cs_nblocks * CALMA_STREAM_BLOCKSIZE;
+    }
+    else
+#endif
+	size = CALMA_STREAM_BUFSIZE;
+
+    cs->cs_buf = (unsigned char *)mallocMagic(size);
+    cs->cs_ptr = cs->cs_buf;
+    cs->cs_end = cs->cs_buf + size;
+}
+
+#ifdef HAVE_ZLIB
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaStreamDeflate --
+ *
+ * Job procedure for WorkerRun():  compress one block of the stream
+ * buffer into a complete gzip member.  Because each member stands on
+ * its own, the members can be compressed in any order and simply
+ * written one after another;  gzip and zlib read such a file as one
+ * stream.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in cb_out, cb_len and cb_ok of the block.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaStreamDeflate(
+    int job,		/* Index of the block */
+    ClientData cdata)	/* The CalmaStream */
+{
+    CalmaStream *cs = (CalmaStream *)cdata;
+    CalmaBlock *cb = &cs->cs_blocks[job];
+    z_stream zs;
+
+    cb->cb_ok = FALSE;
+    cb->cb_len = 0;
+
+    bzero((char *)&zs, sizeof(zs));
+    /* Window bits 15 + 16 requests a gzip header and trailer */
+    if (deflateInit2(&zs, cs->cs_level, Z_DEFLATED, 15 + 16, 8,
+		Z_DEFAULT_STRATEGY) != Z_OK)
+	return;
+
+    zs.next_in = cb->cb_in;
+    zs.avail_in = (uInt)cb->cb_inlen;
+    zs.next_out = cb->cb_out;
+    zs.avail_out = (uInt)cb->cb_size;
+    if (deflate(&zs, Z_FINISH) == Z_STREAM_END)
+    {
+	cb->cb_len = cb->cb_size - zs.avail_out;
+	cb->cb_ok = TRUE;
+    }
+    deflateEnd(&zs);
+}
+
+#endif	/* HAVE_ZLIB */
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaStreamFlush --
+ *
+ * Pass the contents of the stream buffer on to the sink, and empty
+ * the buffer.  For CALMA_STREAM_PGZIP, the buffer is cut into blocks
+ * of CALMA_STREAM_BLOCKSIZE bytes, which are compressed concurrently
+ * and then written in order.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the sink.  Sets cs_error if the write fails, in which
+ *	case the buffer is emptied anyway.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaStreamFlush(
+    CalmaStream *cs)
+{
+    size_t n = cs->cs_ptr - cs->cs_buf;
+
+    cs->cs_ptr = cs->cs_buf;
+    if (n == 0) return;
+
+    switch (cs->cs_kind)
+    {
+	case CALMA_STREAM_FILE:
+	    if (fwrite(cs->cs_buf, 1, n, (FILE *)cs->cs_sink) != n)
+		cs->cs_error = TRUE;
+	    break;
+
+#ifdef HAVE_ZLIB
+	case CALMA_STREAM_GZIP:
+	    if (gzwrite((gzFile)cs->cs_sink, cs->cs_buf, (unsigned)n) != (int)n)
+		cs->cs_error = TRUE;
+	    break;
+
+	case CALMA_STREAM_PGZIP:
+	{
+	    CalmaBlock *cb;
+	    int i, nblocks;
+
+	    nblocks = (n + CALMA_STREAM_BLOCKSIZE - 1) / CALMA_STREAM_BLOCKSIZE;
+	    for (i = 0; i < nblocks; i++)
+	    {
+		cb = &cs->cs_blocks[i];
+		cb->cb_in = cs->cs_buf + (size_t)i * CALMA_STREAM_BLOCKSIZE;
+		cb->cb_inlen = MIN(n - (size_t)i * CALMA_STREAM_BLOCKSIZE,
+			CALMA_STREAM_BLOCKSIZE);
+	    }
+	    WorkerRun(cs->cs_threads, nblocks, calmaStreamDeflate,
+			(ClientData)cs);
+	    for (i = 0; i < nblocks; i++)
+	    {
+		cb = &cs->cs_blocks[i];
+		if (!cb->cb_ok || (fwrite(cb->cb_out, 1, cb->cb_len,
+			(FILE *)cs->cs_sink) != cb->cb_len))
+		    cs->cs_error = TRUE;
+	    }
+	    break;
+	}
+#endif
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaStreamWrite --
+ *
+ * Output 'n' bytes from 'data', like fwrite().
+ *
+ * Results:
+ *	Number of bytes written, which is always 'n';  write failures
+ *	are reported by calmaStreamClose().
+ *
+ * Side effects:
+ *	Copies data into the stream buffer, flushing it as it fills.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+size_t
+calmaStreamWrite(
+    CalmaStream *cs,
+    const char *data,
+    size_t n)
+{
+    size_t left = n, room;
+
+    while (left > 0)
+    {
+	if (cs->cs_ptr == cs->cs_end) calmaStreamFlush(cs);
+	room = MIN(left, (size_t)(cs->cs_end - cs->cs_ptr));
+	memcpy(cs->cs_ptr, data, room);
+	cs->cs_ptr += room;
+	data += room;
+	left -= room;
+    }
+    return n;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaStreamClose --
+ *
+ * Flush any output remaining in the stream and free its buffer.
+ * The sink itself is flushed but not closed.
+ *
+ * Results:
+ *	TRUE if all output was written successfully, FALSE otherwise.
+ *
+ * Side effects:
+ *	Writes to the sink;  frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaStreamClose(
+    CalmaStream *cs)
+{
+    int i;
+
+    calmaStreamFlush(cs);
+    switch (cs->cs_kind)
+    {
+	case CALMA_STREAM_FILE:
+#ifdef HAVE_ZLIB
+	case CALMA_STREAM_PGZIP:
+#endif
+	    fflush((FILE *)cs->cs_sink);
+	    if (ferror((FILE *)cs->cs_sink)) cs->cs_error = TRUE;
+	    break;
+
+#ifdef HAVE_ZLIB
+	case CALMA_STREAM_GZIP:
+	{
+	    int nerr;
+
+	    gzflush((gzFile)cs->cs_sink, Z_SYNC_FLUSH);
+	    gzerror((gzFile)cs->cs_sink, &nerr);
+	    if (nerr != 0) cs->cs_error = TRUE;
+	    break;
+	}
+#endif
+    }
+
+    for (i = 0; i < cs->cs_nblocks; i++)
+	freeMagic((char *)cs->cs_blocks[i].cb_out);
+    if (cs->cs_blocks != NULL) freeMagic((char *)cs->cs_blocks);
+    freeMagic((char *)cs->cs_buf);
+    cs->cs_buf = cs->cs_ptr = cs->cs_end = (unsigned char *)NULL;
+    cs->cs_blocks = (CalmaBlock *)NULL;
+    cs->cs_nblocks = 0;
+
+    return !cs->cs_error;
+}
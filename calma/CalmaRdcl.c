@@ -22,6 +22,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #endif  /* not lint */
 
 #include <stdio.h>
+#include <stdlib.h>		/* for qsort() */
 #include <string.h>
 #include <sys/types.h>
 #include <netinet/in.h>
@@ -63,6 +64,8 @@ extern int CalmaPolygonCount;
 int calmaElementSref(char *filename);
 bool calmaParseElement(char *filename, int *pnsrefs, int *pnpaths);
 void calmaUniqueCell(char *sname);
+void calmaFlattenArray(Plane **gdsplanes, Transform *trans, int cols, int rows,
+	int xsep, int ysep);
 
 /* Structure used when flattening the GDS hierarchy on read-in */
 
@@ -71,6 +74,25 @@ typedef struct {
     Transform *trans;
 } GDSCopyRec;
 
+/*
+ * Structure used to flatten an array of a cell on read-in:  one
+ * rectangle of the cell as placed at the origin of the array, and
+ * the number of copies of it to paint along x and y.  A rectangle
+ * whose copies abut or overlap is painted once, stretched over the
+ * whole array.
+ */
+
+typedef struct {
+    Rect	gs_rect;	/* Area of the copy at the array origin */
+    TileType	gs_type;	/* Type, including any diagonal bits */
+    int		gs_nx;		/* Number of copies along x */
+    int		gs_ny;		/* Number of copies along y */
+} GDSStampRec;
+
+static GDSStampRec *gdsStampList = NULL;
+static int gdsStampCount = 0;
+static int gdsStampSize = 0;
+
 /* Added by NP 8/11/04 */
 
 /*
@@ -106,9 +128,9 @@ calmaSetPosition(
     int strRecSize = 0;
     bool found = FALSE;
 
-    originalPos = FTELL(calmaInputFile);
+    originalPos = calmaInTell();
 
-    while (FEOF(calmaInputFile) == 0)
+    while (calmaEOF() == 0)
     {
         do
         {
@@ -118,7 +140,7 @@ calmaSetPosition(
              /* Skip no of bytes in record header until
               * we reach to next structure record.
               */
-             FSEEK(calmaInputFile, nbytes - CALMAHEADERLENGTH, SEEK_CUR);
+             calmaInSeek(nbytes - CALMAHEADERLENGTH, SEEK_CUR);
         } while (rtype != CALMA_BGNSTR);
         if (nbytes <= 0) break;
 
@@ -131,7 +153,7 @@ calmaSetPosition(
               */
              strRecSize = strlen(strname);
              if (strRecSize & 01) strRecSize++;
-             FSEEK(calmaInputFile, -(nbytes + strRecSize + CALMAHEADERLENGTH),
+             calmaInSeek(-(nbytes + strRecSize + CALMAHEADERLENGTH),
 				SEEK_CUR);
 	     freeMagic(strname);
 	     return originalPos;
@@ -147,7 +169,7 @@ calmaSetPosition(
 
     if (originalPos != 0)
     {
-	REWIND(calmaInputFile);
+	(void) calmaInSeek((OFFTYPE)0, SEEK_SET);
 	CalmaRewound = TRUE;
 	calmaSetPosition(sname);
 	if (!CalmaPostOrder)
@@ -193,7 +215,7 @@ calmaNextCell(void)
 {
     int nbytes, rtype;
 
-    if (FEOF(calmaInputFile) == 0)
+    if (calmaEOF() == 0)
     {
         do
         {
@@ -204,17 +226,17 @@ calmaNextCell(void)
 		 * try to set the file pointer somewhere sane, but
 		 * it will likely dump an error later on.
 		 */
-                FSEEK(calmaInputFile, -(CALMAHEADERLENGTH), SEEK_END);
+                calmaInSeek(-(CALMAHEADERLENGTH), SEEK_END);
                 return;
              }
 
              /* Skip no. of bytes in record header to reach the next
 	      * structure record.
               */
-             FSEEK(calmaInputFile, nbytes - CALMAHEADERLENGTH, SEEK_CUR);
+             calmaInSeek(nbytes - CALMAHEADERLENGTH, SEEK_CUR);
         } while((rtype != CALMA_BGNSTR) && (rtype != CALMA_ENDLIB));
 
-	FSEEK(calmaInputFile, -nbytes, SEEK_CUR);
+	calmaInSeek(-nbytes, SEEK_CUR);
     }
 }
 
@@ -384,7 +406,7 @@ calmaParseStructure(
     TxPrintf("Reading \"%s\".\n", strname);
 
     /* Used for read-only and annotated LEF views */
-    filepos = FTELL(calmaInputFile);
+    filepos = calmaInTell();
 
     /* Set up the cell definition */
     he = HashFind(&calmaDefInitHash, strname);
@@ -519,7 +541,7 @@ calmaParseStructure(
 	proprec->prop_value.prop_double[0] = filepos;
 	DBPropPut(cifReadCellDef, "GDS_START", (ClientData)proprec);
 
-	filepos = FTELL(calmaInputFile);
+	filepos = calmaInTell();
 
 	proprec = (PropertyRecord *)mallocMagic(dlongPropertyRecordSize(1));
 	proprec->prop_type = PROPERTY_TYPE_DOUBLE;
@@ -620,6 +642,43 @@ calmaParseStructure(
 	CIFPaintCurrent(FILE_CALMA);
     }
 
+    calmaFinishStructure(locPolygonCount);
+
+done:
+    HashKill(&calmaLayerHash);
+    return (TRUE);
+
+    /* Syntax error: skip to CALMA_ENDSTR */
+syntaxerror:
+    if (was_initialized == TRUE) HashKill(&calmaLayerHash);
+    return (calmaSkipTo(CALMA_ENDSTR));
+}
+
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaFinishStructure --
+ *
+ * Final processing of a cell read by calmaParseStructure() or by the
+ * OASIS reader, after its paint has been put back into the database:
+ * clean up labels, flatten temporary polygon subcells made since
+ * "locPolygonCount", and register the cell with the DRC and the
+ * display.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Modifies cifReadCellDef and marks it as processed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaFinishStructure(
+    int locPolygonCount)	/* CalmaPolygonCount at start of the cell */
+{
     /* Check for empty string labels that are caused by pin geometry that
      * did not get any corresponding text type, and remove them.
      */
@@ -659,18 +718,8 @@ calmaParseStructure(
      */
     DBGenerateUniqueIds(cifReadCellDef, FALSE);
     cifReadCellDef->cd_flags |= CDPROCESSEDGDS;
-
-done:
-    HashKill(&calmaLayerHash);
-    return (TRUE);
-
-    /* Syntax error: skip to CALMA_ENDSTR */
-syntaxerror:
-    if (was_initialized == TRUE) HashKill(&calmaLayerHash);
-    return (calmaSkipTo(CALMA_ENDSTR));
 }
 
-
 /*
  * ----------------------------------------------------------------------------
  *
@@ -868,7 +917,7 @@ calmaElementSref(
 	 */
 
 	OFFTYPE originalFilePos = calmaSetPosition(sname);
-	if (!FEOF(calmaInputFile))
+	if (!calmaEOF())
 	{
 	    HashTable OrigCalmaLayerHash;
 	    int crsMultiplier = cifCurReadStyle->crs_multiplier;
@@ -882,7 +931,7 @@ calmaElementSref(
 	    calmaParseStructure(filename);
 
 	    /* Put things back to the way they were. */
-	    FSEEK(calmaInputFile, originalFilePos, SEEK_SET);
+	    calmaInSeek(originalFilePos, SEEK_SET);
 	    cifReadCellDef = calmaLookCell(currentSname);
 	    def = calmaLookCell(sname);
 	    def->cd_flags |= CDPRELOADED;
@@ -908,7 +957,7 @@ calmaElementSref(
 	{
 	    /* This is redundant messaging */
 	    // TxPrintf("Cell definition %s does not exist!\n", sname);
-	    FSEEK(calmaInputFile, originalFilePos, SEEK_SET);
+	    calmaInSeek(originalFilePos, SEEK_SET);
 	    def = calmaFindCell(sname, NULL, NULL);
 	    /* Cell flags set to "dereferenced" in case there is no	*/
 	    /* definition in the GDS file.  If there is a definition	*/
@@ -946,7 +995,7 @@ calmaElementSref(
 	READI2(rows);
 	xlo = 0; xhi = cols - 1;
 	ylo = 0; yhi = rows - 1;
-	if (FEOF(calmaInputFile)) return -1;
+	if (calmaEOF()) return -1;
 	(void) calmaSkipBytes(nbytes - CALMAHEADERLENGTH - 4);
     }
     else
@@ -1046,7 +1095,7 @@ calmaElementSref(
 	    }
 	}
 
-	if (FEOF(calmaInputFile))
+	if (calmaEOF())
 	    return -1;
     }
 
@@ -1235,34 +1284,19 @@ calmaElementSref(
 	    // Mark cell as flattened (at least once)
 	    def->cd_flags |= CDFLATTENED;
 
-	    for (pNum = 0; pNum < MAXCIFRLAYERS; pNum++)
+	    if (def->cd_client == (ClientData)0)
+		break;		/* Nothing to copy */
+	    else if (isArray)
+		calmaFlattenArray(gdsplanes, &trans, cols, rows, xsep, ysep);
+	    else
 	    {
-		if ((def->cd_client != (ClientData)0) && (gdsplanes[pNum] != NULL))
+		for (pNum = 0; pNum < MAXCIFRLAYERS; pNum++)
 		{
+		    if (gdsplanes[pNum] == NULL) continue;
 		    gdsCopyRec.plane = cifCurReadPlanes[pNum];
-		    if (isArray)
-		    {
-			Transform artrans;
-			int x, y;
-
-			gdsCopyRec.trans = &artrans;
-
-			for (x = 0; x < cols; x++)
-			    for (y = 0; y < rows; y++)
-			    {
-				GeoTransTranslate((x * xsep), (y * ysep), &trans,
-					&artrans);
-				DBSrPaintArea((Tile *)NULL, gdsplanes[pNum],
-					&TiPlaneRect, &DBAllButSpaceBits,
-					gdsCopyPaintFunc, &gdsCopyRec);
-			    }
-		    }
-		    else
-		    {
-			gdsCopyRec.trans = &trans;
-			DBSrPaintArea((Tile *)NULL, gdsplanes[pNum], &TiPlaneRect,
+		    gdsCopyRec.trans = &trans;
+		    DBSrPaintArea((Tile *)NULL, gdsplanes[pNum], &TiPlaneRect,
 				&DBAllButSpaceBits, gdsCopyPaintFunc, &gdsCopyRec);
-		    }
 		}
 	    }
 	}
@@ -1379,6 +1413,284 @@ gdsCopyPaintFunc(
     return 0;
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * gdsStampCollectFunc --
+ *
+ * Callback function for calmaFlattenArray():  add a tile of a cell's
+ * saved CIF plane, transformed into the cell being read, to the
+ * template of rectangles in gdsStampList.
+ *
+ * Results:
+ *	Always 0 to keep the search going.
+ *
+ * Side effects:
+ *	Adds to gdsStampList, enlarging it if needed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+gdsStampCollectFunc(
+    Tile *tile,
+    TileType dinfo,
+    Transform *trans)
+{
+    GDSStampRec *gs, *newlist;
+    Rect sourceRect;
+
+    if (gdsStampCount == gdsStampSize)
+    {
+	gdsStampSize = (gdsStampSize == 0) ? 64 : gdsStampSize * 2;
+	newlist = (GDSStampRec *)mallocMagic(gdsStampSize * sizeof(GDSStampRec));
+	if (gdsStampCount > 0)
+	    memcpy(newlist, gdsStampList, gdsStampCount * sizeof(GDSStampRec));
+	if (gdsStampList != NULL) freeMagic(gdsStampList);
+	gdsStampList = newlist;
+    }
+    gs = &gdsStampList[gdsStampCount++];
+
+    TiToRect(tile, &sourceRect);
+    GeoTransRect(trans, &sourceRect, &gs->gs_rect);
+    gs->gs_type = TiGetTypeExact(tile) | dinfo;
+    if (IsSplit(tile))
+	gs->gs_type = DBTransformDiagonal(gs->gs_type, trans);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * gdsStampCompareRows --
+ * gdsStampCompareCols --
+ *
+ * Compare two template rectangles for qsort(), ordering them so that
+ * rectangles of the same type that may be merged sideways (Rows) or
+ * upward (Cols) are next to each other.
+ *
+ * Results:
+ *	Negative, zero or positive, as for qsort().
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+gdsStampCompareRows(
+    const void *one,
+    const void *two)
+{
+    GDSStampRec *g1 = (GDSStampRec *)one;
+    GDSStampRec *g2 = (GDSStampRec *)two;
+
+    if (g1->gs_type != g2->gs_type) return (g1->gs_type < g2->gs_type) ? -1 : 1;
+    if (g1->gs_rect.r_ybot != g2->gs_rect.r_ybot)
+	return (g1->gs_rect.r_ybot < g2->gs_rect.r_ybot) ? -1 : 1;
+    if (g1->gs_rect.r_ytop != g2->gs_rect.r_ytop)
+	return (g1->gs_rect.r_ytop < g2->gs_rect.r_ytop) ? -1 : 1;
+    if (g1->gs_rect.r_xbot != g2->gs_rect.r_xbot)
+	return (g1->gs_rect.r_xbot < g2->gs_rect.r_xbot) ? -1 : 1;
+    return 0;
+}
+
+int
+gdsStampCompareCols(
+    const void *one,
+    const void *two)
+{
+    GDSStampRec *g1 = (GDSStampRec *)one;
+    GDSStampRec *g2 = (GDSStampRec *)two;
+
+    if (g1->gs_type != g2->gs_type) return (g1->gs_type < g2->gs_type) ? -1 : 1;
+    if (g1->gs_rect.r_xbot != g2->gs_rect.r_xbot)
+	return (g1->gs_rect.r_xbot < g2->gs_rect.r_xbot) ? -1 : 1;
+    if (g1->gs_rect.r_xtop != g2->gs_rect.r_xtop)
+	return (g1->gs_rect.r_xtop < g2->gs_rect.r_xtop) ? -1 : 1;
+    if (g1->gs_rect.r_ybot != g2->gs_rect.r_ybot)
+	return (g1->gs_rect.r_ybot < g2->gs_rect.r_ybot) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaStampMerge --
+ *
+ * Merge the rectangles of the template in gdsStampList that have the
+ * same type and abut or overlap, either sideways with the same bottom
+ * and top ('sideways' TRUE) or upward with the same left and right.
+ * Split (non-Manhattan) tiles are left alone.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sorts and shortens gdsStampList.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaStampMerge(
+    bool sideways)
+{
+    GDSStampRec *gs, *last;
+    int i, n;
+
+    if (gdsStampCount < 2) return;
+    qsort(gdsStampList, gdsStampCount, sizeof(GDSStampRec),
+		sideways ? gdsStampCompareRows : gdsStampCompareCols);
+
+    n = 1;
+    for (i = 1; i < gdsStampCount; i++)
+    {
+	gs = &gdsStampList[i];
+	last = &gdsStampList[n - 1];
+	if ((gs->gs_type == last->gs_type) && !(gs->gs_type & TT_DIAGONAL))
+	{
+	    if (sideways && (gs->gs_rect.r_ybot == last->gs_rect.r_ybot)
+			&& (gs->gs_rect.r_ytop == last->gs_rect.r_ytop)
+			&& (gs->gs_rect.r_xbot <= last->gs_rect.r_xtop))
+	    {
+		if (gs->gs_rect.r_xtop > last->gs_rect.r_xtop)
+		    last->gs_rect.r_xtop = gs->gs_rect.r_xtop;
+		continue;
+	    }
+	    if (!sideways && (gs->gs_rect.r_xbot == last->gs_rect.r_xbot)
+			&& (gs->gs_rect.r_xtop == last->gs_rect.r_xtop)
+			&& (gs->gs_rect.r_ybot <= last->gs_rect.r_ytop))
+	    {
+		if (gs->gs_rect.r_ytop > last->gs_rect.r_ytop)
+		    last->gs_rect.r_ytop = gs->gs_rect.r_ytop;
+		continue;
+	    }
+	}
+	gdsStampList[n++] = *gs;
+    }
+    gdsStampCount = n;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaFlattenArray --
+ *
+ * Paint all elements of an array of a flattened cell (one marked
+ * CDFLATGDS) into the CIF planes of the cell being read.  Rather than
+ * searching the cell's saved planes and painting each tile once per
+ * array element, each plane is turned once into a template of merged
+ * rectangles, placed at the array origin in the coordinates of the
+ * cell being read.  A rectangle of the template that is at least as
+ * wide (or tall) as the array spacing meets its neighbor copies, so
+ * it is stretched to cover the whole row (or column) and painted only
+ * once.  The other rectangles are painted at each element by offset,
+ * one row of the array after another.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Paints into cifCurReadPlanes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaFlattenArray(
+    Plane **gdsplanes,		/* Saved CIF planes of the arrayed cell */
+    Transform *trans,		/* Transform of the element at (0, 0) */
+    int cols, int rows,		/* Number of array elements */
+    int xsep, int ysep)		/* Spacing of elements, in the arrayed cell */
+{
+    GDSStampRec *gs;
+    Transform origin;
+    Rect r;
+    int pNum, i, x, y, nx, ny, dx, dy, xoff, yoff;
+
+    /*
+     * Find the spacing of the array in the cell being read.  The
+     * columns of the array run along x or, when rotated, along y.
+     */
+
+    if (trans->t_a != 0)
+    {
+	dx = trans->t_a * xsep;
+	dy = trans->t_e * ysep;
+	nx = cols;
+	ny = rows;
+    }
+    else
+    {
+	dx = trans->t_b * ysep;
+	dy = trans->t_d * xsep;
+	nx = rows;
+	ny = cols;
+    }
+    if (dx == 0) nx = 1;
+    if (dy == 0) ny = 1;
+
+    /* Start from the lower left element so that spacings are positive */
+
+    xoff = yoff = 0;
+    if (dx < 0)
+    {
+	dx = -dx;
+	xoff = -(nx - 1) * dx;
+    }
+    if (dy < 0)
+    {
+	dy = -dy;
+	yoff = -(ny - 1) * dy;
+    }
+    GeoTranslateTrans(trans, xoff, yoff, &origin);
+
+    for (pNum = 0; pNum < MAXCIFRLAYERS; pNum++)
+    {
+	if (gdsplanes[pNum] == NULL) continue;
+
+	gdsStampCount = 0;
+	DBSrPaintArea((Tile *)NULL, gdsplanes[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, gdsStampCollectFunc, (ClientData)&origin);
+	calmaStampMerge(FALSE);
+	calmaStampMerge(TRUE);
+
+	for (i = 0; i < gdsStampCount; i++)
+	{
+	    gs = &gdsStampList[i];
+	    gs->gs_nx = nx;
+	    gs->gs_ny = ny;
+	    if (gs->gs_type & TT_DIAGONAL) continue;
+	    if ((nx > 1) && (gs->gs_rect.r_xtop - gs->gs_rect.r_xbot >= dx))
+	    {
+		gs->gs_rect.r_xtop += (nx - 1) * dx;
+		gs->gs_nx = 1;
+	    }
+	    if ((ny > 1) && (gs->gs_rect.r_ytop - gs->gs_rect.r_ybot >= dy))
+	    {
+		gs->gs_rect.r_ytop += (ny - 1) * dy;
+		gs->gs_ny = 1;
+	    }
+	}
+
+	for (y = 0; y < ny; y++)
+	    for (x = 0; x < nx; x++)
+		for (i = 0; i < gdsStampCount; i++)
+		{
+		    gs = &gdsStampList[i];
+		    if ((x >= gs->gs_nx) || (y >= gs->gs_ny)) continue;
+		    r.r_xbot = gs->gs_rect.r_xbot + x * dx;
+		    r.r_xtop = gs->gs_rect.r_xtop + x * dx;
+		    r.r_ybot = gs->gs_rect.r_ybot + y * dy;
+		    r.r_ytop = gs->gs_rect.r_ytop + y * dy;
+		    DBNMPaintPlane(cifCurReadPlanes[pNum], gs->gs_type, &r,
+				CIFPaintTable, (PaintUndoInfo *)NULL);
+		}
+    }
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
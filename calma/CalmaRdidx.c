@@ -0,0 +1,528 @@
+/*
+ * CalmaRdidx.c --
+ *
+ * Input of Calma GDS-II stream format.
+ * Conversion of polygons to rectangles ahead of painting.
+ *
+ * When "gds read -threads n" is used on a file that is mapped into
+ * memory, the file is read in two passes.  The first pass indexes the
+ * structures in the file and hands them to a pool of threads, which
+ * convert the boundaries and boxes of each structure into lists of
+ * rectangles.  The second pass is the ordinary parse, which creates
+ * the cells, labels and uses and paints the rectangles, taking each
+ * polygon's rectangles from the first pass instead of converting it
+ * again.  Polygons that need anything more than a straight conversion
+ * (non-Manhattan edges, a change of scale, or an error message) are
+ * left for the second pass to handle in the usual way.  Paths are
+ * always left for the second pass, since CIFPaintWirePath() paints
+ * each wire straight into the plane as it works out the outline, and
+ * may stop partway with a warning.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "utils/magic.h"
+#include "utils/geometry.h"
+#include "tiles/tile.h"
+#include "utils/utils.h"
+#include "utils/hash.h"
+#include "database/database.h"
+#include "utils/malloc.h"
+#include "cif/cif.h"
+#include "cif/CIFint.h"
+#include "cif/CIFread.h"
+#include "textio/textio.h"
+#include "utils/workers.h"
+#include "calma/calmaInt.h"
+#include "calma/calma.h"
+
+int CalmaReadThreads = 1;	/* Threads converting polygons on input;
+				 * 0 means one per CPU.
+				 */
+
+/* One polygon converted ahead of painting */
+typedef struct
+{
+    OFFTYPE	 cp_offset;	/* File offset of the polygon's XY record */
+    int		 cp_nbytes;	/* Length of the XY record */
+    bool	 cp_used;	/* TRUE once taken by calmaPreTake() */
+    LinkedRect	*cp_rects;	/* Rectangles, in CIF units */
+} CalmaPrePoly;
+
+/* One structure of the index */
+typedef struct
+{
+    unsigned char *cx_start;	/* First record of the structure's body */
+    unsigned char *cx_end;	/* End of the structure's last record */
+    CalmaPrePoly  *cx_polys;	/* Polygons converted, in file order */
+    int		   cx_npolys;	/* Number of entries used in cx_polys */
+    int		   cx_size;	/* Number of entries allocated */
+} CalmaIndex;
+
+/* The index, in file order.  Because the polygons of each structure
+ * are also in file order, all polygons are sorted by file offset.
+ */
+static CalmaIndex *calmaPreIndex = NULL;
+static int calmaPreNStructs = 0;
+
+/* Cursor for calmaPreTake():  the last structure searched */
+static int calmaPreLast = 0;
+
+/* Scale in effect when the polygons were converted */
+static int calmaPreScale1, calmaPreScale2;
+
+/* Read a big-endian integer straight from the mapped file */
+#define	PREI4(p)	((int)(((unsigned)(p)[0] << 24) | ((unsigned)(p)[1] << 16) \
+			| ((unsigned)(p)[2] << 8) | (unsigned)(p)[3]))
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPreCoord --
+ *
+ * Scale one coordinate from the file as calmaReadPoint() would.
+ *
+ * Results:
+ *	TRUE if the coordinate scales to an integer, FALSE if reading it
+ *	would force calmaReadPoint() to rescale the input.
+ *
+ * Side effects:
+ *	Sets *pvalue.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaPreCoord(
+    unsigned char *p,	/* Coordinate in the file */
+    int *pvalue)	/* Scaled coordinate */
+{
+    int value = PREI4(p) * calmaPreScale1;
+
+    if (value % calmaPreScale2 != 0) return FALSE;
+    *pvalue = value / calmaPreScale2;
+    return TRUE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPreBoundary --
+ * calmaPreBox --
+ *
+ * Convert the XY record of a boundary or a box into rectangles, giving
+ * the same result as calmaElementBoundary() or calmaElementBox().
+ *
+ * Results:
+ *	TRUE if the polygon was converted, FALSE if it must be left for
+ *	calmaElementBoundary() or calmaElementBox() because it is not
+ *	Manhattan, is not closed, has too few points, or needs rescaling.
+ *
+ * Side effects:
+ *	Sets *prects to a list of rectangles (possibly empty).
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaPreBoundary(
+    unsigned char *xy,	/* Points of the XY record */
+    int npoints,	/* Number of points */
+    LinkedRect **prects)
+{
+    CIFPath *pathheadp = NULL, *pathtailp = NULL, *newpathp;
+    Point p;
+    int n;
+
+    /* Fewer points than this draws an error from CIFPolyToRects() */
+    if (npoints < 5) return FALSE;
+
+    for (n = 0; n < npoints; n++, xy += 8)
+    {
+	if (!calmaPreCoord(xy, &p.p_x) || !calmaPreCoord(xy + 4, &p.p_y)
+		|| (ABS(p.p_x) > 0x0fffffff) || (ABS(p.p_y) > 0x0fffffff)
+		|| ((pathtailp != NULL) && (pathtailp->cifp_x != p.p_x)
+		&& (pathtailp->cifp_y != p.p_y)))
+	{
+	    CIFFreePath(pathheadp);
+	    return FALSE;
+	}
+	newpathp = (CIFPath *)mallocMagic(sizeof (CIFPath));
+	newpathp->cifp_point = p;
+	newpathp->cifp_next = (CIFPath *)NULL;
+	if (pathheadp)
+	    pathtailp->cifp_next = newpathp;
+	else
+	    pathheadp = newpathp;
+	pathtailp = newpathp;
+    }
+
+    /* An open boundary draws a warning from CIFPolyToRects() */
+    if ((pathtailp->cifp_x != pathheadp->cifp_x) ||
+		(pathtailp->cifp_y != pathheadp->cifp_y))
+    {
+	CIFFreePath(pathheadp);
+	return FALSE;
+    }
+
+    /* A closed Manhattan path is converted without touching a plane */
+    *prects = CIFPolyToRects(pathheadp, (Plane *)NULL, CIFPaintTable,
+		(PaintUndoInfo *)NULL, TRUE);
+    CIFFreePath(pathheadp);
+    return TRUE;
+}
+
+bool
+calmaPreBox(
+    unsigned char *xy,	/* Points of the XY record */
+    int npoints,	/* Number of points */
+    LinkedRect **prects)
+{
+    LinkedRect *lr;
+    Rect r;
+    Point p;
+    int n;
+
+    if (npoints != 5) return FALSE;
+
+    r.r_xbot = r.r_ybot = INFINITY;
+    r.r_xtop = r.r_ytop = MINFINITY;
+    for (n = 0; n < npoints; n++, xy += 8)
+    {
+	if (!calmaPreCoord(xy, &p.p_x) || !calmaPreCoord(xy + 4, &p.p_y))
+	    return FALSE;
+	if (p.p_x < r.r_xbot) r.r_xbot = p.p_x;
+	if (p.p_y < r.r_ybot) r.r_ybot = p.p_y;
+	if (p.p_x > r.r_xtop) r.r_xtop = p.p_x;
+	if (p.p_y > r.r_ytop) r.r_ytop = p.p_y;
+    }
+
+    lr = (LinkedRect *)mallocMagic(sizeof (LinkedRect));
+    lr->r_r = r;
+    lr->r_next = (LinkedRect *)NULL;
+    *prects = lr;
+    return TRUE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPreStructure --
+ *
+ * Job procedure for WorkerRun():  walk the records of one structure
+ * and convert each boundary and box that calmaPreBoundary() or
+ * calmaPreBox() can handle.  A malformed record ends the walk;  the
+ * rest of the structure is then left entirely to the second pass.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in cx_polys, cx_npolys and cx_size of the structure.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaPreStructure(
+    int job,		/* Index of the structure */
+    ClientData cdata)	/* Unused */
+{
+    CalmaIndex *cx = &calmaPreIndex[job];
+    CalmaPrePoly *cp;
+    LinkedRect *rects;
+    unsigned char *rec;
+    int nbytes, rtype, element = 0;
+    bool converted;
+
+    for (rec = cx->cx_start; rec + CALMAHEADERLENGTH <= cx->cx_end;
+		rec += nbytes)
+    {
+	nbytes = ((unsigned)rec[0] << 8) | rec[1];
+	rtype = rec[2];
+	if ((nbytes < CALMAHEADERLENGTH) || (rec + nbytes > cx->cx_end))
+	    break;
+
+	switch (rtype)
+	{
+	    case CALMA_BOUNDARY:
+	    case CALMA_BOX:
+		element = rtype;
+		continue;
+	    case CALMA_XY:
+		break;
+	    default:
+		if (rtype == CALMA_ENDEL) element = 0;
+		continue;
+	}
+	if (element == 0) continue;
+
+	rects = (LinkedRect *)NULL;
+	if (element == CALMA_BOX)
+	    converted = calmaPreBox(rec + CALMAHEADERLENGTH,
+			(nbytes - CALMAHEADERLENGTH) / 8, &rects);
+	else
+	    converted = calmaPreBoundary(rec + CALMAHEADERLENGTH,
+			(nbytes - CALMAHEADERLENGTH) / 8, &rects);
+	element = 0;
+	if (!converted) continue;
+
+	if (cx->cx_npolys == cx->cx_size)
+	{
+	    CalmaPrePoly *newpolys;
+
+	    cx->cx_size = (cx->cx_size == 0) ? 64 : cx->cx_size * 2;
+	    newpolys = (CalmaPrePoly *)mallocMagic(cx->cx_size
+			* sizeof (CalmaPrePoly));
+	    if (cx->cx_npolys > 0)
+	    {
+		memcpy(newpolys, cx->cx_polys, cx->cx_npolys
+			* sizeof (CalmaPrePoly));
+		freeMagic((char *)cx->cx_polys);
+	    }
+	    cx->cx_polys = newpolys;
+	}
+	cp = &cx->cx_polys[cx->cx_npolys++];
+	cp->cp_offset = (OFFTYPE)(rec - calmaInBuf);
+	cp->cp_nbytes = nbytes;
+	cp->cp_used = FALSE;
+	cp->cp_rects = rects;
+    }
+    freeMagicFlush();
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPreRead --
+ *
+ * First pass over a GDS file:  index the structures that follow the
+ * current input position, then convert their polygons concurrently
+ * with CalmaReadThreads threads.  Called by CalmaReadFile() once the
+ * library header has been read, and so the scale is known.  Does
+ * nothing unless CalmaReadThreads is other than 1 and the input is
+ * mapped into memory.
+ *
+ * Results:
+ *	TRUE if the first pass was made, FALSE otherwise.
+ *
+ * Side effects:
+ *	Builds the index and the polygon lists, which calmaPreTake()
+ *	draws on and calmaPreFree() releases.  The input position is not
+ *	changed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaPreRead(void)
+{
+    unsigned char *rec, *start = NULL;
+    int nbytes, rtype, size = 0, nthreads, npolys, i;
+
+    calmaPreIndex = (CalmaIndex *)NULL;
+    calmaPreNStructs = 0;
+    calmaPreLast = 0;
+
+    if (CalmaReadThreads == 1) return FALSE;
+    nthreads = WorkerCount(CalmaReadThreads);
+    if (nthreads <= 1) return FALSE;
+#ifndef HAVE_THREAD_LOCAL
+    TxPrintf("Polygons can't be converted concurrently;  using one thread.\n");
+    return FALSE;
+#else
+    if (!calmaInMapped() || calmaLApresent)
+    {
+	TxPrintf("Only uncompressed files are read with more than one thread;"
+		"  using one thread.\n");
+	return FALSE;
+    }
+
+    /* Index the structures, from BGNSTR to ENDSTR */
+
+    for (rec = calmaInPtr; rec + CALMAHEADERLENGTH <= calmaInEnd; rec += nbytes)
+    {
+	nbytes = ((unsigned)rec[0] << 8) | rec[1];
+	rtype = rec[2];
+	if ((nbytes < CALMAHEADERLENGTH) || (rec + nbytes > calmaInEnd))
+	    break;
+
+	if (rtype == CALMA_BGNSTR)
+	    start = rec + nbytes;
+	else if ((rtype == CALMA_ENDSTR) && (start != NULL))
+	{
+	    if (calmaPreNStructs == size)
+	    {
+		CalmaIndex *newindex;
+
+		size = (size == 0) ? 64 : size * 2;
+		newindex = (CalmaIndex *)mallocMagic(size * sizeof (CalmaIndex));
+		if (calmaPreNStructs > 0)
+		{
+		    memcpy(newindex, calmaPreIndex, calmaPreNStructs
+				* sizeof (CalmaIndex));
+		    freeMagic((char *)calmaPreIndex);
+		}
+		calmaPreIndex = newindex;
+	    }
+	    calmaPreIndex[calmaPreNStructs].cx_start = start;
+	    calmaPreIndex[calmaPreNStructs].cx_end = rec;
+	    calmaPreIndex[calmaPreNStructs].cx_polys = (CalmaPrePoly *)NULL;
+	    calmaPreIndex[calmaPreNStructs].cx_npolys = 0;
+	    calmaPreIndex[calmaPreNStructs].cx_size = 0;
+	    calmaPreNStructs++;
+	    start = NULL;
+	}
+    }
+    if (calmaPreNStructs == 0) return FALSE;
+
+    /* Convert the polygons of each structure */
+
+    calmaPreScale1 = calmaReadScale1;
+    calmaPreScale2 = calmaReadScale2;
+    WorkerRun(nthreads, calmaPreNStructs, calmaPreStructure, (ClientData)NULL);
+
+    npolys = 0;
+    for (i = 0; i < calmaPreNStructs; i++)
+	npolys += calmaPreIndex[i].cx_npolys;
+    nthreads = MIN(nthreads, calmaPreNStructs);
+    TxPrintf("Converted %d polygons in %d structures with %d thread%s.\n",
+		npolys, calmaPreNStructs, nthreads, (nthreads == 1) ? "" : "s");
+    return TRUE;
+#endif
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPreTake --
+ *
+ * Called by calmaElementBoundary() and calmaElementBox() when the
+ * input is positioned at the XY record of a polygon.  If the polygon
+ * was converted by calmaPreRead() at the scale now in effect, skip
+ * over its XY record and return its rectangles.
+ *
+ * Results:
+ *	TRUE if the rectangles were found, FALSE if the caller must read
+ *	and convert the polygon itself.
+ *
+ * Side effects:
+ *	On success, consumes the XY record, and passes ownership of the
+ *	rectangles to the caller through *prects.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaPreTake(
+    LinkedRect **prects)
+{
+    CalmaIndex *cx;
+    CalmaPrePoly *cp;
+    unsigned char *pos;
+    int lo, hi, mid;
+
+    if ((calmaPreNStructs == 0) || calmaLApresent) return FALSE;
+    if ((calmaPreScale1 != calmaReadScale1) ||
+		(calmaPreScale2 != calmaReadScale2))
+	return FALSE;
+
+    /* Find the structure, trying the last one first */
+    pos = calmaInPtr;
+    cx = &calmaPreIndex[calmaPreLast];
+    if ((pos < cx->cx_start) || (pos >= cx->cx_end))
+    {
+	lo = 0;
+	hi = calmaPreNStructs - 1;
+	while (lo < hi)
+	{
+	    mid = (lo + hi + 1) / 2;
+	    if (calmaPreIndex[mid].cx_start <= pos)
+		lo = mid;
+	    else
+		hi = mid - 1;
+	}
+	cx = &calmaPreIndex[lo];
+	if ((pos < cx->cx_start) || (pos >= cx->cx_end)) return FALSE;
+	calmaPreLast = lo;
+    }
+
+    /* Find the polygon */
+    lo = 0;
+    hi = cx->cx_npolys - 1;
+    while (lo <= hi)
+    {
+	mid = (lo + hi) / 2;
+	cp = &cx->cx_polys[mid];
+	if (cp->cp_offset == (OFFTYPE)(pos - calmaInBuf))
+	{
+	    if (cp->cp_used) return FALSE;
+	    cp->cp_used = TRUE;
+	    *prects = cp->cp_rects;
+	    cp->cp_rects = (LinkedRect *)NULL;
+	    calmaInPtr += cp->cp_nbytes;
+	    return TRUE;
+	}
+	else if (cp->cp_offset < (OFFTYPE)(pos - calmaInBuf))
+	    lo = mid + 1;
+	else
+	    hi = mid - 1;
+    }
+    return FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPreFree --
+ *
+ * Free the index and any rectangles not taken by calmaPreTake().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaPreFree(void)
+{
+    CalmaIndex *cx;
+    LinkedRect *lr;
+    int i, j;
+
+    for (i = 0; i < calmaPreNStructs; i++)
+    {
+	cx = &calmaPreIndex[i];
+	for (j = 0; j < cx->cx_npolys; j++)
+	{
+	    free_magic1_t mm1 = freeMagic1_init();
+	    for (lr = cx->cx_polys[j].cp_rects; lr != NULL; lr = lr->r_next)
+		freeMagic1(&mm1, (char *)lr);
+	    freeMagic1_end(&mm1);
+	}
+	if (cx->cx_polys != NULL) freeMagic((char *)cx->cx_polys);
+    }
+    if (calmaPreIndex != NULL) freeMagic((char *)calmaPreIndex);
+    calmaPreIndex = (CalmaIndex *)NULL;
+    calmaPreNStructs = 0;
+    calmaPreLast = 0;
+}
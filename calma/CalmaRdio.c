@@ -22,8 +22,15 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #endif  /* not lint */
 
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <time.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 #include <netinet/in.h>
 
@@ -77,10 +84,9 @@ calmaReadTransform(
     Transform *ptrans,	/* Fill in this transform */
     char *name)		/* Name of subcell (for errors) */
 {
-    int nbytes, rtype, flags, angle;
+    int nbytes, rtype, flags;
     double dangle;
     double dmag;
-    Transform t;
 
     /* Default is the identity transform */
     *ptrans = GeoIdentityTransform;
@@ -103,6 +109,7 @@ calmaReadTransform(
     /* Look for magnification and angle */
     READRH(nbytes, rtype);
     if (nbytes < 0) return (FALSE);
+    dmag = 1.0;
     if (rtype == CALMA_MAG)
     {
 	if (nbytes != CALMAHEADERLENGTH + 8)
@@ -111,14 +118,6 @@ calmaReadTransform(
 	    return (FALSE);
 	}
 	if (!calmaReadR8(&dmag)) return (FALSE);
-
-        if (dmag != (double)((int)(dmag + 0.5)))
-	{
-	    CalmaReadError("Non-integer magnification (%g) in transform\n", dmag);
-	    CalmaReadError("Rounding to %d.\n", (int)(dmag + 0.5));
-	}
-	GeoScaleTrans(ptrans, (int)(dmag + 0.5), &t);
-	*ptrans = t;
     }
     else UNREADRH(nbytes, rtype);
 
@@ -136,6 +135,52 @@ calmaReadTransform(
     }
     else UNREADRH(nbytes, rtype);
 
+    calmaMakeTransform(ptrans, (flags & CALMA_STRANS_UPSIDEDOWN) ? TRUE : FALSE,
+		dmag, dangle);
+    return (TRUE);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaMakeTransform --
+ *
+ * Construct the transform for a cell placed with the given mirroring,
+ * magnification, and counterclockwise angle in degrees, as found in
+ * GDS-II and OASIS.  The magnification is rounded to an integer and
+ * the angle to a multiple of 90 degrees, with a warning.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets the Transform pointed to by 'ptrans'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaMakeTransform(
+    Transform *ptrans,	/* Fill in this transform */
+    bool upsidedown,	/* Mirror about X axis before rotation */
+    double dmag,	/* Magnification */
+    double dangle)	/* Counterclockwise rotation in degrees */
+{
+    int angle;
+    Transform t;
+
+    *ptrans = GeoIdentityTransform;
+    if (dmag != 1.0)
+    {
+        if (dmag != (double)((int)(dmag + 0.5)))
+	{
+	    CalmaReadError("Non-integer magnification (%g) in transform\n", dmag);
+	    CalmaReadError("Rounding to %d.\n", (int)(dmag + 0.5));
+	}
+	GeoScaleTrans(ptrans, (int)(dmag + 0.5), &t);
+	*ptrans = t;
+    }
+
     /* Make sure the angle is Manhattan */
     angle = (int) dangle;
     while (angle < 0) angle += 360;
@@ -161,7 +206,7 @@ calmaReadTransform(
      * Construct the transform.
      * Magic angles are clockwise; Calma angles are counterclockwise.
      */
-    if (flags & CALMA_STRANS_UPSIDEDOWN)
+    if (upsidedown)
     {
 	GeoTransTrans(ptrans, &GeoUpsideDownTransform, &t);
 	*ptrans = t;
@@ -181,8 +226,6 @@ calmaReadTransform(
 	    *ptrans = t;
 	    break;
     }
-
-    return (TRUE);
 }
 
 /*
@@ -222,7 +265,7 @@ calmaReadI2Record(
 
     /* Read the value */
     READI2(n);
-    if (FEOF(calmaInputFile)) goto eof;
+    if (calmaEOF()) goto eof;
     *pvalue = n;
     return (TRUE);
 
@@ -267,7 +310,7 @@ calmaReadI4Record(
 
     /* Read the value */
     READI4(n);
-    if (FEOF(calmaInputFile)) goto eof;
+    if (calmaEOF()) goto eof;
     *pvalue = n;
     return (TRUE);
 
@@ -389,7 +432,7 @@ calmaReadStringRecord(
 
     nbytes -= CALMAHEADERLENGTH;
     *str = (char *) mallocMagic(nbytes + 1);
-    if (magicFREAD(*str, sizeof (char), nbytes, calmaInputFile) != nbytes)
+    if (calmaInRead(*str, nbytes) != nbytes)
 	goto eof;
 
     *(*str + nbytes) = '\0';
@@ -428,8 +471,7 @@ calmaReadR8(
     double mantissa, d;
     bool isneg;
 
-    if (magicFREAD((char *) dchars, sizeof (char), sizeof dchars,
-		calmaInputFile) != sizeof dchars)
+    if (calmaInRead((char *) dchars, sizeof dchars) != sizeof dchars)
 	return (FALSE);
 
     /* Extract the sign and exponent */
@@ -618,9 +660,322 @@ bool
 calmaSkipBytes(
     int nbytes)	/* Skip this many bytes */
 {
+    if ((nbytes >= 0) && (calmaInEnd - calmaInPtr >= nbytes))
+    {
+	calmaInPtr += nbytes;
+	return (TRUE);
+    }
     while (nbytes-- > 0)
-	if (FGETC(calmaInputFile) < 0)
+	if (calmaGetc() < 0)
 	    return (FALSE);
 
     return (TRUE);
 }
+
+/* ------------------------- Buffered input --------------------------- */
+
+/*
+ * All GDS input is read through a window of memory, calmaInBuf to
+ * calmaInEnd, of which calmaInPtr is the next byte to read.  An
+ * uncompressed file is mapped into memory in its entirety, so the
+ * window is the whole file.  A compressed file is decompressed into
+ * the window in large chunks.  Records are then parsed directly from
+ * memory by the READI2(), READI4() and READRH() macros, falling back
+ * on calmaInFill() only at the end of a chunk.
+ */
+
+unsigned char *calmaInBuf = NULL;	/* Start of window */
+unsigned char *calmaInPtr = NULL;	/* Next byte to read */
+unsigned char *calmaInEnd = NULL;	/* End of window */
+bool calmaInEOF = FALSE;		/* Tried to read past end of input */
+dlong calmaInBytes = 0;			/* Bytes of input made available */
+
+static OFFTYPE calmaInBase = 0;		/* File offset of calmaInBuf[0] */
+static size_t calmaInMapSize = 0;	/* Size of mapping, if mapped */
+
+/* Size of each chunk read from a compressed file */
+#define CALMA_IN_CHUNK	(1 << 22)
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaInputOpen --
+ *
+ * Prepare to read GDS-II from 'file', whose real name is 'filename'.
+ * If the file is not compressed and can be mapped into memory, it is;
+ * otherwise, it is read through 'file' in chunks of CALMA_IN_CHUNK
+ * bytes.  calmaInputClose() must be called when reading is done.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets calmaInputFile and the input window.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaInputOpen(
+    FILETYPE file,	/* Open input file */
+    char *filename)	/* Real name of the file */
+{
+    calmaInputFile = file;
+    calmaInEOF = FALSE;
+    calmaInBase = 0;
+    calmaInMapSize = 0;
+    calmaInBytes = 0;
+
+#ifdef HAVE_SYS_MMAN_H
+    if (filename != NULL)
+    {
+	unsigned char magic[2];
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd >= 0)
+	{
+	    /* Compressed files (starting with the gzip magic	*/
+	    /* number) are left to zlib.			*/
+
+	    if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) &&
+			(st.st_size > 0) &&
+			(read(fd, magic, 2) == 2) &&
+			!((magic[0] == 0x1f) && (magic[1] == 0x8b)))
+	    {
+		map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+			fd, (off_t)0);
+		if (map != MAP_FAILED)
+		{
+#ifdef MADV_SEQUENTIAL
+		    (void) madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+		    calmaInMapSize = (size_t)st.st_size;
+		    calmaInBuf = calmaInPtr = (unsigned char *)map;
+		    calmaInEnd = calmaInBuf + calmaInMapSize;
+		    calmaInBytes = (dlong)calmaInMapSize;
+		}
+	    }
+	    close(fd);
+	    if (calmaInMapSize > 0) return;
+	}
+    }
+#endif
+
+    calmaInBuf = (unsigned char *)mallocMagic(CALMA_IN_CHUNK);
+    calmaInPtr = calmaInEnd = calmaInBuf;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaInputClose --
+ *
+ * Release the input window set up by calmaInputOpen().  The file
+ * itself is left for the caller to close.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Unmaps or frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaInputClose(void)
+{
+    if (calmaInBuf == NULL) return;
+#ifdef HAVE_SYS_MMAN_H
+    if (calmaInMapSize > 0)
+	(void) munmap((void *)calmaInBuf, calmaInMapSize);
+    else
+#endif
+	freeMagic((char *)calmaInBuf);
+    calmaInBuf = calmaInPtr = calmaInEnd = (unsigned char *)NULL;
+    calmaInMapSize = 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaInMapped --
+ *
+ * Report whether the whole input file is mapped into memory, in which
+ * case calmaInBuf is file offset 0 and calmaInEnd is the end of the
+ * file.
+ *
+ * Results:
+ *	TRUE if the input is mapped, FALSE otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaInMapped(void)
+{
+    return (calmaInMapSize > 0);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaInFill --
+ *
+ * Called by calmaGetc() when the window has been used up:  read the
+ * next chunk of a compressed file into the window.
+ *
+ * Results:
+ *	The next byte of input, or -1 at the end of the input.
+ *
+ * Side effects:
+ *	Moves the window.  Sets calmaInEOF at the end of the input.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaInFill(void)
+{
+    int n;
+
+    if (calmaInMapSize == 0)
+    {
+	calmaInBase += calmaInEnd - calmaInBuf;
+	n = magicFREAD((char *)calmaInBuf, sizeof(char), CALMA_IN_CHUNK,
+		calmaInputFile);
+	if (n > 0)
+	{
+	    calmaInBytes += n;
+	    calmaInPtr = calmaInBuf;
+	    calmaInEnd = calmaInBuf + n;
+	    return (int)*calmaInPtr++;
+	}
+	calmaInPtr = calmaInEnd = calmaInBuf;
+    }
+    calmaInEOF = TRUE;
+    return -1;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaInTell --
+ * calmaInSeek --
+ *
+ * Equivalents of FTELL() and FSEEK() for the input.  Seeking within
+ * the window only moves calmaInPtr;  seeking elsewhere in a compressed
+ * file empties the window and seeks the file.  Both clear calmaInEOF.
+ *
+ * Results:
+ *	calmaInTell() returns the offset of the next byte to be read.
+ *	calmaInSeek() returns 0 on success, -1 if the offset is negative
+ *	or the file could not be seeked, in which case the position is
+ *	unchanged.
+ *
+ * Side effects:
+ *	calmaInSeek() moves the input position.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+OFFTYPE
+calmaInTell(void)
+{
+    return calmaInBase + (OFFTYPE)(calmaInPtr - calmaInBuf);
+}
+
+int
+calmaInSeek(
+    OFFTYPE offset,
+    int whence)		/* SEEK_SET, SEEK_CUR, or SEEK_END */
+{
+    OFFTYPE target;
+
+    switch (whence)
+    {
+	case SEEK_CUR:
+	    target = calmaInTell() + offset;
+	    break;
+	case SEEK_END:
+	    if (calmaInMapSize == 0)
+	    {
+		/* Only possible if the file system allows it */
+		if (FSEEK(calmaInputFile, offset, SEEK_END) < 0) return -1;
+		calmaInBase = FTELL(calmaInputFile);
+		calmaInPtr = calmaInEnd = calmaInBuf;
+		calmaInEOF = FALSE;
+		return 0;
+	    }
+	    target = (OFFTYPE)calmaInMapSize + offset;
+	    break;
+	default:
+	    target = offset;
+	    break;
+    }
+    if (target < 0) return -1;
+
+    if ((target >= calmaInBase) &&
+		(target <= calmaInBase + (OFFTYPE)(calmaInEnd - calmaInBuf)))
+	calmaInPtr = calmaInBuf + (target - calmaInBase);
+    else if (calmaInMapSize > 0)
+    {
+	/* Past the end of a mapped file;  as with fseek(), the	*/
+	/* seek succeeds, and the next read finds the end of input.	*/
+	calmaInPtr = calmaInEnd;
+    }
+    else
+    {
+	if (FSEEK(calmaInputFile, target, SEEK_SET) < 0) return -1;
+	calmaInBase = target;
+	calmaInPtr = calmaInEnd = calmaInBuf;
+    }
+    calmaInEOF = FALSE;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaInRead --
+ *
+ * Equivalent of magicFREAD() for the input:  copy 'n' bytes into 'buf'.
+ *
+ * Results:
+ *	Number of bytes copied, which is less than 'n' only at the end of
+ *	the input.
+ *
+ * Side effects:
+ *	Consumes input.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaInRead(
+    char *buf,
+    int n)
+{
+    int have, got = 0;
+
+    if (n < 0) return 0;
+    while (got < n)
+    {
+	if (calmaInPtr == calmaInEnd)
+	{
+	    if (calmaInFill() < 0) break;
+	    calmaInPtr--;
+	}
+	have = MIN(n - got, (int)(calmaInEnd - calmaInPtr));
+	memcpy(buf + got, calmaInPtr, have);
+	calmaInPtr += have;
+	got += have;
+    }
+    return got;
+}
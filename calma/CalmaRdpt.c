@@ -114,11 +114,13 @@ calmaInputRescale(
 /*
  * ----------------------------------------------------------------------------
  *
+ * calmaScaleValue ---
  * calmaReadX ---
  * calmaReadY ---
  * calmaReadPoint ---
  *
- * Read a point from the input.
+ * Read a point from the input, or (calmaScaleValue) scale a single
+ * coordinate already read, as done for OASIS input.
  * We take care of scaling by calmaReadScale1/calmaReadScale2.
  * Also take care of noting when the scaling results in a sub-integer
  * value, and rescaling everything appropriately.  "iscale" is an
@@ -126,7 +128,8 @@ calmaInputRescale(
  * the scale, as for a path centerline.
  *
  * Results:
- *	None.
+ *	calmaScaleValue returns the scaled value;  the others return
+ *	nothing.
  *
  * Side effects:
  *	The Point pointed to by parameter "p" is filled with the
@@ -143,34 +146,42 @@ calmaInputRescale(
  * ----------------------------------------------------------------------------
  */
 
-void
-calmaReadX(
-    Point *p,
+int
+calmaScaleValue(
+    int value,
     int iscale)
 {
     int rescale;
 
-    READI4((p)->p_x);
-    p->p_x *= (calmaReadScale1 * iscale);
-    if ((iscale != 0) && (p->p_x % calmaReadScale2 != 0))
+    value *= (calmaReadScale1 * iscale);
+    if ((iscale != 0) && (value % calmaReadScale2 != 0))
     {
-	rescale = calmaReadScale2 / FindGCF(calmaReadScale2, abs(p->p_x));
+	rescale = calmaReadScale2 / FindGCF(calmaReadScale2, abs(value));
 	if ((calmaReadScale1 * rescale) > CIFRescaleLimit)
 	{
 	    CalmaReadError("Warning:  calma units at max scale; value rounded\n");
-	    if (p->p_x < 0)
-		p->p_x -= ((calmaReadScale2 - 1) >> 1);
+	    if (value < 0)
+		value -= ((calmaReadScale2 - 1) >> 1);
 	    else
-		p->p_x += (calmaReadScale2 >> 1);
+		value += (calmaReadScale2 >> 1);
 	}
 	else
 	{
 	    calmaReadScale1 *= rescale;
 	    calmaInputRescale(rescale, 1);
-	    p->p_x *= rescale;
+	    value *= rescale;
 	}
     }
-    p->p_x /= calmaReadScale2;
+    return (value / calmaReadScale2);
+}
+
+void
+calmaReadX(
+    Point *p,
+    int iscale)
+{
+    READI4((p)->p_x);
+    p->p_x = calmaScaleValue(p->p_x, iscale);
 }
 
 
@@ -179,30 +190,12 @@ calmaReadY(
     Point *p,
     int iscale)
 {
-    int rescale;
+    int savescale = calmaReadScale1;
 
     READI4((p)->p_y);
-    p->p_y *= (calmaReadScale1 * iscale);
-    if ((iscale != 0) && (p->p_y % calmaReadScale2 != 0))
-    {
-	rescale = calmaReadScale2 / FindGCF(calmaReadScale2, abs(p->p_y));
-	if ((calmaReadScale1 * rescale) > CIFRescaleLimit)
-	{
-	    CalmaReadError("Warning:  calma units at max scale; value rounded\n");
-	    if (p->p_y < 0)
-		p->p_y -= ((calmaReadScale2 - 1) >> 1);
-	    else
-		p->p_y += (calmaReadScale2 >> 1);
-	}
-	else
-	{
-	    calmaReadScale1 *= rescale;
-	    calmaInputRescale(rescale, 1);
-	    p->p_x *= rescale;
-	    p->p_y *= rescale;
-	}
-    }
-    p->p_y /= calmaReadScale2;
+    p->p_y = calmaScaleValue(p->p_y, iscale);
+    if (savescale != calmaReadScale1)
+	p->p_x *= (calmaReadScale1 / savescale);
 }
 
 void
@@ -238,8 +231,6 @@ calmaElementBoundary(void)
     CIFPath *pathheadp;
     LinkedRect *rp;
     Plane *plane;
-    CellUse *use;
-    CellDef *savedef = NULL, *newdef = NULL;
 
     /* Skip CALMA_ELFLAGS, CALMA_PLEX */
     calmaSkipSet(calmaElementIgnore);
@@ -262,6 +253,13 @@ calmaElementBoundary(void)
     else
 	plane = cifCurReadPlanes[ciftype];
 
+    /* Use the rectangles converted by calmaPreRead(), if there are any */
+    if ((plane != NULL) && calmaPreTake(&rp))
+    {
+	calmaPaintBoundary((CIFPath *)NULL, rp, ciftype);
+	return;
+    }
+
     /* Read the path itself, building up a path structure */
     pathheadp = calmaReadPath((plane == NULL) ? 0 : 1);
     if (pathheadp == NULL)
@@ -270,10 +268,45 @@ calmaElementBoundary(void)
 	    CalmaReadError("Error while reading path for boundary/box; ignored.\n");
 	return;
     }
+    calmaPaintBoundary(pathheadp, (LinkedRect *)NULL, ciftype);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPaintBoundary --
+ *
+ * Paint a polygon read by calmaElementBoundary() or by the OASIS
+ * reader into the CIF plane for "ciftype".  The polygon is given
+ * either as a path "pathheadp" in CIF units, which is freed here,
+ * or as a list of rectangles "rp" already converted from one.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Paints one or more rectangles into one of the CIF planes,
+ *	or into a new subcell for non-Manhattan polygons.  May
+ *	attach the area to a sticky label.  Frees "pathheadp" and "rp".
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaPaintBoundary(
+    CIFPath *pathheadp,		/* Polygon outline, or NULL */
+    LinkedRect *rp,		/* Rectangles if pathheadp is NULL */
+    int ciftype)		/* CIF layer, or -1 if unknown */
+{
+    Plane *plane;
+    CellUse *use;
+    CellDef *savedef = NULL, *newdef = NULL;
 
     /* Note that calmaReadPath() may reallocate planes of cifCurReadPlanes */
-    /* so we need to set it again.					   */
-    if (ciftype >= 0) plane = cifCurReadPlanes[ciftype];
+    /* so the plane is looked up only here.				   */
+    plane = (ciftype >= 0) ? cifCurReadPlanes[ciftype] : NULL;
+    if (pathheadp == NULL)
+	goto haveRects;
 
     /* Save non-Manhattan polygons in their own subcells. */
     /* NOTE: CALMA_POLYGON_TEMP and CALMA_POLYGON_KEEP read in polygons much
@@ -314,6 +347,8 @@ calmaElementBoundary(void)
     rp = CIFPolyToRects(pathheadp, plane, CIFPaintTable, (PaintUndoInfo *)NULL, TRUE);
     CIFFreePath(pathheadp);
 
+haveRects:
+
     /* If the input layer is designated for ports by a "label"	*/
     /* statement in the cifinput section, then find any label	*/
     /* bounded by the path and attach the path to it.  Note	*/
@@ -441,6 +476,7 @@ calmaElementBox(void)
     int nbytes, rtype, npoints, savescale;
     int dt, layer, ciftype;
     Plane *plane;
+    LinkedRect *rp;
     Point p;
     Rect r;
 
@@ -464,6 +500,14 @@ calmaElementBox(void)
     }
     else plane = cifCurReadPlanes[ciftype];
 
+    /* Use the rectangle found by calmaPreRead(), if there is one */
+    if (calmaPreTake(&rp))
+    {
+	DBPaintPlane(plane, &rp->r_r, CIFPaintTable, (PaintUndoInfo *)NULL);
+	freeMagic((char *)rp);
+	return;
+    }
+
     /*
      * Read the path itself.
      * Since it is Manhattan, we can build our rectangle directly.
@@ -534,13 +578,8 @@ void
 calmaElementPath(void)
 {
     int nbytes = -1, rtype = 0, extend1, extend2;
-    int layer, dt, width, pathtype, ciftype, savescale;
-    int xmin, ymin, xmax, ymax, temp;
-    CIFPath *pathheadp, *pathp, *previousp;
-    Plane *plane;
-    int first,last;
-    CellUse *use;
-    CellDef *savedef = NULL, *newdef = NULL;
+    int layer, dt, width, pathtype, savescale;
+    CIFPath *pathheadp;
 
     /* Skip CALMA_ELFLAGS, CALMA_PLEX */
     calmaSkipSet(calmaElementIgnore);
@@ -636,6 +675,45 @@ calmaElementPath(void)
 	extend2 *= (calmaReadScale1 / savescale);
     }
 
+    calmaPaintPath(pathheadp, width, extend1, extend2, pathtype, layer, dt);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPaintPath --
+ *
+ * Paint a path read by calmaElementPath() or by the OASIS reader.
+ * The centerline "pathheadp" and the extensions are in CIF units
+ * times two, the width in CIF units.  "pathtype" is one of the
+ * CALMAPATH_* end styles.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Paints the wire into the CIF plane for (layer, dt), or into
+ *	a new subcell if "gds subcell paths" is set.  Frees "pathheadp".
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaPaintPath(
+    CIFPath *pathheadp,		/* Path centerline */
+    int width,			/* Width of the path */
+    int extend1,		/* Extension of the first point */
+    int extend2,		/* Extension of the last point */
+    int pathtype,		/* End style */
+    int layer,			/* GDS layer */
+    int dt)			/* GDS datatype */
+{
+    int ciftype;
+    CIFPath *pathp;
+    Plane *plane;
+    CellUse *use;
+    CellDef *savedef = NULL, *newdef = NULL;
+
     /* Create path end extensions */
 
     if (extend1 > 0)
@@ -773,7 +851,7 @@ calmaElementText(void)
     TileType type;
     Rect r;
     double dval;
-    int size, micron, angle, font, pos, portnum, idx;
+    int size, micron, angle, font, pos;
 
     /* Skip CALMA_ELFLAGS, CALMA_PLEX */
     calmaSkipSet(calmaElementIgnore);
@@ -781,21 +859,10 @@ calmaElementText(void)
     /* Grab layer and texttype */
     if (!calmaReadI2Record(CALMA_LAYER, &layer)) return;
     if (!calmaReadI2Record(CALMA_TEXTTYPE, &textt)) return;
-    cifnum = CIFCalmaLayerToCifLayer(layer, textt, cifCurReadStyle);
-    if (cifnum < 0)
-    {
-	if (cifCurReadStyle->crs_flags & CRF_IGNORE_UNKNOWNLAYER_LABELS)
-	    type = -1;
-	else {
-	    calmaLayerError("Label on unknown layer/datatype", layer, textt);
-	    type = TT_SPACE;
-	}
-    }
-    else type = cifCurReadStyle->crs_labelLayer[cifnum];
+    type = calmaTextType(layer, textt, &cifnum);
 
     font = -1;
     angle = 0;
-    portnum = 0;
 
     /* Use the minimum width of the layer on which the text is placed
      * as the default text size, or 1um, whichever is smaller.  Account
@@ -1005,6 +1072,94 @@ calmaElementText(void)
 
 #endif /* 0 */
 
+    calmaPlaceText(textbody, &r, cifnum, type, layer, textt,
+		pos, font, size, angle);
+
+    /* done with textbody */
+    if (textbody != NULL) freeMagic(textbody);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaTextType --
+ *
+ * Find the CIF layer and the magic label type for text on the
+ * GDS (layer, textt) pair, reporting unknown pairs.
+ *
+ * Results:
+ *	The magic type for the label, TT_SPACE if the layer is unknown,
+ *	or -1 if labels on unknown layers are being ignored.  The CIF
+ *	layer, or -1, is returned in *pcifnum.
+ *
+ * Side effects:
+ *	May print an error message through calmaLayerError().
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+TileType
+calmaTextType(
+    int layer,
+    int textt,
+    int *pcifnum)
+{
+    int cifnum;
+    TileType type;
+
+    cifnum = CIFCalmaLayerToCifLayer(layer, textt, cifCurReadStyle);
+    if (cifnum < 0)
+    {
+	if (cifCurReadStyle->crs_flags & CRF_IGNORE_UNKNOWNLAYER_LABELS)
+	    type = -1;
+	else {
+	    calmaLayerError("Label on unknown layer/datatype", layer, textt);
+	    type = TT_SPACE;
+	}
+    }
+    else type = cifCurReadStyle->crs_labelLayer[cifnum];
+
+    *pcifnum = cifnum;
+    return type;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaPlaceText --
+ *
+ * Place a label read by calmaElementText() or by the OASIS reader
+ * in the cell being read.  "r" is the label position in magic
+ * units;  "cifnum" and "type" are as returned by calmaTextType().
+ * If "font" is negative, "size" and "angle" are unused.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Adds a label to cifReadCellDef, merges it with a placeholder
+ *	label made by a sticky pin shape, or renames the cell for a
+ *	"cellid" label layer.  Does not free "textbody".
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaPlaceText(
+    char *textbody,		/* Label text */
+    Rect *pr,			/* Label position */
+    int cifnum,			/* CIF layer, or -1 */
+    TileType type,		/* Label type */
+    int layer,			/* GDS layer, for messages */
+    int textt,			/* GDS texttype, for messages */
+    int pos,			/* Justification */
+    int font,			/* Font, or -1 for the default */
+    int size,			/* Font size */
+    int angle)			/* Font rotation */
+{
+    Rect r = *pr;
+    int portnum = 0, idx;
+
     /* Place the label */
     if (strlen(textbody) == 0)
     {
@@ -1117,8 +1272,6 @@ calmaElementText(void)
 	}
     }
 
-    /* done with textbody */
-    if (textbody != NULL) freeMagic(textbody);
 }
 
 /*
@@ -1187,7 +1340,7 @@ calmaReadPath(
 	    CalmaReadError("Warning:  Very large point in path:  (%d, %d)\n",
 		path.cifp_x, path.cifp_y);
 	}
-	if (FEOF(calmaInputFile))
+	if (calmaEOF())
 	{
 	    CIFFreePath(pathheadp);
 	    return (NULL);
@@ -24,6 +24,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/time.h>		/* for gettimeofday() */
 #include <unistd.h>
 
 #include <netinet/in.h>
@@ -103,6 +104,10 @@ bool CalmaNoDuplicates = FALSE;		/* If TRUE, then if a cell exists in
 					 * in the GDS file, then the cell in
 					 * the GDS file is skipped.
 					 */
+bool CalmaReadStats = FALSE;		/* If TRUE, report the amount of GDS
+					 * read and the rate at which it was
+					 * read.
+					 */
 bool CalmaUnique = FALSE;		/* If TRUE, then if a cell exists in
 					 * memory with the same name as a cell
 					 * in the GDS file, then the cell in
@@ -174,6 +179,9 @@ CalmaReadFile(
     int k, version;
     char *libname = NULL, *libnameptr = NULL;
     MagWindow *mw;
+    struct timeval start, now, prestart, preend;
+    double seconds, preseconds;
+    bool preread;
     static const int hdrSkip[] = { CALMA_FORMAT, CALMA_MASK, CALMA_ENDMASKS,
 					 CALMA_REFLIBS, CALMA_FONTS, CALMA_ATTRTABLE,
 					 CALMA_STYPTABLE, CALMA_GENERATIONS, -1 };
@@ -219,7 +227,9 @@ CalmaReadFile(
 
     HashInit(&calmaDefInitHash, 32, 0);
     calmaLApresent = FALSE;
-    calmaInputFile = file;
+    gettimeofday(&start, (struct timezone *)NULL);
+    calmaInputOpen(file, filename);
+    preread = FALSE;
 
     /* Read the GDS-II header */
     if (!calmaReadI2Record(CALMA_HEADER, &version)) goto done;
@@ -276,6 +286,12 @@ CalmaReadFile(
     /* Set the scale factors */
     if (!calmaParseUnits()) goto done;
 
+    /* With more than one thread, convert polygons to rectangles ahead */
+    /* of the main body, which then creates the cells and paints them.  */
+    gettimeofday(&prestart, (struct timezone *)NULL);
+    preread = calmaPreRead();
+    gettimeofday(&preend, (struct timezone *)NULL);
+
     /* Main body of GDS-II input */
     while (calmaParseStructure(filename))
 	if (SigInterruptPending)
@@ -284,6 +300,29 @@ CalmaReadFile(
 
 done:
 
+    /* Report the rate at which the input was read */
+    if (CalmaReadStats)
+    {
+	gettimeofday(&now, (struct timezone *)NULL);
+	seconds = (double)(now.tv_sec - start.tv_sec)
+		+ (double)(now.tv_usec - start.tv_usec) / 1.0e6;
+	if (seconds > 0)
+	    TxPrintf("Read %.1f MB in %.2f seconds (%.1f MB/s)\n",
+			(double)calmaInBytes / 1.0e6, seconds,
+			(double)calmaInBytes / 1.0e6 / seconds);
+	if (preread)
+	{
+	    preseconds = (double)(preend.tv_sec - prestart.tv_sec)
+			+ (double)(preend.tv_usec - prestart.tv_usec) / 1.0e6;
+	    TxPrintf("    Parsing polygons took %.2f seconds, painting "
+			"and the rest %.2f seconds\n", preseconds,
+			(double)(now.tv_sec - preend.tv_sec)
+			+ (double)(now.tv_usec - preend.tv_usec) / 1.0e6);
+	}
+    }
+    if (preread) calmaPreFree();
+    calmaInputClose();
+
     /* Added by Nishit, Sept. 2004---Load cell read from GDS    */
     /* stream file to the magic layout window.  If this fails   */
     /* then we do the original action and don't do a load into  */
@@ -352,7 +391,6 @@ calmaParseUnits(void)
     int nbytes, rtype = 0;
     double metersPerDBUnit;
     double userUnitsPerDBUnit;
-    double cuPerDBUnit;
     bool compatible;
 
     READRH(nbytes, rtype);
@@ -412,6 +450,33 @@ calmaParseUnits(void)
     TxPrintf("1 meter equals %e database units\n", 1.0/metersPerDBUnit);
 #endif	/* notdef */
 
+    calmaSetScale(metersPerDBUnit);
+    return (TRUE);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaSetScale --
+ *
+ * Set calmaReadScale1 and calmaReadScale2 for input whose database
+ * unit is "metersPerDBUnit" meters.  Used for both GDS-II and OASIS.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets calmaReadScale1 and calmaReadScale2.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaSetScale(
+    double metersPerDBUnit)
+{
+    double cuPerDBUnit;
+
     /* Meters per database unit (1.0e8 corresponds to traditional centimicrons) */
     cuPerDBUnit = metersPerDBUnit * 1.0e8 * cifCurReadStyle->crs_multiplier;
 
@@ -434,8 +499,6 @@ calmaParseUnits(void)
 #ifdef	notdef
     TxPrintf("All units to be scaled by %d/%d\n", calmaReadScale1, calmaReadScale2);
 #endif	/* notdef */
-
-    return (TRUE);
 }
 
 /*
@@ -469,7 +532,7 @@ CalmaReadError(const char *format, ...)
 
     if ((calmaTotalErrors < 100) || (CIFWarningLevel != CIF_WARN_LIMIT))
     {
-	filepos = FTELL(calmaInputFile);
+	filepos = calmaInTell();
 
         if (CIFWarningLevel == CIF_WARN_REDIRECT)
         {
@@ -2,6 +2,8 @@
  * CalmaWrite.c --
  *
  * Output of Calma GDS-II stream format.
+ * Records are written to a CalmaStream (see CalmaOutput.c), so the same
+ * code writes plain and compressed files.
  *
  *     *********************************************************************
  *     * Copyright (C) 1985, 1990 Regents of the University of California. *
@@ -59,7 +61,7 @@ static const char rcsid[] __attribute__ ((unused)) ="$Header: /usr/cvsroot/magic
 #include "calma/calmaInt.h"
 #include "extract/extractInt.h"	/* for LabelList */
 #include "utils/main.h"		/* for Path and CellLibPath */
-#include "utils/stack.h"
+#include "utils/workers.h"
 
 /* C99 compat */
 #include "utils/undo.h"
@@ -70,10 +72,14 @@ bool CalmaDoLibrary = FALSE;	  /* If TRUE, do not output the top level */
 bool CalmaDoLabels = TRUE;	  /* If FALSE, don't output labels with GDS-II */
 bool CalmaDoLower = TRUE;	  /* If TRUE, allow lowercase labels. */
 bool CalmaFlattenArrays = FALSE;  /* If TRUE, output arrays as individual uses */
+bool CalmaAutoArrays = FALSE;	  /* If TRUE, output regular grids of uses as arrays */
 bool CalmaAddendum = FALSE;	  /* If TRUE, do not output readonly cell defs */
 time_t *CalmaDateStamp = NULL;	  /* If non-NULL, output this for creation date stamp */
 bool CalmaAllowUndefined = FALSE; /* If TRUE, allow calls to undefined cells */
 bool CalmaAllowAbstract = FALSE;  /* If TRUE, allow abstract views to be written */
+int  CalmaWriteThreads = 1;	  /* Threads generating the CIF of cells for
+				   * output (0 = one per CPU)
+				   */
 
     /* Experimental stuff---not thoroughly tested.  In particular, the 	*/
     /* array generation of CalmaContactArrays is different from that	*/
@@ -90,44 +96,109 @@ int  CalmaCompression = 0;	/* Output file compression level (0 = uncompressed) *
 /* Structure used by calmaWritePaintFunc() */
 
 typedef struct {
-   FILE *f;		/* File stream for output		*/
+   CalmaStream *f;	/* Stream for output			*/
    const Rect *area;	/* Clipping area, in GDS coordinates	*/
    int type;		/* Layer index				*/
 } calmaOutputStruct;
 
+/* Cells whose CIF is generated ahead of output by a pool of threads
+ * (see calmaGenPlan()), in the order in which they will be output.
+ */
+
+static CIFGenCell **calmaGenList = NULL;
+static int calmaGenCount = 0;	/* Number of entries in calmaGenList */
+static int calmaGenSize = 0;	/* Space allocated for calmaGenList */
+static int calmaGenThreads = 1;	/* Number of threads to use */
+static HashTable calmaGenHash;	/* Maps each def to its index + 1 */
+static bool calmaGenActive = FALSE;	/* TRUE while the list is in use */
+
+/* Client data passed by calmaGenPlanDef() to calmaGenPlanUse() */
+
+typedef struct {
+    ClientData cgp_cdata;	/* Output stream, passed to CIFGen */
+    HashTable *cgp_visited;	/* Defs already seen */
+} calmaGenPlanArgs;
+
+/* Number of cells generated ahead of output, per thread */
+#define CALMA_GEN_BATCH	4
+
     /* Forward declarations */
 extern int calmaWriteInitFunc(CellDef *def, ClientData cdata);	/* UNUSED */
 extern int calmaWritePaintFunc(Tile *tile, TileType dinfo, calmaOutputStruct *cos);
-extern int calmaMergePaintFunc(Tile *tile, TileType dinfo, calmaOutputStruct *cos);
-extern int calmaWriteUseFunc(CellUse *use, FILE *f);
+extern int calmaWriteUseFunc(CellUse *use, CalmaStream *f);
 extern int calmaPaintLabelFunc(Tile *tile, TileType dinfo, calmaOutputStruct *cos);
-extern void calmaWriteContacts(FILE *f);
+extern void calmaWriteContacts(CalmaStream *f);
 extern void calmaDelContacts(void);
-extern void calmaOutFunc(CellDef *def, FILE *f, const Rect *cliprect);
-extern void calmaOutStructName(int type, CellDef *def, FILE *f);
-extern void calmaWriteLabelFunc(Label *lab, int ltype, int type, FILE *f);
-extern void calmaOutHeader(CellDef *rootDef, FILE *f);
-extern void calmaOutDate(time_t t, FILE *f);
-extern void calmaOutStringRecord(int type, char *str, FILE *f);
-extern void calmaOut8(const char *str, FILE *f);
-extern void calmaOutR8(double d, FILE *f);
-extern void calmaProcessBoundary(BoundaryTop *blist, calmaOutputStruct *cos);
-extern void calmaRemoveColinear(BoundaryTop *blist);
-extern void calmaRemoveDegenerate(BoundaryTop *blist);
+extern void calmaOutFunc(CellDef *def, CalmaStream *f, const Rect *cliprect);
+extern void calmaOutStructName(int type, CellDef *def, CalmaStream *f);
+extern void calmaWriteLabelFunc(Label *lab, int ltype, int type, CalmaStream *f);
+extern void calmaOutHeader(CellDef *rootDef, CalmaStream *f);
+extern void calmaOutDate(time_t t, CalmaStream *f);
+extern void calmaOutStringRecord(int type, char *str, CalmaStream *f);
+extern void calmaOut8(const char *str, CalmaStream *f);
+extern void calmaOutR8(double d, CalmaStream *f);
+extern bool calmaWriteStream(CellDef *rootDef, CalmaStream *f);
+extern void calmaGenPlanDef(CellDef *def, bool do_library, ClientData cdata, HashTable *visited);
+extern int calmaGenPlanUse(CellUse *use, calmaGenPlanArgs *args);
+extern void calmaMergeLayer(Plane *plane, const Rect *cliprect, calmaOutputStruct *cos);
+extern void calmaWriteUses(CellDef *def, CalmaStream *f);
+
+/*--------------------------------------------------------------*/
+/* Structures used to find arrays of uses ("gds autoarray")	*/
+/*--------------------------------------------------------------*/
+
+/* Largest number of rows or columns in a GDS array reference */
+
+#define CALMA_ARRAY_MAX		32767
+
+/* An evenly spaced row of uses of the same cell and orientation */
+
+typedef struct {
+    int ar_start;	/* Index of the first use in calmaArrayList */
+    int ar_count;	/* Number of uses in the row */
+    int ar_x, ar_y;	/* Position of the first use */
+    int ar_xsep;	/* Spacing of the uses, or 0 for a single use */
+} CalmaArrayRow;
+
+/* Single uses of the cell being written */
+
+static CellUse **calmaArrayList = NULL;
+static int calmaArrayCount = 0;		/* Number of uses in calmaArrayList */
+static int calmaArraySize = 0;		/* Space allocated for calmaArrayList */
 
 /*--------------------------------------------------------------*/
 /* Structures used by the tile merging algorithm 		*/
 /*--------------------------------------------------------------*/
 
-#define GDS_PENDING	0
-#define GDS_UNPROCESSED CLIENTDEFAULT
-#define GDS_PROCESSED	1
+/* Largest number of points in a GDS boundary, not counting the	*/
+/* repeated first point:  the XY record holds at most 8191 points.	*/
 
-#define PUSHTILEC(tp) \
-    if (TiGetClient(tp) == GDS_UNPROCESSED) { \
-	TiSetClientINT(tp, GDS_PENDING); \
-	STACKPUSH((ClientData) (tp), SegStack); \
-    }
+#define CALMA_POLYGON_MAX	8190
+
+/* A vertex of a polygon being built.  Vertices are linked in	*/
+/* counterclockwise order around the polygon.			*/
+
+typedef struct calmavertex {
+    Point		 cv_point;
+    struct calmavertex	*cv_next;	/* Next vertex counterclockwise	*/
+    struct calmapolygon	*cv_poly;	/* Polygon of the vertex's tile	*/
+} CalmaVertex;
+
+/* A polygon being built, one per tile to start with.  Polygons	*/
+/* that have been merged form a tree whose root holds the total.	*/
+
+typedef struct calmapolygon {
+    struct calmapolygon	*cp_parent;	/* Polygon merged into, or NULL	*/
+    CalmaVertex		*cp_start;	/* Any vertex of the polygon	*/
+    Tile		*cp_tile;	/* Tile the polygon started as	*/
+    int			 cp_points;	/* Number of vertices		*/
+} CalmaPolygon;
+
+/* Tiles of the layer being merged, and space for their polygons */
+
+static Tile **calmaMergeList = NULL;
+static int calmaMergeCount = 0;		/* Number of tiles in calmaMergeList */
+static int calmaMergeSize = 0;		/* Space allocated for calmaMergeList */
 
 /*--------------------------------------------------------------*/
 
@@ -173,7 +244,7 @@ HashTable calmaUndefHash;
  * and a one-byte data type.
  */
 #define	calmaOutRH(count, type, datatype, f) \
-    { calmaOutI2(count, f); (void) putc(type, f); (void) putc(datatype, f); }
+    { calmaOutI2(count, f); (void) calmaPutc(type, f); (void) calmaPutc(datatype, f); }
 
 /*
  * calmaOutI2 --
@@ -186,8 +257,8 @@ HashTable calmaUndefHash;
     { \
 	union { short u_s; char u_c[2]; } u; \
 	u.u_s = htons(n); \
-	(void) putc(u.u_c[0], f); \
-	(void) putc(u.u_c[1], f); \
+	(void) calmaPutc(u.u_c[0], f); \
+	(void) calmaPutc(u.u_c[1], f); \
     }
 /*
  * calmaOutI4 --
@@ -200,10 +271,10 @@ HashTable calmaUndefHash;
     { \
 	union { long u_i; char u_c[4]; } u; \
 	u.u_i = htonl(n); \
-	(void) putc(u.u_c[0], f); \
-	(void) putc(u.u_c[1], f); \
-	(void) putc(u.u_c[2], f); \
-	(void) putc(u.u_c[3], f); \
+	(void) calmaPutc(u.u_c[0], f); \
+	(void) calmaPutc(u.u_c[1], f); \
+	(void) calmaPutc(u.u_c[2], f); \
+	(void) calmaPutc(u.u_c[3], f); \
     }
 
 static const char calmaMapTableStrict[] =
@@ -286,7 +357,100 @@ CalmaWrite(
     CellDef *rootDef,	/* Pointer to CellDef to be written */
     FILE *f)		/* Open output file */
 {
-    int oldCount = DBWFeedbackCount, problems, nerr;
+    CalmaStream cs;
+
+    calmaStreamInit(&cs, CALMA_STREAM_FILE, (ClientData)f, 0, 1);
+    return calmaWriteStream(rootDef, &cs);
+}
+
+#ifdef HAVE_ZLIB
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CalmaWriteZ --
+ *
+ * Same as CalmaWrite(), but the output is compressed through the zlib
+ * stream 'f'.
+ *
+ * Results:
+ *	TRUE if the cell could be written successfully, FALSE otherwise.
+ *
+ * Side effects:
+ *	Writes a file to disk.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+CalmaWriteZ(
+    CellDef *rootDef,	/* Pointer to CellDef to be written */
+    gzFile f)		/* Open compressed output file */
+{
+    CalmaStream cs;
+
+    calmaStreamInit(&cs, CALMA_STREAM_GZIP, (ClientData)f, 0, 1);
+    return calmaWriteStream(rootDef, &cs);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CalmaWriteZParallel --
+ *
+ * Same as CalmaWriteZ(), but the output is written to the plain file
+ * 'f' as a series of gzip members that are compressed concurrently by
+ * CalmaWriteThreads threads.  The file decompresses to exactly the
+ * same stream as that written by CalmaWriteZ(), but the compressed
+ * bytes differ.
+ *
+ * Results:
+ *	TRUE if the cell could be written successfully, FALSE otherwise.
+ *
+ * Side effects:
+ *	Writes a file to disk.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+CalmaWriteZParallel(
+    CellDef *rootDef,	/* Pointer to CellDef to be written */
+    FILE *f,		/* Open output file */
+    int level)		/* Compression level, 1 to 9 */
+{
+    CalmaStream cs;
+
+    calmaStreamInit(&cs, CALMA_STREAM_PGZIP, (ClientData)f, level,
+		CalmaWriteThreads);
+    return calmaWriteStream(rootDef, &cs);
+}
+
+#endif	/* HAVE_ZLIB */
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaWriteStream --
+ *
+ * Common part of CalmaWrite() and its variants:  write the tree rooted
+ * at rootDef to the stream 'f'.
+ *
+ * Results:
+ *	TRUE if the cell could be written successfully, FALSE otherwise.
+ *
+ * Side effects:
+ *	Writes to the stream, then closes it (see calmaStreamClose()).
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaWriteStream(
+    CellDef *rootDef,	/* Pointer to CellDef to be written */
+    CalmaStream *f)	/* Output stream */
+{
+    int oldCount = DBWFeedbackCount, problems;
     bool good;
     CellDef *err_def;
     CellUse dummy;
@@ -300,6 +464,7 @@ CalmaWrite(
     if (!CIFCurStyle)
     {
 	TxError("No CIF/GDS output style set!\n");
+	(void) calmaStreamClose(f);
 	return FALSE;
     }
 
@@ -319,6 +484,7 @@ CalmaWrite(
     {
 	TxError("Failure to read entire subtree of the cell.\n");
 	TxError("Failed on cell %s.\n", err_def->cd_name);
+	(void) calmaStreamClose(f);
 	return FALSE;
     }
 
@@ -347,6 +513,7 @@ CalmaWrite(
      * to insure that each child cell is output before it is used.  The
      * root cell is output last.
      */
+    calmaGenPlan(rootDef, CalmaDoLibrary, (ClientData)f);
     good = (calmaProcessDef(rootDef, f, CalmaDoLibrary) == 0) ? TRUE : FALSE;
 
     /*
@@ -376,10 +543,11 @@ CalmaWrite(
 	}
     }
 
+    calmaGenDone();
+
     /* Finish up by outputting the end-of-library marker */
     calmaOutRH(4, CALMA_ENDLIB, CALMA_NODATA, f);
-    fflush(f);
-    if (ferror(f)) good = FALSE;
+    if (!calmaStreamClose(f)) good = FALSE;
 
     /* See if any problems occurred */
     if ((problems = (DBWFeedbackCount - oldCount)))
@@ -414,7 +582,7 @@ CalmaWrite(
 bool
 calmaDumpStructure(
     CellDef *def,
-    FILE *outf,
+    CalmaStream *outf,
     HashTable *calmaDefHash,
     char *filename)
 {
@@ -590,14 +758,14 @@ calmaDumpStructure(
 	int datatype;
 
 	READI2(nbytes);
-	if (FEOF(calmaInputFile))
+	if (calmaEOF())
 	{
 	    /* Unexpected end-of-file */
-	    FSEEK(calmaInputFile, -(CALMAHEADERLENGTH), SEEK_END);
+	    calmaInSeek(-(CALMAHEADERLENGTH), SEEK_END);
 	    break;
 	}
-	rtype = FGETC(calmaInputFile);
-	datatype = FGETC(calmaInputFile);
+	rtype = calmaGetc();
+	datatype = calmaGetc();
 	switch (rtype) {
 	    case CALMA_BGNSTR:
 		UNREADRH(nbytes, rtype);
@@ -644,16 +812,16 @@ calmaDumpStructure(
 		while (nbytes-- > 0)
 		{
 		    int byte;
-		    if ((byte = FGETC(calmaInputFile)) < 0)
+		    if ((byte = calmaGetc()) < 0)
 		    {
 			TxError("End of file with %d bytes remaining to be read.\n",
 				nbytes);
 			while (nbytes-- > 0)
-			    putc(0, outf);	// zero-pad output
+			    calmaPutc(0, outf);	// zero-pad output
 			return (FALSE);
 		    }
 		    else
-			putc(byte, outf);
+			calmaPutc(byte, outf);
 		}
 		break;
 	}
@@ -685,7 +853,7 @@ void
 calmaFullDump(
     CellDef *def,
     FILETYPE fi,
-    FILE *outf,
+    CalmaStream *outf,
     char *filename)
 {
     int version, rval;
@@ -705,7 +873,7 @@ calmaFullDump(
     HashInit(&calmaDefHash, 32, 0);
 
     cifReadCellDef = def;
-    calmaInputFile = fi;
+    calmaInputOpen(fi, filename);
 
     /* Read and ignore the GDS-II header */
 
@@ -722,6 +890,7 @@ calmaFullDump(
     if (calmaParseUnits() == FALSE)
     {
 	TxError("Error:  Library %s has incompatible database units!\n", libname);
+	calmaInputClose();
 	return;
     }
 
@@ -730,6 +899,7 @@ calmaFullDump(
     if ((char *)HashGetValue(he) != NULL)
     {
     	TxPrintf("Library %s has already been processed\n", libname);
+	calmaInputClose();
 	return;
     }
 
@@ -805,6 +975,7 @@ done:
 
     HashFreeKill(&calmaDefHash);
     if (libname != NULL) freeMagic(libname);
+    calmaInputClose();
     return;
 }
 
@@ -861,7 +1032,7 @@ calmaWriteInitFunc(
 int
 calmaProcessUse(
     CellUse *use,	/* Process use->cu_def */
-    FILE *outf)		/* Stream file */
+    CalmaStream *outf)	/* Stream file */
 {
     return (calmaProcessDef(use->cu_def, outf, FALSE));
 }
@@ -869,7 +1040,7 @@ calmaProcessUse(
 int
 calmaProcessDef(
     CellDef *def,	/* Output this def's children, then the def itself */
-    FILE *outf,		/* Stream file */
+    CalmaStream *outf,	/* Stream file */
     bool do_library)	/* If TRUE, output only children of def, but not def */
 {
     char *filename;
@@ -1203,7 +1374,7 @@ calmaProcessDef(
 			calmaOutStructName(CALMA_STRNAME, def, outf);
 		    }
 
-		    numbytes = fwrite(buffer, sizeof(char), (size_t)defsize, outf);
+		    numbytes = calmaStreamWrite(outf, buffer, (size_t)defsize);
 		    if (numbytes != defsize)
 		    {
 			/* The structure header has already been written, so	*/
@@ -1318,7 +1489,7 @@ compport(const void *one, const void *two)
 void
 calmaOutFunc(
     CellDef *def,	/* Pointer to cell def to be written */
-    FILE *f,		/* Open output file */
+    CalmaStream *f,	/* Open output file */
     const Rect *cliprect)/* Area to clip to (used for contact cells),
 			 * in CIF/GDS coordinates.
 			 */
@@ -1327,10 +1498,7 @@ calmaOutFunc(
     CIFLayer *layer;
     Rect bigArea;
     int type;
-    int dbunits;
     calmaOutputStruct cos;
-    bool propfound;
-    PropertyRecord *proprec;
 
     cos.f = f;
     cos.area = (cliprect == &TiPlaneRect) ? NULL : cliprect;
@@ -1347,67 +1515,25 @@ calmaOutFunc(
     /* Output structure name */
     calmaOutStructName(CALMA_STRNAME, def, f);
 
-    /* Since Calma database units are nanometers, multiply all units by 10,
-     * modified by the scale multiplier.
-     */
-
-    dbunits = (CIFCurStyle->cs_flags & CWF_ANGSTROMS) ? 100 : 10;
-    if ((dbunits % CIFCurStyle->cs_expander) == 0)
-    {
-	calmaWriteScale = CIFCurStyle->cs_scaleFactor * dbunits
-		/ CIFCurStyle->cs_expander;
-	calmaPaintScale = dbunits / CIFCurStyle->cs_expander;
-    }
-    else
-    {
-	TxError("Calma output error:  Output scale units are %2.1f nanometers.\n",
-		(float)dbunits / (float)CIFCurStyle->cs_expander);
-	TxError("Magic Calma output will be scaled incorrectly!\n");
-	if ((dbunits == 10) && ((100 % CIFCurStyle->cs_expander) == 0))
-	{
-	    TxError("Please add \"units angstroms\" to the cifoutput section"
-			" of the techfile.\n");
-	}
-	else
-	{
-	    TxError("Magic GDS output is limited to a minimum dimension of"
-			" 1 angstrom.\n");
-	}
-	/* Set expander to 10 so output scales are not zero. */
-	calmaWriteScale = CIFCurStyle->cs_scaleFactor;
-	calmaPaintScale = 1;
-    }
+    calmaOutScale();
 
     /*
      * Output the calls that the child makes to its children.  For
      * arrays we output a single call, unlike CIF, since Calma
-     * supports the notion of arrays.
+     * supports the notion of arrays.  With "gds autoarray", regular
+     * grids of single uses are output as arrays, too.
      */
-    (void) DBCellEnum(def, calmaWriteUseFunc, (ClientData) f);
+    if (CalmaAutoArrays && !CalmaFlattenArrays)
+	calmaWriteUses(def, f);
+    else
+	(void) DBCellEnum(def, calmaWriteUseFunc, (ClientData) f);
 
     /* Output all the tiles associated with this cell; skip temporary layers */
-    GEO_EXPAND(&def->cd_bbox, CIFCurStyle->cs_radius, &bigArea);
-
-    /* Include any fixed bounding box as part of the area to process,	*/
-    /* in case the fixed bounding box is larger than the geometry.	*/
-    proprec = DBPropGet(def, "FIXED_BBOX", &propfound);
-    if (propfound)
-    {
-	Rect bbox;
-
-	if ((proprec->prop_type == PROPERTY_TYPE_DIMENSION) &&
-			(proprec->prop_len == 4))
-	{
-	    bbox.r_xbot = proprec->prop_value.prop_integer[0];
-	    bbox.r_ybot = proprec->prop_value.prop_integer[1];
-	    bbox.r_xtop = proprec->prop_value.prop_integer[2];
-	    bbox.r_ytop = proprec->prop_value.prop_integer[3];
-	    GeoInclude(&bbox, &bigArea);
-	}
-    }
+    calmaOutArea(def, &bigArea);
 
     CIFErrorDef = def;
-    CIFGen(def, def, &bigArea, CIFPlanes, &DBAllTypeBits, TRUE, TRUE, FALSE,
+    if (!calmaGenTake(def, &bigArea))
+	CIFGen(def, def, &bigArea, CIFPlanes, &DBAllTypeBits, TRUE, TRUE, FALSE,
 		(ClientData)f);
 
     if (!CIFHierWriteDisable)
@@ -1428,10 +1554,11 @@ calmaOutFunc(
 	    DBSrPaintArea((Tile *) NULL, CIFPlanes[type],
 		    cliprect, &CIFSolidBits, calmaPaintLabelFunc,
 		    (ClientData) &cos);
+	else if (CalmaMergeTiles)
+	    calmaMergeLayer(CIFPlanes[type], cliprect, &cos);
 	else
 	    DBSrPaintArea((Tile *) NULL, CIFPlanes[type],
-		    cliprect, &CIFSolidBits, (CalmaMergeTiles) ?
-		    calmaMergePaintFunc : calmaWritePaintFunc,
+		    cliprect, &CIFSolidBits, calmaWritePaintFunc,
 		    (ClientData) &cos);
     }
 
@@ -1501,119 +1628,413 @@ calmaOutFunc(
 /*
  * ----------------------------------------------------------------------------
  *
- * calmaIsUseNameDefault --
+ * calmaOutScale --
  *
- * Determine if this use name is not default; that is, it is not the name
- * of the cell def followed by an underscore and a use index number.  If
- * it is not default, then we want to write out the use name as a property
- * in the GDS stream file so that we can recover the name when the file is
- * read back into magic.
+ * Set the scale of the output from the current CIF output style:
+ * calmaWriteScale converts magic units to database units (nanometers,
+ * or angstroms with "units angstroms"), and calmaPaintScale converts
+ * CIF units to database units.
  *
  * Results:
- *	TRUE if the cell use ID is a default name; FALSE if not.
- *
- * Side Effects:
  *	None.
  *
+ * Side effects:
+ *	Sets calmaWriteScale and calmaPaintScale.  Complains if the
+ *	output units can't represent the style's scale exactly.
+ *
  * ----------------------------------------------------------------------------
  */
 
-bool
-calmaIsUseNameDefault(
-    char *defName,
-    char *useName)
+void
+calmaOutScale(void)
 {
-    int idx, slen;
-    char *sptr;
+    int dbunits;
 
-    if (useName == NULL) return TRUE;
-    slen = strlen(defName);
-    if (!strncmp(defName, useName, slen))
+    /* Since Calma database units are nanometers, multiply all units by 10,
+     * modified by the scale multiplier.
+     */
+
+    dbunits = (CIFCurStyle->cs_flags & CWF_ANGSTROMS) ? 100 : 10;
+    if ((dbunits % CIFCurStyle->cs_expander) == 0)
     {
-	sptr = useName + slen;
-	if (*sptr != '_') return FALSE;
-	else sptr++;
-	if (sscanf(sptr, "%d", &idx) != 1) return FALSE;
-	else return TRUE;
+	calmaWriteScale = CIFCurStyle->cs_scaleFactor * dbunits
+		/ CIFCurStyle->cs_expander;
+	calmaPaintScale = dbunits / CIFCurStyle->cs_expander;
+    }
+    else
+    {
+	TxError("Calma output error:  Output scale units are %2.1f nanometers.\n",
+		(float)dbunits / (float)CIFCurStyle->cs_expander);
+	TxError("Magic Calma output will be scaled incorrectly!\n");
+	if ((dbunits == 10) && ((100 % CIFCurStyle->cs_expander) == 0))
+	{
+	    TxError("Please add \"units angstroms\" to the cifoutput section"
+			" of the techfile.\n");
+	}
+	else
+	{
+	    TxError("Magic GDS output is limited to a minimum dimension of"
+			" 1 angstrom.\n");
+	}
+	/* Set expander to 10 so output scales are not zero. */
+	calmaWriteScale = CIFCurStyle->cs_scaleFactor;
+	calmaPaintScale = 1;
     }
-    return FALSE;
 }
 
 /*
  * ----------------------------------------------------------------------------
  *
- * calmaWriteUseFunc --
+ * calmaOutArea --
  *
- * Filter function, called by DBCellEnum on behalf of calmaOutFunc above,
- * to write out each CellUse called by the CellDef being output.  If the
- * CellUse is an array, we output it as a single array instead of as
- * individual uses like CIF.
+ * Find the area of a cell for which CIF is generated on output:  the
+ * bounding box of the cell, expanded by the CIF halo and including any
+ * fixed bounding box, in case that is larger than the geometry.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Appends to the open Calma output file.
+ *	Sets *area.
  *
  * ----------------------------------------------------------------------------
  */
 
-int
-calmaWriteUseFunc(
-    CellUse *use,
-    FILE *f)
+void
+calmaOutArea(
+    CellDef *def,	/* Cell to be written */
+    Rect *area)		/* Filled in with the area to generate */
 {
-    /*
-     * r90, r180, and r270 are Calma 8-byte real representations
-     * of the angles 90, 180, and 270 degrees.  Because there are
-     * only 4 possible values, it is faster to have them pre-computed
-     * than to format with calmaOutR8().
-     */
-    static const unsigned char r90[] = { 0x42, 0x5a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-    static const unsigned char r180[] = { 0x42, 0xb4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
-    static const unsigned char r270[] = { 0x43, 0x10, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00 };
-    const unsigned char *whichangle;
-    int x, y, topx, topy, rows, cols, xxlate, yxlate, hdrsize;
-    int rectype, stransflags;
-    Transform *t;
-    bool isArray = FALSE;
-    Point p, p2;
+    PropertyRecord *proprec;
+    bool propfound;
+    Rect bbox;
 
-    topx = use->cu_xhi - use->cu_xlo;
-    if (topx < 0) topx = -topx;
-    topy = use->cu_yhi - use->cu_ylo;
-    if (topy < 0) topy = -topy;
+    GEO_EXPAND(&def->cd_bbox, CIFCurStyle->cs_radius, area);
 
-    /*
-     * The following translates from the abcdef transforms that
-     * we use internally to the rotation and mirroring specification
-     * used in Calma stream files.  It only works because orientations
-     * are orthogonal in magic, and no scaling is allowed in cell use
-     * transforms.  Thus the elements a, b, d, and e always have one
-     * of the following forms:
-     *
-     *		a  d
-     *		b  e
-     *
-     * (counterclockwise rotations of 0, 90, 180, 270 degrees)
-     *
-     *	1  0	0  1	-1  0	 0 -1
-     *	0  1   -1  0	 0 -1	 1  0
-     *
-     * (mirrored across the x-axis before counterclockwise rotation
-     * by 0, 90, 180, 270 degrees):
-     *
-     *	1  0    0  1    -1  0    0 -1
-     *	0 -1    1  0     0  1   -1  0
-     *
-     * Note that mirroring must be done if either a != e, or
-     * a == 0 and b == d.
-     *
-     */
-    t = &use->cu_transform;
-    stransflags = 0;
-    whichangle = (t->t_a == -1) ? r180 : (unsigned char *) NULL;
-    if (t->t_a != t->t_e || (t->t_a == 0 && t->t_b == t->t_d))
+    proprec = DBPropGet(def, "FIXED_BBOX", &propfound);
+    if (propfound)
+    {
+	if ((proprec->prop_type == PROPERTY_TYPE_DIMENSION) &&
+			(proprec->prop_len == 4))
+	{
+	    bbox.r_xbot = proprec->prop_value.prop_integer[0];
+	    bbox.r_ybot = proprec->prop_value.prop_integer[1];
+	    bbox.r_xtop = proprec->prop_value.prop_integer[2];
+	    bbox.r_ytop = proprec->prop_value.prop_integer[3];
+	    GeoInclude(&bbox, area);
+	}
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaGenPlan --
+ *
+ * When writing with more than one thread (CalmaWriteThreads), list the
+ * cells that calmaProcessDef() will write from the database, in the order
+ * in which it will write them, so that their CIF can be generated ahead
+ * of time by a pool of threads.  The list follows the same traversal as
+ * calmaProcessDef(), but if it should differ, cells not on the list are
+ * simply generated when they are written, and the CIF of cells on the
+ * list that are never written is thrown away.
+ *
+ * Only the CIF of each cell's own paint is generated ahead.  Interactions
+ * between subcells (CIFGenSubcells() and CIFGenArrays()) and the output
+ * itself are still done in order, one cell at a time, so the output is
+ * the same as when writing with one thread.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets up the list used by calmaGenTake().  calmaGenDone() must be
+ *	called when output is complete.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaGenPlan(
+    CellDef *rootDef,	/* Root of the tree to be written */
+    bool do_library,	/* As for calmaProcessDef() */
+    ClientData cdata)	/* Output stream, passed to CIFGen */
+{
+    HashTable visited;
+
+    if (CalmaWriteThreads == 1) return;
+    calmaGenThreads = WorkerCount(CalmaWriteThreads);
+    if (calmaGenThreads <= 1) return;
+    if (!CIFGenCellsOK())
+    {
+	TxPrintf("The output style can't generate cells concurrently;"
+		" using one thread.\n");
+	return;
+    }
+
+    HashInit(&calmaGenHash, 64, HT_WORDKEYS);
+    calmaGenActive = TRUE;
+    HashInit(&visited, 64, HT_WORDKEYS);
+    calmaGenPlanDef(rootDef, do_library, cdata, &visited);
+    HashKill(&visited);
+}
+
+void
+calmaGenPlanDef(
+    CellDef *def,	/* List this def's children, then the def itself */
+    bool do_library,	/* If TRUE, list only the children of def */
+    ClientData cdata,	/* Output stream, passed to CIFGen */
+    HashTable *visited)	/* Defs already seen */
+{
+    CIFGenCell **newList;
+    HashEntry *he;
+    Rect area;
+    bool isReadOnly, hasContent, hasGDSEnd;
+
+    he = HashFind(visited, (char *)def);
+    if (HashGetValue(he) != NULL) return;
+    HashSetValue(he, (ClientData)1);
+
+    if ((def->cd_flags & CDAVAILABLE) == 0) return;
+
+    DBPropGet(def, "GDS_START", &hasContent);
+    DBPropGet(def, "GDS_END", &hasGDSEnd);
+    DBPropGetString(def, "GDS_FILE", &isReadOnly);
+    if (isReadOnly && hasContent && CalmaAddendum) return;
+
+    if (!hasContent || hasGDSEnd)
+    {
+	calmaGenPlanArgs args;
+
+	args.cgp_cdata = cdata;
+	args.cgp_visited = visited;
+	(void) DBCellEnum(def, calmaGenPlanUse, (ClientData)&args);
+    }
+
+    if (isReadOnly || do_library) return;
+
+    if (calmaGenCount == calmaGenSize)
+    {
+	calmaGenSize = (calmaGenSize == 0) ? 64 : calmaGenSize * 2;
+	newList = (CIFGenCell **)mallocMagic(calmaGenSize * sizeof(CIFGenCell *));
+	if (calmaGenList != NULL)
+	{
+	    memcpy(newList, calmaGenList, calmaGenCount * sizeof(CIFGenCell *));
+	    freeMagic((char *)calmaGenList);
+	}
+	calmaGenList = newList;
+    }
+    calmaOutArea(def, &area);
+    calmaGenList[calmaGenCount++] = CIFGenCellNew(def, &area, cdata);
+    he = HashFind(&calmaGenHash, (char *)def);
+    HashSetValue(he, INT2CD(calmaGenCount));
+}
+
+int
+calmaGenPlanUse(
+    CellUse *use,
+    calmaGenPlanArgs *args)
+{
+    calmaGenPlanDef(use->cu_def, FALSE, args->cgp_cdata, args->cgp_visited);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaGenTake --
+ *
+ * Called in place of CIFGen() when a cell is written.  If the cell was
+ * listed by calmaGenPlan(), hand over its CIF, first generating it along
+ * with the next few cells on the list if that has not been done yet.
+ *
+ * Results:
+ *	TRUE if CIFPlanes now holds the cell's CIF, FALSE if the caller
+ *	must generate it.
+ *
+ * Side effects:
+ *	Replaces the contents of CIFPlanes.  Reports errors found while
+ *	generating the cell, against CIFErrorDef.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaGenTake(
+    CellDef *def,	/* Cell being written */
+    const Rect *area)	/* Area of def to generate */
+{
+    CIFGenCell *cgc;
+    HashEntry *he;
+    int idx, n;
+
+    if (!calmaGenActive) return FALSE;
+    he = HashLookOnly(&calmaGenHash, (char *)def);
+    if (he == NULL) return FALSE;
+    idx = CD2INT(HashGetValue(he)) - 1;
+    cgc = calmaGenList[idx];
+    if ((cgc == NULL) || !GEO_SAMERECT(cgc->cgc_area, *area)) return FALSE;
+
+    if (!cgc->cgc_done)
+    {
+	n = MIN(calmaGenCount - idx, CALMA_GEN_BATCH * calmaGenThreads);
+	CIFGenCells(calmaGenList + idx, n, calmaGenThreads);
+    }
+    CIFGenCellTake(cgc, CIFPlanes);
+    CIFGenCellFree(cgc);
+    calmaGenList[idx] = (CIFGenCell *)NULL;
+    return TRUE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaGenDone --
+ *
+ * Throw away the list made by calmaGenPlan(), including the CIF of any
+ * cells that were generated but never written.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaGenDone(void)
+{
+    int i;
+
+    if (!calmaGenActive) return;
+    for (i = 0; i < calmaGenCount; i++)
+	if (calmaGenList[i] != NULL)
+	    CIFGenCellFree(calmaGenList[i]);
+    HashKill(&calmaGenHash);
+    if (calmaGenList != NULL) freeMagic((char *)calmaGenList);
+    calmaGenList = (CIFGenCell **)NULL;
+    calmaGenCount = calmaGenSize = 0;
+    calmaGenActive = FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaIsUseNameDefault --
+ *
+ * Determine if this use name is not default; that is, it is not the name
+ * of the cell def followed by an underscore and a use index number.  If
+ * it is not default, then we want to write out the use name as a property
+ * in the GDS stream file so that we can recover the name when the file is
+ * read back into magic.
+ *
+ * Results:
+ *	TRUE if the cell use ID is a default name; FALSE if not.
+ *
+ * Side Effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+calmaIsUseNameDefault(
+    char *defName,
+    char *useName)
+{
+    int idx, slen;
+    char *sptr;
+
+    if (useName == NULL) return TRUE;
+    slen = strlen(defName);
+    if (!strncmp(defName, useName, slen))
+    {
+	sptr = useName + slen;
+	if (*sptr != '_') return FALSE;
+	else sptr++;
+	if (sscanf(sptr, "%d", &idx) != 1) return FALSE;
+	else return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaWriteUseFunc --
+ *
+ * Filter function, called by DBCellEnum on behalf of calmaOutFunc above,
+ * to write out each CellUse called by the CellDef being output.  If the
+ * CellUse is an array, we output it as a single array instead of as
+ * individual uses like CIF.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends to the open Calma output file.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaWriteUseFunc(
+    CellUse *use,
+    CalmaStream *f)
+{
+    /*
+     * r90, r180, and r270 are Calma 8-byte real representations
+     * of the angles 90, 180, and 270 degrees.  Because there are
+     * only 4 possible values, it is faster to have them pre-computed
+     * than to format with calmaOutR8().
+     */
+    static const unsigned char r90[] = { 0x42, 0x5a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    static const unsigned char r180[] = { 0x42, 0xb4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    static const unsigned char r270[] = { 0x43, 0x10, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    const unsigned char *whichangle;
+    int x, y, topx, topy, rows, cols, xxlate, yxlate, hdrsize;
+    int rectype, stransflags;
+    Transform *t;
+    bool isArray = FALSE;
+    Point p, p2;
+
+    topx = use->cu_xhi - use->cu_xlo;
+    if (topx < 0) topx = -topx;
+    topy = use->cu_yhi - use->cu_ylo;
+    if (topy < 0) topy = -topy;
+
+    /*
+     * The following translates from the abcdef transforms that
+     * we use internally to the rotation and mirroring specification
+     * used in Calma stream files.  It only works because orientations
+     * are orthogonal in magic, and no scaling is allowed in cell use
+     * transforms.  Thus the elements a, b, d, and e always have one
+     * of the following forms:
+     *
+     *		a  d
+     *		b  e
+     *
+     * (counterclockwise rotations of 0, 90, 180, 270 degrees)
+     *
+     *	1  0	0  1	-1  0	 0 -1
+     *	0  1   -1  0	 0 -1	 1  0
+     *
+     * (mirrored across the x-axis before counterclockwise rotation
+     * by 0, 90, 180, 270 degrees):
+     *
+     *	1  0    0  1    -1  0    0 -1
+     *	0 -1    1  0     0  1   -1  0
+     *
+     * Note that mirroring must be done if either a != e, or
+     * a == 0 and b == d.
+     *
+     */
+    t = &use->cu_transform;
+    stransflags = 0;
+    whichangle = (t->t_a == -1) ? r180 : (unsigned char *) NULL;
+    if (t->t_a != t->t_e || (t->t_a == 0 && t->t_b == t->t_d))
     {
 	stransflags |= CALMA_STRANS_UPSIDEDOWN;
 	if (t->t_a == 0)
@@ -1748,11 +2169,313 @@ calmaWriteUseFunc(
 	    calmaOutStringRecord(CALMA_PROPVALUE, arraystr, f);
 	}
 
-	/* End of element */
-	calmaOutRH(4, CALMA_ENDEL, CALMA_NODATA, f);
+	/* End of element */
+	calmaOutRH(4, CALMA_ENDEL, CALMA_NODATA, f);
+    }
+
+    return (0);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaArrayCollectFunc --
+ *
+ * Filter function used by calmaWriteUses() to collect the single uses
+ * of a cell, which may be output as part of an array.  Uses that are
+ * already arrays are output right away.
+ *
+ * Results:
+ *	Always 0 to keep the search going.
+ *
+ * Side effects:
+ *	Adds the use to calmaArrayList, enlarging the list if needed,
+ *	or writes to the disk file.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaArrayCollectFunc(
+    CellUse *use,
+    CalmaStream *f)
+{
+    CellUse **newlist;
+
+    if ((use->cu_xlo != 0) || (use->cu_xhi != 0) ||
+		(use->cu_ylo != 0) || (use->cu_yhi != 0))
+	return calmaWriteUseFunc(use, f);
+
+    if (calmaArrayCount == calmaArraySize)
+    {
+	calmaArraySize = (calmaArraySize == 0) ? 1024 : calmaArraySize * 2;
+	newlist = (CellUse **)mallocMagic(calmaArraySize * sizeof(CellUse *));
+	if (calmaArrayCount > 0)
+	    memcpy(newlist, calmaArrayList, calmaArrayCount * sizeof(CellUse *));
+	if (calmaArrayList != NULL) freeMagic(calmaArrayList);
+	calmaArrayList = newlist;
+    }
+    calmaArrayList[calmaArrayCount++] = use;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaArrayCompareKey --
+ *
+ * Compare two uses by what must be the same for them to be part of
+ * one array:  the cell def, and the orientation.
+ *
+ * Results:
+ *	Negative, zero or positive, as for qsort().
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaArrayCompareKey(
+    CellUse *u1,
+    CellUse *u2)
+{
+    Transform *t1 = &u1->cu_transform;
+    Transform *t2 = &u2->cu_transform;
+    int cmp;
+
+    if (u1->cu_def != u2->cu_def)
+    {
+	cmp = strcmp(u1->cu_def->cd_name, u2->cu_def->cd_name);
+	if (cmp != 0) return cmp;
+    }
+    if (t1->t_a != t2->t_a) return (t1->t_a < t2->t_a) ? -1 : 1;
+    if (t1->t_b != t2->t_b) return (t1->t_b < t2->t_b) ? -1 : 1;
+    if (t1->t_d != t2->t_d) return (t1->t_d < t2->t_d) ? -1 : 1;
+    if (t1->t_e != t2->t_e) return (t1->t_e < t2->t_e) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaArrayCompareUses --
+ *
+ * Compare two uses for qsort(), ordering them by cell def and
+ * orientation, then from bottom to top and from left to right.
+ *
+ * Results:
+ *	Negative, zero or positive, as for qsort().
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaArrayCompareUses(
+    const void *one,
+    const void *two)
+{
+    CellUse *u1 = *((CellUse **)one);
+    CellUse *u2 = *((CellUse **)two);
+    int cmp;
+
+    cmp = calmaArrayCompareKey(u1, u2);
+    if (cmp != 0) return cmp;
+    if (u1->cu_transform.t_f != u2->cu_transform.t_f)
+	return (u1->cu_transform.t_f < u2->cu_transform.t_f) ? -1 : 1;
+    if (u1->cu_transform.t_c != u2->cu_transform.t_c)
+	return (u1->cu_transform.t_c < u2->cu_transform.t_c) ? -1 : 1;
+    return strcmp(u1->cu_id, u2->cu_id);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaArrayCompareRows --
+ *
+ * Compare two rows of uses for qsort(), ordering them so that rows
+ * that can be stacked into one array are together and run from
+ * bottom to top.
+ *
+ * Results:
+ *	Negative, zero or positive, as for qsort().
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+calmaArrayCompareRows(
+    const void *one,
+    const void *two)
+{
+    CalmaArrayRow *r1 = (CalmaArrayRow *)one;
+    CalmaArrayRow *r2 = (CalmaArrayRow *)two;
+    int cmp;
+
+    cmp = calmaArrayCompareKey(calmaArrayList[r1->ar_start],
+		calmaArrayList[r2->ar_start]);
+    if (cmp != 0) return cmp;
+    if (r1->ar_x != r2->ar_x) return (r1->ar_x < r2->ar_x) ? -1 : 1;
+    if (r1->ar_xsep != r2->ar_xsep) return (r1->ar_xsep < r2->ar_xsep) ? -1 : 1;
+    if (r1->ar_count != r2->ar_count) return (r1->ar_count < r2->ar_count) ? -1 : 1;
+    if (r1->ar_y != r2->ar_y) return (r1->ar_y < r2->ar_y) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * calmaWriteUses --
+ *
+ * Output the uses of a cell ("gds autoarray"), finding regular grids
+ * of single uses of the same cell with the same orientation and
+ * writing each grid as one array (AREF) instead of a structure
+ * reference (SREF) per use.
+ *
+ * The uses are sorted, and each horizontal line of uses is split into
+ * rows with an even spacing.  Rows of the same length and spacing that
+ * lie above one another at an even spacing are then stacked into two-
+ * dimensional arrays.  Rows and stacks are found greedily from left to
+ * right and from bottom to top.  Any use not in a row or stack of two
+ * or more is output as a single use.  Each array is output as a magic
+ * array whose columns follow the x axis of the cell, as GDS readers
+ * (including magic's) expect, and is named after one of its uses.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the disk file.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+calmaWriteUses(
+    CellDef *def,		/* Cell whose uses are to be written out */
+    CalmaStream *f)		/* Stream file */
+{
+    CalmaArrayRow *rows, *row;
+    CellUse *use, arrayUse;
+    Transform *t;
+    int i, j, k, nrows, nx, ny, xsep, ysep, x0, y0, col, rownum;
+
+    calmaArrayCount = 0;
+    (void) DBCellEnum(def, calmaArrayCollectFunc, (ClientData) f);
+    if (calmaArrayCount == 0) return;
+
+    qsort(calmaArrayList, calmaArrayCount, sizeof(CellUse *),
+		calmaArrayCompareUses);
+
+    /* Split each horizontal line of uses into evenly spaced rows */
+
+    rows = (CalmaArrayRow *)mallocMagic(calmaArrayCount * sizeof(CalmaArrayRow));
+    nrows = 0;
+    for (i = 0; i < calmaArrayCount; i = j)
+    {
+	use = calmaArrayList[i];
+	row = &rows[nrows++];
+	row->ar_start = i;
+	row->ar_x = use->cu_transform.t_c;
+	row->ar_y = use->cu_transform.t_f;
+	row->ar_xsep = 0;
+
+	for (j = i + 1; (j < calmaArrayCount) && (j - i < CALMA_ARRAY_MAX); j++)
+	{
+	    CellUse *next = calmaArrayList[j];
+	    CellUse *last = calmaArrayList[j - 1];
+
+	    if (next->cu_transform.t_f != row->ar_y) break;
+	    if (calmaArrayCompareKey(next, use) != 0) break;
+	    xsep = next->cu_transform.t_c - last->cu_transform.t_c;
+	    if (j == i + 1)
+	    {
+		if (xsep <= 0) break;
+		row->ar_xsep = xsep;
+	    }
+	    else if (xsep != row->ar_xsep) break;
+	}
+	row->ar_count = j - i;
+    }
+
+    /* Stack rows that match and are evenly spaced into arrays */
+
+    qsort(rows, nrows, sizeof(CalmaArrayRow), calmaArrayCompareRows);
+
+    for (i = 0; i < nrows; i = j)
+    {
+	row = &rows[i];
+	ysep = 0;
+	for (j = i + 1; (j < nrows) && (j - i < CALMA_ARRAY_MAX); j++)
+	{
+	    if (calmaArrayCompareRows(&rows[j], row) == 0) break;	/* Same y */
+	    if ((rows[j].ar_x != row->ar_x) || (rows[j].ar_xsep != row->ar_xsep)
+			|| (rows[j].ar_count != row->ar_count)) break;
+	    if (calmaArrayCompareKey(calmaArrayList[rows[j].ar_start],
+			calmaArrayList[row->ar_start]) != 0) break;
+	    if (j == i + 1)
+		ysep = rows[j].ar_y - row->ar_y;
+	    else if (rows[j].ar_y - rows[j - 1].ar_y != ysep) break;
+	}
+	nx = row->ar_count;
+	ny = j - i;
+
+	if ((nx == 1) && (ny == 1))
+	{
+	    calmaWriteUseFunc(calmaArrayList[row->ar_start], f);
+	    continue;
+	}
+
+	/* Express the grid as an array in the coordinates of the	*/
+	/* cell, starting from the corner where both array indices	*/
+	/* are lowest.							*/
+
+	use = calmaArrayList[row->ar_start];
+	t = &use->cu_transform;
+	x0 = row->ar_x;
+	y0 = row->ar_y;
+	if (t->t_a != 0)
+	{
+	    if (t->t_a < 0) x0 += (nx - 1) * row->ar_xsep;
+	    if (t->t_e < 0) y0 += (ny - 1) * ysep;
+	}
+	else
+	{
+	    if (t->t_b < 0) x0 += (nx - 1) * row->ar_xsep;
+	    if (t->t_d < 0) y0 += (ny - 1) * ysep;
+	}
+	col = (x0 == row->ar_x) ? 0 : nx - 1;
+	rownum = (y0 == row->ar_y) ? 0 : ny - 1;
+
+	arrayUse = *calmaArrayList[rows[i + rownum].ar_start + col];
+	arrayUse.cu_transform.t_c = x0;
+	arrayUse.cu_transform.t_f = y0;
+	arrayUse.cu_xlo = arrayUse.cu_ylo = 0;
+	if (t->t_a != 0)
+	{
+	    arrayUse.cu_xhi = nx - 1;
+	    arrayUse.cu_yhi = ny - 1;
+	    arrayUse.cu_xsep = row->ar_xsep;
+	    arrayUse.cu_ysep = ysep;
+	}
+	else
+	{
+	    arrayUse.cu_xhi = ny - 1;
+	    arrayUse.cu_yhi = nx - 1;
+	    arrayUse.cu_xsep = ysep;
+	    arrayUse.cu_ysep = row->ar_xsep;
+	}
+	calmaWriteUseFunc(&arrayUse, f);
     }
 
-    return (0);
+    freeMagic(rows);
 }
 
 /*
@@ -1777,7 +2500,7 @@ void
 calmaOutStructName(
     int type,
     CellDef *def,
-    FILE *f)
+    CalmaStream *f)
 {
     char *defname;
     unsigned char c;
@@ -1901,7 +2624,7 @@ calmaGetContactCell(
 
 bool
 CalmaGenerateArray(
-    FILE *f,		/* GDS output file */
+    CalmaStream *f,	/* GDS output file */
     TileType type,	/* Magic tile type of contact */
     int llx,
     int lly,		/* Lower-left hand coordinate of the array
@@ -1972,7 +2695,7 @@ CalmaGenerateArray(
 
 void
 calmaWriteContacts(
-    FILE *f)
+    CalmaStream *f)
 {
     TileType type;
     TileTypeBitMask tMask, *rMask;
@@ -2073,775 +2796,411 @@ calmaDelContacts(void)
 
 /*
  * ----------------------------------------------------------------------------
- * calmaAddSegment ---
  *
- * Process a new polygon edge, inserting it into a polygon record as
- * required.  If the edge is between a GDS layer and TT_SPACE, then
- * we insert a point record.  If the edge is between two tiles of the
- * same layer, then we insert a tile record.
+ * calmaMergeCollectFunc --
  *
- * Results:
- *	Return 1 if an internal segment was generated, 0 if an external
- *	segment was generate.  On error, return -1 (failure to find a
- *	connecting point; this shouldn't happen).
+ * Filter function used by calmaMergeLayer() to collect the tiles of a
+ * CIF plane.
  *
- *	Returns the current segment in the original pointer position (1st
- *	argument).  If segments are added in counterclockwise order, then
- *	this should be most efficient.
+ * Results:
+ *	Always 0 to keep the search going.
  *
  * Side effects:
- *	May allocate memory.
- * ---------------------------------------------------------------------------
+ *	Adds the tile to calmaMergeList, enlarging the list if needed.
+ *
+ * ----------------------------------------------------------------------------
  */
 
 int
-calmaAddSegment(
-    LinkedBoundary **lbptr,
-    bool poly_edge,
-    int p1x,
-    int p1y,
-    int p2x,
-    int p2y)
+calmaMergeCollectFunc(
+    Tile *tile,			/* Tile to be merged */
+    TileType dinfo,		/* Split tile information (unused) */
+    ClientData cdata)		/* (unused) */
 {
-    LinkedBoundary *newseg, *curseg, *stopseg;
-    bool startmatch = FALSE;
-    bool endmatch = FALSE;
+    Tile **newlist;
 
-    stopseg = NULL;
-    for (curseg = *lbptr; curseg != stopseg; curseg = curseg->lb_next)
+    if (calmaMergeCount == calmaMergeSize)
     {
-	stopseg = *lbptr;
-	if (curseg->lb_type == LB_INIT)
-	{
-	    if ((p1x == curseg->lb_start.p_x) && (p1y == curseg->lb_start.p_y))
-		startmatch = TRUE;
-
-	    if ((p2x == curseg->lb_next->lb_start.p_x) &&
-			(p2y == curseg->lb_next->lb_start.p_y))
-		endmatch = TRUE;
-
-	    if (startmatch && endmatch)
-	    {
-		/* Segment completes this edge */
-		curseg->lb_type = (poly_edge) ? LB_EXTERNAL : LB_INTERNAL;
-		*lbptr = curseg;
-		return (int)curseg->lb_type;
-	    }
-	    else if (startmatch || endmatch)
-	    {
-		/* Insert a new segment after curseg */
-		newseg = (LinkedBoundary *)mallocMagic(sizeof(LinkedBoundary));
-		newseg->lb_next = curseg->lb_next;
-		curseg->lb_next = newseg;
-
-		if (startmatch)
-		{
-		    newseg->lb_type = curseg->lb_type;
-		    curseg->lb_type = (poly_edge) ? LB_EXTERNAL : LB_INTERNAL;
-		    newseg->lb_start.p_x = p2x;
-		    newseg->lb_start.p_y = p2y;
-		}
-		else
-		{
-		    newseg->lb_type = (poly_edge) ? LB_EXTERNAL : LB_INTERNAL;
-		    newseg->lb_start.p_x = p1x;
-		    newseg->lb_start.p_y = p1y;
-		}
-		curseg = newseg;
-		*lbptr = curseg;
-		return (int)curseg->lb_type;
-	    }
-	}
+	calmaMergeSize = (calmaMergeSize == 0) ? 1024 : calmaMergeSize * 2;
+	newlist = (Tile **)mallocMagic(calmaMergeSize * sizeof(Tile *));
+	if (calmaMergeCount > 0)
+	    memcpy(newlist, calmaMergeList, calmaMergeCount * sizeof(Tile *));
+	if (calmaMergeList != NULL) freeMagic(calmaMergeList);
+	calmaMergeList = newlist;
     }
-    return -1;		/* This shouldn't happen, but isn't fatal. */
+    calmaMergeList[calmaMergeCount++] = tile;
+    return 0;
 }
 
 /*
  * ----------------------------------------------------------------------------
- * calmaRemoveDegenerate ---
  *
- *    This routine takes lists of polygons and removes any degenerate
- *    segments (those that backtrack on themselves) from each one.
+ * calmaMergeCompare --
+ *
+ * Compare two tiles for qsort(), ordering them from bottom to top and
+ * then from left to right.
  *
  * Results:
- *	None.
+ *	Negative, zero or positive, as for qsort().
  *
- * Side Effects:
- *	Deallocates memory for any segments that are removed.
+ * Side effects:
+ *	None.
  *
  * ----------------------------------------------------------------------------
  */
 
-void
-calmaRemoveDegenerate(
-    BoundaryTop *blist)
+int
+calmaMergeCompare(
+    const void *one,
+    const void *two)
 {
-    bool segfound;
-    LinkedBoundary *stopseg, *curseg, *lastseg;
-    BoundaryTop *bounds;
-
-    for (bounds = blist; bounds != NULL; bounds = bounds->bt_next)
-    {
-	segfound = TRUE;
-	while (segfound)
-	{
-	    segfound = FALSE;
-	    stopseg = NULL;
-	    for (lastseg = bounds->bt_first; lastseg != stopseg;)
-	    {
-		stopseg = bounds->bt_first;
-		curseg = lastseg->lb_next;
+    Tile *t1 = *((Tile **)one);
+    Tile *t2 = *((Tile **)two);
 
-		if (GEO_SAMEPOINT(curseg->lb_start,
-			curseg->lb_next->lb_next->lb_start))
-		{
-		    segfound = TRUE;
-		    lastseg->lb_next = curseg->lb_next->lb_next;
-
-		    freeMagic(curseg->lb_next);
-		    freeMagic(curseg);
-
-		    /* Make sure record doesn't point to a free'd segment */
-		    bounds->bt_first = lastseg;
-		    bounds->bt_points -= 2;
-		    break;
-		}
-		else
-		    lastseg = lastseg->lb_next;
-	    }
-	}
-    }
+    if (BOTTOM(t1) != BOTTOM(t2))
+	return (BOTTOM(t1) < BOTTOM(t2)) ? -1 : 1;
+    if (LEFT(t1) != LEFT(t2))
+	return (LEFT(t1) < LEFT(t2)) ? -1 : 1;
+    return 0;
 }
 
 /*
  * ----------------------------------------------------------------------------
- * calmaRemoveColinear ---
  *
- *    This routine takes lists of polygons and removes any redundant
- *    (colinear) points.
+ * calmaMergeFind --
+ *
+ * Find the polygon that a tile's polygon has been merged into.
  *
  * Results:
- *	None.
+ *	The root of the tree of merged polygons containing "cp".
  *
- * Side Effects:
- *	Deallocates memory for any segments that are removed.
+ * Side effects:
+ *	Shortens the path from "cp" to the root.
  *
  * ----------------------------------------------------------------------------
  */
 
-void
-calmaRemoveColinear(
-    BoundaryTop *blist)
+CalmaPolygon *
+calmaMergeFind(
+    CalmaPolygon *cp)
 {
-    LinkedBoundary *stopseg, *curseg, *lastseg;
-    BoundaryTop *bounds;
+    CalmaPolygon *root, *next;
 
-    for (bounds = blist; bounds != NULL; bounds = bounds->bt_next)
+    for (root = cp; root->cp_parent != NULL; root = root->cp_parent);
+    for (; cp != root; cp = next)
     {
-	stopseg = NULL;
-	for (lastseg = bounds->bt_first; lastseg != stopseg;)
-	{
-	    stopseg = bounds->bt_first;
-	    curseg = lastseg->lb_next;
-
-	    if (((lastseg->lb_start.p_x == curseg->lb_start.p_x) &&
-		(lastseg->lb_start.p_x == curseg->lb_next->lb_start.p_x)) ||
-		((lastseg->lb_start.p_y == curseg->lb_start.p_y) &&
-		(lastseg->lb_start.p_y == curseg->lb_next->lb_start.p_y)))
-	    {
-		lastseg->lb_next = curseg->lb_next;
-
-		/* Make sure record doesn't point to a free'd segment */
-		if (curseg == bounds->bt_first) bounds->bt_first = lastseg;
-
-		freeMagic(curseg);
-		bounds->bt_points--;
-	    }
-	    else if ((lastseg->lb_start.p_x != curseg->lb_start.p_x) &&
-		(lastseg->lb_start.p_y != curseg->lb_start.p_y) &&
-		(curseg->lb_start.p_x != curseg->lb_next->lb_start.p_x) &&
-		(curseg->lb_start.p_y != curseg->lb_next->lb_start.p_y))
-	    {
-		/* Check colinearity of non-Manhattan edges */
-		int delx1, dely1, delx2, dely2, gcf;
-
-		delx1 = curseg->lb_start.p_x - lastseg->lb_start.p_x;
-		dely1 = curseg->lb_start.p_y - lastseg->lb_start.p_y;
-		delx2 = curseg->lb_next->lb_start.p_x - curseg->lb_start.p_x;
-		dely2 = curseg->lb_next->lb_start.p_y - curseg->lb_start.p_y;
-
-		if ((delx1 != delx2) || (dely1 != dely2))
-		{
-		    gcf = FindGCF(delx1, dely1);
-		    if (gcf > 1)
-		    {
-			delx1 /= gcf;
-			dely1 /= gcf;
-		    }
-		}
-		if ((delx1 != delx2) || (dely1 != dely2))
-		{
-		    gcf = FindGCF(delx2, dely2);
-		    if (gcf > 1)
-		    {
-			delx2 /= gcf;
-			dely2 /= gcf;
-		    }
-		}
-		if ((delx1 == delx2) && (dely1 == dely2))
-	 	{
-		    lastseg->lb_next = curseg->lb_next;
-		    if (curseg == bounds->bt_first) bounds->bt_first = lastseg;
-		    freeMagic(curseg);
-		    bounds->bt_points--;
-		}
-		else
-		    lastseg = lastseg->lb_next;
-	    }
-	    else
-		lastseg = lastseg->lb_next;
-	}
+	next = cp->cp_parent;
+	cp->cp_parent = root;
     }
+    return root;
 }
 
 /*
  * ----------------------------------------------------------------------------
- * calmaMergeSegments ---
  *
- *    Once a tile has been disassembled into segments, and it is not a simple
- *    rectangle (which would have been handled already), then merge it into
- *    the list of boundaries.
+ * calmaMergeOutput --
  *
- *    Note that this algorithm is O(N^2) and has lots of room for improvement!
- *    Still, each segment is never checked against more than 200 points,
- *    because when a boundary reaches this number (the maximum for GDS
- *    boundary records), the record will tend to be skipped (it should
- *    probably be output here. . .)
+ * Write one merged polygon as a GDS boundary.  Repeated points and
+ * points in the middle of a straight edge are dropped.  A polygon that
+ * is still a single tile is written by calmaWritePaintFunc(), exactly
+ * as if the tiles had not been merged.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Output, memory allocation and deallocation
+ *	Writes to the disk file.
  *
  * ----------------------------------------------------------------------------
  */
 
+/* TRUE if point "b" adds nothing to the outline between "a" and "c" */
+#define COLINEAR(a, b, c) \
+	((dlong)((b).p_x - (a).p_x) * (dlong)((c).p_y - (b).p_y) == \
+	 (dlong)((b).p_y - (a).p_y) * (dlong)((c).p_x - (b).p_x))
+
 void
-calmaMergeSegments(
-    LinkedBoundary *edge,
-    BoundaryTop **blist,
-    int num_points)
+calmaMergeOutput(
+    CalmaPolygon *cp,		/* Polygon to be written out */
+    calmaOutputStruct *cos)	/* File for output */
 {
-    LinkedBoundary *stopseg, *curseg, *lastseg;
-    LinkedBoundary *compstop, *compseg, *complast;
-    BoundaryTop *bounds, *newbounds;
-
-    if (*blist == NULL) goto make_new_bound;
-
-    /* Check each internal edge for an antiparallel match with	*/
-    /* an internal edge in the boundary lists.			*/
+    static Point *points = NULL;
+    static int maxpoints = 0;
+    CalmaStream *f = cos->f;
+    CalmaVertex *cv;
+    Point p;
+    int i, n, first;
 
-    stopseg = NULL;
-    for (lastseg = edge; lastseg != stopseg; lastseg = lastseg->lb_next)
+    if (cp->cp_points <= 4)
     {
-	stopseg = edge;
-	curseg = lastseg->lb_next;
-	if (curseg->lb_type == LB_EXTERNAL) continue;
-
-	for (bounds = *blist; bounds != NULL; bounds = bounds->bt_next)
-	{
-	    /* Avoid overflow on GDS boundary point limit.  Note	*/
-	    /* that a merge will remove 2 points, but GDS requires	*/
-	    /* that we add the 1st point to the end of the list.	*/
-
-	    if (bounds->bt_points + num_points > 201) continue;
-
-	    compstop = NULL;
-	    for (complast = bounds->bt_first; complast != compstop;
-			complast = complast->lb_next)
-	    {
-	        compstop = bounds->bt_first;
-		compseg = complast->lb_next;
-		if (compseg->lb_type == LB_EXTERNAL) continue;
-
-		/* Edges match antiparallel only. Rect points are *not*	*/
-		/* canonical. r_ll and p1 are both 1st points traveling	*/
-		/* in a counterclockwise direction along the perimeter.	*/
-
-		if (GEO_SAMEPOINT(compseg->lb_start, curseg->lb_next->lb_start) &&
-		   GEO_SAMEPOINT(compseg->lb_next->lb_start, curseg->lb_start))
-		{
-		    lastseg->lb_next = compseg->lb_next;
-		    complast->lb_next = curseg->lb_next;
-
-		    freeMagic(compseg);
-		    freeMagic(curseg);
-
-		    /* Make sure the record doesn't point to the free'd segment */
-		    if (compseg == bounds->bt_first) bounds->bt_first = complast;
-		    bounds->bt_points += num_points - 2;
-		    return;
-		}
-	    }
-	}
+	calmaWritePaintFunc(cp->cp_tile, (TiGetLeftType(cp->cp_tile) == TT_SPACE) ?
+		(TileType)TT_SIDE : (TileType)0, cos);
+	return;
     }
 
-    /* If still no connecting edge was found, or if we overflowed the GDS max	*/
-    /* number of records for a boundary, then start a new entry.		*/
-
-make_new_bound:
-
-    newbounds = (BoundaryTop *)mallocMagic(sizeof(BoundaryTop));
-    newbounds->bt_first = edge;
-    newbounds->bt_next = *blist;
-    newbounds->bt_points = num_points;
-    *blist = newbounds;
-}
-
-/*
- * ----------------------------------------------------------------------------
- * Process a LinkedBoundary list into a polygon and generate GDS output.
- * Free the linked list when done.
- *
- * Results:
- *	None.
- *
- * Side effects:
- *	Output, memory deallocation.
- *
- * ----------------------------------------------------------------------------
- */
-
-void
-calmaProcessBoundary(
-    BoundaryTop *blist,
-    calmaOutputStruct *cos)
-{
-    FILE *f = cos->f;
-    LinkedBoundary *listtop, *lbref, *lbstop, *lbfree;
-    BoundaryTop *bounds;
-    int sval;
-    int chkcount;	/* diagnostic */
-
-    for (bounds = blist; bounds != NULL; bounds = bounds->bt_next)
+    if (cp->cp_points > maxpoints)
     {
-	/* Boundary */
-	calmaOutRH(4, CALMA_BOUNDARY, CALMA_NODATA, f);
-
-	/* Layer */
-	calmaOutRH(6, CALMA_LAYER, CALMA_I2, f);
-	calmaOutI2(calmaPaintLayerNumber, f);
-
-	/* Data type */
-	calmaOutRH(6, CALMA_DATATYPE, CALMA_I2, f);
-	calmaOutI2(calmaPaintLayerType, f);
-
-	/* Record length = ((#points + 1) * 2 values * 4 bytes) + 4 bytes header */
-	calmaOutRH(4 + (bounds->bt_points + 1) * 8, CALMA_XY, CALMA_I4, f);
-
-	/* Coordinates (repeat 1st point) */
-
-	listtop = bounds->bt_first;
-	lbstop = NULL;
-	chkcount = 0;
-	for (lbref = listtop; lbref != lbstop; lbref = lbref->lb_next)
-	{
-	    lbstop = listtop;
-	    calmaOutI4(lbref->lb_start.p_x * calmaPaintScale, f);
-	    calmaOutI4(lbref->lb_start.p_y * calmaPaintScale, f);
-	    chkcount++;
-	}
-	if (listtop != NULL)
-	{
-	    calmaOutI4(listtop->lb_start.p_x * calmaPaintScale, f);
-	    calmaOutI4(listtop->lb_start.p_y * calmaPaintScale, f);
-	}
-
-	if (chkcount != bounds->bt_points)
-	    TxError("Points recorded=%d;  Points written=%d\n",
-			bounds->bt_points, chkcount);
-
-	/* End of element */
-	calmaOutRH(4, CALMA_ENDEL, CALMA_NODATA, f);
-
-#ifdef DEBUG
-	/* Diagnostic: report the contents of the list */
-	TxPrintf("Polygon path (%d points):\n", bounds->bt_points);
+	if (points != NULL) freeMagic(points);
+	maxpoints = cp->cp_points;
+	points = (Point *)mallocMagic(maxpoints * sizeof(Point));
+    }
 
-	listtop = bounds->bt_first;
-	lbstop = NULL;
+    /* Walk the outline, dropping points as they become redundant */
 
-	for (lbref = listtop; lbref != lbstop; lbref = lbref->lb_next)
+    n = 0;
+    cv = cp->cp_start;
+    do
+    {
+	p = cv->cv_point;
+	while (TRUE)
 	{
-	    if (lbref != listtop)
-		TxPrintf("->");
+	    if ((n >= 1) && GEO_SAMEPOINT(points[n - 1], p))
+		n--;
+	    else if ((n >= 2) && COLINEAR(points[n - 2], points[n - 1], p))
+		n--;
 	    else
-		lbstop = listtop;
-
-	    switch(lbref->lb_type)
-	    {
-		case LB_EXTERNAL:
-		    TxPrintf("(%d %d)", lbref->lb_start.p_x, lbref->lb_start.p_y);
-		    break;
-		case LB_INTERNAL:
-		    TxPrintf("[[%d %d]]", lbref->lb_start.p_x, lbref->lb_start.p_y);
-		    break;
-		case LB_INIT:
-		    TxPrintf("XXXXX");
-		    break;
-	    }
+		break;
 	}
-	TxPrintf("\n\n");
-#endif
+	points[n++] = p;
+	cv = cv->cv_next;
+    }
+    while (cv != cp->cp_start);
 
-	/* Free the LinkedBoundary list */
+    /* Do the same where the end of the outline meets the start */
 
-	{
-	    free_magic1_t mm1 = freeMagic1_init();
-	    lbref = listtop;
-	    while (lbref->lb_next != listtop)
-	    {
-		freeMagic1(&mm1, lbref);
-		lbref = lbref->lb_next;
-	    }
-	    freeMagic1(&mm1, lbref);
-	    freeMagic1_end(&mm1);
-	}
+    first = 0;
+    while (TRUE)
+    {
+	if ((n - first >= 2) && GEO_SAMEPOINT(points[n - 1], points[first]))
+	    n--;
+	else if ((n - first >= 3) && COLINEAR(points[n - 2], points[n - 1],
+		points[first]))
+	    n--;
+	else if ((n - first >= 3) && COLINEAR(points[n - 1], points[first],
+		points[first + 1]))
+	    first++;
+	else
+	    break;
     }
+    if (n - first < 3) return;	/* No area */
+
+    /* Boundary */
+    calmaOutRH(4, CALMA_BOUNDARY, CALMA_NODATA, f);
 
-    /* Free the BoundaryTop list */
+    /* Layer */
+    calmaOutRH(6, CALMA_LAYER, CALMA_I2, f);
+    calmaOutI2(calmaPaintLayerNumber, f);
+
+    /* Data type */
+    calmaOutRH(6, CALMA_DATATYPE, CALMA_I2, f);
+    calmaOutI2(calmaPaintLayerType, f);
 
+    /* Coordinates (repeat 1st point) */
+    calmaOutRH(4 + (n - first + 1) * 8, CALMA_XY, CALMA_I4, f);
+    for (i = first; i < n; i++)
     {
-	free_magic1_t mm1 = freeMagic1_init();
-	for (bounds = blist; bounds != NULL; bounds = bounds->bt_next)
-	    freeMagic1(&mm1, bounds);
-	freeMagic1_end(&mm1);
+	calmaOutI4(points[i].p_x * calmaPaintScale, f);
+	calmaOutI4(points[i].p_y * calmaPaintScale, f);
     }
+    calmaOutI4(points[first].p_x * calmaPaintScale, f);
+    calmaOutI4(points[first].p_y * calmaPaintScale, f);
+
+    /* End of element */
+    calmaOutRH(4, CALMA_ENDEL, CALMA_NODATA, f);
 }
 
 /*
  * ----------------------------------------------------------------------------
  *
- * calmaMergePaintFunc --
+ * calmaMergeLayer --
+ *
+ * Write the paint of one CIF plane as merged polygons ("gds merge").
+ *
+ * The tiles of the plane are swept from bottom to top.  Each tile
+ * starts out as a polygon of its own, with its corners linked in
+ * counterclockwise order, and is joined to the polygon of each tile
+ * below it that it touches:  the bottom edge of the tile and the top
+ * edge of the tile below are cut where they overlap, and the two
+ * outlines are relinked into one.  The top edge of a tile is always
+ * the link out of its upper right corner, which is kept in the tile's
+ * client field, so each join takes constant time and the whole layer
+ * is merged in one pass.
+ *
+ * A tile is not joined to a polygon that it is already part of, as
+ * that would cut a hole out of the polygon;  the tile's outline then
+ * runs back along the shared edge, leaving a zero-width slit (as GDS
+ * boundaries cannot have holes).  Nor is it joined if the result would
+ * have more than CALMA_POLYGON_MAX points, so large areas are written
+ * as several abutting polygons.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Writes to the disk file.
+ *	Writes to the disk file.  Client fields of the tiles are used
+ *	while merging and reset to CLIENTDEFAULT afterward.
  *
  * ----------------------------------------------------------------------------
  */
 
-int
-calmaMergePaintFunc(
-    Tile *tile,			/* Tile to be written out. */
-    TileType dinfo,		/* Split tile information (unused) */
-    calmaOutputStruct *cos)	/* Information needed by algorithm */
+void
+calmaMergeLayer(
+    Plane *plane,		/* CIF plane to be written out */
+    const Rect *cliprect,	/* Area to search */
+    calmaOutputStruct *cos)	/* File for output and clipping area */
 {
-    FILE *f = cos->f;
     const Rect *clipArea = cos->area;
+    CalmaVertex *vertices, *cv, *top, *bottom, *below, *next;
+    CalmaPolygon *polygons, *cp, *root, *broot;
     Tile *t, *tp;
-    TileType ttype;
-    int i, llx, lly, urx, ury, intedges, num_points, split_type;
-    bool is_ext;
-    static Stack *SegStack = (Stack *)NULL;
+    Rect r;
+    int i, j, nv, split_type;
 
-    static LinkedBoundary *edge;
-    LinkedBoundary *lb;
-    BoundaryTop *bounds = NULL;
+    calmaMergeCount = 0;
+    DBSrPaintArea((Tile *) NULL, plane, cliprect, &CIFSolidBits,
+		calmaMergeCollectFunc, (ClientData) NULL);
+    if (calmaMergeCount == 0) return;
 
-    /* Quick check for tiles that have already been processed */
-    if (TiGetClientINT(tile) == GDS_PROCESSED) return 0;
+    qsort(calmaMergeList, calmaMergeCount, sizeof(Tile *), calmaMergeCompare);
 
-    if (SegStack == (Stack *)NULL)
-	SegStack = StackNew(64);
+    vertices = (CalmaVertex *)mallocMagic(calmaMergeCount * 4 * sizeof(CalmaVertex));
+    polygons = (CalmaPolygon *)mallocMagic(calmaMergeCount * sizeof(CalmaPolygon));
 
-    PUSHTILEC(tile);
-    while (!StackEmpty(SegStack))
+    cv = vertices;
+    for (i = 0; i < calmaMergeCount; i++)
     {
-	t = (Tile *) STACKPOP(SegStack);
-	if (TiGetClientINT(t) != GDS_PENDING) continue;
-	TiSetClientINT(t, GDS_PROCESSED);
-
-	split_type = -1;
-	if (IsSplit(t))
-	{
-	    /* If we use TT_SIDE, then we need to set it when the	*/
-	    /* tile is pushed.  Since these are one-or-zero mask layers	*/
-	    /* I assume it is okay to just check which side is TT_SPACE	*/
-
-	    split_type = SplitDirection(t);
-	    if (TiGetLeftType(t) == TT_SPACE) split_type |= 2;
-	    num_points = 2;
-	    if (edge != NULL)
-	    {
-		/* Remove one point from the edge record for rectangles */
-		/* and relink the last entry back to the new head.	*/
-
-		lb = edge;
-		while (lb->lb_next != edge) lb = lb->lb_next;
-		lb->lb_next = edge->lb_next;
-		free_magic1_t mm1 = freeMagic1_init();
-		freeMagic1(&mm1, edge);
-		edge = edge->lb_next;
-		freeMagic1_end(&mm1);
-	    }
-	}
-	else
-	    num_points = 3;
-
-	/* Create a new linked boundary structure with 4 unknown edges.	*/
-	/* This structure is reused when we encounter isolated tiles,	*/
-	/* so we avoid unnecessary overhead in the case of, for		*/
-	/* example, large contact cut arrays.				*/
+	t = calmaMergeList[i];
+	cp = &polygons[i];
+	cp->cp_parent = NULL;
+	cp->cp_tile = t;
 
-	if (edge == NULL)
+	TiToRect(t, &r);
+	if (clipArea != NULL)
 	{
-	    edge = (LinkedBoundary *)mallocMagic(sizeof(LinkedBoundary));
-	    lb = edge;
+	    /* A split tile crossing the clip area is written by	*/
+	    /* itself as a clipped triangle, as without merging.	*/
 
-	    for (i = 0; i < num_points; i++)
+	    if (IsSplit(t) && !GEO_SURROUND(clipArea, &r))
 	    {
-		lb->lb_type = LB_INIT;
-		lb->lb_next = (LinkedBoundary *)mallocMagic(sizeof(LinkedBoundary));
-		lb = lb->lb_next;
+		cp->cp_start = NULL;
+		calmaWritePaintFunc(t, (TiGetLeftType(t) == TT_SPACE) ?
+			(TileType)TT_SIDE : (TileType)0, cos);
+		continue;
 	    }
-	    lb->lb_type = LB_INIT;
-	    lb->lb_next = edge;
+	    GeoClip(&r, clipArea);
 	}
 
-	lb = edge;
-	llx = LEFT(t);
-	lly = BOTTOM(t);
-	urx = RIGHT(t);
-	ury = TOP(t);
-	intedges = 0;
-
-	/* Initialize the "edge" record with the corner points of the	*/
-	/* tile.							*/
+	/* Make the counterclockwise outline of the tile, noting the	*/
+	/* upper right corner (which leads along the top edge) and the	*/
+	/* lower left corner (which leads along the bottom edge).	*/
 
+	top = bottom = NULL;
+	split_type = -1;
 	if (IsSplit(t))
 	{
-	    switch (split_type)
-	    {
-		case 0x0:
-		    lb->lb_start.p_x = urx;
-		    lb->lb_start.p_y = ury;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = llx;
-		    lb->lb_start.p_y = ury;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = llx;
-		    lb->lb_start.p_y = lly;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    break;
-		case 0x1:
-		    lb->lb_start.p_x = llx;
-		    lb->lb_start.p_y = ury;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = llx;
-		    lb->lb_start.p_y = lly;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = urx;
-		    lb->lb_start.p_y = lly;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    break;
-		case 0x2:
-		    lb->lb_start.p_x = urx;
-		    lb->lb_start.p_y = ury;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = llx;
-		    lb->lb_start.p_y = lly;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = urx;
-		    lb->lb_start.p_y = lly;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    break;
-		case 0x3:
-		    lb->lb_start.p_x = urx;
-		    lb->lb_start.p_y = ury;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = llx;
-		    lb->lb_start.p_y = ury;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    lb->lb_start.p_x = urx;
-		    lb->lb_start.p_y = lly;
-		    lb->lb_type = LB_INIT;
-		    lb = lb->lb_next;
-		    break;
-	    }
-	    num_points = 1;
-	}
-	else
-	{
-	    lb->lb_start.p_x = urx;
-	    lb->lb_start.p_y = ury;
-	    lb->lb_type = LB_INIT;
-	    lb = lb->lb_next;
-	    lb->lb_start.p_x = llx;
-	    lb->lb_start.p_y = ury;
-	    lb->lb_type = LB_INIT;
-	    lb = lb->lb_next;
-	    lb->lb_start.p_x = llx;
-	    lb->lb_start.p_y = lly;
-	    lb->lb_type = LB_INIT;
-	    lb = lb->lb_next;
-	    lb->lb_start.p_x = urx;
-	    lb->lb_start.p_y = lly;
-	    lb->lb_type = LB_INIT;
-	    lb = lb->lb_next;
-
-	    num_points = 0;
-	}
-	if (split_type == 0x1) goto left_search;
-
-	/* Search the tile boundary for connected and unconnected tiles.	*/
-	/* Generate segments in a counterclockwise cycle.			*/
-
-	if (split_type == 0x2)
-	{
-	    intedges += calmaAddSegment(&lb, TRUE, RIGHT(t), TOP(t),
-			LEFT(t), BOTTOM(t));
-	    goto bottom_search;
-	}
-
-	/* Search top */
-
-	ttype = TiGetTopType(t);
-	for (tp = RT(t); RIGHT(tp) > LEFT(t); tp = BL(tp), num_points++)
-	{
-	    is_ext = (TiGetBottomType(tp) != ttype) ? TRUE : FALSE;
-	    intedges += calmaAddSegment(&lb, is_ext,
-			MIN(RIGHT(t), RIGHT(tp)), TOP(t),
-			MAX(LEFT(t), LEFT(tp)), TOP(t));
-	    if (!is_ext) PUSHTILEC(tp);
-	}
-
-	if (split_type == 0x3)
-	{
-	    intedges += calmaAddSegment(&lb, TRUE, LEFT(t), TOP(t),
-			RIGHT(t), BOTTOM(t));
-	    goto right_search;
-	}
-
-	/* Search left */
-
-left_search:
-	ttype = TiGetLeftType(t);
-	for (tp = BL(t); BOTTOM(tp) < TOP(t); tp = RT(tp), num_points++)
-	{
-	    is_ext = (TiGetRightType(tp) != ttype) ? TRUE : FALSE;
-	    intedges += calmaAddSegment(&lb, is_ext,
-			LEFT(t), MIN(TOP(t), TOP(tp)),
-			LEFT(t), MAX(BOTTOM(t), BOTTOM(tp)));
-	    if (!is_ext) PUSHTILEC(tp);
-	}
-
-	if (split_type == 0x0)
-	{
-	    intedges += calmaAddSegment(&lb, TRUE, LEFT(t), BOTTOM(t),
-			RIGHT(t), TOP(t));
-	    goto done_searches;
-	}
-
-	/* Search bottom */
-
-bottom_search:
-	ttype = TiGetBottomType(t);
-	for (tp = LB(t); LEFT(tp) < RIGHT(t); tp = TR(tp), num_points++)
-	{
-	    is_ext = (TiGetTopType(tp) != ttype) ? TRUE : FALSE;
-	    intedges += calmaAddSegment(&lb, is_ext,
-			MAX(LEFT(t), LEFT(tp)), BOTTOM(t),
-			MIN(RIGHT(t), RIGHT(tp)), BOTTOM(t));
-	    if (!is_ext) PUSHTILEC(tp);
+	    split_type = SplitDirection(t);
+	    if (TiGetLeftType(t) == TT_SPACE) split_type |= 2;
 	}
-
-	if (split_type == 0x1)
+	switch (split_type)
 	{
-	    intedges += calmaAddSegment(&lb, TRUE, RIGHT(t), BOTTOM(t),
-			LEFT(t), TOP(t));
-	    goto done_searches;
+	    case 0x0:
+		cv[0].cv_point.p_x = r.r_xtop; cv[0].cv_point.p_y = r.r_ytop;
+		cv[1].cv_point.p_x = r.r_xbot; cv[1].cv_point.p_y = r.r_ytop;
+		cv[2].cv_point.p_x = r.r_xbot; cv[2].cv_point.p_y = r.r_ybot;
+		top = &cv[0];
+		nv = 3;
+		break;
+	    case 0x1:
+		cv[0].cv_point.p_x = r.r_xbot; cv[0].cv_point.p_y = r.r_ytop;
+		cv[1].cv_point.p_x = r.r_xbot; cv[1].cv_point.p_y = r.r_ybot;
+		cv[2].cv_point.p_x = r.r_xtop; cv[2].cv_point.p_y = r.r_ybot;
+		bottom = &cv[1];
+		nv = 3;
+		break;
+	    case 0x2:
+		cv[0].cv_point.p_x = r.r_xbot; cv[0].cv_point.p_y = r.r_ybot;
+		cv[1].cv_point.p_x = r.r_xtop; cv[1].cv_point.p_y = r.r_ybot;
+		cv[2].cv_point.p_x = r.r_xtop; cv[2].cv_point.p_y = r.r_ytop;
+		bottom = &cv[0];
+		nv = 3;
+		break;
+	    case 0x3:
+		cv[0].cv_point.p_x = r.r_xtop; cv[0].cv_point.p_y = r.r_ytop;
+		cv[1].cv_point.p_x = r.r_xbot; cv[1].cv_point.p_y = r.r_ytop;
+		cv[2].cv_point.p_x = r.r_xtop; cv[2].cv_point.p_y = r.r_ybot;
+		top = &cv[0];
+		nv = 3;
+		break;
+	    default:
+		cv[0].cv_point.p_x = r.r_xtop; cv[0].cv_point.p_y = r.r_ytop;
+		cv[1].cv_point.p_x = r.r_xbot; cv[1].cv_point.p_y = r.r_ytop;
+		cv[2].cv_point.p_x = r.r_xbot; cv[2].cv_point.p_y = r.r_ybot;
+		cv[3].cv_point.p_x = r.r_xtop; cv[3].cv_point.p_y = r.r_ybot;
+		top = &cv[0];
+		bottom = &cv[2];
+		nv = 4;
+		break;
 	}
-	/* Search right */
-
-right_search:
-	ttype = TiGetRightType(t);
-	for (tp = TR(t); TOP(tp) > BOTTOM(t); tp = LB(tp), num_points++)
+	for (j = 0; j < nv; j++)
 	{
-	    is_ext = (TiGetLeftType(tp) != ttype) ? TRUE : FALSE;
-	    intedges += calmaAddSegment(&lb, is_ext,
-			RIGHT(t), MAX(BOTTOM(t), BOTTOM(tp)),
-			RIGHT(t), MIN(TOP(t), TOP(tp)));
-	    if (!is_ext) PUSHTILEC(tp);
+	    cv[j].cv_next = (j == nv - 1) ? &cv[0] : &cv[j + 1];
+	    cv[j].cv_poly = cp;
 	}
-
-	/* If tile is isolated, process it now and we're done */
-
-done_searches:
-	if (intedges == 0)
+	cp->cp_start = cv;
+	cp->cp_points = nv;
+	cv += nv;
+
+	/* Join the polygons of the tiles below, from left to right.	*/
+	/* "bottom" always leads along what remains of this tile's	*/
+	/* bottom edge, and "below" along the top edge of the tile	*/
+	/* below.  Tiles below were all handled before this one, and	*/
+	/* any of their top edges to the left of this tile have already	*/
+	/* been cut off by the tiles above them.			*/
+
+	if (bottom != NULL)
 	{
-	    calmaWritePaintFunc(t,
-			(split_type & 2) ? (TileType)TT_SIDE : (TileType)0,
-			cos);
-
-	    /* Although calmaWritePaintFunc is called only on isolated	*/
-	    /* tiles, we may have expanded it.  This could use a LOT of	*/
-	    /* optimizing.  1) remove colinear points in calmaAddSegment */
-	    /* when both subsegments are external paths, and 2) here,	*/
-	    /* take the shortest path to making "edge" exactly 4 points.*/
-	    /* Note that in non-Manhattan mode, num_points may be 3.	*/
-
-	    if (num_points != 4)
+	    for (tp = LB(t); LEFT(tp) < RIGHT(t); tp = TR(tp))
 	    {
-		free_magic1_t mm1 = freeMagic1_init();
-		for (i = 0; i < num_points; i++)
-		{
-		    freeMagic1(&mm1, edge);
-		    edge = edge->lb_next;
-		}
-		freeMagic1_end(&mm1);
-		edge = NULL;
+		if (TiGetClient(tp) == CLIENTDEFAULT) continue;
+		if (TiGetTopType(tp) == TT_SPACE) continue;
+		if ((clipArea != NULL) &&
+			(MAX(MAX(LEFT(t), LEFT(tp)), clipArea->r_xbot) >=
+			MIN(MIN(RIGHT(t), RIGHT(tp)), clipArea->r_xtop)))
+		    continue;
+
+		below = (CalmaVertex *)TiGetClientPTR(tp);
+		root = calmaMergeFind(cp);
+		broot = calmaMergeFind(below->cv_poly);
+		if (broot == root) continue;
+		if (broot->cp_points + root->cp_points > CALMA_POLYGON_MAX)
+		    continue;
+
+		next = bottom->cv_next;
+		bottom->cv_next = below->cv_next;
+		below->cv_next = next;
+		bottom = below;
+
+		root->cp_parent = broot;
+		broot->cp_points += root->cp_points;
 	    }
-	    if (!StackEmpty(SegStack))
-		TxError("ERROR:  Segment stack is supposed to be empty!\n");
-	    else
-		return 0;
-	}
-	else
-	{
-	    /* Merge boundary into existing record */
-
-	    calmaMergeSegments(edge, &bounds, num_points);
-	    edge = NULL;
 	}
+	if (top != NULL)
+	    TiSetClientPTR(t, top);
     }
 
-    /* Remove any degenerate points */
-    calmaRemoveDegenerate(bounds);
-
-    /* Remove any colinear points */
-    calmaRemoveColinear(bounds);
-
-    /* Output the boundary records */
-    calmaProcessBoundary(bounds, cos);
+    for (i = 0; i < calmaMergeCount; i++)
+    {
+	cp = &polygons[i];
+	if ((cp->cp_parent == NULL) && (cp->cp_start != NULL))
+	    calmaMergeOutput(cp, cos);
+	TiSetClient(calmaMergeList[i], CLIENTDEFAULT);
+    }
 
-    return 0;	/* Keep the search alive. . . */
+    freeMagic(vertices);
+    freeMagic(polygons);
 }
 
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -2869,7 +3228,7 @@ calmaWritePaintFunc(
     TileType dinfo,		/* Split tile information */
     calmaOutputStruct *cos)	/* File for output and clipping area */
 {
-    FILE *f = cos->f;
+    CalmaStream *f = cos->f;
     const Rect *clipArea = cos->area;
     Rect r, r2;
 
@@ -2964,7 +3323,7 @@ calmaWritePaintFunc(
  *	None.
  *
  * Side effects:
- *	Writes to the FILE 'f'.
+ *	Writes to the stream 'f'.
  *
  * ----------------------------------------------------------------------------
  */
@@ -2976,7 +3335,7 @@ calmaWriteLabelFunc(
     int type,	/* CIF layer number to use for BOUNDARY record,
 		 * or -1 if not attached to a layer
 		 */
-    FILE *f)	/* Stream file */
+    CalmaStream *f)	/* Stream file */
 {
     Point p;
     int calmanum, calmatype;
@@ -3146,7 +3505,7 @@ calmaPaintLabelFunc(
     TileType dinfo,		/* Split tile information (unused) */
     calmaOutputStruct *cos)	/* File for output and clipping area */
 {
-    FILE *f = cos->f;
+    CalmaStream *f = cos->f;
     const Rect *clipArea = cos->area;
     Rect r, r2;
     Point p;
@@ -3197,7 +3556,7 @@ calmaPaintLabelFunc(
  *	None.
  *
  * Side effects:
- *	Writes to the FILE 'f'.
+ *	Writes to the stream 'f'.
  *
  * ----------------------------------------------------------------------------
  */
@@ -3205,7 +3564,7 @@ calmaPaintLabelFunc(
 void
 calmaOutHeader(
     CellDef *rootDef,
-    FILE *f)
+    CalmaStream *f)
 {
     static double useru = 0.001;
     static double mum = 1.0e-9;
@@ -3250,7 +3609,7 @@ calmaOutHeader(
  *
  * calmaOutDate --
  *
- * Output a date/time specification to the FILE 'f'.
+ * Output a date/time specification to the stream 'f'.
  * This consists of outputting 6 2-byte quantities,
  * or a total of 12 bytes.
  *
@@ -3258,7 +3617,7 @@ calmaOutHeader(
  *	None.
  *
  * Side effects:
- *	Writes to the FILE 'f'.
+ *	Writes to the stream 'f'.
  *
  * ----------------------------------------------------------------------------
  */
@@ -3266,7 +3625,7 @@ calmaOutHeader(
 void
 calmaOutDate(
     time_t t,	/* Time (UNIX format) to be output */
-    FILE *f)	/* Stream file */
+    CalmaStream *f)	/* Stream file */
 {
     struct tm *datep = localtime(&t);
 
@@ -3293,7 +3652,7 @@ calmaOutDate(
  *	None.
  *
  * Side effects:
- *	Writes to the FILE 'f'.
+ *	Writes to the stream 'f'.
  *
  * ----------------------------------------------------------------------------
  */
@@ -3302,7 +3661,7 @@ void
 calmaOutStringRecord(
     int type,		/* Type of this record (data type is ASCII string) */
     char *str,	/* String to be output */
-    FILE *f)	/* Stream file */
+    CalmaStream *f)	/* Stream file */
 {
     int len;
     unsigned char c;
@@ -3344,15 +3703,15 @@ calmaOutStringRecord(
 	len = CALMANAMELENGTH;
     }
     calmaOutI2(len+4, f);	/* Record length */
-    (void) putc(type, f);		/* Record type */
-    (void) putc(CALMA_ASCII, f);	/* Data type */
+    (void) calmaPutc(type, f);		/* Record type */
+    (void) calmaPutc(CALMA_ASCII, f);	/* Data type */
 
     /* Output the string itself */
     while (len--)
     {
 	locstrprv = locstr;
 	c = (unsigned char) *locstr++;
-	if (c == 0) putc('\0', f);
+	if (c == 0) calmaPutc('\0', f);
 	else
 	{
 	    if ((c > 127) || (c == 0))
@@ -3370,9 +3729,9 @@ calmaOutStringRecord(
 		locstrprv[0] = c;
 	    }
 	    if (!CalmaDoLower && islower(c))
-		(void) putc(toupper(c), f);
+		(void) calmaPutc(toupper(c), f);
 	    else
-		(void) putc(c, f);
+		(void) calmaPutc(c, f);
 	}
     }
     if (origstr != NULL)
@@ -3395,15 +3754,15 @@ calmaOutStringRecord(
  *	None.
  *
  * Side effects:
- *	8-byte value written to output stream FILE 'f'.
+ *	8-byte value written to output stream 'f'.
  *
  * ----------------------------------------------------------------------------
  */
 
 void
 calmaOutR8(
-    double d,	/* Double value to write to output */
-    FILE *f)	/* Stream file */
+    double d,		/* Double value to write to output */
+    CalmaStream *f)	/* Stream file */
 {
     int c, i, sign, expon;
 
@@ -3450,11 +3809,11 @@ calmaOutR8(
 	}
     }
     c = (sign << 7) | expon;
-    (void) putc(c, f);
+    (void) calmaPutc(c, f);
     for (i = 1; i < 8; i++)
     {
 	c = (int)(0xff & (mantissa >> (64 - (8 * i))));
-	(void) putc(c, f);
+	(void) calmaPutc(c, f);
     }
 }
 
@@ -3470,7 +3829,7 @@ calmaOutR8(
  *	None.
  *
  * Side effects:
- *	Writes to the FILE 'f'.
+ *	Writes to the stream 'f'.
  *
  * ----------------------------------------------------------------------------
  */
@@ -3478,10 +3837,7 @@ calmaOutR8(
 void
 calmaOut8(
     const char *str,	/* 8-byte string to be output */
-    FILE *f)	/* Stream file */
+    CalmaStream *f)	/* Stream file */
 {
-    int i;
-
-    for (i = 0; i < 8; i++)
-	(void) putc(*str++, f);
+    (void) calmaStreamWrite(f, str, 8);
 }
@@ -0,0 +1,2255 @@
+/*
+ * OasisRead.c --
+ *
+ * Input of OASIS (SEMI P39) layout files.  OASIS records are mapped
+ * onto the same layers, datatypes and "cifinput" style as GDS-II, and
+ * the shapes are painted through the same code as GDS-II boundaries,
+ * paths and text (CalmaRdpt.c), so "gds" read settings apply to OASIS
+ * input as well.
+ *
+ * The file is read twice:  once to collect the tables of cell names
+ * and text strings, which OASIS allows anywhere in the file, and once
+ * to build the cells.  Compressed CBLOCK records are inflated in
+ * memory as they are met.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+/*
+ * C99 compat
+ * Mind: tcltk/tclmagic.h must be included prior to all the other headers
+ */
+#include "tcltk/tclmagic.h"
+
+#include "utils/magic.h"
+#include "utils/geometry.h"
+#include "tiles/tile.h"
+#include "utils/utils.h"
+#include "utils/magic_zlib.h"
+#include "utils/hash.h"
+#include "database/database.h"
+#include "database/databaseInt.h"
+#include "utils/malloc.h"
+#include "utils/tech.h"
+#include "cif/cif.h"
+#include "cif/CIFint.h"
+#include "cif/CIFread.h"
+#include "utils/signals.h"
+#include "windows/windows.h"
+#include "dbwind/dbwind.h"
+#include "textio/textio.h"
+#include "calma/calmaInt.h"
+#include "calma/oasisInt.h"
+#include "commands/commands.h"		/* for CmdGetRootPoint */
+#include "utils/main.h"			/* for EditCellUse */
+#include "utils/undo.h"
+#include "calma/calma.h"
+
+/*
+ * A point list, as the positions of its points relative to the
+ * position of the element.  The first point is always (0, 0).
+ */
+
+typedef struct
+{
+    int	   op_n;		/* Number of points */
+    int	   op_size;		/* Space allocated */
+    dlong *op_x, *op_y;		/* Point positions */
+} OasisPoints;
+
+/*
+ * A repetition:  either a grid of nx by ny copies stepped by the
+ * vectors v1 and v2, or (if or_n > 0) a list of or_n offsets.
+ */
+
+typedef struct
+{
+    bool   or_valid;		/* TRUE once a repetition has been read */
+    int	   or_nx, or_ny;	/* Grid size */
+    dlong  or_v1x, or_v1y;	/* Step between columns */
+    dlong  or_v2x, or_v2y;	/* Step between rows */
+    int	   or_n;		/* Number of offsets, or 0 for a grid */
+    int	   or_size;		/* Space allocated */
+    dlong *or_x, *or_y;		/* Offsets */
+} OasisRep;
+
+/* Largest number of copies accepted in one repetition */
+#define OASIS_MAX_REPEAT	(1 << 24)
+
+/*
+ * Modal variables:  values of fields that OASIS records may leave out,
+ * taken from the last record that gave them.
+ */
+
+typedef struct
+{
+    bool   om_relative;		/* Positions are relative (XYRELATIVE) */
+    int	   om_layer, om_datatype;
+    int	   om_textlayer, om_texttype;
+    dlong  om_width, om_height;
+    dlong  om_geomx, om_geomy;
+    dlong  om_placex, om_placey;
+    dlong  om_textx, om_texty;
+    char  *om_cell;		/* Name of the placed cell */
+    char  *om_text;		/* Text string */
+    OasisPoints om_polygon;	/* Polygon point list */
+    OasisPoints om_path;	/* Path point list */
+    dlong  om_halfwidth;	/* Path half-width */
+    int	   om_startScheme;	/* Path start extension scheme */
+    int	   om_endScheme;	/* Path end extension scheme */
+    dlong  om_startExt;		/* Explicit start extension */
+    dlong  om_endExt;		/* Explicit end extension */
+    OasisRep om_rep;		/* Repetition */
+} OasisModal;
+
+static OasisModal oasisModal;
+
+/* Input of an inflated CBLOCK record, read before the file itself */
+static unsigned char *oasisBlock = NULL;
+static unsigned char *oasisBlockPtr = NULL;
+static unsigned char *oasisBlockEnd = NULL;
+
+/* Set on end of file or bad input;  the read stops at the next record */
+static bool oasisFailed;
+
+/* Reading the tables (pass 1) or the cells (pass 2) */
+static int oasisPass;
+
+/* Tables from CELLNAME and TEXTSTRING records, keyed by reference number */
+static HashTable oasisCellNames;
+static HashTable oasisTextStrings;
+static int oasisCellNameNum, oasisTextStringNum;
+
+/* TRUE for the offset-flag of START:  tables are given in END */
+static bool oasisTablesAtEnd;
+
+/* State of the cell being read */
+static bool oasisInCell;	/* TRUE if there is a cell being read */
+static bool oasisSkipCell;	/* TRUE to skip the elements of the cell */
+static int oasisPolygonCount;	/* CalmaPolygonCount at start of cell */
+static CellDef *oasisLastDef;	/* Last cell read */
+
+/* Warn only once about each unsupported kind of element */
+static bool oasisWarnedCTrapezoid, oasisWarnedCircle;
+
+#define oasisGetc() \
+	((oasisBlockPtr < oasisBlockEnd) ? (int)*oasisBlockPtr++ : oasisGetFile())
+
+/* Forward declarations */
+extern bool oasisReadRecord(void);
+extern void oasisEndCell(void);
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisError --
+ *
+ * Report an error in the input:  through CalmaReadError() within a
+ * cell, so that "gds warning" settings apply, or directly otherwise.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Prints an error message.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisError(const char *format, ...)
+{
+    va_list args;
+    char mesg[1024];
+
+    va_start(args, format);
+    vsnprintf(mesg, sizeof(mesg), format, args);
+    va_end(args);
+
+    if (cifReadCellDef != NULL)
+	CalmaReadError("%s", mesg);
+    else
+	TxError("Error while reading OASIS: %s", mesg);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisGetFile --
+ *
+ * Read the next byte from the file, once any CBLOCK is used up.
+ *
+ * Results:
+ *	The next byte, or 0 at the end of the file.
+ *
+ * Side effects:
+ *	Sets oasisFailed at the end of the file.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisGetFile(void)
+{
+    int c;
+
+    c = calmaGetc();
+    if (c < 0)
+    {
+	oasisFailed = TRUE;
+	return 0;
+    }
+    return c;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadUInt --
+ * oasisReadSInt --
+ *
+ * Read an unsigned or signed integer:  seven bits to a byte, least
+ * significant first, continued while the top bit is set.  A signed
+ * integer keeps its sign in the lowest bit.
+ *
+ * Results:
+ *	The integer read.
+ *
+ * Side effects:
+ *	Consumes input.  Sets oasisFailed for integers too large to keep.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+unsigned long long
+oasisReadUInt(void)
+{
+    unsigned long long value = 0;
+    int c, shift = 0;
+
+    do
+    {
+	c = oasisGetc();
+	if (shift < 63)
+	    value |= (unsigned long long)(c & 0x7f) << shift;
+	else if (c & 0x7f)
+	    oasisFailed = TRUE;
+	shift += 7;
+    } while ((c & 0x80) && !oasisFailed);
+    return value;
+}
+
+dlong
+oasisReadSInt(void)
+{
+    unsigned long long value = oasisReadUInt();
+
+    if (value & 1)
+	return -(dlong)(value >> 1);
+    return (dlong)(value >> 1);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadRealType --
+ * oasisReadReal --
+ *
+ * Read a real number of the given type, or its type and then the
+ * number.  Types 0 to 5 are integers, reciprocals and ratios;  6 and 7
+ * are IEEE floats of four and eight bytes, least significant first.
+ *
+ * Results:
+ *	The number read.
+ *
+ * Side effects:
+ *	Consumes input.  Sets oasisFailed for an unknown type.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+double
+oasisReadRealType(
+    int type)
+{
+    union { unsigned char uc[8]; float f; double d; unsigned long long u; } u;
+    double d, n;
+    int i;
+
+    switch (type)
+    {
+	case 0: return (double)oasisReadUInt();
+	case 1: return -(double)oasisReadUInt();
+	case 2:
+	case 3:
+	    d = (double)oasisReadUInt();
+	    if (d == 0.0) d = 1.0;
+	    return (type == 2) ? 1.0 / d : -1.0 / d;
+	case 4:
+	case 5:
+	    n = (double)oasisReadUInt();
+	    d = (double)oasisReadUInt();
+	    if (d == 0.0) d = 1.0;
+	    return (type == 4) ? n / d : -n / d;
+	case 6:
+	    u.u = 0;
+	    for (i = 0; i < 4; i++)
+		u.u |= (unsigned long long)oasisGetc() << (8 * i);
+	    {
+		unsigned int w = (unsigned int)u.u;
+		float f;
+
+		memcpy(&f, &w, sizeof(f));
+		return (double)f;
+	    }
+	case 7:
+	    u.u = 0;
+	    for (i = 0; i < 8; i++)
+		u.u |= (unsigned long long)oasisGetc() << (8 * i);
+	    return u.d;
+	default:
+	    oasisFailed = TRUE;
+	    return 0.0;
+    }
+}
+
+double
+oasisReadReal(void)
+{
+    return oasisReadRealType((int)oasisReadUInt());
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadString --
+ * oasisSkipString --
+ *
+ * Read a string, given as its length and its bytes, or skip over one.
+ *
+ * Results:
+ *	oasisReadString() returns the string, allocated with mallocMagic(),
+ *	or NULL on a read failure.
+ *
+ * Side effects:
+ *	Consumes input.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+char *
+oasisReadString(void)
+{
+    unsigned long long len;
+    char *s;
+    int i;
+
+    len = oasisReadUInt();
+    if (oasisFailed || (len > (1 << 24)))
+    {
+	oasisFailed = TRUE;
+	return NULL;
+    }
+    s = (char *)mallocMagic(len + 1);
+    for (i = 0; i < (int)len; i++)
+	s[i] = (char)oasisGetc();
+    s[len] = '\0';
+    return s;
+}
+
+void
+oasisSkipString(void)
+{
+    unsigned long long len;
+
+    len = oasisReadUInt();
+    while ((len-- > 0) && !oasisFailed)
+	(void) oasisGetc();
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadGDelta --
+ *
+ * Read a g-delta:  a displacement along one of eight directions in one
+ * integer, or any displacement in two.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Sets *pdx and *pdy.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisReadGDelta(
+    dlong *pdx,
+    dlong *pdy)
+{
+    unsigned long long value;
+    dlong mag;
+
+    value = oasisReadUInt();
+    if (value & 1)
+    {
+	mag = (dlong)(value >> 2);
+	*pdx = (value & 2) ? -mag : mag;
+	*pdy = oasisReadSInt();
+	return;
+    }
+    mag = (dlong)(value >> 4);
+    switch ((value >> 1) & 7)
+    {
+	case 0: *pdx = mag;  *pdy = 0;    break;	/* East */
+	case 1: *pdx = 0;    *pdy = mag;  break;	/* North */
+	case 2: *pdx = -mag; *pdy = 0;    break;	/* West */
+	case 3: *pdx = 0;    *pdy = -mag; break;	/* South */
+	case 4: *pdx = mag;  *pdy = mag;  break;	/* Northeast */
+	case 5: *pdx = -mag; *pdy = mag;  break;	/* Northwest */
+	case 6: *pdx = -mag; *pdy = -mag; break;	/* Southwest */
+	case 7: *pdx = mag;  *pdy = -mag; break;	/* Southeast */
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisAddPoint --
+ * oasisAddOffset --
+ *
+ * Append a point to a point list, or an offset to a repetition,
+ * growing its arrays as needed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May reallocate the arrays.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisGrow(
+    int *psize,
+    int n,
+    dlong **px,
+    dlong **py)
+{
+    dlong *newx, *newy;
+
+    if (n < *psize) return;
+    *psize = (*psize == 0) ? 64 : *psize * 2;
+    newx = (dlong *)mallocMagic(*psize * sizeof(dlong));
+    newy = (dlong *)mallocMagic(*psize * sizeof(dlong));
+    if (*px != NULL)
+    {
+	memcpy(newx, *px, n * sizeof(dlong));
+	memcpy(newy, *py, n * sizeof(dlong));
+	freeMagic((char *)*px);
+	freeMagic((char *)*py);
+    }
+    *px = newx;
+    *py = newy;
+}
+
+void
+oasisAddPoint(
+    OasisPoints *op,
+    dlong x,
+    dlong y)
+{
+    oasisGrow(&op->op_size, op->op_n, &op->op_x, &op->op_y);
+    op->op_x[op->op_n] = x;
+    op->op_y[op->op_n] = y;
+    op->op_n++;
+}
+
+void
+oasisAddOffset(
+    OasisRep *or,
+    dlong x,
+    dlong y)
+{
+    oasisGrow(&or->or_size, or->or_n, &or->or_x, &or->or_y);
+    or->or_x[or->or_n] = x;
+    or->or_y[or->or_n] = y;
+    or->or_n++;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadPointList --
+ *
+ * Read a point list into 'op'.  For a polygon ('isPolygon' TRUE), the
+ * last point of a list of alternating horizontal and vertical deltas
+ * is implied and added here;  the closing point is never included.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Replaces the contents of 'op'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisReadPointList(
+    OasisPoints *op,
+    bool isPolygon)
+{
+    int type, i, dir;
+    unsigned long long count, value;
+    dlong x = 0, y = 0, dx, dy, ddx = 0, ddy = 0, mag;
+
+    type = (int)oasisReadUInt();
+    count = oasisReadUInt();
+    if (oasisFailed || (count > (1 << 24)))
+    {
+	oasisFailed = TRUE;
+	return;
+    }
+    op->op_n = 0;
+    oasisAddPoint(op, 0, 0);
+
+    for (i = 0; (i < (int)count) && !oasisFailed; i++)
+    {
+	switch (type)
+	{
+	    case OASIS_PTS_HFIRST:
+	    case OASIS_PTS_VFIRST:
+		if (((i & 1) == 0) == (type == OASIS_PTS_HFIRST))
+		    x += oasisReadSInt();
+		else
+		    y += oasisReadSInt();
+		break;
+	    case OASIS_PTS_2DELTA:
+		value = oasisReadUInt();
+		mag = (dlong)(value >> 2);
+		switch (value & 3)
+		{
+		    case 0: x += mag; break;
+		    case 1: y += mag; break;
+		    case 2: x -= mag; break;
+		    case 3: y -= mag; break;
+		}
+		break;
+	    case OASIS_PTS_3DELTA:
+		value = oasisReadUInt();
+		mag = (dlong)(value >> 3);
+		dir = (int)(value & 7);
+		if ((dir == 0) || (dir == 4) || (dir == 7)) x += mag;
+		if ((dir == 2) || (dir == 5) || (dir == 6)) x -= mag;
+		if ((dir == 1) || (dir == 4) || (dir == 5)) y += mag;
+		if ((dir == 3) || (dir == 6) || (dir == 7)) y -= mag;
+		break;
+	    case OASIS_PTS_GDELTA:
+		oasisReadGDelta(&dx, &dy);
+		x += dx;
+		y += dy;
+		break;
+	    case OASIS_PTS_DDELTA:
+		oasisReadGDelta(&dx, &dy);
+		ddx += dx;
+		ddy += dy;
+		x += ddx;
+		y += ddy;
+		break;
+	    default:
+		oasisFailed = TRUE;
+		return;
+	}
+	oasisAddPoint(op, x, y);
+    }
+
+    /* The implied last point of a Manhattan polygon */
+    if (isPolygon && ((type == OASIS_PTS_HFIRST) || (type == OASIS_PTS_VFIRST)))
+    {
+	if (((count & 1) == 0) == (type == OASIS_PTS_HFIRST))
+	    oasisAddPoint(op, 0, y);
+	else
+	    oasisAddPoint(op, x, 0);
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadRepCount --
+ *
+ * Read the count of columns, rows or offsets of a repetition, which is
+ * stored as two less than the count.
+ *
+ * Results:
+ *	The count, or 1 if it is larger than OASIS_MAX_REPEAT.
+ *
+ * Side effects:
+ *	Consumes input.  Sets oasisFailed for a count that is too large.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisReadRepCount(void)
+{
+    unsigned long long count = oasisReadUInt();
+
+    if (count > OASIS_MAX_REPEAT - 2)
+    {
+	oasisError("Repetition of %llu copies is too large.\n", count + 2);
+	oasisFailed = TRUE;
+	return 1;
+    }
+    return (int)count + 2;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadRepetition --
+ *
+ * Read a repetition into 'or', or leave 'or' as it is for a reference
+ * to the previous repetition.  Grids of copies stepped by one or two
+ * vectors are kept as such;  other repetitions become lists of offsets.
+ * A repetition of more than OASIS_MAX_REPEAT copies is an error.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisReadRepetition(
+    OasisRep *or)
+{
+    int type, n, i;
+    dlong grid, x, y, dx, dy;
+
+    type = (int)oasisReadUInt();
+    if (type == OASIS_REP_REUSE)
+    {
+	if (!or->or_valid)
+	{
+	    oasisError("Repetition reused before one was given.\n");
+	    oasisFailed = TRUE;
+	}
+	return;
+    }
+
+    or->or_valid = TRUE;
+    or->or_n = 0;
+    or->or_nx = or->or_ny = 1;
+    or->or_v1x = or->or_v1y = or->or_v2x = or->or_v2y = 0;
+
+    switch (type)
+    {
+	case OASIS_REP_GRID:
+	    or->or_nx = oasisReadRepCount();
+	    or->or_ny = oasisReadRepCount();
+	    or->or_v1x = (dlong)oasisReadUInt();
+	    or->or_v2y = (dlong)oasisReadUInt();
+	    break;
+	case OASIS_REP_XROW:
+	    or->or_nx = oasisReadRepCount();
+	    or->or_v1x = (dlong)oasisReadUInt();
+	    break;
+	case OASIS_REP_YCOL:
+	    or->or_ny = oasisReadRepCount();
+	    or->or_v2y = (dlong)oasisReadUInt();
+	    break;
+	case 4: case 5:		/* Arbitrary spacings along x */
+	case 6: case 7:		/* Arbitrary spacings along y */
+	    n = oasisReadRepCount();
+	    grid = ((type == 5) || (type == 7)) ? (dlong)oasisReadUInt() : 1;
+	    x = 0;
+	    oasisAddOffset(or, 0, 0);
+	    for (i = 1; (i < n) && !oasisFailed; i++)
+	    {
+		x += (dlong)oasisReadUInt() * grid;
+		if (type <= 5)
+		    oasisAddOffset(or, x, 0);
+		else
+		    oasisAddOffset(or, 0, x);
+	    }
+	    break;
+	case OASIS_REP_VGRID:
+	    or->or_nx = oasisReadRepCount();
+	    or->or_ny = oasisReadRepCount();
+	    oasisReadGDelta(&or->or_v1x, &or->or_v1y);
+	    oasisReadGDelta(&or->or_v2x, &or->or_v2y);
+	    break;
+	case OASIS_REP_VROW:
+	    or->or_nx = oasisReadRepCount();
+	    oasisReadGDelta(&or->or_v1x, &or->or_v1y);
+	    break;
+	case 10: case 11:	/* Arbitrary displacements */
+	    n = oasisReadRepCount();
+	    grid = (type == 11) ? (dlong)oasisReadUInt() : 1;
+	    x = y = 0;
+	    oasisAddOffset(or, 0, 0);
+	    for (i = 1; (i < n) && !oasisFailed; i++)
+	    {
+		oasisReadGDelta(&dx, &dy);
+		x += dx * grid;
+		y += dy * grid;
+		oasisAddOffset(or, x, y);
+	    }
+	    break;
+	default:
+	    oasisError("Unknown repetition type %d.\n", type);
+	    oasisFailed = TRUE;
+	    break;
+    }
+
+    if ((dlong)or->or_nx * (dlong)or->or_ny > OASIS_MAX_REPEAT)
+    {
+	oasisError("Repetition of %d by %d copies is too large.\n",
+		or->or_nx, or->or_ny);
+	oasisFailed = TRUE;
+    }
+    if (oasisFailed)
+    {
+	or->or_valid = FALSE;
+	or->or_n = 0;
+	or->or_nx = or->or_ny = 1;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisRepCount --
+ * oasisRepOffset --
+ *
+ * Return the number of copies made by a repetition (1 for none), and
+ * the offset of copy 'i'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisRepCount(
+    OasisRep *or)	/* Repetition, or NULL */
+{
+    if (or == NULL) return 1;
+    if (or->or_n > 0) return or->or_n;
+    return or->or_nx * or->or_ny;
+}
+
+void
+oasisRepOffset(
+    OasisRep *or,	/* Repetition, or NULL */
+    int i,
+    dlong *pdx,
+    dlong *pdy)
+{
+    if (or == NULL)
+	*pdx = *pdy = 0;
+    else if (or->or_n > 0)
+    {
+	*pdx = or->or_x[i];
+	*pdy = or->or_y[i];
+    }
+    else
+    {
+	*pdx = (i % or->or_nx) * or->or_v1x + (i / or->or_nx) * or->or_v2x;
+	*pdy = (i % or->or_nx) * or->or_v1y + (i / or->or_nx) * or->or_v2y;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadXY --
+ *
+ * Read the position of an element into the modal variables for it,
+ * adding to them if positions are relative.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Modifies *px and *py.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisReadXY(
+    int info,		/* Info-byte of the element */
+    int xbit,		/* Bit in 'info' for x */
+    int ybit,		/* Bit in 'info' for y */
+    dlong *px,		/* Modal x */
+    dlong *py)		/* Modal y */
+{
+    if (info & xbit)
+    {
+	if (oasisModal.om_relative)
+	    *px += oasisReadSInt();
+	else
+	    *px = oasisReadSInt();
+    }
+    if (info & ybit)
+    {
+	if (oasisModal.om_relative)
+	    *py += oasisReadSInt();
+	else
+	    *py = oasisReadSInt();
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisMakePath --
+ *
+ * Convert a point list at (x, y), in OASIS units, to a CIFPath in CIF
+ * units times 'iscale', as calmaReadPath() does.  If a point causes
+ * the scale to change, the whole list is converted again.
+ *
+ * Results:
+ *	The path, or NULL if it has no points.
+ *
+ * Side effects:
+ *	May change the input scale (see calmaScaleValue()).  Increments
+ *	calmaNonManhattan for a non-Manhattan path.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+CIFPath *
+oasisMakePath(
+    OasisPoints *op,	/* Points relative to (x, y) */
+    dlong x,
+    dlong y,
+    int iscale,		/* 1 for polygons, 2 for path centerlines */
+    bool close)		/* Repeat the first point at the end */
+{
+    CIFPath *pathheadp, *pathtailp, *newpathp;
+    Point p;
+    int i, n, savescale;
+    bool nonManhattan;
+
+    do
+    {
+	savescale = calmaReadScale1;
+	pathheadp = pathtailp = (CIFPath *)NULL;
+	nonManhattan = FALSE;
+	n = op->op_n + (close ? 1 : 0);
+	for (i = 0; i < n; i++)
+	{
+	    p.p_x = calmaScaleValue((int)(x + op->op_x[i % op->op_n]), iscale);
+	    p.p_y = calmaScaleValue((int)(y + op->op_y[i % op->op_n]), iscale);
+
+	    /* Drop repeated points */
+	    if ((pathtailp != NULL) && GEO_SAMEPOINT(pathtailp->cifp_point, p))
+		continue;
+
+	    newpathp = (CIFPath *)mallocMagic(sizeof (CIFPath));
+	    newpathp->cifp_point = p;
+	    newpathp->cifp_next = (CIFPath *)NULL;
+	    if (pathtailp != NULL)
+	    {
+		if ((pathtailp->cifp_x != p.p_x) && (pathtailp->cifp_y != p.p_y))
+		    nonManhattan = TRUE;
+		pathtailp->cifp_next = newpathp;
+	    }
+	    else
+		pathheadp = newpathp;
+	    pathtailp = newpathp;
+	}
+	if (savescale != calmaReadScale1)
+	    CIFFreePath(pathheadp);
+    } while (savescale != calmaReadScale1);
+
+    if (nonManhattan) calmaNonManhattan++;
+    return pathheadp;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPaintPolygon --
+ *
+ * Paint the polygon 'op' at (x, y) and at each offset of the
+ * repetition 'or' on (layer, dt), as a GDS-II boundary.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Paints into the CIF planes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisPaintPolygon(
+    OasisPoints *op,
+    dlong x,
+    dlong y,
+    OasisRep *or,
+    int layer,
+    int dt)
+{
+    int ciftype, i, count;
+    dlong dx, dy;
+    CIFPath *pathheadp;
+
+    ciftype = CIFCalmaLayerToCifLayer(layer, dt, cifCurReadStyle);
+    if (ciftype < 0)
+    {
+	calmaLayerError("Unknown layer/datatype in boundary", layer, dt);
+	return;
+    }
+    if (op->op_n < 3) return;
+
+    count = oasisRepCount(or);
+    for (i = 0; i < count; i++)
+    {
+	oasisRepOffset(or, i, &dx, &dy);
+	calmaNonManhattan = 0;
+	pathheadp = oasisMakePath(op, x + dx, y + dy, 1, TRUE);
+	if (pathheadp != NULL)
+	    calmaPaintBoundary(pathheadp, (LinkedRect *)NULL, ciftype);
+    }
+    calmaNonManhattan = 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisElementRectangle --
+ *
+ * Read a RECTANGLE record and paint its rectangles.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Paints into the CIF planes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisElementRectangle(void)
+{
+    OasisModal *om = &oasisModal;
+    int info, ciftype, i, count, savescale;
+    dlong dx, dy, x, y;
+    LinkedRect *rp;
+    Rect r;
+
+    info = oasisGetc();
+    if (info & OASIS_INFO_L) om->om_layer = (int)oasisReadUInt();
+    if (info & OASIS_INFO_D) om->om_datatype = (int)oasisReadUInt();
+    if (info & OASIS_INFO_W) om->om_width = (dlong)oasisReadUInt();
+    if (info & OASIS_INFO_S)
+	om->om_height = om->om_width;
+    else if (info & OASIS_INFO_H)
+	om->om_height = (dlong)oasisReadUInt();
+    oasisReadXY(info, OASIS_INFO_X, OASIS_INFO_Y, &om->om_geomx, &om->om_geomy);
+    if (info & OASIS_INFO_R) oasisReadRepetition(&om->om_rep);
+
+    if ((oasisPass == 1) || oasisSkipCell || oasisFailed) return;
+
+    ciftype = CIFCalmaLayerToCifLayer(om->om_layer, om->om_datatype,
+		cifCurReadStyle);
+    if (ciftype < 0)
+    {
+	calmaLayerError("Unknown layer/datatype in box", om->om_layer,
+		om->om_datatype);
+	return;
+    }
+
+    count = (info & OASIS_INFO_R) ? oasisRepCount(&om->om_rep) : 1;
+    for (i = 0; i < count; i++)
+    {
+	oasisRepOffset((info & OASIS_INFO_R) ? &om->om_rep : NULL, i, &dx, &dy);
+	x = om->om_geomx + dx;
+	y = om->om_geomy + dy;
+	do
+	{
+	    savescale = calmaReadScale1;
+	    r.r_xbot = calmaScaleValue((int)x, 1);
+	    r.r_ybot = calmaScaleValue((int)y, 1);
+	    r.r_xtop = calmaScaleValue((int)(x + om->om_width), 1);
+	    r.r_ytop = calmaScaleValue((int)(y + om->om_height), 1);
+	} while (savescale != calmaReadScale1);
+
+	if ((r.r_xtop <= r.r_xbot) || (r.r_ytop <= r.r_ybot))
+	    continue;
+	rp = (LinkedRect *)mallocMagic(sizeof (LinkedRect));
+	rp->r_r = r;
+	rp->r_next = (LinkedRect *)NULL;
+	calmaPaintBoundary((CIFPath *)NULL, rp, ciftype);
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisElementPolygon --
+ * oasisElementTrapezoid --
+ *
+ * Read a POLYGON or TRAPEZOID record and paint it.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Paints into the CIF planes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisElementPolygon(void)
+{
+    OasisModal *om = &oasisModal;
+    int info;
+
+    info = oasisGetc();
+    if (info & OASIS_INFO_L) om->om_layer = (int)oasisReadUInt();
+    if (info & OASIS_INFO_D) om->om_datatype = (int)oasisReadUInt();
+    if (info & OASIS_INFO_P) oasisReadPointList(&om->om_polygon, TRUE);
+    oasisReadXY(info, OASIS_INFO_X, OASIS_INFO_Y, &om->om_geomx, &om->om_geomy);
+    if (info & OASIS_INFO_R) oasisReadRepetition(&om->om_rep);
+
+    if ((oasisPass == 1) || oasisSkipCell || oasisFailed) return;
+
+    oasisPaintPolygon(&om->om_polygon, om->om_geomx, om->om_geomy,
+		(info & OASIS_INFO_R) ? &om->om_rep : NULL,
+		om->om_layer, om->om_datatype);
+}
+
+void
+oasisElementTrapezoid(
+    int rtype)		/* OASIS_TRAPEZOID, OASIS_TRAPEZOID_A or _B */
+{
+    OasisModal *om = &oasisModal;
+    static OasisPoints trap = { 0, 0, NULL, NULL };
+    int info;
+    dlong da = 0, db = 0, w, h;
+
+    info = oasisGetc();
+    if (info & OASIS_INFO_L) om->om_layer = (int)oasisReadUInt();
+    if (info & OASIS_INFO_D) om->om_datatype = (int)oasisReadUInt();
+    if (info & OASIS_INFO_W) om->om_width = (dlong)oasisReadUInt();
+    if (info & OASIS_INFO_H) om->om_height = (dlong)oasisReadUInt();
+    if (rtype != OASIS_TRAPEZOID_B) da = oasisReadSInt();
+    if (rtype != OASIS_TRAPEZOID_A) db = oasisReadSInt();
+    oasisReadXY(info, OASIS_INFO_X, OASIS_INFO_Y, &om->om_geomx, &om->om_geomy);
+    if (info & OASIS_INFO_R) oasisReadRepetition(&om->om_rep);
+
+    if ((oasisPass == 1) || oasisSkipCell || oasisFailed) return;
+
+    /* Corners of the trapezoid in its bounding box */
+    w = om->om_width;
+    h = om->om_height;
+    trap.op_n = 0;
+    if (info & OASIS_INFO_O)
+    {
+	/* Vertical:  delta-a and delta-b move the bottom and top edges */
+	oasisAddPoint(&trap, 0, MAX(da, 0));
+	oasisAddPoint(&trap, 0, h + MIN(db, 0));
+	oasisAddPoint(&trap, w, h - MAX(db, 0));
+	oasisAddPoint(&trap, w, -MIN(da, 0));
+    }
+    else
+    {
+	/* Horizontal:  delta-a and delta-b move the left and right edges */
+	oasisAddPoint(&trap, MAX(da, 0), h);
+	oasisAddPoint(&trap, w + MIN(db, 0), h);
+	oasisAddPoint(&trap, w - MAX(db, 0), 0);
+	oasisAddPoint(&trap, -MIN(da, 0), 0);
+    }
+    oasisPaintPolygon(&trap, om->om_geomx, om->om_geomy,
+		(info & OASIS_INFO_R) ? &om->om_rep : NULL,
+		om->om_layer, om->om_datatype);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisElementPath --
+ *
+ * Read a PATH record and paint it as a GDS-II path.  Ends extended by
+ * half the width become square-plus ends;  others are extended by the
+ * given amount.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Paints into the CIF planes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisElementPath(void)
+{
+    OasisModal *om = &oasisModal;
+    int info, scheme, pathtype, i, count, savescale, width, extend1, extend2;
+    dlong dx, dy, ext1, ext2;
+    CIFPath *pathheadp;
+
+    info = oasisGetc();
+    if (info & OASIS_INFO_L) om->om_layer = (int)oasisReadUInt();
+    if (info & OASIS_INFO_D) om->om_datatype = (int)oasisReadUInt();
+    if (info & OASIS_INFO_PW) om->om_halfwidth = (dlong)oasisReadUInt();
+    if (info & OASIS_INFO_PE)
+    {
+	scheme = (int)oasisReadUInt();
+	if ((scheme >> 2) & 3) om->om_startScheme = (scheme >> 2) & 3;
+	if (scheme & 3) om->om_endScheme = scheme & 3;
+	if (((scheme >> 2) & 3) == 3) om->om_startExt = oasisReadSInt();
+	if ((scheme & 3) == 3) om->om_endExt = oasisReadSInt();
+    }
+    if (info & OASIS_INFO_P) oasisReadPointList(&om->om_path, FALSE);
+    oasisReadXY(info, OASIS_INFO_X, OASIS_INFO_Y, &om->om_geomx, &om->om_geomy);
+    if (info & OASIS_INFO_R) oasisReadRepetition(&om->om_rep);
+
+    if ((oasisPass == 1) || oasisSkipCell || oasisFailed) return;
+
+    /* Extensions:  1 is flush, 2 is half the width, 3 is explicit */
+    ext1 = (om->om_startScheme == 2) ? om->om_halfwidth :
+		(om->om_startScheme == 3) ? om->om_startExt : 0;
+    ext2 = (om->om_endScheme == 2) ? om->om_halfwidth :
+		(om->om_endScheme == 3) ? om->om_endExt : 0;
+    if ((om->om_startScheme == 2) && (om->om_endScheme == 2))
+    {
+	pathtype = CALMAPATH_SQUAREPLUS;
+	ext1 = ext2 = 0;
+    }
+    else if ((ext1 > 0) || (ext2 > 0))
+	pathtype = CALMAPATH_CUSTOM;
+    else
+	pathtype = CALMAPATH_SQUAREFLUSH;
+    if (ext1 < 0) ext1 = 0;
+    if (ext2 < 0) ext2 = 0;
+
+    count = (info & OASIS_INFO_R) ? oasisRepCount(&om->om_rep) : 1;
+    for (i = 0; i < count; i++)
+    {
+	oasisRepOffset((info & OASIS_INFO_R) ? &om->om_rep : NULL, i, &dx, &dy);
+
+	/* Points and extensions in CIF units times 2, width in CIF units */
+	do
+	{
+	    savescale = calmaReadScale1;
+	    width = calmaScaleValue((int)om->om_halfwidth, 2);
+	    extend1 = calmaScaleValue((int)ext1, 2);
+	    extend2 = calmaScaleValue((int)ext2, 2);
+	    calmaNonManhattan = 0;
+	    pathheadp = oasisMakePath(&om->om_path, om->om_geomx + dx,
+			om->om_geomy + dy, 2, FALSE);
+	    if (savescale != calmaReadScale1)
+		CIFFreePath(pathheadp);
+	} while (savescale != calmaReadScale1);
+
+	if (pathheadp != NULL)
+	    calmaPaintPath(pathheadp, width, extend1, extend2, pathtype,
+			om->om_layer, om->om_datatype);
+    }
+    calmaNonManhattan = 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisElementText --
+ *
+ * Read a TEXT record and place its labels, centered on their position
+ * as OASIS has no justification.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Adds labels to the cell.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisElementText(void)
+{
+    OasisModal *om = &oasisModal;
+    int info, cifnum, i, count;
+    dlong dx, dy;
+    TileType type;
+    HashEntry *he;
+    Rect r;
+
+    info = oasisGetc();
+    if (info & OASIS_INFO_C)
+    {
+	if (om->om_text != NULL) freeMagic(om->om_text);
+	om->om_text = NULL;
+	if (info & OASIS_INFO_N)
+	{
+	    unsigned long long refnum = oasisReadUInt();
+
+	    if (oasisPass == 2)
+	    {
+		he = HashLookOnly(&oasisTextStrings, (char *)(spointertype)refnum);
+		if (he == NULL)
+		    oasisError("Text string %llu is not defined.\n", refnum);
+		else
+		    om->om_text = StrDup((char **)NULL, (char *)HashGetValue(he));
+	    }
+	}
+	else
+	    om->om_text = oasisReadString();
+    }
+    if (info & OASIS_INFO_L) om->om_textlayer = (int)oasisReadUInt();
+    if (info & OASIS_INFO_T) om->om_texttype = (int)oasisReadUInt();
+    oasisReadXY(info, OASIS_INFO_X, OASIS_INFO_Y, &om->om_textx, &om->om_texty);
+    if (info & OASIS_INFO_R) oasisReadRepetition(&om->om_rep);
+
+    if ((oasisPass == 1) || oasisSkipCell || oasisFailed) return;
+    if (om->om_text == NULL) return;
+
+    type = calmaTextType(om->om_textlayer, om->om_texttype, &cifnum);
+
+    count = (info & OASIS_INFO_R) ? oasisRepCount(&om->om_rep) : 1;
+    for (i = 0; i < count; i++)
+    {
+	oasisRepOffset((info & OASIS_INFO_R) ? &om->om_rep : NULL, i, &dx, &dy);
+	r.r_xbot = calmaScaleValue((int)(om->om_textx + dx), 1);
+	r.r_ybot = calmaScaleValue((int)(om->om_texty + dy), 1);
+	r.r_xbot /= cifCurReadStyle->crs_scaleFactor;
+	r.r_ybot /= cifCurReadStyle->crs_scaleFactor;
+	r.r_ur = r.r_ll;
+	calmaPlaceText(om->om_text, &r, cifnum, type, om->om_textlayer,
+		om->om_texttype, GEO_CENTER, -1, 0, 0);
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisScalePlacement --
+ *
+ * Convert a position or displacement of a placement from OASIS units
+ * to magic units.  Both conversions may change the scale, in which
+ * case the caller's values must be converted again;  this returns
+ * FALSE if that happened.  A position too large for magic is an error;
+ * it sets oasisFailed and gives (0, 0).
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+oasisScalePlacement(
+    dlong x,
+    dlong y,
+    Point *p)
+{
+    int savescale = calmaReadScale1;
+    int savefactor = cifCurReadStyle->crs_scaleFactor;
+
+    if ((x > INFINITY) || (x < MINFINITY) || (y > INFINITY) || (y < MINFINITY))
+    {
+	oasisError("Placement at (%" DLONG_PREFIX "d, %" DLONG_PREFIX "d)"
+		" is out of range.\n", x, y);
+	oasisFailed = TRUE;
+	p->p_x = p->p_y = 0;
+	return TRUE;
+    }
+    p->p_x = CIFScaleCoord(calmaScaleValue((int)x, 1), COORD_EXACT);
+    p->p_y = CIFScaleCoord(calmaScaleValue((int)y, 1), COORD_EXACT);
+    return ((savescale == calmaReadScale1) &&
+		(savefactor == cifCurReadStyle->crs_scaleFactor));
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPlaceUse --
+ *
+ * Place a use of 'def' with transform 'trans' in the cell being read,
+ * as an array if 'xhi' or 'yhi' is nonzero, as calmaElementSref() does.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Adds a use to cifReadCellDef.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisPlaceUse(
+    CellDef *def,
+    Transform *trans,
+    int xhi,
+    int yhi,
+    int xsep,
+    int ysep)
+{
+    CellUse *use;
+
+    use = DBCellNewUse(def, (char *)NULL);
+    if ((xhi > 0) || (yhi > 0))
+	DBMakeArray(use, &GeoIdentityTransform, 0, 0, xhi, yhi, xsep, ysep);
+    DBSetTrans(use, trans);
+    if (DBCellFindDup(use, cifReadCellDef) != NULL)
+    {
+	DBCellDeleteUse(use);
+	oasisError("Warning: cell \"%s\" placed on top of"
+			" itself.  Ignoring the extra one.\n", def->cd_name);
+    }
+    else
+	DBPlaceCell(use, cifReadCellDef);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisElementPlacement --
+ *
+ * Read a PLACEMENT record and place the cell.  A grid repetition whose
+ * steps run along the axes of the placed cell becomes a magic array;
+ * any other repetition is placed as separate uses.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Adds uses to the cell.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisElementPlacement(
+    int rtype)		/* OASIS_PLACEMENT or OASIS_PLACEMENT_MAG */
+{
+    OasisModal *om = &oasisModal;
+    OasisRep *or;
+    int info, i, count, xsep, ysep;
+    double dmag = 1.0, dangle = 0.0;
+    dlong dx, dy;
+    Transform trans, tlin, tinv;
+    Point p, v1, v2, c1, c2;
+    HashEntry *he;
+    CellDef *def;
+
+    info = oasisGetc();
+    if (info & OASIS_INFO_PC)
+    {
+	if (om->om_cell != NULL) freeMagic(om->om_cell);
+	om->om_cell = NULL;
+	if (info & OASIS_INFO_PN)
+	{
+	    unsigned long long refnum = oasisReadUInt();
+
+	    if (oasisPass == 2)
+	    {
+		he = HashLookOnly(&oasisCellNames, (char *)(spointertype)refnum);
+		if (he == NULL)
+		    oasisError("Cell name %llu is not defined.\n", refnum);
+		else
+		    om->om_cell = StrDup((char **)NULL, (char *)HashGetValue(he));
+	    }
+	}
+	else
+	    om->om_cell = oasisReadString();
+    }
+    if (rtype == OASIS_PLACEMENT_MAG)
+    {
+	if (info & OASIS_INFO_M) dmag = oasisReadReal();
+	if (info & OASIS_INFO_A) dangle = oasisReadReal();
+    }
+    else
+	dangle = 90.0 * ((info & OASIS_INFO_AA) >> 1);
+    oasisReadXY(info, OASIS_INFO_PX, OASIS_INFO_PY, &om->om_placex,
+		&om->om_placey);
+    if (info & OASIS_INFO_PR) oasisReadRepetition(&om->om_rep);
+
+    if ((oasisPass == 1) || oasisSkipCell || oasisFailed) return;
+    if (om->om_cell == NULL) return;
+
+    def = calmaLookCell(om->om_cell);
+    if (!def) def = calmaFindCell(om->om_cell, NULL, NULL);
+    if (DBIsAncestor(def, cifReadCellDef))
+    {
+	oasisError("Cell %s is an ancestor of %s",
+			def->cd_name, cifReadCellDef->cd_name);
+	oasisError(" and can't be used as a subcell.\n");
+	oasisError("(Use skipped)\n");
+	return;
+    }
+
+    calmaMakeTransform(&tlin, (info & OASIS_INFO_F) ? TRUE : FALSE,
+		dmag, dangle);
+    GeoInvertTrans(&tlin, &tinv);
+    or = (info & OASIS_INFO_PR) ? &om->om_rep : NULL;
+
+    /* A grid whose steps are along the axes of the cell is an array */
+    if ((or != NULL) && (or->or_n == 0) && (dmag == 1.0))
+    {
+	while (!oasisScalePlacement(om->om_placex, om->om_placey, &p)
+		|| !oasisScalePlacement(or->or_v1x, or->or_v1y, &v1)
+		|| !oasisScalePlacement(or->or_v2x, or->or_v2y, &v2))
+	    /* Scale changed;  convert again */ ;
+	if (oasisFailed) return;
+
+	GeoTransPoint(&tinv, &v1, &c1);
+	GeoTransPoint(&tinv, &v2, &c2);
+	if ((or->or_ny == 1) || (c2.p_x == 0))
+	{
+	    if ((or->or_nx == 1) || (c1.p_y == 0))
+	    {
+		xsep = c1.p_x;
+		ysep = c2.p_y;
+		GeoTranslateTrans(&tlin, p.p_x, p.p_y, &trans);
+		oasisPlaceUse(def, &trans, or->or_nx - 1, or->or_ny - 1,
+			xsep, ysep);
+		return;
+	    }
+	}
+	if (((or->or_ny == 1) || (c2.p_y == 0)) &&
+		((or->or_nx == 1) || (c1.p_x == 0)))
+	{
+	    /* Columns of the grid are rows of the array */
+	    GeoTranslateTrans(&tlin, p.p_x, p.p_y, &trans);
+	    oasisPlaceUse(def, &trans, or->or_ny - 1, or->or_nx - 1,
+			c2.p_x, c1.p_y);
+	    return;
+	}
+    }
+
+    count = oasisRepCount(or);
+    for (i = 0; i < count; i++)
+    {
+	oasisRepOffset(or, i, &dx, &dy);
+	while (!oasisScalePlacement(om->om_placex + dx, om->om_placey + dy, &p))
+	    /* Scale changed;  convert again */ ;
+	if (oasisFailed) return;
+	GeoTranslateTrans(&tlin, p.p_x, p.p_y, &trans);
+	oasisPlaceUse(def, &trans, 0, 0, 0, 0);
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisSkipElement --
+ *
+ * Read and ignore a CTRAPEZOID, CIRCLE or XGEOMETRY record, keeping the
+ * modal variables they set.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisSkipElement(
+    int rtype)
+{
+    OasisModal *om = &oasisModal;
+    int info;
+
+    info = oasisGetc();
+    if (rtype == OASIS_XGEOMETRY)
+	(void) oasisReadUInt();		/* Attribute */
+    if (info & OASIS_INFO_L) om->om_layer = (int)oasisReadUInt();
+    if (info & OASIS_INFO_D) om->om_datatype = (int)oasisReadUInt();
+    switch (rtype)
+    {
+	case OASIS_CTRAPEZOID:
+	    if (info & 0x80) (void) oasisReadUInt();	/* Type */
+	    if (info & OASIS_INFO_W) om->om_width = (dlong)oasisReadUInt();
+	    if (info & OASIS_INFO_H) om->om_height = (dlong)oasisReadUInt();
+	    if ((oasisPass == 2) && !oasisWarnedCTrapezoid)
+	    {
+		oasisError("CTRAPEZOID records are not supported (ignored).\n");
+		oasisWarnedCTrapezoid = TRUE;
+	    }
+	    break;
+	case OASIS_CIRCLE:
+	    if (info & 0x20) (void) oasisReadUInt();	/* Radius */
+	    if ((oasisPass == 2) && !oasisWarnedCircle)
+	    {
+		oasisError("CIRCLE records are not supported (ignored).\n");
+		oasisWarnedCircle = TRUE;
+	    }
+	    break;
+	case OASIS_XGEOMETRY:
+	    oasisSkipString();
+	    break;
+    }
+    oasisReadXY(info, OASIS_INFO_X, OASIS_INFO_Y, &om->om_geomx, &om->om_geomy);
+    if (info & OASIS_INFO_R) oasisReadRepetition(&om->om_rep);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisSkipProperty --
+ *
+ * Read and ignore a PROPERTY record.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisSkipProperty(void)
+{
+    int info, type;
+    unsigned long long count;
+
+    info = oasisGetc();
+    if (info & 0x04)			/* C:  name given */
+    {
+	if (info & 0x02)		/* N:  by reference number */
+	    (void) oasisReadUInt();
+	else
+	    oasisSkipString();
+    }
+    if (info & 0x08) return;		/* V:  reuse the last values */
+
+    count = (info >> 4) & 0xf;
+    if (count == 15) count = oasisReadUInt();
+    while ((count-- > 0) && !oasisFailed)
+    {
+	type = (int)oasisReadUInt();
+	if (type <= 7)
+	    (void) oasisReadRealType(type);
+	else if (type <= 9)
+	    (void) oasisReadUInt();
+	else if (type <= 12)
+	    oasisSkipString();
+	else if (type <= 15)
+	    (void) oasisReadUInt();
+	else
+	    oasisFailed = TRUE;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadName --
+ *
+ * Read a CELLNAME or TEXTSTRING record, and on the first pass save
+ * the name in 'table' under its reference number.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Adds to 'table'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisReadName(
+    HashTable *table,
+    int *pnum,		/* Next implicit reference number */
+    bool explicit)	/* Reference number given in the record */
+{
+    unsigned long long refnum;
+    HashEntry *he;
+    char *name;
+
+    name = oasisReadString();
+    refnum = (explicit) ? oasisReadUInt() : (*pnum)++;
+    if (name == NULL) return;
+    if (oasisPass == 2)
+    {
+	freeMagic(name);
+	return;
+    }
+    he = HashFind(table, (char *)(spointertype)refnum);
+    if (HashGetValue(he) != NULL)
+    {
+	oasisError("Reference number %llu is defined twice.\n", refnum);
+	freeMagic(name);
+    }
+    else
+	HashSetValue(he, name);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadCBlock --
+ *
+ * Read a CBLOCK record and inflate its contents, which are then read
+ * before the rest of the file.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Consumes input.  Sets oasisBlock.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisReadCBlock(void)
+{
+    unsigned long long comptype, ulen, clen;
+
+    comptype = oasisReadUInt();
+    ulen = oasisReadUInt();
+    clen = oasisReadUInt();
+    if (oasisFailed) return;
+
+    if (oasisBlockPtr < oasisBlockEnd)
+    {
+	oasisError("CBLOCK record inside a CBLOCK.\n");
+	oasisFailed = TRUE;
+	return;
+    }
+    if (comptype != OASIS_CBLOCK_DEFLATE)
+    {
+	oasisError("Unknown CBLOCK compression type %llu.\n", comptype);
+	oasisFailed = TRUE;
+	return;
+    }
+    if ((ulen > (1 << 30)) || (clen > (1 << 30)))
+    {
+	oasisError("CBLOCK record of %llu bytes (%llu compressed) is"
+		" too large.\n", ulen, clen);
+	oasisFailed = TRUE;
+	return;
+    }
+
+#ifdef HAVE_ZLIB
+    {
+	z_stream zs;
+	char *cbuf;
+	int result;
+
+	if (oasisBlock != NULL) freeMagic((char *)oasisBlock);
+	oasisBlock = (unsigned char *)mallocMagic(ulen + 1);
+	oasisBlockPtr = oasisBlockEnd = oasisBlock;
+
+	cbuf = (char *)mallocMagic(clen + 1);
+	if (calmaInRead(cbuf, (int)clen) != (int)clen)
+	{
+	    freeMagic(cbuf);
+	    oasisFailed = TRUE;
+	    return;
+	}
+
+	memset(&zs, 0, sizeof(zs));
+	result = inflateInit2(&zs, -15);
+	if (result == Z_OK)
+	{
+	    zs.next_in = (Bytef *)cbuf;
+	    zs.avail_in = (uInt)clen;
+	    zs.next_out = (Bytef *)oasisBlock;
+	    zs.avail_out = (uInt)ulen;
+	    result = inflate(&zs, Z_FINISH);
+	    inflateEnd(&zs);
+	}
+	freeMagic(cbuf);
+	if ((result != Z_STREAM_END) || (zs.total_out != ulen))
+	{
+	    oasisError("Corrupt CBLOCK record.\n");
+	    oasisFailed = TRUE;
+	    return;
+	}
+	oasisBlockEnd = oasisBlock + ulen;
+    }
+#else
+    oasisError("Cannot read CBLOCK records:  magic was compiled"
+		" without zlib.\n");
+    oasisFailed = TRUE;
+#endif
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisBeginCell --
+ *
+ * Start reading the cell 'name', as calmaParseStructure() does.
+ * Cells already defined in this file, and cells that already exist
+ * when "gds noduplicates" is set, are skipped.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets cifReadCellDef and clears it.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisBeginCell(
+    char *name)		/* Name of the cell;  freed here */
+{
+    OasisModal *om = &oasisModal;
+    HashEntry *he;
+    CellDef *def;
+    bool predefined = FALSE, was_called = FALSE;
+    int suffix;
+
+    /* Modal positions are reset by each CELL record */
+    om->om_relative = FALSE;
+    om->om_geomx = om->om_geomy = 0;
+    om->om_placex = om->om_placey = 0;
+    om->om_textx = om->om_texty = 0;
+
+    if (oasisPass == 1)
+    {
+	freeMagic(name);
+	return;
+    }
+    TxPrintf("Reading \"%s\".\n", name);
+    oasisPolygonCount = CalmaPolygonCount;
+    oasisSkipCell = TRUE;
+
+    he = HashFind(&calmaDefInitHash, name);
+    if ((def = (CellDef *)HashGetValue(he)) != NULL)
+    {
+	if (def->cd_flags & CDPROCESSEDGDS)
+	{
+	    cifReadCellDef = def;
+	    oasisError("Cell \"%s\" was already defined in this file.\n",
+				name);
+	    oasisError("Ignoring duplicate definition\n");
+	    freeMagic(name);
+	    return;
+	}
+	else
+	{
+	    char *newname;
+
+	    cifReadCellDef = def;
+	    oasisError("Cell \"%s\" was already defined in this file.\n",
+				name);
+	    newname = (char *)mallocMagic(strlen(name) + 20);
+	    for (suffix = 1; HashGetValue(he) != NULL; suffix++)
+	    {
+		(void) sprintf(newname, "%s_%d", name, suffix);
+		he = HashFind(&calmaDefInitHash, newname);
+	    }
+	    oasisError("Giving this cell a new name: %s\n", newname);
+	    freeMagic(name);
+	    name = newname;
+	}
+    }
+    if (CalmaUnique) calmaUniqueCell(name);	/* Ensure uniqueness */
+    cifReadCellDef = calmaFindCell(name, &was_called, &predefined);
+    HashSetValue(he, cifReadCellDef);
+    freeMagic(name);
+
+    if (predefined) return;
+
+    DBCellClearDef(cifReadCellDef);
+    DBCellSetAvail(cifReadCellDef);
+    cifCurReadPlanes = cifSubcellPlanes;
+    cifReadCellDef->cd_flags &= ~CDDEREFERENCE;
+
+    /* OASIS has no timestamps;  use "calma datestamp" if given */
+    if (CalmaDateStamp == NULL)
+	cifReadCellDef->cd_timestamp = 0;
+    else
+    {
+	cifReadCellDef->cd_timestamp = *CalmaDateStamp;
+	if (*CalmaDateStamp != (time_t)0)
+	    cifReadCellDef->cd_flags |= CDFIXEDSTAMP;
+    }
+
+    /* Initialize the hash table for layer errors */
+    HashInit(&calmaLayerHash, 32, sizeof (CalmaLayerType) / sizeof (unsigned));
+    calmaNonManhattan = 0;
+    oasisInCell = TRUE;
+    oasisSkipCell = FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisEndCell --
+ *
+ * Finish the cell being read, if any:  paint its CIF into the magic
+ * database as calmaParseStructure() does.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Paints into cifReadCellDef.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisEndCell(void)
+{
+    oasisSkipCell = TRUE;
+    if (!oasisInCell) return;
+    oasisInCell = FALSE;
+
+    CIFPaintCurrent(FILE_CALMA);
+    calmaFinishStructure(oasisPolygonCount);
+    HashKill(&calmaLayerHash);
+    oasisLastDef = cifReadCellDef;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadRecord --
+ *
+ * Read one record.  On the first pass, only the names of cells and
+ * text strings are kept;  on the second, the cells are built.
+ *
+ * Results:
+ *	TRUE if there are more records, FALSE after the END record or on
+ *	an error.
+ *
+ * Side effects:
+ *	Consumes input.  Depends on the record.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+oasisReadRecord(void)
+{
+    OasisModal *om = &oasisModal;
+    int rtype, i;
+    char *name;
+    HashEntry *he;
+    unsigned long long refnum;
+
+    rtype = (int)oasisReadUInt();
+    if (oasisFailed) return FALSE;
+
+    /* Name records and CELL records end the cell being read */
+    if ((oasisPass == 2) && (((rtype >= OASIS_CELLNAME) &&
+		(rtype <= OASIS_CELL)) || (rtype == OASIS_END)))
+	oasisEndCell();
+
+    switch (rtype)
+    {
+	case OASIS_PAD:
+	    break;
+	case OASIS_START:
+	    oasisError("START record in the middle of the file.\n");
+	    return FALSE;
+	case OASIS_END:
+	    return FALSE;
+	case OASIS_CELLNAME:
+	case OASIS_CELLNAME_REF:
+	    oasisReadName(&oasisCellNames, &oasisCellNameNum,
+			(rtype == OASIS_CELLNAME_REF));
+	    break;
+	case OASIS_TEXTSTRING:
+	case OASIS_TEXTSTRING_REF:
+	    oasisReadName(&oasisTextStrings, &oasisTextStringNum,
+			(rtype == OASIS_TEXTSTRING_REF));
+	    break;
+	case OASIS_PROPNAME:
+	case OASIS_PROPSTRING:
+	    oasisSkipString();
+	    break;
+	case OASIS_PROPNAME_REF:
+	case OASIS_PROPSTRING_REF:
+	    oasisSkipString();
+	    (void) oasisReadUInt();
+	    break;
+	case OASIS_LAYERNAME:
+	case OASIS_LAYERNAME_TEXT:
+	    oasisSkipString();
+	    for (i = 0; i < 2; i++)		/* Layer and type intervals */
+	    {
+		int itype = (int)oasisReadUInt();
+
+		if (itype > 0) (void) oasisReadUInt();
+		if (itype == 4) (void) oasisReadUInt();
+	    }
+	    break;
+	case OASIS_CELL_REF:
+	    refnum = oasisReadUInt();
+	    name = NULL;
+	    if (oasisPass == 2)
+	    {
+		he = HashLookOnly(&oasisCellNames, (char *)(spointertype)refnum);
+		if (he == NULL)
+		{
+		    oasisError("Cell name %llu is not defined.\n", refnum);
+		    name = (char *)mallocMagic(32);
+		    (void) sprintf(name, "cell%llu", refnum);
+		}
+		else
+		    name = StrDup((char **)NULL, (char *)HashGetValue(he));
+	    }
+	    else
+		name = StrDup((char **)NULL, "");
+	    oasisBeginCell(name);
+	    break;
+	case OASIS_CELL:
+	    name = oasisReadString();
+	    if (name != NULL) oasisBeginCell(name);
+	    break;
+	case OASIS_XYABSOLUTE:
+	    om->om_relative = FALSE;
+	    break;
+	case OASIS_XYRELATIVE:
+	    om->om_relative = TRUE;
+	    break;
+	case OASIS_PLACEMENT:
+	case OASIS_PLACEMENT_MAG:
+	    oasisElementPlacement(rtype);
+	    break;
+	case OASIS_TEXT:
+	    oasisElementText();
+	    break;
+	case OASIS_RECTANGLE:
+	    oasisElementRectangle();
+	    break;
+	case OASIS_POLYGON:
+	    oasisElementPolygon();
+	    break;
+	case OASIS_PATH:
+	    oasisElementPath();
+	    break;
+	case OASIS_TRAPEZOID:
+	case OASIS_TRAPEZOID_A:
+	case OASIS_TRAPEZOID_B:
+	    oasisElementTrapezoid(rtype);
+	    break;
+	case OASIS_CTRAPEZOID:
+	case OASIS_CIRCLE:
+	case OASIS_XGEOMETRY:
+	    oasisSkipElement(rtype);
+	    break;
+	case OASIS_PROPERTY:
+	    oasisSkipProperty();
+	    break;
+	case OASIS_PROPERTY_LAST:
+	    break;
+	case OASIS_XNAME:
+	    (void) oasisReadUInt();
+	    oasisSkipString();
+	    break;
+	case OASIS_XNAME_REF:
+	    (void) oasisReadUInt();
+	    oasisSkipString();
+	    (void) oasisReadUInt();
+	    break;
+	case OASIS_XELEMENT:
+	    (void) oasisReadUInt();
+	    oasisSkipString();
+	    break;
+	case OASIS_CBLOCK:
+	    oasisReadCBlock();
+	    break;
+	default:
+	    oasisError("Unknown OASIS record type %d.\n", rtype);
+	    return FALSE;
+    }
+    if (oasisFailed)
+    {
+	oasisError("Unexpected end of file or bad data in record %d.\n",
+		rtype);
+	return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisReadStart --
+ *
+ * Check the magic bytes and read the START record.
+ *
+ * Results:
+ *	The number of database units per micron, or 0 if the file is not
+ *	an OASIS file.
+ *
+ * Side effects:
+ *	Consumes input.  Sets oasisTablesAtEnd.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+double
+oasisReadStart(void)
+{
+    char magic[OASIS_MAGICLENGTH];
+    char *version;
+    double unit;
+    int i;
+
+    if ((calmaInRead(magic, OASIS_MAGICLENGTH) != OASIS_MAGICLENGTH)
+		|| strncmp(magic, OASIS_MAGIC, OASIS_MAGICLENGTH))
+    {
+	TxError("File is not an OASIS file.\n");
+	return 0.0;
+    }
+    if (oasisReadUInt() != OASIS_START)
+    {
+	TxError("OASIS file does not begin with a START record.\n");
+	return 0.0;
+    }
+    version = oasisReadString();
+    if (version != NULL)
+    {
+	if (strcmp(version, "1.0"))
+	    TxError("Warning:  unknown OASIS version \"%s\".\n", version);
+	freeMagic(version);
+    }
+    unit = oasisReadReal();
+    oasisTablesAtEnd = (oasisReadUInt() != 0);
+    if (!oasisTablesAtEnd)
+	for (i = 0; i < 12; i++)
+	    (void) oasisReadUInt();
+    if (oasisFailed || (unit <= 0.0))
+    {
+	TxError("Bad START record in OASIS file.\n");
+	return 0.0;
+    }
+    return unit;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisModalFree --
+ *
+ * Free the modal strings, point lists and repetition, and reset the
+ * modal variables.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisModalFree(void)
+{
+    OasisModal *om = &oasisModal;
+
+    if (om->om_cell != NULL) freeMagic(om->om_cell);
+    if (om->om_text != NULL) freeMagic(om->om_text);
+    if (om->om_polygon.op_x != NULL)
+    {
+	freeMagic((char *)om->om_polygon.op_x);
+	freeMagic((char *)om->om_polygon.op_y);
+    }
+    if (om->om_path.op_x != NULL)
+    {
+	freeMagic((char *)om->om_path.op_x);
+	freeMagic((char *)om->om_path.op_y);
+    }
+    if (om->om_rep.or_x != NULL)
+    {
+	freeMagic((char *)om->om_rep.or_x);
+	freeMagic((char *)om->om_rep.or_y);
+    }
+    memset(om, 0, sizeof(OasisModal));
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisKillTable --
+ *
+ * Free the names in a table of names and the table itself.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisKillTable(
+    HashTable *table)
+{
+    HashSearch hs;
+    HashEntry *he;
+
+    HashStartSearch(&hs);
+    while ((he = HashNext(table, &hs)) != NULL)
+	if (HashGetValue(he) != NULL)
+	    freeMagic((char *)HashGetValue(he));
+    HashKill(table);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * OasisReadFile --
+ *
+ * Read an entire OASIS file into the magic database, as CalmaReadFile()
+ * does for GDS-II:  each cell of the file becomes a magic cell, and the
+ * cell last defined is loaded into the layout window if nothing uses it.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Many cells are created.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+OasisReadFile(
+    FILETYPE file,		/* File from which to read OASIS */
+    char *filename)		/* The real name of the file read */
+{
+    MagWindow *mw;
+    double unit;
+
+    if (EditCellUse == (CellUse *)NULL)
+    {
+	TxError("Cannot read OASIS:  There is no edit cell.\n");
+	return;
+    }
+
+    /* We will use full cell names as keys in this hash table */
+    CIFReadCellInit(0);
+
+    if (CIFWarningLevel == CIF_WARN_REDIRECT)
+    {
+	if (CIFErrorFilename == NULL)
+	    calmaErrorFile = NULL;
+	else
+	    calmaErrorFile = PaOpen(CIFErrorFilename, "w", (char *)NULL, ".",
+			(char *)NULL, (char **)NULL);
+    }
+
+    if (cifCurReadStyle == NULL)
+    {
+	TxError("Don't know how to read OASIS:\n");
+	TxError("Nothing in \"cifinput\" section of tech file.\n");
+	return;
+    }
+    TxPrintf("Warning: OASIS reading is not undoable!  I hope that's OK.\n");
+    UndoDisable();
+
+    calmaTotalErrors = 0;
+    CalmaPolygonCount = 0;
+    CalmaPathCount = 0;
+
+    /* Reset cd_client pointers (using init function from CalmaWrite.c) */
+    (void) DBCellSrDefs(0, calmaWriteInitFunc, (ClientData) NULL);
+
+    HashInit(&calmaDefInitHash, 32, 0);
+    HashInit(&oasisCellNames, 32, HT_WORDKEYS);
+    HashInit(&oasisTextStrings, 32, HT_WORDKEYS);
+    oasisModalFree();
+    oasisFailed = FALSE;
+    oasisInCell = FALSE;
+    oasisSkipCell = TRUE;
+    oasisLastDef = (CellDef *)NULL;
+    oasisWarnedCTrapezoid = oasisWarnedCircle = FALSE;
+    cifReadCellDef = (CellDef *)NULL;
+
+    calmaInputOpen(file, filename);
+
+    /* First pass:  tables of names */
+    oasisPass = 1;
+    oasisCellNameNum = oasisTextStringNum = 0;
+    unit = oasisReadStart();
+    if (unit == 0.0) goto done;
+    calmaSetScale(1.0e-6 / unit);
+
+    while (oasisReadRecord())
+	if (SigInterruptPending)
+	    goto done;
+    if (oasisFailed) goto done;
+
+    /* Second pass:  cells */
+    oasisPass = 2;
+    oasisModalFree();
+    oasisBlockPtr = oasisBlockEnd = oasisBlock;
+    if (calmaInSeek(0, SEEK_SET) < 0)
+    {
+	TxError("Cannot rewind the OASIS file.\n");
+	goto done;
+    }
+    (void) oasisReadStart();
+    while (oasisReadRecord())
+	if (SigInterruptPending)
+	    break;
+    oasisEndCell();
+
+done:
+    calmaInputClose();
+
+    if (oasisBlock != NULL)
+    {
+	freeMagic((char *)oasisBlock);
+	oasisBlock = oasisBlockPtr = oasisBlockEnd = (unsigned char *)NULL;
+    }
+    oasisModalFree();
+    oasisKillTable(&oasisCellNames);
+    oasisKillTable(&oasisTextStrings);
+
+    /* Load the top cell into the layout window, as "gds read" does	*/
+    /* with the cell named after the library.  Magic writes the top	*/
+    /* cell last.							*/
+
+    if (!CalmaDoLibrary && (oasisLastDef != NULL)
+		&& (oasisLastDef->cd_parents == NULL))
+    {
+	mw = CmdGetRootPoint((Point *)NULL, (Rect *)NULL);
+	if (mw == NULL)
+	    windCheckOnlyWindow(&mw, DBWclientID);
+	if (mw != NULL)
+	    DBWloadWindow(mw, oasisLastDef->cd_name, 0);
+    }
+
+    CIFReadCellCleanup(FILE_CALMA);
+    HashKill(&calmaDefInitHash);
+    UndoEnable();
+
+    if (calmaErrorFile != NULL)
+    {
+	fclose(calmaErrorFile);
+	calmaErrorFile = NULL;
+    }
+}
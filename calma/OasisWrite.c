@@ -0,0 +1,1364 @@
+/*
+ * OasisWrite.c --
+ *
+ * Output of OASIS (SEMI P39) layout files.  The cells, their CIF and
+ * the layer and datatype numbers are the same as for GDS-II output
+ * (CalmaWrite.c), so a file written here reads back through "gds"
+ * settings and the "cifinput" style exactly as the GDS-II file would.
+ *
+ * The encoding takes advantage of what OASIS offers over GDS-II:
+ * tiles are written as RECTANGLE records, with identical rectangles
+ * on a regular grid (contact cuts, for example) collapsed into one
+ * record with a repetition;  coordinates are relative to the previous
+ * element;  and the body of each cell is compressed into a CBLOCK
+ * record when magic is compiled with zlib.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/time.h>		/* for gettimeofday() */
+
+#include "utils/magic.h"
+#include "utils/malloc.h"
+#include "utils/geometry.h"
+#include "tiles/tile.h"
+#include "utils/utils.h"
+#include "utils/magic_zlib.h"
+#include "utils/hash.h"
+#include "database/database.h"
+#include "database/databaseInt.h"
+#include "utils/tech.h"
+#include "cif/cif.h"
+#include "cif/CIFint.h"
+#include "utils/signals.h"
+#include "windows/windows.h"
+#include "dbwind/dbwind.h"
+#include "textio/textio.h"
+#include "calma/calmaInt.h"
+#include "calma/oasisInt.h"
+#include "calma/calma.h"
+
+/* A growing buffer of output bytes */
+
+typedef struct
+{
+    unsigned char *ob_buf;	/* Bytes written so far */
+    size_t	   ob_len;	/* Number of bytes in ob_buf */
+    size_t	   ob_size;	/* Space allocated for ob_buf */
+} OasisBuf;
+
+/*
+ * Modal variables of the output.  OASIS leaves out any field of an
+ * element that is the same as in the previous element;  these are the
+ * values the reader will assume.  They are reset at each CELL record.
+ */
+
+typedef struct
+{
+    int	  om_layer;		/* Layer, or -1 if not yet set */
+    int	  om_datatype;		/* Datatype, or -1 */
+    int	  om_textlayer;		/* Textlayer, or -1 */
+    int	  om_texttype;		/* Texttype, or -1 */
+    int	  om_width;		/* Geometry width, or -1 */
+    int	  om_height;		/* Geometry height, or -1 */
+    Point om_geom;		/* Position of the last shape */
+    Point om_place;		/* Position of the last placement */
+    Point om_text;		/* Position of the last text */
+    CellDef *om_cell;		/* Cell of the last placement, or NULL */
+    bool  om_hasRep;		/* TRUE once a repetition was written */
+    int	  om_nx, om_ny;		/* Last repetition:  counts and steps */
+    Point om_vx, om_vy;
+} OasisModal;
+
+/*
+ * A shape to write:  a rectangle, or a grid of nx by ny identical
+ * rectangles stepped by dx and dy.
+ */
+
+typedef struct
+{
+    int og_x, og_y;		/* Lower left of the first rectangle */
+    int og_w, og_h;		/* Size of each rectangle */
+    int og_nx, og_dx;		/* Columns and their spacing */
+    int og_ny, og_dy;		/* Rows and their spacing */
+} OasisGrid;
+
+/* The body of the cell being written */
+static OasisBuf oasisBody;
+
+/* Modal variables for oasisBody */
+static OasisModal oasisModal;
+
+/* Rectangles of the CIF layer being written (see oasisRectFunc()) */
+static OasisGrid *oasisRects;
+static int oasisNumRects;
+static int oasisRectsSize;
+
+/* Layer and datatype of the CIF layer being written */
+static int oasisLayer;
+static int oasisDatatype;
+
+/* Reference number of the next cell written */
+static int oasisCellNum;
+
+/* Bytes of cell bodies before compression, for the summary */
+static dlong oasisRawBytes;
+
+/* Forward declarations */
+extern int oasisProcessDef(CellDef *def, CalmaStream *f, bool do_library);
+extern int oasisProcessUse(CellUse *use, CalmaStream *f);
+extern void oasisOutCell(CellDef *def, CalmaStream *f);
+extern int oasisWriteUseFunc(CellUse *use, ClientData cdata);
+extern int oasisRectFunc(Tile *tile, TileType dinfo, ClientData cdata);
+extern int oasisPaintLabelFunc(Tile *tile, TileType dinfo, CIFLayer *layer);
+extern void oasisOutRects(void);
+extern void oasisOutLabel(Label *lab, int ltype, int type);
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPutByte --
+ * oasisPutUInt --
+ * oasisPutSInt --
+ * oasisPutString --
+ *
+ * Append a byte, an unsigned integer, a signed integer, or a string
+ * (its length followed by its bytes) to the buffer 'b'.  Integers are
+ * written seven bits to a byte, least significant first, with the top
+ * bit set on all but the last byte;  the sign of a signed integer is
+ * moved to its lowest bit.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Grows the buffer as needed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisPutByte(
+    OasisBuf *b,
+    int c)
+{
+    if (b->ob_len == b->ob_size)
+    {
+	unsigned char *newbuf;
+
+	b->ob_size = (b->ob_size == 0) ? 65536 : b->ob_size * 2;
+	newbuf = (unsigned char *)mallocMagic(b->ob_size);
+	if (b->ob_buf != NULL)
+	{
+	    memcpy(newbuf, b->ob_buf, b->ob_len);
+	    freeMagic((char *)b->ob_buf);
+	}
+	b->ob_buf = newbuf;
+    }
+    b->ob_buf[b->ob_len++] = (unsigned char)c;
+}
+
+void
+oasisPutUInt(
+    OasisBuf *b,
+    unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+	oasisPutByte(b, (int)(value & 0x7f) | 0x80);
+	value >>= 7;
+    }
+    oasisPutByte(b, (int)value);
+}
+
+void
+oasisPutSInt(
+    OasisBuf *b,
+    dlong value)
+{
+    if (value < 0)
+	oasisPutUInt(b, ((unsigned long long)(-value) << 1) | 1);
+    else
+	oasisPutUInt(b, (unsigned long long)value << 1);
+}
+
+void
+oasisPutString(
+    OasisBuf *b,
+    const char *s)
+{
+    size_t len = strlen(s);
+
+    oasisPutUInt(b, len);
+    while (len--)
+	oasisPutByte(b, *s++);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPutGDelta --
+ *
+ * Append the displacement (dx, dy) to 'b' as a g-delta:  in one integer
+ * with a direction if it runs along an axis or a diagonal, or else as
+ * a pair of integers.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to 'b'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisPutGDelta(
+    OasisBuf *b,
+    dlong dx,
+    dlong dy)
+{
+    int dir;
+    dlong mag;
+
+    /* Directions are E, N, W, S, NE, NW, SW, SE */
+    if (dy == 0)
+    {
+	dir = (dx >= 0) ? 0 : 2;
+	mag = ABS(dx);
+    }
+    else if (dx == 0)
+    {
+	dir = (dy > 0) ? 1 : 3;
+	mag = ABS(dy);
+    }
+    else if (dx == dy)
+    {
+	dir = (dx > 0) ? 4 : 6;
+	mag = ABS(dx);
+    }
+    else if (dx == -dy)
+    {
+	dir = (dx > 0) ? 7 : 5;
+	mag = ABS(dx);
+    }
+    else
+    {
+	oasisPutUInt(b, ((unsigned long long)ABS(dx) << 2)
+		| ((dx < 0) ? 2 : 0) | 1);
+	oasisPutSInt(b, dy);
+	return;
+    }
+    oasisPutUInt(b, ((unsigned long long)mag << 4) | (dir << 1));
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPutRepetition --
+ *
+ * Append a repetition of 'nx' copies stepped by 'vx' and 'ny' copies
+ * stepped by 'vy' to 'b', using the shortest form that describes it,
+ * or a reference to the previous repetition if it is the same.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to 'b' and updates the modal repetition.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisPutRepetition(
+    OasisBuf *b,
+    int nx,
+    Point *vx,
+    int ny,
+    Point *vy)
+{
+    OasisModal *om = &oasisModal;
+
+    if (om->om_hasRep && (om->om_nx == nx) && (om->om_ny == ny)
+		&& ((nx == 1) || GEO_SAMEPOINT(om->om_vx, *vx))
+		&& ((ny == 1) || GEO_SAMEPOINT(om->om_vy, *vy)))
+    {
+	oasisPutUInt(b, OASIS_REP_REUSE);
+	return;
+    }
+    om->om_hasRep = TRUE;
+    om->om_nx = nx;
+    om->om_ny = ny;
+    om->om_vx = *vx;
+    om->om_vy = *vy;
+
+    /* A single column or row of two or more is written as a row */
+    if (nx == 1)
+    {
+	nx = ny;
+	vx = vy;
+	ny = 1;
+    }
+
+    if (ny > 1)
+    {
+	if ((vx->p_y == 0) && (vx->p_x > 0) && (vy->p_x == 0) && (vy->p_y > 0))
+	{
+	    oasisPutUInt(b, OASIS_REP_GRID);
+	    oasisPutUInt(b, nx - 2);
+	    oasisPutUInt(b, ny - 2);
+	    oasisPutUInt(b, vx->p_x);
+	    oasisPutUInt(b, vy->p_y);
+	}
+	else
+	{
+	    oasisPutUInt(b, OASIS_REP_VGRID);
+	    oasisPutUInt(b, nx - 2);
+	    oasisPutUInt(b, ny - 2);
+	    oasisPutGDelta(b, vx->p_x, vx->p_y);
+	    oasisPutGDelta(b, vy->p_x, vy->p_y);
+	}
+    }
+    else if ((vx->p_y == 0) && (vx->p_x > 0))
+    {
+	oasisPutUInt(b, OASIS_REP_XROW);
+	oasisPutUInt(b, nx - 2);
+	oasisPutUInt(b, vx->p_x);
+    }
+    else if ((vx->p_x == 0) && (vx->p_y > 0))
+    {
+	oasisPutUInt(b, OASIS_REP_YCOL);
+	oasisPutUInt(b, nx - 2);
+	oasisPutUInt(b, vx->p_y);
+    }
+    else
+    {
+	oasisPutUInt(b, OASIS_REP_VROW);
+	oasisPutUInt(b, nx - 2);
+	oasisPutGDelta(b, vx->p_x, vx->p_y);
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisModalReset --
+ *
+ * Forget all modal variables, as the reader does at each CELL record.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Resets oasisModal.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisModalReset(void)
+{
+    OasisModal *om = &oasisModal;
+
+    om->om_layer = om->om_datatype = -1;
+    om->om_textlayer = om->om_texttype = -1;
+    om->om_width = om->om_height = -1;
+    om->om_geom = GeoOrigin;
+    om->om_place = GeoOrigin;
+    om->om_text = GeoOrigin;
+    om->om_cell = (CellDef *)NULL;
+    om->om_hasRep = FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * OasisWrite --
+ *
+ * Write out the entire tree rooted at the supplied CellDef in OASIS
+ * format, to the specified file.  Cells are written children first,
+ * as calmaProcessDef() does for GDS-II, from magic's own layout, using
+ * the current CIF output style and the same "gds" settings for labels,
+ * abstract views and library output.
+ *
+ * Results:
+ *	TRUE if the cell could be written successfully, FALSE otherwise.
+ *
+ * Side effects:
+ *	Writes a file to disk.
+ *	In the event of an error while writing out the cell,
+ *	the external integer errno is set to the UNIX error
+ *	encountered.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+OasisWrite(
+    CellDef *rootDef,	/* Pointer to CellDef to be written */
+    FILE *f)		/* Open output file */
+{
+    int oldCount = DBWFeedbackCount, problems, padding;
+    bool good, saveContacts;
+    CellDef *err_def;
+    CellUse dummy;
+    CalmaStream cs;
+    OasisBuf head;
+    struct timeval start, now;
+    double seconds;
+    dlong nbytes;
+
+    if (!CIFCurStyle)
+    {
+	TxError("No CIF/GDS output style set!\n");
+	return FALSE;
+    }
+
+    /* Make sure that the entire hierarchy is in memory and up to date */
+    dummy.cu_def = rootDef;
+    err_def = DBCellReadArea(&dummy, &rootDef->cd_bbox, !CalmaAllowUndefined);
+    if (err_def != NULL)
+    {
+	TxError("Failure to read entire subtree of the cell.\n");
+	TxError("Failed on cell %s.\n", err_def->cd_name);
+	return FALSE;
+    }
+    DBFixMismatch();
+
+    /* cd_client is 0 for cells not yet seen, -1 for cells seen but	*/
+    /* not (or not yet) written, and the reference number plus one	*/
+    /* once the cell has been written.					*/
+    (void) DBCellSrDefs(0, calmaWriteInitFunc, (ClientData) NULL);
+    oasisCellNum = 0;
+    oasisRawBytes = 0;
+    calmaOutScale();
+
+    /* Contact cells are placed by CIFGen() through the GDS-II stream */
+    saveContacts = CalmaContactArrays;
+    CalmaContactArrays = FALSE;
+
+    gettimeofday(&start, (struct timezone *)NULL);
+    calmaStreamInit(&cs, CALMA_STREAM_FILE, (ClientData)f, 0, 1);
+
+    /* Magic bytes, then START:  version, units and table offsets in END */
+    head.ob_buf = NULL;
+    head.ob_len = head.ob_size = 0;
+    calmaStreamWrite(&cs, OASIS_MAGIC, OASIS_MAGICLENGTH);
+    oasisPutUInt(&head, OASIS_START);
+    oasisPutString(&head, "1.0");
+    oasisPutUInt(&head, 0);		/* Real, positive integer */
+    oasisPutUInt(&head, (CIFCurStyle->cs_flags & CWF_ANGSTROMS) ? 10000 : 1000);
+    oasisPutUInt(&head, 1);
+    calmaStreamWrite(&cs, (char *)head.ob_buf, head.ob_len);
+    nbytes = OASIS_MAGICLENGTH + head.ob_len;
+
+    good = (oasisProcessDef(rootDef, &cs, CalmaDoLibrary) == 0);
+
+    /* END:  no name tables, padding to 256 bytes, no validation */
+    head.ob_len = 0;
+    oasisPutUInt(&head, OASIS_END);
+    for (padding = 0; padding < 12; padding++)
+	oasisPutUInt(&head, 0);
+    padding = 256 - head.ob_len - 1 - 2;
+    oasisPutUInt(&head, padding);
+    while (padding--)
+	oasisPutByte(&head, 0);
+    oasisPutUInt(&head, 0);
+    calmaStreamWrite(&cs, (char *)head.ob_buf, head.ob_len);
+    freeMagic((char *)head.ob_buf);
+    if (!calmaStreamClose(&cs)) good = FALSE;
+
+    CalmaContactArrays = saveContacts;
+    if (oasisBody.ob_buf != NULL)
+    {
+	freeMagic((char *)oasisBody.ob_buf);
+	oasisBody.ob_buf = NULL;
+	oasisBody.ob_len = oasisBody.ob_size = 0;
+    }
+    if (oasisRects != NULL)
+    {
+	freeMagic((char *)oasisRects);
+	oasisRects = NULL;
+	oasisRectsSize = 0;
+    }
+
+    /* Report the size and the time taken */
+    gettimeofday(&now, (struct timezone *)NULL);
+    seconds = (double)(now.tv_sec - start.tv_sec)
+		+ (double)(now.tv_usec - start.tv_usec) / 1.0e6;
+    nbytes = (dlong)ftello(f);
+    TxPrintf("Wrote %d cells, %.2f MB (%.2f MB before compression) "
+		"in %.2f seconds\n", oasisCellNum, (double)nbytes / 1.0e6,
+		(double)oasisRawBytes / 1.0e6, seconds);
+
+    if ((problems = (DBWFeedbackCount - oldCount)))
+	TxPrintf("%d problems occurred.  See feedback entries.\n", problems);
+
+    return (good);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisProcessDef --
+ *
+ * Write the definitions of the children of 'def' that have not yet
+ * been written, then 'def' itself unless 'do_library' is TRUE.
+ *
+ * Results:
+ *	0 if successful, 1 if an abstract view could not be written or
+ *	the output was interrupted.
+ *
+ * Side effects:
+ *	Writes to the stream 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisProcessDef(
+    CellDef *def,	/* Output this def's children, then the def itself */
+    CalmaStream *f,	/* Stream file */
+    bool do_library)	/* If TRUE, output only children of def, but not def */
+{
+    bool isReadOnly, isAbstract;
+
+    /* Skip if already seen */
+    if ((int) CD2INT(def->cd_client) != 0)
+	return (0);
+    def->cd_client = INT2CD(-1);
+
+    /* Read the cell in if it is not already available. */
+    if ((def->cd_flags & CDAVAILABLE) == 0)
+	if (!DBCellRead(def, TRUE, TRUE, NULL))
+	    return (0);
+
+    if (!strcmp(def->cd_name, UNNAMED))
+	TxError("Error:  Cell has the default name \"%s\"!\n", UNNAMED);
+
+    DBPropGet(def, "LEFview", &isAbstract);
+    DBPropGetString(def, "GDS_FILE", &isReadOnly);
+
+    if (isAbstract && !isReadOnly)
+    {
+	if (CalmaAllowAbstract)
+	    TxError("Warning:  Writing abstract view of \"%s\" to OASIS.\n",
+			def->cd_name);
+	else
+	{
+	    TxError("Error:  Cell \"%s\" is an abstract view;  cannot write OASIS.\n",
+			def->cd_name);
+	    return 1;
+	}
+    }
+
+    /* A read-only cell can't be copied from its GDS-II file */
+    if (isReadOnly)
+	TxError("Warning:  Writing magic's view of read-only cell \"%s\".\n",
+			def->cd_name);
+
+    if (DBCellEnum(def, oasisProcessUse, (ClientData) f) != 0)
+	return 1;
+    if (SigInterruptPending)
+	return 1;
+
+    if (!do_library)
+	oasisOutCell(def, f);
+    return 0;
+}
+
+int
+oasisProcessUse(
+    CellUse *use,	/* Process use->cu_def */
+    CalmaStream *f)	/* Stream file */
+{
+    return (oasisProcessDef(use->cu_def, f, FALSE));
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisCellName --
+ *
+ * Return the name to use for 'def' in the output:  its own name if all
+ * of its characters are printable, as OASIS requires, or else a name
+ * made up from its reference number, as calmaOutStructName() does.
+ *
+ * Results:
+ *	A string to be freed by the caller.
+ *
+ * Side effects:
+ *	Prints a warning for names that are changed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+char *
+oasisCellName(
+    CellDef *def,
+    int refnum)
+{
+    char *defname, *cp;
+
+    for (cp = def->cd_name; *cp; cp++)
+	if ((*cp <= ' ') || (*cp > '~'))
+	    break;
+    if ((*cp == '\0') && (cp != def->cd_name))
+	return StrDup(NULL, def->cd_name);
+
+    defname = (char *)mallocMagic(32);
+    (void) sprintf(defname, "XXXXX%d", refnum);
+    TxError("Warning: string in output unprintable; changed to \'%s\'\n",
+		defname);
+    return defname;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisOutCell --
+ *
+ * Write the definition of a single cell:  a CELLNAME record giving it
+ * the next reference number, a CELL record, and the body of the cell,
+ * compressed into a CBLOCK record if that makes it smaller.  The body
+ * holds the cell's placements, the CIF generated for it as calmaOutFunc()
+ * generates it, and its labels.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the stream 'f'.  Sets def->cd_client to the reference
+ *	number plus one.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisOutCell(
+    CellDef *def,	/* Cell to be written */
+    CalmaStream *f)	/* Stream file */
+{
+    OasisBuf *b = &oasisBody;
+    OasisBuf head;
+    CIFLayer *layer;
+    Label *lab;
+    Rect bigArea;
+    char *name;
+    int type, refnum;
+
+    refnum = oasisCellNum++;
+    b->ob_len = 0;
+    oasisModalReset();
+
+    /* Positions are written relative to the previous element */
+    oasisPutUInt(b, OASIS_XYRELATIVE);
+
+    /* Placements of the children, arrays as one record */
+    (void) DBCellEnum(def, oasisWriteUseFunc, (ClientData) NULL);
+
+    /* CIF of the cell, skipping temporary layers */
+    calmaOutArea(def, &bigArea);
+
+    CIFErrorDef = def;
+    CIFGen(def, def, &bigArea, CIFPlanes, &DBAllTypeBits, TRUE, TRUE, FALSE,
+		(ClientData)NULL);
+
+    if (!CIFHierWriteDisable)
+	CIFGenSubcells(def, &bigArea, CIFPlanes);
+    if (!CIFArrayWriteDisable)
+	CIFGenArrays(def, &bigArea, CIFPlanes);
+
+    for (type = 0; type < CIFCurStyle->cs_nLayers; type++)
+    {
+	layer = CIFCurStyle->cs_layers[type];
+	if (layer->cl_flags & CIF_TEMP) continue;
+	if (!CalmaIsValidLayer(layer->cl_calmanum)) continue;
+
+	if (layer->cl_flags & CIF_LABEL)
+	{
+	    DBSrPaintArea((Tile *) NULL, CIFPlanes[type], &TiPlaneRect,
+		    &CIFSolidBits, oasisPaintLabelFunc, (ClientData) layer);
+	    continue;
+	}
+
+	oasisLayer = layer->cl_calmanum;
+	oasisDatatype = layer->cl_calmatype;
+	oasisNumRects = 0;
+	DBSrPaintArea((Tile *) NULL, CIFPlanes[type], &TiPlaneRect,
+		&CIFSolidBits, oasisRectFunc, (ClientData) NULL);
+	oasisOutRects();
+    }
+
+    /* Labels, then ports in the order of their index, as calmaOutFunc() */
+    if (CalmaDoLabels)
+    {
+	PortLabel *pllist;
+	int i, numports = 0;
+
+	for (lab = def->cd_labels; lab; lab = lab->lab_next)
+	{
+	    if ((lab->lab_flags & PORT_DIR_MASK) == 0)
+		oasisOutLabel(lab, CIFCurStyle->cs_labelLayer[lab->lab_type],
+			CIFCurStyle->cs_labelLayer[lab->lab_type]);
+	    else
+		numports++;
+	}
+	if (numports > 0)
+	{
+	    pllist = (PortLabel *)mallocMagic(numports * sizeof(PortLabel));
+	    i = 0;
+	    for (lab = def->cd_labels; lab; lab = lab->lab_next)
+		if ((lab->lab_flags & PORT_DIR_MASK) != 0)
+		{
+		    pllist[i].pl_label = lab;
+		    pllist[i].pl_port = (unsigned int)lab->lab_port;
+		    i++;
+		}
+	    qsort(pllist, numports, sizeof(PortLabel), compport);
+
+	    for (i = 0; i < numports; i++)
+	    {
+		lab = pllist[i].pl_label;
+		type = CIFCurStyle->cs_portLayer[lab->lab_type];
+		if (type >= 0)
+		    oasisOutLabel(lab, CIFCurStyle->cs_portText[lab->lab_type],
+				type);
+	    }
+	    freeMagic(pllist);
+	}
+    }
+
+    /* CELLNAME with an implicit reference number, and CELL */
+    head.ob_buf = NULL;
+    head.ob_len = head.ob_size = 0;
+    name = oasisCellName(def, refnum);
+    oasisPutUInt(&head, OASIS_CELLNAME);
+    oasisPutString(&head, name);
+    freeMagic(name);
+    oasisPutUInt(&head, OASIS_CELL_REF);
+    oasisPutUInt(&head, refnum);
+
+    oasisRawBytes += b->ob_len;
+
+#ifdef HAVE_ZLIB
+    {
+	z_stream zs;
+	unsigned char *zbuf = NULL;
+	uLong zsize;
+	bool compressed = FALSE;
+
+	memset(&zs, 0, sizeof(zs));
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8,
+		Z_DEFAULT_STRATEGY) == Z_OK)
+	{
+	    zsize = deflateBound(&zs, b->ob_len);
+	    zbuf = (unsigned char *)mallocMagic(zsize);
+	    zs.next_in = b->ob_buf;
+	    zs.avail_in = b->ob_len;
+	    zs.next_out = zbuf;
+	    zs.avail_out = zsize;
+	    if ((deflate(&zs, Z_FINISH) == Z_STREAM_END)
+			&& (zs.total_out + 8 < b->ob_len))
+	    {
+		oasisPutUInt(&head, OASIS_CBLOCK);
+		oasisPutUInt(&head, OASIS_CBLOCK_DEFLATE);
+		oasisPutUInt(&head, b->ob_len);
+		oasisPutUInt(&head, zs.total_out);
+		calmaStreamWrite(f, (char *)head.ob_buf, head.ob_len);
+		calmaStreamWrite(f, (char *)zbuf, zs.total_out);
+		compressed = TRUE;
+	    }
+	    deflateEnd(&zs);
+	    freeMagic((char *)zbuf);
+	}
+	if (!compressed)
+	{
+	    calmaStreamWrite(f, (char *)head.ob_buf, head.ob_len);
+	    calmaStreamWrite(f, (char *)b->ob_buf, b->ob_len);
+	}
+    }
+#else
+    calmaStreamWrite(f, (char *)head.ob_buf, head.ob_len);
+    calmaStreamWrite(f, (char *)b->ob_buf, b->ob_len);
+#endif
+    freeMagic((char *)head.ob_buf);
+
+    def->cd_client = INT2CD(refnum + 1);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisWriteUseFunc --
+ *
+ * Write a PLACEMENT record for the use 'use', with a repetition for an
+ * array.  The orientation is found from the transform as it is in
+ * calmaWriteUseFunc():  OASIS also mirrors about the x axis first and
+ * then rotates counterclockwise.
+ *
+ * Results:
+ *	Returns 0 always.
+ *
+ * Side effects:
+ *	Writes to oasisBody.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisWriteUseFunc(
+    CellUse *use,
+    ClientData cdata)	/* (unused) */
+{
+    OasisBuf *b = &oasisBody;
+    OasisModal *om = &oasisModal;
+    Transform *t = &use->cu_transform;
+    int info, angle, nx, ny, refnum;
+    Point p, vx, vy;
+
+    info = 0;
+    angle = (t->t_a == -1) ? 2 : 0;
+    if (t->t_a != t->t_e || (t->t_a == 0 && t->t_b == t->t_d))
+    {
+	info |= OASIS_INFO_F;
+	if (t->t_a == 0)
+	    angle = (t->t_b == 1) ? 1 : 3;
+    }
+    else if (t->t_a == 0)
+	angle = (t->t_b == -1) ? 1 : 3;
+    info |= angle << 1;
+
+    refnum = (int) CD2INT(use->cu_def->cd_client) - 1;
+    if (use->cu_def != om->om_cell)
+    {
+	info |= OASIS_INFO_PC;
+	if (refnum >= 0) info |= OASIS_INFO_PN;
+    }
+
+    p.p_x = t->t_c * calmaWriteScale;
+    p.p_y = t->t_f * calmaWriteScale;
+    if (p.p_x != om->om_place.p_x) info |= OASIS_INFO_PX;
+    if (p.p_y != om->om_place.p_y) info |= OASIS_INFO_PY;
+
+    /* Columns step along the use's x axis, rows along its y axis */
+    nx = ABS(use->cu_xhi - use->cu_xlo) + 1;
+    ny = ABS(use->cu_yhi - use->cu_ylo) + 1;
+    if (CalmaFlattenArrays)
+	nx = ny = 1;
+    if ((nx > 1) || (ny > 1))
+	info |= OASIS_INFO_PR;
+    vx.p_x = t->t_a * use->cu_xsep * calmaWriteScale;
+    vx.p_y = t->t_d * use->cu_xsep * calmaWriteScale;
+    vy.p_x = t->t_b * use->cu_ysep * calmaWriteScale;
+    vy.p_y = t->t_e * use->cu_ysep * calmaWriteScale;
+
+    oasisPutUInt(b, OASIS_PLACEMENT);
+    oasisPutByte(b, info);
+    if (info & OASIS_INFO_PC)
+    {
+	if (refnum >= 0)
+	    oasisPutUInt(b, refnum);
+	else
+	    oasisPutString(b, use->cu_def->cd_name);
+	om->om_cell = use->cu_def;
+    }
+    if (info & OASIS_INFO_PX)
+	oasisPutSInt(b, (dlong)p.p_x - om->om_place.p_x);
+    if (info & OASIS_INFO_PY)
+	oasisPutSInt(b, (dlong)p.p_y - om->om_place.p_y);
+    if (info & OASIS_INFO_PR)
+	oasisPutRepetition(b, nx, &vx, ny, &vy);
+    om->om_place = p;
+
+    /* With "gds arrays yes", write every element of an array */
+    if (CalmaFlattenArrays)
+    {
+	int x, y;
+
+	nx = ABS(use->cu_xhi - use->cu_xlo) + 1;
+	ny = ABS(use->cu_yhi - use->cu_ylo) + 1;
+	for (x = 0; x < nx; x++)
+	    for (y = 0; y < ny; y++)
+	    {
+		if ((x == 0) && (y == 0)) continue;
+		p.p_x = t->t_c * calmaWriteScale + x * vx.p_x + y * vy.p_x;
+		p.p_y = t->t_f * calmaWriteScale + x * vx.p_y + y * vy.p_y;
+		oasisPutUInt(b, OASIS_PLACEMENT);
+		oasisPutByte(b, (info & (OASIS_INFO_F | OASIS_INFO_AA))
+			| OASIS_INFO_PX | OASIS_INFO_PY);
+		oasisPutSInt(b, (dlong)p.p_x - om->om_place.p_x);
+		oasisPutSInt(b, (dlong)p.p_y - om->om_place.p_y);
+		om->om_place = p;
+	    }
+    }
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisRectFunc --
+ *
+ * Filter function for the tiles of a CIF layer.  Rectangles are saved
+ * in oasisRects to be grouped into repetitions by oasisOutRects();
+ * triangles of split tiles are written at once as POLYGON records.
+ *
+ * Results:
+ *	Returns 0 always.
+ *
+ * Side effects:
+ *	Adds to oasisRects or writes to oasisBody.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisRectFunc(
+    Tile *tile,			/* Tile to be written out */
+    TileType dinfo,		/* Split tile information */
+    ClientData cdata)		/* (unused) */
+{
+    OasisBuf *b = &oasisBody;
+    OasisModal *om = &oasisModal;
+    OasisGrid *og;
+    Rect r;
+    Point pts[3];
+    int info, i;
+
+    TiToRect(tile, &r);
+    r.r_xbot *= calmaPaintScale;
+    r.r_ybot *= calmaPaintScale;
+    r.r_xtop *= calmaPaintScale;
+    r.r_ytop *= calmaPaintScale;
+
+    if (!IsSplit(tile))
+    {
+	if (oasisNumRects == oasisRectsSize)
+	{
+	    OasisGrid *newrects;
+
+	    oasisRectsSize = (oasisRectsSize == 0) ? 1024 : oasisRectsSize * 2;
+	    newrects = (OasisGrid *)mallocMagic(oasisRectsSize * sizeof(OasisGrid));
+	    if (oasisRects != NULL)
+	    {
+		memcpy(newrects, oasisRects, oasisNumRects * sizeof(OasisGrid));
+		freeMagic((char *)oasisRects);
+	    }
+	    oasisRects = newrects;
+	}
+	og = &oasisRects[oasisNumRects++];
+	og->og_x = r.r_xbot;
+	og->og_y = r.r_ybot;
+	og->og_w = r.r_xtop - r.r_xbot;
+	og->og_h = r.r_ytop - r.r_ybot;
+	og->og_nx = og->og_ny = 1;
+	og->og_dx = og->og_dy = 0;
+	return 0;
+    }
+
+    /* The triangle, with the same corners as calmaWritePaintFunc() */
+    switch (((dinfo & TT_SIDE) ? 2 : 0) | SplitDirection(tile))
+    {
+	case 0x0:
+	    pts[0] = r.r_ll;
+	    pts[1].p_x = r.r_xbot; pts[1].p_y = r.r_ytop;
+	    pts[2] = r.r_ur;
+	    break;
+	case 0x1:
+	    pts[0].p_x = r.r_xbot; pts[0].p_y = r.r_ytop;
+	    pts[1] = r.r_ll;
+	    pts[2].p_x = r.r_xtop; pts[2].p_y = r.r_ybot;
+	    break;
+	case 0x2:
+	    pts[0] = r.r_ll;
+	    pts[1].p_x = r.r_xtop; pts[1].p_y = r.r_ybot;
+	    pts[2] = r.r_ur;
+	    break;
+	case 0x3:
+	    pts[0].p_x = r.r_xbot; pts[0].p_y = r.r_ytop;
+	    pts[1] = r.r_ur;
+	    pts[2].p_x = r.r_xtop; pts[2].p_y = r.r_ybot;
+	    break;
+    }
+
+    info = OASIS_INFO_P;
+    if (oasisLayer != om->om_layer) info |= OASIS_INFO_L;
+    if (oasisDatatype != om->om_datatype) info |= OASIS_INFO_D;
+    if (pts[0].p_x != om->om_geom.p_x) info |= OASIS_INFO_X;
+    if (pts[0].p_y != om->om_geom.p_y) info |= OASIS_INFO_Y;
+
+    oasisPutUInt(b, OASIS_POLYGON);
+    oasisPutByte(b, info);
+    if (info & OASIS_INFO_L) oasisPutUInt(b, oasisLayer);
+    if (info & OASIS_INFO_D) oasisPutUInt(b, oasisDatatype);
+
+    /* Two g-deltas from the first corner;  the polygon closes itself */
+    oasisPutUInt(b, OASIS_PTS_GDELTA);
+    oasisPutUInt(b, 2);
+    for (i = 1; i < 3; i++)
+	oasisPutGDelta(b, (dlong)pts[i].p_x - pts[i - 1].p_x,
+		(dlong)pts[i].p_y - pts[i - 1].p_y);
+
+    if (info & OASIS_INFO_X)
+	oasisPutSInt(b, (dlong)pts[0].p_x - om->om_geom.p_x);
+    if (info & OASIS_INFO_Y)
+	oasisPutSInt(b, (dlong)pts[0].p_y - om->om_geom.p_y);
+
+    om->om_layer = oasisLayer;
+    om->om_datatype = oasisDatatype;
+    om->om_geom = pts[0];
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisCompareRects --
+ * oasisCompareRows --
+ *
+ * Sort functions for oasisOutRects():  rectangles by size, then by row
+ * and column;  and rows of rectangles by size, column and spacing,
+ * then by row.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define OASIS_CMP(a, b)	if ((a) != (b)) return ((a) < (b)) ? -1 : 1
+
+int
+oasisCompareRects(
+    const void *one,
+    const void *two)
+{
+    const OasisGrid *g1 = (const OasisGrid *)one;
+    const OasisGrid *g2 = (const OasisGrid *)two;
+
+    OASIS_CMP(g1->og_w, g2->og_w);
+    OASIS_CMP(g1->og_h, g2->og_h);
+    OASIS_CMP(g1->og_y, g2->og_y);
+    OASIS_CMP(g1->og_x, g2->og_x);
+    return 0;
+}
+
+int
+oasisCompareRows(
+    const void *one,
+    const void *two)
+{
+    const OasisGrid *g1 = (const OasisGrid *)one;
+    const OasisGrid *g2 = (const OasisGrid *)two;
+
+    OASIS_CMP(g1->og_w, g2->og_w);
+    OASIS_CMP(g1->og_h, g2->og_h);
+    OASIS_CMP(g1->og_x, g2->og_x);
+    OASIS_CMP(g1->og_nx, g2->og_nx);
+    OASIS_CMP(g1->og_dx, g2->og_dx);
+    OASIS_CMP(g1->og_y, g2->og_y);
+    return 0;
+}
+
+/* TRUE if rows g1 and g2 differ only in their y position */
+#define OASIS_SAMEROW(g1, g2) \
+	(((g1)->og_w == (g2)->og_w) && ((g1)->og_h == (g2)->og_h) \
+	&& ((g1)->og_x == (g2)->og_x) && ((g1)->og_nx == (g2)->og_nx) \
+	&& ((g1)->og_dx == (g2)->og_dx))
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisOutRects --
+ *
+ * Write the rectangles collected in oasisRects for one layer.  Equal
+ * rectangles evenly spaced along a row are first combined into one,
+ * then equal rows evenly spaced in y, so that an array of contact cuts
+ * is written as a single RECTANGLE record with a repetition.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to oasisBody.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisOutRects(void)
+{
+    OasisBuf *b = &oasisBody;
+    OasisModal *om = &oasisModal;
+    OasisGrid *og, *rows;
+    int i, j, n, nrows, info;
+    Point vx, vy;
+
+    if (oasisNumRects == 0) return;
+    qsort(oasisRects, oasisNumRects, sizeof(OasisGrid), oasisCompareRects);
+
+    /* Combine runs of equal rectangles with equal spacing into rows */
+    rows = oasisRects;
+    nrows = 0;
+    for (i = 0; i < oasisNumRects; i = j)
+    {
+	og = &oasisRects[i];
+	n = 1;
+	j = i + 1;
+	if ((j < oasisNumRects) && (oasisRects[j].og_w == og->og_w)
+		&& (oasisRects[j].og_h == og->og_h)
+		&& (oasisRects[j].og_y == og->og_y))
+	{
+	    int dx = oasisRects[j].og_x - og->og_x;
+
+	    for (n = 2, j++; j < oasisNumRects; n++, j++)
+		if ((oasisRects[j].og_w != og->og_w)
+			|| (oasisRects[j].og_h != og->og_h)
+			|| (oasisRects[j].og_y != og->og_y)
+			|| (oasisRects[j].og_x - oasisRects[j - 1].og_x != dx))
+		    break;
+	    og->og_nx = n;
+	    og->og_dx = dx;
+	}
+	rows[nrows++] = *og;
+    }
+
+    /* Combine equal rows with equal spacing into grids */
+    qsort(rows, nrows, sizeof(OasisGrid), oasisCompareRows);
+    for (i = 0; i < nrows; i = j)
+    {
+	og = &rows[i];
+	j = i + 1;
+	if ((j < nrows) && OASIS_SAMEROW(&rows[j], og))
+	{
+	    int dy = rows[j].og_y - og->og_y;
+
+	    for (n = 2, j++; j < nrows; n++, j++)
+		if (!OASIS_SAMEROW(&rows[j], og)
+			|| (rows[j].og_y - rows[j - 1].og_y != dy))
+		    break;
+	    og->og_ny = n;
+	    og->og_dy = dy;
+	}
+
+	info = 0;
+	if (oasisLayer != om->om_layer) info |= OASIS_INFO_L;
+	if (oasisDatatype != om->om_datatype) info |= OASIS_INFO_D;
+	if (og->og_w == og->og_h)
+	{
+	    info |= OASIS_INFO_S;
+	    if (og->og_w != om->om_width) info |= OASIS_INFO_W;
+	}
+	else
+	{
+	    if (og->og_w != om->om_width) info |= OASIS_INFO_W;
+	    if (og->og_h != om->om_height) info |= OASIS_INFO_H;
+	}
+	if (og->og_x != om->om_geom.p_x) info |= OASIS_INFO_X;
+	if (og->og_y != om->om_geom.p_y) info |= OASIS_INFO_Y;
+	if ((og->og_nx > 1) || (og->og_ny > 1)) info |= OASIS_INFO_R;
+
+	oasisPutUInt(b, OASIS_RECTANGLE);
+	oasisPutByte(b, info);
+	if (info & OASIS_INFO_L) oasisPutUInt(b, oasisLayer);
+	if (info & OASIS_INFO_D) oasisPutUInt(b, oasisDatatype);
+	if (info & OASIS_INFO_W) oasisPutUInt(b, og->og_w);
+	if (info & OASIS_INFO_H) oasisPutUInt(b, og->og_h);
+	if (info & OASIS_INFO_X)
+	    oasisPutSInt(b, (dlong)og->og_x - om->om_geom.p_x);
+	if (info & OASIS_INFO_Y)
+	    oasisPutSInt(b, (dlong)og->og_y - om->om_geom.p_y);
+	if (info & OASIS_INFO_R)
+	{
+	    vx.p_x = og->og_dx;
+	    vx.p_y = 0;
+	    vy.p_x = 0;
+	    vy.p_y = og->og_dy;
+	    oasisPutRepetition(b, og->og_nx, &vx, og->og_ny, &vy);
+	}
+
+	om->om_layer = oasisLayer;
+	om->om_datatype = oasisDatatype;
+	om->om_width = og->og_w;
+	om->om_height = og->og_h;
+	om->om_geom.p_x = og->og_x;
+	om->om_geom.p_y = og->og_y;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPutText --
+ *
+ * Write a TEXT record with the string 'text' at 'p'.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to oasisBody.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisPutText(
+    char *text,
+    int textlayer,
+    int texttype,
+    Point *p)
+{
+    OasisBuf *b = &oasisBody;
+    OasisModal *om = &oasisModal;
+    int info;
+
+    info = OASIS_INFO_C;
+    if (textlayer != om->om_textlayer) info |= OASIS_INFO_L;
+    if (texttype != om->om_texttype) info |= OASIS_INFO_T;
+    if (p->p_x != om->om_text.p_x) info |= OASIS_INFO_X;
+    if (p->p_y != om->om_text.p_y) info |= OASIS_INFO_Y;
+
+    oasisPutUInt(b, OASIS_TEXT);
+    oasisPutByte(b, info);
+    oasisPutString(b, text);
+    if (info & OASIS_INFO_L) oasisPutUInt(b, textlayer);
+    if (info & OASIS_INFO_T) oasisPutUInt(b, texttype);
+    if (info & OASIS_INFO_X) oasisPutSInt(b, (dlong)p->p_x - om->om_text.p_x);
+    if (info & OASIS_INFO_Y) oasisPutSInt(b, (dlong)p->p_y - om->om_text.p_y);
+
+    om->om_textlayer = textlayer;
+    om->om_texttype = texttype;
+    om->om_text = *p;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisOutLabel --
+ *
+ * Output a label as calmaWriteLabelFunc() does:  a TEXT record at the
+ * center of the label on the layer of CIF layer 'ltype', and for a
+ * label layer without operators, the label's area as a rectangle on
+ * CIF layer 'type'.  OASIS has no justification, font or size for
+ * text, so only the position and string are kept.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to oasisBody.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+oasisOutLabel(
+    Label *lab,	/* Label to output */
+    int ltype,	/* CIF layer number to use for TEXT record */
+    int type)	/* CIF layer number to use for the pin rectangle,
+		 * or -1 if not attached to a layer
+		 */
+{
+    OasisBuf *b = &oasisBody;
+    OasisModal *om = &oasisModal;
+    CIFLayer *layer;
+    Point p;
+    Rect r;
+    int info;
+
+    if (ltype < 0)
+	return;
+    layer = CIFCurStyle->cs_layers[ltype];
+    if (!CalmaIsValidLayer(layer->cl_calmanum))
+	return;
+
+    p.p_x = (lab->lab_rect.r_xbot + lab->lab_rect.r_xtop) * calmaWriteScale / 2;
+    p.p_y = (lab->lab_rect.r_ybot + lab->lab_rect.r_ytop) * calmaWriteScale / 2;
+    oasisPutText(lab->lab_text, layer->cl_calmanum, layer->cl_calmatype, &p);
+
+    if (type < 0)
+	return;
+    layer = CIFCurStyle->cs_layers[type];
+    if (!CalmaIsValidLayer(layer->cl_calmanum))
+	return;
+
+    if ((layer->cl_ops == NULL) &&
+		(lab->lab_rect.r_xtop > lab->lab_rect.r_xbot) &&
+		(lab->lab_rect.r_ytop > lab->lab_rect.r_ybot))
+    {
+	r = lab->lab_rect;
+	r.r_xbot *= calmaWriteScale;
+	r.r_ybot *= calmaWriteScale;
+	r.r_xtop *= calmaWriteScale;
+	r.r_ytop *= calmaWriteScale;
+
+	info = OASIS_INFO_W | OASIS_INFO_H | OASIS_INFO_X | OASIS_INFO_Y;
+	if (layer->cl_calmanum != om->om_layer) info |= OASIS_INFO_L;
+	if (layer->cl_calmatype != om->om_datatype) info |= OASIS_INFO_D;
+
+	oasisPutUInt(b, OASIS_RECTANGLE);
+	oasisPutByte(b, info);
+	if (info & OASIS_INFO_L) oasisPutUInt(b, layer->cl_calmanum);
+	if (info & OASIS_INFO_D) oasisPutUInt(b, layer->cl_calmatype);
+	oasisPutUInt(b, r.r_xtop - r.r_xbot);
+	oasisPutUInt(b, r.r_ytop - r.r_ybot);
+	oasisPutSInt(b, (dlong)r.r_xbot - om->om_geom.p_x);
+	oasisPutSInt(b, (dlong)r.r_ybot - om->om_geom.p_y);
+
+	om->om_layer = layer->cl_calmanum;
+	om->om_datatype = layer->cl_calmatype;
+	om->om_width = r.r_xtop - r.r_xbot;
+	om->om_height = r.r_ytop - r.r_ybot;
+	om->om_geom = r.r_ll;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * oasisPaintLabelFunc --
+ *
+ * Filter function for the tiles of a CIF layer that makes labels:
+ * write a TEXT record with the name of the layer at the center of the
+ * tile, as calmaPaintLabelFunc() does.
+ *
+ * Results:
+ *	Returns 0 always.
+ *
+ * Side effects:
+ *	Writes to oasisBody.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+oasisPaintLabelFunc(
+    Tile *tile,			/* Tile contains area for label */
+    TileType dinfo,		/* Split tile information (unused) */
+    CIFLayer *layer)		/* CIF layer being written */
+{
+    Rect r;
+    Point p;
+
+    if (IsSplit(tile)) return 0;    /* Ignore non-Manhattan geometry */
+
+    TiToRect(tile, &r);
+    p.p_x = (r.r_xbot + r.r_xtop) * calmaPaintScale / 2;
+    p.p_y = (r.r_ybot + r.r_ytop) * calmaPaintScale / 2;
+    oasisPutText(layer->cl_name, layer->cl_calmanum, layer->cl_calmatype, &p);
+    return 0;
+}
@@ -32,11 +32,13 @@ extern bool CalmaDoLibrary;
 extern bool CalmaDoLower;
 extern bool CalmaAddendum;
 extern bool CalmaNoDuplicates;
+extern bool CalmaReadStats;
 extern time_t *CalmaDateStamp;
 extern bool CalmaUnique;
 extern TileTypeBitMask *CalmaMaskHints;
 extern bool CalmaMergeTiles;
 extern bool CalmaFlattenArrays;
+extern bool CalmaAutoArrays;
 extern bool CalmaNoDRCCheck;
 extern bool CalmaRecordPaths;
 extern bool CalmaFlattenUses;
@@ -51,6 +53,8 @@ extern int  CalmaCompression;
 extern bool CalmaPostOrder;
 extern bool CalmaAllowUndefined;
 extern bool CalmaAllowAbstract;
+extern int  CalmaWriteThreads;
+extern int  CalmaReadThreads;
 
 /* Definitions used by the return value for CalmaSubcellPolygons */
 /* 	CALMA_POLYGON_NONE:  Process polygons immediately	 */
@@ -61,12 +65,17 @@ extern bool CalmaAllowAbstract;
 #define CALMA_POLYGON_TEMP	1
 #define CALMA_POLYGON_KEEP	2
 
+/* GDS-II output stream (see calmaInt.h) */
+struct calmastream;
+
 /* Externally-visible procedures: */
 extern bool CalmaWrite(CellDef *rootDef, FILE *f);
 extern void CalmaReadFile(FILETYPE file, char *filename);
 extern void CalmaTechInit(void);
-extern bool CalmaGenerateArray(FILE *f, TileType type, int llx, int lly, int pitch, int cols, int rows);
+extern bool CalmaGenerateArray(struct calmastream *f, TileType type, int llx, int lly, int pitch, int cols, int rows);
 extern void CalmaReadError(const char *format, ...) ATTR_FORMAT_PRINTF_1;
+extern bool OasisWrite(CellDef *rootDef, FILE *f);
+extern void OasisReadFile(FILETYPE file, char *filename);
 
 /* C99 compat */
 extern void calmaDelContacts(void);
@@ -76,10 +85,6 @@ extern void calmaElementPath(void);
 extern void calmaElementText(void);
 extern bool calmaIsUseNameDefault(char *defName, char *useName);
 extern bool calmaParseStructure(char *filename);
-extern int calmaProcessDef(CellDef *def, FILE *outf, bool do_library);
-#ifdef HAVE_ZLIB
-extern int calmaProcessDefZ(CellDef *def, gzFile outf, bool do_library);
-#endif
 extern bool calmaReadI2Record(int type, int *pvalue);
 extern bool calmaReadI4Record(int type, int *pvalue);
 extern void calmaReadX(Point *p, int iscale);
@@ -97,7 +102,7 @@ extern void calmaUnexpected(int wanted, int got);
 
 #ifdef HAVE_ZLIB
 extern bool CalmaWriteZ(CellDef *rootDef, gzFile f);
-extern bool CalmaGenerateArrayZ(gzFile f, TileType type, int llx, int lly, int pitch, int cols, int rows);
+extern bool CalmaWriteZParallel(CellDef *rootDef, FILE *f, int level);
 #endif
 
 #endif /* _MAGIC__CALMA__CALMA_H */
@@ -171,24 +171,66 @@ extern int  calmaLArtype;
 typedef union { char uc[2]; unsigned short us; } TwoByteInt;
 typedef union { char uc[4]; unsigned int ul; } FourByteInt;
 
-/* Macro to read a 2-byte integer */
+/* Buffered input window (see CalmaRdio.c) */
+extern unsigned char *calmaInBuf;
+extern unsigned char *calmaInPtr;
+extern unsigned char *calmaInEnd;
+extern bool calmaInEOF;
+extern dlong calmaInBytes;
+
+extern void calmaInputOpen(FILETYPE file, char *filename);
+extern void calmaInputClose(void);
+extern int calmaInFill(void);
+extern OFFTYPE calmaInTell(void);
+extern int calmaInSeek(OFFTYPE offset, int whence);
+extern int calmaInRead(char *buf, int n);
+extern bool calmaInMapped(void);
+
+/* Polygons converted to rectangles ahead of painting (see CalmaRdidx.c) */
+extern bool calmaPreRead(void);
+extern bool calmaPreTake(LinkedRect **prects);
+extern void calmaPreFree(void);
+
+/* Read one byte of input, like FGETC();  -1 at the end of input */
+#define calmaGetc() \
+	((calmaInPtr < calmaInEnd) ? (int)*calmaInPtr++ : calmaInFill())
+
+/* TRUE once a read has tried to go past the end of input, like FEOF() */
+#define calmaEOF()	(calmaInEOF)
+
+/*
+ * Macros to read 2- and 4-byte big-endian integers.  When the whole
+ * value is in the window it is loaded directly;  otherwise it is read
+ * a byte at a time, which refills the window.
+ */
 #define	READI2(z) \
 	{ \
-            TwoByteInt u; \
-            u.uc[0] = FGETC(calmaInputFile); \
-            u.uc[1] = FGETC(calmaInputFile); \
-            (z) = (int) ntohs(u.us); \
+	    if (calmaInEnd - calmaInPtr >= 2) { \
+		(z) = (int)(((unsigned)calmaInPtr[0] << 8) | calmaInPtr[1]); \
+		calmaInPtr += 2; \
+	    } else { \
+		TwoByteInt u; \
+		u.uc[0] = calmaGetc(); \
+		u.uc[1] = calmaGetc(); \
+		(z) = (int) ntohs(u.us); \
+	    } \
 	}
 
-/* Macro to read a 4-byte integer */
 #define	READI4(z) \
 	{ \
-            FourByteInt u; \
-            u.uc[0] = FGETC(calmaInputFile); \
-            u.uc[1] = FGETC(calmaInputFile); \
-            u.uc[2] = FGETC(calmaInputFile); \
-            u.uc[3] = FGETC(calmaInputFile); \
-            (z) = (int) ntohl(u.ul); \
+	    if (calmaInEnd - calmaInPtr >= 4) { \
+		(z) = (int)(((unsigned)calmaInPtr[0] << 24) | \
+			((unsigned)calmaInPtr[1] << 16) | \
+			((unsigned)calmaInPtr[2] << 8) | calmaInPtr[3]); \
+		calmaInPtr += 4; \
+	    } else { \
+		FourByteInt u; \
+		u.uc[0] = calmaGetc(); \
+		u.uc[1] = calmaGetc(); \
+		u.uc[2] = calmaGetc(); \
+		u.uc[3] = calmaGetc(); \
+		(z) = (int) ntohl(u.ul); \
+	    } \
 	}
 
 /* Macros for reading and unreading record headers */
@@ -198,12 +240,16 @@ typedef union { char uc[4]; unsigned int ul; } FourByteInt;
 		(nb) = calmaLAnbytes; \
 		(rt) = calmaLArtype; \
 		calmaLApresent = FALSE; \
+	    } else if (calmaInEnd - calmaInPtr >= CALMAHEADERLENGTH) { \
+		(nb) = (int)(((unsigned)calmaInPtr[0] << 8) | calmaInPtr[1]); \
+		(rt) = calmaInPtr[2]; \
+		calmaInPtr += CALMAHEADERLENGTH; \
 	    } else { \
 		READI2(nb); \
-		if (FEOF(calmaInputFile)) nb = -1; \
+		if (calmaEOF()) nb = -1; \
 		else { \
-		    (rt) = FGETC(calmaInputFile); \
-		    (void) FGETC(calmaInputFile); \
+		    (rt) = calmaGetc(); \
+		    (void) calmaGetc(); \
 		} \
 	    } \
 	}
@@ -222,6 +268,67 @@ typedef union { char uc[4]; unsigned int ul; } FourByteInt;
 	    UNREADRH(nb, rt); \
 	}
 
+/* ------------------------- Output stream ---------------------------- */
+
+/*
+ * GDS-II output is built up in a large memory buffer, which is handed
+ * to a sink whenever it fills:  a plain file, a zlib stream, or a file
+ * of gzip members, each compressing one block of the buffer, that are
+ * compressed concurrently by a pool of threads (see CalmaOutput.c).
+ */
+
+#define CALMA_STREAM_FILE	0	/* cs_sink is a FILE *		*/
+#define CALMA_STREAM_GZIP	1	/* cs_sink is a gzFile		*/
+#define CALMA_STREAM_PGZIP	2	/* cs_sink is a FILE *, written in
+					 * gzip members compressed in parallel
+					 */
+
+/* Size of the buffer for CALMA_STREAM_FILE and CALMA_STREAM_GZIP */
+#define CALMA_STREAM_BUFSIZE	(1 << 20)
+
+/* Size of each gzip member written by CALMA_STREAM_PGZIP */
+#define CALMA_STREAM_BLOCKSIZE	(1 << 20)
+
+typedef struct calmablock
+{
+    unsigned char *cb_out;	/* Compressed block */
+    size_t	   cb_size;	/* Space allocated for cb_out */
+    size_t	   cb_len;	/* Bytes of cb_out in use */
+    unsigned char *cb_in;	/* Block of the stream buffer to compress */
+    size_t	   cb_inlen;	/* Bytes of cb_in to compress */
+    bool	   cb_ok;	/* FALSE if compression failed */
+} CalmaBlock;
+
+typedef struct calmastream
+{
+    unsigned char *cs_buf;	/* Output buffer */
+    unsigned char *cs_ptr;	/* Next free byte in cs_buf */
+    unsigned char *cs_end;	/* End of cs_buf */
+    int		   cs_kind;	/* One of CALMA_STREAM_* above */
+    ClientData	   cs_sink;	/* Where the output goes */
+    bool	   cs_error;	/* TRUE if any output has failed */
+    int		   cs_level;	/* Compression level (CALMA_STREAM_PGZIP) */
+    int		   cs_threads;	/* Threads to use (CALMA_STREAM_PGZIP) */
+    int		   cs_nblocks;	/* Number of blocks in cs_buf */
+    CalmaBlock	  *cs_blocks;	/* One per block of cs_buf */
+} CalmaStream;
+
+/*
+ * calmaPutc --
+ *
+ * Output a single byte, like putc().  The buffer is flushed first if
+ * it is full, so there is always room for the byte.
+ */
+#define calmaPutc(c, cs) \
+    (((cs)->cs_ptr == (cs)->cs_end) ? calmaStreamFlush(cs) : (void)0, \
+	*((cs)->cs_ptr)++ = (unsigned char)(c))
+
+extern void calmaStreamInit(CalmaStream *cs, int kind, ClientData sink,
+		int level, int nthreads);
+extern void calmaStreamFlush(CalmaStream *cs);
+extern size_t calmaStreamWrite(CalmaStream *cs, const char *data, size_t n);
+extern bool calmaStreamClose(CalmaStream *cs);
+
 /* Structure used for sorting ports by number */
 
 typedef struct portlabel
@@ -237,37 +344,50 @@ extern CellDef *calmaFindCell(const char *name, bool *was_called, bool *predefin
 
 /* (Added by Nishit, 8/18/2004--8/24/2004) */
 extern CellDef *calmaLookCell(char *name);
-extern void calmaWriteContacts(FILE *f);
+extern void calmaWriteContacts(CalmaStream *f);
 extern CellDef *calmaGetContactCell(TileType type, bool lookOnly);
 extern bool calmaIsContactCell;
 
 extern const char *calmaRecordName(int rtype);
 extern void calmaSkipSet(const int *skipwhat);
 extern bool calmaParseUnits(void);
+extern void calmaSetScale(double metersPerDBUnit);
+
+/* Shared by the GDS-II and OASIS readers (CalmaRdpt.c, CalmaRdcl.c) */
+struct cifpath;
+extern FILE *calmaErrorFile;
+extern int calmaTotalErrors;
+extern int CalmaPathCount;
+extern int calmaNonManhattan;
+extern int CalmaPolygonCount;
+extern HashTable calmaDefInitHash;
+extern int calmaScaleValue(int value, int iscale);
+extern void calmaLayerError(char *mesg, int layer, int dt);
+extern void calmaPaintBoundary(struct cifpath *pathheadp, LinkedRect *rp,
+		int ciftype);
+extern void calmaPaintPath(struct cifpath *pathheadp, int width, int extend1,
+		int extend2, int pathtype, int layer, int dt);
+extern TileType calmaTextType(int layer, int textt, int *pcifnum);
+extern void calmaPlaceText(char *textbody, Rect *pr, int cifnum, TileType type,
+		int layer, int textt, int pos, int font, int size, int angle);
+extern void calmaFinishStructure(int locPolygonCount);
+extern void calmaMakeTransform(Transform *ptrans, bool upsidedown, double dmag,
+		double dangle);
+extern void calmaUniqueCell(char *sname);
+extern int calmaWriteInitFunc(CellDef *def, ClientData cdata);
 
 extern int compport(const void *one, const void *two);
 
+/* Generating the CIF of cells ahead of output (CalmaWrite.c) */
+extern int calmaWriteScale;
+extern int calmaPaintScale;
+extern void calmaOutScale(void);
+extern void calmaOutArea(CellDef *def, Rect *area);
+extern void calmaGenPlan(CellDef *rootDef, bool do_library, ClientData cdata);
+extern int calmaProcessDef(CellDef *def, CalmaStream *outf, bool do_library);
+extern bool calmaGenTake(CellDef *def, const Rect *area);
+extern void calmaGenDone(void);
 
-#define LB_EXTERNAL	0	/* Polygon external edge	*/
-#define LB_INTERNAL	1	/* Polygon internal edge	*/
-#define LB_INIT		2	/* Data not yet valid		*/
-
-typedef struct LB1 {
-    char lb_type;		/* Boundary Type (external or internal) */
-    Point lb_start;		/* Start point */
-    struct LB1 *lb_next;	/* Next point record */
-} LinkedBoundary;
-
-typedef struct BT1 {
-    LinkedBoundary *bt_first;   /* Polygon list */
-    int bt_points;		/* Number of points in this list */
-    struct BT1 *bt_next;	/* Next polygon record */
-} BoundaryTop;
-
-extern int calmaAddSegment(LinkedBoundary **lbptr, bool poly_edge, int p1x, int p1y, int p2x, int p2y);
-extern void calmaMergeSegments(LinkedBoundary *edge, BoundaryTop **blist, int num_points);
-extern void calmaRemoveDegenerate(BoundaryTop *blist);
-extern void calmaRemoveColinear(BoundaryTop *blist);
 
 /* ------------------- Imports from CIF reading ----------------------- */
 
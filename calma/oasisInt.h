@@ -0,0 +1,125 @@
+/*
+ * oasisInt.h --
+ *
+ * Definitions used internally by the OASIS (SEMI P39) reader and
+ * writer of the calma module.  OASIS files use the same layer
+ * numbers, datatypes and CIF styles as GDS-II files.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#ifndef _MAGIC__CALMA__OASISINT_H
+#define _MAGIC__CALMA__OASISINT_H
+
+/* Every OASIS file starts with these 13 bytes */
+#define OASIS_MAGIC		"%SEMI-OASIS\r\n"
+#define OASIS_MAGICLENGTH	13
+
+/* Record types */
+#define OASIS_PAD		0
+#define OASIS_START		1
+#define OASIS_END		2
+#define OASIS_CELLNAME		3	/* Implicit reference number */
+#define OASIS_CELLNAME_REF	4	/* Explicit reference number */
+#define OASIS_TEXTSTRING	5
+#define OASIS_TEXTSTRING_REF	6
+#define OASIS_PROPNAME		7
+#define OASIS_PROPNAME_REF	8
+#define OASIS_PROPSTRING	9
+#define OASIS_PROPSTRING_REF	10
+#define OASIS_LAYERNAME		11
+#define OASIS_LAYERNAME_TEXT	12
+#define OASIS_CELL_REF		13	/* Cell given by reference number */
+#define OASIS_CELL		14	/* Cell given by name */
+#define OASIS_XYABSOLUTE	15
+#define OASIS_XYRELATIVE	16
+#define OASIS_PLACEMENT		17	/* Angle in multiples of 90 degrees */
+#define OASIS_PLACEMENT_MAG	18	/* Magnification and real angle */
+#define OASIS_TEXT		19
+#define OASIS_RECTANGLE		20
+#define OASIS_POLYGON		21
+#define OASIS_PATH		22
+#define OASIS_TRAPEZOID		23	/* Both delta-a and delta-b */
+#define OASIS_TRAPEZOID_A	24	/* delta-a only */
+#define OASIS_TRAPEZOID_B	25	/* delta-b only */
+#define OASIS_CTRAPEZOID	26
+#define OASIS_CIRCLE		27
+#define OASIS_PROPERTY		28
+#define OASIS_PROPERTY_LAST	29
+#define OASIS_XNAME		30
+#define OASIS_XNAME_REF		31
+#define OASIS_XELEMENT		32
+#define OASIS_XGEOMETRY		33
+#define OASIS_CBLOCK		34
+
+/*
+ * Bits of the info-byte of element records.  The low bits are shared:
+ * layer (or textlayer), datatype (or texttype), repetition, and the
+ * x and y position.
+ */
+#define OASIS_INFO_L		0x01
+#define OASIS_INFO_D		0x02
+#define OASIS_INFO_R		0x04
+#define OASIS_INFO_Y		0x08
+#define OASIS_INFO_X		0x10
+
+/* RECTANGLE:  square, width, height */
+#define OASIS_INFO_H		0x20
+#define OASIS_INFO_W		0x40
+#define OASIS_INFO_S		0x80
+
+/* POLYGON and PATH:  point-list;  PATH:  half-width, extension scheme */
+#define OASIS_INFO_P		0x20
+#define OASIS_INFO_PW		0x40
+#define OASIS_INFO_PE		0x80
+
+/* TEXT:  texttype in place of datatype, reference number, explicit text */
+#define OASIS_INFO_T		0x02
+#define OASIS_INFO_N		0x20
+#define OASIS_INFO_C		0x40
+
+/* PLACEMENT:  flip, angle, magnification, repetition, y, x, reference */
+/* number and explicit cell					  */
+#define OASIS_INFO_F		0x01
+#define OASIS_INFO_A		0x02	/* 18:  real angle */
+#define OASIS_INFO_M		0x04	/* 18:  real magnification */
+#define OASIS_INFO_AA		0x06	/* 17:  angle / 90 in two bits */
+#define OASIS_INFO_PR		0x08
+#define OASIS_INFO_PY		0x10
+#define OASIS_INFO_PX		0x20
+#define OASIS_INFO_PN		0x40
+#define OASIS_INFO_PC		0x80
+
+/* TRAPEZOID:  vertical orientation */
+#define OASIS_INFO_O		0x80
+
+/* Point list types */
+#define OASIS_PTS_HFIRST	0	/* 1-deltas, horizontal first */
+#define OASIS_PTS_VFIRST	1	/* 1-deltas, vertical first */
+#define OASIS_PTS_2DELTA	2	/* Manhattan 2-deltas */
+#define OASIS_PTS_3DELTA	3	/* Octangular 3-deltas */
+#define OASIS_PTS_GDELTA	4	/* General g-deltas */
+#define OASIS_PTS_DDELTA	5	/* g-deltas of the g-deltas */
+
+/* Repetition types used by the writer (the reader handles all) */
+#define OASIS_REP_REUSE		0	/* Same as the last repetition */
+#define OASIS_REP_GRID		1	/* Columns and rows along x and y */
+#define OASIS_REP_XROW		2	/* Columns along x */
+#define OASIS_REP_YCOL		3	/* Rows along y */
+#define OASIS_REP_VGRID		8	/* Columns and rows along any vectors */
+#define OASIS_REP_VROW		9	/* Columns along any vector */
+
+/* CBLOCK compression type */
+#define OASIS_CBLOCK_DEFLATE	0
+
+#endif /* _MAGIC__CALMA__OASISINT_H */
@@ -26,6 +26,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include <math.h>		/* for ceil() and sqrt() */
 #include <ctype.h>
 #include <string.h>		/* for strcmp() */
+#include <sys/time.h>		/* for gettimeofday() */
 
 #include "utils/magic.h"
 #include "utils/geometry.h"
@@ -34,6 +35,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include "utils/hash.h"
 #include "database/database.h"
 #include "cif/CIFint.h"
+#include "cif/cif.h"
 #include "calma/calma.h"	/* for CalmaContactArrays */
 #include "commands/commands.h"	/* for CmdFindNetProc()	*/
 #include "select/selInt.h"	/* for select use and def */
@@ -46,11 +48,23 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 /* C99 compat */
 #include "textio/textio.h"
 #include "utils/undo.h"
+#include "utils/workers.h"
 
 /* TRUE to run (very slow) algorithm for optimizing non-manhattan tiles */
 /* (cuts size of output;  see also the GDS "merge" option)		*/
 bool CIFUnfracture = FALSE;
 
+/* Number of threads CIFGen may use to generate independent layers at
+ * the same time.  1 generates layers one by one;  0 means one thread
+ * per processor (see WorkerCount()).
+ */
+int CIFGenThreads = 1;
+
+/* Cells with fewer paint tiles than this in the area being generated
+ * are not worth starting threads for.
+ */
+#define CIF_PARALLEL_MIN_TILES	2000
+
 /* The following global arrays hold pointers to the CIF planes
  * generated by the procedures in this module.  There are two
  * kinds of planes:  real CIF, which will ostensibly be output,
@@ -76,9 +90,17 @@ const PaintResultType CIFEraseTable[] = {TT_SPACE, TT_SPACE};
  * information between CIFGen and the various search functions.
  */
 
-static int growDistance;	/* Distance to grow stuff. */
-static Plane *cifPlane;		/* Plane acted on by search functions. */
-static int cifScale;		/* Scale factor to use on tiles. */
+static THREAD_LOCAL int growDistance;	/* Distance to grow stuff. */
+static THREAD_LOCAL Plane *cifPlane;	/* Plane acted on by search functions. */
+static THREAD_LOCAL int cifScale;	/* Scale factor to use on tiles. */
+
+/* Scratch storage kept between calls.  Like the variables above, each
+ * thread generating layers has its own copy (see cifGenThreadDone()).
+ */
+
+static THREAD_LOCAL Plane *nextPlane;	/* Spare plane for CIFGenLayer */
+static THREAD_LOCAL Stack *BloatStack, *ResetStack, *GatherStack;
+static THREAD_LOCAL Stack *BoxStack, *CutStack, *RegStack;
 
 extern void cifClipPlane(Plane *plane, Rect *clip);
 extern void cifGenClip(const Rect *area, Rect *expanded, Rect *clip);
@@ -1387,8 +1409,6 @@ cifBloatAllFunc(
     CIFOp *op;
     CellDef *def;
     Plane **temps;
-    static Stack *BloatStack = (Stack *)NULL;
-    static Stack *ResetStack = (Stack *)NULL;
 
     op = bls->op;
     def = bls->def;
@@ -2239,8 +2259,6 @@ cifGatherFunc(
     ClientData cdata = (mode == CLOSE_SEARCH) ? CIF_UNPROCESSED :
 	    CD2INT(CIF_PENDING);
 
-    static Stack *GatherStack = (Stack *)NULL;
-
     if (GatherStack == (Stack *)NULL)
 	GatherStack = StackNew(64);
 
@@ -2582,7 +2600,6 @@ cifRectBoundingBox(
     int i, j, savecount;
     TileType type;
     bool simple;
-    static Stack *BoxStack = (Stack *)NULL;
 
     if (BoxStack == (Stack *)NULL)
 	BoxStack = StackNew(64);
@@ -2745,7 +2762,6 @@ cifSquaresFillArea(
     StripsData stripsData;
     linkedStrip *stripList;
     bool simple;
-    static Stack *CutStack = (Stack *)NULL;
 
     pitch = squares->sq_size + squares->sq_sep;
     size = squares->sq_size + 2 * squares->sq_border;
@@ -3078,7 +3094,6 @@ cifSlotsFillArea(
     StripsData stripsData;
     linkedStrip *stripList;
     bool simple, vertical;
-    static Stack *CutStack = (Stack *)NULL;
 
     spitch = slots->sl_ssize + slots->sl_ssep;
     lpitch = slots->sl_lsize + slots->sl_lsep;
@@ -3672,14 +3687,8 @@ cifContactFunc(
     left += halfsize;
     bottom += halfsize;
 
-#ifdef HAVE_ZLIB
-    if (CalmaCompression > 0)
-	result = CalmaGenerateArrayZ((FILETYPE)csi->csi_client, csi->csi_type,
-		left, bottom, pitch, nAcross, nUp);
-    else
-#endif
-	result = CalmaGenerateArray((FILE *)csi->csi_client, csi->csi_type,
-		left, bottom, pitch, nAcross, nUp);
+    result = CalmaGenerateArray((struct calmastream *)csi->csi_client,
+		csi->csi_type, left, bottom, pitch, nAcross, nUp);
 
     return (result == TRUE) ? 0 : 1;
 }
@@ -4200,7 +4209,7 @@ typedef struct _bridgeLimStruct {
     TileTypeBitMask co_cifMask;  /* Zero or more other CIF layers. */
 } BridgeLimStruct;
 
-static int xOverlap, yOverlap;
+static THREAD_LOCAL int xOverlap, yOverlap;
 
 /* Bridge-lim Check data structure */
 
@@ -4910,7 +4919,6 @@ cifInteractingRegions(
     int i;
     TileType type;
     bool interacts;
-    static Stack *RegStack = (Stack *)NULL;
 
     if (RegStack == (Stack *)NULL)
 	RegStack = StackNew(64);
@@ -5095,6 +5103,41 @@ cifCopyPropPlaneFunc(Tile *tile,
     return 0;
 }
 
+/* Cell and level for which CIFGen is generating layers, to which
+ * CIFGenLayer charges its operations while CIFProfileOps is TRUE.
+ * NULL when CIFGenLayer is called other than from CIFGen (e.g., by
+ * CIF input), in which case nothing is recorded.
+ */
+
+static THREAD_LOCAL CellDef *cifProfDef = NULL;
+static THREAD_LOCAL bool cifProfHier = FALSE;
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifProfCountFunc --
+ *
+ *	Count the tiles in the result of an operation, for the profile.
+ *
+ * Results:
+ *	Always returns 0 to keep the search going.
+ *
+ * Side effects:
+ *	Increments *count.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+cifProfCountFunc(
+    Tile *tile,			/* (unused) */
+    TileType dinfo,		/* (unused) */
+    int *count)
+{
+    (*count)++;
+    return 0;
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -5140,7 +5183,7 @@ CIFGenLayer(
 				 */
 {
     Plane *temp;
-    static Plane *nextPlane, *curPlane;
+    static THREAD_LOCAL Plane *curPlane;
     Rect bbox;
     CIFOp *tempOp;
     CIFSquaresInfo csi;
@@ -5157,6 +5200,9 @@ CIFGenLayer(
     PropertyRecord *proprec;
     char *propvalue;
     bool found;
+    bool profile = (CIFProfileOps && (cifProfDef != NULL));
+    struct timeval opStart, opEnd;
+    int opNum, tileOps = 0, tilesOut;
 
     int (*cifGrowFuncPtr)() = (CIFCurStyle->cs_flags & CWF_GROW_EUCLIDEAN) ?
 		cifGrowEuclideanFunc : cifGrowFunc;
@@ -5183,8 +5229,14 @@ CIFGenLayer(
      * SLOTS.
      */
 
-    for ( ; op != NULL; op = op->co_next)
+    for (opNum = 0; op != NULL; op = op->co_next, opNum++)
     {
+	if (profile)
+	{
+	    tileOps = CIFTileOps;
+	    gettimeofday(&opStart, (struct timezone *)NULL);
+	}
+
 	switch (op->co_opcode)
 	{
 	    /* For AND, first collect all the stuff to be anded with
@@ -5862,12 +5914,490 @@ CIFGenLayer(
 	    default:
 		continue;
 	}
+
+	if (profile)
+	{
+	    /* The result is counted outside of the timed interval */
+	    gettimeofday(&opEnd, (struct timezone *)NULL);
+	    tilesOut = 0;
+	    DBSrPaintArea((Tile *)NULL, curPlane, &TiPlaneRect, &CIFSolidBits,
+			cifProfCountFunc, (ClientData)&tilesOut);
+	    CIFOpStatsAdd(cifProfDef, cifProfHier, CIFErrorLayer, opNum,
+			op->co_opcode, CIFTileOps - tileOps, tilesOut,
+			(opEnd.tv_sec - opStart.tv_sec)
+			+ (opEnd.tv_usec - opStart.tv_usec) * 1e-6);
+	}
 	if (hstop) break;	/* Don't process any further rules */
     }
 
     return curPlane;
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenThreadDone --
+ *
+ *	Release the scratch storage that CIFGenLayer keeps between calls
+ *	on the calling thread, along with the thread's free tiles and its
+ *	delayed free.  Called at the end of each job that generates a layer
+ *	for CIFGen, since a worker thread's storage would otherwise be lost
+ *	when the thread exits.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifGenThreadDone(void)
+{
+    int i;
+    Stack **stacks[] = { &BloatStack, &ResetStack, &GatherStack,
+		&BoxStack, &CutStack, &RegStack };
+
+    if (nextPlane != NULL)
+    {
+	DBFreePaintPlane(nextPlane);
+	TiFreePlane(nextPlane);
+	nextPlane = NULL;
+    }
+
+    for (i = 0; i < sizeof(stacks) / sizeof(stacks[0]); i++)
+	if (*stacks[i] != NULL)
+	{
+	    StackFree(*stacks[i]);
+	    *stacks[i] = NULL;
+	}
+
+    TiStoreRelease();
+    freeMagicFlush();
+}
+
+/* Work shared by the jobs that generate the layers of one call to
+ * CIFGen concurrently.
+ */
+
+typedef struct
+{
+    int		 cw_order[MAXCIFLAYERS];  /* Layers of the current wave */
+    const Rect	*cw_area;		/* Area to consider, as for CIFGenLayer */
+    CellDef	*cw_def;		/* Cell to generate CIF for */
+    CellDef	*cw_origDef;		/* Original cell, for CIFGenLayer */
+    Plane	**cw_new;		/* Generated planes, indexed by layer */
+    ClientData	 cw_client;		/* Passed to CIFGenLayer */
+    CIFQueuedError *cw_errors[MAXCIFLAYERS];  /* Errors queued per layer */
+    double	 cw_time[MAXCIFLAYERS];	/* Seconds spent on each layer */
+    int		 cw_tileOps[MAXCIFLAYERS]; /* Tile operations per layer */
+} CIFGenWork;
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifOpsThreadSafe --
+ *
+ *	Determine whether a layer may be generated at the same time as
+ *	other layers.  Operations that mark the tiles of the planes they
+ *	read, that use the selection or undo machinery, or that modify
+ *	the op itself or write output must run alone.
+ *
+ * Results:
+ *	TRUE if none of the operations in the list is unsafe.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+cifOpsThreadSafe(
+    CIFOp *op)
+{
+    for (; op != NULL; op = op->co_next)
+    {
+	switch (op->co_opcode)
+	{
+	    case CIFOP_BLOATALL:	/* Marks tiles of the source planes */
+	    case CIFOP_TAGGED:
+	    case CIFOP_NET:		/* Uses Select2Def and undo */
+	    case CIFOP_MAXRECT:		/* Static storage in utils/maxrect.c */
+		return FALSE;
+	    case CIFOP_OR:		/* Contact arrays modify the op */
+		if ((op->co_client != (ClientData)NULL)
+				&& (CalmaContactArrays == TRUE))
+		    return FALSE;
+		break;
+	    default:
+		break;
+	}
+    }
+    return TRUE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifCountTileFunc --
+ *
+ *	Called for each paint tile by cifGenThreadCount.
+ *
+ * Results:
+ *	Returns 1 to stop the search once enough tiles have been counted.
+ *
+ * Side effects:
+ *	Increments the count.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+cifCountTileFunc(
+    Tile *tile,
+    TileType dinfo,
+    int *count)
+{
+    return (++(*count) >= CIF_PARALLEL_MIN_TILES) ? 1 : 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenThreadCount --
+ *
+ *	Decide how many threads CIFGen should use for an area of a cell.
+ *
+ * Results:
+ *	The number of threads, or 1 if the layers should be generated in
+ *	order on the calling thread.  This is the case unless CIFGenThreads
+ *	asks for threads and the area holds enough paint to pay for them,
+ *	and operations are not being profiled (see CIFOpStatsAdd).
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+cifGenThreadCount(
+    CellDef *cellDef,
+    const Rect *area)
+{
+#ifdef HAVE_THREAD_LOCAL
+    int nthreads, pNum, count = 0;
+
+    /* The per-operation profile is kept by the main thread only */
+    if ((CIFGenThreads == 1) || CIFProfileOps) return 1;
+    nthreads = WorkerCount(CIFGenThreads);
+    if (nthreads <= 1) return 1;
+
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+	if (DBSrPaintArea((Tile *)NULL, cellDef->cd_planes[pNum], area,
+		    &DBAllButSpaceBits, cifCountTileFunc, (ClientData)&count))
+	    return nthreads;
+#endif
+    return 1;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenLayerJob --
+ *
+ *	Generate one layer for cifGenParallel.  This is a job procedure
+ *	for WorkerRun(), and so may run on any thread.  Errors found while
+ *	generating the layer are queued for cifGenParallel to report.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in the plane, time, and tile count of the layer in the
+ *	CIFGenWork record.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifGenLayerJob(
+    int job,			/* Index into cw_order */
+    ClientData cdata)		/* CIFGenWork record */
+{
+    CIFGenWork *work = (CIFGenWork *)cdata;
+    int i = work->cw_order[job];
+    int tileOps = CIFTileOps;
+    struct timeval start, now;
+
+    gettimeofday(&start, (struct timezone *)NULL);
+    CIFErrorLayer = i;
+    CIFErrorQueue = &work->cw_errors[i];
+    work->cw_new[i] = CIFGenLayer(CIFCurStyle->cs_layers[i]->cl_ops,
+		work->cw_area, work->cw_def, work->cw_origDef, work->cw_new,
+		FALSE, work->cw_client);
+    if (CIFUnfracture) DBMergeNMTiles(work->cw_new[i], work->cw_area,
+		(PaintUndoInfo *)NULL);
+    CIFErrorQueue = NULL;
+    gettimeofday(&now, (struct timezone *)NULL);
+
+    work->cw_time[i] = (now.tv_sec - start.tv_sec)
+		+ (now.tv_usec - start.tv_usec) * 1e-6;
+    /* The caller adds the count to CIFTileOps of its own thread */
+    work->cw_tileOps[i] = CIFTileOps - tileOps;
+    CIFTileOps = tileOps;
+    cifGenThreadDone();
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenParallel --
+ *
+ *	Generate the layers for CIFGen using several threads.  A layer
+ *	can only be generated once the layers it uses as templayers are
+ *	done, so the layers are sorted into waves by the depth of their
+ *	dependencies.  The layers of a wave are generated at the same time,
+ *	except for those using operations that are not thread safe (see
+ *	cifOpsThreadSafe()), which are generated afterwards on the calling
+ *	thread.  Each layer is built in a plane of its own, so the result
+ *	is identical to generating the layers in order.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in new[] as CIFGen does.  Errors are reported in layer order
+ *	once all layers are done, and layer statistics are recorded.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifGenParallel(
+    int nthreads,		/* Number of threads to use */
+    CellDef *cellDef,		/* Cell for which CIF is to be generated */
+    CellDef *origDef,		/* Original cell, if different from cellDef */
+    const Rect *area,		/* Area to consider, as for CIFGenLayer */
+    TileTypeBitMask *layers,	/* CIF layers to generate */
+    bool genAllPlanes,		/* As for CIFGen */
+    Plane **new,		/* Filled in with the generated planes */
+    ClientData clientdata)	/* Passed to CIFGenLayer */
+{
+    CIFGenWork work;
+    CIFOp *op;
+    BloatData *bloats;
+    int level[MAXCIFLAYERS];
+    int i, j, wave, maxLevel = -1, nsafe, njobs;
+
+    /* Find the dependency depth of each layer being generated.  Other
+     * layers are only read through co_cifMask (and the templayers of
+     * bloat-all), and always precede the layers that read them.
+     */
+
+    for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
+    {
+	level[i] = -1;
+	work.cw_errors[i] = NULL;
+	if (!TTMaskHasType(layers, i))
+	{
+	    new[i] = (genAllPlanes) ? DBNewPlane((ClientData) TT_SPACE) :
+			(Plane *) NULL;
+	    continue;
+	}
+	new[i] = (Plane *) NULL;
+	level[i] = 0;
+	for (op = CIFCurStyle->cs_layers[i]->cl_ops; op; op = op->co_next)
+	{
+	    bloats = (op->co_opcode == CIFOP_BLOATALL) ?
+			(BloatData *)op->co_client : (BloatData *)NULL;
+	    if ((bloats != NULL) && (bloats->bl_plane >= 0)) bloats = NULL;
+	    for (j = 0; j < i; j++)
+		if ((TTMaskHasType(&op->co_cifMask, j) ||
+			((bloats != NULL) && (bloats->bl_distance[j] != 0)))
+			&& (level[j] >= level[i]))
+		    level[i] = level[j] + 1;
+	}
+	if (level[i] > maxLevel) maxLevel = level[i];
+    }
+
+    work.cw_area = area;
+    work.cw_def = cellDef;
+    work.cw_origDef = origDef;
+    work.cw_new = new;
+    work.cw_client = clientdata;
+
+    for (wave = 0; wave <= maxLevel; wave++)
+    {
+	/* List the thread-safe layers of the wave first */
+
+	nsafe = njobs = 0;
+	for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
+	    if ((level[i] == wave) &&
+			cifOpsThreadSafe(CIFCurStyle->cs_layers[i]->cl_ops))
+		work.cw_order[nsafe++] = i;
+	njobs = nsafe;
+	for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
+	    if ((level[i] == wave) &&
+			!cifOpsThreadSafe(CIFCurStyle->cs_layers[i]->cl_ops))
+		work.cw_order[njobs++] = i;
+
+	WorkerRun(nthreads, nsafe, cifGenLayerJob, (ClientData)&work);
+	for (j = nsafe; j < njobs; j++)
+	    cifGenLayerJob(j, (ClientData)&work);
+
+	for (j = 0; j < njobs; j++)
+	{
+	    i = work.cw_order[j];
+	    CIFTileOps += work.cw_tileOps[i];
+	    CIFLayerStatsAdd(i, work.cw_time[i], work.cw_tileOps[i],
+			(j < nsafe) && (nsafe > 1));
+	}
+    }
+
+    for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
+	if (work.cw_errors[i] != NULL)
+	    CIFErrorReplay(work.cw_errors[i]);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenSerial --
+ *
+ *	Generate the layers of 'layers' one after another on the calling
+ *	thread, for CIFGen or for a cell generated by CIFGenCells.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in new[] as CIFGen describes.  The time and tile operations
+ *	of each layer are passed to CIFLayerStatsAdd() if 'layerTime' is
+ *	NULL, and otherwise saved in layerTime[] and layerTileOps[] for
+ *	the caller and left out of this thread's CIFTileOps.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifGenSerial(
+    CellDef *cellDef,		/* Cell for which CIF is to be generated */
+    CellDef *origDef,		/* Original cell, if different from cellDef */
+    const Rect *expanded,	/* Area to consider, as for CIFGenLayer */
+    TileTypeBitMask *layers,	/* CIF layers to generate */
+    bool genAllPlanes,		/* As for CIFGen */
+    Plane **new,		/* Filled in with the generated planes */
+    bool hier,			/* As for CIFGen */
+    ClientData clientdata,	/* Passed to CIFGenLayer */
+    double *layerTime,		/* If non-NULL, time taken by each layer */
+    int *layerTileOps)		/* Tile operations of each layer */
+{
+    int i, tileOps;
+    struct timeval start, now;
+    double seconds;
+
+    for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
+    {
+	if (TTMaskHasType(layers,i))
+	{
+	    gettimeofday(&start, (struct timezone *)NULL);
+	    tileOps = CIFTileOps;
+	    CIFErrorLayer = i;
+	    if (CIFProfileOps)
+	    {
+		cifProfDef = (origDef) ? origDef : cellDef;
+		cifProfHier = hier;
+	    }
+	    new[i] = CIFGenLayer(CIFCurStyle->cs_layers[i]->cl_ops,
+		    expanded, cellDef, origDef, new, hier, clientdata);
+	    cifProfDef = (CellDef *)NULL;
+
+	    /* Clean up the non-manhattan geometry in the plane */
+	    if (CIFUnfracture) DBMergeNMTiles(new[i], expanded,
+			(PaintUndoInfo *)NULL);
+
+	    gettimeofday(&now, (struct timezone *)NULL);
+	    seconds = (now.tv_sec - start.tv_sec)
+			+ (now.tv_usec - start.tv_usec) * 1e-6;
+	    if (layerTime == NULL)
+		CIFLayerStatsAdd(i, seconds, CIFTileOps - tileOps, FALSE);
+	    else
+	    {
+		layerTime[i] = seconds;
+		layerTileOps[i] = CIFTileOps - tileOps;
+		CIFTileOps = tileOps;
+	    }
+	}
+	else if (genAllPlanes) new[i] = DBNewPlane((ClientData) TT_SPACE);
+	else new[i] = (Plane *) NULL;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenCombine --
+ *
+ *	Mask off all the unwanted material in the newly generated layers
+ *	and either OR them into the existing layers or replace the
+ *	existing material with them.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Modifies planes[].  The planes of new[] are either moved into
+ *	planes[] or freed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifGenCombine(
+    Plane **new,		/* Newly generated layers */
+    Plane **planes,		/* Layers to be updated */
+    Rect *clip,			/* Area to keep, in CIF coordinates */
+    bool replace)		/* As for CIFGen */
+{
+    int i;
+
+    for (i = 0; i < CIFCurStyle->cs_nLayers; i += 1)
+    {
+	if (new[i])
+	    cifClipPlane(new[i], clip);
+
+	if (replace)
+	{
+	    if (planes[i])
+	    {
+		DBFreePaintPlane(planes[i]);
+		TiFreePlane(planes[i]);
+	    }
+	    planes[i] = new[i];
+	    continue;
+	}
+
+	if (planes[i])
+	{
+	    if (new[i])
+	    {
+		cifPlane = planes[i];
+		cifScale = 1;
+		(void) DBSrPaintArea((Tile *) NULL, new[i], &TiPlaneRect,
+			&CIFSolidBits, cifPaintFunc,
+			(ClientData) CIFPaintTable);
+		DBFreePaintPlane(new[i]);
+		TiFreePlane(new[i]);
+	    }
+	}
+	else planes[i] = new[i];
+    }
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -5919,7 +6449,7 @@ CIFGen(
 				 * CIF operation functions.
 				 */
 {
-    int i;
+    int nthreads;
     Plane *new[MAXCIFLAYERS];
     Rect expanded, clip;
 
@@ -5932,60 +6462,262 @@ CIFGen(
     /*
      * Generate all of the new layers in a temporary place.
      * If a layer isn't being generated, leave new[i] set to
-     * NULL to indicate this fact.
+     * NULL to indicate this fact.  Large non-hierarchical areas
+     * may be handed to several threads.
      */
+    nthreads = (hier) ? 1 : cifGenThreadCount(cellDef, &expanded);
+    if (nthreads > 1)
+	cifGenParallel(nthreads, cellDef, origDef, &expanded, layers,
+		genAllPlanes, new, clientdata);
+    else
+	cifGenSerial(cellDef, origDef, &expanded, layers, genAllPlanes,
+		new, hier, clientdata, (double *)NULL, (int *)NULL);
+
+    cifGenCombine(new, planes, &clip, replace);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFGenCellsOK --
+ *
+ *	Check whether CIFGenCells can generate cells concurrently with
+ *	the current style.  The operations that CIFGen can't run on a
+ *	worker thread for one layer (see cifOpsThreadSafe) can be run for
+ *	one cell, except for those that modify the style or use storage
+ *	shared by all cells.
+ *
+ * Results:
+ *	TRUE if cells may be generated on worker threads.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+CIFGenCellsOK(void)
+{
+#ifdef HAVE_THREAD_LOCAL
+    CIFOp *op;
+    int i;
+
+    if ((CIFCurStyle == NULL) || CIFProfileOps) return FALSE;
+
+    for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
+	for (op = CIFCurStyle->cs_layers[i]->cl_ops; op; op = op->co_next)
+	    switch (op->co_opcode)
+	    {
+		case CIFOP_TAGGED:	/* Swaps co_client while running */
+		case CIFOP_NET:		/* Uses Select2Def and undo */
+		case CIFOP_MAXRECT:	/* Static storage in utils/maxrect.c */
+		    return FALSE;
+		case CIFOP_OR:		/* Contact arrays modify the op */
+		    if ((op->co_client != (ClientData)NULL)
+				&& (CalmaContactArrays == TRUE))
+			return FALSE;
+		    break;
+		default:
+		    /* BLOATALL marks tiles of the cell's own planes only */
+		    break;
+	    }
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFGenCellNew --
+ *
+ *	Create a record for CIFGenCells, to generate all of the CIF of
+ *	'def' in 'area' as CIFGen(def, def, area, planes, &DBAllTypeBits,
+ *	TRUE, TRUE, FALSE, clientdata) would.
+ *
+ * Results:
+ *	A new CIFGenCell record, to be passed to CIFGenCellFree() when
+ *	done.
+ *
+ * Side effects:
+ *	Allocates memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+CIFGenCell *
+CIFGenCellNew(
+    CellDef *def,		/* Cell to generate */
+    const Rect *area,		/* Area of def to generate */
+    ClientData clientdata)	/* Passed to CIFGenLayer */
+{
+    CIFGenCell *cgc;
+
+    cgc = (CIFGenCell *)mallocMagic(sizeof(CIFGenCell));
+    bzero((char *)cgc, sizeof(CIFGenCell));
+    cgc->cgc_def = def;
+    cgc->cgc_area = *area;
+    cgc->cgc_client = clientdata;
+    return cgc;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifGenCellJob --
+ *
+ *	Generate one cell for CIFGenCells.  This is a job procedure for
+ *	WorkerRun(), and so may run on any thread.  Errors are queued in
+ *	the cell's record, to be reported by CIFGenCellTake().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in the planes, errors, and statistics of the record.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifGenCellJob(
+    int job,			/* Index into the list of records */
+    ClientData cdata)		/* List of CIFGenCell records */
+{
+    CIFGenCell *cgc = ((CIFGenCell **)cdata)[job];
+    Plane *new[MAXCIFLAYERS];
+    Rect expanded, clip;
+
+    CIFErrorQueue = &cgc->cgc_errors;
+    cifGenClip(&cgc->cgc_area, &expanded, &clip);
+    cifGenSerial(cgc->cgc_def, cgc->cgc_def, &expanded, &DBAllTypeBits,
+		TRUE, new, FALSE, cgc->cgc_client, cgc->cgc_time,
+		cgc->cgc_tileOps);
+    cifGenCombine(new, cgc->cgc_planes, &clip, TRUE);
+    CIFErrorQueue = NULL;
+    cgc->cgc_done = TRUE;
+    cifGenThreadDone();
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFGenCells --
+ *
+ *	Generate the CIF of several cells at once, using up to 'nthreads'
+ *	threads.  The caller must have checked CIFGenCellsOK(), and must
+ *	not change the cells or the style until the records are freed.
+ *	NULL entries and records already generated are skipped.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in the records, for CIFGenCellTake().
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFGenCells(
+    CIFGenCell **cells,		/* Records of cells to generate */
+    int ncells,			/* Number of records */
+    int nthreads)		/* Number of threads to use */
+{
+    CIFGenCell **jobs;
+    int i, njobs = 0;
+
+    jobs = (CIFGenCell **)mallocMagic(ncells * sizeof(CIFGenCell *));
+    for (i = 0; i < ncells; i++)
+	if ((cells[i] != NULL) && !cells[i]->cgc_done)
+	    jobs[njobs++] = cells[i];
+    WorkerRun(nthreads, njobs, cifGenCellJob, (ClientData)jobs);
+    freeMagic((char *)jobs);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFGenCellTake --
+ *
+ *	Hand the CIF generated for a cell by CIFGenCells to the caller
+ *	in place of calling CIFGen.  Errors found while generating the
+ *	cell are reported now, against CIFErrorDef, in the order CIFGen
+ *	would have reported them, and the statistics are added in.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The planes of the record replace those of planes[], which are
+ *	freed.  The record is left empty.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFGenCellTake(
+    CIFGenCell *cgc,		/* Generated cell */
+    Plane **planes)		/* Planes to receive the CIF */
+{
+    int i;
+
     for (i = 0; i < CIFCurStyle->cs_nLayers; i++)
     {
-	if (TTMaskHasType(layers,i))
+	CIFTileOps += cgc->cgc_tileOps[i];
+	CIFLayerStatsAdd(i, cgc->cgc_time[i], cgc->cgc_tileOps[i], TRUE);
+	if (planes[i])
 	{
-	    CIFErrorLayer = i;
-	    new[i] = CIFGenLayer(CIFCurStyle->cs_layers[i]->cl_ops,
-		    &expanded, cellDef, origDef, new, hier, clientdata);
-
-	    /* Clean up the non-manhattan geometry in the plane */
-	    if (CIFUnfracture) DBMergeNMTiles(new[i], &expanded,
-			(PaintUndoInfo *)NULL);
+	    DBFreePaintPlane(planes[i]);
+	    TiFreePlane(planes[i]);
 	}
-	else if (genAllPlanes) new[i] = DBNewPlane((ClientData) TT_SPACE);
-	else new[i] = (Plane *) NULL;
+	planes[i] = cgc->cgc_planes[i];
+	cgc->cgc_planes[i] = (Plane *)NULL;
     }
+    if (cgc->cgc_errors != NULL)
+	CIFErrorReplay(cgc->cgc_errors);
+    cgc->cgc_errors = NULL;
+}
 
-    /*
-     * Now mask off all the unwanted material in the new layers, and
-     * either OR them into the existing layers or replace the existing
-     * material with them.
-     */
-    for (i = 0; i < CIFCurStyle->cs_nLayers; i += 1)
-    {
-	if (new[i])
-	    cifClipPlane(new[i], &clip);
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFGenCellFree --
+ *
+ *	Free a record made by CIFGenCellNew, along with any CIF and errors
+ *	that it still holds.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
 
-	if (replace)
-	{
-	    if (planes[i])
-	    {
-		DBFreePaintPlane(planes[i]);
-		TiFreePlane(planes[i]);
-	    }
-	    planes[i] = new[i];
-	    continue;
-	}
+void
+CIFGenCellFree(
+    CIFGenCell *cgc)
+{
+    CIFQueuedError *cqe;
+    int i;
 
-	if (planes[i])
+    for (i = 0; i < MAXCIFLAYERS; i++)
+	if (cgc->cgc_planes[i])
 	{
-	    if (new[i])
-	    {
-		cifPlane = planes[i];
-		cifScale = 1;
-		(void) DBSrPaintArea((Tile *) NULL, new[i], &TiPlaneRect,
-			&CIFSolidBits, cifPaintFunc,
-			(ClientData) CIFPaintTable);
-		DBFreePaintPlane(new[i]);
-		TiFreePlane(new[i]);
-	    }
+	    DBFreePaintPlane(cgc->cgc_planes[i]);
+	    TiFreePlane(cgc->cgc_planes[i]);
 	}
-	else planes[i] = new[i];
+    for (cqe = cgc->cgc_errors; cqe != NULL; cqe = cgc->cgc_errors)
+    {
+	cgc->cgc_errors = cqe->cqe_next;
+	freeMagic(cqe->cqe_message);
+	freeMagic((char *)cqe);
     }
+    freeMagic((char *)cgc);
 }
 
 /*
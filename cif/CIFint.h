@@ -380,7 +380,7 @@ typedef enum {CIF_WARN_DEFAULT, CIF_WARN_NONE, CIF_WARN_ALIGN,
 
 /* Statistics counters: */
 
-extern int CIFTileOps;
+extern THREAD_LOCAL int CIFTileOps;
 extern int CIFHierTileOps;
 extern int CIFRects;
 extern int CIFHierRects;
@@ -391,10 +391,60 @@ extern const PaintResultType CIFPaintTable[], CIFEraseTable[];
 
 /* Procedures and variables for reporting errors. */
 
-extern int CIFErrorLayer;
+extern THREAD_LOCAL int CIFErrorLayer;
 extern CellDef *CIFErrorDef;
 extern void CIFError(Rect *area, char *message);
 
+/* While CIFGen generates layers concurrently, errors for each layer are
+ * queued here and reported afterwards in layer order.
+ */
+
+typedef struct cifqueuederror
+{
+    Rect cqe_area;			/* Area of the error */
+    char *cqe_message;			/* Note about what went wrong */
+    int cqe_layer;			/* CIFErrorLayer at the time */
+    struct cifqueuederror *cqe_next;
+} CIFQueuedError;
+
+extern THREAD_LOCAL CIFQueuedError **CIFErrorQueue;
+extern void CIFErrorReplay(CIFQueuedError *list);
+
+/* The CIF of a whole cell, generated on a worker thread by CIFGenCells()
+ * ahead of the time that it is needed.
+ */
+
+typedef struct cifgencell
+{
+    CellDef *cgc_def;			/* Cell to generate */
+    Rect cgc_area;			/* Area of the cell to generate */
+    ClientData cgc_client;		/* Passed to CIFGenLayer */
+    bool cgc_done;			/* TRUE once generated */
+    Plane *cgc_planes[MAXCIFLAYERS];	/* The generated CIF */
+    CIFQueuedError *cgc_errors;		/* Errors found, most recent first */
+    double cgc_time[MAXCIFLAYERS];	/* Time taken by each layer */
+    int cgc_tileOps[MAXCIFLAYERS];	/* Tile operations of each layer */
+} CIFGenCell;
+
+extern bool CIFGenCellsOK(void);
+extern CIFGenCell *CIFGenCellNew(CellDef *def, const Rect *area,
+		ClientData clientdata);
+extern void CIFGenCells(CIFGenCell **cells, int ncells, int nthreads);
+extern void CIFGenCellTake(CIFGenCell *cgc, Plane **planes);
+extern void CIFGenCellFree(CIFGenCell *cgc);
+
+/* Time spent generating each layer, reported by CIFPrintStats() */
+
+extern void CIFLayerStatsAdd(int layer, double seconds, int tileops,
+		bool parallel);
+
+/* Time spent in each operation of each layer, recorded by CIFGenLayer
+ * while CIFProfileOps (see cif.h) is TRUE.
+ */
+
+extern void CIFOpStatsAdd(CellDef *def, bool hier, int layer, int op,
+		int opcode, int tilesIn, int tilesOut, double seconds);
+
 /* The following determines the tile type used to hold the CIF
  * information on its paint plane.
  */
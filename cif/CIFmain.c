@@ -21,6 +21,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #endif  /* not lint */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "tcltk/tclmagic.h"
@@ -30,10 +31,13 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include "utils/hash.h"
 #include "database/database.h"
 #include "cif/CIFint.h"
+#include "cif/cif.h"
 #include "textio/textio.h"
 #include "windows/windows.h"
 #include "dbwind/dbwind.h"
 #include "utils/styles.h"
+#include "utils/utils.h"
+#include "utils/malloc.h"
 
 /* The following points to a list of all the CIF output styles
  * currently understood:
@@ -50,8 +54,10 @@ CIFStyle *CIFCurStyle = NULL;
  * a total number, and the number since stats were last printed.
  */
 
-int CIFTileOps = 0;		/* Total tiles touched in geometrical
-				 * operations.
+THREAD_LOCAL int CIFTileOps = 0; /* Total tiles touched in geometrical
+				 * operations.  Threads generating layers
+				 * for CIFGen count their own, which CIFGen
+				 * adds back in.
 				 */
 int CIFHierTileOps = 0;		/* Tiles touched in geometrical operations
 				 * as part of hierarchical processing.
@@ -64,6 +70,67 @@ static int cifTotalHierTileOps = 0;
 static int cifTotalRects = 0;
 static int cifTotalHierRects = 0;
 
+/* Time and tile operations spent on each layer of the current style
+ * since the statistics were last printed, and the number of times the
+ * layer was generated, and generated concurrently with other layers.
+ */
+
+static double cifLayerTime[MAXCIFLAYERS];
+static int cifLayerTileOps[MAXCIFLAYERS];
+static int cifLayerCount[MAXCIFLAYERS];
+static int cifLayerParallel[MAXCIFLAYERS];
+
+/* Per-operation profile, collected while "cif statistics -ops on" is in
+ * effect.  There is one record for each operation of each layer in each
+ * cell, at each level (paint or hierarchical interactions), keyed by the
+ * structure below.  Profiling forces CIFGen to run serially, so this is
+ * touched by the main thread only.
+ */
+
+typedef struct
+{
+    CellDef *cok_def;		/* Cell being generated */
+    int	     cok_hier;		/* 1 for hierarchical processing */
+    int	     cok_layer;		/* Index of CIF layer */
+    int	     cok_op;		/* Position of the op in the layer */
+} CIFOpKey;
+
+typedef struct
+{
+    char  *cos_cell;		/* Cell name (the def may be deleted) */
+    char  *cos_layer;		/* CIF layer name */
+    int	   cos_hier;		/* 1 for hierarchical processing */
+    int	   cos_op;		/* Position of the op in the layer */
+    int	   cos_opcode;		/* CIFOP_* */
+    int	   cos_calls;		/* Number of times the op was run */
+    dlong  cos_tilesIn;		/* Tiles visited by the op */
+    dlong  cos_tilesOut;	/* Tiles in the op's result */
+    double cos_time;		/* Wall clock seconds */
+} CIFOpStat;
+
+bool CIFProfileOps = FALSE;	/* TRUE while profiling operations */
+static HashTable cifOpTable;	/* CIFOpStat records keyed by CIFOpKey */
+static int cifOpCount = -1;	/* Number of records, or -1 if the
+				 * table has not been initialized.
+				 */
+
+/* Names of the operations, indexed by CIFOP_*, as in the tech file */
+
+static const char * const cifOpNames[] =
+{
+    "?", "and", "or", "grow", "grow-min", "grow-grid", "shrink", "bloat-or",
+    "squares", "slots", "bloat-max", "bloat-min", "bloat-all", "and-not",
+    "squares-grid", "bbox", "boundary", "net", "maxrect", "interacting",
+    "copyup", "close", "orthogonal", "bridge", "bridge-lim", "mask-hints",
+    "not-square", "tagged"
+};
+
+#define CIFOP_NAME(op) (((op) > 0 && (op) <= CIFOP_TAGGED) ? \
+		cifOpNames[op] : cifOpNames[0])
+
+/* Number of rows of the per-op table printed by CIFPrintOpStats */
+#define CIF_OPSTAT_ROWS	40
+
 /* This file provides several procedures for dealing with errors during
  * the CIF generation process.  Low-level CIF artwork-manipulation
  * procedures call CIFError without knowing what cell CIF is being
@@ -74,7 +141,13 @@ static int cifTotalHierRects = 0;
  */
 
 global CellDef *CIFErrorDef;	/* Definition in which to record errors. */
-global int CIFErrorLayer;	/* Index of CIF layer associated with errors.*/
+global THREAD_LOCAL int CIFErrorLayer;	/* Index of CIF layer associated
+					 * with errors.
+					 */
+global THREAD_LOCAL CIFQueuedError **CIFErrorQueue = NULL;
+					/* If non-NULL, CIFError adds to this
+					 * list instead of reporting at once.
+					 */
 
 
 /*
@@ -97,6 +170,8 @@ global int CIFErrorLayer;	/* Index of CIF layer associated with errors.*/
 void
 CIFPrintStats(void)
 {
+    int i;
+
     TxPrintf("CIF statistics (recent/total):\n");
     cifTotalTileOps += CIFTileOps;
     TxPrintf("    Geometrical tile operations: %d/%d\n",
@@ -114,6 +189,387 @@ CIFPrintStats(void)
     TxPrintf("    CIF rectangles due to hierarchical interactions: %d/%d\n",
 	CIFHierRects, cifTotalHierRects);
     CIFHierRects = 0;
+
+    for (i = 0; i < MAXCIFLAYERS; i++)
+	if (cifLayerCount[i] > 0) break;
+    if (i < MAXCIFLAYERS)
+    {
+	TxPrintf("    Layer generation (recent):\n");
+	TxPrintf("        %-20s %8s %6s %8s %10s\n", "layer", "times",
+		"par", "ms", "tile ops");
+	for (i = 0; i < MAXCIFLAYERS; i++)
+	{
+	    if (cifLayerCount[i] == 0) continue;
+	    TxPrintf("        %-20s %8d %6d %8.1f %10d\n",
+		(CIFCurStyle && (i < CIFCurStyle->cs_nLayers)) ?
+		CIFCurStyle->cs_layers[i]->cl_name : "?",
+		cifLayerCount[i], cifLayerParallel[i],
+		cifLayerTime[i] * 1000.0, cifLayerTileOps[i]);
+	    cifLayerCount[i] = cifLayerParallel[i] = cifLayerTileOps[i] = 0;
+	    cifLayerTime[i] = 0.0;
+	}
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFLayerStatsAdd --
+ *
+ *	Record the time taken, and the tiles touched, in generating
+ *	one CIF layer.  Called by CIFGen on the main thread only.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the per-layer statistics printed by CIFPrintStats.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFLayerStatsAdd(
+    int layer,			/* Index of CIF layer */
+    double seconds,		/* Wall clock time spent on the layer */
+    int tileops,		/* Tile operations for the layer */
+    bool parallel)		/* TRUE if generated concurrently */
+{
+    cifLayerTime[layer] += seconds;
+    cifLayerTileOps[layer] += tileops;
+    cifLayerCount[layer]++;
+    if (parallel) cifLayerParallel[layer]++;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFOpStatsClear --
+ *
+ *	Discard all of the per-operation profile records.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFOpStatsClear(void)
+{
+    HashSearch hs;
+    HashEntry *he;
+    CIFOpStat *cos;
+
+    if (cifOpCount < 0) return;
+    HashStartSearch(&hs);
+    while ((he = HashNext(&cifOpTable, &hs)) != NULL)
+    {
+	cos = (CIFOpStat *) HashGetValue(he);
+	if (cos == NULL) continue;
+	freeMagic(cos->cos_cell);
+	freeMagic(cos->cos_layer);
+	freeMagic((char *) cos);
+    }
+    HashKill(&cifOpTable);
+    cifOpCount = -1;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFOpStatsAdd --
+ *
+ *	Record one run of one operation of a CIF layer.  Called from
+ *	CIFGenLayer while CIFProfileOps is TRUE.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Creates or updates the record for (def, hier, layer, op).
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFOpStatsAdd(
+    CellDef *def,		/* Cell being generated */
+    bool hier,			/* TRUE for hierarchical processing */
+    int layer,			/* Index of CIF layer */
+    int op,			/* Position of the op in the layer */
+    int opcode,			/* CIFOP_* */
+    int tilesIn,		/* Tiles visited by the op */
+    int tilesOut,		/* Tiles in the result of the op */
+    double seconds)		/* Wall clock time taken by the op */
+{
+    CIFOpKey key;
+    CIFOpStat *cos;
+    HashEntry *he;
+
+    if (cifOpCount < 0)
+    {
+	HashInit(&cifOpTable, 256, HashSize(sizeof (CIFOpKey)));
+	cifOpCount = 0;
+    }
+
+    /* Zero the whole key, since it is hashed as raw words */
+    bzero((char *) &key, sizeof key);
+    key.cok_def = def;
+    key.cok_hier = (hier) ? 1 : 0;
+    key.cok_layer = layer;
+    key.cok_op = op;
+
+    he = HashFind(&cifOpTable, (char *) &key);
+    cos = (CIFOpStat *) HashGetValue(he);
+    if (cos == NULL)
+    {
+	cos = (CIFOpStat *) mallocMagic(sizeof (CIFOpStat));
+	bzero((char *) cos, sizeof (CIFOpStat));
+	cos->cos_cell = StrDup((char **) NULL, def->cd_name);
+	cos->cos_layer = StrDup((char **) NULL,
+		(CIFCurStyle && (layer < CIFCurStyle->cs_nLayers)) ?
+		CIFCurStyle->cs_layers[layer]->cl_name : "?");
+	cos->cos_hier = key.cok_hier;
+	cos->cos_op = op;
+	cos->cos_opcode = opcode;
+	HashSetValue(he, (ClientData) cos);
+	cifOpCount++;
+    }
+    cos->cos_calls++;
+    cos->cos_tilesIn += tilesIn;
+    cos->cos_tilesOut += tilesOut;
+    cos->cos_time += seconds;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifOpStatsSorted --
+ *
+ *	Collect the per-operation records into an array, slowest first.
+ *
+ * Results:
+ *	A malloc'ed array of cifOpCount record pointers, to be freed by
+ *	the caller, or NULL if there are no records.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+cifOpStatCompare(
+    const void *a,
+    const void *b)
+{
+    const CIFOpStat *ca = *(const CIFOpStat * const *) a;
+    const CIFOpStat *cb = *(const CIFOpStat * const *) b;
+
+    if (ca->cos_time > cb->cos_time) return -1;
+    if (ca->cos_time < cb->cos_time) return 1;
+    if (ca->cos_tilesIn > cb->cos_tilesIn) return -1;
+    if (ca->cos_tilesIn < cb->cos_tilesIn) return 1;
+    return 0;
+}
+
+CIFOpStat **
+cifOpStatsSorted(void)
+{
+    CIFOpStat **list;
+    HashSearch hs;
+    HashEntry *he;
+    int n = 0;
+
+    if (cifOpCount <= 0) return (CIFOpStat **) NULL;
+    list = (CIFOpStat **) mallocMagic(cifOpCount * sizeof (CIFOpStat *));
+    HashStartSearch(&hs);
+    while ((he = HashNext(&cifOpTable, &hs)) != NULL)
+	if (HashGetValue(he) != NULL)
+	    list[n++] = (CIFOpStat *) HashGetValue(he);
+    qsort(list, n, sizeof (CIFOpStat *), cifOpStatCompare);
+    return list;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFPrintOpStats --
+ *
+ *	Print the per-operation profile: first a summary by kind of
+ *	operation, then the slowest operations of individual layers,
+ *	broken down by cell and by level (paint or hierarchical).
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Several messages are printed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFPrintOpStats(void)
+{
+    CIFOpStat **list, *cos;
+    double opTime[CIFOP_TAGGED + 1], total = 0.0;
+    dlong opIn[CIFOP_TAGGED + 1], opOut[CIFOP_TAGGED + 1];
+    int opCalls[CIFOP_TAGGED + 1];
+    int i, op, best;
+
+    list = cifOpStatsSorted();
+    if (list == NULL)
+    {
+	TxPrintf("No CIF operations have been profiled%s.\n",
+		(CIFProfileOps) ? "" : " (use \"cif statistics -ops on\")");
+	return;
+    }
+
+    bzero((char *) opTime, sizeof opTime);
+    bzero((char *) opIn, sizeof opIn);
+    bzero((char *) opOut, sizeof opOut);
+    bzero((char *) opCalls, sizeof opCalls);
+    for (i = 0; i < cifOpCount; i++)
+    {
+	cos = list[i];
+	op = (cos->cos_opcode > 0 && cos->cos_opcode <= CIFOP_TAGGED) ?
+		cos->cos_opcode : 0;
+	opTime[op] += cos->cos_time;
+	opIn[op] += cos->cos_tilesIn;
+	opOut[op] += cos->cos_tilesOut;
+	opCalls[op] += cos->cos_calls;
+	total += cos->cos_time;
+    }
+
+    /* Summary by operation, slowest first (selection sort; the
+     * number of distinct operations is small).
+     */
+    TxPrintf("CIF operations by kind:\n");
+    TxPrintf("    %-14s %8s %12s %12s %10s %6s\n", "op", "calls",
+		"tiles in", "tiles out", "ms", "%");
+    while (TRUE)
+    {
+	best = -1;
+	for (op = 0; op <= CIFOP_TAGGED; op++)
+	    if (opCalls[op] > 0 && (best < 0 || opTime[op] > opTime[best]))
+		best = op;
+	if (best < 0) break;
+	TxPrintf("    %-14s %8d %12"DLONG_PREFIX"d %12"DLONG_PREFIX"d "
+		"%10.1f %6.1f\n", cifOpNames[best], opCalls[best],
+		opIn[best], opOut[best], opTime[best] * 1000.0,
+		(total > 0.0) ? opTime[best] * 100.0 / total : 0.0);
+	opCalls[best] = 0;
+    }
+
+    TxPrintf("CIF operations by cell and layer (slowest %d of %d):\n",
+		MIN(cifOpCount, CIF_OPSTAT_ROWS), cifOpCount);
+    TxPrintf("    %-20s %-5s %-16s %3s %-14s %7s %11s %11s %9s\n",
+		"cell", "level", "layer", "#", "op", "calls", "tiles in",
+		"tiles out", "ms");
+    for (i = 0; i < cifOpCount && i < CIF_OPSTAT_ROWS; i++)
+    {
+	cos = list[i];
+	TxPrintf("    %-20s %-5s %-16s %3d %-14s %7d %11"DLONG_PREFIX"d "
+		"%11"DLONG_PREFIX"d %9.1f\n", cos->cos_cell,
+		(cos->cos_hier) ? "hier" : "paint", cos->cos_layer,
+		cos->cos_op, CIFOP_NAME(cos->cos_opcode), cos->cos_calls,
+		cos->cos_tilesIn, cos->cos_tilesOut, cos->cos_time * 1000.0);
+    }
+    TxPrintf("    Total time in CIF operations: %.1f ms\n", total * 1000.0);
+    freeMagic((char *) list);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * cifJSONString --
+ *
+ *	Write the string 's' to 'f' as a quoted JSON string.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the FILE 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+cifJSONString(
+    FILE *f,
+    const char *s)
+{
+    putc('"', f);
+    for (; *s; s++)
+    {
+	if (*s == '"' || *s == '\\')
+	    fprintf(f, "\\%c", *s);
+	else if ((unsigned char)*s < 0x20)
+	    fprintf(f, "\\u%04x", (unsigned char)*s);
+	else
+	    putc(*s, f);
+    }
+    putc('"', f);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFWriteOpStatsJSON --
+ *
+ *	Write the per-operation profile to 'f' as a single JSON object:
+ *
+ *	{ "version": ..., "style": ...,
+ *	  "ops": [ { "cell": ..., "level": "paint"|"hier", "layer": ...,
+ *		     "index": n, "op": ..., "calls": n, "tiles_in": n,
+ *		     "tiles_out": n, "seconds": x }, ... ] }
+ *
+ *	Records are listed slowest first.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the FILE 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFWriteOpStatsJSON(
+    FILE *f)
+{
+    CIFOpStat **list, *cos;
+    int i;
+
+    list = cifOpStatsSorted();
+
+    fprintf(f, "{\n  \"version\": \"%s.%s\",\n", MagicVersion, MagicRevision);
+    fprintf(f, "  \"style\": ");
+    cifJSONString(f, (CIFCurStyle) ? CIFCurStyle->cs_name : "");
+    fprintf(f, ",\n  \"ops\": [");
+    for (i = 0; list && i < cifOpCount; i++)
+    {
+	cos = list[i];
+	fprintf(f, "%s\n    {\"cell\": ", (i == 0) ? "" : ",");
+	cifJSONString(f, cos->cos_cell);
+	fprintf(f, ", \"level\": \"%s\", \"layer\": ",
+		(cos->cos_hier) ? "hier" : "paint");
+	cifJSONString(f, cos->cos_layer);
+	fprintf(f, ", \"index\": %d, \"op\": \"%s\", \"calls\": %d, "
+		"\"tiles_in\": %"DLONG_PREFIX"d, \"tiles_out\": %"DLONG_PREFIX"d, "
+		"\"seconds\": %.6f}", cos->cos_op, CIFOP_NAME(cos->cos_opcode),
+		cos->cos_calls, cos->cos_tilesIn, cos->cos_tilesOut,
+		cos->cos_time);
+    }
+    fprintf(f, "\n  ]\n}\n");
+    if (list) freeMagic((char *) list);
 }
 
 /*
@@ -421,9 +877,21 @@ CIFError(
     char *message)		/* Short note about what went wrong. */
 {
     char msg[200];
+    CIFQueuedError *cqe;
 
     if (CIFCurStyle->cs_flags & CWF_NO_ERRORS) return;
 
+    if (CIFErrorQueue != NULL)
+    {
+	cqe = (CIFQueuedError *)mallocMagic(sizeof(CIFQueuedError));
+	cqe->cqe_area = *area;
+	cqe->cqe_message = StrDup((char **)NULL, message);
+	cqe->cqe_layer = CIFErrorLayer;
+	cqe->cqe_next = *CIFErrorQueue;
+	*CIFErrorQueue = cqe;
+	return;
+    }
+
     if (CIFErrorDef == (NULL)) return;
     (void) sprintf(msg, "CIF error in cell %s, layer %s: %s",
 	CIFErrorDef->cd_name, CIFCurStyle->cs_layers[CIFErrorLayer]->cl_name,
@@ -432,6 +900,49 @@ CIFError(
 	STYLE_PALEHIGHLIGHTS);
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CIFErrorReplay --
+ *
+ *	Report the errors queued by CIFError while CIFErrorQueue was
+ *	set, in the order in which they occurred and against the layers
+ *	they were found on, and free the list.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Feedback information is added, as for CIFError.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+CIFErrorReplay(
+    CIFQueuedError *list)	/* Errors, most recent first */
+{
+    CIFQueuedError *cqe, *next, *rev = NULL;
+
+    /* Reverse the list to get the errors in order of occurrence */
+    while (list != NULL)
+    {
+	cqe = list;
+	list = cqe->cqe_next;
+	cqe->cqe_next = rev;
+	rev = cqe;
+    }
+
+    for (cqe = rev; cqe != NULL; cqe = next)
+    {
+	next = cqe->cqe_next;
+	CIFErrorLayer = cqe->cqe_layer;
+	CIFError(&cqe->cqe_area, cqe->cqe_message);
+	freeMagic(cqe->cqe_message);
+	freeMagic((char *)cqe);
+    }
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
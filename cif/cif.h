@@ -48,6 +48,8 @@ extern bool CIFArrayWriteDisable;
 extern bool CIFHierWriteDisable;
 extern bool CIFSubcellPolygons;
 extern bool CIFUnfracture;
+extern int  CIFGenThreads;
+extern bool CIFProfileOps;
 
 /* Procedures that parse the cif sections of a technology file. */
 
@@ -75,6 +77,9 @@ extern void CIFSeeLayer(CellDef *rootDef, Rect *area, char *layer);
 extern void CIFPaintLayer(CellDef *rootDef, Rect *area, char *cifLayer, int magicLayer, CellDef *paintDef);
 extern void CIFSeeHierLayer(CellDef *rootDef, Rect *area, char *layer, int arrays, int subcells);
 extern void CIFPrintStats(void);
+extern void CIFPrintOpStats(void);
+extern void CIFWriteOpStatsJSON(FILE *f);
+extern void CIFOpStatsClear(void);
 
 extern bool CIFWrite(CellDef *rootDef, FILE *f);
 extern void CIFReadFile(FILE *file);
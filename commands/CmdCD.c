@@ -50,6 +50,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include "select/select.h"
 #include "utils/signals.h"
 #include "utils/malloc.h"
+#include "utils/workers.h"
 #include "cif/CIFint.h"
 #include "cif/CIFread.h"
 #include "calma/calmaInt.h"
@@ -124,6 +125,8 @@ bool cmdDumpParseArgs(char *cmdName, MagWindow *w, TxCommand *cmd, CellUse *dumm
 #define CALMA_PATHS	26
 #define CALMA_UNDEFINED	27
 #define CALMA_UNIQUE	28
+#define CALMA_AUTOARRAY	29
+#define CALMA_STATS	30
 
 #define CALMA_WARN_HELP CIF_WARN_END	/* undefined by CIF module */
 
@@ -132,9 +135,9 @@ CmdCalma(
     MagWindow *w,
     TxCommand *cmd)
 {
-    int option, ext, value;
+    int option, ext, value, threads = 1;
     const char * const *msg;
-    char *namep, *dotptr;
+    char *namep, *dotptr, *readName;
     char writeMode[3];
     CellDef *rootDef;
     FILETYPE f;
@@ -172,14 +175,15 @@ CmdCalma(
 	"nodatestamp [yes|no]	write a zero value creation date stamp",
 	"noduplicates [yes|no]	do not read cells that exist before reading GDS",
 	"ordering [on|off]	cause cells to be read in post-order",
-	"read file		read Calma GDS-II format from \"file\"\n"
-	"		into edit cell",
+	"read [-threads n] file	read Calma GDS-II format from \"file\"\n"
+	"		into edit cell, converting polygons with n threads",
 	"readonly [yes|no]	set cell as read-only and generate output from GDS file",
 	"rescale [yes|no]	allow or disallow internal grid subdivision",
 	"savepaths [yes|no]	save path centerlines as cell properties",
 	"warning [option]	set warning information level",
-	"write file		output Calma GDS-II format to \"file\"\n"
-	"		for the window's root cell",
+	"write [-threads n] file	output Calma GDS-II format to \"file\"\n"
+	"		for the window's root cell, generating cells (and\n"
+	"		compressing output) with n threads",
 	"polygon subcells [yes|no]\n"
 	"		put non-Manhattan polygons into subcells",
 	"path subcells [yes|no]\n"
@@ -187,6 +191,8 @@ CmdCalma(
 	"undefined [allow|disallow]\n"
 	"		[dis]allow writing of GDS with calls to undefined cells",
 	"unique [yes|no]	rename any cells with names duplicated in the GDS",
+	"autoarray [yes|no]	output regular grids of subuses as arrays",
+	"stats [yes|no]		report the amount of GDS read and the read rate",
 	NULL
     };
 
@@ -618,6 +624,26 @@ CmdCalma(
 	    CalmaFlattenArrays = (option < 4) ? FALSE : TRUE;
 	    return;
 
+	case CALMA_AUTOARRAY:
+	    if (cmd->tx_argc == 2)
+	    {
+#ifdef MAGIC_WRAPPER
+		Tcl_SetObjResult(magicinterp, Tcl_NewBooleanObj(CalmaAutoArrays));
+#else
+		TxPrintf("Regular grids of GDS subuses are %soutput as arrays.\n",
+			(CalmaAutoArrays) ?  "" : "not ");
+#endif
+		return;
+	    }
+	    else if (cmd->tx_argc != 3)
+		goto wrongNumArgs;
+
+	    option = Lookup(cmd->tx_argv[2], cmdCalmaYesNo);
+	    if (option < 0)
+		goto wrongNumArgs;
+	    CalmaAutoArrays = (option < 4) ? FALSE : TRUE;
+	    return;
+
 	case CALMA_LOWER:
 	    if (cmd->tx_argc == 2)
 	    {
@@ -801,6 +827,26 @@ CmdCalma(
 	    CalmaUnique = (option < 4) ? FALSE : TRUE;
 	    return;
 
+	case CALMA_STATS:
+	    if (cmd->tx_argc == 2)
+	    {
+#ifdef MAGIC_WRAPPER
+		Tcl_SetObjResult(magicinterp, Tcl_NewBooleanObj(CalmaReadStats));
+#else
+		TxPrintf("GDS input statistics are %sreported.\n",
+			(CalmaReadStats) ?  "" : "not ");
+#endif
+		return;
+	    }
+	    else if (cmd->tx_argc != 3)
+		goto wrongNumArgs;
+
+	    option = Lookup(cmd->tx_argv[2], cmdCalmaYesNo);
+	    if (option < 0)
+		goto wrongNumArgs;
+	    CalmaReadStats = (option < 4) ? FALSE : TRUE;
+	    return;
+
 	case CALMA_NO_STAMP:
 	    /* CALMA_DATESTAMP is the current implementation.		*/
 	    /* CALMA_NO_STAMP is retained for backwards-compatibility.	*/
@@ -1003,18 +1049,33 @@ CmdCalma(
 	    }
 	    return;
 	case CALMA_WRITE:
-	    if (cmd->tx_argc != 3) goto wrongNumArgs;
-	    namep = cmd->tx_argv[2];
+	    if ((cmd->tx_argc == 5) && !strcmp(cmd->tx_argv[2], "-threads"))
+	    {
+		if (!StrIsInt(cmd->tx_argv[3]) || (atoi(cmd->tx_argv[3]) < 0))
+		    goto wrongNumArgs;
+		threads = atoi(cmd->tx_argv[3]);
+		namep = cmd->tx_argv[4];
+	    }
+	    else if (cmd->tx_argc != 3) goto wrongNumArgs;
+	    else namep = cmd->tx_argv[2];
 	    goto outputCalma;
 
 	case CALMA_READ:
-	    if (cmd->tx_argc != 3) goto wrongNumArgs;
+	    if ((cmd->tx_argc == 5) && !strcmp(cmd->tx_argv[2], "-threads"))
+	    {
+		if (!StrIsInt(cmd->tx_argv[3]) || (atoi(cmd->tx_argv[3]) < 0))
+		    goto wrongNumArgs;
+		threads = atoi(cmd->tx_argv[3]);
+		readName = cmd->tx_argv[4];
+	    }
+	    else if (cmd->tx_argc != 3) goto wrongNumArgs;
+	    else readName = cmd->tx_argv[2];
 
 	    /* Check for various common file extensions, including	*/
 	    /* no extension (as-is), ".gds", ".gds2", and ".strm".	*/
 
 	    for (ext = 0; gdsExts[ext] != NULL; ext++)
-		if ((f = PaZOpen(cmd->tx_argv[2], "r", gdsExts[ext], Path,
+		if ((f = PaZOpen(readName, "r", gdsExts[ext], Path,
 		    	(char *) NULL, &namep)) != (FILETYPE)NULL)
 		    break;
 
@@ -1022,7 +1083,7 @@ CmdCalma(
 	    {
 	        TxError("Cannot open %s.gds, %s.strm or %s to read "
 			"GDS-II stream input.\n",
-			cmd->tx_argv[2], cmd->tx_argv[2], cmd->tx_argv[2]);
+			readName, readName, readName);
 	        return;
 	    }
 
@@ -1030,7 +1091,9 @@ CmdCalma(
 	    if (EditCellUse == NULL)
 		DBWloadWindow(w, (char *)NULL, DBW_LOAD_IGNORE_TECH);
 
+	    CalmaReadThreads = threads;
 	    CalmaReadFile(f, namep);
+	    CalmaReadThreads = 1;
 	    (void) FCLOSE(f);
 	    return;
     }
@@ -1045,7 +1108,28 @@ outputCalma:
 
 #ifdef HAVE_ZLIB
     /* Handle compression based on value of CalmaCompression */
-    if (CalmaCompression > 0)
+    if ((CalmaCompression > 0) && (WorkerCount(threads) > 1))
+    {
+	/* Compress blocks of the output concurrently, writing	*/
+	/* the result through an ordinary file.			*/
+
+	fp = PaOpen(namep, "w", (dotptr == NULL) ? ".gds.gz" : "", ".", (char *) NULL, (char **)NULL);
+	if (fp == (FILE *)NULL)
+	{
+	    TxError("Cannot open %s%s to write compressed GDS-II stream output\n", namep,
+			(dotptr == NULL) ? ".gds.gz" : "");
+	    return;
+	}
+	CalmaWriteThreads = threads;
+	if (!CalmaWriteZParallel(rootDef, fp, CalmaCompression))
+	{
+	    TxError("I/O error in writing compressed file %s.\n", namep);
+	    TxError("File may be incompletely written.\n");
+	}
+	CalmaWriteThreads = 1;
+	(void) fclose(fp);
+    }
+    else if (CalmaCompression > 0)
     {
 	sprintf(writeMode, "w%d", CalmaCompression);
 	fz = PaZOpen(namep, writeMode, (dotptr == NULL) ? ".gds.gz" : "", ".", (char *) NULL, (char **)NULL);
@@ -1055,11 +1139,13 @@ outputCalma:
 			(dotptr == NULL) ? ".gds.gz" : "");
 	    return;
 	}
+	CalmaWriteThreads = threads;
 	if (!CalmaWriteZ(rootDef, fz))
 	{
 	    TxError("I/O error in writing compressed file %s.\n", namep);
 	    TxError("File may be incompletely written.\n");
 	}
+	CalmaWriteThreads = 1;
 	(void) gzclose(fz);
     }
     else
@@ -1073,11 +1159,13 @@ outputCalma:
 			(dotptr == NULL) ? ".gds" : "");
 	    return;
 	}
+	CalmaWriteThreads = threads;
 	if (!CalmaWrite(rootDef, fp))
 	{
 	    TxError("I/O error in writing file %s.\n", namep);
 	    TxError("File may be incompletely written.\n");
 	}
+	CalmaWriteThreads = 1;
 	(void) fclose(fp);
 
 #ifdef HAVE_ZLIB
@@ -1737,6 +1825,7 @@ badusage:
 #define CIF_WRITE_FLAT	20
 #define POLYGONS	21
 #define UNFRACTURE	22
+#define CIF_THREADS	23
 
 #define CIF_WARN_HELP  CIF_WARN_END	/* undefined by CIF module */
 
@@ -1786,7 +1875,8 @@ CmdCif(
 	"rescale [yes|no]	allow/disallow rescaling of internal grid",
 	"scale in|out	show microns per internal units for the current style",
 	"see layer		display CIF layer under box",
-	"statistics		print out statistics for CIF generator",
+	"statistics [-ops [on|off|file]]\n"
+	"			print out statistics for CIF generator",
 	"warning [option]	set warning display options",
 	"write file		output CIF for the window's root cell to \"file\"",
 	"flat file		output flattened CIF for "
@@ -1795,6 +1885,7 @@ CmdCif(
 	"			put non-Manhattan polygons in subcells",
 	"unfracture [yes|no]\n"
 	"			optimize non-Manhattan geometry",
+	"threads [n]	generate independent layers with n threads",
 	NULL
     };
 
@@ -1827,7 +1918,7 @@ CmdCif(
     {
 	case HELP: case ISTYLE: case OSTYLE: case PREFIX:
 	case AREALABELS: case WARNING: case CIF_LIMIT:
-	case POLYGONS:
+	case POLYGONS: case CIF_THREADS:
 	   break;
 	default:
 	    windCheckOnlyWindow(&w, DBWclientID);
@@ -1977,6 +2068,26 @@ CmdCif(
 	    }
 	    return;
 
+	case CIF_THREADS:
+	    if (argc == 2)
+	    {
+#ifdef MAGIC_WRAPPER
+		Tcl_SetObjResult(magicinterp, Tcl_NewIntObj(CIFGenThreads));
+#else
+		TxPrintf("CIF layers generated with %d thread%s\n",
+			WorkerCount(CIFGenThreads),
+			(WorkerCount(CIFGenThreads) == 1) ? "" : "s");
+#endif
+		return;
+	    }
+	    else if (argc != 3)
+		goto wrongNumArgs;
+	    else if (!StrIsInt(argv[2]) || (atoi(argv[2]) < 0))
+		goto wrongNumArgs;
+
+	    CIFGenThreads = atoi(argv[2]);
+	    return;
+
 	case AREALABELS:
 	    if (argc > 3) goto wrongNumArgs;
 	    if (argc == 3)
@@ -2186,7 +2297,36 @@ CmdCif(
 	    return;
 
 	case STATS:
-	    CIFPrintStats();
+	    if (argc == 2)
+	    {
+		CIFPrintStats();
+		return;
+	    }
+	    if ((argc > 4) || strcmp(argv[2], "-ops")) goto wrongNumArgs;
+	    if (argc == 3)
+		CIFPrintOpStats();
+	    else if (!strcmp(argv[3], "on"))
+	    {
+		/* Start a new profile */
+		CIFOpStatsClear();
+		CIFProfileOps = TRUE;
+	    }
+	    else if (!strcmp(argv[3], "off"))
+		CIFProfileOps = FALSE;
+	    else
+	    {
+		FILE *pf;
+
+		pf = PaOpen(argv[3], "w", (char *) NULL, ".",
+			(char *) NULL, (char **) NULL);
+		if (pf == NULL)
+		{
+		    TxError("Cannot open file \"%s\" for writing.\n", argv[3]);
+		    return;
+		}
+		CIFWriteOpStatsJSON(pf);
+		(void) fclose(pf);
+	    }
 	    return;
 
 	case WARNING:
@@ -1025,11 +1025,12 @@ cmdExpandFunc(
 #define	EXTNO		6
 #define	EXTPARENTS	7
 #define EXTPATH		8
-#define	EXTSHOWPARENTS	9
-#define EXTSTEPSIZE	10
-#define	EXTSTYLE	11
-#define	EXTUNIQUE	12
-#define	EXTWARN		13
+#define EXTPROFILE	9
+#define	EXTSHOWPARENTS	10
+#define EXTSTEPSIZE	11
+#define	EXTSTYLE	12
+#define	EXTUNIQUE	13
+#define	EXTWARN		14
 
 #define	WARNALL		0
 #define WARNDUP		1
@@ -1049,6 +1050,7 @@ cmdExpandFunc(
 #define	DOALIASES      10
 #define	DOUNIQUE       11
 #define	DOEXTRESIST2   12
+#define	DOPARTIAL      13
 
 #define	LENCLEAR	0
 #define	LENDRIVER	1
@@ -1101,6 +1103,7 @@ CmdExtract(
 	"aliases		output all net name aliases",
 	"unique	 [notopports]	ensure unique node names during extraction",
 	"resistance		extract resistance (same as \"do extresist\")",
+	"partial		re-extract only the changed area of flat cells",
 	NULL
     };
     static const char * const cmdExtLength[] =
@@ -1132,6 +1135,8 @@ CmdExtract(
 	"no [option]		disable extractor option",
 	"parents		extract selected cell and all its parents",
 	"path [path]		if set, extract into the indicated path",
+	"profile [-json] [file]	extract all, reporting time spent per cell\n\
+			and per extraction phase",
 	"showparents		show all parents of selected cell",
 	"stepsize [value]	print or set the extraction step size",
 	"style [stylename]	set current extraction parameter style",
@@ -1224,6 +1229,39 @@ CmdExtract(
 		ExtAll(selectedUse);
 	    return;
 
+	case EXTPROFILE:
+	    {
+		FILE *pf = stdout;
+		bool doJSON = FALSE;
+
+		if (argc > 2 && !strcmp(argv[2], "-json"))
+		{
+		    doJSON = TRUE;
+		    argv++;
+		    argc--;
+		}
+		if (argc > 3) goto wrongNumArgs;
+		if (!strcmp(selectedUse->cu_def->cd_name, UNNAMED))
+		{
+		    TxError("Please name the cell before extracting.\n");
+		    return;
+		}
+		if (argc == 3)
+		{
+		    pf = PaOpen(argv[2], "w", (char *) NULL, ".",
+				(char *) NULL, (char **) NULL);
+		    if (pf == NULL)
+		    {
+			TxError("Cannot open file \"%s\" for writing.\n", argv[2]);
+			return;
+		    }
+		}
+		ExtProfile(selectedUse, pf, doJSON);
+		if (pf != stdout) (void) fclose(pf);
+		else (void) fflush(pf);
+	    }
+	    return;
+
 	case EXTCELL:
 	    if (argc != 3) goto wrongNumArgs;
 	    namep = argv[2];
@@ -1410,6 +1448,7 @@ CmdExtract(
 		TxPrintf("%s unique\n", OPTSET(EXT_DOUNIQUE));
 		TxPrintf("%s unique notopports\n", OPTSET(EXT_DOUNIQNOTOPPORTS));
 		TxPrintf("%s resistance (extresist)\n", OPTSET(EXT_DOEXTRESIST));
+		TxPrintf("%s partial\n", OPTSET(EXT_DOPARTIAL));
 		return;
 #undef	OPTSET
 	    }
@@ -1455,6 +1494,11 @@ CmdExtract(
 		case DOALIASES:		option = EXT_DOALIASES; break;
 		case DOEXTRESIST:
 		case DOEXTRESIST2:	option = EXT_DOEXTRESIST; break;
+		case DOPARTIAL:
+		    /* Discard saved state when partial extraction is off */
+		    if (no) ExtIncrFree((CellDef *) NULL);
+		    option = EXT_DOPARTIAL;
+		    break;
 		case DOUNIQUE:
 		    if (argc == 4)
 		    {
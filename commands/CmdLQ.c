@@ -24,12 +24,14 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/time.h>		/* for gettimeofday() */
 
 #include "tcltk/tclmagic.h"
 #include "utils/magic.h"
 #include "utils/malloc.h"
 #include "utils/geometry.h"
 #include "utils/utils.h"
+#include "utils/magic_zlib.h"
 #include "tiles/tile.h"
 #include "utils/hash.h"
 #include "database/database.h"
@@ -47,6 +49,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include "netmenu/netmenu.h"
 #include "cif/cif.h"
 #include "cif/CIFint.h"
+#include "calma/calma.h"
 
 /* Forward declarations */
 
@@ -3043,6 +3046,202 @@ CmdNetlist(
     }
 }
 
+#ifdef CALMA_MODULE
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * CmdOasis --
+ *
+ * Implement the "oasis" command:  read or write OASIS files.  Layers,
+ * label handling and other options are shared with the "gds" command.
+ *
+ * Usage:
+ *	oasis [write [-compare] [file]]
+ *	oasis read file
+ *	oasis help
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes a file, or reads cells from one.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+#define OASIS_HELP	0
+#define OASIS_READ	1
+#define OASIS_WRITE	2
+
+void
+CmdOasis(
+    MagWindow *w,
+    TxCommand *cmd)
+{
+    int option, ext, argbase;
+    bool compare;
+    const char * const *msg;
+    char *namep, *dotptr;
+    CellDef *rootDef;
+    FILETYPE f;
+    FILE *fp, *gdsfp;
+    struct timeval start, now;
+    double oasSeconds, gdsSeconds;
+    dlong oasBytes, gdsBytes;
+
+    static const char * const oasisExts[] = {".oas", ".oas.gz", ".oasis", "", NULL};
+    static const char * const cmdOasisOption[] =
+    {
+	"help		print this help information",
+	"read file	read OASIS format from \"file\" into edit cell",
+	"write [-compare] [file]\n"
+	"		output OASIS for the window's root cell to \"file\",\n"
+	"		comparing its size and time with GDS output",
+	NULL
+    };
+
+    if (cmd->tx_argc == 1)
+	option = OASIS_WRITE;
+    else
+    {
+	option = Lookup(cmd->tx_argv[1], cmdOasisOption);
+	if (option < 0)
+	{
+	    TxError("\"%s\" isn't a valid oasis option.\n", cmd->tx_argv[1]);
+	    option = OASIS_HELP;
+	}
+    }
+
+    switch (option)
+    {
+	case OASIS_HELP:
+	    TxPrintf("OASIS commands have the form \":oasis option\",");
+	    TxPrintf(" where option is one of:\n");
+	    for (msg = &(cmdOasisOption[0]); *msg != NULL; msg++)
+		TxPrintf("    %s\n", *msg);
+	    TxPrintf("Layers, labels and other settings are those of the");
+	    TxPrintf(" \"gds\" command.\n");
+	    return;
+
+	case OASIS_READ:
+	    if (cmd->tx_argc != 3)
+		goto wrongNumArgs;
+
+	    for (ext = 0; oasisExts[ext] != NULL; ext++)
+		if ((f = PaZOpen(cmd->tx_argv[2], "r", oasisExts[ext], Path,
+			(char *) NULL, &namep)) != (FILETYPE)NULL)
+		    break;
+
+	    if (f == (FILETYPE) NULL)
+	    {
+		TxError("Cannot open %s.oas or %s to read OASIS input.\n",
+			cmd->tx_argv[2], cmd->tx_argv[2]);
+		return;
+	    }
+
+	    /* Ensure that there is a valid edit cell */
+	    if (EditCellUse == NULL)
+		DBWloadWindow(w, (char *)NULL, DBW_LOAD_IGNORE_TECH);
+
+	    OasisReadFile(f, namep);
+	    (void) FCLOSE(f);
+	    return;
+
+	case OASIS_WRITE:
+	    compare = FALSE;
+	    argbase = 2;
+	    if ((cmd->tx_argc > 2) && !strcmp(cmd->tx_argv[2], "-compare"))
+	    {
+		compare = TRUE;
+		argbase = 3;
+	    }
+	    if (cmd->tx_argc > argbase + 1)
+		goto wrongNumArgs;
+
+	    windCheckOnlyWindow(&w, DBWclientID);
+	    if (w == (MagWindow *) NULL)
+	    {
+		TxError("Point to a window first\n");
+		return;
+	    }
+	    rootDef = ((CellUse *) w->w_surfaceID)->cu_def;
+
+	    if (cmd->tx_argc == argbase + 1)
+		namep = cmd->tx_argv[argbase];
+	    else
+	    {
+		namep = strrchr(rootDef->cd_name, '/');
+		if (namep == (char *) NULL)
+		    namep = rootDef->cd_name;
+		else
+		    namep++;
+	    }
+	    dotptr = strrchr(namep, '.');
+
+	    fp = PaOpen(namep, "w", (dotptr == NULL) ? ".oas" : "", ".",
+			(char *) NULL, (char **)NULL);
+	    if (fp == (FILE *)NULL)
+	    {
+		TxError("Cannot open %s%s to write OASIS output\n", namep,
+			(dotptr == NULL) ? ".oas" : "");
+		return;
+	    }
+	    gettimeofday(&start, (struct timezone *)NULL);
+	    if (!OasisWrite(rootDef, fp))
+	    {
+		TxError("I/O error in writing file %s.\n", namep);
+		TxError("File may be incompletely written.\n");
+		compare = FALSE;
+	    }
+	    gettimeofday(&now, (struct timezone *)NULL);
+	    oasSeconds = (double)(now.tv_sec - start.tv_sec)
+			+ (double)(now.tv_usec - start.tv_usec) / 1.0e6;
+	    oasBytes = (dlong)ftello(fp);
+	    (void) fclose(fp);
+
+	    /* Write the same layout as GDS to a scratch file, and	*/
+	    /* compare the two.						*/
+	    if (compare)
+	    {
+		gdsfp = tmpfile();
+		if (gdsfp == (FILE *)NULL)
+		{
+		    TxError("Cannot open a scratch file to compare with GDS.\n");
+		    return;
+		}
+		gettimeofday(&start, (struct timezone *)NULL);
+		if (!CalmaWrite(rootDef, gdsfp))
+		{
+		    TxError("I/O error in writing GDS for comparison.\n");
+		    (void) fclose(gdsfp);
+		    return;
+		}
+		gettimeofday(&now, (struct timezone *)NULL);
+		gdsSeconds = (double)(now.tv_sec - start.tv_sec)
+			+ (double)(now.tv_usec - start.tv_usec) / 1.0e6;
+		gdsBytes = (dlong)ftello(gdsfp);
+		(void) fclose(gdsfp);
+
+		TxPrintf("OASIS:  %.2f MB in %.2f seconds\n",
+			(double)oasBytes / 1.0e6, oasSeconds);
+		TxPrintf("GDS:    %.2f MB in %.2f seconds\n",
+			(double)gdsBytes / 1.0e6, gdsSeconds);
+		if ((oasBytes > 0) && (oasSeconds > 0))
+		    TxPrintf("GDS is %.1f times the size of OASIS and took"
+			" %.1f times as long to write.\n",
+			(double)gdsBytes / (double)oasBytes,
+			gdsSeconds / oasSeconds);
+	    }
+	    return;
+    }
+    return;
+
+wrongNumArgs:
+    TxError("Wrong number of arguments in \"%s\" command.", cmd->tx_argv[0]);
+    TxError("  Try \":%s help\" for help.\n", cmd->tx_argv[0]);
+}
+#endif /* CALMA_MODULE */
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -89,6 +89,7 @@ extern void CmdCif();
 #endif
 #ifdef CALMA_MODULE
 extern void CmdCalma();
+extern void CmdOasis();
 #endif
 
 /*
@@ -518,6 +519,10 @@ DBWInitCommands()
     WindAddCommand(DBWclientID,
 	"gds option		alias for the \"calma\" command",
 	CmdCalma, FALSE);
+    WindAddCommand(DBWclientID,
+	"oasis option		OASIS file processor; type \"oasis help\"\n\
+			for information on options",
+	CmdOasis, FALSE);
 #endif
 
 
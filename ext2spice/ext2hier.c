@@ -22,6 +22,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include <string.h>
 #include <ctype.h>
 #include <math.h>		/* for fabs() */
+#include <unistd.h>		/* for fork(), _exit() */
 
 #ifdef MAGIC_WRAPPER
 #include "tcltk/tclmagic.h"
@@ -44,6 +45,7 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include "extract/extract.h"	/* for extDevTable */
 #include "extflat/EFint.h"
 #include "utils/runstats.h"
+#include "utils/workers.h"
 #include "ext2spice/ext2spice.h"
 
 /* These global values are defined in ext2spice.c */
@@ -57,6 +59,339 @@ typedef struct _defflagsdata {
    int flags;
 } DefFlagsData;
 
+/*
+ * When "-j" asks for more than one job, the subcircuits are written by
+ * forked copies of magic, each into a temporary file of its own, so
+ * that several subcircuits are generated at once.  Each process takes
+ * a batch of consecutive subcircuits:  it is forked just before the
+ * first one is written, and then carries on through the hierarchy
+ * exactly as a single job would, until it has written esHierBatch of
+ * them.  Meanwhile the parent goes over the same subcircuits, doing
+ * only the work that later cells depend on, with its output thrown
+ * away:  it flattens each cell one level, which marks cells without
+ * devices DEF_NODEVICES, and writes the .subckt line, which assigns
+ * port numbers (efnn_port) to unnumbered ports and may rename the def.
+ * Cells calling the subcircuit need all three.  The temporary files are
+ * copied to the output in order, so the netlist is identical to the
+ * one written with a single job.
+ *
+ * This state is recomputed in the parent rather than passed back from
+ * the child because the parent needs it at once:  the next job, which
+ * may write a cell calling this subcircuit, is forked from the parent
+ * straight away, and must inherit it.  Waiting for the child to send
+ * it back would leave only one job running at a time.  Nor can the
+ * child be handed the parent's flattened cell, since it is forked
+ * before the first cell of its batch.  So the flattening is done twice,
+ * and "-j" only pays off where writing the bodies (devices, parasitics
+ * and node capacitances) is a good part of the work;  where a one-level
+ * flatten reaches far down a deep hierarchy, it is most of the work.
+ * Other counters restart at each subcircuit, so only the merged device
+ * count has to come back (see esHierJobWait()).
+ */
+
+typedef struct _eshierjob {
+    FILE	*ehj_file;	/* Text of the subcircuits */
+    FILE	*ehj_out;	/* TxPrintf() output from the job */
+    FILE	*ehj_err;	/* TxError() output from the job */
+    FILE	*ehj_merged;	/* Devices merged in each subcircuit */
+    int		 ehj_pid;	/* Process writing the job, or 0 */
+} EsHierJob;
+
+static EsHierJob *esHierJobs = NULL;	/* Jobs in output order */
+static int esHierNumJobs = 0;		/* Number of jobs created */
+static int esHierMaxJobs = 0;		/* Size of esHierJobs */
+static int esHierNextJob = 0;		/* First job not yet copied out */
+static int esHierRunning = 0;		/* Number of processes running */
+static int esHierParallel = 1;		/* Most processes to run at once */
+static int esHierBatch = 1;		/* Subcircuits written by each job */
+static int esHierBatchCount = 0;	/* Subcircuits in the newest job */
+static bool esHierChild = FALSE;	/* TRUE in a process writing a job */
+static bool esHierQuiet = FALSE;	/* TRUE while discarding output */
+static FILE *esHierOutF = NULL;		/* Where the jobs are copied to */
+static FILE *esHierNullF = NULL;	/* Where the parent's copy goes */
+
+/* Jobs per process allowed at once, so that uneven batches even out */
+#define ESHIER_BATCHES	4
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * esHierJobCopy --
+ *
+ * Copy the contents of a temporary file from the beginning to 'outf',
+ * or, if 'outf' is NULL, to TxPrintf() (if 'err' is FALSE) or
+ * TxError() (if 'err' is TRUE);  then close it.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes output.  Closes (and so deletes) the temporary file.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+esHierJobCopy(
+    FILE *tmpf,
+    FILE *outf,
+    bool err)
+{
+    char buf[8192];
+    size_t n;
+
+    rewind(tmpf);
+    while ((n = fread(buf, 1, (outf) ? sizeof buf : sizeof buf - 1, tmpf)) > 0)
+    {
+	if (outf)
+	    fwrite(buf, 1, n, outf);
+	else
+	{
+	    buf[n] = '\0';
+	    if (err)
+		TxError("%s", buf);
+	    else
+		TxPrintf("%s", buf);
+	}
+    }
+    fclose(tmpf);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * esHierJobWait --
+ *
+ * Wait for the process writing job number 'n', if any, to finish,
+ * then copy out every finished job that is next in output order.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to esHierOutF.  Adds the devices merged by each job to
+ *	esSpiceDevsMerged, and reports the total as each subcircuit
+ *	would have.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+esHierJobWait(
+    int n)
+{
+    EsHierJob *job = &esHierJobs[n];
+    int status, merged;
+
+    /* Messages here are the parent's own, even while it is quiet */
+    TxDivert((FILE *)NULL, (FILE *)NULL);
+
+    if (job->ehj_pid > 0)
+    {
+	if ((WaitPid(job->ehj_pid, &status) < 0) || (status != 0))
+	    TxError("Error writing subcircuit (job %d) in a child process.\n", n);
+	job->ehj_pid = 0;
+	esHierRunning--;
+    }
+
+    while ((esHierNextJob < esHierNumJobs) &&
+		(esHierJobs[esHierNextJob].ehj_pid == 0))
+    {
+	job = &esHierJobs[esHierNextJob++];
+	esHierJobCopy(job->ehj_file, esHierOutF, FALSE);
+	esHierJobCopy(job->ehj_out, (FILE *)NULL, FALSE);
+	rewind(job->ehj_merged);
+	while (fscanf(job->ehj_merged, "%d", &merged) == 1)
+	{
+	    esSpiceDevsMerged += merged;
+	    TxPrintf("Devs merged: %d\n", esSpiceDevsMerged);
+	}
+	fclose(job->ehj_merged);
+	esHierJobCopy(job->ehj_err, (FILE *)NULL, TRUE);
+    }
+
+    if (esHierQuiet) TxDivert(esHierNullF, esHierNullF);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * esHierJobExit --
+ *
+ * Called in a child process when it has written its batch of
+ * subcircuits, or has reached the end of the hierarchy.
+ *
+ * Results:
+ *	None.  Does not return.
+ *
+ * Side effects:
+ *	Flushes the job's files and exits.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+esHierJobExit(void)
+{
+    EsHierJob *job = &esHierJobs[esHierNumJobs - 1];
+    int status = 0;
+
+    if (fflush(job->ehj_file) != 0) status = 1;
+    if (fflush(job->ehj_merged) != 0) status = 1;
+    fflush(job->ehj_out);
+    fflush(job->ehj_err);
+    _exit(status);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * esHierJobNew --
+ *
+ * Called when a subcircuit is about to be written.  Add it to the
+ * newest job if that one is still taking subcircuits;  otherwise
+ * start a new job and fork a process to write it, first waiting for
+ * a running job to finish if there are already as many as allowed.
+ *
+ * Results:
+ *	Pointer to the job writing the subcircuit, or NULL if running a
+ *	single job or if no job could be started, in which case the
+ *	caller writes the subcircuit straight to the output.  In the
+ *	child, the caller writes all of the subcircuit;  in the parent,
+ *	it writes only the .subckt line, which is thrown away.
+ *
+ * Side effects:
+ *	Creates temporary files and forks.  Sets esSpiceF.  In the
+ *	child, TxPrintf() and TxError() output is diverted into the
+ *	job's temporary files;  in the parent, it is thrown away until
+ *	the batch is complete (see esHierVisit()).
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static EsHierJob *
+esHierJobNew(void)
+{
+    EsHierJob *job;
+    FILE *f, *fo, *fe, *fm;
+    int n, pid;
+
+    if (esHierParallel <= 1) return NULL;
+
+    if (esHierChild || (esHierBatchCount < esHierBatch))
+    {
+	job = &esHierJobs[esHierNumJobs - 1];
+	esHierBatchCount++;
+	esSpiceF = (esHierChild) ? job->ehj_file : esHierNullF;
+	return job;
+    }
+
+    f = tmpfile();
+    fo = (f) ? tmpfile() : NULL;
+    fe = (fo) ? tmpfile() : NULL;
+    fm = (fe) ? tmpfile() : NULL;
+    if (fm == NULL)
+    {
+	if (f) fclose(f);
+	if (fo) fclose(fo);
+	if (fe) fclose(fe);
+	goto serial;
+    }
+
+    if (esHierNumJobs == esHierMaxJobs)
+    {
+	EsHierJob *newjobs;
+
+	esHierMaxJobs = (esHierMaxJobs == 0) ? 32 : esHierMaxJobs * 2;
+	newjobs = (EsHierJob *)mallocMagic(esHierMaxJobs * sizeof(EsHierJob));
+	if (esHierJobs != NULL)
+	{
+	    memcpy(newjobs, esHierJobs, esHierNumJobs * sizeof(EsHierJob));
+	    freeMagic(esHierJobs);
+	}
+	esHierJobs = newjobs;
+    }
+
+    if (esHierRunning >= esHierParallel)
+    {
+	for (n = esHierNextJob; n < esHierNumJobs; n++)
+	    if (esHierJobs[n].ehj_pid > 0)
+		break;
+	esHierJobWait(n);
+    }
+
+    job = &esHierJobs[esHierNumJobs];
+    job->ehj_file = f;
+    job->ehj_out = fo;
+    job->ehj_err = fe;
+    job->ehj_merged = fm;
+    job->ehj_pid = 0;
+
+    TxFlush();
+    FORK_f(pid);
+    if (pid < 0)
+    {
+	fclose(f);
+	fclose(fo);
+	fclose(fe);
+	fclose(fm);
+	goto serial;
+    }
+
+    esHierNumJobs++;
+    esHierBatchCount = 1;
+    if (pid == 0)
+    {
+	esHierChild = TRUE;
+	esHierQuiet = FALSE;
+	TxDivert(fo, fe);
+	esSpiceF = f;
+	return job;
+    }
+    job->ehj_pid = pid;
+    esHierRunning++;
+    esHierQuiet = TRUE;
+    TxDivert(esHierNullF, esHierNullF);
+    esSpiceF = esHierNullF;
+    return job;
+
+serial:
+    /* Finish all jobs so that output can go straight to the file */
+    while (esHierNextJob < esHierNumJobs)
+	esHierJobWait(esHierNextJob);
+    esHierParallel = 1;
+    esHierQuiet = FALSE;
+    TxDivert((FILE *)NULL, (FILE *)NULL);
+    esSpiceF = esHierOutF;
+    return NULL;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * esHierCountDefs --
+ *
+ * Callback for EFHierSrDefs() that counts the cell definitions in
+ * the hierarchy, to size the batches of subcircuits given to each job.
+ *
+ * Results:
+ *	Returns 0 to keep the search going.
+ *
+ * Side effects:
+ *	Increments the int pointed to by 'cdata'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static int
+esHierCountDefs(
+    HierContext *hc,		/* UNUSED */
+    ClientData cdata)
+{
+    (*(int *)CD2PTR(cdata))++;
+    return 0;
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -77,6 +412,7 @@ ESGenerateHierarchy(
     Use u;
     HierContext hc;
     DefFlagsData dfd;
+    int ndefs;
 
     u.use_def = efDefLook(inName);
     hc.hc_use = &u;
@@ -87,10 +423,41 @@ ESGenerateHierarchy(
     EFHierSrDefs(&hc, esMakePorts, NULL);
     EFHierSrDefs(&hc, NULL, NULL);	/* Clear processed */
 
+    /* Number of subcircuits to write at once (see esHierJobNew()) */
+    esHierParallel = WorkerCount(EFThreads);
+    esHierOutF = esSpiceF;
+    if (esHierParallel > 1)
+    {
+	esHierNullF = fopen("/dev/null", "w");
+	if (esHierNullF == NULL) esHierParallel = 1;
+    }
+    if (esHierParallel > 1)
+    {
+	ndefs = 0;
+	EFHierSrDefs(&hc, esHierCountDefs, PTR2CD(&ndefs));
+	EFHierSrDefs(&hc, NULL, NULL);	/* Clear processed */
+	esHierBatch = ndefs / (esHierParallel * ESHIER_BATCHES);
+	if (esHierBatch < 1) esHierBatch = 1;
+	esHierBatchCount = esHierBatch;	/* No job taking subcircuits yet */
+    }
+
     dfd.def = u.use_def;
     dfd.flags = flags;
     EFHierSrDefs(&hc, esHierVisit, (ClientData)(&dfd));
+    if (esHierChild) esHierJobExit();
     EFHierSrDefs(&hc, NULL, NULL);	/* Clear processed */
+    esHierQuiet = FALSE;
+    TxDivert((FILE *)NULL, (FILE *)NULL);
+
+    /* Collect the output of any jobs still running */
+    while (esHierNextJob < esHierNumJobs)
+	esHierJobWait(esHierNextJob);
+    if (esHierJobs != NULL) freeMagic(esHierJobs);
+    esHierJobs = NULL;
+    esHierNumJobs = esHierMaxJobs = esHierNextJob = esHierRunning = 0;
+    if (esHierNullF != NULL) fclose(esHierNullF);
+    esHierNullF = NULL;
+    esSpiceF = esHierOutF;
 
     return;
 }
@@ -1363,6 +1730,7 @@ spcdevHierMergeVisit(
     int pmode, l, w;
     devMerge *fp;
     const devMerge *cfp;
+    HashEntry *he;
     float m;
 
     /* If no terminals, or only a gate, can't do much of anything */
@@ -1383,7 +1751,9 @@ spcdevHierMergeVisit(
     fp = mkDevMerge((float)((float)l * scale), (float)((float)w * scale),
 		gnode, snode, dnode, subnode, hc->hc_hierName, dev);
 
-    for (cfp = devMergeList; cfp != NULL; cfp = cfp->next)
+    he = devMergeFind(fp);
+    cfp = (he == NULL) ? NULL : (const devMerge *)HashGetValue(he);
+    for (; cfp != NULL; cfp = cfp->hnext)
     {
 	if ((pmode = parallelDevs(fp, cfp)) != NOT_PARALLEL)
 	{
@@ -1443,8 +1813,7 @@ spcdevHierMergeVisit(
     }
 
     /* No devices are parallel to this one (yet) */
-    fp->next = devMergeList;
-    devMergeList = fp;
+    devMergeAdd(fp, he);
     return 0;
 }
 
@@ -1778,6 +2147,7 @@ devMergeHierVisit(
     bool     hS, hD, chS, chD;
     devMerge *fp;
     const devMerge *cfp;
+    HashEntry *he;
     float m;
 
     if (esDistrJunct)
@@ -1814,7 +2184,8 @@ devMergeHierVisit(
     hD = extHierSDAttr(drain);
 
     /*
-     * run the list of devs. compare the current one with
+     * run the list of devs that could be parallel to this one (those
+     * in the same devMergeTable bucket). compare the current one with
      * each one in the list. if they fullfill the matching requirements
      * merge them only if:
      * 1) they have both apf S, D attributes
@@ -1824,7 +2195,9 @@ devMergeHierVisit(
      * If one of them has apf and the other aph print a warning.
      */
 
-    for (cfp = devMergeList; cfp != NULL; cfp = cfp->next)
+    he = devMergeFind(fp);
+    cfp = (he == NULL) ? NULL : (const devMerge *)HashGetValue(he);
+    for (; cfp != NULL; cfp = cfp->hnext)
     {
 	if ((pmode = parallelDevs(fp, cfp)) != NOT_PARALLEL)
 	{
@@ -1910,8 +2283,7 @@ mergeThem:
     }
 
     /* No parallel devs to it yet */
-    fp->next = devMergeList;
-    devMergeList = fp;
+    devMergeAdd(fp, he);
     return 0;
 }
 
@@ -2304,11 +2676,27 @@ esHierVisit(
     int flags;
     int locDoSubckt = esDoSubckt;
     bool doStub;
+    EsHierJob *job;
 
     dfd = (DefFlagsData *)cdata;
     topdef = dfd->def;
     flags = dfd->flags;
 
+    /* A child process stops once it has written its batch, and the	*/
+    /* parent keeps quiet until then, since the child repeats all of	*/
+    /* its messages (see esHierJobNew()).				*/
+
+    if (esHierParallel > 1)
+    {
+	if (esHierChild && (esHierBatchCount == esHierBatch))
+	    esHierJobExit();
+	esHierQuiet = (!esHierChild && (esHierBatchCount < esHierBatch));
+	if (esHierQuiet)
+	    TxDivert(esHierNullF, esHierNullF);
+	else if (!esHierChild)
+	    TxDivert((FILE *)NULL, (FILE *)NULL);
+    }
+
     /* Cells which are marked as "primitive" get no output at all */
     if (def->def_flags & DEF_PRIMITIVE) return 0;
 
@@ -2363,7 +2751,11 @@ esHierVisit(
 	EFFlatDone(esFreeNodeClient);
 	return 0;
     }
-    else if (doStub)
+
+    /* Output goes to a job's temporary file if using more than one job */
+    job = esHierJobNew();
+
+    if (doStub)
 	fprintf(esSpiceF, "* Black-box entry subcircuit for %s abstract view\n",
 		def->def_name);
 
@@ -2391,6 +2783,10 @@ esHierVisit(
     else
 	fprintf(esSpiceF, "\n* Top level circuit %s\n\n", topdef->def_name);
 
+    /* The rest is written by the child process only */
+    if ((job != NULL) && !esHierChild)
+	goto done;
+
     if (!doStub)	/* By definition, stubs have no internal components */
     {
 	/* Output subcircuit calls */
@@ -2401,14 +2797,27 @@ esHierVisit(
 	{
 	    const devMerge *p;
 
-	    EFHierVisitDevs(hcf, spcdevHierMergeVisit, (ClientData)NULL);
-	    TxPrintf("Devs merged: %d\n", esSpiceDevsMerged);
+	    HashInit(&devMergeTable, DEVMERGE_HASHSIZE,
+			HashSize(sizeof (devMergeKey)));
+	    if (job != NULL)
+	    {
+		/* The parent adds these up (see esHierJobWait()) */
+		esSpiceDevsMerged = 0;
+		EFHierVisitDevs(hcf, spcdevHierMergeVisit, (ClientData)NULL);
+		fprintf(job->ehj_merged, "%d\n", esSpiceDevsMerged);
+	    }
+	    else
+	    {
+		EFHierVisitDevs(hcf, spcdevHierMergeVisit, (ClientData)NULL);
+		TxPrintf("Devs merged: %d\n", esSpiceDevsMerged);
+	    }
 	    esFMIndex = 0;
 	    free_magic1_t mm1 = freeMagic1_init();
 	    for (p = devMergeList; p != NULL; p = p->next)
 		freeMagic1(&mm1, (char *)p);
 	    freeMagic1_end(&mm1);
 	    devMergeList = NULL;
+	    HashKill(&devMergeTable);
 	}
 	else if (esDistrJunct)
 	    EFHierVisitDevs(hcf, devDistJunctHierVisit, PTR2CD(NULL));
@@ -2444,6 +2853,9 @@ esHierVisit(
     else
 	fprintf(esSpiceF, ".end\n\n");
 
+done:
+    if ((job != NULL) && !esHierChild) esSpiceF = esHierOutF;
+
     /* Reset device/node/subcircuit instance counts */
 
     esCapNum  = 0;
@@ -0,0 +1,785 @@
+/*
+ * ext2spef.c --
+ *
+ * Write the parasitics of a flattened circuit in SPEF (IEEE 1481)
+ * or DSPF format, for use by static timing and signal integrity
+ * tools.  This is selected by "ext2spice format spef" or "ext2spice
+ * format dspf", and is driven entirely by the extflat visitors
+ * EFVisitNodes(), EFVisitResists() and EFVisitCaps():  no device
+ * netlist is written.
+ *
+ * Flat nodes that are joined by resistors (as produced by "extresist")
+ * form a single net.  The net takes the best name of its nodes, with
+ * top-level ports taking precedence, and the remaining nodes become
+ * the net's internal nodes "net:1", "net:2", and so on.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#ifdef MAGIC_WRAPPER
+#include "tcltk/tclmagic.h"
+#endif
+
+#include "utils/magic.h"
+#include "utils/malloc.h"
+#include "utils/geometry.h"
+#include "utils/hash.h"
+#include "utils/utils.h"
+#include "tiles/tile.h"
+#include "database/database.h"
+#include "windows/windows.h"
+#include "textio/textio.h"
+#include "textio/txcommands.h"
+#include "extflat/extflat.h"
+#include "extflat/EFint.h"
+#include "ext2spice/ext2spice.h"
+
+/* One entry per flat node */
+
+typedef struct spefnode
+{
+    struct spefnode *sn_parent;	/* Union-find link toward the net's node */
+    EFNode	    *sn_node;	/* The flat node itself */
+    int		     sn_net;	/* Net number (1..n), set on all nodes */
+    int		     sn_sub;	/* 0 for the net's own node, otherwise the
+				 * internal node number within the net;
+				 * on the net's node, the number of
+				 * internal nodes handed out so far.
+				 */
+} SpefNode;
+
+/* One parasitic element:  a resistor, or a capacitor to ground
+ * (se_n2 == NULL) or between two nodes.
+ */
+
+typedef struct
+{
+    SpefNode	*se_n1;
+    SpefNode	*se_n2;
+    double	 se_value;	/* In femtofarads or ohms */
+} SpefElem;
+
+typedef struct
+{
+    SpefElem	*sl_elems;
+    int		 sl_num;
+    int		 sl_size;
+} SpefList;
+
+static SpefNode *spefNodes;	/* Array of all flat nodes */
+static int	 spefNumNodes;
+static SpefList	 spefCaps;	/* Ground and coupling capacitors */
+static SpefList	 spefRes;	/* Resistors */
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefListAdd --
+ *
+ * Append an element to a growable list of parasitics.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May reallocate list->sl_elems.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+spefListAdd(
+    SpefList *list,
+    SpefNode *n1,
+    SpefNode *n2,
+    double value)
+{
+    SpefElem *new;
+
+    if (list->sl_num == list->sl_size)
+    {
+	list->sl_size = (list->sl_size == 0) ? 256 : list->sl_size * 2;
+	new = (SpefElem *) mallocMagic(list->sl_size * sizeof (SpefElem));
+	if (list->sl_num > 0)
+	{
+	    memcpy(new, list->sl_elems, list->sl_num * sizeof (SpefElem));
+	    freeMagic((char *) list->sl_elems);
+	}
+	list->sl_elems = new;
+    }
+    new = &list->sl_elems[list->sl_num++];
+    new->se_n1 = n1;
+    new->se_n2 = n2;
+    new->se_value = value;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefFind --
+ *
+ * Union-find lookup of the node that names the net containing 'sn'.
+ *
+ * Results:
+ *	The net's SpefNode.
+ *
+ * Side effects:
+ *	Compresses the path from 'sn'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static SpefNode *
+spefFind(
+    SpefNode *sn)
+{
+    SpefNode *root, *next;
+
+    for (root = sn; root->sn_parent != root; root = root->sn_parent)
+	/* Nothing */;
+    for ( ; sn != root; sn = next)
+    {
+	next = sn->sn_parent;
+	sn->sn_parent = root;
+    }
+    return root;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefPrefer --
+ *
+ * Decide which of two nodes should name a net:  top-level ports
+ * first, then whichever name EFHNBest() prefers.
+ *
+ * Results:
+ *	TRUE if 'sn1' should name the net, FALSE if 'sn2' should.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static bool
+spefPrefer(
+    SpefNode *sn1,
+    SpefNode *sn2)
+{
+    int port1 = sn1->sn_node->efnode_flags & EF_TOP_PORT;
+    int port2 = sn2->sn_node->efnode_flags & EF_TOP_PORT;
+
+    if (port1 && !port2) return TRUE;
+    if (port2 && !port1) return FALSE;
+    return EFHNBest(sn1->sn_node->efnode_name->efnn_hier,
+		sn2->sn_node->efnode_name->efnn_hier);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefLook --
+ *
+ * Find the SpefNode for a hierarchical node name.
+ *
+ * Results:
+ *	The SpefNode, or NULL if the name does not name a live flat node.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static SpefNode *
+spefLook(
+    const HierName *hierName)
+{
+    HashEntry *he;
+    EFNode *node;
+
+    he = EFHNLook((HierName *) hierName, (char *) NULL, "spef");
+    if (he == NULL) return NULL;
+    node = ((EFNodeName *) HashGetValue(he))->efnn_node;
+    return (SpefNode *) node->efnode_client;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * Visitor procedures --
+ *
+ * spefCountVisit counts the flat nodes; spefNodeVisit attaches a
+ * SpefNode to each and records its capacitance to ground;
+ * spefResistVisit joins the two nodes of each resistor into one net;
+ * spefCapVisit records each coupling capacitor, lower node first.
+ * Capacitances arrive in attofarads and resistances in milliohms.
+ *
+ * Results:
+ *	Return 0 to keep the visit going.
+ *
+ * Side effects:
+ *	Fill in spefNodes, spefCaps and spefRes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+/* @typedef cb_extflat_visitnodes_t (UNUSED) */
+static int
+spefCountVisit(
+    EFNode *node,
+    int res,
+    double cap,
+    ClientData cdata)	/* unused */
+{
+    spefNumNodes++;
+    return 0;
+}
+
+/* @typedef cb_extflat_visitnodes_t (UNUSED) */
+static int
+spefNodeVisit(
+    EFNode *node,
+    int res,
+    double cap,
+    ClientData cdata)	/* unused */
+{
+    SpefNode *sn = &spefNodes[spefNumNodes++];
+
+    sn->sn_parent = sn;
+    sn->sn_node = node;
+    sn->sn_net = 0;
+    sn->sn_sub = 0;
+    node->efnode_client = (ClientData) sn;
+
+    cap = cap / 1000;
+    if (cap > EFCapThreshold)
+	spefListAdd(&spefCaps, sn, (SpefNode *) NULL, cap);
+    return 0;
+}
+
+/* @typedef cb_extflat_visitresists_t (UNUSED) */
+static int
+spefResistVisit(
+    const HierName *hierName1,
+    const HierName *hierName2,
+    float res,
+    ClientData cdata)	/* unused */
+{
+    SpefNode *sn1, *sn2, *r1, *r2;
+
+    sn1 = spefLook(hierName1);
+    sn2 = spefLook(hierName2);
+    if (sn1 == NULL || sn2 == NULL) return 0;
+
+    r1 = spefFind(sn1);
+    r2 = spefFind(sn2);
+    if (r1 != r2)
+    {
+	if (spefPrefer(r1, r2))
+	    r2->sn_parent = r1;
+	else
+	    r1->sn_parent = r2;
+    }
+    spefListAdd(&spefRes, sn1, sn2, (double) res / 1000.);
+    return 0;
+}
+
+/* @typedef cb_extflat_visitcaps_t (UNUSED) */
+static int
+spefCapVisit(
+    HierName *hierName1,
+    HierName *hierName2,
+    double cap,
+    ClientData cdata)	/* unused */
+{
+    SpefNode *sn1, *sn2;
+
+    cap = cap / 1000;
+    if (cap <= EFCapThreshold)
+	return 0;
+
+    sn1 = spefLook(hierName1);
+    sn2 = spefLook(hierName2);
+    if (sn1 == NULL || sn2 == NULL) return 0;
+    if (sn2 < sn1)
+	spefListAdd(&spefCaps, sn2, sn1, cap);
+    else
+	spefListAdd(&spefCaps, sn1, sn2, cap);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefElemCompare --
+ *
+ * qsort() comparison for coupling capacitors.  EFVisitCaps() walks a
+ * hash table keyed by node pointers, so the capacitors are sorted by
+ * node order to make the output the same from run to run.
+ *
+ * Results:
+ *	Negative, zero or positive as e1 sorts before, with, or after e2.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static int
+spefElemCompare(
+    const void *p1,
+    const void *p2)
+{
+    const SpefElem *e1 = (const SpefElem *) p1;
+    const SpefElem *e2 = (const SpefElem *) p2;
+
+    if (e1->se_n1 != e2->se_n1)
+	return (e1->se_n1 < e2->se_n1) ? -1 : 1;
+    if (e1->se_n2 != e2->se_n2)
+	return (e1->se_n2 < e2->se_n2) ? -1 : 1;
+    if (e1->se_value != e2->se_value)
+	return (e1->se_value < e2->se_value) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefPutName --
+ *
+ * Write a node name for SPEF.  Hierarchy dividers and bus brackets
+ * are kept, and any other character that is not part of a SPEF
+ * identifier is escaped with a backslash.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+spefPutName(
+    FILE *f,
+    const char *name)
+{
+    const char *cp;
+
+    for (cp = name; *cp; cp++)
+    {
+	if (!isalnum((unsigned char) *cp) && (*cp != '_') && (*cp != '/')
+		&& (*cp != '[') && (*cp != ']'))
+	    putc('\\', f);
+	putc(*cp, f);
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spefPutNode / dspfPutNode --
+ *
+ * Write the reference to a node within an element line:  "*net" or
+ * "*net:sub" for SPEF, using the name map, and "name" or "name:sub"
+ * for DSPF.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+spefPutNode(
+    FILE *f,
+    SpefNode *sn)
+{
+    fprintf(f, "*%d", sn->sn_net);
+    if (sn->sn_sub > 0 && sn->sn_parent != sn)
+	fprintf(f, ":%d", sn->sn_sub);
+}
+
+static void
+dspfPutNode(
+    FILE *f,
+    SpefNode *sn,
+    char **netNames)
+{
+    fputs(netNames[sn->sn_net], f);
+    if (sn->sn_sub > 0 && sn->sn_parent != sn)
+	fprintf(f, ":%d", sn->sn_sub);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ESGenerateParasitics --
+ *
+ * Flatten the circuit rooted at 'inName' and write its parasitics to
+ * esSpiceF in SPEF or DSPF form, according to esFormat.  The total
+ * capacitance reported for each net is the sum of its capacitance to
+ * ground and of every coupling capacitor touching it, which is the
+ * same figure obtained by summing the matching capacitors of the
+ * flat SPICE output.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to esSpiceF.  Builds and frees the flat circuit.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+ESGenerateParasitics(
+    char *inName,
+    int flags)
+{
+    SpefNode *sn, *root, **netNodes;
+    SpefElem *se, **netElems;
+    int *netStart, *netFill, *nodeStart;
+    double *netCap;
+    char **netNames;
+    char name[MAX_STR_SIZE];
+    int i, j, numNets, numElems;
+    bool doSpef = (esFormat == SPEF);
+    float scale = EFScale / 100.0;	/* Microns per internal unit */
+    time_t now;
+    char *date;
+
+    EFFlatBuild(inName, flags);
+
+    /* Collect nodes and parasitics */
+
+    spefNumNodes = 0;
+    EFVisitNodes(spefCountVisit, (ClientData) NULL);
+    spefNodes = (SpefNode *) mallocMagic((spefNumNodes + 1) * sizeof (SpefNode));
+    spefNumNodes = 0;
+    spefCaps.sl_num = spefCaps.sl_size = 0;
+    spefRes.sl_num = spefRes.sl_size = 0;
+    EFVisitNodes(spefNodeVisit, (ClientData) NULL);
+    EFVisitResists(spefResistVisit, (ClientData) NULL);
+    if (flags & EF_FLATCAPS)
+    {
+	numElems = spefCaps.sl_num;	/* Ground capacitors, in node order */
+	EFVisitCaps(spefCapVisit, (ClientData) NULL);
+	if (spefCaps.sl_num > numElems)
+	    qsort(spefCaps.sl_elems + numElems, spefCaps.sl_num - numElems,
+		    sizeof (SpefElem), spefElemCompare);
+    }
+
+    /* Number the nets in node order, then the internal nodes of each */
+
+    numNets = 0;
+    for (i = 0; i < spefNumNodes; i++)
+    {
+	sn = &spefNodes[i];
+	if (spefFind(sn) == sn)
+	    sn->sn_net = ++numNets;
+    }
+    netNames = (char **) mallocMagic((numNets + 1) * sizeof (char *));
+    for (i = 0; i < spefNumNodes; i++)
+    {
+	sn = &spefNodes[i];
+	root = sn->sn_parent;
+	if (root == sn)
+	{
+	    EFHNSprintf(name, sn->sn_node->efnode_name->efnn_hier);
+	    netNames[sn->sn_net] = StrDup((char **) NULL, name);
+	}
+	else
+	{
+	    sn->sn_net = root->sn_net;
+	    sn->sn_sub = ++root->sn_sub;
+	}
+    }
+
+    /* Sort the nodes by net, keeping node order within each net, so
+     * that the connection sections need not scan every node per net.
+     */
+
+    nodeStart = (int *) mallocMagic((numNets + 2) * sizeof (int));
+    netFill = (int *) mallocMagic((numNets + 2) * sizeof (int));
+    for (i = 0; i <= numNets + 1; i++) nodeStart[i] = 0;
+    for (i = 0; i < spefNumNodes; i++)
+	nodeStart[spefNodes[i].sn_net + 1]++;
+    for (i = 1; i <= numNets + 1; i++)
+	nodeStart[i] += nodeStart[i - 1];
+    netNodes = (SpefNode **) mallocMagic((spefNumNodes + 1) * sizeof (SpefNode *));
+    for (i = 0; i <= numNets; i++) netFill[i] = nodeStart[i];
+    for (i = 0; i < spefNumNodes; i++)
+	netNodes[netFill[spefNodes[i].sn_net]++] = &spefNodes[i];
+
+    /* Sort the elements by net.  A coupling capacitor between two nets
+     * is listed under both;  resistors always lie within one net.
+     */
+
+    netStart = (int *) mallocMagic((numNets + 2) * sizeof (int));
+    netCap = (double *) mallocMagic((numNets + 1) * sizeof (double));
+    for (i = 0; i <= numNets + 1; i++) netStart[i] = 0;
+    for (i = 0; i <= numNets; i++) netCap[i] = 0.0;
+
+    for (i = 0; i < spefCaps.sl_num; i++)
+    {
+	se = &spefCaps.sl_elems[i];
+	netStart[se->se_n1->sn_net + 1]++;
+	netCap[se->se_n1->sn_net] += se->se_value;
+	if (se->se_n2 && se->se_n2->sn_net != se->se_n1->sn_net)
+	{
+	    netStart[se->se_n2->sn_net + 1]++;
+	    netCap[se->se_n2->sn_net] += se->se_value;
+	}
+    }
+    for (i = 0; i < spefRes.sl_num; i++)
+	netStart[spefRes.sl_elems[i].se_n1->sn_net + 1]++;
+    for (i = 1; i <= numNets + 1; i++)
+	netStart[i] += netStart[i - 1];
+    numElems = netStart[numNets + 1];
+    netElems = (SpefElem **) mallocMagic((numElems + 1) * sizeof (SpefElem *));
+    for (i = 0; i <= numNets; i++) netFill[i] = netStart[i];
+
+    /* Capacitors first, then resistors, so that each net's range
+     * holds its capacitors followed by its resistors.
+     */
+    for (i = 0; i < spefCaps.sl_num; i++)
+    {
+	se = &spefCaps.sl_elems[i];
+	netElems[netFill[se->se_n1->sn_net]++] = se;
+	if (se->se_n2 && se->se_n2->sn_net != se->se_n1->sn_net)
+	    netElems[netFill[se->se_n2->sn_net]++] = se;
+    }
+    for (i = 0; i < spefRes.sl_num; i++)
+    {
+	se = &spefRes.sl_elems[i];
+	netElems[netFill[se->se_n1->sn_net]++] = se;
+    }
+
+    /* Header */
+
+    now = time((time_t *) NULL);
+    date = ctime(&now);
+    date[strlen(date) - 1] = '\0';	/* Remove the newline */
+
+    if (doSpef)
+    {
+	fprintf(esSpiceF, "*SPEF \"IEEE 1481-1998\"\n");
+	fprintf(esSpiceF, "*DESIGN \"%s\"\n", inName);
+	fprintf(esSpiceF, "*DATE \"%s\"\n", date);
+	fprintf(esSpiceF, "*VENDOR \"Magic\"\n");
+	fprintf(esSpiceF, "*PROGRAM \"ext2spice\"\n");
+	fprintf(esSpiceF, "*VERSION \"%s.%s\"\n", MagicVersion, MagicRevision);
+	fprintf(esSpiceF, "*DESIGN_FLOW \"NAME_SCOPE FLAT\"\n");
+	fprintf(esSpiceF, "*DIVIDER /\n*DELIMITER :\n*BUS_DELIMITER [ ]\n");
+	fprintf(esSpiceF, "*T_UNIT 1 NS\n*C_UNIT 1 FF\n*R_UNIT 1 OHM\n");
+	fprintf(esSpiceF, "*L_UNIT 1 HENRY\n\n");
+
+	fprintf(esSpiceF, "*NAME_MAP\n");
+	for (i = 1; i <= numNets; i++)
+	{
+	    fprintf(esSpiceF, "*%d ", i);
+	    spefPutName(esSpiceF, netNames[i]);
+	    putc('\n', esSpiceF);
+	}
+
+	fprintf(esSpiceF, "\n*PORTS\n");
+	for (i = 0; i < spefNumNodes; i++)
+	{
+	    sn = &spefNodes[i];
+	    if (sn->sn_parent == sn && (sn->sn_node->efnode_flags & EF_TOP_PORT))
+		fprintf(esSpiceF, "*%d B\n", sn->sn_net);
+	}
+    }
+    else
+    {
+	fprintf(esSpiceF, "*|DSPF 1.3\n");
+	fprintf(esSpiceF, "*|DESIGN \"%s\"\n", inName);
+	fprintf(esSpiceF, "*|DATE \"%s\"\n", date);
+	fprintf(esSpiceF, "*|VENDOR \"Magic\"\n");
+	fprintf(esSpiceF, "*|PROGRAM \"ext2spice\"\n");
+	fprintf(esSpiceF, "*|VERSION \"%s.%s\"\n", MagicVersion, MagicRevision);
+	fprintf(esSpiceF, "*|DIVIDER /\n*|DELIMITER :\n");
+	fprintf(esSpiceF, "*|GROUND_NET %s\n", esSpiceDefaultGnd);
+    }
+
+    /* One section per net.  Nets with no parasitics are omitted. */
+
+    esCapNum = esResNum = 1;
+    for (i = 1; i <= numNets; i++)
+    {
+	int first = netStart[i], last = netStart[i + 1];
+	int numCaps;
+
+	if (first == last) continue;
+
+	if (doSpef)
+	    fprintf(esSpiceF, "\n*D_NET *%d %.6g\n", i, netCap[i]);
+	else
+	{
+	    fprintf(esSpiceF, "\n*|NET %s %.6gPF\n", netNames[i],
+			1.0E-3 * netCap[i]);
+	}
+
+	/* Connections:  the net's top-level ports and, for DSPF,
+	 * every internal node with its location.
+	 */
+	if (doSpef)
+	{
+	    bool conn = FALSE;
+
+	    for (j = nodeStart[i]; j < nodeStart[i + 1]; j++)
+	    {
+		sn = netNodes[j];
+		if (!(sn->sn_node->efnode_flags & EF_TOP_PORT)) continue;
+		if (!conn) fprintf(esSpiceF, "*CONN\n");
+		conn = TRUE;
+		fprintf(esSpiceF, "*P ");
+		spefPutNode(esSpiceF, sn);
+		fprintf(esSpiceF, " B\n");
+	    }
+	}
+	else
+	{
+	    for (j = nodeStart[i]; j < nodeStart[i + 1]; j++)
+	    {
+		Rect *r;
+
+		sn = netNodes[j];
+		r = &sn->sn_node->efnode_loc;
+		if (sn->sn_node->efnode_flags & EF_TOP_PORT)
+		    fprintf(esSpiceF, "*|P (");
+		else if (sn->sn_parent != sn)
+		    fprintf(esSpiceF, "*|S (");
+		else
+		    continue;
+		dspfPutNode(esSpiceF, sn, netNames);
+		if (sn->sn_node->efnode_flags & EF_TOP_PORT)
+		    fprintf(esSpiceF, " B 0");
+		fprintf(esSpiceF, " %g %g)\n", r->r_xbot * scale,
+			r->r_ybot * scale);
+	    }
+	}
+
+	/* Elements:  capacitors precede resistors within each range */
+	numCaps = 0;
+	for (j = first; j < last; j++)
+	{
+	    se = netElems[j];
+	    if (se >= spefRes.sl_elems && se < spefRes.sl_elems + spefRes.sl_num)
+		break;
+	    numCaps++;
+	}
+
+	if (numCaps > 0)
+	{
+	    if (doSpef) fprintf(esSpiceF, "*CAP\n");
+	    for (j = first; j < first + numCaps; j++)
+	    {
+		se = netElems[j];
+		if (doSpef)
+		{
+		    fprintf(esSpiceF, "%d ", j - first + 1);
+		    spefPutNode(esSpiceF, se->se_n1);
+		    if (se->se_n2)
+		    {
+			putc(' ', esSpiceF);
+			spefPutNode(esSpiceF, se->se_n2);
+		    }
+		    fprintf(esSpiceF, " %.6g\n", se->se_value);
+		}
+		else
+		{
+		    /* Coupling capacitors are written once, by the
+		     * first of the two nets.
+		     */
+		    if (se->se_n2 && (MIN(se->se_n1->sn_net,
+				se->se_n2->sn_net) < i))
+			continue;
+		    fprintf(esSpiceF, "C%d ", esCapNum++);
+		    dspfPutNode(esSpiceF, se->se_n1, netNames);
+		    putc(' ', esSpiceF);
+		    if (se->se_n2)
+			dspfPutNode(esSpiceF, se->se_n2, netNames);
+		    else
+			fputs(esSpiceDefaultGnd, esSpiceF);
+		    putc(' ', esSpiceF);
+		    esSIvalue(esSpiceF, 1.0E-15 * se->se_value);
+		    putc('\n', esSpiceF);
+		}
+	    }
+	}
+
+	if (first + numCaps < last)
+	{
+	    if (doSpef) fprintf(esSpiceF, "*RES\n");
+	    for (j = first + numCaps; j < last; j++)
+	    {
+		se = netElems[j];
+		if (doSpef)
+		{
+		    fprintf(esSpiceF, "%d ", j - first - numCaps + 1);
+		    spefPutNode(esSpiceF, se->se_n1);
+		    putc(' ', esSpiceF);
+		    spefPutNode(esSpiceF, se->se_n2);
+		    fprintf(esSpiceF, " %.6g\n", se->se_value);
+		}
+		else
+		{
+		    fprintf(esSpiceF, "R%d ", esResNum++);
+		    dspfPutNode(esSpiceF, se->se_n1, netNames);
+		    putc(' ', esSpiceF);
+		    dspfPutNode(esSpiceF, se->se_n2, netNames);
+		    fprintf(esSpiceF, " %g\n", se->se_value);
+		}
+	    }
+	}
+	if (doSpef) fprintf(esSpiceF, "*END\n");
+    }
+    if (!doSpef) fprintf(esSpiceF, "\n.END\n");
+
+    /* Clean up.  The node clients point into spefNodes and must not
+     * be freed individually by EFFlatDone().
+     */
+
+    for (i = 0; i < spefNumNodes; i++)
+	spefNodes[i].sn_node->efnode_client = (ClientData) NULL;
+    for (i = 1; i <= numNets; i++)
+	freeMagic(netNames[i]);
+    freeMagic((char *) netNames);
+    freeMagic((char *) netStart);
+    freeMagic((char *) netFill);
+    freeMagic((char *) nodeStart);
+    freeMagic((char *) netNodes);
+    freeMagic((char *) netCap);
+    freeMagic((char *) netElems);
+    if (spefCaps.sl_size > 0) freeMagic((char *) spefCaps.sl_elems);
+    if (spefRes.sl_size > 0) freeMagic((char *) spefRes.sl_elems);
+    freeMagic((char *) spefNodes);
+    spefNodes = NULL;
+
+    EFFlatDone(NULL);
+}
@@ -113,10 +113,12 @@ int	 esFMSize = FMULT_SIZE ; /* its current size (growable) */
 int	 esSpiceDevsMerged;
 
 const devMerge *devMergeList = NULL ;
+HashTable devMergeTable;	/* devMerge candidates bucketed by devMergeKey */
 
 #define        atoCap(s)       ((EFCapValue)atof(s))
 
 extern void ESGenerateHierarchy(char *inName, int flags);  /* forward reference ext2hier.c */
+extern void ESGenerateParasitics(char *inName, int flags);  /* forward reference ext2spef.c */
 
 /*
  * ----------------------------------------------------------------------------
@@ -284,7 +286,7 @@ CmdExtToSpice(
     static int LocResistThreshold = INFINITE_THRESHOLD;
 
     static const char * const spiceFormats[] = {
-	"SPICE2", "SPICE3", "HSPICE", "NGSPICE", "CDL", NULL
+	"SPICE2", "SPICE3", "HSPICE", "NGSPICE", "CDL", "SPEF", "DSPF", NULL
     };
 
     static const char * const cmdExtToSpcOption[] = {
@@ -331,6 +333,8 @@ CmdExtToSpice(
 	"hspice",
 	"ngspice",
 	"cdl",
+	"spef",
+	"dspf",
 	NULL
     };
 
@@ -664,10 +668,10 @@ CmdExtToSpice(
 	    {
 #ifdef MAGIC_WRAPPER
 		Tcl_SetResult(magicinterp, "Bad format type.  Formats are:"
-			"spice2, spice3, hspice, ngspice, and cdl.", NULL);
+			"spice2, spice3, hspice, ngspice, cdl, spef, and dspf.", NULL);
 #else
 		TxError("Bad format type.  Formats are:"
-			"spice2, spice3, hspice, ngspice, and cdl.");
+			"spice2, spice3, hspice, ngspice, cdl, spef, and dspf.");
 #endif
 		return;
 	    }
@@ -880,6 +884,10 @@ runexttospice:
     {
 	if (esFormat == CDL)
 	    sprintf(spcesDefaultOut, "%s.cdl", inName);
+	else if (esFormat == SPEF)
+	    sprintf(spcesDefaultOut, "%s.spef", inName);
+	else if (esFormat == DSPF)
+	    sprintf(spcesDefaultOut, "%s.dspf", inName);
 	else
 	    sprintf(spcesDefaultOut, "%s.spice", inName);
     }
@@ -1048,6 +1056,31 @@ runexttospice:
     }
 #endif
 
+    /* SPEF and DSPF formats write only the flat parasitics */
+
+    if (esFormat == SPEF || esFormat == DSPF)
+    {
+	while (glist != NULL)
+	{
+	    globalList *glnext = glist->gll_next;
+
+	    freeMagic(glist->gll_name);
+	    freeMagic((char *)glist);
+	    glist = glnext;
+	}
+
+	flatFlags = EF_FLATNODES;
+	if (esMergeNames == FALSE) flatFlags |= EF_NONAMEMERGE;
+	if (IS_FINITE_F(EFCapThreshold)) flatFlags |= EF_FLATCAPS;
+	EFOutputFlags |= EF_TRIMGLOB | EF_CONVERTEQUAL | EF_CONVERTCOMMA;
+
+	ESGenerateParasitics(inName, flatFlags);
+	EFDone(NULL);
+	fclose(esSpiceF);
+	TxPrintf("exttospice finished.\n");
+	return;
+    }
+
     /* Write the output file */
 
     fprintf(esSpiceF, "* %s file created from %s.ext - technology: %s\n\n",
@@ -1158,6 +1191,8 @@ runexttospice:
 	{
 	    const devMerge *p;
 
+	    HashInit(&devMergeTable, DEVMERGE_HASHSIZE,
+			HashSize(sizeof (devMergeKey)));
 	    EFVisitDevs(devMergeVisit, (ClientData) NULL);
 	    TxPrintf("Devs merged: %d\n", esSpiceDevsMerged);
 	    esFMIndex = 0;
@@ -1166,6 +1201,7 @@ runexttospice:
 		freeMagic1(&mm1, (char *) p);
 	    freeMagic1_end(&mm1);
 	    devMergeList = NULL;
+	    HashKill(&devMergeTable);
 	}
 	else if (esDistrJunct)
      	    EFVisitDevs(devDistJunctVisit, (ClientData) NULL);
@@ -1341,6 +1377,8 @@ main(
 	TTMaskSetType(&initMask, efNumResistClasses);
 
     if ( esMergeDevsA || esMergeDevsC ) {
+	HashInit(&devMergeTable, DEVMERGE_HASHSIZE,
+			HashSize(sizeof (devMergeKey)));
      	EFVisitDevs(devMergeVisit, (ClientData) NULL);
 	TxPrintf("Devs merged: %d\n", esSpiceDevsMerged);
 	esFMIndex = 0 ;
@@ -1352,6 +1390,7 @@ main(
 		freeMagic1(&mm1, (char *)p);
 	    freeMagic1_end(&mm1);
 	}
+	HashKill(&devMergeTable);
     } else if ( esDistrJunct )
      	EFVisitDevs(devDistJunctVisit, (ClientData) NULL);
     EFVisitDevs(spcdevVisit, (ClientData) NULL);
@@ -1469,6 +1508,10 @@ spcParseArgs(
 		esFormat = NGSPICE;
 	    else if (strcasecmp(ftmp, "CDL") == 0)
 		esFormat = CDL;
+	    else if (strcasecmp(ftmp, "SPEF") == 0)
+		esFormat = SPEF;
+	    else if (strcasecmp(ftmp, "DSPF") == 0)
+		esFormat = DSPF;
 	    else goto usage;
 	    break;
 
@@ -3444,7 +3487,7 @@ spcdevSubstrate(
 	if (outf)
 	{
 	    const char *spicename;
-	    spicename = nodeSpiceName(nn->efnn_node->efnode_name->efnn_hier, NULL);
+	    spicename = spcNodeName(nn->efnn_node);
 	    fprintf(outf, "%s", spicename);
 	}
 
@@ -3546,6 +3589,63 @@ morphNumericString(
     }
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * esFormatDecimal --
+ *
+ *	Write the value "d" into string "s" exactly as nDecimals(s, d, 5)
+ *	followed by morphNumericString(s, 5) would (rounded to 5 decimal
+ *	places, with trailing zeros removed), but without sprintf(), which
+ *	dominates the time spent writing large netlists.  Values that are
+ *	too large, not finite, or too close to a rounding boundary to be
+ *	sure of matching sprintf() are passed to the slow path.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+esFormatDecimal(
+    char *s,
+    double d)
+{
+    double x;
+    dlong r, whole;
+    int frac, n;
+    char digits[24];
+
+    x = fabs(d) * 100000.0;
+    if (!(x < 1.0E11) || (fabs(x - floor(x) - 0.5) < 1.0E-4))
+    {
+	nDecimals(s, d, 5);
+	morphNumericString(s, 5);
+	return;
+    }
+    r = (dlong)(x + 0.5);
+    whole = r / 100000;
+    frac = (int)(r % 100000);
+
+    if (signbit(d)) *s++ = '-';
+    n = 0;
+    do
+    {
+	digits[n++] = '0' + (int)(whole % 10);
+	whole /= 10;
+    } while (whole > 0);
+    while (n > 0) *s++ = digits[--n];
+
+    if (frac != 0)
+    {
+	*s++ = '.';
+	for (n = 10000; (n > 0) && (frac != 0); n /= 10)
+	{
+	    *s++ = '0' + frac / n;
+	    frac %= n;
+	}
+    }
+    *s = '\0';
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -3621,13 +3721,11 @@ esSIvalue(
      * digits.  Using a solution provided in StackOverflow (see above).
      */
 
-    nDecimals(vstr, (double)value, 5);
-    morphNumericString(vstr, 5);
+    esFormatDecimal(vstr, (double)value);
 
-    if (suffix == '\0')
-	fprintf(file, "%s", vstr);
-    else
-	fprintf(file, "%s%c", vstr, suffix);
+    fputs(vstr, file);
+    if (suffix != '\0')
+	putc(suffix, file);
 }
 
 /*
@@ -3946,7 +4044,7 @@ spcdevOutNode(
 	return 0;
     }
     nn = (EFNodeName *) HashGetValue(he);
-    nname = nodeSpiceName(nn->efnn_node->efnode_name->efnn_hier, NULL);
+    nname = spcNodeName(nn->efnn_node);
     fprintf(outf, " %s", nname);
 
     /* Mark node as visited (set bit one higher than number of resist classes) */
@@ -4104,13 +4202,11 @@ spcsubVisit(
     ClientData cdata)
 {
     char **resstr = (char **)CD2PTR(cdata);
-    HierName *hierName;
     const char *nsn;
 
     if (node->efnode_flags & EF_GLOB_SUBS_NODE)
     {
-	hierName = (HierName *) node->efnode_name->efnn_hier;
-	nsn = nodeSpiceName(hierName, NULL);
+	nsn = spcNodeName(node);
 	*resstr = StrDup((char **)NULL, nsn);
 	return 1;
     }
@@ -4162,7 +4258,7 @@ spcnodeVisit(
     if (!isConnected && node->efnode_flags & EF_PORT) isConnected = TRUE;
 
     hierName = (HierName *) node->efnode_name->efnn_hier;
-    nsn = nodeSpiceName(hierName, NULL);
+    nsn = spcNodeName(node);
 
     if (esFormat == SPICE2 || (esFormat == HSPICE && strncmp(nsn, "z@", 2)==0 )) {
 	static char ntmp[MAX_STR_SIZE];
@@ -4257,15 +4353,38 @@ nodeSpiceName(
     node = nn->efnn_node;
     if (rnode) *rnode = node;
 
+    return spcNodeName(node);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * spcNodeName --
+ *
+ * Like nodeSpiceName(), but for a node that the caller already has in
+ * hand, which saves looking it up by name again.  The name is built
+ * the first time it is asked for and then kept in the node's client
+ * record, so each node name is only formatted once.
+ *
+ * Results:
+ *	Returns the spice node name.
+ *
+ * Side effects:
+ *      Allocates nodeClients for the node.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+const char *
+spcNodeName(
+    EFNode *node)
+{
     if ( (nodeClient *) (node->efnode_client) == NULL ) {
     	initNodeClient(node);
-	goto makeName;
-    } else if ( ((nodeClient *) (node->efnode_client))->spiceNodeName == NULL)
-	goto makeName;
-    else goto retName;
-
+    }
+    else if ( ((nodeClient *) (node->efnode_client))->spiceNodeName != NULL)
+	return ((nodeClient *) (node->efnode_client))->spiceNodeName;
 
-makeName:
     if ( esFormat == SPICE2 )
 	sprintf(esTempName, "%d", esNodeNum++);
     else {
@@ -4276,7 +4395,6 @@ makeName:
    ((nodeClient *) (node->efnode_client))->spiceNodeName =
 	    StrDup(NULL, esTempName);
 
-retName:
     return ((nodeClient *) (node->efnode_client))->spiceNodeName;
 }
 
@@ -4526,6 +4644,7 @@ mkDevMerge(
     fp->esFMIndex = esFMIndex;
     fp->hierName = hn;
     fp->next = NULL;
+    fp->hnext = NULL;
     addDevMult(1.0);
 
     return fp;
@@ -4645,6 +4764,103 @@ parallelDevs(
     return NOT_PARALLEL;
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * devMergeFind --
+ *
+ * Find the bucket of devMergeTable holding the devices that could be
+ * parallel to fp.  The key mirrors the tests made by parallelDevs():
+ * class and type always; gate, bulk, length and the (unordered)
+ * source/drain pair for transistors; top and bottom for capacitors.
+ * Classes that parallelDevs() never merges have no bucket.
+ *
+ * Results:
+ *    The hash entry for fp's bucket, whose value is the most recently
+ *    added device in the bucket (chained through "hnext"), or NULL if
+ *    fp cannot be merged with anything.
+ *
+ * Side effects:
+ *	May create an empty bucket in devMergeTable.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HashEntry *
+devMergeFind(
+    const devMerge *fp)
+{
+    devMergeKey key;
+
+    /* Zero the whole key, including padding, since it is hashed bytewise */
+    memset(&key, 0, sizeof (devMergeKey));
+    key.class = fp->dev->dev_class;
+    key.type = fp->dev->dev_type;
+
+    switch (fp->dev->dev_class)
+    {
+	case DEV_MSUBCKT:
+	case DEV_MOSFET:
+	case DEV_FET:
+	case DEV_ASYMMETRIC:
+	    key.g = fp->g;
+	    key.b = fp->b;
+	    key.l = fp->l;
+	    if (fp->s < fp->d)
+	    {
+		key.s = fp->s;
+		key.d = fp->d;
+	    }
+	    else
+	    {
+		key.s = fp->d;
+		key.d = fp->s;
+	    }
+	    break;
+
+	case DEV_CAP:
+	case DEV_CAPREV:
+	    key.g = fp->g;
+	    key.s = fp->s;
+	    break;
+
+	default:
+	    return (HashEntry *)NULL;
+    }
+    return HashFind(&devMergeTable, (char *)&key);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * devMergeAdd --
+ *
+ * Add a device that was not merged to the list of merge candidates.
+ *
+ * Results:
+ *    None.
+ *
+ * Side effects:
+ *	Prepends fp to devMergeList and, if he is non-NULL, to the
+ *	devMergeTable bucket "he" returned by devMergeFind().
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+devMergeAdd(
+    devMerge *fp,
+    HashEntry *he)
+{
+    fp->next = devMergeList;
+    devMergeList = fp;
+    if (he != NULL)
+    {
+	fp->hnext = (const devMerge *)HashGetValue(he);
+	HashSetValue(he, (ClientData)fp);
+    }
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -4712,6 +4928,7 @@ devMergeVisit(
     bool     hS, hD, chS, chD;
     devMerge *fp;
     const devMerge *cfp;
+    HashEntry *he;
     float m;
     HierName *hierName = hc->hc_hierName;
 
@@ -4752,7 +4969,8 @@ devMergeVisit(
     hD = extHierSDAttr(drain);
 
     /*
-     * run the list of devs. compare the current one with
+     * run the list of devs that could be parallel to this one (those
+     * in the same devMergeTable bucket). compare the current one with
      * each one in the list. if they fullfill the matching requirements
      * merge them only if:
      * 1) they have both apf S, D attributes
@@ -4762,7 +4980,9 @@ devMergeVisit(
      * If one of them has apf and the other aph print a warning.
      */
 
-    for (cfp = devMergeList; cfp != NULL; cfp = cfp->next)
+    he = devMergeFind(fp);
+    cfp = (he == NULL) ? NULL : (const devMerge *)HashGetValue(he);
+    for (; cfp != NULL; cfp = cfp->hnext)
     {
 	if ((pmode = parallelDevs(fp, cfp)) != NOT_PARALLEL)
 	{
@@ -4861,8 +5081,7 @@ mergeThem:
     }
 
     /* No parallel devs to it yet */
-    fp->next = devMergeList;
-    devMergeList = fp;
+    devMergeAdd(fp, he);
     return 0;
 }
 
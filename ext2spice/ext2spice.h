@@ -14,8 +14,19 @@ typedef struct _devMerge {
 	int	  esFMIndex;
 	HierName *hierName;
 	const struct _devMerge *next;
+	const struct _devMerge *hnext;	/* next in devMergeTable bucket */
 } devMerge;
 
+/* Key into devMergeTable.  Devices can be parallel only if their keys
+ * match, so only devices sharing a key need to be compared with
+ * parallelDevs().  Fields not compared for a device class are zero.
+ */
+typedef struct _devMergeKey {
+	EFNode	*g, *s, *d, *b;	/* s and d are in address order */
+	float	l;
+	int	class, type;
+} devMergeKey;
+
 #include "extflat/EFint.h" /* HierContext */
 
 /* Forward declarations */
@@ -32,6 +43,7 @@ extern int spcsubVisit(EFNode *node, int res, double cap, ClientData cdata); /*
 extern int subcktUndef(Use *use, HierName *hierName, bool is_top); /* @typedef cb_extflat_visitsubcircuits_t */
 extern EFNode *spcdevSubstrate(HierName *prefix, HierName *suffix, int type, FILE *outf);
 extern const char *nodeSpiceName(const HierName *hname, EFNode **rnode);
+extern const char *spcNodeName(EFNode *node);
 extern int nodeVisitDebug(EFNode *node, int res, double cap, ClientData cdata); /* @typedef cb_extflat_visitnodes_t (UNUSED) */
 extern void topVisit(Def *def, bool doStub);
 extern void swapDrainSource(Dev *dev);
@@ -52,6 +64,8 @@ extern int spcdevOutNode(const HierName *prefix, const HierName *suffix, const c
 extern void spcdevResPi(const HierName *prefix, const HierName *gate, const HierName *source, const HierName *drain, const char *name);
 extern int spcnAP(DevTerm *dterm, EFNode *node, int resClass, float scale, char *asterm, char *psterm, float m, FILE *outf, int w);
 extern int parallelDevs(const devMerge *f1, const devMerge *f2);
+extern HashEntry *devMergeFind(const devMerge *fp);
+extern void devMergeAdd(devMerge *fp, HashEntry *he);
 extern int nodeHspiceName(char *s);
 extern int devDistJunctHierVisit(HierContext *hc, Dev *dev, float scale, ClientData cdata); /* @typedef cb_extflat_hiervisitdevs_t (UNUSED) */
 extern int spcnAPHier(DevTerm *dterm, HierName *hierName, int resClass, float scale, char *asterm, char *psterm, float m, FILE *outf);
@@ -99,6 +113,10 @@ extern int	 esFMSize; 	/* its current size (growable) */
 
 extern int	 esSpiceDevsMerged;
 extern const devMerge *devMergeList;
+extern HashTable devMergeTable;
+
+/* Initial size of devMergeTable */
+#define DEVMERGE_HASHSIZE	1024
 
 /*
  * The following hash table and associated functions are used only if
@@ -175,6 +193,8 @@ typedef struct {
 #define	HSPICE	2
 #define	NGSPICE	3
 #define	CDL	4
+#define	SPEF	5	/* Parasitics only, see ext2spef.c */
+#define	DSPF	6
 
 #define AUTO	2	/* TRUE | FALSE | AUTO for esDoSubckt */
 
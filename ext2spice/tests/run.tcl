@@ -0,0 +1,247 @@
+#------------------------------------------------------------------------
+# run.tcl --
+#
+#	Regression checks for ext2spice.  Run from any directory with
+#
+#		magic -dnull -noconsole ext2spice/tests/run.tcl
+#
+#	Each check reads the .ext files in this directory, writes its
+#	output to a scratch directory, and compares it with the expected
+#	output kept here.  Lines giving the date or the version of magic
+#	are ignored.  The result of each check is printed, and magic exits
+#	with status 1 if any check failed.
+#------------------------------------------------------------------------
+
+set testdir [file dirname [file normalize [info script]]]
+set scratch [file join [expr {[info exists ::env(TMPDIR)] ? \
+	$::env(TMPDIR) : "/tmp"}] ext2spice_tests_[pid]]
+file mkdir $scratch
+cd $testdir
+set failed 0
+
+#------------------------------------------------------------------------
+# Read a file as a list of lines, dropping those that change from run
+# to run.
+#------------------------------------------------------------------------
+
+proc readStable {name} {
+    set f [open $name r]
+    set lines {}
+    foreach line [split [read $f] "\n"] {
+	if {[regexp {^\*\|?(DATE|VERSION) } $line]} continue
+	lappend lines $line
+    }
+    close $f
+    return $lines
+}
+
+#------------------------------------------------------------------------
+# Report the result of one check.
+#------------------------------------------------------------------------
+
+proc report {name ok {why ""}} {
+    global failed
+    if {$ok} {
+	puts "PASS: $name"
+    } else {
+	puts "FAIL: $name $why"
+	incr failed
+    }
+}
+
+#------------------------------------------------------------------------
+# Compare the output file 'actual' with the expected file 'expect'.
+#------------------------------------------------------------------------
+
+proc compareFiles {name expect actual} {
+    set a [readStable $actual]
+    set e [readStable $expect]
+    if {$a == $e} {
+	report $name 1
+	return
+    }
+    set n 0
+    foreach la $a le $e {
+	incr n
+	if {$la != $le} break
+    }
+    report $name 0 "(line $n:  expected \"$le\", got \"$la\")"
+}
+
+#------------------------------------------------------------------------
+# Compare two SPICE netlists without regard to the order of the lines,
+# the numbering of the capacitors, or the order of a capacitor's two
+# nodes, all of which follow the order of a hash table in ext2spice.
+#------------------------------------------------------------------------
+
+proc compareNetlists {name expect actual} {
+    foreach which {expect actual} {
+	set lines($which) {}
+	foreach line [readStable [set $which]] {
+	    if {[regexp {^C\d+ (\S+) (\S+) (.*)$} $line -> n1 n2 v]} {
+		set line "C [lsort [list $n1 $n2]] $v"
+	    }
+	    lappend lines($which) $line
+	}
+	set lines($which) [lsort $lines($which)]
+    }
+    if {$lines(expect) == $lines(actual)} {
+	report $name 1
+	return
+    }
+    foreach le $lines(expect) la $lines(actual) {
+	if {$la != $le} break
+    }
+    report $name 0 "(expected \"$le\", got \"$la\")"
+}
+
+#------------------------------------------------------------------------
+# Convert a SPICE value with an SI suffix to a number.
+#------------------------------------------------------------------------
+
+proc spiceValue {v} {
+    array set si {f 1e-15 p 1e-12 n 1e-9 u 1e-6 m 1e-3 k 1e3 G 1e9}
+    set last [string index $v end]
+    if {[info exists si($last)]} {
+	return [expr {[string range $v 0 end-1] * $si($last)}]
+    }
+    return $v
+}
+
+#------------------------------------------------------------------------
+# SPEF and DSPF:  name map, connections and elements of a small RC
+# network.  The total capacitance of each net in the SPEF file must
+# be the sum of the capacitors touching that net in the flat SPICE
+# output, where the net is a group of nodes joined by resistors.
+#------------------------------------------------------------------------
+
+ext2spice default
+ext2spice cthresh 0
+ext2spice rthresh 0
+ext2spice extresist on
+
+ext2spice format spef
+ext2spice -o $scratch/rcnet.spef rcnet
+compareFiles "spef output" rcnet.spef $scratch/rcnet.spef
+
+ext2spice format dspf
+ext2spice -o $scratch/rcnet.dspf rcnet
+compareFiles "dspf output" rcnet.dspf $scratch/rcnet.dspf
+
+ext2spice format ngspice
+ext2spice -o $scratch/rcnet.spice rcnet
+
+# Group the SPICE nodes into nets through the resistors
+proc netOf {node} {
+    global parent
+    if {![info exists parent($node)]} {set parent($node) $node}
+    while {$parent($node) != $node} {set node $parent($node)}
+    return $node
+}
+foreach line [readStable $scratch/rcnet.spice] {
+    if {[regexp {^R\S*\s+(\S+)\s+(\S+)} $line -> n1 n2]} {
+	set parent([netOf $n1]) [netOf $n2]
+    }
+}
+foreach line [readStable $scratch/rcnet.spice] {
+    if {[regexp {^C\S*\s+(\S+)\s+(\S+)\s+(\S+)} $line -> n1 n2 v]} {
+	set value [spiceValue $v]
+	set nets [lsort -unique [list [netOf $n1] [netOf $n2]]]
+	foreach net $nets {
+	    if {$net == "0"} continue
+	    set spiceCap($net) [expr {[info exists spiceCap($net)] ? \
+			$spiceCap($net) + $value : $value}]
+	}
+    }
+}
+
+# Compare with the total of each net in the SPEF file
+set ok 1
+set why ""
+set section ""
+foreach line [readStable $scratch/rcnet.spef] {
+    if {[regexp {^\*([A-Z_]+)$} $line -> section]} continue
+    if {$section == "NAME_MAP" && [regexp {^\*(\d+) (\S+)$} $line -> num name]} {
+	set netName($num) $name
+    } elseif {[regexp {^\*D_NET \*(\d+) (\S+)} $line -> num total]} {
+	set net [netOf $netName($num)]
+	set sum [expr {[info exists spiceCap($net)] ? $spiceCap($net) : 0}]
+	if {abs($sum * 1e15 - $total) > 1e-6 * $total} {
+	    set ok 0
+	    append why "$netName($num): SPEF $total, SPICE [expr {$sum * 1e15}]  "
+	}
+    }
+}
+report "spef total capacitance matches spice" $ok $why
+
+#------------------------------------------------------------------------
+# Number formatting:  fmt.spice was written by ext2spice before values
+# were formatted without sprintf(), and the output must not change.
+# The coupling capacitors fall on both sides of each SI suffix boundary,
+# round up to the next decade (9.999996f becomes 10f), and lie on or
+# near a rounding boundary at the fifth decimal.  The x, y and l device
+# parameters, with a negative offset on l, give negative values, some
+# of which also round up to the next decade.
+#------------------------------------------------------------------------
+
+set oldScale [ext2spice scale]
+ext2spice default
+ext2spice cthresh 0
+ext2spice scale off
+ext2spice format ngspice
+ext2spice -o $scratch/fmt.spice fmt
+compareNetlists "number formatting" fmt.spice $scratch/fmt.spice
+ext2spice scale $oldScale
+
+#------------------------------------------------------------------------
+# Device merging:  merge.ext has twelve gate/source/drain triples of ten
+# fingers each, with two widths and the source and drain swapped on
+# every other finger.  merge_cons.spice and merge_aggr.spice were
+# written by ext2spice before merge candidates were found through a hash
+# table, and each finger must still go to the same merged device.
+#------------------------------------------------------------------------
+
+ext2spice default
+ext2spice cthresh 0
+ext2spice format ngspice
+foreach {m expect} {conservative merge_cons.spice aggressive merge_aggr.spice} {
+    ext2spice merge $m
+    ext2spice -o $scratch/$expect merge
+    compareNetlists "merge $m" $expect $scratch/$expect
+}
+ext2spice merge none
+
+#------------------------------------------------------------------------
+# Hierarchical output with "-j":  the cells of hier.ext are written by
+# several processes, each taking a batch of them, and the netlist must
+# be the same as with a single job.  Device merging is on, so that the
+# merge counts passed back by each job are used too, and the coupling
+# capacitors must come out in the same order.  The single job runs
+# last, so that "-j" is left at 1.
+#------------------------------------------------------------------------
+
+ext2spice default
+ext2spice cthresh 0
+ext2spice hierarchy on
+ext2spice merge conservative
+ext2spice format ngspice
+foreach j {3 2 1} {
+    ext2spice -j $j -o $scratch/hier_j$j.spice hier
+}
+foreach j {2 3} {
+    compareFiles "hierarchy with -j $j" $scratch/hier_j1.spice \
+		$scratch/hier_j$j.spice
+}
+ext2spice hierarchy off
+ext2spice merge none
+
+#------------------------------------------------------------------------
+
+file delete -force $scratch
+ext2spice default
+if {$failed > 0} {
+    puts "$failed check(s) failed."
+    exit 1
+}
+puts "All checks passed."
+quit -noprompt
@@ -15,6 +15,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>	/* for INFINITY */
+#include <unistd.h>	/* for fork(), _exit() */
 
 #ifdef MAGIC_WRAPPER
 #include "tcltk/tclmagic.h"
@@ -36,6 +37,7 @@
 #include "extract/extractInt.h"
 #include "select/select.h"
 #include "utils/malloc.h"
+#include "utils/workers.h"
 #include "cif/cif.h"		/* For CIFGetContactSize() */
 #include "cif/CIFint.h"		/* For CIFCurStyle */
 
@@ -44,7 +46,10 @@
 
 /* Forward declarations */
 int antennacheckArgs(int *pargc, char ***pargv);
-int antennacheckVisit(Dev *dev, HierContext *hc, float scale, Transform *trans, ClientData cdata); /* @typedef cb_extflat_visitdevs_t (CellUse *editUse) */
+int antennacheckVisit(Dev *dev, HierContext *hc, float scale, Transform *trans, ClientData cdata); /* @typedef cb_extflat_visitdevs_t (UNUSED) */
+void antennaSetup(void);
+void antennaCheckAll(CellUse *editUse);
+void antennaCheckGate(int gnum, CellUse *editUse);
 
 typedef struct {
 	TileTypeBitMask visitMask;
@@ -109,6 +114,57 @@ typedef struct _ams {
     CellDef *def;	/* CellDef for adding feedback */
 } AntennaMarkStruct;
 
+/* One gate node to be checked, collected by antennacheckVisit() so that
+ * the checks can be run in order, either here or in child processes.
+ */
+typedef struct _antgate {
+    Rect	 ag_rect;	/* Gate area, in edit cell coordinates */
+    TileType	 ag_type;	/* Magic tile type of the gate */
+    char	*ag_cell;	/* Use id or cell name, for debug output */
+} AntennaGate;
+
+static AntennaGate *antennaGates = NULL;
+static int antennaNumGates = 0;
+static int antennaMaxGates = 0;
+
+/* Values that depend only on the technology, computed once per run
+ * by antennaSetup() rather than once per gate.
+ */
+static TileTypeBitMask antennaGateMask;	/* All MOSFET gate types */
+static int antennaPlaneAt[PL_MAXTYPES + 1];	/* Plane of each plane order */
+static TileType antennaConAt[PL_MAXTYPES + 1];	/* Contact based on that
+						 * plane, or -1
+						 */
+
+/* A feedback area found by a child process, passed back to the parent */
+typedef struct _antmark {
+    Rect	 am_rect;
+    int		 am_pNum;
+} AntennaMark;
+
+/* Areas found on one plane of the yank copy of a gate's node.  These
+ * depend only on the copy, so each plane is searched once and the
+ * result reused for as long as the copy is kept from one plane order
+ * to the next.
+ */
+typedef struct _antplane {
+    dlong	*ap_area;	/* Area of each tile type on the plane */
+    Rect	 ap_r;		/* Any one visited rectangle, or GeoNullRect */
+} AntennaPlaneArea;
+
+/* If non-NULL, feedback areas are written here instead of being added */
+static FILE *antennaMarkF = NULL;
+
+/* A range of gates checked by one child process under "-j" */
+typedef struct _antjob {
+    int		 aj_first;	/* First gate of the range */
+    int		 aj_last;	/* One past the last gate */
+    FILE	*aj_marks;	/* AntennaMark records from the job */
+    FILE	*aj_out;	/* TxPrintf() output from the job */
+    FILE	*aj_err;	/* TxError() output from the job */
+    int		 aj_pid;	/* Process running the job, or 0 */
+} AntennaJob;
+
 
 /*
  * ----------------------------------------------------------------------------
@@ -253,14 +309,25 @@ runantennacheck:
 	if (EFDevTypes[i])
 	    EFDeviceTypes[i] = extGetDevType(EFDevTypes[i]);
 
+    /* Collect one gate per gate node, then check them in that order */
+    antennaNumGates = 0;
+    EFVisitDevs(antennacheckVisit, (ClientData) NULL);
+
     efGates = 0;
     TxPrintf("Running antenna checks.\n");
-    EFVisitDevs(antennacheckVisit, PTR2CD(editUse));
+    antennaSetup();
+    antennaCheckAll(editUse);
     EFFlatDone(NULL);
     EFDone(NULL);
 
     TxPrintf("antennacheck finished.\n");
     freeMagic(EFDeviceTypes);
+    if (antennaGates != NULL)
+    {
+	freeMagic(antennaGates);
+	antennaGates = NULL;
+	antennaMaxGates = 0;
+    }
     efAntennaDebug = FALSE;
 }
 
@@ -342,49 +409,32 @@ HierName *suffix;
  *
  * antennacheckVisit --
  *
- * Procedure to check for antenna violations from a single device.
- * Called by EFVisitDevs().
+ * Procedure to collect the gates to be checked for antenna violations.
+ * Called by EFVisitDevs().  Only the first gate found on each gate
+ * node is kept, since the connectivity search from any gate of the
+ * node covers the same material.
  *
  * Results:
  *	Returns 0 always.
  *
  * Side effects:
- *	May tag other device records to avoid double-counting devices.
- *	Generates feedback entries if an antenna violation is found.
+ *	Marks the gate node visited.  Adds an entry to antennaGates.
  *
  * ----------------------------------------------------------------------------
  */
 
-/* @typedef cb_extflat_visitdevs_t (CellUse *editUse) */
+/* @typedef cb_extflat_visitdevs_t (UNUSED) */
 int
 antennacheckVisit(
     Dev *dev,		/* Device being output */
     HierContext *hc,	/* Hierarchical context down to this device */
     float scale,	/* Scale transform for output */
     Transform *trans,	/* Coordinate transform */
-    ClientData cdata)	/* ClientData is edit cell use */
+    ClientData cdata)	/* Unused */
 {
-    CellUse *editUse = (CellUse *) CD2PTR(cdata);
     DevTerm *gate;
-    TileType t, conType;
-    int pos, pNum, pNum2, pmax, p, i, j, total;
-    dlong gatearea, diffarea;
-    double anttotal, conttotal;
-    float saveRatio, ratioTotal;
-    dlong *antennaarea;
-    Rect r, gaterect;
     EFNode *gnode;
-    SearchContext scx;
-    TileTypeBitMask gatemask, saveConMask;
-    bool antennaError;
-    HierName *hierName = hc->hc_hierName;
-
-    extern CellDef *extPathDef;	    /* see extract/ExtLength.c */
-    extern CellUse *extPathUse;	    /* see extract/ExtLength.c */
-
-    extern int  areaAccumFunc(), antennaAccumFunc(), areaMarkFunc();
-
-    antennaarea = (dlong *)mallocMagic(DBNumTypes * sizeof(dlong));
+    AntennaGate *ag;
 
     switch(dev->dev_class)
     {
@@ -392,355 +442,712 @@ antennacheckVisit(
 	case DEV_MOSFET:
 	case DEV_MSUBCKT:
 	case DEV_ASYMMETRIC:
-
-	    /* Procedure:
-	     *
-	     * 1.  If device gate node is marked visited, return.
-	     * 2.  Mark device gate node visited
-	     * 3.  For each plane from metal1 up (determined by planeorder):
-	     *   a.  Run DBTreeCopyConnect()
-	     *   b.  Accumulate gate area of connected devices
-	     *   c.  Accumulate diffusion area of connected devices
-	     *	 d.  Accumulate	metal area of connected devices
-	     *	 e.  Check against antenna ratio(s)
-	     *	 f.  Generate feedback if in violation of antenna rule
-	     *
-	     * NOTE: DBTreeCopyConnect() is used cumulatively, so that
-	     * additional searching only needs to be done for the additional
-	     * layer being searched.
-	     */
-
-	    GeoTransRect(trans, &dev->dev_rect, &r);
 	    gate = &dev->dev_terms[0];
-	    gnode = AntennaGetNode(hierName, gate->dterm_node->efnode_name->efnn_hier);
+	    gnode = AntennaGetNode(hc->hc_hierName,
+			gate->dterm_node->efnode_name->efnn_hier);
 	    if (gnode->efnode_client == (ClientData) NULL)
                 initNodeClient(gnode);
 	    if (beenVisited((nodeClient *)gnode->efnode_client, 0))
-	    {
-		freeMagic(antennaarea);
 		return 0;
-	    }
-	    else
-		markVisited((nodeClient *)gnode->efnode_client, 0);
-
-	    /* Diagnostic stuff */
-	    efGates++;
-	    if (efGates % 100 == 0) TxPrintf("   %d gates analyzed.\n", efGates);
-
-	    /* Diagnostic for debugging */
-	    /*
-	    TxPrintf("Gate %d : (%d %d) to (%d %d) net %s\n", efGates, r.r_xbot,
-		    r.r_ybot, r.r_xtop, r.r_ytop,
-		    gnode->efnode_name->efnn_hier->hn_name);
-	    */
-
-	    /* Find the plane of the gate type */
-	    t = EFDeviceTypes[dev->dev_type];
-	    pNum = DBPlane(t);
-	    pos = ExtCurStyle->exts_planeOrder[pNum];
-	    pmax = ++pos;
-
-	    /* Find the highest plane in the technology */
-	    for (p = PL_TECHDEPBASE; p < DBNumPlanes; p++)
-		if (ExtCurStyle->exts_planeOrder[p] > pmax)
-		    pmax = ExtCurStyle->exts_planeOrder[p];
-
-	    /* Create the yank cell if it doesn't already exist */
-	    if (extPathDef == (CellDef *) NULL)
-	        DBNewYank("__PATHYANK__", &extPathUse, &extPathDef);
-
-	    /* Use the cellDef reserved for extraction */
-	    /* DBCellClearDef(extPathDef); */	    /* See below */
-	    scx.scx_use = editUse;
-	    scx.scx_trans = GeoIdentityTransform;
-	    scx.scx_area = r;
-
-	    /* gatemask is a mask of all gate types for MOSFET devices	*/
-
-	    TTMaskZero(&gatemask);
-	    for (i = 0; i < DBNumTypes; i++)
+	    markVisited((nodeClient *)gnode->efnode_client, 0);
+
+	    if (antennaNumGates == antennaMaxGates)
 	    {
-		ExtDevice *ed;
-		char devclass;
+		AntennaGate *newgates;
 
-		if (ExtCurStyle->exts_device[i] != NULL)
+		antennaMaxGates = (antennaMaxGates == 0) ? 256 : antennaMaxGates * 2;
+		newgates = (AntennaGate *)mallocMagic(antennaMaxGates *
+				sizeof(AntennaGate));
+		if (antennaGates != NULL)
 		{
-		    for (ed = ExtCurStyle->exts_device[i]; ed; ed = ed->exts_next)
-		    {
-			devclass = ed->exts_deviceClass;
-			switch (devclass)
-			{
-			    case DEV_MOSFET:
-			    case DEV_FET:
-			    case DEV_ASYMMETRIC:
-			    case DEV_MSUBCKT:
-				TTMaskSetType(&gatemask, i);
-				break;
-			}
-		    }
+		    memcpy(newgates, antennaGates, antennaNumGates *
+				sizeof(AntennaGate));
+		    freeMagic(antennaGates);
 		}
+		antennaGates = newgates;
 	    }
+	    ag = &antennaGates[antennaNumGates++];
+	    GeoTransRect(trans, &dev->dev_rect, &ag->ag_rect);
+	    ag->ag_type = EFDeviceTypes[dev->dev_type];
+	    ag->ag_cell = (hc->hc_use->use_id) ? hc->hc_use->use_id :
+			hc->hc_use->use_def->def_name;
+	    break;
+    }
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaSetup --
+ *
+ * Compute the parts of the antenna check that depend only on the
+ * technology:  the mask of MOSFET gate types, and for each plane
+ * order the plane at that order and the contact type based on it.
+ * Also make sure that the yank cell used for connectivity searches
+ * exists.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets antennaGateMask, antennaPlaneAt[], and antennaConAt[].
+ *	May create extPathDef.
+ *
+ * ----------------------------------------------------------------------------
+ */
 
-	    for (; pos <= pmax; pos++)
+void
+antennaSetup(void)
+{
+    int i, p, pos, pNum2;
+
+    extern CellDef *extPathDef;	    /* see extract/ExtLength.c */
+    extern CellUse *extPathUse;	    /* see extract/ExtLength.c */
+
+    /* Create the yank cell if it doesn't already exist */
+    if (extPathDef == (CellDef *) NULL)
+	DBNewYank("__PATHYANK__", &extPathUse, &extPathDef);
+
+    /* antennaGateMask is a mask of all gate types for MOSFET devices */
+
+    TTMaskZero(&antennaGateMask);
+    for (i = 0; i < DBNumTypes; i++)
+    {
+	ExtDevice *ed;
+
+	for (ed = ExtCurStyle->exts_device[i]; ed; ed = ed->exts_next)
+	{
+	    switch (ed->exts_deviceClass)
 	    {
-		GateDiffAccumStruct gdas;
-		AntennaAccumStruct aas;
-		AntennaMarkStruct ams;
+		case DEV_MOSFET:
+		case DEV_FET:
+		case DEV_ASYMMETRIC:
+		case DEV_MSUBCKT:
+		    TTMaskSetType(&antennaGateMask, i);
+		    break;
+	    }
+	}
+    }
+
+    /* Find the plane of each plane order, and the tiletype which is a	*/
+    /* contact and whose base is that plane.  (NOTE:  Need to extend to	*/
+    /* all such contacts, as there may be more than one.)  An order	*/
+    /* with no plane keeps the plane of the order below it.		*/
+
+    pNum2 = 0;
+    for (pos = 0; pos <= PL_MAXTYPES; pos++)
+    {
+	for (p = 0; p < DBNumPlanes; p++)
+	    if (ExtCurStyle->exts_planeOrder[p] == pos)
+		pNum2 = p;
+	antennaPlaneAt[pos] = pNum2;
+
+	antennaConAt[pos] = -1;
+	for (i = 0; i < DBNumTypes; i++)
+	    if (DBIsContact(i) && DBPlane(i) == pNum2)
+	    {
+		antennaConAt[pos] = i;
+		break;
+	    }
+    }
+}
 
-		/* Find the plane of pos */
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaMark --
+ *
+ *	Record an area in violation of an antenna rule:  add a feedback
+ *	entry, or in a child process, pass the area back to the parent.
+ *
+ * ----------------------------------------------------------------------------
+ */
 
-		for (p = 0;  p < DBNumPlanes; p++)
-		    if (ExtCurStyle->exts_planeOrder[p] == pos)
-			pNum2 = p;
+void
+antennaMark(rect, pNum, def)
+    Rect *rect;
+    int pNum;
+    CellDef *def;
+{
+    AntennaMark am;
+    char msg[200];
 
-		/* Find the tiletype which is a contact and whose base is pNum2 */
-		/* (NOTE:  Need to extend to all such contacts, as there may be	*/
-		/* more than one.) (Also should find these types up top, not	*/
-		/* within the loop.)						*/
+    if (antennaMarkF != NULL)
+    {
+	am.am_rect = *rect;
+	am.am_pNum = pNum;
+	fwrite(&am, sizeof am, 1, antennaMarkF);
+	return;
+    }
+    sprintf(msg, "Antenna error at plane %s\n", DBPlaneLongNameTbl[pNum]);
+    DBWFeedbackAdd(rect, msg, def, 1, STYLE_PALEHIGHLIGHTS);
+}
 
-		/* Modify DBConnectTbl to limit connectivity to the plane   */
-		/* of the antenna check and below			    */
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaAlways1 --
+ *
+ *	Search function that stops the search at the first tile found.
+ *
+ * ----------------------------------------------------------------------------
+ */
 
-		conType = -1;
-		for (i = 0; i < DBNumTypes; i++)
-		    if (DBIsContact(i) && DBPlane(i) == pNum2)
-		    {
-			conType = i;
-			TTMaskZero(&saveConMask);
-			TTMaskSetMask(&saveConMask, &DBConnectTbl[i]);
-			TTMaskZero(&DBConnectTbl[i]);
-			for (j = 0; j < DBNumTypes; j++)
-			    if (TTMaskHasType(&saveConMask, j) &&
-					(DBPlane(j) <= pNum2))
-				TTMaskSetType(&DBConnectTbl[i], j);
-			break;
-		    }
+int
+antennaAlways1(
+    Tile *tile,
+    TileType dinfo,
+    ClientData clientdata)
+{
+    return 1;
+}
 
-	        for (i = 0; i < DBNumTypes; i++) antennaarea[i] = (dlong)0;
-	        gatearea = 0;
-	        diffarea = 0;
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaCheckGate --
+ *
+ * Check for antenna violations on the node of gate number 'gnum' in
+ * antennaGates.
+ *
+ * Procedure:
+ *
+ * For each plane from metal1 up (determined by planeorder):
+ *   a.  Run DBTreeCopyConnect()
+ *   b.  Accumulate gate area of connected devices
+ *   c.  Accumulate diffusion area of connected devices
+ *   d.  Accumulate metal area of connected devices
+ *   e.  Check against antenna ratio(s)
+ *   f.  Generate feedback if in violation of antenna rule
+ *
+ * The connectivity at one plane order differs from that at the next
+ * only through the contacts based on those two planes, whose entries
+ * in DBConnectTbl are restricted in turn.  So if the material copied
+ * for one plane order contains neither contact type, the copy is
+ * exact for the next order as well and is kept, saving the search.
+ * While the copy is kept, the tie-down and gate areas are kept too,
+ * and the antenna area of each plane is taken from planeArea[] rather
+ * than searched again.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Generates feedback entries (see antennaMark()) if an antenna
+ *	violation is found.  Uses extPathDef.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+antennaCheckGate(
+    int gnum,			/* Index into antennaGates */
+    CellUse *editUse)		/* Edit cell use */
+{
+    AntennaGate *ag = &antennaGates[gnum];
+    TileType t, conType, nextConType;
+    int pos, pNum, pNum2, pmax, p, i, j;
+    dlong gatearea, diffarea;
+    double anttotal, conttotal;
+    float saveRatio, ratioTotal;
+    dlong *antennaarea;
+    SearchContext scx;
+    TileTypeBitMask saveConMask, conMask;
+    bool antennaError, keepCopy;
+    GateDiffAccumStruct gdas;
+    AntennaAccumStruct aas;
+    AntennaMarkStruct ams;
+    AntennaPlaneArea *planeArea, *pa;
+    PlaneMask planesDone;
+    Rect antRect;
 
-		/* Note:  Ideally, the addition of material in the next	    */
-		/* metal plane is additive.  But that requires enumerating  */
-		/* all the vias and using those as starting points for the  */
-		/* next connectivity search, which needs to be coded.	    */
+    extern CellDef *extPathDef;	    /* see extract/ExtLength.c */
+    extern CellUse *extPathUse;	    /* see extract/ExtLength.c */
 
-		DBCellClearDef(extPathDef);
+    extern int  areaAccumFunc(), antennaAccumFunc(), areaMarkFunc();
 
-		/* To do:  Mark tiles so area count can be progressive */
+    /* Diagnostic stuff */
+    efGates = gnum + 1;
+    if (efGates % 100 == 0) TxPrintf("   %d gates analyzed.\n", efGates);
 
-		DBTreeCopyConnect(&scx, &DBConnectTbl[t], 0,
+    antennaarea = (dlong *)mallocMagic(DBNumTypes * sizeof(dlong));
+    planeArea = (AntennaPlaneArea *)mallocMagic(DBNumPlanes *
+		sizeof(AntennaPlaneArea));
+    for (p = 0; p < DBNumPlanes; p++)
+	planeArea[p].ap_area = (dlong *)mallocMagic(DBNumTypes * sizeof(dlong));
+
+    /* Find the plane of the gate type */
+    t = ag->ag_type;
+    pNum = DBPlane(t);
+    pos = ExtCurStyle->exts_planeOrder[pNum];
+    pmax = ++pos;
+
+    /* Find the highest plane in the technology */
+    for (p = PL_TECHDEPBASE; p < DBNumPlanes; p++)
+	if (ExtCurStyle->exts_planeOrder[p] > pmax)
+	    pmax = ExtCurStyle->exts_planeOrder[p];
+
+    scx.scx_use = editUse;
+    scx.scx_trans = GeoIdentityTransform;
+    scx.scx_area = ag->ag_rect;
+
+    keepCopy = FALSE;
+    planesDone = 0;
+    gatearea = diffarea = 0;
+    for (; pos <= pmax; pos++)
+    {
+	pNum2 = antennaPlaneAt[pos];
+	conType = antennaConAt[pos];
+
+	/* Modify DBConnectTbl to limit connectivity to the plane   */
+	/* of the antenna check and below			    */
+
+	if (conType >= 0)
+	{
+	    TTMaskZero(&saveConMask);
+	    TTMaskSetMask(&saveConMask, &DBConnectTbl[conType]);
+	    TTMaskZero(&DBConnectTbl[conType]);
+	    for (j = 0; j < DBNumTypes; j++)
+		if (TTMaskHasType(&saveConMask, j) &&
+			(DBPlane(j) <= pNum2))
+		    TTMaskSetType(&DBConnectTbl[conType], j);
+	}
+
+	for (i = 0; i < DBNumTypes; i++) antennaarea[i] = (dlong)0;
+
+	/* Note:  Ideally, the addition of material in the next	    */
+	/* metal plane is additive.  But that requires enumerating  */
+	/* all the vias and using those as starting points for the  */
+	/* next connectivity search, which needs to be coded.	    */
+
+	if (!keepCopy)
+	{
+	    DBCellClearDef(extPathDef);
+	    DBTreeCopyConnect(&scx, &DBConnectTbl[t], 0,
 			DBConnectTbl, &TiPlaneRect, SEL_NO_LABELS, extPathUse);
 
-		/* Search planes of tile types and accumulate all tiedown areas */
-		gdas.accum = (dlong)0;
-		for (p = 0;  p < DBNumPlanes; p++)
-		{
-		    gdas.pNum = p;
-		    DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[p],
-			    &TiPlaneRect, &ExtCurStyle->exts_antennaTieTypes,
-			    areaAccumFunc, (ClientData)&gdas);
-		}
-		diffarea = gdas.accum;
+	    /* Search planes of tile types and accumulate all tiedown areas */
+	    gdas.accum = (dlong)0;
+	    for (p = 0;  p < DBNumPlanes; p++)
+	    {
+		gdas.pNum = p;
+		DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[p],
+			&TiPlaneRect, &ExtCurStyle->exts_antennaTieTypes,
+			areaAccumFunc, (ClientData)&gdas);
+	    }
+	    diffarea = gdas.accum;
+
+	    /* Search plane of gate type and accumulate all gate area */
+	    gdas.accum = (dlong)0;
+	    gdas.pNum = pNum;
+	    DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[pNum],
+		    &TiPlaneRect, &antennaGateMask, areaAccumFunc,
+		    (ClientData)&gdas);
+	    gatearea = gdas.accum;
+
+	    /* No antenna areas of the new copy are known yet */
+	    planesDone = 0;
+	}
 
-		/* Search plane of gate type and accumulate all gate area */
-		gdas.accum = (dlong)0;
-		gdas.pNum = pNum;
-		DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[pNum],
-			&TiPlaneRect, &gatemask, areaAccumFunc, (ClientData)&gdas);
-		gatearea = gdas.accum;
+	/* Search metal planes and accumulate all antenna areas,    */
+	/* searching each plane of the copy only the first time.    */
+	antRect = GeoNullRect;
+	for (p = 0;  p < DBNumPlanes; p++)
+	{
+	    if (ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
+		if (p != pNum2) continue;
+	    if (ExtCurStyle->exts_planeOrder[p] > pos) continue;
 
-		/* Search metal planes and accumulate all antenna areas */
-		for (p = 0;  p < DBNumPlanes; p++)
-		{
-		    if (ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
-			if (p != pNum2) continue;
-
-		    aas.pNum = p;
-		    aas.accum = &antennaarea[0];
-		    if (ExtCurStyle->exts_planeOrder[p] <= pos)
-			DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[p],
-				&TiPlaneRect, &DBAllButSpaceAndDRCBits,
-				antennaAccumFunc, (ClientData)&aas);
-		}
+	    pa = &planeArea[p];
+	    if (!PlaneMaskHasPlane(planesDone, p))
+	    {
+		for (i = 0; i < DBNumTypes; i++) pa->ap_area[i] = (dlong)0;
+		aas.pNum = p;
+		aas.accum = pa->ap_area;
+		aas.r = GeoNullRect;
+		DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[p],
+			&TiPlaneRect, &DBAllButSpaceAndDRCBits,
+			antennaAccumFunc, (ClientData)&aas);
+		pa->ap_r = aas.r;
+		planesDone |= PlaneNumToMaskBit(p);
+	    }
+	    for (i = 0; i < DBNumTypes; i++)
+		antennaarea[i] += pa->ap_area[i];
+	    if (!GEO_RECTNULL(&pa->ap_r)) antRect = pa->ap_r;
+	}
+	aas.r = antRect;
 
-		antennaError = FALSE;
+	antennaError = FALSE;
 
-		if (diffarea == 0)
+	if (diffarea == 0)
+	{
+	    anttotal = 0.0;
+	    conttotal = 0.0;
+	    saveRatio = 0.0;
+	    for (i = 0; i < DBNumUserLayers; i++)
+	    {
+		if (ExtCurStyle->exts_antennaRatio[i].ratioGate > 0)
 		{
-		    anttotal = 0.0;
-		    conttotal = 0.0;
-		    saveRatio = 0.0;
-		    for (i = 0; i < DBNumUserLayers; i++)
-		    {
-			if (ExtCurStyle->exts_antennaRatio[i].ratioGate > 0)
-			{
-			    /* Partial model computes vias separately */
-			    if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
-					&& !DBIsContact(i))
-				anttotal += (double)antennaarea[i] /
-					(double)ExtCurStyle->exts_antennaRatio[i].ratioGate;
-			    else if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
-					&& (DBPlane(i) == pNum2))
-				conttotal += (double)antennaarea[i] /
-					(double)ExtCurStyle->exts_antennaRatio[i].ratioGate;
-			}
-			if (ExtCurStyle->exts_antennaRatio[i].ratioGate > saveRatio)
-			    saveRatio = ExtCurStyle->exts_antennaRatio[i].ratioGate;
-		    }
+		    /* Partial model computes vias separately */
+		    if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
+				&& !DBIsContact(i))
+			anttotal += (double)antennaarea[i] /
+				(double)ExtCurStyle->exts_antennaRatio[i].ratioGate;
+		    else if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
+				&& (DBPlane(i) == pNum2))
+			conttotal += (double)antennaarea[i] /
+				(double)ExtCurStyle->exts_antennaRatio[i].ratioGate;
+		}
+		if (ExtCurStyle->exts_antennaRatio[i].ratioGate > saveRatio)
+		    saveRatio = ExtCurStyle->exts_antennaRatio[i].ratioGate;
+	    }
 
-		    /* gatearea == 0 indicates that something went wrong---No device
-		     * of type "t" was found connected to this net.  This should be
-		     * reported as an error.  Avoid generating an antenna error with
-		     * infinite area ratio.
-		     */
-		    if ((gatearea > 0) && (anttotal > (double)gatearea))
-		    {
-			antennaError = TRUE;
-			if (efAntennaDebug == TRUE)
-			{
-			    if (hc->hc_use->use_id)
-				TxError("Cell: %s\n", hc->hc_use->use_id);
-			    else
-				TxError("Cell: %s\n", hc->hc_use->use_def->def_name);
-			    TxError("Antenna violation detected at plane %s\n",
-				    DBPlaneLongNameTbl[pNum2]);
-			    TxError("Effective antenna ratio %g > limit %g\n",
-				    saveRatio * (float)anttotal / (float)gatearea,
-				    saveRatio);
-			    TxError("Gate rect (%d %d) to (%d %d)\n",
-				    gdas.r.r_xbot, gdas.r.r_ybot,
-				    gdas.r.r_xtop, gdas.r.r_ytop);
-			    TxError("Antenna rect (%d %d) to (%d %d)\n",
-				    aas.r.r_xbot, aas.r.r_ybot,
-				    aas.r.r_xtop, aas.r.r_ytop);
-			}
-		    }
-		    if ((gatearea > 0) && (conttotal > (double)gatearea))
-		    {
-			antennaError = TRUE;
-			if (efAntennaDebug == TRUE)
-			{
-			    if (hc->hc_use->use_id)
-				TxError("Cell: %s\n", hc->hc_use->use_id);
-			    else
-				TxError("Cell: %s\n", hc->hc_use->use_def->def_name);
-			    TxError("Antenna violation detected at plane %s contact\n",
-				    DBPlaneLongNameTbl[pNum2]);
-			    TxError("Effective antenna ratio %g > limit %g\n",
-				    saveRatio * (float)conttotal / (float)gatearea,
-				    saveRatio);
-			    TxError("Gate rect (%d %d) to (%d %d)\n",
-				    gdas.r.r_xbot, gdas.r.r_ybot,
-				    gdas.r.r_xtop, gdas.r.r_ytop);
-			    TxError("Antenna rect (%d %d) to (%d %d)\n",
-				    aas.r.r_xbot, aas.r.r_ybot,
-				    aas.r.r_xtop, aas.r.r_ytop);
-			}
-		    }
+	    /* gatearea == 0 indicates that something went wrong---No device
+	     * of type "t" was found connected to this net.  This should be
+	     * reported as an error.  Avoid generating an antenna error with
+	     * infinite area ratio.
+	     */
+	    if ((gatearea > 0) && (anttotal > (double)gatearea))
+	    {
+		antennaError = TRUE;
+		if (efAntennaDebug == TRUE)
+		{
+		    TxError("Cell: %s\n", ag->ag_cell);
+		    TxError("Antenna violation detected at plane %s\n",
+			    DBPlaneLongNameTbl[pNum2]);
+		    TxError("Effective antenna ratio %g > limit %g\n",
+			    saveRatio * (float)anttotal / (float)gatearea,
+			    saveRatio);
+		    TxError("Gate rect (%d %d) to (%d %d)\n",
+			    gdas.r.r_xbot, gdas.r.r_ybot,
+			    gdas.r.r_xtop, gdas.r.r_ytop);
+		    TxError("Antenna rect (%d %d) to (%d %d)\n",
+			    aas.r.r_xbot, aas.r.r_ybot,
+			    aas.r.r_xtop, aas.r.r_ytop);
 		}
-		else
+	    }
+	    if ((gatearea > 0) && (conttotal > (double)gatearea))
+	    {
+		antennaError = TRUE;
+		if (efAntennaDebug == TRUE)
 		{
-		    anttotal = 0.0;
-		    conttotal = 0.0;
-		    saveRatio = 0.0;
-		    for (i = 0; i < DBNumUserLayers; i++)
-			if (ExtCurStyle->exts_antennaRatio[i].ratioDiffB != INFINITY)
-			{
-			    /* Compute effective gate ratio increased by diffusion area */
-			    ratioTotal = ExtCurStyle->exts_antennaRatio[i].ratioGate +
-			    		ExtCurStyle->exts_antennaRatio[i].ratioDiffB +
-					ExtCurStyle->exts_antennaRatio[i].ratioDiffA *
-					(double)diffarea;
-
-			    if (ratioTotal > 0)
-			    {
-			    	/* Partial model computes vias separately */
-			    	if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
-					&& !DBIsContact(i))
-				    anttotal += (double)antennaarea[i] / ratioTotal;
-			        else if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
-					&& (DBPlane(i) == pNum2))
-				    conttotal += (double)antennaarea[i] / ratioTotal;
-			    }
-			    if (ratioTotal > saveRatio)
-				saveRatio = ratioTotal;
-			}
+		    TxError("Cell: %s\n", ag->ag_cell);
+		    TxError("Antenna violation detected at plane %s contact\n",
+			    DBPlaneLongNameTbl[pNum2]);
+		    TxError("Effective antenna ratio %g > limit %g\n",
+			    saveRatio * (float)conttotal / (float)gatearea,
+			    saveRatio);
+		    TxError("Gate rect (%d %d) to (%d %d)\n",
+			    gdas.r.r_xbot, gdas.r.r_ybot,
+			    gdas.r.r_xtop, gdas.r.r_ytop);
+		    TxError("Antenna rect (%d %d) to (%d %d)\n",
+			    aas.r.r_xbot, aas.r.r_ybot,
+			    aas.r.r_xtop, aas.r.r_ytop);
+		}
+	    }
+	}
+	else
+	{
+	    anttotal = 0.0;
+	    conttotal = 0.0;
+	    saveRatio = 0.0;
+	    for (i = 0; i < DBNumUserLayers; i++)
+		if (ExtCurStyle->exts_antennaRatio[i].ratioDiffB != INFINITY)
+		{
+		    /* Compute effective gate ratio increased by diffusion area */
+		    ratioTotal = ExtCurStyle->exts_antennaRatio[i].ratioGate +
+		    		ExtCurStyle->exts_antennaRatio[i].ratioDiffB +
+				ExtCurStyle->exts_antennaRatio[i].ratioDiffA *
+				(double)diffarea;
 
-		    if (anttotal > (double)gatearea)
+		    if (ratioTotal > 0)
 		    {
-			antennaError = TRUE;
-			if (efAntennaDebug == TRUE)
-			{
-			    if (hc->hc_use->use_id)
-				TxError("Cell: %s\n", hc->hc_use->use_id);
-			    else
-				TxError("Cell: %s\n", hc->hc_use->use_def->def_name);
-			    TxError("Antenna violation detected at plane %s\n",
-		    			DBPlaneLongNameTbl[pNum2]);
-			    TxError("Effective antenna ratio %g > limit %g\n",
-				    saveRatio * (float)anttotal / (float)gatearea,
-				    saveRatio);
-			    TxError("Gate rect (%d %d) to (%d %d)\n",
-				    gdas.r.r_xbot, gdas.r.r_ybot,
-				    gdas.r.r_xtop, gdas.r.r_ytop);
-			    TxError("Antenna rect (%d %d) to (%d %d)\n",
-				    aas.r.r_xbot, aas.r.r_ybot,
-				    aas.r.r_xtop, aas.r.r_ytop);
-			}
-		    }
-		    if (conttotal > (double)gatearea)
-		    {
-			antennaError = TRUE;
-			if (efAntennaDebug == TRUE)
-			{
-			    if (hc->hc_use->use_id)
-				TxError("Cell: %s\n", hc->hc_use->use_id);
-			    else
-				TxError("Cell: %s\n", hc->hc_use->use_def->def_name);
-			    TxError("Antenna violation detected at plane %s contact\n",
-		    			DBPlaneLongNameTbl[pNum2]);
-			    TxError("Effective antenna ratio %g > limit %g\n",
-				    saveRatio * (float)conttotal / (float)gatearea,
-				    saveRatio);
-			    TxError("Gate rect (%d %d) to (%d %d)\n",
-				    gdas.r.r_xbot, gdas.r.r_ybot,
-				    gdas.r.r_xtop, gdas.r.r_ytop);
-			    TxError("Antenna rect (%d %d) to (%d %d)\n",
-				    aas.r.r_xbot, aas.r.r_ybot,
-				    aas.r.r_xtop, aas.r.r_ytop);
-			}
+		    	/* Partial model computes vias separately */
+		    	if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
+				&& !DBIsContact(i))
+			    anttotal += (double)antennaarea[i] / ratioTotal;
+		        else if ((ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
+				&& (DBPlane(i) == pNum2))
+			    conttotal += (double)antennaarea[i] / ratioTotal;
 		    }
+		    if (ratioTotal > saveRatio)
+			saveRatio = ratioTotal;
 		}
 
-		if (antennaError)
+	    if (anttotal > (double)gatearea)
+	    {
+		antennaError = TRUE;
+		if (efAntennaDebug == TRUE)
 		{
-		    /* Search plane of gate type and mark all gate areas */
-		    ams.def = editUse->cu_def;
-		    ams.pNum = pNum2;
-		    DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[pNum],
-			    &TiPlaneRect, &gatemask, areaMarkFunc, (ClientData)&ams);
-
-		    /* Search metal planes and accumulate all antenna areas */
-		    for (p = 0;  p < DBNumPlanes; p++)
-		    {
-			if (ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
-			    if (p != pNum2) continue;
-
-			if (ExtCurStyle->exts_planeOrder[p] <= pos)
-			    DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[p],
-				    &TiPlaneRect, &DBAllButSpaceAndDRCBits,
-				    areaMarkFunc, (ClientData)&ams);
-		    }
+		    TxError("Cell: %s\n", ag->ag_cell);
+		    TxError("Antenna violation detected at plane %s\n",
+	    			DBPlaneLongNameTbl[pNum2]);
+		    TxError("Effective antenna ratio %g > limit %g\n",
+			    saveRatio * (float)anttotal / (float)gatearea,
+			    saveRatio);
+		    TxError("Gate rect (%d %d) to (%d %d)\n",
+			    gdas.r.r_xbot, gdas.r.r_ybot,
+			    gdas.r.r_xtop, gdas.r.r_ytop);
+		    TxError("Antenna rect (%d %d) to (%d %d)\n",
+			    aas.r.r_xbot, aas.r.r_ybot,
+			    aas.r.r_xtop, aas.r.r_ytop);
 		}
+	    }
+	    if (conttotal > (double)gatearea)
+	    {
+		antennaError = TRUE;
+		if (efAntennaDebug == TRUE)
+		{
+		    TxError("Cell: %s\n", ag->ag_cell);
+		    TxError("Antenna violation detected at plane %s contact\n",
+	    			DBPlaneLongNameTbl[pNum2]);
+		    TxError("Effective antenna ratio %g > limit %g\n",
+			    saveRatio * (float)conttotal / (float)gatearea,
+			    saveRatio);
+		    TxError("Gate rect (%d %d) to (%d %d)\n",
+			    gdas.r.r_xbot, gdas.r.r_ybot,
+			    gdas.r.r_xtop, gdas.r.r_ytop);
+		    TxError("Antenna rect (%d %d) to (%d %d)\n",
+			    aas.r.r_xbot, aas.r.r_ybot,
+			    aas.r.r_xtop, aas.r.r_ytop);
+		}
+	    }
+	}
 
-		/* Put the connect table back the way it was */
-		if (conType >= 0)
-		    TTMaskSetMask(&DBConnectTbl[conType], &saveConMask);
+	if (antennaError)
+	{
+	    /* Search plane of gate type and mark all gate areas */
+	    ams.def = editUse->cu_def;
+	    ams.pNum = pNum2;
+	    DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[pNum],
+		    &TiPlaneRect, &antennaGateMask, areaMarkFunc, (ClientData)&ams);
+
+	    /* Search metal planes and accumulate all antenna areas */
+	    for (p = 0;  p < DBNumPlanes; p++)
+	    {
+		if (ExtCurStyle->exts_antennaModel & ANTENNAMODEL_PARTIAL)
+		    if (p != pNum2) continue;
+
+		if (ExtCurStyle->exts_planeOrder[p] <= pos)
+		    DBSrPaintArea((Tile *)NULL, extPathUse->cu_def->cd_planes[p],
+			    &TiPlaneRect, &DBAllButSpaceAndDRCBits,
+			    areaMarkFunc, (ClientData)&ams);
 	    }
+	}
+
+	/* Put the connect table back the way it was */
+	if (conType >= 0)
+	    TTMaskSetMask(&DBConnectTbl[conType], &saveConMask);
+
+	/* Keep the copied material for the next plane order if neither */
+	/* contact type whose connectivity changes is in it.		*/
+
+	keepCopy = TRUE;
+	nextConType = (pos < pmax) ? antennaConAt[pos + 1] : -1;
+	for (i = 0; i < 2; i++)
+	{
+	    TileType ct = (i == 0) ? conType : nextConType;
+
+	    if (ct < 0) continue;
+	    TTMaskSetOnlyType(&conMask, ct);
+	    if (DBSrPaintArea((Tile *)NULL,
+			extPathUse->cu_def->cd_planes[DBPlane(ct)],
+			&TiPlaneRect, &conMask, antennaAlways1,
+			(ClientData)NULL))
+		keepCopy = FALSE;
+	}
     }
+    for (p = 0; p < DBNumPlanes; p++)
+	freeMagic(planeArea[p].ap_area);
+    freeMagic(planeArea);
     freeMagic(antennaarea);
-    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaJobCopy --
+ *
+ *	Copy the text output of a child process to TxPrintf() (if 'err'
+ *	is FALSE) or TxError() (if 'err' is TRUE), then close the file.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+antennaJobCopy(
+    FILE *tmpf,
+    bool err)
+{
+    char buf[8192];
+    size_t n;
+
+    rewind(tmpf);
+    while ((n = fread(buf, 1, sizeof buf - 1, tmpf)) > 0)
+    {
+	buf[n] = '\0';
+	if (err)
+	    TxError("%s", buf);
+	else
+	    TxPrintf("%s", buf);
+    }
+    fclose(tmpf);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaJobFinish --
+ *
+ * Wait for the process running 'job', if any, then add its feedback
+ * entries and print its output.  Jobs are finished in order, so that
+ * the results are the same as checking every gate in this process.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Adds feedback.  Closes the job's temporary files.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+antennaJobFinish(
+    AntennaJob *job,
+    CellDef *def)
+{
+    AntennaMark am;
+    int status;
+
+    if (job->aj_pid > 0)
+    {
+	if ((WaitPid(job->aj_pid, &status) < 0) || (status != 0))
+	    TxError("Error checking gates %d to %d in a child process.\n",
+			job->aj_first + 1, job->aj_last);
+	job->aj_pid = 0;
+    }
+
+    antennaJobCopy(job->aj_out, FALSE);
+    antennaJobCopy(job->aj_err, TRUE);
+
+    rewind(job->aj_marks);
+    while (fread(&am, sizeof am, 1, job->aj_marks) == 1)
+	antennaMark(&am.am_rect, am.am_pNum, def);
+    fclose(job->aj_marks);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * antennaCheckAll --
+ *
+ * Check every gate collected in antennaGates.  With "-j" asking for
+ * more than one job, the gates are split into consecutive ranges that
+ * are checked by child processes, each working on its own copy of the
+ * layout and of the yank cell, so that the searches need no locking.
+ * The results are collected in gate order, so the feedback entries
+ * and messages come out exactly as they would from a single process.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Generates feedback entries for antenna violations.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+antennaCheckAll(
+    CellUse *editUse)
+{
+    AntennaJob *jobs, *job;
+    int nproc, njobs, running, next, i, g, pid;
+
+    nproc = WorkerCount(EFThreads);
+    if ((nproc <= 1) || (antennaNumGates < 2))
+    {
+	for (g = 0; g < antennaNumGates; g++)
+	    antennaCheckGate(g, editUse);
+	return;
+    }
+
+    /* Several ranges per process keep the processes evenly loaded */
+    njobs = MIN(antennaNumGates, nproc * 4);
+    jobs = (AntennaJob *)mallocMagic(njobs * sizeof(AntennaJob));
+    for (i = 0; i < njobs; i++)
+    {
+	job = &jobs[i];
+	job->aj_first = (int)(((dlong)antennaNumGates * i) / njobs);
+	job->aj_last = (int)(((dlong)antennaNumGates * (i + 1)) / njobs);
+	job->aj_pid = 0;
+	job->aj_marks = tmpfile();
+	job->aj_out = (job->aj_marks) ? tmpfile() : NULL;
+	job->aj_err = (job->aj_out) ? tmpfile() : NULL;
+	if (job->aj_err == NULL)
+	{
+	    /* Can't make the files:  check everything here instead */
+	    if (job->aj_marks) fclose(job->aj_marks);
+	    if (job->aj_out) fclose(job->aj_out);
+	    while (--i >= 0)
+	    {
+		fclose(jobs[i].aj_marks);
+		fclose(jobs[i].aj_out);
+		fclose(jobs[i].aj_err);
+	    }
+	    freeMagic(jobs);
+	    for (g = 0; g < antennaNumGates; g++)
+		antennaCheckGate(g, editUse);
+	    return;
+	}
+    }
+
+    running = 0;
+    next = 0;
+    for (i = 0; i < njobs; i++)
+    {
+	job = &jobs[i];
+	while (running >= nproc)
+	{
+	    if (jobs[next].aj_pid > 0) running--;
+	    antennaJobFinish(&jobs[next++], editUse->cu_def);
+	}
+
+	TxFlush();
+	FORK_f(pid);
+	if (pid == 0)
+	{
+	    TxDivert(job->aj_out, job->aj_err);
+	    antennaMarkF = job->aj_marks;
+	    for (g = job->aj_first; g < job->aj_last; g++)
+		antennaCheckGate(g, editUse);
+	    fflush(job->aj_marks);
+	    fflush(job->aj_out);
+	    fflush(job->aj_err);
+	    _exit(0);
+	}
+	else if (pid < 0)
+	{
+	    /* Could not fork:  finish the earlier jobs, then do this one */
+	    for (; next < i; next++)
+		antennaJobFinish(&jobs[next], editUse->cu_def);
+	    running = 0;
+	    for (g = job->aj_first; g < job->aj_last; g++)
+		antennaCheckGate(g, editUse);
+	}
+	else
+	{
+	    job->aj_pid = pid;
+	    running++;
+	}
+    }
+    while (next < njobs)
+	antennaJobFinish(&jobs[next++], editUse->cu_def);
+
+    efGates = antennaNumGates;
+    freeMagic(jobs);
 }
 
 /*
@@ -760,11 +1167,9 @@ areaMarkFunc(tile, dinfo, ams)
     AntennaMarkStruct *ams;
 {
     Rect rect;
-    char msg[200];
 
     TiToRect(tile, &rect);
-    sprintf(msg, "Antenna error at plane %s\n", DBPlaneLongNameTbl[ams->pNum]);
-    DBWFeedbackAdd(&rect, msg, ams->def, 1, STYLE_PALEHIGHLIGHTS);
+    antennaMark(&rect, ams->pNum, ams->def);
     return 0;
 }
 
@@ -48,6 +48,7 @@ EFCapValue EFCapThreshold = 2;  /* -c/-C: (fF) smallest interesting C */
 int EFResistThreshold = 10;	/* -r/-R: (Ohms) smallest interesting R */
 int EFOutputFlags = 0;		/* -t: output of nodename trailing #!'s */
 char *EFSearchPath = NULL;	/* -p: Search path for .ext files */
+int EFThreads = 1;		/* -j: Number of concurrent jobs */
 char *EFArgTech = NULL;		/* -T: Tech specified on command line */
 
     /* Misc globals */
@@ -107,6 +108,11 @@ extern void efLoadSearchPath();
  *
  *	-T techname	Specify the name of the technology, leaving
  *			EFArgTech pointing to the technology name.
+ *	-j nthreads	Read the .ext files of the hierarchy using up
+ *			to 'nthreads' concurrent readers (0 means one
+ *			per processor) before building the defs.  Also
+ *			the number of subcircuits that hierarchical
+ *			ext2spice writes at the same time.
  *	-p path		Use the colon-separated search path 'path'
  *			for finding .ext files.  Overrides any paths
  *			found in .magicrc files.
@@ -158,7 +164,8 @@ EFArgs(argc, argv, err_result, argsProc, cdata)
 
     const char usage_text[] =
 	"Standard arguments: [-R] [-C] [-r rthresh] [-c cthresh] [-v]\n"
-		"[-p searchpath] [-s sym=value] [-S symfile] [-t trimchars]\n"
+		"[-j nthreads] [-p searchpath] [-s sym=value] [-S symfile]\n"
+		"[-t trimchars] "
 #ifdef MAGIC_WRAPPER
 		"[rootfile]\n";
 #else
@@ -167,11 +174,6 @@ EFArgs(argc, argv, err_result, argsProc, cdata)
 
     if (err_result != NULL) *err_result = FALSE;
 
-    /* Hash table of nodes we're going to watch if -N given */
-    HashInitClient(&efWatchTable, 32, HT_CLIENTKEYS,
-	efHNCompare, (char *(*)()) NULL,
-	efHNHash, (int (*)()) NULL);
-
     /* Process command line options */
     for (argc--, argv++; argc-- > 0; argv++)
     {
@@ -194,6 +196,11 @@ EFArgs(argc, argv, err_result, argsProc, cdata)
 		    goto usage;
 		EFCapThreshold = atoCap(cp);	/* Femtofarads */
 		break;
+	    case 'j':
+		if ((cp = ArgStr(&argc, &argv, "thread count")) == NULL)
+		    goto usage;
+		EFThreads = atoi(cp);
+		break;
 	    case 'p':
 		cp = ArgStr(&argc, &argv, "search path");
 		if (cp == NULL)
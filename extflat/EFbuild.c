@@ -193,7 +193,6 @@ efBuildNode(def, isSubsnode, isDevSubsnode, isExtNode, nodeName, nodeCap,
 			    knn->efnn_node->efnode_name = nodeAlias->efnn_next;
 			else
 			    lastAlias->efnn_next = nodeAlias->efnn_next;
-			EFHNFree(nodeAlias->efnn_hier, (HierName *)NULL, HN_ALLOC);
 			freeMagic(nodeAlias);
 			break;
 		    }
@@ -468,14 +467,10 @@ efBuildDist(def, driver, receiver, min, max)
     {
 	/*
 	 * There was already an entry in the table; update it
-	 * to reflect new minimum and maximum distances.  We
-	 * can free the keys since they were already in the
-	 * table.
+	 * to reflect new minimum and maximum distances.
 	 */
 	dist->dist_min = MIN(dist->dist_min, min);
 	dist->dist_max = MAX(dist->dist_max, max);
-	EFHNFree(hn1, (HierName *) NULL, HN_ALLOC);
-	EFHNFree(hn2, (HierName *) NULL, HN_ALLOC);
     }
     else
     {
@@ -2462,20 +2457,18 @@ efFreeDevTable(table)
  *
  * efFreeNodeTable --
  *
- * Free the EFNodeNames (and the HierNames they point to) pointed to by
- * the entries in the HashTable 'table'.  Each EFNodeName is assumed to
- * be pointed to by exactly one HashEntry, but each HierName can be
- * pointed to by many entries (some of which may be in other HashTables).
- * As a result, the HierNames aren't freed here; instead, an entry is
- * added to efFreeHashTable for each HierName encountered.  Everything
- * is then freed at the end by EFDone().
+ * Free the EFNodeNames pointed to by the entries in the HashTable
+ * 'table'.  Each EFNodeName is assumed to be pointed to by exactly one
+ * HashEntry, but each HierName can be pointed to by many entries (some
+ * of which may be in other HashTables) and is shared with other names.
+ * As a result, the HierNames aren't freed here;  they are all freed at
+ * the end by EFDone().
  *
  * Results:
  *	None.
  *
  * Side effects:
  *	Frees memory.
- *	Adds an entry to hnTable for each HierName.
  *
  * ----------------------------------------------------------------------------
  */
@@ -2486,16 +2479,12 @@ efFreeNodeTable(table)
 {
     HashSearch hs;
     HashEntry *he;
-    HierName *hn;
     EFNodeName *nn;
 
     HashStartSearch(&hs);
     while ((he = HashNext(table, &hs)))
 	if ((nn = (EFNodeName *) HashGetValue(he)))
 	{
-	    for (hn = nn->efnn_hier; hn; hn = hn->hn_parent)
-		(void) HashFind(&efFreeHashTable, (char *) hn);
-
 	    /* Node equivalences made by "equiv" statements are	handled	*/
 	    /* by reference count.  Don't free the node structure until	*/
 	    /* all references have been seen.				*/
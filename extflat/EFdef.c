@@ -41,9 +41,6 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 /* Def hash table itself; maps from def names into pointers to Defs */
 HashTable efDefHashTable;
 
-/* Hash table used for checking for malloc leaks */
-HashTable efFreeHashTable;
-
 /* Hash table used for keeping subcircuit parameter names for a device */
 HashTable efDevParamTable;
 
@@ -70,10 +67,15 @@ EFInit()
     EFDevNumTypes = 0;
     EFCompat = TRUE;
 
-    HashInit(&efFreeHashTable, 32, HT_WORDKEYS);
     HashInit(&efDefHashTable, INITDEFSIZE, 0);
     HashInit(&efDevParamTable, 8, HT_STRINGKEYS);
     efSymInit();
+
+    /* Hash table of nodes we're going to watch if -n or -N given */
+    HashInitClient(&efWatchTable, 32, HT_CLIENTKEYS,
+	efHNCompare, (char *(*)()) NULL,
+	efHNHash, (int (*)()) NULL);
+    efWatchNodes = FALSE;
 }
 
 /*
@@ -125,11 +127,9 @@ EFDone(func)
 	efConnPointFreeLinkedList(def->def_connpts);
 
 	free_magic1_t mm1 = freeMagic1_init();
+	/* kill_name is interned and released by efHNFreeAll() below */
 	for (kill = def->def_kills; kill; kill = kill->kill_next)
-	{
-	    freeMagic(kill->kill_name);
 	    freeMagic1(&mm1, (char *) kill);
-	}
 	freeMagic1_end(&mm1);
 	freeMagic((char *) def);
     }
@@ -165,13 +165,12 @@ EFDone(func)
     }
     HashKill(&efDevParamTable);
 
-    HashStartSearch(&hs);
-    while ((he = HashNext(&efFreeHashTable, &hs)))
-    {
-	/* Keys of this table are entries to be free'd */
-	freeMagic((void *)he->h_key.h_ptr);
-    }
-    HashKill(&efFreeHashTable);
+    /* The watched names are HierNames, so they go first */
+    HashKill(&efWatchTable);
+    efWatchNodes = FALSE;
+
+    /* All HierNames are freed together */
+    efHNFreeAll();
 
     /* Final cleanup */
     HashKill(&efDefHashTable);
@@ -119,10 +119,6 @@ EFFlatBuild(name, flags)
     /* Keyed by pairs of EFNode pointers (i.e., EFCoupleKeys) */
     HashInit(&efCapHashTable, INITFLATSIZE, HashSize(sizeof (EFCoupleKey)));
 
-    /* Keyed by a string and a HierName */
-    HashInitClient(&efHNUseHashTable, INITFLATSIZE, HT_CLIENTKEYS,
-	efHNUseCompare, (char *(*)()) NULL, efHNUseHash, (int (*)()) NULL);
-
     /* Circular list of all nodes contains no elements initially */
     efNodeList.efnode_next = (EFNodeHdr *) &efNodeList;
     efNodeList.efnode_prev = (EFNodeHdr *) &efNodeList;
@@ -203,10 +199,6 @@ EFFlatBuildOneLevel(def, flags)
     /* Keyed by pairs of EFNode pointers (i.e., EFCoupleKeys) */
     HashInit(&efCapHashTable, INITFLATSIZE, HashSize(sizeof (EFCoupleKey)));
 
-    /* Keyed by a string and a HierName */
-    HashInitClient(&efHNUseHashTable, INITFLATSIZE, HT_CLIENTKEYS,
-	efHNUseCompare, (char *(*)()) NULL, efHNUseHash, (int (*)()) NULL);
-
     /* Circular list of all nodes contains no elements initially */
     efNodeList.efnode_next = (EFNodeHdr *) &efNodeList;
     efNodeList.efnode_prev = (EFNodeHdr *) &efNodeList;
@@ -277,7 +269,6 @@ EFFlatDone(func)
     HashFreeKill(&efCapHashTable);
     HashKill(&efNodeHashTable);
     HashKill(&efDistHashTable);
-    HashKill(&efHNUseHashTable);
     return;
 }
 
@@ -556,8 +547,6 @@ efAddNodes(
 	     */
 	    if ((oldname = (EFNodeName *) HashGetValue(he)))
 	    {
-		if (hierName != nn->efnn_hier)
-		    EFHNFree(hierName, hc->hc_hierName, HN_CONCAT);
 		if (oldname->efnn_node != newnode)
 		    efNodeMerge(&oldname->efnn_node, &newnode);
 		newnode = oldname->efnn_node;
@@ -831,10 +820,7 @@ efFlatGlob(void)
 	    nodeFlat->efnode_name = nameGlob;
 	}
 	else
-	{
 	    freeMagic((char *) nameGlob);
-	    EFHNFree(hnGlob, (HierName *) NULL, HN_GLOBAL);
-	}
     }
 
     HashKill(&globalTable);
@@ -890,18 +876,8 @@ char *
 efFlatGlobCopy(hierName)
     HierName *hierName;
 {
-    HierName *hNew;
-    int size;
-
-    size = HIERNAMESIZE(strlen(hierName->hn_name));
-    hNew = (HierName *) mallocMagic((unsigned)(size));
-    (void) strcpy(hNew->hn_name, hierName->hn_name);
-    hNew->hn_parent = (HierName *) NULL;
-    hNew->hn_hash = hierName->hn_hash;
-    if (efHNStats)
-	efHNRecord(size, HN_GLOBAL);
-
-    return (char *) hNew;
+    return (char *) efHNIntern((HierName *) NULL, hierName->hn_name,
+		strlen(hierName->hn_name), hierName->hn_hash, HN_GLOBAL);
 }
 
 int
@@ -1185,8 +1161,6 @@ efFlatDists(hc)
 	     */
 	    distFlat->dist_min = dist->dist_min;
 	    distFlat->dist_max = dist->dist_max;
-	    EFHNFree(distKey.dist_1, hc->hc_hierName, HN_CONCAT);
-	    EFHNFree(distKey.dist_2, hc->hc_hierName, HN_CONCAT);
 	}
 	else
 	{
@@ -22,6 +22,7 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #endif  /* not lint */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "utils/magic.h"
@@ -648,6 +649,82 @@ efHierVisitResists(
     return 0;
 }
 
+/* A coupling capacitor, with the positions of its two nodes in
+ * efNodeList (see EFHierVisitCaps()).
+ */
+
+typedef struct
+{
+    int		 hc_pos1, hc_pos2;	/* Positions, hc_pos1 < hc_pos2 */
+    EFNode	*hc_node1, *hc_node2;
+    EFCapValue	 hc_cap;
+} EFHierCap;
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHierCapCompare --
+ *
+ * qsort() comparison for EFHierCaps, by the positions of their nodes.
+ *
+ * Results:
+ *	Negative, zero or positive as c1 sorts before, with, or after c2.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static int
+efHierCapCompare(p1, p2)
+    const void *p1, *p2;
+{
+    const EFHierCap *c1 = (const EFHierCap *) p1;
+    const EFHierCap *c2 = (const EFHierCap *) p2;
+
+    if (c1->hc_pos1 != c2->hc_pos1)
+	return (c1->hc_pos1 < c2->hc_pos1) ? -1 : 1;
+    if (c1->hc_pos2 != c2->hc_pos2)
+	return (c1->hc_pos2 < c2->hc_pos2) ? -1 : 1;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHierNodePos --
+ *
+ * Look up the position of a node in efNodeList, as numbered by
+ * EFHierVisitCaps().  A node not in the list (which should not
+ * happen) is numbered after all the others.
+ *
+ * Results:
+ *	The position of the node.
+ *
+ * Side effects:
+ *	May add the node to 'posTable' and increment *pnpos.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static int
+efHierNodePos(posTable, node, pnpos)
+    HashTable *posTable;
+    EFNode *node;
+    int *pnpos;
+{
+    HashEntry *he;
+
+    he = HashLookOnly(posTable, (char *) node);
+    if (he == NULL)
+    {
+	he = HashFind(posTable, (char *) node);
+	HashSetValue(he, INT2CD((*pnpos)++));
+    }
+    return (int) CD2INT(HashGetValue(he));
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -667,6 +744,12 @@ efHierVisitResists(
  *
  * Here cap is the capacitance in attofarads.
  *
+ * efCapHashTable is keyed by node pointers, so a search through it
+ * returns the capacitors in an order that depends on where the nodes
+ * were allocated.  That differs between the processes writing
+ * subcircuits with "ext2spice -j", so the capacitors are visited in
+ * the order of their nodes in efNodeList instead, lower node first.
+ *
  * Results:
  *	Returns 1 if the client procedure returned 1;
  *	otherwise returns 0.
@@ -685,24 +768,63 @@ EFHierVisitCaps(hc, capProc, cdata)
 {
     HashSearch hs;
     HashEntry *he;
+    HashTable posTable;
     EFCoupleKey *ck;
-    EFCapValue ccap;
+    EFNodeHdr *nh;
+    EFHierCap *caps, *cp;
+    int ncaps, npos, pos1, pos2, n, result;
 
     /* Visit capacitors flattened from a lower level, as well	*/
     /* as our own.  These have been created and saved in	*/
     /* efCapHashTable using efFlatCaps().			*/
 
+    ncaps = HashGetNumEntries(&efCapHashTable);
+    if (ncaps == 0) return 0;
+
+    /* Number the nodes in list order */
+    HashInit(&posTable, 256, HT_WORDKEYS);
+    npos = 0;
+    for (nh = efNodeList.efnode_next; nh != (EFNodeHdr *) &efNodeList;
+		nh = nh->efnhdr_next)
+	HashSetValue(HashFind(&posTable, (char *) nh), INT2CD(npos++));
+
+    caps = (EFHierCap *) mallocMagic(ncaps * sizeof (EFHierCap));
+    n = 0;
     HashStartSearch(&hs);
     while ((he = HashNext(&efCapHashTable, &hs)))
     {
-	ccap = CapHashGetValue(he);
 	ck = (EFCoupleKey *) he->h_key.h_words;
-	if ((*capProc)(hc, ck->ck_1->efnode_name->efnn_hier,
-			ck->ck_2->efnode_name->efnn_hier,
-			(double) ccap, cdata))
-	    return 1;
+	pos1 = efHierNodePos(&posTable, ck->ck_1, &npos);
+	pos2 = efHierNodePos(&posTable, ck->ck_2, &npos);
+	cp = &caps[n++];
+	cp->hc_cap = CapHashGetValue(he);
+	if (pos1 < pos2)
+	{
+	    cp->hc_pos1 = pos1, cp->hc_node1 = ck->ck_1;
+	    cp->hc_pos2 = pos2, cp->hc_node2 = ck->ck_2;
+	}
+	else
+	{
+	    cp->hc_pos1 = pos2, cp->hc_node1 = ck->ck_2;
+	    cp->hc_pos2 = pos1, cp->hc_node2 = ck->ck_1;
+	}
     }
-    return 0;
+    HashKill(&posTable);
+    qsort(caps, n, sizeof (EFHierCap), efHierCapCompare);
+
+    result = 0;
+    for (cp = caps; cp < caps + n; cp++)
+    {
+	if ((*capProc)(hc, cp->hc_node1->efnode_name->efnn_hier,
+			cp->hc_node2->efnode_name->efnn_hier,
+			(double) cp->hc_cap, cdata))
+	{
+	    result = 1;
+	    break;
+	}
+    }
+    freeMagic((char *) caps);
+    return result;
 }
 
 /*
@@ -273,10 +273,8 @@ extern bool efScaleChanged;	/* If TRUE, multiply all dimensions by scale
 extern int efResists[];		/* Resistance per square for each class */
 extern bool efResistChanged;	/* TRUE if some cells' resistclasses unequal */
 
-extern HashTable efFreeHashTable;
 extern HashTable efNodeHashTable;
 extern HashTable efDevParamTable;
-extern HashTable efHNUseHashTable;
 extern HashTable efCapHashTable;
 extern HashTable efDistHashTable;
 extern HashTable efWatchTable;
@@ -305,9 +303,13 @@ extern char *efHNDistCopy();
 extern int efHNDistHash();
 extern void efHNDistKill();
 
-    /* Functions for hashing of use id HierNames */
-extern bool efHNUseCompare();
-extern int efHNUseHash();
+    /* HierName interning */
+extern HierName *efHNIntern();
+extern HierName *efHNInternStr();
+extern HierName *efHNFind();
+extern HierName *efHNFindStr();
+extern HierName *efHNConcatFind();
+extern void efHNFreeAll();
 
 extern EFCapValue CapHashGetValue();
 extern void CapHashSetValue();
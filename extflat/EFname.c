@@ -52,14 +52,30 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 HashTable efNodeHashTable;
 
 /*
- * Hash table used by efHNFromUse to ensure that it always returns
- * a pointer to the SAME HierName structure each time it is called
- * with the same fields.
+ * HierNames are interned:  there is only ever one HierName with a
+ * given parent and component string, so names with a common prefix
+ * share the HierNames for that prefix, and asking for the same name
+ * twice returns the same pointer.  The interned HierNames are kept in
+ * an open-addressed table of pointers keyed by (hn_parent, hn_name),
+ * and are carved out of large arena chunks rather than malloc'd one
+ * at a time.  They are never freed individually;  EFDone() releases
+ * all of them at once with efHNFreeAll().
  */
-HashTable efHNUseHashTable;
+static HierName **efHNInternSlots = NULL;	/* Open-addressed table */
+static unsigned efHNInternSize = 0;		/* Slots (a power of 2) */
+static unsigned efHNInternCount = 0;		/* Slots in use */
+static unsigned efHNInternShared = 0;		/* Requests already interned */
+
+#define	HN_INTERN_INITSIZE	4096
+
+static char *efHNArenaChunks = NULL;	/* Chunks, linked through 1st word */
+static char *efHNArenaNext = NULL;	/* Next free byte in current chunk */
+static char *efHNArenaEnd = NULL;	/* End of current chunk */
+static size_t efHNArenaBytes = 0;	/* Total bytes in all chunks */
+
+#define	HN_ARENA_CHUNK		(64 * 1024)
+#define	HN_ARENA_ALIGN(n)	(((n) + sizeof (char *) - 1) & ~(sizeof (char *) - 1))
 
-extern void EFHNFree();
-extern void efHNInit();
 extern void efHNRecord();
 
 
@@ -153,19 +169,360 @@ EFHNIsGND(hierName)
 }
 
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNAlloc --
+ *
+ * Allocate 'size' bytes for a HierName from the HierName arena.
+ *
+ * Results:
+ *	Pointer to the (pointer-aligned) storage.
+ *
+ * Side effects:
+ *	May allocate a new arena chunk.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HierName *
+efHNAlloc(size)
+    unsigned size;
+{
+    char *chunk, *mem;
+    size_t chunkSize;
+
+    size = HN_ARENA_ALIGN(size);
+    if (efHNArenaNext == NULL || efHNArenaNext + size > efHNArenaEnd)
+    {
+	chunkSize = HN_ARENA_ALIGN(sizeof (char *)) + size;
+	if (chunkSize < HN_ARENA_CHUNK) chunkSize = HN_ARENA_CHUNK;
+	chunk = (char *) mallocMagic(chunkSize);
+	*((char **) chunk) = efHNArenaChunks;
+	efHNArenaChunks = chunk;
+	efHNArenaNext = chunk + HN_ARENA_ALIGN(sizeof (char *));
+	efHNArenaEnd = chunk + chunkSize;
+	efHNArenaBytes += chunkSize;
+    }
+    mem = efHNArenaNext;
+    efHNArenaNext += size;
+    return (HierName *) mem;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNInternSlot --
+ *
+ * Return the starting slot in efHNInternSlots for a HierName with the
+ * given parent and component hash.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static unsigned
+efHNInternSlot(parent, hash)
+    HierName *parent;
+    int hash;
+{
+    unsigned h;
+
+    h = (unsigned) hash + (unsigned) (((spointertype) parent) >> 3) * 0x9e3779b1U;
+    h ^= h >> 15;
+    return h & (efHNInternSize - 1);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNInternGrow --
+ *
+ * Double the size of the intern table (or create it) and reinsert
+ * all the interned HierNames.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Reallocates efHNInternSlots.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+efHNInternGrow()
+{
+    HierName **oldSlots = efHNInternSlots, *hn;
+    unsigned oldSize = efHNInternSize, i, j;
+
+    efHNInternSize = (oldSize == 0) ? HN_INTERN_INITSIZE : oldSize * 2;
+    efHNInternSlots = (HierName **) mallocMagic(efHNInternSize
+		* sizeof (HierName *));
+    memset(efHNInternSlots, 0, efHNInternSize * sizeof (HierName *));
+
+    for (i = 0; i < oldSize; i++)
+    {
+	if ((hn = oldSlots[i]) == NULL) continue;
+	j = efHNInternSlot(hn->hn_parent, hn->hn_hash);
+	while (efHNInternSlots[j])
+	    j = (j + 1) & (efHNInternSize - 1);
+	efHNInternSlots[j] = hn;
+    }
+    if (oldSlots) freeMagic((char *) oldSlots);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNIntern --
+ *
+ * Return the unique HierName whose parent is 'parent' and whose
+ * component is the 'len' characters at 'name' (with hash value 'hash'
+ * as computed by HASHADDVAL over those characters), creating it in
+ * the HierName arena if it does not exist yet.
+ *
+ * Results:
+ *	Pointer to the interned HierName.
+ *
+ * Side effects:
+ *	May add a HierName to the arena and the intern table.
+ *	'type' (HN_ALLOC, HN_CONCAT, etc.) is used for statistics only.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HierName *
+efHNIntern(parent, name, len, hash, type)
+    HierName *parent;	/* Components of name on root side */
+    char *name;		/* Component (need not be NULL-terminated) */
+    int len;		/* Length of component */
+    int hash;		/* Hash of component */
+    int type;		/* HN_ALLOC, HN_CONCAT, etc. */
+{
+    HierName *hn;
+    unsigned i, size;
+
+    if (4 * (efHNInternCount + 1) > 3 * efHNInternSize)
+	efHNInternGrow();
+
+    for (i = efHNInternSlot(parent, hash); (hn = efHNInternSlots[i]);
+		i = (i + 1) & (efHNInternSize - 1))
+    {
+	if (hn->hn_parent == parent && hn->hn_hash == hash
+		&& strncmp(hn->hn_name, name, len) == 0
+		&& hn->hn_name[len] == '\0')
+	{
+	    efHNInternShared++;
+	    return hn;
+	}
+    }
+
+    size = HIERNAMESIZE(len);
+    hn = efHNAlloc(size);
+    if (efHNStats) efHNRecord(size, type);
+    memcpy(hn->hn_name, name, len);
+    hn->hn_name[len] = '\0';
+    hn->hn_hash = hash;
+    hn->hn_parent = parent;
+    efHNInternSlots[i] = hn;
+    efHNInternCount++;
+    return hn;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNInternStr --
+ *
+ * Intern the component running from 'cp' up to 'endp' (or to the
+ * trailing NULL byte if 'endp' is NULL) under 'parent'.
+ *
+ * Results:
+ *	Pointer to the interned HierName.
+ *
+ * Side effects:
+ *	See efHNIntern().
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HierName *
+efHNInternStr(parent, cp, endp, type)
+    HierName *parent;
+    char *cp;
+    char *endp;
+    int type;
+{
+    unsigned hashsum = 0;
+    char *sp;
+
+    for (sp = cp; endp ? (sp < endp) : (*sp != '\0'); sp++)
+	hashsum = HASHADDVAL(hashsum, *sp);
+
+    return efHNIntern(parent, cp, (int)(sp - cp), (int) hashsum, type);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNFind --
+ *
+ * Like efHNIntern(), but only looks for an existing HierName and
+ * never creates one.  Every HierName used as a key anywhere is
+ * interned, so a name with a component that isn't interned can't
+ * be found in any table either.
+ *
+ * Results:
+ *	Pointer to the interned HierName, or NULL if there is none.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HierName *
+efHNFind(parent, name, len, hash)
+    HierName *parent;	/* Components of name on root side */
+    char *name;		/* Component (need not be NULL-terminated) */
+    int len;		/* Length of component */
+    int hash;		/* Hash of component */
+{
+    HierName *hn;
+    unsigned i;
+
+    if (efHNInternSize == 0)
+	return (HierName *) NULL;
+
+    for (i = efHNInternSlot(parent, hash); (hn = efHNInternSlots[i]);
+		i = (i + 1) & (efHNInternSize - 1))
+    {
+	if (hn->hn_parent == parent && hn->hn_hash == hash
+		&& strncmp(hn->hn_name, name, len) == 0
+		&& hn->hn_name[len] == '\0')
+	    return hn;
+    }
+    return (HierName *) NULL;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNFindStr --
+ *
+ * Like EFStrToHN(), but only looks for the existing HierName for
+ * 'suffixStr' (which may contain '/'s) under 'prefix'.
+ *
+ * Results:
+ *	Pointer to the interned HierName, or NULL if there is none.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HierName *
+efHNFindStr(prefix, suffixStr)
+    HierName *prefix;	/* Components of name on side of root */
+    char *suffixStr;	/* Leaf part of name (may have /'s) */
+{
+    unsigned hashsum;
+    char *cp;
+
+    for (;;)
+    {
+	hashsum = 0;
+	for (cp = suffixStr; *cp != '/' && *cp != '\0'; cp++)
+	    hashsum = HASHADDVAL(hashsum, *cp);
+	prefix = efHNFind(prefix, suffixStr, (int)(cp - suffixStr),
+		(int) hashsum);
+	if (prefix == NULL || *cp == '\0')
+	    return prefix;
+	suffixStr = cp + 1;
+    }
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNConcatFind --
+ *
+ * Like EFHNConcat(), but only looks for the existing HierName for
+ * 'suffix' appended to 'prefix'.
+ *
+ * Results:
+ *	Pointer to the interned HierName, or NULL if there is none
+ *	('prefix' itself if 'suffix' is NULL).
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+HierName *
+efHNConcatFind(prefix, suffix)
+    HierName *prefix;	/* Components of name on root side */
+    HierName *suffix;	/* Components of name on leaf side */
+{
+    if (suffix == NULL)
+	return prefix;
+
+    prefix = efHNConcatFind(prefix, suffix->hn_parent);
+    if (prefix == NULL && suffix->hn_parent != NULL)
+	return (HierName *) NULL;
+    return efHNFind(prefix, suffix->hn_name, strlen(suffix->hn_name),
+		suffix->hn_hash);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNFreeAll --
+ *
+ * Free every HierName, along with the intern table.  Any HierName
+ * pointer still held becomes invalid.  Called by EFDone().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+efHNFreeAll()
+{
+    char *chunk;
+
+    free_magic1_t mm1 = freeMagic1_init();
+    for (chunk = efHNArenaChunks; chunk; chunk = *((char **) chunk))
+	freeMagic1(&mm1, chunk);
+    freeMagic1_end(&mm1);
+    efHNArenaChunks = efHNArenaNext = efHNArenaEnd = NULL;
+    efHNArenaBytes = 0;
+
+    if (efHNInternSlots) freeMagic((char *) efHNInternSlots);
+    efHNInternSlots = NULL;
+    efHNInternSize = efHNInternCount = efHNInternShared = 0;
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
  * EFHNConcat --
  *
- * Given a HierName prefix and a HierName suffix, make a newly allocated
- * copy of the suffix that points to the prefix.
+ * Given a HierName prefix and a HierName suffix, return the HierName
+ * for the suffix's components appended to the prefix.
  *
  * Results:
- *	Pointer to the new HierName as described above.
+ *	Pointer to the (interned) HierName as described above.
  *
  * Side effects:
- *	May allocate memory.
+ *	May add HierNames to the intern table.
  *
  * ----------------------------------------------------------------------------
  */
@@ -175,28 +532,15 @@ EFHNConcat(prefix, suffix)
     HierName *prefix;		/* Components of name on root side */
     HierName *suffix;	/* Components of name on leaf side */
 {
-    HierName *new, *prev;
-    HierName *firstNew;
-    unsigned size;
+    if (suffix == NULL)
+	return prefix;
 
-    for (firstNew = prev = (HierName *) NULL;
-	    suffix;
-	    prev = new, suffix = suffix->hn_parent)
-    {
-	size = HIERNAMESIZE(strlen(suffix->hn_name));
-	new = (HierName *) mallocMagic((unsigned)(size));
-	if (efHNStats) efHNRecord(size, HN_CONCAT);
-	new->hn_hash = suffix->hn_hash;
-	(void) strcpy(new->hn_name, suffix->hn_name);
-	if (prev)
-	    prev->hn_parent = new;
-	else
-	    firstNew = new;
-    }
-    if (prev)
-	prev->hn_parent = prefix;
-
-    return firstNew;
+    /* Intern from the root side down, since each component's key
+     * includes its (already interned) parent.
+     */
+    prefix = EFHNConcat(prefix, suffix->hn_parent);
+    return efHNIntern(prefix, suffix->hn_name, strlen(suffix->hn_name),
+		suffix->hn_hash, HN_CONCAT);
 }
 
 /*
@@ -206,15 +550,15 @@ EFHNConcat(prefix, suffix)
  *
  * Given a hierarchical prefix (the HierName pointed to by prefix)
  * and a name relative to that prefix (the string 'suffixStr'), return a
- * pointer to the HierName we should use.  Normally, this is just a newly
- * built HierName containing the path components of 'suffixStr' appended to
- * prefix.
+ * pointer to the HierName we should use.  Normally, this is just the
+ * (interned) HierName containing the path components of 'suffixStr'
+ * appended to prefix.
  *
  * Results:
  *	Pointer to a name determined as described above.
  *
  * Side effects:
- *	May allocate new HierNames.
+ *	May add HierNames to the intern table.
  *
  * ----------------------------------------------------------------------------
  */
@@ -225,11 +569,8 @@ EFStrToHN(prefix, suffixStr)
     char *suffixStr;	/* Leaf part of name (may have /'s) */
 {
     char *cp;
-    HashEntry *he;
     char *slashPtr;
     HierName *hierName;
-    unsigned size;
-    int len;
 
     /* Skip to the end of the relative name */
     slashPtr = NULL;
@@ -246,11 +587,7 @@ EFStrToHN(prefix, suffixStr)
     {
 	if (*cp == '/' || *cp == '\0')
 	{
-	    size = HIERNAMESIZE(cp - slashPtr);
-	    hierName = (HierName *) mallocMagic((unsigned)(size));
-	    if (efHNStats) efHNRecord(size, HN_ALLOC);
-	    efHNInit(hierName, slashPtr, cp);
-	    hierName->hn_parent = prefix;
+	    hierName = efHNInternStr(prefix, slashPtr, cp, HN_ALLOC);
 	    if (*cp++ == '\0')
 		break;
 	    slashPtr = cp;
@@ -333,6 +670,49 @@ efHNToStrFunc(hierName, dstp)
     return --dstp;
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efHNLookErr --
+ *
+ * Report that the node formed from 'prefix' and either the HierName
+ * 'suffix' or the string 'suffixStr' does not exist.  The name is
+ * built as a string, since a name that isn't found need not have been
+ * interned.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Prints an error message.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+efHNLookErr(prefix, suffix, suffixStr, errorStr)
+    HierName *prefix;	/* Components of name on root side */
+    HierName *suffix;	/* Part of name on leaf side, or NULL */
+    char *suffixStr;	/* Part of name on leaf side, or NULL */
+    char *errorStr;	/* Explanatory string for errors */
+{
+    char name[2048], *cp;
+
+    cp = efHNToStrFunc(prefix, name);
+    if (suffix != NULL || suffixStr != NULL)
+    {
+	if (cp > name) *cp++ = '/';
+	if (suffix != NULL)
+	    (void) efHNToStrFunc(suffix, cp);
+	else
+	{
+	    strncpy(cp, suffixStr, name + sizeof name - cp - 1);
+	    name[sizeof name - 1] = '\0';
+	}
+    }
+    PrintErr("%s: no such node %s\n", errorStr, name);
+}
+
 /*
  * ----------------------------------------------------------------------------
  *
@@ -352,8 +732,7 @@ efHNToStrFunc(hierName, dstp)
  *	See above.
  *
  * Side effects:
- *	Allocates memory temporarily to build the key for HashLookOnly(),
- *	but then frees it before returning.
+ *	None.  The name is only looked up, never interned.
  *
  * ----------------------------------------------------------------------------
  */
@@ -364,32 +743,23 @@ EFHNLook(prefix, suffixStr, errorStr)
     char *suffixStr;	/* Part of name on leaf side */
     char *errorStr;	/* Explanatory string for errors */
 {
-    HierName *hierName, *hn;
-    bool dontFree = FALSE;
-    HashEntry *he;
+    HierName *hierName;
+    HashEntry *he = NULL;
 
     if (suffixStr == NULL)
-    {
 	hierName = prefix;
-	dontFree = TRUE;
-    }
-    else hierName = EFStrToHN(prefix, suffixStr);
+    else
+	hierName = efHNFindStr(prefix, suffixStr);
 
-    he = HashLookOnly(&efNodeHashTable, (char *) hierName);
+    if (hierName != NULL)
+	he = HashLookOnly(&efNodeHashTable, (char *) hierName);
     if (he == NULL || HashGetValue(he) == NULL)
     {
 	if (errorStr)
-	    PrintErr("%s: no such node %s\n", errorStr, EFHNToStr(hierName));
+	    efHNLookErr(prefix, (HierName *) NULL, suffixStr, errorStr);
 	he = NULL;
     }
 
-    /*
-     * Free the portion of the HierName we just allocated for
-     * looking in the table, if we allocated one.
-     */
-    if (!dontFree)
-	EFHNFree(hierName, prefix, HN_ALLOC);
-
     return he;
 }
 
@@ -418,73 +788,21 @@ EFHNConcatLook(prefix, suffix, errorStr)
     HierName *suffix;	/* Part of name on leaf side */
     char *errorStr;	/* Explanatory string for errors */
 {
-    HashEntry *he;
-    HierName *hn;
+    HashEntry *he = NULL;
+    HierName *hierName;
 
-    /*
-     * Find the last component of the suffix, then temporarily
-     * link the HierNames for use as a hash key.  This is safe
-     * because HashLookOnly() doesn't ever store anything in the
-     * hash table, so we don't have to worry about this temporarily
-     * built key somehow being saved without our knowledge.
-     */
-    hn = suffix;
-    while (hn->hn_parent)
-	hn = hn->hn_parent;
-    hn->hn_parent = prefix;
+    hierName = efHNConcatFind(prefix, suffix);
 
-    he = HashLookOnly(&efNodeHashTable, (char *) suffix);
+    if (hierName != NULL)
+	he = HashLookOnly(&efNodeHashTable, (char *) hierName);
     if (he == NULL || HashGetValue(he) == NULL)
     {
-	PrintErr("%s: no such node %s\n", errorStr, EFHNToStr(suffix));
+	efHNLookErr(prefix, suffix, (char *) NULL, errorStr);
 	he = (HashEntry *) NULL;
     }
-
-    /* Undo the temp link */
-    hn->hn_parent = (HierName *) NULL;
     return he;
 }
 
-/*
- * ----------------------------------------------------------------------------
- *
- * EFHNFree --
- *
- * Free a list of HierNames, up to but not including the element pointed
- * to by 'prefix' (or the NULL indicating the end of the HierName list).
- *
- * Results:
- *	None.
- *
- * Side effects:
- *	Frees memory.
- *
- * ----------------------------------------------------------------------------
- */
-
-void
-EFHNFree(hierName, prefix, type)
-    HierName *hierName, *prefix;
-    int type;	/* HN_ALLOC, HN_CONCAT, etc */
-{
-    HierName *hn;
-
-    free_magic1_t mm1 = freeMagic1_init();
-    for (hn = hierName; hn; hn = hn->hn_parent)
-    {
-	if (hn == prefix)
-	    break;
-
-	freeMagic1(&mm1, (char *) hn);
-	if (efHNStats)
-	{
-	    int len = strlen(hn->hn_name);
-	    efHNRecord(-HIERNAMESIZE(len), type);
-	}
-    }
-    freeMagic1_end(&mm1);
-}
-
 /*
  * ----------------------------------------------------------------------------
  *
@@ -613,16 +931,16 @@ efHNLexOrder(hierName1, hierName2)
  *
  * Construct a HierName for a cell use (for the array element identified
  * by (hc_x, hc_y) if the use is an array).  The parent pointer of this
- * newly allocated HierName will be set to prefix.
+ * HierName will be set to prefix.
  *
  * Results:
- *	Returns a pointer to a newly allocated HierName.
+ *	Returns a pointer to the HierName.
  *
  * Side effects:
  *	See above.
- *	Note: we use a hash table to ensure that we always return
- *	the SAME HierName whenever prefix, the (x, y) use
- *	coordinates, and the use id are the same.
+ *	Note: since HierNames are interned, we always return the SAME
+ *	HierName whenever prefix, the (x, y) use coordinates, and the
+ *	use id are the same.
  *
  * ----------------------------------------------------------------------------
  */
@@ -635,10 +953,7 @@ efHNFromUse(hc, prefix)
     char *srcp, *dstp;
     char name[2048], *namePtr;
     Use *u = hc->hc_use;
-    HierName *hierName, *hn;
     bool hasX, hasY;
-    HashEntry *he;
-    unsigned size;
 
     hasX = u->use_xlo != u->use_xhi;
     hasY = u->use_ylo != u->use_yhi;
@@ -676,116 +991,7 @@ efHNFromUse(hc, prefix)
 	*dstp = '\0';
     }
 
-    size = HIERNAMESIZE(strlen(namePtr));
-    hierName = (HierName *) mallocMagic ((unsigned)(size));
-    if (efHNStats) efHNRecord(size, HN_FROMUSE);
-    efHNInit(hierName, namePtr, (char *) NULL);
-    hierName->hn_parent = prefix;
-
-    /* See if we already have an entry for this one */
-    he = HashFind(&efHNUseHashTable, (char *) hierName);
-    if (HashGetValue(he))
-    {
-	freeMagic((char *) hierName);
-	return (HierName *) HashGetValue(he);
-    }
-    HashSetValue(he, (ClientData) hierName);
-
-    for (hn = hierName; hn; hn = hn->hn_parent)
-	HashFind(&efFreeHashTable, (char *) hierName);
-
-    return hierName;
-}
-
-/*
- * ----------------------------------------------------------------------------
- *
- * efHNUseCompare --
- *
- *	Compare two HierNames for equality, but using a different sense
- *	of comparison than efHNCompare: two names are considered equal
- *	only if their hn_parent fields are equal and their hn_name strings
- *	are identical.
- *
- * Results: Returns 0 if they are equal, 1 if not.
- *
- * efHNUseHash --
- *
- *	Convert a HierName to a single 32-bit value suitable for being
- *	turned into a hash bucket by the hash module.  Hashes based on
- *	hierName->hn_hash and hierName->hn_parent, rather than summing
- *	the hn_hash values.
- *
- * Results: Returns the 32-bit hash value.
- *
- * Side effects:
- *	None.
- *
- * ----------------------------------------------------------------------------
- */
-
-bool
-efHNUseCompare(hierName1, hierName2)
-    HierName *hierName1, *hierName2;
-{
-    return ((bool)(hierName1->hn_parent != hierName2->hn_parent
-	           || strcmp(hierName1->hn_name, hierName2->hn_name)
-		  ));
-}
-
-int
-efHNUseHash(hierName)
-    HierName *hierName;
-{
-    return hierName->hn_hash + (spointertype) hierName->hn_parent;
-}
-
-/*
- * ----------------------------------------------------------------------------
- *
- * efHNInit --
- *
- * Copy the string 'cp' into hierName->hn_name, also initializing
- * the hn_hash fields of hierName.  If 'endp' is NULL, copy all
- * characters in 'cp' up to a trailing NULL byte; otherwise, copy
- * up to 'endp'.
- *
- * Results:
- *	None.
- *
- * Side effects:
- *	See above.
- *
- * ----------------------------------------------------------------------------
- */
-
-void
-efHNInit(hierName, cp, endp)
-    HierName *hierName;		/* Fill in fields of this HierName */
-    char *cp;		/* Start of name to be stored in hn_name */
-    char *endp;	/* End of name if non-NULL; else, see above */
-{
-    unsigned hashsum;
-    char *dstp;
-
-    hashsum = 0;
-    dstp = hierName->hn_name;
-    if (endp)
-    {
-	while (cp < endp)
-	{
-	    hashsum = HASHADDVAL(hashsum, *cp);
-	    *dstp++ = *cp++;
-	}
-	*dstp = '\0';
-    }
-    else
-    {
-	while ((*dstp++ = *cp))
-	    hashsum = HASHADDVAL(hashsum, *cp++);
-    }
-
-    hierName->hn_hash = hashsum;
+    return efHNInternStr(prefix, namePtr, (char *) NULL, HN_FROMUSE);
 }
 
 /*
@@ -908,13 +1114,7 @@ void
 efHNDistKill(dist)
     Distance *dist;
 {
-    HierName *hn;
-
-    for (hn = dist->dist_1; hn; hn = hn->hn_parent)
-	(void) HashFind(&efFreeHashTable, (char *) hn);
-    for (hn = dist->dist_2; hn; hn = hn->hn_parent)
-	(void) HashFind(&efFreeHashTable, (char *) hn);
-
+    /* The HierNames in dist are interned, and freed by EFDone() */
     freeMagic((char *) dist);
 }
 
@@ -1026,4 +1226,9 @@ efHNPrintSizes(when)
     printf("%8d bytes for names from strings\n", efHNSizes[HN_ALLOC]);
     printf("--------\n");
     printf("%8d bytes total\n", total);
+    printf("%8u distinct HierName components (%u requests shared one)\n",
+		efHNInternCount, efHNInternShared);
+    printf("%8lu bytes in HierName arena\n", (unsigned long) efHNArenaBytes);
+    printf("%8lu bytes in HierName intern table\n",
+		(unsigned long) efHNInternSize * sizeof (HierName *));
 }
@@ -25,6 +25,9 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <sys/param.h>
+#include <sys/stat.h>
 
 #include "tcltk/tclmagic.h"
 #include "utils/main.h"
@@ -42,6 +45,7 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #include "extract/extract.h"
 #include "extract/extractInt.h"
 #include "utils/paths.h"
+#include "utils/workers.h"
 
 /* C99 compat */
 #include "textio/textio.h"
@@ -62,6 +66,40 @@ bool EFSaveLocs;	/* If TRUE, save location of merged top-level nodes */
 
 /* Data local to this file */
 static bool efReadDef(Def *def, bool dosubckt, bool resist, bool noscale, bool toplevel, bool isspice);
+static FILE *efReadOpen(char *name, char *ext);
+
+#ifdef HAVE_WORKERS
+/*
+ * A .ext file read ahead of time by efReadPrefetch().  The search
+ * directories are expanded on the main thread; finding, opening and
+ * reading the file are all done by a worker thread, which keeps the
+ * file open only while reading it.
+ */
+typedef struct
+{
+    char	*erp_name;	/* Def name (the hash key) */
+    char       **erp_dirs[3];	/* NULL-terminated lists of directories
+				 * to search in order, or NULL.
+				 */
+    char	*erp_path;	/* Real name of the file, for error messages */
+    char	*erp_data;	/* Contents of the file */
+    size_t	 erp_size;	/* Number of bytes in erp_data */
+    int		 erp_errno;	/* Why the file was not read ahead, or 0 */
+} ExtPrefetch;
+
+/* ExtPrefetch records keyed by def name, valid while efReadPrefetching */
+static HashTable efReadPrefetchTable;
+static bool efReadPrefetching = FALSE;
+
+/* Expanded EFSearchPath and Path, each followed by EFLibPath */
+static char **efReadPrefetchSearch;
+static char **efReadPrefetchStd;
+
+static void efReadPrefetch(char *name);
+static FILE *efReadPrefetched(char *name);
+static void efReadPrefetchRelease(char *name);
+static void efReadPrefetchDone(void);
+#endif
 
 /*
  * ----------------------------------------------------------------------------
@@ -77,6 +115,13 @@ static bool efReadDef(Def *def, bool dosubckt, bool resist, bool noscale, bool t
  * netlist generation, and node names should be treated as case-
  * insensitive.
  *
+ * If EFThreads (set by the -j option) asks for more than one
+ * thread, all of the .ext files in the hierarchy are first found and
+ * read into memory concurrently by efReadPrefetch(), so that waiting
+ * on a slow file system overlaps.  The defs themselves are still built
+ * here on the main thread in the usual order, so the result is the
+ * same either way.
+ *
  * Results:
  *	Passes on the return value of efReadDef (see below)
  *
@@ -102,7 +147,14 @@ EFReadFile(name, dosubckt, resist, noscale, isspice)
 	def = efDefNew(name);
 
     locScale = 1.0;
+#ifdef HAVE_WORKERS
+    if (WorkerCount(EFThreads) > 1)
+	efReadPrefetch(name);
+#endif
     rc = efReadDef(def, dosubckt, resist, noscale, TRUE, isspice);
+#ifdef HAVE_WORKERS
+    efReadPrefetchDone();
+#endif
     if (EFArgTech) EFTech = StrDup((char **) NULL, EFArgTech);
     if (EFScale == 0.0) EFScale = 1.0;
 
@@ -139,7 +191,6 @@ efReadDef(
    bool isspice)
 {
     int argc, ac, n;
-    CellDef *dbdef;
     EFCapValue cap;
     EFNode *node;
     char *line = NULL, *argv[128], *name, *attrs;
@@ -160,32 +211,12 @@ efReadDef(
     def->def_flags |= DEF_AVAILABLE;
     name = def->def_name;
 
-    /* If the search path was specified with the "-p" argument to the calling
-     * command (e.g., ext2spice or ext2sim), then use that path.
-     */
-    if (EFSearchPath != NULL)
-	inf = PaOpen(name, "r", ".ext", EFSearchPath, EFLibPath, &efReadFileName);
-
-    if ((inf == NULL) && (dbdef = DBCellLookDef(name)) != NULL)
-    {
-	/* If cell is in main database, check if there is a file path set. */
-	if (dbdef->cd_file != NULL)
-	{
-	    char *filepath, *sptr;
-
-	    filepath = StrDup((char **)NULL, dbdef->cd_file);
-	    sptr = strrchr(filepath, '/');
-	    if (sptr) {
-		*sptr = '\0';
-		inf = PaOpen(name, "r", ".ext", filepath, EFLibPath, &efReadFileName);
-	    }
-	    freeMagic(filepath);
-	}
-    }
-
-    /* Try with the standard search path */
-    if ((inf == NULL) && (EFSearchPath == NULL))
-	inf = PaOpen(name, "r", ".ext", Path, EFLibPath, &efReadFileName);
+#ifdef HAVE_WORKERS
+    /* Use the contents read ahead by efReadPrefetch(), if any */
+    inf = efReadPrefetched(name);
+    if (inf == NULL)
+#endif
+	inf = efReadOpen(name, ".ext");
 
     if (inf == NULL)
     {
@@ -624,37 +655,15 @@ resistChanged:
     }
     fclose(inf);
     inf = (FILE *)NULL;
+#ifdef HAVE_WORKERS
+    efReadPrefetchRelease(name);
+#endif
 
     /* Is there an "extresist" extract file? */
     if (DoResist)
     {
 	DoResist = FALSE;	/* do this only once */
-	if (EFSearchPath != NULL)
-	    inf = PaOpen(name, "r", ".res.ext", EFSearchPath,
-			EFLibPath, &efReadFileName);
-
-	if ((inf == NULL) && (dbdef = DBCellLookDef(name)) != NULL)
-	{
-	    /* If cell is in main database, check if there is a file path set. */
-	    if (dbdef->cd_file != NULL)
-	    {
-		char *filepath, *sptr;
-
-		filepath = StrDup((char **)NULL, dbdef->cd_file);
-		sptr = strrchr(filepath, '/');
-		if (sptr) {
-		    *sptr = '\0';
-		    inf = PaOpen(name, "r", ".res.ext", filepath,
-				EFLibPath, &efReadFileName);
-		}
-		freeMagic(filepath);
-	    }
-	}
-
-	/* Try with the standard search path */
-	if ((inf == NULL) && (EFSearchPath == NULL))
-	    inf = PaOpen(name, "r", ".res.ext", Path, EFLibPath, &efReadFileName);
-
+	inf = efReadOpen(name, ".res.ext");
 	if (inf != NULL)
 	    goto readfile;
     }
@@ -681,6 +690,509 @@ resistChanged:
     return rc;
 }
 
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadOpen --
+ *
+ * Find and open the file 'name' with extension 'ext' (".ext" or
+ * ".res.ext").  Look first in the search path given with "-p", if
+ * any, then in the directory of the cell 'name' if it is in the
+ * database, and finally in the standard search path.
+ *
+ * Results:
+ *	Open FILE pointer, or NULL if the file could not be found.
+ *
+ * Side effects:
+ *	Sets efReadFileName to the real name of the file opened.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static FILE *
+efReadOpen(
+    char *name,
+    char *ext)
+{
+    CellDef *dbdef;
+    FILE *inf = NULL;
+
+    /* If the search path was specified with the "-p" argument to the calling
+     * command (e.g., ext2spice or ext2sim), then use that path.
+     */
+    if (EFSearchPath != NULL)
+	inf = PaOpen(name, "r", ext, EFSearchPath, EFLibPath, &efReadFileName);
+
+    if ((inf == NULL) && (dbdef = DBCellLookDef(name)) != NULL)
+    {
+	/* If cell is in main database, check if there is a file path set. */
+	if (dbdef->cd_file != NULL)
+	{
+	    char *filepath, *sptr;
+
+	    filepath = StrDup((char **)NULL, dbdef->cd_file);
+	    sptr = strrchr(filepath, '/');
+	    if (sptr) {
+		*sptr = '\0';
+		inf = PaOpen(name, "r", ext, filepath, EFLibPath, &efReadFileName);
+	    }
+	    freeMagic(filepath);
+	}
+    }
+
+    /* Try with the standard search path */
+    if ((inf == NULL) && (EFSearchPath == NULL))
+	inf = PaOpen(name, "r", ext, Path, EFLibPath, &efReadFileName);
+
+    return inf;
+}
+
+#ifdef HAVE_WORKERS
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetchDirs --
+ *
+ * Expand a search path and a library path into a list of directory
+ * names, in the way that PaOpen() steps through them, so that worker
+ * threads can search the directories without calling PaExpand().
+ *
+ * Results:
+ *	NULL-terminated array of directory names, each either empty
+ *	(the working directory) or ending in '/'.  The array and the
+ *	names are to be freed by efReadPrefetchFreeDirs().
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static char **
+efReadPrefetchDirs(
+    const char *path,
+    const char *library)
+{
+    const char *paths[2], *pp;
+    char dir[MAXPATHLEN], *dp, **dirs, **newdirs;
+    int ndirs, maxdirs, i;
+
+    paths[0] = path;
+    paths[1] = library;
+    maxdirs = 8;
+    dirs = (char **)mallocMagic(maxdirs * sizeof (char *));
+    ndirs = 0;
+    for (i = 0; i < 2; i++)
+    {
+	if ((pp = paths[i]) == NULL) continue;
+	while (TRUE)
+	{
+	    /* Same steps as nextName(), without a file name on the end */
+	    while (isspace(*pp) || (*pp == ':')) pp++;
+	    if (*pp == '\0') break;
+	    dp = dir;
+	    dir[MAXPATHLEN - 1] = '\0';
+	    if (PaExpand(&pp, &dp, MAXPATHLEN - 1) < 0)
+	    {
+		if (*pp) pp++;
+		continue;
+	    }
+	    if (*pp) pp++;
+	    if ((dp != dir) && (*(dp - 1) != '/'))
+		*dp++ = '/';
+	    *dp = '\0';
+
+	    if (ndirs + 1 >= maxdirs)
+	    {
+		newdirs = (char **)mallocMagic(2 * maxdirs * sizeof (char *));
+		memcpy(newdirs, dirs, ndirs * sizeof (char *));
+		freeMagic(dirs);
+		dirs = newdirs;
+		maxdirs *= 2;
+	    }
+	    dirs[ndirs++] = StrDup((char **)NULL, dir);
+	}
+    }
+    dirs[ndirs] = NULL;
+    return dirs;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetchFreeDirs --
+ *
+ * Free a list made by efReadPrefetchDirs().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+efReadPrefetchFreeDirs(
+    char **dirs)
+{
+    char **dp;
+
+    if (dirs == NULL) return;
+    for (dp = dirs; *dp; dp++)
+	freeMagic(*dp);
+    freeMagic(dirs);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetchJob --
+ *
+ * Worker thread procedure for efReadPrefetch().  Searches the
+ * directories of one ExtPrefetch record for its .ext file in the
+ * same order as efReadOpen(), then reads the whole file into memory
+ * and closes it.  Runs concurrently with other jobs, so it does
+ * nothing but stdio and memory allocation on its own record.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in erp_path, erp_data and erp_size.  If the file could
+ *	not be found or read, erp_data is left NULL and erp_errno says
+ *	why.  An empty file is left to efReadDef() without an error.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+efReadPrefetchJob(
+    int job,
+    ClientData cdata)
+{
+    ExtPrefetch *erp = ((ExtPrefetch **)CD2PTR(cdata))[job];
+    char realName[MAXPATHLEN], **dp;
+    struct stat sbuf;
+    FILE *f = NULL;
+    int i;
+
+    erp->erp_errno = ENOENT;
+    for (i = 0; (i < 3) && (f == NULL); i++)
+    {
+	if (erp->erp_dirs[i] == NULL) continue;
+	for (dp = erp->erp_dirs[i]; *dp; dp++)
+	{
+	    snprintf(realName, sizeof realName, "%s%s.ext", *dp, erp->erp_name);
+	    if ((f = fopen(realName, "r")) != NULL) break;
+
+	    /* As in PaOpen(), any error but "not found" ends this path */
+	    if (errno != ENOENT)
+	    {
+		erp->erp_errno = errno;
+		break;
+	    }
+	}
+    }
+    if (f == NULL) return;
+
+    erp->erp_errno = 0;
+    if (fstat(fileno(f), &sbuf) != 0)
+	erp->erp_errno = errno;
+    else if (sbuf.st_size > 0)
+    {
+	erp->erp_size = (size_t)sbuf.st_size;
+	erp->erp_data = (char *)mallocMagic(erp->erp_size);
+	if (fread(erp->erp_data, 1, erp->erp_size, f) == erp->erp_size)
+	    erp->erp_path = StrDup((char **)NULL, realName);
+	else
+	{
+	    erp->erp_errno = ferror(f) ? errno : EIO;
+	    freeMagic(erp->erp_data);
+	    erp->erp_data = NULL;
+	    erp->erp_size = 0;
+	}
+    }
+    fclose(f);
+    freeMagicFlush();
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetch --
+ *
+ * Read the .ext file for 'name' and those of all the cells it uses,
+ * recursively, into memory.  The hierarchy is discovered one level at
+ * a time:  the files of each level are searched for, opened and read
+ * concurrently using up to EFThreads threads, so no more than that
+ * many files are open at once.  Each level is then scanned for "use"
+ * lines to find the names making up the next level.  Defs that have
+ * already been read are skipped.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills efReadPrefetchTable and sets efReadPrefetching, so that
+ *	efReadDef() takes its input from memory.  Files that could not
+ *	be read ahead are reported, and left to efReadDef() to read in
+ *	the usual way.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+efReadPrefetch(
+    char *name)
+{
+    ExtPrefetch **wave, *erp;
+    char **pending, **next, *cp, *np, *end, *use, *sptr;
+    char usename[1024];
+    int npending, nnext, maxpending, nwave, i;
+    HashEntry *he;
+    CellDef *dbdef;
+    Def *def;
+
+#ifndef HAVE_THREAD_LOCAL
+    TxPrintf(".ext files can't be read concurrently;  reading them in order.\n");
+    return;
+#else
+    HashInit(&efReadPrefetchTable, 64, HT_STRINGKEYS);
+    efReadPrefetching = TRUE;
+    efReadPrefetchSearch = efReadPrefetchStd = NULL;
+    if (EFSearchPath != NULL)
+	efReadPrefetchSearch = efReadPrefetchDirs(EFSearchPath, EFLibPath);
+    else
+	efReadPrefetchStd = efReadPrefetchDirs(Path, EFLibPath);
+
+    maxpending = 16;
+    pending = (char **)mallocMagic(maxpending * sizeof (char *));
+    he = HashFind(&efReadPrefetchTable, name);
+    pending[0] = he->h_key.h_name;
+    npending = 1;
+
+    while (npending > 0)
+    {
+	/* Set up the search for each of this level's files */
+	wave = (ExtPrefetch **)mallocMagic(npending * sizeof (ExtPrefetch *));
+	nwave = 0;
+	for (i = 0; i < npending; i++)
+	{
+	    erp = (ExtPrefetch *)callocMagic(1, sizeof (ExtPrefetch));
+	    HashSetValue(HashFind(&efReadPrefetchTable, pending[i]), erp);
+	    erp->erp_name = pending[i];
+
+	    /* Names that PaOpen() treats specially are read in order */
+	    if (strchr("/.~$", pending[i][0]) != NULL)
+	    {
+		TxPrintf("Reading %s.ext in order:  not a plain cell name.\n",
+			pending[i]);
+		continue;
+	    }
+
+	    /* Same order of directories as efReadOpen() */
+	    erp->erp_dirs[0] = efReadPrefetchSearch;
+	    if ((dbdef = DBCellLookDef(pending[i])) != NULL
+		    && dbdef->cd_file != NULL
+		    && (sptr = strrchr(dbdef->cd_file, '/')) != NULL)
+	    {
+		*sptr = '\0';
+		erp->erp_dirs[1] = efReadPrefetchDirs(dbdef->cd_file, EFLibPath);
+		*sptr = '/';
+	    }
+	    erp->erp_dirs[2] = efReadPrefetchStd;
+	    wave[nwave++] = erp;
+	}
+
+	WorkerRun(EFThreads, nwave, efReadPrefetchJob, PTR2CD(wave));
+
+	/* Names used by this level that have not been seen yet */
+	next = (char **)mallocMagic(maxpending * sizeof (char *));
+	nnext = 0;
+	for (i = 0; i < nwave; i++)
+	{
+	    erp = wave[i];
+	    efReadPrefetchFreeDirs(erp->erp_dirs[1]);
+	    erp->erp_dirs[1] = NULL;
+	    if (erp->erp_errno != 0)
+		TxPrintf("Reading %s.ext in order:  %s.\n", erp->erp_name,
+			strerror(erp->erp_errno));
+	    if (erp->erp_data == NULL)
+		continue;
+
+	    /* The def name is the first argument of each "use" line */
+	    end = erp->erp_data + erp->erp_size;
+	    for (cp = erp->erp_data; cp < end; cp = np + 1)
+	    {
+		np = memchr(cp, '\n', end - cp);
+		if (np == NULL) np = end;
+		if (np - cp < 5 || strncmp(cp, "use", 3) || !isspace(cp[3]))
+		    continue;
+		for (cp += 3; cp < np && isspace(*cp); cp++)
+		    /* Nothing */;
+		for (use = cp; cp < np && !isspace(*cp); cp++)
+		    /* Nothing */;
+		if (*use == '"' && cp - use > 1 && cp[-1] == '"')
+		    use++, cp--;
+		if (cp == use || cp - use >= sizeof usename)
+		    continue;
+		strncpy(usename, use, cp - use);
+		usename[cp - use] = '\0';
+
+		if (HashLookOnly(&efReadPrefetchTable, usename) != NULL)
+		    continue;
+		def = efDefLook(usename);
+		if (def != NULL && (def->def_flags & DEF_AVAILABLE))
+		    continue;
+		he = HashFind(&efReadPrefetchTable, usename);
+		if (nnext == maxpending)
+		{
+		    char **newnext;
+
+		    newnext = (char **)mallocMagic(2 * maxpending * sizeof (char *));
+		    memcpy(newnext, next, nnext * sizeof (char *));
+		    freeMagic(next);
+		    next = newnext;
+		    maxpending *= 2;
+		}
+		next[nnext++] = he->h_key.h_name;
+	    }
+	}
+	freeMagic(wave);
+	freeMagic(pending);
+	pending = next;
+	npending = nnext;
+    }
+    freeMagic(pending);
+#endif	/* HAVE_THREAD_LOCAL */
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetched --
+ *
+ * Return a stream reading the prefetched contents of the .ext file
+ * for 'name', if efReadPrefetch() managed to read it.
+ *
+ * Results:
+ *	FILE pointer on the in-memory contents, or NULL if there are
+ *	none and the file should be opened normally.
+ *
+ * Side effects:
+ *	Sets efReadFileName to the real name of the file.  Reports
+ *	the prefetched contents that could not be opened as a stream.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static FILE *
+efReadPrefetched(
+    char *name)
+{
+    HashEntry *he;
+    ExtPrefetch *erp;
+    FILE *f;
+
+    if (!efReadPrefetching) return NULL;
+    he = HashLookOnly(&efReadPrefetchTable, name);
+    if (he == NULL) return NULL;
+    erp = (ExtPrefetch *)HashGetValue(he);
+    if (erp == NULL || erp->erp_data == NULL)
+	return NULL;
+
+    f = fmemopen(erp->erp_data, erp->erp_size, "r");
+    if (f != NULL)
+	efReadFileName = erp->erp_path;
+    else
+	TxPrintf("Reading %s.ext in order:  %s.\n", name, strerror(errno));
+    return f;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetchRelease --
+ *
+ * Free the in-memory contents of the .ext file for 'name' once
+ * efReadDef() has finished with it, so that the prefetched data
+ * shrinks as the defs are built.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+efReadPrefetchRelease(
+    char *name)
+{
+    HashEntry *he;
+    ExtPrefetch *erp;
+
+    if (!efReadPrefetching) return;
+    he = HashLookOnly(&efReadPrefetchTable, name);
+    if (he == NULL) return;
+    erp = (ExtPrefetch *)HashGetValue(he);
+    if (erp == NULL) return;
+
+    if (erp->erp_data) freeMagic(erp->erp_data);
+    erp->erp_data = NULL;
+    erp->erp_size = 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * efReadPrefetchDone --
+ *
+ * Free everything left over from efReadPrefetch().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory and clears efReadPrefetching.  efReadFileName
+ *	is reset, since it may point into a freed record.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void
+efReadPrefetchDone(void)
+{
+    HashSearch hs;
+    HashEntry *he;
+    ExtPrefetch *erp;
+
+    if (!efReadPrefetching) return;
+
+    HashStartSearch(&hs);
+    while ((he = HashNext(&efReadPrefetchTable, &hs)))
+    {
+	erp = (ExtPrefetch *)HashGetValue(he);
+	if (erp == NULL) continue;
+	if (erp->erp_data) freeMagic(erp->erp_data);
+	if (erp->erp_path) freeMagic(erp->erp_path);
+	freeMagic(erp);
+    }
+    HashKill(&efReadPrefetchTable);
+    efReadPrefetchFreeDirs(efReadPrefetchSearch);
+    efReadPrefetchFreeDirs(efReadPrefetchStd);
+    efReadPrefetchSearch = efReadPrefetchStd = NULL;
+    efReadPrefetching = FALSE;
+    efReadFileName = NULL;
+}
+
+#endif	/* HAVE_WORKERS */
+
 /*
  * ----------------------------------------------------------------------------
  *
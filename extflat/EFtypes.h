@@ -83,7 +83,7 @@ typedef struct hiername
  */
 #define	HIERNAMESIZE(n)	(sizeof (HierName) + n + 1)
 
-/* Indicates where the HierName was allocated: passed to EFHNFree() */
+/* Indicates where the HierName was made:  used for statistics only */
 #define	HN_ALLOC	0	/* Normal name (FromStr) */
 #define	HN_CONCAT	1	/* Concatenation of two HierNames */
 #define HN_GLOBAL	2	/* Global name */
@@ -32,6 +32,7 @@ extern char *EFTech;		/* Technology of extracted circuit */
 extern char *EFStyle;           /* Extraction style of extracted circuit */
 extern char *EFSearchPath;	/* Path to search for .ext files */
 extern char *EFLibPath;		/* Library search path */
+extern int   EFThreads;		/* Number of concurrent jobs (-j) */
 extern char *EFVersion;		/* Version of extractor we work with */
 extern char *EFArgTech;		/* Tech file given as command line argument */
 extern bool  EFCompat;		/* Subtrate backwards-compatibility mode */
@@ -71,7 +72,6 @@ extern char *EFHNToStr();
 extern int EFGetPortMax();
 
 /* C99 compat */
-extern void EFHNFree();
 extern bool EFHNIsGlob();
 extern int  EFNodeResist();
 extern void efAdjustSubCap();
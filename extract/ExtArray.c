@@ -177,7 +177,9 @@ extArray(parentUse, f)
 #endif
 
     /* Output connections and node adjustments */
+    (void) extProfileSwitch(EXT_PROF_OUTPUT);
     extOutputConns(&ha.ha_connHash, f);
+    (void) extProfileSwitch(EXT_PROF_SUBTREE);
     HashKill(&ha.ha_connHash);
 }
 
@@ -605,7 +607,9 @@ extArrayInterFunc(use, trans, x, y, ha)
 	extFindCoupling(oneDef, &oneFlat->et_coupleHash, &ha->ha_clipArea);
 
     /* Process connections */
+    (void) extProfileSwitch(EXT_PROF_HIERCONN);
     extHierConnections(ha, extArrayPrimary, oneFlat);
+    (void) extProfileSwitch(EXT_PROF_SUBTREE);
 
     /* Process substrate connection */
     if (use->cu_xlo == use->cu_xhi)
@@ -226,6 +226,7 @@ extBasic(def, outFile)
     bool isabstract = FALSE;
 
     glob_subsnode = (NodeRegion *)NULL;
+    (void) extProfileSwitch(EXT_PROF_REGIONS);
 
     /*
      * Build up a list of the device regions for extOutputDevices()
@@ -305,6 +306,10 @@ extBasic(def, outFile)
     if (!SigInterruptPending && (ExtDoWarn & EXTWARN_DUP) && !isabstract)
 	extFindDuplicateLabels(def, nodeList);
 
+    /* When re-extracting part of a cell, carry over the old node names */
+    if (!SigInterruptPending && def == extIncrYankDef)
+	extIncrNameNodes(nodeList);
+
     /*
      * Build up table of coupling capacitances (overlap, sidewall).
      * This comes before extOutputNodes because we may have to adjust
@@ -312,6 +317,7 @@ extBasic(def, outFile)
      */
     if (!SigInterruptPending && (ExtOptions & EXT_DOCOUPLING))
     {
+	(void) extProfileSwitch(EXT_PROF_COUPLING);
 	coupleInitialized = TRUE;
 	HashInit(&extCoupleHash, 256, HashSize(sizeof (CoupleKey)));
 	extFindCoupling(def, &extCoupleHash, (Rect *) NULL);
@@ -325,6 +331,18 @@ extBasic(def, outFile)
 		extRelocateSubstrateCoupling(&extCoupleHash, glob_subsnode);
     }
 
+    (void) extProfileSwitch(EXT_PROF_OUTPUT);
+    if (extProfileOn)
+    {
+	NodeRegion *tnode;
+	int nnodes = 0, ndevs = 0;
+
+	for (tnode = nodeList; tnode; tnode = tnode->nreg_next) nnodes++;
+	for (reg = transList; reg; reg = reg->treg_next)
+	    if (reg->treg_type != TT_SPACE) ndevs++;
+	extProfileCounts(nnodes, ndevs);
+    }
+
     /* Check for "device", as it modifies handling of parasitics */
     propptr = DBPropGetString(def, "device", &propfound);
     if (propfound)
@@ -362,6 +380,7 @@ extBasic(def, outFile)
 	extOutputCoupling(&extCoupleHash, outFile);
 
     /* Output devices and connectivity between nodes */
+    (void) extProfileSwitch(EXT_PROF_DEVICES);
     if (!SigInterruptPending)
     {
 	int llx, lly, urx, ury, devidx, l, w;
@@ -563,6 +582,7 @@ extBasic(def, outFile)
     }
 
     /* Clean up */
+    (void) extProfileSwitch(EXT_PROF_OUTPUT);
     if (coupleInitialized)
 	extCapHashKill(&extCoupleHash);
 
@@ -114,6 +114,7 @@ ExtCell(def, outName, isTop)
     extNumErrors = extNumWarnings = 0;
     savePlane = extCellFile(def, f, isTop);
     if (f != NULL) fclose(f);
+    if (ExtOptions & EXT_DOPARTIAL) ExtIncrSaveLines(def, filename);
 
     if (extNumErrors > 0 || extNumWarnings > 0)
     {
@@ -482,6 +483,7 @@ extCellFile(def, f, isTop)
     Label *lab;
 
     UndoDisable();
+    extProfileBeginCell(def);
 
     /* If "extract do unique" was specified, then make labels in the
      * cell unique.
@@ -506,6 +508,18 @@ extCellFile(def, f, isTop)
     else
 	saveSub = extPrepSubstrate(def);
 
+    /*
+     * If "extract do partial" was specified and the cell was extracted
+     * before, try re-extracting only the area that changed.
+     */
+    if ((ExtOptions & EXT_DOPARTIAL) && !SigInterruptPending
+		&& ExtIncrCell(def, f, isTop))
+    {
+	extProfileEndCell(def);
+	UndoEnable();
+	return saveSub;
+    }
+
     /* Remove any label markers that were made by a previous extraction */
     for (lab = def->cd_labels; lab; lab = lab->lab_next)
 	if (lab->lab_port == INFINITY)
@@ -520,8 +534,13 @@ extCellFile(def, f, isTop)
 
     /* Do hierarchical extraction */
     extParentUse->cu_def = def;
+    (void) extProfileSwitch(EXT_PROF_SUBTREE);
     if (!SigInterruptPending) extSubtree(extParentUse, reg, f);
     if (!SigInterruptPending) extArray(extParentUse, f);
+    (void) extProfileSwitch(EXT_PROF_OUTPUT);
+
+    /* Save what partial re-extraction needs before the regions go away */
+    if (ExtOptions & EXT_DOPARTIAL) ExtIncrSave(def, reg, isTop);
 
     /* Clean up from basic extraction */
     if (reg) ExtFreeLabRegions((LabRegion *) reg);
@@ -531,6 +550,7 @@ extCellFile(def, f, isTop)
     if (!SigInterruptPending && isTop && (ExtOptions & EXT_DOLENGTH))
 	extLength(extParentUse, f);
 
+    extProfileEndCell(def);
     UndoEnable();
     return saveSub;
 }
@@ -34,6 +34,7 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #include "utils/hash.h"
 #include "database/database.h"
 #include "utils/malloc.h"
+#include "utils/utils.h"
 #include "textio/textio.h"
 #include "utils/styles.h"
 #include "windows/windows.h"
@@ -186,71 +187,47 @@ extHierSubShieldFunc(tile, dinfo, use)
 
 /*
  *----------------------------------------------------------------------
- * extHierSubstrate --
- *
- * 	Find the substrate node of a child cell and make a connection
- *	between parent and child substrates.  If either of the
- *	substrate nodes is already in the hash table, then the table
- *	will be updated as necessary.
+ * extHierSubstrateName --
  *
- *	This function also determines if a child cell's substrate is
- *	isolated by a substrate shield type, in which case no merge is
- *	done.
+ *	Find the name of the substrate node of the child cell of 'use',
+ *	and determine whether the child's substrate is isolated from
+ *	the parent by a substrate shield type.  The result depends only
+ *	on the child def and on the transform of the use, so for an
+ *	arrayed use it is the same for every element of the array and
+ *	needs to be computed only once.
  *
  * Result:
- *	Return 0 if a substrate was extracted, or doesn't require
- *	extracting; 1 if not.
+ *	Returns a newly allocated copy of the child's substrate node
+ *	name, which the caller must free, or NULL if the child has no
+ *	substrate node.  If the child substrate is shielded, sets
+ *	*pshield to TRUE and returns NULL.
  *
  *----------------------------------------------------------------------
  */
 
-int
-extHierSubstrate(ha, use, x, y)
+char *
+extHierSubstrateName(ha, use, pshield)
     HierExtractArg *ha; 	// Contains parent def and hash table
     CellUse *use;		// Child use
-    int x, y;			// Array subscripts, or -1 if not an array
+    bool *pshield;		// Set TRUE if child substrate is shielded
 {
     NodeRegion *nodeList;
-    HashTable *table = &ha->ha_connHash;
-    HashEntry *he;
-    NodeName *nn;
-    Node *node1, *node2;
-    char *name1, *name2, *childname;
     CellDef *def;
     Rect subArea;
+    char *name2;
     int pNum;
 
     NodeRegion *extFindNodes();
 
-    /* Backwards compatibility with tech files that don't */
-    /* define a substrate plane or substrate connections. */
-    if (glob_subsnode == NULL) return 0;
-
-    /* If the substrate has already been extracted for this use	*/
-    /* then there is no need to do it again.			*/
-    if (use->cu_flags & CU_SUB_EXTRACTED) return 0;
-
-    /* Don't extract anything from cells marked "don't use".	*/
-    if (use->cu_def->cd_flags & CDDONTUSE) return 0;
-
+    *pshield = FALSE;
     def = (CellDef *)ha->ha_parentUse->cu_def;
 
-    /* Register the name of the parent's substrate */
-    /* The parent def's substrate node is in glob_subsnode */
-
-    name1 = extNodeName(glob_subsnode);
-    /* Don't process "(none)" nodes! */
-    if (*name1 == '(' && !strcmp(name1, "(none)")) return 0;
-    he = HashFind(table, name1);
-    nn = (NodeName *) HashGetValue(he);
-    node1 = nn ? nn->nn_node : extHierNewNode(he);
-
     /* Find the child's substrate node */
     nodeList = extFindNodes(use->cu_def, (Rect *) NULL, TRUE);
     if (nodeList == NULL)
     {
     	ExtResetTiles(use->cu_def, CLIENTDEFAULT);
-	return 0;
+	return NULL;
     }
 
     /* Check if the child's substrate node is covered by any substrate	*/
@@ -290,7 +267,8 @@ extHierSubstrate(ha, use, x, y)
     	    {
     		freeMagic(nodeList);
     		ExtResetTiles(use->cu_def, CLIENTDEFAULT);
-		return 1;
+		*pshield = TRUE;
+		return NULL;
 	    }
 	}
     }
@@ -300,18 +278,60 @@ extHierSubstrate(ha, use, x, y)
 			&TiPlaneRect);
     ExtResetTiles(use->cu_def, CLIENTDEFAULT);
 
-    name2 = extNodeName(temp_subsnode);
+    name2 = StrDup((char **)NULL, extNodeName(temp_subsnode));
+    freeMagic(nodeList);
+    return name2;
+}
+
+/*
+ *----------------------------------------------------------------------
+ * extHierSubstrateMerge --
+ *
+ *	Make a connection between the parent substrate node 'name1' and
+ *	the substrate node 'name2' of the array element (x, y) of the
+ *	child 'use'.  If either of the substrate nodes is already in the
+ *	hash table, then the table will be updated as necessary.
+ *
+ * Result:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+extHierSubstrateMerge(ha, use, name1, name2, x, y)
+    HierExtractArg *ha; 	// Contains parent def and hash table
+    CellUse *use;		// Child use
+    char *name1;		// Name of the parent's substrate node
+    char *name2;		// Name of the child's substrate node
+    int x, y;			// Array subscripts, or -1 if not an array
+{
+    HashTable *table = &ha->ha_connHash;
+    HashEntry *he;
+    NodeName *nn;
+    Node *node1, *node2;
+    char *childname;
+
+    he = HashFind(table, name1);
+    nn = (NodeName *) HashGetValue(he);
+    node1 = nn ? nn->nn_node : extHierNewNode(he);
 
     if (x >= 0 && y >= 0)
     {
 	/* Process array information */
-	childname = mallocMagic(strlen(name2) + strlen(use->cu_id) + 14);
-	sprintf(childname, "%s[%d,%d]/%s", use->cu_id, y, x, name2);
+	int len = snprintf((char *) NULL, 0, "%s[%d,%d]/%s",
+			use->cu_id, y, x, name2) + 1;
+
+	childname = mallocMagic(len);
+	snprintf(childname, len, "%s[%d,%d]/%s", use->cu_id, y, x, name2);
     }
     else if (x >= 0 || y >= 0)
     {
-	childname = mallocMagic(strlen(name2) + strlen(use->cu_id) + 9);
-	sprintf(childname, "%s[%d]/%s", use->cu_id, ((x >= 0) ? x : y),
+	int len = snprintf((char *) NULL, 0, "%s[%d]/%s", use->cu_id,
+			((x >= 0) ? x : y), name2) + 1;
+
+	childname = mallocMagic(len);
+	snprintf(childname, len, "%s[%d]/%s", use->cu_id, ((x >= 0) ? x : y),
 			name2);
     }
     else
@@ -368,7 +388,143 @@ extHierSubstrate(ha, use, x, y)
 	    freeMagic((char *)node2);
 	}
     }
-    freeMagic(nodeList);
+}
+
+/*
+ *----------------------------------------------------------------------
+ * extHierSubstrate --
+ *
+ * 	Find the substrate node of a child cell and make a connection
+ *	between parent and child substrates.  If either of the
+ *	substrate nodes is already in the hash table, then the table
+ *	will be updated as necessary.
+ *
+ *	This function also determines if a child cell's substrate is
+ *	isolated by a substrate shield type, in which case no merge is
+ *	done.
+ *
+ * Result:
+ *	Return 0 if a substrate was extracted, or doesn't require
+ *	extracting; 1 if not.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+extHierSubstrate(ha, use, x, y)
+    HierExtractArg *ha; 	// Contains parent def and hash table
+    CellUse *use;		// Child use
+    int x, y;			// Array subscripts, or -1 if not an array
+{
+    char *name1, *name2;
+    bool shield;
+
+    /* Backwards compatibility with tech files that don't */
+    /* define a substrate plane or substrate connections. */
+    if (glob_subsnode == NULL) return 0;
+
+    /* If the substrate has already been extracted for this use	*/
+    /* then there is no need to do it again.			*/
+    if (use->cu_flags & CU_SUB_EXTRACTED) return 0;
+
+    /* Don't extract anything from cells marked "don't use".	*/
+    if (use->cu_def->cd_flags & CDDONTUSE) return 0;
+
+    /* Register the name of the parent's substrate */
+    /* The parent def's substrate node is in glob_subsnode */
+
+    name1 = extNodeName(glob_subsnode);
+    /* Don't process "(none)" nodes! */
+    if (*name1 == '(' && !strcmp(name1, "(none)")) return 0;
+
+    /* extNodeName() may return a static buffer, which the call	*/
+    /* to extHierSubstrateName() below overwrites, so copy it.	*/
+    name1 = StrDup((char **)NULL, name1);
+
+    name2 = extHierSubstrateName(ha, use, &shield);
+    if (name2 == NULL)
+    {
+	freeMagic(name1);
+	return (shield) ? 1 : 0;
+    }
+
+    extHierSubstrateMerge(ha, use, name1, name2, x, y);
+    freeMagic(name1);
+    freeMagic(name2);
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ * extHierSubstrateArray --
+ *
+ *	Connect the parent substrate to the substrate of every element
+ *	of the (possibly arrayed) child 'use'.  This is equivalent to
+ *	calling extHierSubstrate() once for each array element, but
+ *	the child substrate node and the substrate shield check, which
+ *	are the same for every element of the array, are computed only
+ *	once, so that the cost of extracting the substrate of an array
+ *	does not depend on the number of elements in it beyond the
+ *	bookkeeping of one name per element.
+ *
+ * Result:
+ *	Return 0 if a substrate was extracted, or doesn't require
+ *	extracting; 1 if not.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+extHierSubstrateArray(ha, use)
+    HierExtractArg *ha; 	// Contains parent def and hash table
+    CellUse *use;		// Child use
+{
+    char *name1, *name2;
+    bool shield;
+    int x, y;
+
+    if (glob_subsnode == NULL) return 0;
+    if (use->cu_flags & CU_SUB_EXTRACTED) return 0;
+    if (use->cu_def->cd_flags & CDDONTUSE) return 0;
+
+    name1 = extNodeName(glob_subsnode);
+    if (*name1 == '(' && !strcmp(name1, "(none)")) return 0;
+
+    /* extNodeName() may return a static buffer;  see extHierSubstrate() */
+    name1 = StrDup((char **)NULL, name1);
+
+    name2 = extHierSubstrateName(ha, use, &shield);
+    if (name2 == NULL)
+    {
+	freeMagic(name1);
+	return (shield) ? 1 : 0;
+    }
+
+    if (use->cu_xhi == use->cu_xlo && use->cu_yhi == use->cu_ylo)
+	extHierSubstrateMerge(ha, use, name1, name2, -1, -1);
+    else if (use->cu_xhi == use->cu_xlo)
+    {
+	for (y = MIN(use->cu_ylo, use->cu_yhi);
+		y <= MAX(use->cu_ylo, use->cu_yhi); y++)
+	    extHierSubstrateMerge(ha, use, name1, name2, -1, y);
+    }
+    else if (use->cu_yhi == use->cu_ylo)
+    {
+	for (x = MIN(use->cu_xlo, use->cu_xhi);
+		x <= MAX(use->cu_xlo, use->cu_xhi); x++)
+	    extHierSubstrateMerge(ha, use, name1, name2, x, -1);
+    }
+    else
+    {
+	for (x = MIN(use->cu_xlo, use->cu_xhi);
+		x <= MAX(use->cu_xlo, use->cu_xhi); x++)
+	    for (y = MIN(use->cu_ylo, use->cu_yhi);
+			y <= MAX(use->cu_ylo, use->cu_yhi); y++)
+		extHierSubstrateMerge(ha, use, name1, name2, x, y);
+    }
+
+    freeMagic(name1);
+    freeMagic(name2);
     return 0;
 }
 
@@ -0,0 +1,2415 @@
+/*
+ * ExtIncr.c --
+ *
+ * Circuit extraction.
+ * Incremental re-extraction of flat cells.
+ *
+ * After a cell without subcells has been extracted in full, a copy of
+ * its paint is kept in which each tile is tagged with the index of the
+ * node it belonged to, along with the names of those nodes, the cell's
+ * labels, and the body of the .ext file that was written.  The next time
+ * the cell is extracted, its paint and labels are compared against the
+ * copy.  Only the nodes within coupling distance of the changed area,
+ * and the devices connected to them, are extracted again, from a yank
+ * buffer holding a window around them.  The .ext records for those
+ * nodes and devices are then replaced in the saved body, and the file
+ * is rewritten.
+ *
+ * Whenever the change cannot be handled this way (it touches the
+ * substrate node, it spreads over too much of the cell, node names
+ * would become ambiguous, etc.), the cell is extracted in full, which
+ * also refreshes the saved copy.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/magic.h"
+#include "utils/geometry.h"
+#include "utils/geofast.h"
+#include "tiles/tile.h"
+#include "utils/hash.h"
+#include "database/database.h"
+#include "utils/malloc.h"
+#include "textio/textio.h"
+#include "debug/debug.h"
+#include "extract/extract.h"
+#include "extract/extractInt.h"
+#include "extract/extDebugInt.h"
+#include "utils/signals.h"
+#include "utils/utils.h"
+
+/*
+ * If the window that has to be re-extracted covers more than this
+ * fraction of the cell's area, a full extraction is done instead.
+ */
+#define EXT_INCR_MAXFRACTION	0.25
+
+/* One node of the last full or incremental extraction */
+typedef struct
+{
+    char	*ein_name;	/* Node name, or NULL if the node is gone */
+    Rect	 ein_area;	/* Bounding box of the node's paint */
+} ExtIncrNode;
+
+/* Everything remembered about a cell between extractions */
+typedef struct
+{
+    char	 *ei_name;	/* Name of the cell when it was saved */
+    ExtStyle	 *ei_style;	/* Extraction style in effect */
+    int		  ei_options;	/* ExtOptions in effect */
+    Plane	 *ei_planes[MAXPLANES];	/* Copy of the cell's paint.  The
+				 * client of each tile is the index of
+				 * its node in ei_nodes, or CLIENTDEFAULT.
+				 */
+    ExtIncrNode	 *ei_nodes;	/* Nodes, indexed as above */
+    int		  ei_nnodes;	/* Number of entries used in ei_nodes */
+    int		  ei_maxnodes;	/* Number of entries allocated */
+    int		  ei_live;	/* Number of nodes that still exist */
+    int		  ei_subsnode;	/* Index of the substrate node, or -1 */
+    HashTable	  ei_labels;	/* Label key -> number of such labels */
+    dlong	  ei_devArea[TT_MAXTYPES];	/* Area of each device type */
+    char	**ei_lines;	/* Body of the .ext file (no header) */
+    int		  ei_nlines;	/* Number of lines in ei_lines */
+    bool	  ei_pending;	/* TRUE until ei_lines has been read */
+} ExtIncr;
+
+/* Per-region information gathered while naming the re-extracted nodes */
+typedef struct
+{
+    int		 eir_index;	/* Old node this region is part of, or -1 */
+    bool	 eir_affected;	/* TRUE if the region must be re-output */
+    bool	 eir_boundary;	/* TRUE if the region is near the window edge */
+    int		 eir_newIndex;	/* Index assigned when the copy is updated */
+    char	*eir_name;	/* Name of an affected region */
+} ExtIncrReg;
+
+/* Paint of one tile of an affected node in the yank buffer */
+typedef struct eit
+{
+    int		 eit_pNum;
+    TileType	 eit_type;
+    Rect	 eit_rect;
+    ExtIncrReg	*eit_reg;
+    struct eit	*eit_next;
+} ExtIncrTile;
+
+/* State of one incremental extraction */
+typedef struct
+{
+    CellDef	 *eia_def;	/* Cell being extracted */
+    ExtIncr	 *eia_ei;	/* What was saved for the cell */
+    Plane	**eia_dirty;	/* Changed paint, one plane per paint plane */
+    Plane	 *eia_union;	/* Changed area over all planes and labels */
+    Plane	 *eia_seed;	/* Changed area bloated by the coupling halo */
+    Plane	 *eia_geom;	/* Paint of affected nodes, bloated by 1 */
+    Plane	 *eia_devs;	/* Paint of affected devices */
+    bool	 *eia_oldAffected; /* Per old node, TRUE if it is re-output */
+    Rect	  eia_window;	/* Area yanked for re-extraction */
+    Rect	  eia_inner;	/* Affected material must lie inside this */
+    Rect	  eia_box;	/* Accumulated bounding box */
+    int		  eia_pNum;	/* Plane currently being searched */
+    int		  eia_index;	/* Node index being assigned */
+    int		  eia_sign;	/* +1 or -1 when accumulating device area */
+    Rect	 *eia_clip;	/* Clip area when accumulating device area */
+    bool	  eia_abort;	/* Set to abandon the incremental extraction */
+    HashTable	  eia_regions;	/* NodeRegion * -> ExtIncrReg * */
+    HashTable	 *eia_visited;	/* Device tiles already seen */
+    ExtIncrReg	 *eia_reg;	/* Region being classified */
+    HashTable	  eia_newNames;	/* Names of all re-output nodes */
+    ExtIncrTile	 *eia_tiles;	/* Paint of re-output nodes */
+    LabelList	 *eia_fakeLists; /* Label lists made up to rename nodes */
+    Label	**eia_labels;	/* Yanked labels on re-output nodes */
+    int		  eia_nlabels;
+    int		  eia_maxlabels;
+} ExtIncrArg;
+
+/* Saved state, one ExtIncr per CellDef */
+static HashTable extIncrTable;
+static bool extIncrTableInit = FALSE;
+
+/* Yank buffer for the window being re-extracted */
+CellDef *extIncrYankDef = (CellDef *) NULL;
+static CellUse *extIncrYankUse = (CellUse *) NULL;
+
+/* Non-NULL while the yank buffer is being extracted */
+static ExtIncrArg *extIncrCur = (ExtIncrArg *) NULL;
+
+/* Scratch planes */
+static Plane *extIncrDirty[MAXPLANES];
+static Plane *extIncrUnion = (Plane *) NULL;
+static Plane *extIncrSeed = (Plane *) NULL;
+static Plane *extIncrGeom = (Plane *) NULL;
+static Plane *extIncrDevs = (Plane *) NULL;
+
+/* Forward declarations */
+void ExtIncrFree();
+bool extIncrEligible();
+void extIncrFreeOne();
+void extIncrFreeLines();
+void extIncrLabelKey();
+char *extIncrReadLine();
+char *extIncrField();
+int extIncrCopyFunc();
+int extIncrTagFunc();
+int extIncrTagSetFunc();
+int extIncrDevAreaFunc();
+int extIncrDiffFunc();
+int extIncrDiffPaintFunc();
+int extIncrUnionFunc();
+int extIncrSeedFunc();
+int extIncrOldFunc();
+int extIncrSubsFunc();
+int extIncrBoxFunc();
+int extIncrDevBoxFunc();
+int extIncrClassifyFunc();
+int extIncrClassifyOldFunc();
+int extIncrRecordFunc();
+int extIncrDevMarkFunc();
+int extIncrDevPaintFunc();
+int extIncrTermCheckFunc();
+int extIncrRepaintFunc();
+int extIncrResetFunc();
+int extIncrCopyClipFunc();
+int extIncrLiveFunc();
+void extIncrDevFlood();
+bool extIncrPatch();
+void extIncrUpdate();
+
+extern int extEnumFunc();
+extern void extHeader();
+extern void extOutputParameters();
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrLookup --
+ *
+ * Find the ExtIncr record saved for 'def'.
+ *
+ * Results:
+ *	Returns a pointer to the record, or NULL if there is none and
+ *	'create' is FALSE.
+ *
+ * Side effects:
+ *	If 'create' is TRUE, an empty record is made if none exists.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+ExtIncr *
+extIncrLookup(def, create)
+    CellDef *def;
+    bool create;
+{
+    HashEntry *he;
+    ExtIncr *ei;
+    int pNum;
+
+    if (!extIncrTableInit)
+    {
+	if (!create) return (ExtIncr *) NULL;
+	HashInit(&extIncrTable, 32, HT_WORDKEYS);
+	extIncrTableInit = TRUE;
+    }
+
+    if (!create)
+    {
+	he = HashLookOnly(&extIncrTable, (char *) def);
+	return (he) ? (ExtIncr *) HashGetValue(he) : (ExtIncr *) NULL;
+    }
+
+    he = HashFind(&extIncrTable, (char *) def);
+    ei = (ExtIncr *) HashGetValue(he);
+    if (ei == (ExtIncr *) NULL)
+    {
+	ei = (ExtIncr *) mallocMagic(sizeof (ExtIncr));
+	ei->ei_name = StrDup((char **) NULL, def->cd_name);
+	ei->ei_style = ExtCurStyle;
+	ei->ei_options = ExtOptions;
+	for (pNum = 0; pNum < MAXPLANES; pNum++)
+	    ei->ei_planes[pNum] = (Plane *) NULL;
+	ei->ei_nodes = (ExtIncrNode *) NULL;
+	ei->ei_nnodes = ei->ei_maxnodes = ei->ei_live = 0;
+	ei->ei_subsnode = -1;
+	HashInit(&ei->ei_labels, 32, HT_STRINGKEYS);
+	memset(ei->ei_devArea, 0, sizeof ei->ei_devArea);
+	ei->ei_lines = (char **) NULL;
+	ei->ei_nlines = 0;
+	ei->ei_pending = TRUE;
+	HashSetValue(he, (ClientData) ei);
+    }
+    return ei;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ExtIncrFree --
+ *
+ * Forget what was saved for incremental extraction of 'def', or of
+ * all cells if 'def' is NULL.  Called when "extract no partial"
+ * is given.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+ExtIncrFree(def)
+    CellDef *def;
+{
+    HashSearch hs;
+    HashEntry *he;
+    ExtIncr *ei;
+
+    if (!extIncrTableInit) return;
+
+    if (def != (CellDef *) NULL)
+    {
+	he = HashLookOnly(&extIncrTable, (char *) def);
+	if (he == NULL) return;
+	ei = (ExtIncr *) HashGetValue(he);
+	if (ei) extIncrFreeOne(ei);
+	HashSetValue(he, (ClientData) NULL);
+	return;
+    }
+
+    HashStartSearch(&hs);
+    while ((he = HashNext(&extIncrTable, &hs)))
+    {
+	ei = (ExtIncr *) HashGetValue(he);
+	if (ei) extIncrFreeOne(ei);
+    }
+    HashKill(&extIncrTable);
+    extIncrTableInit = FALSE;
+}
+
+void
+extIncrFreeOne(ei)
+    ExtIncr *ei;
+{
+    int pNum, n;
+
+    for (pNum = 0; pNum < MAXPLANES; pNum++)
+	if (ei->ei_planes[pNum] != (Plane *) NULL)
+	{
+	    DBFreePaintPlane(ei->ei_planes[pNum]);
+	    TiFreePlane(ei->ei_planes[pNum]);
+	}
+    for (n = 0; n < ei->ei_nnodes; n++)
+	if (ei->ei_nodes[n].ein_name)
+	    freeMagic(ei->ei_nodes[n].ein_name);
+    if (ei->ei_nodes) freeMagic((char *) ei->ei_nodes);
+    HashKill(&ei->ei_labels);
+    extIncrFreeLines(ei->ei_lines, ei->ei_nlines);
+    freeMagic(ei->ei_name);
+    freeMagic((char *) ei);
+}
+
+void
+extIncrFreeLines(lines, nlines)
+    char **lines;
+    int nlines;
+{
+    int n;
+
+    if (lines == (char **) NULL) return;
+    for (n = 0; n < nlines; n++)
+	freeMagic(lines[n]);
+    freeMagic((char *) lines);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrEligible --
+ *
+ * Decide whether 'def' can be extracted incrementally at all with the
+ * current options.  Hierarchical cells, full R-C extraction, path
+ * lengths (when drivers have been given), and cells with the "device"
+ * or "LEFview" properties are always extracted in full.
+ *
+ * Results:
+ *	TRUE if incremental extraction may be used.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+extIncrEligible(def, isTop)
+    CellDef *def;
+    bool isTop;
+{
+    bool propfound;
+
+    if (!(ExtOptions & EXT_DOPARTIAL)) return FALSE;
+    if (ExtOptions & EXT_DOEXTRESIST) return FALSE;
+    if (isTop && (ExtOptions & EXT_DOLENGTH)
+		&& HashGetNumEntries(&extDriverHash) > 0)
+	return FALSE;
+    if (def->cd_flags & CDINTERNAL) return FALSE;
+
+    if (DBSrCellPlaneArea(def->cd_cellPlane, &TiPlaneRect, extEnumFunc,
+		(ClientData) NULL))
+	return FALSE;
+
+    propfound = FALSE;
+    DBPropGet(def, "device", &propfound);
+    if (propfound) return FALSE;
+    DBPropGet(def, "LEFview", &propfound);
+    if (propfound) return FALSE;
+
+    return TRUE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrLabelKey --
+ *
+ * Print into 'buf' a string identifying everything about 'lab' that
+ * matters to extraction.  Marks left on labels by a previous extraction
+ * (lab_port == INFINITY) are ignored.  'buf' must hold at least
+ * strlen(lab->lab_text) + 100 characters.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Fills in 'buf'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extIncrLabelKey(lab, buf)
+    Label *lab;
+    char *buf;
+{
+    sprintf(buf, "%d %d %d %d %d %u %u %s", lab->lab_type,
+		lab->lab_rect.r_xbot, lab->lab_rect.r_ybot,
+		lab->lab_rect.r_xtop, lab->lab_rect.r_ytop,
+		(unsigned int) lab->lab_flags,
+		(lab->lab_port == INFINITY) ? 0 : lab->lab_port,
+		lab->lab_text);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ExtIncrSave --
+ *
+ * Called from extCellFile() after a full extraction of 'def', while
+ * its tiles still point to the node regions in 'nodeList'.  Saves a
+ * copy of the paint tagged with node indices, the node names, and the
+ * labels.  The body of the .ext file is read back afterwards by
+ * ExtIncrSaveLines().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Replaces anything previously saved for 'def'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+ExtIncrSave(def, nodeList, isTop)
+    CellDef *def;
+    NodeRegion *nodeList;
+    bool isTop;
+{
+    ExtIncr *ei;
+    NodeRegion *reg;
+    HashTable regHash;
+    HashEntry *he;
+    Label *lab;
+    char *key;
+    int pNum, n, keylen;
+
+    ExtIncrFree(def);
+    if (SigInterruptPending || !extIncrEligible(def, isTop))
+	return;
+
+    ei = extIncrLookup(def, TRUE);
+
+    /* Number the nodes */
+    HashInit(&regHash, 256, HT_WORDKEYS);
+    for (reg = nodeList, n = 0; reg; reg = reg->nreg_next) n++;
+    ei->ei_maxnodes = n + 16;
+    ei->ei_nodes = (ExtIncrNode *) mallocMagic(ei->ei_maxnodes
+		* sizeof (ExtIncrNode));
+    for (reg = nodeList, n = 0; reg; reg = reg->nreg_next, n++)
+    {
+	ei->ei_nodes[n].ein_name = StrDup((char **) NULL,
+		extNodeName((LabRegion *) reg));
+	ei->ei_nodes[n].ein_area = GeoNullRect;
+	he = HashFind(&regHash, (char *) reg);
+	HashSetValue(he, INT2CD(n + 1));
+	if (reg == glob_subsnode) ei->ei_subsnode = n;
+    }
+    ei->ei_nnodes = ei->ei_live = n;
+
+    /* Copy the paint, then tag each tile with its node */
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	ei->ei_planes[pNum] = DBNewPlane((ClientData) TT_SPACE);
+	if (DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrCopyFunc,
+		(ClientData) ei->ei_planes[pNum]))
+	{
+	    /* Non-Manhattan geometry is not handled */
+	    HashKill(&regHash);
+	    ExtIncrFree(def);
+	    return;
+	}
+    }
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	ExtIncrArg arg;
+
+	arg.eia_ei = ei;
+	arg.eia_pNum = pNum;
+	arg.eia_visited = &regHash;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrTagFunc, (ClientData) &arg);
+	arg.eia_sign = 1;
+	arg.eia_clip = (Rect *) NULL;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&ExtCurStyle->exts_deviceMask, extIncrDevAreaFunc,
+		(ClientData) &arg);
+    }
+    HashKill(&regHash);
+
+    /* Remember the labels */
+    keylen = 0;
+    key = NULL;
+    for (lab = def->cd_labels; lab; lab = lab->lab_next)
+    {
+	n = strlen(lab->lab_text) + 100;
+	if (n > keylen)
+	{
+	    if (key) freeMagic(key);
+	    key = mallocMagic(keylen = n);
+	}
+	extIncrLabelKey(lab, key);
+	he = HashFind(&ei->ei_labels, key);
+	HashSetValue(he, INT2CD(CD2INT(HashGetValue(he)) + 1));
+    }
+    if (key) freeMagic(key);
+}
+
+/*
+ * Filter functions for ExtIncrSave().
+ *
+ * extIncrCopyFunc() paints a tile into the copy, or aborts the search
+ * on a split tile.  extIncrTagFunc() finds the index of the node that
+ * a tile of the cell belongs to, and passes it to extIncrTagSetFunc()
+ * to set the client of the matching tiles of the copy.
+ * extIncrDevAreaFunc() adds the area of a device tile (clipped to
+ * arg->eia_clip if that is non-NULL) into ei_devArea.
+ */
+
+int
+extIncrCopyFunc(tile, dinfo, plane)
+    Tile *tile;
+    TileType dinfo;
+    Plane *plane;
+{
+    Rect r;
+
+    if (IsSplit(tile)) return 1;
+    TITORECT(tile, &r);
+    DBPaintPlane(plane, &r, DBStdWriteTbl(TiGetType(tile)),
+		(PaintUndoInfo *) NULL);
+    return 0;
+}
+
+int
+extIncrTagFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    ExtIncr *ei = arg->eia_ei;
+    TileTypeBitMask mask;
+    HashEntry *he;
+    Rect r;
+
+    TITORECT(tile, &r);
+    he = HashLookOnly(arg->eia_visited, (char *) TiGetClient(tile));
+    arg->eia_index = (he) ? CD2INT(HashGetValue(he)) - 1 : -1;
+    if (arg->eia_index >= 0)
+	(void) GeoInclude(&r, &ei->ei_nodes[arg->eia_index].ein_area);
+
+    TTMaskSetOnlyType(&mask, TiGetType(tile));
+    (void) DBSrPaintArea((Tile *) NULL, ei->ei_planes[arg->eia_pNum], &r,
+		&mask, extIncrTagSetFunc, (ClientData) arg);
+    return 0;
+}
+
+int
+extIncrTagSetFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    if (arg->eia_index < 0)
+	TiSetClient(tile, CLIENTDEFAULT);
+    else
+	TiSetClientINT(tile, arg->eia_index);
+    return 0;
+}
+
+int
+extIncrDevAreaFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    if (arg->eia_clip) GEOCLIP(&r, arg->eia_clip);
+    if (r.r_xtop > r.r_xbot && r.r_ytop > r.r_ybot)
+	arg->eia_ei->ei_devArea[TiGetType(tile)] +=
+		arg->eia_sign * (dlong) (r.r_xtop - r.r_xbot)
+		* (dlong) (r.r_ytop - r.r_ybot);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrReadLine --
+ *
+ * Read one line of any length from 'f', without the trailing newline.
+ *
+ * Results:
+ *	Returns a string allocated with mallocMagic(), or NULL at EOF.
+ *
+ * Side effects:
+ *	Advances the file position.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+char *
+extIncrReadLine(f)
+    FILE *f;
+{
+    char buf[1024], *line, *newline;
+    int len, total;
+
+    line = NULL;
+    total = 0;
+    while (fgets(buf, sizeof buf, f) != NULL)
+    {
+	len = strlen(buf);
+	newline = mallocMagic(total + len + 1);
+	if (line)
+	{
+	    memcpy(newline, line, total);
+	    freeMagic(line);
+	}
+	memcpy(newline + total, buf, len + 1);
+	line = newline;
+	total += len;
+	if (total > 0 && line[total - 1] == '\n')
+	{
+	    line[--total] = '\0';
+	    break;
+	}
+    }
+    return line;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ExtIncrSaveLines --
+ *
+ * Called from ExtCell() after the .ext file for 'def' has been closed.
+ * If ExtIncrSave() saved the paint of 'def' during this extraction,
+ * read back the body of the file (everything after the header that
+ * extHeader() writes) to complete the saved state.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Reads the file 'filename'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+ExtIncrSaveLines(def, filename)
+    CellDef *def;
+    char *filename;
+{
+    ExtIncr *ei;
+    FILE *f;
+    char *line;
+    int maxlines;
+    static const char * const headerKeys[] = {
+	"timestamp ", "version ", "tech ", "style ", "scale ",
+	"resistclasses", "parameters :", NULL
+    };
+    const char * const *hp;
+
+    ei = extIncrLookup(def, FALSE);
+    if (ei == (ExtIncr *) NULL || !ei->ei_pending) return;
+
+    if (SigInterruptPending || filename == NULL
+		|| (f = fopen(filename, "r")) == NULL)
+    {
+	ExtIncrFree(def);
+	return;
+    }
+
+    maxlines = 256;
+    ei->ei_lines = (char **) mallocMagic(maxlines * sizeof (char *));
+    ei->ei_nlines = 0;
+    while ((line = extIncrReadLine(f)) != NULL)
+    {
+	for (hp = headerKeys; *hp; hp++)
+	    if (!strncmp(line, *hp, strlen(*hp)))
+		break;
+	if (*hp != NULL)
+	{
+	    freeMagic(line);
+	    continue;
+	}
+	if (ei->ei_nlines == maxlines)
+	{
+	    char **newlines;
+
+	    newlines = (char **) mallocMagic(2 * maxlines * sizeof (char *));
+	    memcpy(newlines, ei->ei_lines, maxlines * sizeof (char *));
+	    freeMagic((char *) ei->ei_lines);
+	    ei->ei_lines = newlines;
+	    maxlines *= 2;
+	}
+	ei->ei_lines[ei->ei_nlines++] = line;
+    }
+    fclose(f);
+    ei->ei_pending = FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrField --
+ *
+ * Copy the next blank-separated field of 'cp' into 'buf', removing
+ * the surrounding double quotes if the field is quoted.  'buf' must be
+ * at least as long as the string 'cp'.
+ *
+ * Results:
+ *	Returns a pointer to the remainder of the line after the field,
+ *	or NULL if there is no field.
+ *
+ * Side effects:
+ *	Fills in 'buf'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+char *
+extIncrField(cp, buf)
+    char *cp;
+    char *buf;
+{
+    while (*cp == ' ') cp++;
+    if (*cp == '\0') return NULL;
+
+    if (*cp == '"')
+    {
+	cp++;
+	while (*cp != '"' && *cp != '\0') *buf++ = *cp++;
+	if (*cp == '"') cp++;
+    }
+    else
+	while (*cp != ' ' && *cp != '\0') *buf++ = *cp++;
+    *buf = '\0';
+    return cp;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ExtIncrCell --
+ *
+ * Try to extract 'def' incrementally.  Called from extCellFile() after
+ * the substrate plane of 'def' has been prepared, but before anything
+ * has been written to 'f'.
+ *
+ * Results:
+ *	TRUE if 'def' was extracted and its .ext file written to 'f';
+ *	FALSE if the caller must extract 'def' in full (in which case
+ *	nothing has been written to 'f').
+ *
+ * Side effects:
+ *	Writes to 'f'.  Updates the state saved for 'def', and the
+ *	extraction marks on the labels of re-extracted nodes.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+ExtIncrCell(def, f, isTop)
+    CellDef *def;
+    FILE *f;
+    bool isTop;
+{
+    ExtIncr *ei;
+    ExtIncrArg arg;
+    HashTable curLabels, labelMap;
+    HashSearch hs;
+    HashEntry *he, *he2;
+    Label *lab;
+    Rect r, bbox;
+    dlong warea, carea;
+    char *key, **newlines;
+    int pNum, n, keylen, halo, nnewlines;
+    bool result, unchanged;
+
+    ei = extIncrLookup(def, FALSE);
+    if (ei == (ExtIncr *) NULL || ei->ei_pending) return FALSE;
+
+    if (!extIncrEligible(def, isTop) || ei->ei_style != ExtCurStyle
+		|| ei->ei_options != ExtOptions
+		|| strcmp(ei->ei_name, def->cd_name))
+    {
+	ExtIncrFree(def);
+	return FALSE;
+    }
+
+    /* Scratch planes */
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+	if (extIncrDirty[pNum] == (Plane *) NULL)
+	    extIncrDirty[pNum] = DBNewPlane((ClientData) TT_SPACE);
+    if (extIncrUnion == (Plane *) NULL)
+    {
+	extIncrUnion = DBNewPlane((ClientData) TT_SPACE);
+	extIncrSeed = DBNewPlane((ClientData) TT_SPACE);
+	extIncrGeom = DBNewPlane((ClientData) TT_SPACE);
+	extIncrDevs = DBNewPlane((ClientData) TT_SPACE);
+    }
+    if (extIncrYankDef == (CellDef *) NULL)
+	DBNewYank("__ext_incremental", &extIncrYankUse, &extIncrYankDef);
+
+    bzero((char *) &arg, sizeof arg);
+    arg.eia_def = def;
+    arg.eia_ei = ei;
+    arg.eia_dirty = extIncrDirty;
+    arg.eia_union = extIncrUnion;
+    arg.eia_seed = extIncrSeed;
+    arg.eia_geom = extIncrGeom;
+    arg.eia_devs = extIncrDevs;
+    arg.eia_abort = FALSE;
+    HashInit(&curLabels, 32, HT_STRINGKEYS);
+    HashInit(&labelMap, 32, HT_STRINGKEYS);
+    HashInit(&arg.eia_regions, 256, HT_WORDKEYS);
+    HashInit(&arg.eia_newNames, 256, HT_STRINGKEYS);
+    result = FALSE;
+
+    /*
+     * Find everything that changed since the last extraction:
+     * first the paint, plane by plane, then the labels.
+     */
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	arg.eia_pNum = pNum;
+	if (DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&DBAllTypeBits, extIncrDiffFunc, (ClientData) &arg))
+	    goto fallback;
+	(void) DBSrPaintArea((Tile *) NULL, extIncrDirty[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrUnionFunc, (ClientData) &arg);
+    }
+
+    keylen = 0;
+    key = NULL;
+    for (lab = def->cd_labels; lab; lab = lab->lab_next)
+    {
+	n = strlen(lab->lab_text) + 100;
+	if (n > keylen)
+	{
+	    if (key) freeMagic(key);
+	    key = mallocMagic(keylen = n);
+	}
+	extIncrLabelKey(lab, key);
+	he = HashFind(&curLabels, key);
+	HashSetValue(he, INT2CD(CD2INT(HashGetValue(he)) + 1));
+	he = HashFind(&labelMap, key);
+	if (HashGetValue(he) == NULL) HashSetValue(he, (ClientData) lab);
+    }
+    if (key) freeMagic(key);
+
+    for (n = 0; n < 2; n++)
+    {
+	HashTable *table = (n == 0) ? &curLabels : &ei->ei_labels;
+	HashTable *other = (n == 0) ? &ei->ei_labels : &curLabels;
+	int type;
+
+	HashStartSearch(&hs);
+	while ((he = HashNext(table, &hs)))
+	{
+	    he2 = HashLookOnly(other, he->h_key.h_name);
+	    if (he2 && CD2INT(HashGetValue(he2)) == CD2INT(HashGetValue(he)))
+		continue;
+	    if (n == 1 && he2) continue;	/* Already seen from the other side */
+
+	    if (sscanf(he->h_key.h_name, "%d %d %d %d %d", &type,
+			&r.r_xbot, &r.r_ybot, &r.r_xtop, &r.r_ytop) != 5)
+		goto fallback;
+
+	    /* Labels on space attach to the substrate node */
+	    if (type == TT_SPACE) goto fallback;
+
+	    GEO_EXPAND(&r, 1, &r);
+	    DBPaintPlane(extIncrUnion, &r, DBStdWriteTbl(TT_ERROR_P),
+			(PaintUndoInfo *) NULL);
+	}
+    }
+
+    unchanged = (DBSrPaintArea((Tile *) NULL, extIncrUnion, &TiPlaneRect,
+		&DBAllButSpaceBits, extEnumFunc, (ClientData) NULL) == 0);
+    if (unchanged)
+    {
+	extHeader(def, f);
+	for (n = 0; n < ei->ei_nlines; n++)
+	    fprintf(f, "%s\n", ei->ei_lines[n]);
+	result = TRUE;
+	goto done;
+    }
+
+    /*
+     * Everything within the coupling halo of a change may see a
+     * different capacitance, so all nodes with paint in the bloated
+     * change area (the "seed") are output again.
+     */
+    halo = ExtCurStyle->exts_sideCoupleHalo + 1;
+    arg.eia_box = GeoNullRect;
+    arg.eia_index = halo;
+    (void) DBSrPaintArea((Tile *) NULL, extIncrUnion, &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrSeedFunc, (ClientData) &arg);
+    bbox = arg.eia_box;
+
+    arg.eia_oldAffected = (bool *) mallocMagic(ei->ei_nnodes * sizeof (bool));
+    for (n = 0; n < ei->ei_nnodes; n++) arg.eia_oldAffected[n] = FALSE;
+
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	arg.eia_pNum = pNum;
+
+	/* Changes to substrate node paint are not handled */
+	if (DBSrPaintArea((Tile *) NULL, extIncrDirty[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrSubsFunc, (ClientData) &arg))
+	    goto fallback;
+	(void) DBSrPaintArea((Tile *) NULL, extIncrSeed, &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrOldFunc, (ClientData) &arg);
+    }
+    for (n = 0; n < ei->ei_nnodes; n++)
+	if (arg.eia_oldAffected[n])
+	    (void) GeoInclude(&ei->ei_nodes[n].ein_area, &bbox);
+
+    /*
+     * Devices near any of this area may be output again, too, and with
+     * them the area of their terminals.
+     */
+    arg.eia_box = bbox;
+    GEO_EXPAND(&bbox, 3, &r);
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	HashTable visited;
+
+	arg.eia_pNum = pNum;
+	HashInit(&visited, 32, HT_WORDKEYS);
+	arg.eia_visited = &visited;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &r,
+		&ExtCurStyle->exts_deviceMask, extIncrDevBoxFunc,
+		(ClientData) &arg);
+	HashKill(&visited);
+    }
+    bbox = arg.eia_box;
+
+    /*
+     * The window to re-extract includes everything within coupling
+     * distance of the affected material, which must itself lie
+     * inside eia_inner.
+     */
+    GEO_EXPAND(&bbox, (halo + 1), &arg.eia_window);
+    GEO_EXPAND(&bbox, 1, &arg.eia_inner);
+    warea = (dlong) (arg.eia_window.r_xtop - arg.eia_window.r_xbot)
+		* (dlong) (arg.eia_window.r_ytop - arg.eia_window.r_ybot);
+    carea = (dlong) (def->cd_bbox.r_xtop - def->cd_bbox.r_xbot)
+		* (dlong) (def->cd_bbox.r_ytop - def->cd_bbox.r_ybot);
+    if ((double) warea > EXT_INCR_MAXFRACTION * (double) carea)
+	goto fallback;
+
+    if (!extIncrPatch(&arg, &newlines, &nnewlines))
+	goto fallback;
+
+    extHeader(def, f);
+    for (n = 0; n < nnewlines; n++)
+	fprintf(f, "%s\n", newlines[n]);
+
+    extIncrUpdate(&arg, newlines, nnewlines, &curLabels, &labelMap);
+    result = TRUE;
+    goto done;
+
+fallback:
+    ExtIncrFree(def);
+
+done:
+    {
+	ExtIncrTile *eit;
+	LabelList *ll;
+
+	free_magic1_t mm1 = freeMagic1_init();
+	for (eit = arg.eia_tiles; eit; eit = eit->eit_next)
+	    freeMagic1(&mm1, (char *) eit);
+	freeMagic1_end(&mm1);
+
+	free_magic1_t mm1_ = freeMagic1_init();
+	for (ll = arg.eia_fakeLists; ll; ll = ll->ll_next)
+	{
+	    freeMagic((char *) ll->ll_label);
+	    freeMagic1(&mm1_, (char *) ll);
+	}
+	freeMagic1_end(&mm1_);
+    }
+    HashStartSearch(&hs);
+    while ((he = HashNext(&arg.eia_regions, &hs)))
+    {
+	ExtIncrReg *eir = (ExtIncrReg *) HashGetValue(he);
+
+	if (eir == (ExtIncrReg *) NULL) continue;
+	if (eir->eir_name) freeMagic(eir->eir_name);
+	freeMagic((char *) eir);
+    }
+    if (arg.eia_labels) freeMagic((char *) arg.eia_labels);
+    if (arg.eia_oldAffected) freeMagic((char *) arg.eia_oldAffected);
+    HashKill(&curLabels);
+    HashKill(&labelMap);
+    HashKill(&arg.eia_regions);
+    HashKill(&arg.eia_newNames);
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+	DBClearPaintPlane(extIncrDirty[pNum]);
+    DBClearPaintPlane(extIncrUnion);
+    DBClearPaintPlane(extIncrSeed);
+    DBClearPaintPlane(extIncrGeom);
+    DBClearPaintPlane(extIncrDevs);
+    DBCellClearDef(extIncrYankDef);
+    return result;
+}
+
+/*
+ * Filter functions for ExtIncrCell().
+ *
+ * extIncrDiffFunc() is called for each tile of the cell; any tile of
+ * the saved copy in the same area with a different type is painted
+ * into the dirty plane by extIncrDiffPaintFunc().  Split tiles abort
+ * the search.  extIncrUnionFunc() collects the dirty planes into one,
+ * and extIncrSeedFunc() bloats that by arg->eia_index into the seed
+ * plane.  extIncrSubsFunc() aborts if the substrate node had paint in
+ * a changed area, and extIncrOldFunc() marks the old nodes with paint
+ * in the seed area.  extIncrDevBoxFunc() adds every device touching
+ * the search area to arg->eia_box.
+ */
+
+int
+extIncrDiffFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    TileTypeBitMask mask;
+    Rect r;
+
+    if (IsSplit(tile)) return 1;
+    TITORECT(tile, &r);
+    GEOCLIP(&r, &TiPlaneRect);
+    TTMaskCom2(&mask, &DBZeroTypeBits);
+    TTMaskClearType(&mask, TiGetType(tile));
+    arg->eia_clip = &r;
+    return DBSrPaintArea((Tile *) NULL, arg->eia_ei->ei_planes[arg->eia_pNum],
+		&r, &mask, extIncrDiffPaintFunc, (ClientData) arg);
+}
+
+int
+extIncrDiffPaintFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    if (IsSplit(tile)) return 1;
+    TITORECT(tile, &r);
+    GEOCLIP(&r, arg->eia_clip);
+    DBPaintPlane(arg->eia_dirty[arg->eia_pNum], &r, DBStdWriteTbl(TT_ERROR_P),
+		(PaintUndoInfo *) NULL);
+    return 0;
+}
+
+int
+extIncrUnionFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    DBPaintPlane(arg->eia_union, &r, DBStdWriteTbl(TT_ERROR_P),
+		(PaintUndoInfo *) NULL);
+    return 0;
+}
+
+int
+extIncrSeedFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    GEO_EXPAND(&r, arg->eia_index, &r);
+    DBPaintPlane(arg->eia_seed, &r, DBStdWriteTbl(TT_ERROR_P),
+		(PaintUndoInfo *) NULL);
+    (void) GeoInclude(&r, &arg->eia_box);
+    return 0;
+}
+
+int
+extIncrSubsFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    ExtIncr *ei = arg->eia_ei;
+    Rect r;
+
+    if (ei->ei_subsnode < 0) return 0;
+    TITORECT(tile, &r);
+    arg->eia_index = ei->ei_subsnode;
+    return DBSrPaintArea((Tile *) NULL, ei->ei_planes[arg->eia_pNum], &r,
+		&DBAllButSpaceBits, extIncrBoxFunc, (ClientData) arg);
+}
+
+/* Returns 1 if a tile of the saved copy belongs to node arg->eia_index */
+
+int
+extIncrBoxFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    if (TiGetClient(tile) == CLIENTDEFAULT) return 0;
+    return (TiGetClientINT(tile) == arg->eia_index) ? 1 : 0;
+}
+
+int
+extIncrOldFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    (void) DBSrPaintArea((Tile *) NULL, arg->eia_ei->ei_planes[arg->eia_pNum],
+		&r, &DBAllButSpaceBits, extIncrLiveFunc, (ClientData) arg);
+    return 0;
+}
+
+int
+extIncrLiveFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    int idx;
+
+    if (TiGetClient(tile) == CLIENTDEFAULT) return 0;
+    idx = TiGetClientINT(tile);
+    if (idx >= 0 && idx < arg->eia_ei->ei_nnodes
+		&& idx != arg->eia_ei->ei_subsnode)
+	arg->eia_oldAffected[idx] = TRUE;
+    return 0;
+}
+
+int
+extIncrDevBoxFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    int extIncrDevIncludeFunc();
+
+    if (HashLookOnly(arg->eia_visited, (char *) tile) == NULL)
+	extIncrDevFlood(arg->eia_def, tile, arg->eia_pNum, arg->eia_visited,
+		extIncrDevIncludeFunc, extIncrDevIncludeFunc, (ClientData) arg);
+    return 0;
+}
+
+int
+extIncrDevIncludeFunc(tile, pNum, arg)
+    Tile *tile;
+    int pNum;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    (void) GeoInclude(&r, &arg->eia_box);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrDevFlood --
+ *
+ * Visit all the device tiles of 'def' connected to 'tile' (on plane
+ * 'pNum') through the device connectivity, calling
+ *
+ *	(*func)(tile, pNum, cdata)
+ *
+ * on each.  Then visit the source/drain terminal area of those devices,
+ * that is, the material on the same plane that abuts a device tile
+ * without being connected to it, and everything connected to that on
+ * the same plane other than devices, calling
+ *
+ *	(*termFunc)(tile, pNum, cdata)
+ *
+ * on each.  This is the area whose size is output with each terminal.
+ * Tiles that touch only at a corner are treated as connected, which
+ * errs on the side of including too much.  'visited' is a hash table
+ * (HT_WORDKEYS) of tiles already seen, and is updated.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever (*func)() and (*termFunc)() do.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+typedef struct
+{
+    Tile	**edf_tiles;	/* Stack of tiles still to be visited */
+    int		 *edf_planes;	/* Plane of each tile on the stack */
+    bool	 *edf_terms;	/* TRUE if the tile is terminal area */
+    int		  edf_ntiles;
+    int		  edf_max;
+    int		  edf_pNum;	/* Plane of tiles being pushed */
+    bool	  edf_term;	/* Whether tiles being pushed are terminals */
+    HashTable	 *edf_visited;
+} ExtDevFlood;
+
+void
+extIncrDevFlood(def, tile, pNum, visited, func, termFunc, cdata)
+    CellDef *def;
+    Tile *tile;
+    int pNum;
+    HashTable *visited;
+    int (*func)();
+    int (*termFunc)();
+    ClientData cdata;
+{
+    int extIncrDevPushFunc();
+    ExtDevFlood edf;
+    TileTypeBitMask mask;
+    TileType type;
+    Rect r;
+    int p;
+    bool isTerm;
+
+    edf.edf_max = 32;
+    edf.edf_tiles = (Tile **) mallocMagic(edf.edf_max * sizeof (Tile *));
+    edf.edf_planes = (int *) mallocMagic(edf.edf_max * sizeof (int));
+    edf.edf_terms = (bool *) mallocMagic(edf.edf_max * sizeof (bool));
+    edf.edf_ntiles = 0;
+    edf.edf_visited = visited;
+    edf.edf_pNum = pNum;
+    edf.edf_term = FALSE;
+    (void) extIncrDevPushFunc(tile, (TileType) 0, &edf);
+
+    while (edf.edf_ntiles > 0)
+    {
+	edf.edf_ntiles--;
+	tile = edf.edf_tiles[edf.edf_ntiles];
+	pNum = edf.edf_planes[edf.edf_ntiles];
+	isTerm = edf.edf_terms[edf.edf_ntiles];
+
+	type = TiGetType(tile);
+	TITORECT(tile, &r);
+	GEO_EXPAND(&r, 1, &r);
+
+	if (isTerm)
+	{
+	    (*termFunc)(tile, pNum, cdata);
+	    TTMaskAndMask3(&mask, &DBConnectTbl[type], &DBPlaneTypes[pNum]);
+	    TTMaskClearMask(&mask, &ExtCurStyle->exts_deviceMask);
+	    TTMaskClearType(&mask, TT_SPACE);
+	    edf.edf_pNum = pNum;
+	    edf.edf_term = TRUE;
+	    (void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &r, &mask,
+			extIncrDevPushFunc, (ClientData) &edf);
+	    continue;
+	}
+
+	(*func)(tile, pNum, cdata);
+	for (p = PL_TECHDEPBASE; p < DBNumPlanes; p++)
+	{
+	    TTMaskAndMask3(&mask, &ExtCurStyle->exts_deviceConn[type],
+			&ExtCurStyle->exts_deviceMask);
+	    TTMaskAndMask(&mask, &DBPlaneTypes[p]);
+	    if (TTMaskIsZero(&mask)) continue;
+	    edf.edf_pNum = p;
+	    edf.edf_term = FALSE;
+	    (void) DBSrPaintArea((Tile *) NULL, def->cd_planes[p], &r, &mask,
+			extIncrDevPushFunc, (ClientData) &edf);
+	}
+
+	/* Terminal area (but not the gate) */
+	TTMaskCom2(&mask, &DBConnectTbl[type]);
+	TTMaskAndMask(&mask, &DBPlaneTypes[pNum]);
+	TTMaskClearMask(&mask, &ExtCurStyle->exts_deviceMask);
+	TTMaskClearType(&mask, TT_SPACE);
+	edf.edf_pNum = pNum;
+	edf.edf_term = TRUE;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &r, &mask,
+		extIncrDevPushFunc, (ClientData) &edf);
+    }
+    freeMagic((char *) edf.edf_tiles);
+    freeMagic((char *) edf.edf_planes);
+    freeMagic((char *) edf.edf_terms);
+}
+
+int
+extIncrDevPushFunc(tile, dinfo, edf)
+    Tile *tile;
+    TileType dinfo;
+    ExtDevFlood *edf;
+{
+    HashEntry *he;
+
+    he = HashFind(edf->edf_visited, (char *) tile);
+    if (HashGetValue(he) != NULL) return 0;
+    HashSetValue(he, (ClientData) 1);
+
+    if (edf->edf_ntiles == edf->edf_max)
+    {
+	Tile **newtiles;
+	int *newplanes;
+	bool *newterms;
+
+	newtiles = (Tile **) mallocMagic(2 * edf->edf_max * sizeof (Tile *));
+	newplanes = (int *) mallocMagic(2 * edf->edf_max * sizeof (int));
+	newterms = (bool *) mallocMagic(2 * edf->edf_max * sizeof (bool));
+	memcpy(newtiles, edf->edf_tiles, edf->edf_max * sizeof (Tile *));
+	memcpy(newplanes, edf->edf_planes, edf->edf_max * sizeof (int));
+	memcpy(newterms, edf->edf_terms, edf->edf_max * sizeof (bool));
+	freeMagic((char *) edf->edf_tiles);
+	freeMagic((char *) edf->edf_planes);
+	freeMagic((char *) edf->edf_terms);
+	edf->edf_tiles = newtiles;
+	edf->edf_planes = newplanes;
+	edf->edf_terms = newterms;
+	edf->edf_max *= 2;
+    }
+    edf->edf_tiles[edf->edf_ntiles] = tile;
+    edf->edf_planes[edf->edf_ntiles] = edf->edf_pNum;
+    edf->edf_terms[edf->edf_ntiles] = edf->edf_term;
+    edf->edf_ntiles++;
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrNameNodes --
+ *
+ * Called from extBasic() while the yank buffer holding the window
+ * being re-extracted is extracted, after labels have been assigned to
+ * the node regions in 'nodeList'.  Each region is classified as either
+ * affected (it must be output again, under its own name) or unaffected
+ * (part of an old node whose records are kept).  Unaffected regions,
+ * and the substrate node, are given a made-up label carrying the name
+ * of the old node, so that coupling capacitors and device terminals
+ * referring to them come out with the right names.  Also finds the
+ * affected devices.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Replaces label lists of unaffected regions.  Sets eia_abort if
+ *	anything is found that incremental extraction can't handle.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extIncrNameNodes(nodeList)
+    NodeRegion *nodeList;
+{
+    ExtIncrArg *arg = extIncrCur;
+    ExtIncr *ei;
+    CellDef *def = extIncrYankDef;
+    NodeRegion *reg;
+    ExtIncrReg *eir;
+    LabelList *ll, *llnext;
+    HashEntry *he;
+    HashTable visited;
+    char *name;
+    int pNum;
+
+    if (arg == (ExtIncrArg *) NULL) return;
+    ei = arg->eia_ei;
+
+    /* Classify every tile of every region */
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes && !arg->eia_abort; pNum++)
+    {
+	arg->eia_pNum = pNum;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrClassifyFunc, (ClientData) arg);
+    }
+    if (arg->eia_abort) return;
+
+    /* Name the regions */
+    for (reg = nodeList; reg; reg = reg->nreg_next)
+    {
+	he = HashLookOnly(&arg->eia_regions, (char *) reg);
+	eir = (he) ? (ExtIncrReg *) HashGetValue(he) : (ExtIncrReg *) NULL;
+
+	if (reg == glob_subsnode)
+	{
+	    if (ei->ei_subsnode < 0) goto abort;
+
+	    /* Changed labels on the substrate are not handled */
+	    for (ll = reg->nreg_labels; ll; ll = ll->ll_next)
+	    {
+		Rect r;
+
+		GEO_EXPAND(&ll->ll_label->lab_rect, 1, &r);
+		if (DBSrPaintArea((Tile *) NULL, arg->eia_union, &r,
+			&DBAllButSpaceBits, extEnumFunc, (ClientData) NULL))
+		    goto abort;
+	    }
+	    name = ei->ei_nodes[ei->ei_subsnode].ein_name;
+	}
+	else if (eir == (ExtIncrReg *) NULL)
+	    goto abort;
+	else if (eir->eir_affected)
+	{
+	    if (eir->eir_boundary) goto abort;
+	    name = extNodeName((LabRegion *) reg);
+	    he = HashFind(&arg->eia_newNames, name);
+	    if (HashGetValue(he) != NULL) goto abort;
+	    HashSetValue(he, (ClientData) 1);
+	    eir->eir_name = StrDup((char **) NULL, name);
+	    for (ll = reg->nreg_labels; ll; ll = ll->ll_next)
+	    {
+		if (arg->eia_nlabels == arg->eia_maxlabels)
+		{
+		    Label **newlabels;
+
+		    arg->eia_maxlabels = 2 * arg->eia_maxlabels + 16;
+		    newlabels = (Label **) mallocMagic(arg->eia_maxlabels
+				* sizeof (Label *));
+		    if (arg->eia_labels)
+		    {
+			memcpy(newlabels, arg->eia_labels,
+				arg->eia_nlabels * sizeof (Label *));
+			freeMagic((char *) arg->eia_labels);
+		    }
+		    arg->eia_labels = newlabels;
+		}
+		arg->eia_labels[arg->eia_nlabels++] = ll->ll_label;
+	    }
+	    continue;
+	}
+	else if (eir->eir_index < 0)
+	    goto abort;
+	else
+	    name = ei->ei_nodes[eir->eir_index].ein_name;
+
+	/* Replace the region's labels with one carrying the old name */
+	free_magic1_t mm1 = freeMagic1_init();
+	for (ll = reg->nreg_labels; ll; ll = ll->ll_next)
+	    freeMagic1(&mm1, (char *) ll);
+	freeMagic1_end(&mm1);
+
+	ll = (LabelList *) mallocMagic(sizeof (LabelList));
+	ll->ll_label = (Label *) mallocMagic(labelSize(strlen(name)));
+	bzero((char *) ll->ll_label, sizeof (Label));
+	strcpy(ll->ll_label->lab_text, name);
+	ll->ll_label->lab_type = TT_SPACE;
+	ll->ll_attr = LL_NOATTR;
+	ll->ll_next = (LabelList *) NULL;
+	reg->nreg_labels = ll;
+
+	/* Keep track of it so the Label can be freed afterwards */
+	llnext = (LabelList *) mallocMagic(sizeof (LabelList));
+	llnext->ll_label = ll->ll_label;
+	llnext->ll_next = arg->eia_fakeLists;
+	arg->eia_fakeLists = llnext;
+    }
+
+    /* Record the paint of the affected regions */
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	arg->eia_pNum = pNum;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrRecordFunc, (ClientData) arg);
+    }
+
+    /* Find the affected devices */
+    HashInit(&visited, 32, HT_WORDKEYS);
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes && !arg->eia_abort; pNum++)
+    {
+	arg->eia_pNum = pNum;
+	arg->eia_visited = &visited;
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&ExtCurStyle->exts_deviceMask, extIncrDevMarkFunc,
+		(ClientData) arg);
+    }
+    HashKill(&visited);
+    return;
+
+abort:
+    arg->eia_abort = TRUE;
+}
+
+/*
+ * Filter functions for extIncrNameNodes().
+ *
+ * extIncrClassifyFunc() looks at one tile of a region of the yank
+ * buffer.  The region is affected if the tile lies in the seed area,
+ * or if it was part of an affected old node; otherwise it must map to
+ * exactly one unaffected old node, which extIncrClassifyOldFunc()
+ * checks.  extIncrRecordFunc() remembers the tiles of affected regions
+ * and paints them (bloated by 1) into the eia_geom plane.
+ * extIncrDevMarkFunc() and extIncrDevPaintFunc() find the devices that
+ * touch affected paint or the seed area, and paint them into eia_devs;
+ * extIncrTermCheckFunc() makes sure their terminal area is all there.
+ */
+
+int
+extIncrClassifyFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    NodeRegion *reg = (NodeRegion *) TiGetClient(tile);
+    ExtIncrReg *eir;
+    HashEntry *he;
+    Rect r;
+
+    if (TiGetClient(tile) == CLIENTDEFAULT) return 0;
+    TITORECT(tile, &r);
+
+    if (reg == glob_subsnode)
+    {
+	if (DBSrPaintArea((Tile *) NULL, arg->eia_dirty[arg->eia_pNum], &r,
+		&DBAllButSpaceBits, extEnumFunc, (ClientData) NULL))
+	{
+	    arg->eia_abort = TRUE;
+	    return 1;
+	}
+	return 0;
+    }
+
+    he = HashFind(&arg->eia_regions, (char *) reg);
+    eir = (ExtIncrReg *) HashGetValue(he);
+    if (eir == (ExtIncrReg *) NULL)
+    {
+	eir = (ExtIncrReg *) mallocMagic(sizeof (ExtIncrReg));
+	eir->eir_index = -1;
+	eir->eir_affected = FALSE;
+	eir->eir_boundary = FALSE;
+	eir->eir_newIndex = -1;
+	eir->eir_name = (char *) NULL;
+	HashSetValue(he, (ClientData) eir);
+    }
+
+    if (!GEO_SURROUND(&arg->eia_inner, &r))
+	eir->eir_boundary = TRUE;
+    if (eir->eir_affected) return 0;
+
+    if (DBSrPaintArea((Tile *) NULL, arg->eia_seed, &r, &DBAllButSpaceBits,
+		extEnumFunc, (ClientData) NULL))
+    {
+	eir->eir_affected = TRUE;
+	return 0;
+    }
+
+    /* Outside the seed area, the paint is the same as in the copy */
+    arg->eia_reg = eir;
+    if (DBSrPaintArea((Tile *) NULL, arg->eia_ei->ei_planes[arg->eia_pNum],
+		&r, &DBAllButSpaceBits, extIncrClassifyOldFunc, (ClientData) arg))
+    {
+	arg->eia_abort = TRUE;
+	return 1;
+    }
+    return 0;
+}
+
+int
+extIncrClassifyOldFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    ExtIncrReg *eir = arg->eia_reg;
+    int idx;
+
+    if (TiGetClient(tile) == CLIENTDEFAULT) return 1;
+    idx = TiGetClientINT(tile);
+    if (idx < 0 || idx >= arg->eia_ei->ei_nnodes) return 1;
+    if (arg->eia_oldAffected[idx])
+	eir->eir_affected = TRUE;
+    else if (eir->eir_index < 0)
+	eir->eir_index = idx;
+    else if (eir->eir_index != idx)
+	return 1;
+    return 0;
+}
+
+int
+extIncrRecordFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    ExtIncrTile *eit;
+    ExtIncrReg *eir;
+    HashEntry *he;
+    Rect r;
+
+    if (TiGetClient(tile) == CLIENTDEFAULT) return 0;
+    he = HashLookOnly(&arg->eia_regions, (char *) TiGetClient(tile));
+    if (he == NULL) return 0;
+    eir = (ExtIncrReg *) HashGetValue(he);
+    if (!eir->eir_affected) return 0;
+
+    eit = (ExtIncrTile *) mallocMagic(sizeof (ExtIncrTile));
+    eit->eit_pNum = arg->eia_pNum;
+    eit->eit_type = TiGetType(tile);
+    TITORECT(tile, &eit->eit_rect);
+    eit->eit_reg = eir;
+    eit->eit_next = arg->eia_tiles;
+    arg->eia_tiles = eit;
+
+    GEO_EXPAND(&eit->eit_rect, 1, &r);
+    DBPaintPlane(arg->eia_geom, &r, DBStdWriteTbl(TT_ERROR_P),
+		(PaintUndoInfo *) NULL);
+    return 0;
+}
+
+int
+extIncrDevMarkFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    HashTable *visited = arg->eia_visited;
+    Rect r;
+
+    if (HashLookOnly(visited, (char *) tile) != NULL) return 0;
+
+    TITORECT(tile, &r);
+    GEO_EXPAND(&r, 1, &r);
+    if (DBSrPaintArea((Tile *) NULL, arg->eia_geom, &r, &DBAllButSpaceBits,
+		extEnumFunc, (ClientData) NULL) == 0 &&
+	    DBSrPaintArea((Tile *) NULL, arg->eia_seed, &r, &DBAllButSpaceBits,
+		extEnumFunc, (ClientData) NULL) == 0)
+	return 0;
+
+    extIncrDevFlood(extIncrYankDef, tile, arg->eia_pNum, visited,
+		extIncrDevPaintFunc, extIncrTermCheckFunc, (ClientData) arg);
+    return 0;
+}
+
+int
+extIncrTermCheckFunc(tile, pNum, arg)
+    Tile *tile;
+    int pNum;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    if (!GEO_SURROUND(&arg->eia_inner, &r))
+	arg->eia_abort = TRUE;
+    return 0;
+}
+
+int
+extIncrDevPaintFunc(tile, pNum, arg)
+    Tile *tile;
+    int pNum;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    if (!GEO_SURROUND(&arg->eia_inner, &r))
+	arg->eia_abort = TRUE;
+    DBPaintPlane(arg->eia_devs, &r, DBStdWriteTbl(TT_ERROR_P),
+		(PaintUndoInfo *) NULL);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrPointIn --
+ *
+ * Results:
+ *	TRUE if the unit square whose lower-left corner is (x, y) is
+ *	painted in 'plane'.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+bool
+extIncrPointIn(plane, x, y)
+    Plane *plane;
+    int x, y;
+{
+    Point p;
+    Tile *tp;
+
+    p.p_x = x;
+    p.p_y = y;
+    tp = TiSrPoint((Tile *) NULL, plane, &p);
+    return (TiGetType(tp) != TT_SPACE) ? TRUE : FALSE;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrPatch --
+ *
+ * Re-extract the window arg->eia_window and combine the result with
+ * the saved body of the .ext file.
+ *
+ * The yank buffer is extracted by extBasic(), with extIncrNameNodes()
+ * called part way through.  Of its output, only the records for
+ * affected nodes, coupling capacitors involving at least one affected
+ * node, and affected devices are kept.  Of the saved body, the records
+ * for old nodes that were affected (and their aliases, ports and
+ * capacitors), and for devices that were affected or changed, are
+ * dropped.  Device "parameters" records are kept unless the set of
+ * device types present in the cell changed, in which case they are
+ * regenerated.
+ *
+ * Results:
+ *	TRUE on success, with *pLines and *pNLines set to the new body.
+ *	FALSE if a full extraction is needed.
+ *
+ * Side effects:
+ *	Extracts the yank buffer.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+/* Sections of the body of a .ext file, in the order they are written */
+#define	EXT_INCR_PARAMS		0
+#define	EXT_INCR_PORTS		1
+#define	EXT_INCR_NODES		2
+#define	EXT_INCR_CAPS		3
+#define	EXT_INCR_DEVICES	4
+#define	EXT_INCR_NSECTIONS	5
+
+typedef struct
+{
+    char	**eis_lines;
+    int		  eis_nlines;
+    int		  eis_max;
+} ExtIncrSection;
+
+/* Coupling capacitor between a pair of nodes, merged over regions */
+typedef struct
+{
+    char	*eic_line;	/* First line seen for the pair */
+    double	 eic_cap;	/* Total capacitance */
+    int		 eic_count;	/* Number of lines seen */
+} ExtIncrCap;
+
+void
+extIncrAddLine(sec, line)
+    ExtIncrSection *sec;
+    char *line;
+{
+    if (sec->eis_nlines == sec->eis_max)
+    {
+	char **newlines;
+
+	sec->eis_max = 2 * sec->eis_max + 64;
+	newlines = (char **) mallocMagic(sec->eis_max * sizeof (char *));
+	if (sec->eis_lines)
+	{
+	    memcpy(newlines, sec->eis_lines, sec->eis_nlines * sizeof (char *));
+	    freeMagic((char *) sec->eis_lines);
+	}
+	sec->eis_lines = newlines;
+    }
+    sec->eis_lines[sec->eis_nlines++] = line;
+}
+
+/*
+ * Classify a line of a .ext body.  Fills in 'name1' (and 'name2' for
+ * "equiv" and "cap" records) and, for devices, the position.
+ * Returns the section, EXT_INCR_NSECTIONS for a "substrate" record,
+ * or -1 for anything unexpected.
+ */
+
+int
+extIncrParseLine(line, name1, name2, px, py, pcap)
+    char *line;
+    char *name1, *name2;
+    int *px, *py;
+    double *pcap;
+{
+    char *cp;
+    int skip;
+
+    cp = extIncrField(line, name1);
+    if (cp == NULL) return -1;
+
+    if (!strcmp(name1, "parameters"))
+	return EXT_INCR_PARAMS;
+    if (!strcmp(name1, "port"))
+    {
+	if (extIncrField(cp, name1) == NULL) return -1;
+	return EXT_INCR_PORTS;
+    }
+    if (!strcmp(name1, "substrate"))
+    {
+	if (extIncrField(cp, name1) == NULL) return -1;
+	return EXT_INCR_NSECTIONS;
+    }
+    if (!strcmp(name1, "node") || !strcmp(name1, "attr"))
+    {
+	if (extIncrField(cp, name1) == NULL) return -1;
+	return EXT_INCR_NODES;
+    }
+    if (!strcmp(name1, "equiv"))
+    {
+	if ((cp = extIncrField(cp, name1)) == NULL) return -1;
+	if (extIncrField(cp, name2) == NULL) return -1;
+	return EXT_INCR_NODES;
+    }
+    if (!strcmp(name1, "cap"))
+    {
+	if ((cp = extIncrField(cp, name1)) == NULL) return -1;
+	if ((cp = extIncrField(cp, name2)) == NULL) return -1;
+	if (sscanf(cp, "%lg", pcap) != 1) return -1;
+	return EXT_INCR_CAPS;
+    }
+    if (!strcmp(name1, "device") || !strcmp(name1, "fet"))
+    {
+	/* "device class model x y ..." or "fet model x y ..." */
+	skip = (name1[0] == 'd') ? 2 : 1;
+	while (skip-- > 0)
+	    if ((cp = extIncrField(cp, name1)) == NULL) return -1;
+	if (sscanf(cp, "%d %d", px, py) != 2) return -1;
+	return EXT_INCR_DEVICES;
+    }
+    return -1;
+}
+
+bool
+extIncrPatch(arg, pLines, pNLines)
+    ExtIncrArg *arg;
+    char ***pLines;
+    int *pNLines;
+{
+    ExtIncr *ei = arg->eia_ei;
+    CellDef *def = arg->eia_def;
+    CellDef *yankDef = extIncrYankDef;
+    ExtIncrSection sections[EXT_INCR_NSECTIONS];
+    HashTable dropNames, dropAlias, capTable;
+    HashEntry *he;
+    HashSearch hs;
+    SearchContext scx;
+    CellUse dummy;
+    NodeRegion *reg;
+    Label *lab;
+    FILE *tmpf;
+    char *line, *name1, *name2, *key;
+    double cap;
+    int n, sec, x, y, maxlen, saveWarn, saveErrors, saveWarnings;
+    bool saveFeedback, ok, typesChanged;
+    TileTypeBitMask oldTypes, newTypes;
+    TileType t;
+
+    /* Fill the yank buffer */
+    scx.scx_use = &dummy;
+    dummy.cu_def = def;
+    dummy.cu_id = NULL;
+    scx.scx_trans = GeoIdentityTransform;
+    scx.scx_area = arg->eia_window;
+    DBCellClearDef(yankDef);
+    DBCellCopyPaint(&scx, &DBAllButSpaceBits, 0, extIncrYankUse);
+    for (lab = def->cd_labels; lab; lab = lab->lab_next)
+	if (GEO_LABEL_IN_AREA(&lab->lab_rect, &arg->eia_window))
+	    DBPutFontLabel(yankDef, &lab->lab_rect, lab->lab_font,
+			lab->lab_size, lab->lab_rotate, &lab->lab_offset,
+			lab->lab_just, lab->lab_text, lab->lab_type,
+			lab->lab_flags,
+			(lab->lab_port == INFINITY) ? 0 : lab->lab_port);
+    DBReComputeBbox(yankDef);
+
+    /* Extract it quietly */
+    tmpf = tmpfile();
+    if (tmpf == NULL) return FALSE;
+    saveWarn = ExtDoWarn;
+    saveErrors = extNumErrors;
+    saveWarnings = extNumWarnings;
+    saveFeedback = DebugIsSet(extDebugID, extDebNoFeedback);
+    ExtDoWarn = 0;
+    DebugIsSet(extDebugID, extDebNoFeedback) = TRUE;
+    extIncrCur = arg;
+
+    reg = extBasic(yankDef, tmpf);
+
+    extIncrCur = (ExtIncrArg *) NULL;
+    DebugIsSet(extDebugID, extDebNoFeedback) = saveFeedback;
+    ExtDoWarn = saveWarn;
+    extNumErrors = saveErrors;
+    extNumWarnings = saveWarnings;
+    if (reg) ExtFreeLabRegions((LabRegion *) reg);
+    ExtResetTiles(yankDef, CLIENTDEFAULT);
+
+    if (arg->eia_abort || SigInterruptPending || arg->eia_tiles == NULL)
+    {
+	fclose(tmpf);
+	return FALSE;
+    }
+
+    /*
+     * Old nodes being replaced.  None of their names may also belong
+     * to a node that is kept, or to a node being added.
+     */
+    HashInit(&dropNames, 256, HT_STRINGKEYS);
+    HashInit(&dropAlias, 32, HT_STRINGKEYS);
+    HashInit(&capTable, 256, HT_STRINGKEYS);
+    for (n = 0; n < EXT_INCR_NSECTIONS; n++)
+    {
+	sections[n].eis_lines = (char **) NULL;
+	sections[n].eis_nlines = sections[n].eis_max = 0;
+    }
+    ok = FALSE;
+    name1 = name2 = key = NULL;
+    rewind(tmpf);
+
+    for (n = 0; n < ei->ei_nnodes; n++)
+	if (arg->eia_oldAffected[n])
+	    HashSetValue(HashFind(&dropNames, ei->ei_nodes[n].ein_name),
+			(ClientData) 1);
+    for (n = 0; n < ei->ei_nnodes; n++)
+	if (!arg->eia_oldAffected[n] && ei->ei_nodes[n].ein_name)
+	{
+	    if (HashLookOnly(&dropNames, ei->ei_nodes[n].ein_name)) goto out;
+	    if (HashLookOnly(&arg->eia_newNames, ei->ei_nodes[n].ein_name))
+		goto out;
+	}
+
+    maxlen = 0;
+    for (n = 0; n < ei->ei_nlines; n++)
+	if ((x = strlen(ei->ei_lines[n])) > maxlen)
+	    maxlen = x;
+    name1 = mallocMagic(maxlen + 2);
+    name2 = mallocMagic(maxlen + 2);
+
+    /* Aliases of the nodes being replaced */
+    for (n = 0; n < ei->ei_nlines; n++)
+    {
+	if (strncmp(ei->ei_lines[n], "equiv ", 6)) continue;
+	sec = extIncrParseLine(ei->ei_lines[n], name1, name2, &x, &y, &cap);
+	if (sec < 0) goto out;
+	if (HashLookOnly(&dropNames, name1))
+	    HashSetValue(HashFind(&dropAlias, name2), (ClientData) 1);
+    }
+    for (n = 0; n < ei->ei_nlines; n++)
+    {
+	if (strncmp(ei->ei_lines[n], "equiv ", 6)) continue;
+	sec = extIncrParseLine(ei->ei_lines[n], name1, name2, &x, &y, &cap);
+	if (!HashLookOnly(&dropNames, name1) &&
+		(HashLookOnly(&dropNames, name2) || HashLookOnly(&dropAlias, name2)))
+	    goto out;
+    }
+
+    /* Keep what is still valid of the old body */
+    for (n = 0; n < ei->ei_nlines; n++)
+    {
+	line = ei->ei_lines[n];
+	sec = extIncrParseLine(line, name1, name2, &x, &y, &cap);
+	switch (sec)
+	{
+	    case EXT_INCR_PARAMS:
+		break;
+	    case EXT_INCR_PORTS:
+		if (HashLookOnly(&dropNames, name1)
+			|| HashLookOnly(&dropAlias, name1))
+		    continue;
+		break;
+	    case EXT_INCR_NSECTIONS:
+		sec = EXT_INCR_NODES;
+		break;
+	    case EXT_INCR_NODES:
+		if (HashLookOnly(&dropNames, name1)) continue;
+		break;
+	    case EXT_INCR_CAPS:
+		if (HashLookOnly(&dropNames, name1)
+			|| HashLookOnly(&dropNames, name2))
+		    continue;
+		break;
+	    case EXT_INCR_DEVICES:
+		if (extIncrPointIn(arg->eia_devs, x, y)
+			|| extIncrPointIn(arg->eia_union, x, y))
+		    continue;
+		break;
+	    default:
+		goto out;
+	}
+	extIncrAddLine(&sections[sec], StrDup((char **) NULL, line));
+    }
+
+    /* Add the re-extracted records */
+    while ((line = extIncrReadLine(tmpf)) != NULL)
+    {
+	x = strlen(line);
+	if (x > maxlen)
+	{
+	    maxlen = x;
+	    freeMagic(name1);
+	    freeMagic(name2);
+	    name1 = mallocMagic(maxlen + 2);
+	    name2 = mallocMagic(maxlen + 2);
+	}
+	sec = extIncrParseLine(line, name1, name2, &x, &y, &cap);
+	switch (sec)
+	{
+	    case EXT_INCR_PARAMS:
+	    case EXT_INCR_NSECTIONS:
+		freeMagic(line);
+		continue;
+	    case EXT_INCR_PORTS:
+		break;
+	    case EXT_INCR_NODES:
+		if (!HashLookOnly(&arg->eia_newNames, name1))
+		{
+		    freeMagic(line);
+		    continue;
+		}
+		break;
+	    case EXT_INCR_CAPS:
+	    {
+		ExtIncrCap *eic;
+
+		if (!HashLookOnly(&arg->eia_newNames, name1)
+			&& !HashLookOnly(&arg->eia_newNames, name2))
+		{
+		    freeMagic(line);
+		    continue;
+		}
+
+		/* Several regions may carry the same old node's name */
+		if (key) freeMagic(key);
+		key = mallocMagic(strlen(name1) + strlen(name2) + 8);
+		if (strcmp(name1, name2) < 0)
+		    sprintf(key, "\"%s\" \"%s\"", name1, name2);
+		else
+		    sprintf(key, "\"%s\" \"%s\"", name2, name1);
+		he = HashFind(&capTable, key);
+		eic = (ExtIncrCap *) HashGetValue(he);
+		if (eic == NULL)
+		{
+		    eic = (ExtIncrCap *) mallocMagic(sizeof (ExtIncrCap));
+		    eic->eic_line = line;
+		    eic->eic_cap = cap;
+		    eic->eic_count = 1;
+		    HashSetValue(he, (ClientData) eic);
+		}
+		else
+		{
+		    eic->eic_cap += cap;
+		    eic->eic_count++;
+		    freeMagic(line);
+		}
+		continue;
+	    }
+	    case EXT_INCR_DEVICES:
+		if (!extIncrPointIn(arg->eia_devs, x, y))
+		{
+		    freeMagic(line);
+		    continue;
+		}
+		break;
+	    default:
+		freeMagic(line);
+		goto out;
+	}
+	extIncrAddLine(&sections[sec], line);
+    }
+
+    HashStartSearch(&hs);
+    while ((he = HashNext(&capTable, &hs)))
+    {
+	ExtIncrCap *eic = (ExtIncrCap *) HashGetValue(he);
+
+	if (eic->eic_count == 1)
+	    line = eic->eic_line;
+	else
+	{
+	    line = mallocMagic(strlen(he->h_key.h_name) + 40);
+	    sprintf(line, "cap %s %lg", he->h_key.h_name, eic->eic_cap);
+	    freeMagic(eic->eic_line);
+	}
+	extIncrAddLine(&sections[EXT_INCR_CAPS], line);
+	freeMagic((char *) eic);
+	HashSetValue(he, NULL);
+    }
+
+    /*
+     * Device "parameters" records depend only on which device types
+     * are present.  Regenerate them if that changed.
+     */
+    TTMaskZero(&oldTypes);
+    for (t = TT_TECHDEPBASE; t < DBNumTypes; t++)
+	if (ei->ei_devArea[t] > 0)
+	    TTMaskSetType(&oldTypes, t);
+    {
+	ExtIncrArg aarg;
+	int pNum;
+
+	aarg = *arg;
+	aarg.eia_clip = (Rect *) NULL;
+	for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+	{
+	    aarg.eia_pNum = pNum;
+	    (void) DBSrPaintArea((Tile *) NULL, arg->eia_dirty[pNum],
+			&TiPlaneRect, &DBAllButSpaceBits, extIncrRepaintFunc,
+			(ClientData) &aarg);
+	}
+    }
+    TTMaskZero(&newTypes);
+    for (t = TT_TECHDEPBASE; t < DBNumTypes; t++)
+	if (ei->ei_devArea[t] > 0)
+	    TTMaskSetType(&newTypes, t);
+    typesChanged = !TTMaskEqual(&oldTypes, &newTypes);
+
+    if (typesChanged)
+    {
+	TransRegion *treg, *transList = (TransRegion *) NULL;
+	FILE *pf;
+
+	for (t = TT_TECHDEPBASE; t < DBNumTypes; t++)
+	    if (TTMaskHasType(&newTypes, t))
+	    {
+		treg = (TransRegion *) mallocMagic(sizeof (TransRegion));
+		bzero((char *) treg, sizeof (TransRegion));
+		treg->treg_type = t;
+		treg->treg_next = transList;
+		transList = treg;
+	    }
+	pf = tmpfile();
+	if (pf != NULL)
+	{
+	    extOutputParameters(def, transList, pf);
+	    rewind(pf);
+	    while ((line = extIncrReadLine(pf)) != NULL)
+		extIncrAddLine(&sections[EXT_INCR_PARAMS], line);
+	    fclose(pf);
+	}
+	free_magic1_t mm1 = freeMagic1_init();
+	for (treg = transList; treg; treg = treg->treg_next)
+	    freeMagic1(&mm1, (char *) treg);
+	freeMagic1_end(&mm1);
+	if (pf == NULL) goto out;
+    }
+    else
+    {
+	for (n = 0; n < ei->ei_nlines; n++)
+	    if (!strncmp(ei->ei_lines[n], "parameters ", 11))
+		extIncrAddLine(&sections[EXT_INCR_PARAMS],
+			StrDup((char **) NULL, ei->ei_lines[n]));
+    }
+    ok = TRUE;
+
+out:
+    fclose(tmpf);
+    if (name1) freeMagic(name1);
+    if (name2) freeMagic(name2);
+    if (key) freeMagic(key);
+    HashStartSearch(&hs);
+    while ((he = HashNext(&capTable, &hs)))
+    {
+	ExtIncrCap *eic = (ExtIncrCap *) HashGetValue(he);
+	if (eic)
+	{
+	    freeMagic(eic->eic_line);
+	    freeMagic((char *) eic);
+	}
+    }
+    HashKill(&capTable);
+    HashKill(&dropNames);
+    HashKill(&dropAlias);
+
+    /* Concatenate the sections */
+    n = 0;
+    for (sec = 0; sec < EXT_INCR_NSECTIONS; sec++)
+	n += sections[sec].eis_nlines;
+    *pLines = (char **) mallocMagic((n + 1) * sizeof (char *));
+    *pNLines = 0;
+    for (sec = 0; sec < EXT_INCR_NSECTIONS; sec++)
+    {
+	for (n = 0; n < sections[sec].eis_nlines; n++)
+	{
+	    if (ok)
+		(*pLines)[(*pNLines)++] = sections[sec].eis_lines[n];
+	    else
+		freeMagic(sections[sec].eis_lines[n]);
+	}
+	if (sections[sec].eis_lines)
+	    freeMagic((char *) sections[sec].eis_lines);
+    }
+    if (!ok)
+    {
+	freeMagic((char *) *pLines);
+	*pLines = (char **) NULL;
+	*pNLines = 0;
+    }
+    return ok;
+}
+
+/*
+ * Filter functions for extIncrPatch() and extIncrUpdate().
+ *
+ * extIncrRepaintFunc() is called for each tile of a dirty plane, and
+ * replaces the device area the saved copy had there by the device area
+ * the cell has there now.  extIncrResetFunc() is also called for each
+ * tile of a dirty plane, and replaces the paint of the saved copy
+ * there by that of the cell, which extIncrCopyClipFunc() paints.
+ */
+
+int
+extIncrRepaintFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    arg->eia_clip = &r;
+    arg->eia_sign = -1;
+    (void) DBSrPaintArea((Tile *) NULL, arg->eia_ei->ei_planes[arg->eia_pNum],
+		&r, &ExtCurStyle->exts_deviceMask, extIncrDevAreaFunc,
+		(ClientData) arg);
+    arg->eia_sign = 1;
+    (void) DBSrPaintArea((Tile *) NULL, arg->eia_def->cd_planes[arg->eia_pNum],
+		&r, &ExtCurStyle->exts_deviceMask, extIncrDevAreaFunc,
+		(ClientData) arg);
+    return 0;
+}
+
+int
+extIncrResetFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Plane *plane = arg->eia_ei->ei_planes[arg->eia_pNum];
+    Rect r;
+
+    TITORECT(tile, &r);
+    arg->eia_clip = &r;
+    DBPaintPlane(plane, &r, DBStdWriteTbl(TT_SPACE), (PaintUndoInfo *) NULL);
+    (void) DBSrPaintArea((Tile *) NULL, arg->eia_def->cd_planes[arg->eia_pNum],
+		&r, &DBAllButSpaceBits, extIncrCopyClipFunc, (ClientData) arg);
+
+    arg->eia_index = -1;
+    (void) DBSrPaintArea((Tile *) NULL, plane, &r, &DBAllButSpaceBits,
+		extIncrTagSetFunc, (ClientData) arg);
+    return 0;
+}
+
+int
+extIncrCopyClipFunc(tile, dinfo, arg)
+    Tile *tile;
+    TileType dinfo;
+    ExtIncrArg *arg;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    GEOCLIP(&r, arg->eia_clip);
+    DBPaintPlane(arg->eia_ei->ei_planes[arg->eia_pNum], &r,
+		DBStdWriteTbl(TiGetType(tile)), (PaintUndoInfo *) NULL);
+    return 0;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extIncrUpdate --
+ *
+ * Bring the state saved for arg->eia_def up to date after a successful
+ * incremental extraction, so that the next one is relative to it.
+ * 'lines' (of which there are 'nlines') becomes the saved body of the
+ * .ext file, and 'curLabels' the saved labels.  'labelMap' maps label
+ * keys to the labels of the cell, and is used to copy the extraction
+ * marks left on the yanked labels back to the cell.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the saved state.  Takes over 'lines' and the contents of
+ *	'curLabels', which is left empty.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extIncrUpdate(arg, lines, nlines, curLabels, labelMap)
+    ExtIncrArg *arg;
+    char **lines;
+    int nlines;
+    HashTable *curLabels;
+    HashTable *labelMap;
+{
+    ExtIncr *ei = arg->eia_ei;
+    ExtIncrTile *eit;
+    ExtIncrReg *eir;
+    TileTypeBitMask mask;
+    HashTable swap;
+    HashEntry *he;
+    Label *lab, *deflab;
+    char *key;
+    int pNum, n, oldn, keylen;
+
+    /* Paint */
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+    {
+	arg->eia_pNum = pNum;
+	(void) DBSrPaintArea((Tile *) NULL, arg->eia_dirty[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extIncrResetFunc, (ClientData) arg);
+    }
+
+    /* Nodes */
+    oldn = ei->ei_nnodes;
+    for (n = 0; n < oldn; n++)
+	if (arg->eia_oldAffected[n] && ei->ei_nodes[n].ein_name)
+	{
+	    freeMagic(ei->ei_nodes[n].ein_name);
+	    ei->ei_nodes[n].ein_name = (char *) NULL;
+	    ei->ei_live--;
+	}
+    for (eit = arg->eia_tiles; eit; eit = eit->eit_next)
+    {
+	eir = eit->eit_reg;
+	if (eir->eir_newIndex < 0)
+	{
+	    if (ei->ei_nnodes == ei->ei_maxnodes)
+	    {
+		ExtIncrNode *newnodes;
+
+		ei->ei_maxnodes *= 2;
+		newnodes = (ExtIncrNode *) mallocMagic(ei->ei_maxnodes
+			* sizeof (ExtIncrNode));
+		memcpy(newnodes, ei->ei_nodes,
+			ei->ei_nnodes * sizeof (ExtIncrNode));
+		freeMagic((char *) ei->ei_nodes);
+		ei->ei_nodes = newnodes;
+	    }
+	    eir->eir_newIndex = ei->ei_nnodes++;
+	    ei->ei_nodes[eir->eir_newIndex].ein_name = eir->eir_name;
+	    ei->ei_nodes[eir->eir_newIndex].ein_area = GeoNullRect;
+	    eir->eir_name = (char *) NULL;
+	    ei->ei_live++;
+	}
+	(void) GeoInclude(&eit->eit_rect,
+		&ei->ei_nodes[eir->eir_newIndex].ein_area);
+	TTMaskSetOnlyType(&mask, eit->eit_type);
+	arg->eia_index = eir->eir_newIndex;
+	(void) DBSrPaintArea((Tile *) NULL, ei->ei_planes[eit->eit_pNum],
+		&eit->eit_rect, &mask, extIncrTagSetFunc, (ClientData) arg);
+    }
+
+    /* Labels, and the marks extraction left on them */
+    swap = ei->ei_labels;
+    ei->ei_labels = *curLabels;
+    *curLabels = swap;
+    HashKill(curLabels);
+    HashInit(curLabels, 4, HT_STRINGKEYS);
+
+    keylen = 0;
+    key = NULL;
+    for (n = 0; n < arg->eia_nlabels; n++)
+    {
+	lab = arg->eia_labels[n];
+	if (strlen(lab->lab_text) + 100 > keylen)
+	{
+	    if (key) freeMagic(key);
+	    key = mallocMagic(keylen = strlen(lab->lab_text) + 100);
+	}
+	extIncrLabelKey(lab, key);
+	he = HashLookOnly(labelMap, key);
+	if (he == NULL) continue;
+	deflab = (Label *) HashGetValue(he);
+	if (lab->lab_port == INFINITY)
+	    deflab->lab_port = INFINITY;
+	else if (deflab->lab_port == INFINITY)
+	    deflab->lab_port = 0;
+    }
+    if (key) freeMagic(key);
+
+    /* Body of the .ext file */
+    extIncrFreeLines(ei->ei_lines, ei->ei_nlines);
+    ei->ei_lines = lines;
+    ei->ei_nlines = nlines;
+
+    /* Start over with a full extraction once too many nodes are gone */
+    if (ei->ei_nnodes > 2 * ei->ei_live + 256)
+	ExtIncrFree(arg->eia_def);
+}
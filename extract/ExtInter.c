@@ -22,6 +22,8 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #endif  /* not lint */
 
 #include <stdio.h>
+#include <stdlib.h>	/* for qsort() */
+#include <string.h>
 
 #include "utils/magic.h"
 #include "utils/geometry.h"
@@ -56,6 +58,9 @@ int extInterSubtreeClip();
 int extInterSubtreeElement();
 int extInterSubtreeTile();
 int extInterSubtreePaint();
+int extSweepCollectFunc();
+int extSweepPaintFunc();
+int extSweepCompare();
 
 #define	BLOATBY(r, h) ( (r)->r_xbot -= (h), (r)->r_ybot -= (h), \
 			(r)->r_xtop += (h), (r)->r_ytop += (h) )
@@ -484,3 +489,251 @@ extTreeSrFunc(scx, fp)
     return (DBCellSrArea(scx, extTreeSrFunc, (ClientData) fp));
 }
 
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ExtSweepInteractions --
+ *
+ * Paint into 'resultPlane' a conservative approximation of all the areas
+ * of 'def' in which DRCFindInteractions() could report an interaction
+ * for the given 'halo':  the overlap of every pair of child uses whose
+ * bounding boxes come within 'halo' of each other, and the part of each
+ * use's halo that contains paint of the parent.  Unlike
+ * ExtFindInteractions(), the contents of the children are not examined,
+ * so this takes a single pass over the uses, sorted by their left edges,
+ * plus one paint search per use.  The uses still active in the sweep
+ * are kept in bins by y, so each use is compared only with its nearby
+ * neighbors.  Overlapping areas merge as they are painted into the
+ * plane.
+ *
+ * Every area is bloated by one unit so that material that only touches
+ * a use's halo is still covered.  extSubtree() uses the result to skip
+ * the interaction search for step areas with nothing in them.
+ *
+ * Results:
+ *	Returns the number of candidate areas painted (before merging).
+ *
+ * Side effects:
+ *	Paints TT_ERROR_P into the plane 'resultPlane'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+/* Each use's bounding box, bloated by halo + 1, for the sweep */
+typedef struct
+{
+    Rect	 esu_rect;
+    CellUse	*esu_use;
+} ExtSweepUse;
+
+typedef struct
+{
+    ExtSweepUse	*es_uses;	/* Array of uses */
+    int		 es_nuses;	/* Number of entries in es_uses */
+    int		 es_size;	/* Allocated size of es_uses */
+    int		 es_halo;	/* Interaction halo */
+} ExtSweepArg;
+
+/* Active uses of the sweep whose y ranges meet one band of y values */
+typedef struct
+{
+    int		*eb_uses;	/* Indices into es_uses */
+    int		 eb_count;	/* Number of entries in eb_uses */
+    int		 eb_size;	/* Allocated size of eb_uses */
+} ExtSweepBin;
+
+/* Largest number of y bands used by the sweep */
+#define EXT_SWEEP_MAXBINS	4096
+
+int
+ExtSweepInteractions(def, halo, resultPlane)
+    CellDef *def;	/* Find interactions among children of def */
+    int halo;		/* Interaction is elements closer than halo */
+    Plane *resultPlane;	/* Paint interaction areas into this plane */
+{
+    ExtSweepArg esa;
+    ExtSweepUse *cur, *act;
+    ExtSweepBin *bins, *bin;
+    int i, j, k, b, b0, b1, nbins, binSize, ylo, yhi, pNum, count;
+    dlong height;
+    Rect r, paintArea;
+
+    esa.es_size = 64;
+    esa.es_nuses = 0;
+    esa.es_halo = halo;
+    esa.es_uses = (ExtSweepUse *) mallocMagic(esa.es_size * sizeof (ExtSweepUse));
+    (void) DBCellEnum(def, extSweepCollectFunc, (ClientData) &esa);
+
+    count = 0;
+    if (esa.es_nuses == 0)
+    {
+	freeMagic((char *) esa.es_uses);
+	return (0);
+    }
+
+    UndoDisable();
+
+    /*
+     * Use-to-use interactions.  Sweep from left to right over the uses
+     * in order of their left edges, keeping the uses whose right edges
+     * have not yet been passed in bins by y.  Each new use is checked
+     * only against the active uses in the bins that its y range spans,
+     * and each pair is painted only in the first bin the two share.
+     * Uses that have been passed are dropped from a bin whenever the
+     * bin is visited.
+     */
+    qsort((char *) esa.es_uses, esa.es_nuses, sizeof (ExtSweepUse),
+		extSweepCompare);
+
+    ylo = esa.es_uses[0].esu_rect.r_ybot;
+    yhi = esa.es_uses[0].esu_rect.r_ytop;
+    height = 0;
+    for (i = 0; i < esa.es_nuses; i++)
+    {
+	cur = &esa.es_uses[i];
+	ylo = MIN(ylo, cur->esu_rect.r_ybot);
+	yhi = MAX(yhi, cur->esu_rect.r_ytop);
+	height += (dlong)(cur->esu_rect.r_ytop - cur->esu_rect.r_ybot);
+    }
+    binSize = (int)(height / esa.es_nuses) + 1;
+    if ((dlong)(yhi - ylo) / binSize >= EXT_SWEEP_MAXBINS)
+	binSize = (int)((dlong)(yhi - ylo) / EXT_SWEEP_MAXBINS) + 1;
+    nbins = (int)((dlong)(yhi - ylo) / binSize) + 1;
+    bins = (ExtSweepBin *) mallocMagic(nbins * sizeof (ExtSweepBin));
+    bzero((char *) bins, nbins * sizeof (ExtSweepBin));
+
+    for (i = 0; i < esa.es_nuses; i++)
+    {
+	cur = &esa.es_uses[i];
+	b0 = (cur->esu_rect.r_ybot - ylo) / binSize;
+	b1 = (cur->esu_rect.r_ytop - 1 - ylo) / binSize;
+	for (b = b0; b <= b1; b++)
+	{
+	    bin = &bins[b];
+	    for (j = k = 0; j < bin->eb_count; j++)
+	    {
+		act = &esa.es_uses[bin->eb_uses[j]];
+		if (act->esu_rect.r_xtop <= cur->esu_rect.r_xbot)
+		    continue;		/* Passed; drop from the bin */
+		bin->eb_uses[k++] = bin->eb_uses[j];
+		if (act->esu_rect.r_ybot >= cur->esu_rect.r_ytop
+			|| act->esu_rect.r_ytop <= cur->esu_rect.r_ybot)
+		    continue;
+		if (b != MAX(b0, (act->esu_rect.r_ybot - ylo) / binSize))
+		    continue;		/* Pair was seen in an earlier bin */
+		r = cur->esu_rect;
+		GEOCLIP(&r, &act->esu_rect);
+		DBPaintPlane(resultPlane, &r, DBStdWriteTbl(TT_ERROR_P),
+			(PaintUndoInfo *) NULL);
+		count++;
+	    }
+	    bin->eb_count = k;
+
+	    if (bin->eb_count >= bin->eb_size)
+	    {
+		int *newuses;
+
+		bin->eb_size = (bin->eb_size == 0) ? 8 : bin->eb_size * 2;
+		newuses = (int *) mallocMagic(bin->eb_size * sizeof (int));
+		if (bin->eb_count > 0)
+		    memcpy(newuses, bin->eb_uses, bin->eb_count * sizeof (int));
+		if (bin->eb_uses != NULL) freeMagic((char *) bin->eb_uses);
+		bin->eb_uses = newuses;
+	    }
+	    bin->eb_uses[bin->eb_count++] = i;
+	}
+    }
+    for (b = 0; b < nbins; b++)
+	if (bins[b].eb_uses != NULL) freeMagic((char *) bins[b].eb_uses);
+    freeMagic((char *) bins);
+
+    /*
+     * Use-to-parent-paint interactions.  As in DRCFindInteractions(),
+     * take the bounding box of the parent's paint near each use.
+     */
+    for (i = 0; i < esa.es_nuses; i++)
+    {
+	cur = &esa.es_uses[i];
+	paintArea = GeoNullRect;
+	for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+	    (void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum],
+			&cur->esu_rect, &DBAllButSpaceBits, extSweepPaintFunc,
+			(ClientData) &paintArea);
+	if (GEO_RECTNULL(&paintArea)) continue;
+	BLOATBY(&paintArea, halo + 1);
+	GEOCLIP(&paintArea, &cur->esu_rect);
+	DBPaintPlane(resultPlane, &paintArea, DBStdWriteTbl(TT_ERROR_P),
+			(PaintUndoInfo *) NULL);
+	count++;
+    }
+
+    UndoEnable();
+    freeMagic((char *) esa.es_uses);
+    return (count);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extSweepCollectFunc --
+ *
+ * Called by DBCellEnum() for each child use of the cell passed to
+ * ExtSweepInteractions().  Append the use and its bloated bounding
+ * box to the array in 'esa'.
+ *
+ * Results:
+ *	Returns 0 always.
+ *
+ * Side effects:
+ *	May reallocate esa->es_uses.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+extSweepCollectFunc(use, esa)
+    CellUse *use;
+    ExtSweepArg *esa;
+{
+    ExtSweepUse *esu;
+
+    if (esa->es_nuses >= esa->es_size)
+    {
+	ExtSweepUse *newuses;
+
+	newuses = (ExtSweepUse *) mallocMagic(2 * esa->es_size
+			* sizeof (ExtSweepUse));
+	memcpy(newuses, esa->es_uses, esa->es_nuses * sizeof (ExtSweepUse));
+	freeMagic((char *) esa->es_uses);
+	esa->es_uses = newuses;
+	esa->es_size *= 2;
+    }
+    esu = &esa->es_uses[esa->es_nuses++];
+    esu->esu_use = use;
+    esu->esu_rect = use->cu_bbox;
+    BLOATBY(&esu->esu_rect, esa->es_halo + 1);
+    return (0);
+}
+
+int
+extSweepCompare(a, b)
+    ExtSweepUse *a, *b;
+{
+    if (a->esu_rect.r_xbot < b->esu_rect.r_xbot) return (-1);
+    if (a->esu_rect.r_xbot > b->esu_rect.r_xbot) return (1);
+    return (0);
+}
+
+int
+extSweepPaintFunc(tile, dinfo, pArea)
+    Tile *tile;
+    TileType dinfo;	/* (unused) */
+    Rect *pArea;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    (void) GeoInclude(&r, pArea);
+    return (0);
+}
@@ -70,6 +70,7 @@ extern int extHierYankFunc();
 extern LabRegion *extSubtreeHardNode();
 extern Node *extHierNewNode();
 extern ExtTree *extHierNewOne();
+extern int extEnumFunc();
 
 /* Global data incremented by extSubtree() */
 long extSubtreeTotalArea;	/* Total area of cell */
@@ -80,6 +81,10 @@ long extSubtreeClippedArea;	/* Total area of all interactions, counting only
 				 * the area that lies inside each chunk, so no
 				 * area is counted more than once.
 				 */
+long extSubtreeSweepSkips;	/* Number of steps for which the search for
+				 * interactions was skipped because
+				 * ExtSweepInteractions() found nothing there.
+				 */
 
 /* Local data */
 
@@ -167,10 +172,11 @@ extSubtree(parentUse, reg, f)
     FILE *f;
 {
     int extSubtreeInterFunc();
+    static Plane *sweepPlane = (Plane *) NULL;
     CellDef *def = parentUse->cu_def;
     int halo = ExtCurStyle->exts_sideCoupleHalo	 + 1;
     HierExtractArg ha;
-    Rect r, rlab, rbloat, *b;
+    Rect r, rlab, rbloat, rsearch, *b;
     Label *lab;
     int result;
     int cuts, totcuts;
@@ -232,6 +238,15 @@ extSubtree(parentUse, reg, f)
      */
     b = &def->cd_bbox;
 
+    /*
+     * Find everywhere an interaction is possible in a single sweep
+     * over the children.  Steps that see none of this area cannot
+     * have interactions, and DRCFindInteractions() is not needed.
+     */
+    if (sweepPlane == (Plane *) NULL)
+	sweepPlane = DBNewPlane((ClientData) TT_SPACE);
+    (void) ExtSweepInteractions(def, halo, sweepPlane);
+
     /* Monitor progress, for large designs, and allow display refresh at intervals */
 
     totcuts = (b->r_ytop - b->r_ybot + ExtCurStyle->exts_stepSize - 1)
@@ -253,7 +268,21 @@ extSubtree(parentUse, reg, f)
 	    rbloat = r;
 	    rbloat.r_xbot -= halo, rbloat.r_ybot -= halo;
 	    rbloat.r_xtop += halo, rbloat.r_ytop += halo;
-	    result = DRCFindInteractions(def, &rbloat, halo, &ha.ha_interArea);
+
+	    /* DRCFindInteractions() searches rbloat bloated by halo */
+	    GEO_EXPAND(&rbloat, halo + 1, &rsearch);
+	    if (DBSrPaintArea((Tile *) NULL, sweepPlane, &rsearch,
+			&DBAllButSpaceBits, extEnumFunc, (ClientData) NULL))
+		result = DRCFindInteractions(def, &rbloat, halo,
+			&ha.ha_interArea);
+	    else
+	    {
+		/* Same as DRCFindInteractions() with nothing found */
+		GEO_EXPAND(&rbloat, halo, &rsearch);
+		extSubtreeSweepSkips++;
+		result = (DBSrCellPlaneArea(def->cd_cellPlane, &rsearch,
+			extEnumFunc, (ClientData) NULL)) ? 0 : -1;
+	    }
 
 	    // Check area for labels.  Expand interaction area to include
 	    // the labels.  This catches labels that are not attached to
@@ -367,8 +396,14 @@ extSubtree(parentUse, reg, f)
 #endif	/* exactinteractions */
 
 done:
+#ifndef	exactinteractions
+    DBClearPaintPlane(sweepPlane);
+#endif	/* exactinteractions */
+
     /* Output connections and node adjustments */
+    (void) extProfileSwitch(EXT_PROF_OUTPUT);
     extOutputConns(&ha.ha_connHash, f);
+    (void) extProfileSwitch(EXT_PROF_SUBTREE);
     HashKill(&ha.ha_connHash);
 
     /* Clear the CU_SUB_EXTRACTED flag from all children instances */
@@ -815,7 +850,6 @@ extSubtreeFunc(scx, ha)
     ExtTree *oneFlat;
     HierYank hy;
     bool subok;
-    int x, y;
 
     /* Allocate a new ExtTree to hold the flattened, extracted subtree */
     oneFlat = extHierNewOne();
@@ -950,37 +984,16 @@ extSubtreeFunc(scx, ha)
     }
 
     /* Process connections; this updates ha->ha_connHash */
+    (void) extProfileSwitch(EXT_PROF_HIERCONN);
     extHierConnections(ha, &ha->ha_cumFlat, oneFlat);
+    (void) extProfileSwitch(EXT_PROF_SUBTREE);
 
     /* Process substrate connection.  All substrates should be	*/
-    /* connected together in the cell def, so in the case of an	*/
-    /* array, just make sure that the first array entry is	*/
-    /* connected.						*/
+    /* connected together in the cell def.  In the case of an	*/
+    /* array, the child substrate node is the same for every	*/
+    /* element, so it is found once and merged for each element.	*/
 
-    if (use->cu_xhi == use->cu_xlo && use->cu_yhi == use->cu_ylo)
-	subok = (!extHierSubstrate(ha, use, -1, -1)) ? TRUE : FALSE;
-    else if (use->cu_xhi == use->cu_xlo && use->cu_yhi > use->cu_ylo)
-    {
-	subok = FALSE;
-	for (y = use->cu_ylo; y <= use->cu_yhi; y++)
-	    if (!extHierSubstrate(ha, use, -1, y))
-		subok = TRUE;
-    }
-    else if (use->cu_xhi > use->cu_xlo && use->cu_yhi == use->cu_ylo)
-    {
-	subok = FALSE;
-	for (x = use->cu_xlo; x <= use->cu_xhi; x++)
-	    if (!extHierSubstrate(ha, use, x, -1))
-		subok = TRUE;
-    }
-    else
-    {
-	subok = FALSE;
-	for (x = use->cu_xlo; x <= use->cu_xhi; x++)
-	    for (y = use->cu_ylo; y <= use->cu_yhi; y++)
-		if (!extHierSubstrate(ha, use, x, y))
-		    subok = TRUE;
-    }
+    subok = (!extHierSubstrateArray(ha, use)) ? TRUE : FALSE;
     /* Mark substrate as having been extracted for this use. */
     if (subok) use->cu_flags |= CU_SUB_EXTRACTED;
 
@@ -1033,7 +1046,6 @@ extSubstrateFunc(scx, ha)
     HierExtractArg *ha;
 {
     CellUse *use = scx->scx_use;
-    int x, y;
 
     /* Record information for finding node names the hard way */
     ha->ha_subUse = use;
@@ -1041,28 +1053,11 @@ extSubstrateFunc(scx, ha)
     GEOCLIP(&ha->ha_subArea, &ha->ha_interArea);
 
     /* Process substrate connection.  All substrates should be	*/
-    /* connected together in the cell def, so in the case of an	*/
-    /* array, just make sure that the first array entry is	*/
-    /* connected.						*/
+    /* connected together in the cell def.  In the case of an	*/
+    /* array, the child substrate node is the same for every	*/
+    /* element, so it is found once and merged for each element.	*/
 
-    if (use->cu_xhi == use->cu_xlo && use->cu_yhi == use->cu_ylo)
-	extHierSubstrate(ha, use, -1, -1);
-    else if (use->cu_xhi == use->cu_xlo && use->cu_yhi > use->cu_ylo)
-    {
-	for (y = use->cu_ylo; y <= use->cu_yhi; y++)
-	    extHierSubstrate(ha, use, -1, y);
-    }
-    else if (use->cu_xhi > use->cu_xlo && use->cu_yhi == use->cu_ylo)
-    {
-	for (x = use->cu_xlo; x <= use->cu_xhi; x++)
-	extHierSubstrate(ha, use, x, -1);
-    }
-    else
-    {
-	for (x = use->cu_xlo; x <= use->cu_xhi; x++)
-	    for (y = use->cu_ylo; y <= use->cu_yhi; y++)
-		extHierSubstrate(ha, use, x, y);
-    }
+    extHierSubstrateArray(ha, use);
     use->cu_flags |= CU_SUB_EXTRACTED;
     return (2);
 }
@@ -112,6 +112,7 @@ ExtractTest(w, cmd)
     extern long extSubtreeTotalArea;
     extern long extSubtreeInteractionArea;
     extern long extSubtreeClippedArea;
+    extern long extSubtreeSweepSkips;
     static Plane *interPlane = (Plane *) NULL;
     static long areaTotal = 0, areaInteraction = 0, areaClipped = 0;
     long a1, a2;
@@ -198,9 +199,12 @@ ExtractTest(w, cmd)
 		((double) extSubtreeClippedArea) / ((double) a1) * 100.0,
 		areaClipped,
 		((double) areaClipped) / ((double) a2) * 100.0);
+	    TxPrintf("Steps skipped (no possible interactions) = %ld\n",
+		extSubtreeSweepSkips);
 	    extSubtreeTotalArea = 0;
 	    extSubtreeInteractionArea = 0;
 	    extSubtreeClippedArea = 0;
+	    extSubtreeSweepSkips = 0;
 	    break;
 	case INTERACTIONS:
 	    if (interPlane == NULL)
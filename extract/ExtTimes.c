@@ -96,6 +96,8 @@ struct cumStats cumIncrTime;
 struct cumStats cumPercentClipped;
 struct cumStats cumPercentInteraction;
 struct cumStats cumTotalArea, cumInteractArea, cumClippedArea;
+struct cumStats cumSweepArea;
+long extInterUncovered;		/* Interaction area missed by the sweep */
 
 FILE *extDevNull = NULL;
 
@@ -1009,7 +1011,10 @@ extGetStats(def)
  * Find all interaction areas in an entire design, and count
  * the fraction of the total area that is really an interaction
  * area.  Report this for each cell in the design, and as a
- * fraction of the total area.
+ * fraction of the total area.  For comparison, also report the
+ * area and number of candidate interaction areas found by the
+ * single-pass ExtSweepInteractions(), and any exact interaction
+ * area that the sweep failed to cover (which should be none).
  *
  * Results:
  *	None.
@@ -1022,6 +1027,8 @@ extGetStats(def)
 
 int extInterCountHalo;
 CellDef *extInterCountDef;
+Plane *extInterSweepPlane;	/* Sweep candidates, for extInterMissedFunc */
+long extInterMissed;		/* Area accumulated by extInterMissedFunc */
 
 void
 ExtInterCount(rootUse, halo, f)
@@ -1045,10 +1052,15 @@ ExtInterCount(rootUse, halo, f)
     extCumInit(&cumPercentInteraction);
     extCumInit(&cumTotalArea);
     extCumInit(&cumInteractArea);
+    extCumInit(&cumSweepArea);
+    extInterUncovered = 0;
 
     /* Mark all defs as unvisited */
     (void) DBCellSrDefs(0, extDefInitFunc, (ClientData) 0);
 
+    fprintf(f, "%8s %8s %8s %8s  %s\n",
+		"interact", "sweep", "areas", "missed", "cell");
+
     /*
      * Recursively visit all defs in the tree and compute
      * their interaction area.
@@ -1070,6 +1082,12 @@ ExtInterCount(rootUse, halo, f)
     if (cumTotalArea.cums_sum > 0)
 	inter = 100.0 * cumInteractArea.cums_sum / cumTotalArea.cums_sum;
     fprintf(f, "Mean %% interaction area = %.2f\n", inter);
+    inter = 0.0;
+    if (cumTotalArea.cums_sum > 0)
+	inter = 100.0 * cumSweepArea.cums_sum / cumTotalArea.cums_sum;
+    fprintf(f, "Mean %% sweep candidate area = %.2f\n", inter);
+    fprintf(f, "Interaction area not covered by sweep = %ld\n",
+		extInterUncovered);
 }
 
 int
@@ -1078,13 +1096,17 @@ extInterAreaFunc(use, f)
     FILE *f;
 {
     static Plane *interPlane = (Plane *) NULL;
+    static Plane *sweepPlane = (Plane *) NULL;
     CellDef *def = use->cu_def;
-    int extInterCountFunc();
-    int area, interarea;
-    double pctinter;
+    int extInterCountFunc(), extInterMissedFunc();
+    int area, interarea, sweeparea, nsweep;
+    long missed;
+    double pctinter, pctsweep;
 
     if (interPlane == NULL)
 	interPlane = DBNewPlane((ClientData) TT_SPACE);
+    if (sweepPlane == NULL)
+	sweepPlane = DBNewPlane((ClientData) TT_SPACE);
 
     /* Skip if already visited */
     if (def->cd_client)
@@ -1099,18 +1121,37 @@ extInterAreaFunc(use, f)
     interarea = 0;
     (void) DBSrPaintArea((Tile *) NULL, interPlane, &TiPlaneRect,
 	    &DBAllButSpaceBits, extInterCountFunc, (ClientData) &interarea);
+
+    /* Compare against the single-pass sweep */
+    nsweep = ExtSweepInteractions(def, extInterCountHalo, sweepPlane);
+    sweeparea = 0;
+    (void) DBSrPaintArea((Tile *) NULL, sweepPlane, &TiPlaneRect,
+	    &DBAllButSpaceBits, extInterCountFunc, (ClientData) &sweeparea);
+    extInterSweepPlane = sweepPlane;
+    extInterMissed = 0;
+    (void) DBSrPaintArea((Tile *) NULL, interPlane, &TiPlaneRect,
+	    &DBAllButSpaceBits, extInterMissedFunc, (ClientData) NULL);
+    missed = extInterMissed;
     DBClearPaintPlane(interPlane);
+    DBClearPaintPlane(sweepPlane);
+    extInterUncovered += missed;
+
     area = (def->cd_bbox.r_xtop - def->cd_bbox.r_xbot)
 	*  (def->cd_bbox.r_ytop - def->cd_bbox.r_ybot);
 
-    pctinter = 0.0;
+    pctinter = pctsweep = 0.0;
     if (area > 0)
+    {
 	pctinter = ((double) interarea) / ((double) area) * 100.0;
+	pctsweep = ((double) sweeparea) / ((double) area) * 100.0;
+    }
     if (pctinter > 0.0) extCumAdd(&cumPercentInteraction, pctinter);
     extCumAdd(&cumTotalArea, (double) area);
     extCumAdd(&cumInteractArea, (double) interarea);
+    extCumAdd(&cumSweepArea, (double) sweeparea);
 
-    fprintf(f, "%7.2f%%  %s\n", pctinter, def->cd_name);
+    fprintf(f, "%7.2f%% %7.2f%% %8d %8ld  %s\n", pctinter, pctsweep,
+		nsweep, missed, def->cd_name);
 
     /* Visit our children */
     (void) DBCellEnum(def, extInterAreaFunc, (ClientData) f);
@@ -1130,3 +1171,695 @@ extInterCountFunc(tile, dinfo, pArea)
     *pArea += (r.r_xtop - r.r_xbot) * (r.r_ytop - r.r_ybot);
     return (0);
 }
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extInterMissedFunc --
+ *
+ * Called for each tile of the exact interaction area of a cell.  Add to
+ * extInterMissed the part of the tile that is not covered by the sweep
+ * candidate areas in extInterSweepPlane.
+ *
+ * Results:
+ *	Returns 0 always.
+ *
+ * Side effects:
+ *	Updates extInterMissed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+extInterMissedFunc(tile, dinfo, cdata)
+    Tile *tile;
+    TileType dinfo;	/* (unused) */
+    ClientData cdata;	/* (unused) */
+{
+    int extInterMissedSpace();
+    Rect r;
+
+    TITORECT(tile, &r);
+    GEOCLIP(&r, &extInterCountDef->cd_bbox);
+    if (GEO_RECTNULL(&r)) return (0);
+    (void) DBSrPaintArea((Tile *) NULL, extInterSweepPlane, &r,
+	    &DBSpaceBits, extInterMissedSpace, (ClientData) &r);
+    return (0);
+}
+
+int
+extInterMissedSpace(tile, dinfo, area)
+    Tile *tile;
+    TileType dinfo;	/* (unused) */
+    Rect *area;
+{
+    Rect r;
+
+    TITORECT(tile, &r);
+    GEOCLIP(&r, area);
+    if (!GEO_RECTNULL(&r))
+	extInterMissed += (long)(r.r_xtop - r.r_xbot) * (r.r_ytop - r.r_ybot);
+    return (0);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * Extraction profiling.
+ *
+ * While "extract profile" is running, extCellFile() and the routines it
+ * calls switch between the phases EXT_PROF_* (see extractInt.h), and
+ * the wall-clock time spent in each phase is charged to the CellDef
+ * being extracted.  Phases do not nest:  switching to a new phase stops
+ * the clock on the previous one, so the phase times for a cell add up
+ * to the total time taken to extract it.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static const char * const extProfPhaseNames[EXT_PROF_NPHASES] =
+{
+    "regions", "devices", "coupling", "subtree", "hierconn", "output"
+};
+
+/* Roll-up of a cell and all of its descendants, each counted once */
+typedef struct
+{
+    double		 epr_time[EXT_PROF_NPHASES];
+    double		 epr_total;
+    long		 epr_tiles;
+    long		 epr_nodes;
+    long		 epr_devs;
+    int			 epr_cells;
+} ExtProfileRollup;
+
+/* One of the following is allocated for each cell extracted */
+typedef struct extprof
+{
+    CellDef		*ep_def;	/* Which cell */
+    int			 ep_order;	/* Order in which cell was extracted */
+    double		 ep_time[EXT_PROF_NPHASES]; /* Seconds in each phase */
+    double		 ep_total;	/* Total seconds for this cell */
+    int			 ep_tiles;	/* Non-space tile count in this cell */
+    int			 ep_nodes;	/* Number of nodes in this cell */
+    int			 ep_devs;	/* Number of devices in this cell */
+    long		 ep_peakrss;	/* Peak RSS of the whole process
+					 * (KB) at the end of this cell.
+					 */
+    long		 ep_peakgrowth;	/* Growth of the process peak RSS
+					 * while extracting this cell.
+					 */
+    ExtProfileRollup	 ep_hier;	/* This cell and its descendants */
+    struct extprof	*ep_next;	/* Next cell in extraction order */
+} ExtProfRec;
+
+/* Client data for listing the distinct children of a cell */
+typedef struct
+{
+    HashTable		 epc_seen;	/* Child defs already listed */
+    FILE		*epc_file;
+    int			 epc_count;
+} ExtProfileChildren;
+
+bool extProfileOn = FALSE;		/* TRUE while profiling */
+static HashTable extProfTable;		/* ExtProfile records keyed by def */
+static ExtProfRec *extProfList;		/* Records in extraction order */
+static ExtProfRec *extProfLast;		/* Tail of extProfList */
+static ExtProfRec *extProfCell;		/* Record of the cell in progress */
+static int extProfCurPhase = EXT_PROF_NONE;
+static struct timeval extProfStamp;	/* Time of the last phase switch */
+static long extProfRssStart;		/* RSS high-water mark at cell start */
+
+/* Forward declarations */
+long extProfileMaxRss();
+void extProfileRollup();
+void extProfileWriteText();
+void extProfileWriteJSON();
+void extProfileJSONString();
+int  extProfCountTiles();
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileSwitch --
+ *
+ * Stop the clock on the current extraction phase and start it on 'phase'.
+ * This is a no-op unless "extract profile" is running.
+ *
+ * Results:
+ *	Returns the phase that was running before the switch, so that
+ *	the caller can restore it when done.
+ *
+ * Side effects:
+ *	Charges the elapsed time to the previous phase of the cell
+ *	currently being extracted.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+extProfileSwitch(phase)
+    int phase;
+{
+    struct timeval now;
+    int prev;
+
+    if (!extProfileOn) return EXT_PROF_NONE;
+
+    prev = extProfCurPhase;
+    gettimeofday(&now, (struct timezone *) NULL);
+    if (prev != EXT_PROF_NONE && extProfCell != NULL)
+	extProfCell->ep_time[prev] +=
+		(double)(now.tv_sec - extProfStamp.tv_sec) +
+		(double)(now.tv_usec - extProfStamp.tv_usec) / 1.0e6;
+    extProfStamp = now;
+    extProfCurPhase = phase;
+    return prev;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileCounts --
+ *
+ * Record the number of nodes and devices found in the cell currently
+ * being extracted.  Called from extBasic().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the profile record of the current cell, if profiling.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extProfileCounts(nodes, devs)
+    int nodes, devs;
+{
+    if (!extProfileOn || extProfCell == NULL) return;
+    extProfCell->ep_nodes = nodes;
+    extProfCell->ep_devs = devs;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileBeginCell --
+ * extProfileEndCell --
+ *
+ * Bracket the extraction of a single CellDef.  Called from extCellFile().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	extProfileBeginCell allocates a profile record for 'def' and
+ *	counts its tiles.  extProfileEndCell closes the last phase and
+ *	records the total time and memory high-water mark.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extProfileBeginCell(def)
+    CellDef *def;
+{
+    ExtProfRec *ep;
+    HashEntry *he;
+    int pNum, n;
+
+    if (!extProfileOn) return;
+
+    he = HashFind(&extProfTable, (char *) def);
+    ep = (ExtProfRec *) HashGetValue(he);
+    if (ep == NULL)
+    {
+	ep = (ExtProfRec *) mallocMagic(sizeof (ExtProfRec));
+	bzero((char *) ep, sizeof (ExtProfRec));
+	ep->ep_def = def;
+	ep->ep_order = (extProfLast) ? extProfLast->ep_order + 1 : 0;
+	if (extProfLast) extProfLast->ep_next = ep;
+	else extProfList = ep;
+	extProfLast = ep;
+	HashSetValue(he, (ClientData) ep);
+    }
+
+    /* Count the tiles (not charged to any phase) */
+    ep->ep_tiles = 0;
+    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
+	(void) DBSrPaintArea((Tile *) NULL, def->cd_planes[pNum], &TiPlaneRect,
+		&DBAllButSpaceBits, extProfCountTiles, (ClientData) &ep->ep_tiles);
+
+    extProfCell = ep;
+    extProfRssStart = extProfileMaxRss();
+    extProfCurPhase = EXT_PROF_NONE;
+    (void) extProfileSwitch(EXT_PROF_OUTPUT);
+}
+
+void
+extProfileEndCell(def)
+    CellDef *def;
+{
+    ExtProfRec *ep = extProfCell;
+    int i;
+
+    if (!extProfileOn || ep == NULL || ep->ep_def != def) return;
+
+    (void) extProfileSwitch(EXT_PROF_NONE);
+    ep->ep_total = 0.0;
+    for (i = 0; i < EXT_PROF_NPHASES; i++)
+	ep->ep_total += ep->ep_time[i];
+    ep->ep_peakrss = extProfileMaxRss();
+    ep->ep_peakgrowth = ep->ep_peakrss - extProfRssStart;
+    extProfCell = NULL;
+}
+
+int
+extProfCountTiles(tile, dinfo, pcount)
+    Tile *tile;			/* (unused) */
+    TileType dinfo;		/* (unused) */
+    int *pcount;
+{
+    (*pcount)++;
+    return (0);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileMaxRss --
+ *
+ * Results:
+ *	Returns the high-water mark of the resident set size of this
+ *	process in kilobytes, or 0 if it cannot be determined.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+long
+extProfileMaxRss()
+{
+#if defined(EMSCRIPTEN)
+    return 0;
+#else
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (long) ru.ru_maxrss;
+#endif
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * ExtProfile --
+ *
+ * Extract the subtree rooted at 'rootUse' as "extract all" does, while
+ * recording for each CellDef the time spent in each extraction phase,
+ * the number of tiles, nodes, and devices, and the process memory
+ * high-water mark.  When done, write a report to 'f', either as text
+ * or (if 'doJSON' is TRUE) as a JSON object that includes, for each
+ * cell, a roll-up over the cell and all of its descendants.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Creates .ext files as ExtAll() does.  Writes to the FILE 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+ExtProfile(rootUse, f, doJSON)
+    CellUse *rootUse;
+    FILE *f;
+    bool doJSON;
+{
+    ExtProfRec *ep;
+
+    HashInit(&extProfTable, 128, HT_WORDKEYS);
+    extProfList = extProfLast = extProfCell = NULL;
+    extProfCurPhase = EXT_PROF_NONE;
+
+    extProfileOn = TRUE;
+    ExtAll(rootUse);
+    extProfileOn = FALSE;
+
+    if (extProfList == NULL)
+	TxError("No cells were extracted; no profile written.\n");
+    else if (doJSON)
+	extProfileWriteJSON(rootUse->cu_def, f);
+    else
+	extProfileWriteText(rootUse->cu_def, f);
+
+    for (ep = extProfList; ep; ep = ep->ep_next)
+	freeMagic((char *) ep);
+    extProfList = extProfLast = NULL;
+    HashKill(&extProfTable);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileRollup --
+ *
+ * Compute, in a single depth-first walk of the hierarchy below
+ * 'rootDef', the roll-up of every profiled cell over the cell and all
+ * of its descendants, each def counted only once however many times
+ * it is used.  Each def visited gets a bit set of the profile records
+ * (indexed by ep_order) at or below it, which is the union of the
+ * sets of its children plus its own record.  The sets are kept in a
+ * hash table keyed by def, which also marks the defs already visited.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Sets ep_hier in every profile record reached from 'rootDef',
+ *	and sets 'r' to the roll-up of 'rootDef' itself.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+/* Client data for the walk made by extProfileRollup() */
+typedef struct
+{
+    HashTable		 epw_sets;	/* Bit set of each def visited */
+    ExtProfRec		**epw_recs;	/* Profile records by ep_order */
+    int			 epw_nrecs;
+    int			 epw_words;	/* Words in each bit set */
+} ExtProfileWalk;
+
+/* Client data for merging the bit sets of a def's children */
+typedef struct
+{
+    ExtProfileWalk	*epm_walk;
+    unsigned int	*epm_set;	/* Bit set of the parent */
+} ExtProfileMerge;
+
+void
+extProfileRollup(rootDef, r)
+    CellDef *rootDef;
+    ExtProfileRollup *r;
+{
+    unsigned int *extProfileDescend();
+    void extProfileSum();
+    ExtProfileWalk walk;
+    ExtProfRec *ep;
+    HashSearch hs;
+    HashEntry *he;
+
+    walk.epw_nrecs = extProfLast->ep_order + 1;
+    walk.epw_words = (walk.epw_nrecs + 31) / 32;
+    walk.epw_recs = (ExtProfRec **) mallocMagic(walk.epw_nrecs
+		* sizeof (ExtProfRec *));
+    for (ep = extProfList; ep; ep = ep->ep_next)
+	walk.epw_recs[ep->ep_order] = ep;
+    HashInit(&walk.epw_sets, 128, HT_WORDKEYS);
+
+    extProfileSum(extProfileDescend(rootDef, &walk), &walk, r);
+
+    HashStartSearch(&hs);
+    while ((he = HashNext(&walk.epw_sets, &hs)))
+	freeMagic((char *) HashGetValue(he));
+    HashKill(&walk.epw_sets);
+    freeMagic((char *) walk.epw_recs);
+}
+
+/*
+ * extProfileDescend --
+ *
+ * Return the bit set of 'def' for extProfileRollup(), computing it (and
+ * the sets of all defs below it) on the first visit.
+ */
+
+unsigned int *
+extProfileDescend(def, walk)
+    CellDef *def;
+    ExtProfileWalk *walk;
+{
+    int extProfileMergeUse();
+    void extProfileSum();
+    ExtProfileMerge merge;
+    ExtProfRec *ep;
+    HashEntry *he;
+    unsigned int *set;
+
+    he = HashFind(&walk->epw_sets, (char *) def);
+    if ((set = (unsigned int *) HashGetValue(he)) != NULL) return set;
+
+    set = (unsigned int *) mallocMagic(walk->epw_words * sizeof (unsigned int));
+    bzero((char *) set, walk->epw_words * sizeof (unsigned int));
+    HashSetValue(he, (ClientData) set);
+
+    merge.epm_walk = walk;
+    merge.epm_set = set;
+    (void) DBCellEnum(def, extProfileMergeUse, (ClientData) &merge);
+
+    he = HashLookOnly(&extProfTable, (char *) def);
+    if (he && (ep = (ExtProfRec *) HashGetValue(he)))
+    {
+	set[ep->ep_order / 32] |= 1U << (ep->ep_order % 32);
+	extProfileSum(set, walk, &ep->ep_hier);
+    }
+    return set;
+}
+
+int
+extProfileMergeUse(use, merge)
+    CellUse *use;
+    ExtProfileMerge *merge;
+{
+    unsigned int *child;
+    int w;
+
+    child = extProfileDescend(use->cu_def, merge->epm_walk);
+    for (w = 0; w < merge->epm_walk->epw_words; w++)
+	merge->epm_set[w] |= child[w];
+    return (0);
+}
+
+/*
+ * extProfileSum --
+ *
+ * Set 'r' to the sum of the profile records whose bits are in 'set'.
+ */
+
+void
+extProfileSum(set, walk, r)
+    unsigned int *set;
+    ExtProfileWalk *walk;
+    ExtProfileRollup *r;
+{
+    ExtProfRec *ep;
+    unsigned int bits;
+    int w, b, i;
+
+    bzero((char *) r, sizeof (ExtProfileRollup));
+    for (w = 0; w < walk->epw_words; w++)
+	for (bits = set[w], b = 0; bits != 0; bits >>= 1, b++)
+	{
+	    if (!(bits & 1)) continue;
+	    ep = walk->epw_recs[w * 32 + b];
+	    for (i = 0; i < EXT_PROF_NPHASES; i++)
+		r->epr_time[i] += ep->ep_time[i];
+	    r->epr_total += ep->ep_total;
+	    r->epr_tiles += ep->ep_tiles;
+	    r->epr_nodes += ep->ep_nodes;
+	    r->epr_devs += ep->ep_devs;
+	    r->epr_cells++;
+	}
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileWriteText --
+ *
+ * Write the profile as a table, one line per cell in extraction order,
+ * followed by the totals for the whole tree.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the FILE 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extProfileWriteText(rootDef, f)
+    CellDef *rootDef;
+    FILE *f;
+{
+    ExtProfileRollup r;
+    ExtProfRec *ep;
+    int i;
+
+    fprintf(f, "%-24s %8s %8s %8s", "cell", "tiles", "nodes", "devices");
+    for (i = 0; i < EXT_PROF_NPHASES; i++)
+	fprintf(f, " %9s", extProfPhaseNames[i]);
+    fprintf(f, " %9s %12s\n", "total", "peakrss(KB)");
+
+    for (ep = extProfList; ep; ep = ep->ep_next)
+    {
+	fprintf(f, "%-24s %8d %8d %8d", ep->ep_def->cd_name,
+		ep->ep_tiles, ep->ep_nodes, ep->ep_devs);
+	for (i = 0; i < EXT_PROF_NPHASES; i++)
+	    fprintf(f, " %9.3f", ep->ep_time[i]);
+	fprintf(f, " %9.3f %12ld\n", ep->ep_total, ep->ep_peakrss);
+    }
+
+    extProfileRollup(rootDef, &r);
+
+    fprintf(f, "%-24s %8ld %8ld %8ld", "(total)",
+		r.epr_tiles, r.epr_nodes, r.epr_devs);
+    for (i = 0; i < EXT_PROF_NPHASES; i++)
+	fprintf(f, " %9.3f", r.epr_time[i]);
+    fprintf(f, " %9.3f %12ld\n", r.epr_total, extProfileMaxRss());
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileJSONString --
+ *
+ * Write the string 's' to 'f' as a quoted JSON string.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the FILE 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+extProfileJSONString(f, s)
+    FILE *f;
+    char *s;
+{
+    putc('"', f);
+    for (; *s; s++)
+    {
+	if (*s == '"' || *s == '\\')
+	    fprintf(f, "\\%c", *s);
+	else if ((unsigned char)*s < 0x20)
+	    fprintf(f, "\\u%04x", (unsigned char)*s);
+	else
+	    putc(*s, f);
+    }
+    putc('"', f);
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * extProfileWriteJSON --
+ *
+ * Write the profile as a single JSON object:
+ *
+ *	{ "version": ..., "top": ..., "phases": [ ... ],
+ *	  "cells": [ { "name": ..., "order": n, "tiles": n, "nodes": n,
+ *		       "devices": n, "process_peak_rss_kb": n,
+ *		       "process_peak_rss_growth_kb": n,
+ *		       "children": [ ... ],
+ *		       "time": { <phase>: seconds, ..., "total": seconds },
+ *		       "hier": { "cells": n, "tiles": n, "nodes": n,
+ *				 "devices": n,
+ *				 "time": { <phase>: seconds, ... } } },
+ *		     ... ] }
+ *
+ * Cells appear in the order in which they were extracted (bottom-up).
+ * The "hier" entry of each cell is the roll-up over the cell and all
+ * of its descendants, each counted once.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to the FILE 'f'.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+extProfileChildFunc(use, cdata)
+    CellUse *use;
+    ClientData cdata;
+{
+    ExtProfileChildren *pc = (ExtProfileChildren *) cdata;
+    HashEntry *he;
+
+    /* List each child def only once, however many uses it has */
+    he = HashFind(&pc->epc_seen, (char *) use->cu_def);
+    if (HashGetValue(he)) return (0);
+    HashSetValue(he, (ClientData) 1);
+
+    if (pc->epc_count++ > 0) fprintf(pc->epc_file, ", ");
+    extProfileJSONString(pc->epc_file, use->cu_def->cd_name);
+    return (0);
+}
+
+void
+extProfileWriteJSON(rootDef, f)
+    CellDef *rootDef;
+    FILE *f;
+{
+    ExtProfileRollup r, *h;
+    ExtProfRec *ep;
+    ExtProfileChildren pc;
+    int i;
+
+    extProfileRollup(rootDef, &r);
+
+    fprintf(f, "{\n  \"version\": \"%s.%s\",\n", MagicVersion, MagicRevision);
+    fprintf(f, "  \"top\": ");
+    extProfileJSONString(f, rootDef->cd_name);
+    fprintf(f, ",\n  \"phases\": [");
+    for (i = 0; i < EXT_PROF_NPHASES; i++)
+	fprintf(f, "%s\"%s\"", (i > 0) ? ", " : "", extProfPhaseNames[i]);
+    fprintf(f, "],\n  \"cells\": [");
+
+    for (ep = extProfList; ep; ep = ep->ep_next)
+    {
+	fprintf(f, "%s\n    {\"name\": ", (ep == extProfList) ? "" : ",");
+	extProfileJSONString(f, ep->ep_def->cd_name);
+	fprintf(f, ", \"order\": %d, \"tiles\": %d, \"nodes\": %d, "
+		"\"devices\": %d, \"process_peak_rss_kb\": %ld, "
+		"\"process_peak_rss_growth_kb\": %ld,\n",
+		ep->ep_order, ep->ep_tiles, ep->ep_nodes, ep->ep_devs,
+		ep->ep_peakrss, ep->ep_peakgrowth);
+
+	/* Distinct child defs */
+	fprintf(f, "     \"children\": [");
+	HashInit(&pc.epc_seen, 16, HT_WORDKEYS);
+	pc.epc_file = f;
+	pc.epc_count = 0;
+	(void) DBCellEnum(ep->ep_def, extProfileChildFunc, (ClientData) &pc);
+	HashKill(&pc.epc_seen);
+	fprintf(f, "],\n");
+
+	fprintf(f, "     \"time\": {");
+	for (i = 0; i < EXT_PROF_NPHASES; i++)
+	    fprintf(f, "\"%s\": %.6f, ", extProfPhaseNames[i], ep->ep_time[i]);
+	fprintf(f, "\"total\": %.6f},\n", ep->ep_total);
+
+	h = &ep->ep_hier;
+	fprintf(f, "     \"hier\": {\"cells\": %d, \"tiles\": %ld, "
+		"\"nodes\": %ld, \"devices\": %ld, \"time\": {",
+		h->epr_cells, h->epr_tiles, h->epr_nodes, h->epr_devs);
+	for (i = 0; i < EXT_PROF_NPHASES; i++)
+	    fprintf(f, "\"%s\": %.6f, ", extProfPhaseNames[i], h->epr_time[i]);
+	fprintf(f, "\"total\": %.6f}}}", h->epr_total);
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
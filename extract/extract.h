@@ -81,6 +81,10 @@ extern const char * const extDevTable[];
 					 * corners.  Adds compute time, and so
 					 * is not included in EXT_DOALL.
 					 */
+#define EXT_DOPARTIAL		0x1000	/* Re-extract only the changed area of
+					 * cells without subcells (see
+					 * ExtIncr.c).  Not in EXT_DOALL.
+					 */
 
 extern int ExtOptions;		/* Bitmask of above */
 extern char *ExtLocalPath;	/* If non-NULL, location to write .ext files */
@@ -126,8 +130,10 @@ extern FILE *ExtFileOpen(CellDef *def, char *file, char *mode, char **prealfile)
 /* C99 compat */
 extern void ExtAll();
 extern void ExtIncremental();
+extern void ExtIncrFree();
 extern void ExtLengthClear();
 extern void ExtParents();
+extern void ExtProfile();
 extern void ExtSetDriver();
 extern void ExtSetReceiver();
 extern void ExtShowParents();
@@ -145,6 +151,7 @@ extern void extHierFreeLabels();
 extern void extHierFreeOne();
 extern void extHierFreeOne();
 extern int  extHierSubstrate();
+extern int  extHierSubstrateArray();
 extern int  extHierYankFunc();
 extern bool extLabType();
 extern void extLength();
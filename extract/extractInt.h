@@ -1120,6 +1120,7 @@ extern struct stack *extNodeStack;
 
 /* C99 compat */
 extern void ExtFindInteractions();
+extern int  ExtSweepInteractions();
 extern void ExtInterCount();
 extern void ExtInterCount();
 extern void ExtTimes();
@@ -1137,6 +1138,37 @@ extern void extEnumTerminal(Tile *tile, TileType dinfo,
         TileTypeBitMask *connect, void (*func)(), ClientData clientData);
 extern void ExtRevertUniqueCell(CellDef *def);
 
+/* -------------------- Extraction profiling -------------------------- */
+
+/*
+ * Phases of extracting a single cell, timed separately by
+ * "extract profile" (see ExtTimes.c).  extProfileSwitch() stops the
+ * clock on the phase in progress and starts it on a new one.
+ */
+#define EXT_PROF_NONE		(-1)
+#define EXT_PROF_REGIONS	0	/* Node and device region finding */
+#define EXT_PROF_DEVICES	1	/* Device terminal/parameter output */
+#define EXT_PROF_COUPLING	2	/* Coupling capacitance */
+#define EXT_PROF_SUBTREE	3	/* Subcell and array interactions */
+#define EXT_PROF_HIERCONN	4	/* Hierarchical connections */
+#define EXT_PROF_OUTPUT		5	/* Writing everything else to .ext */
+#define EXT_PROF_NPHASES	6
+
+extern bool extProfileOn;
+extern int  extProfileSwitch();
+extern void extProfileCounts();
+extern void extProfileBeginCell();
+extern void extProfileEndCell();
+
+/* ------------------ Partial (incremental) re-extraction ------------- */
+
+extern CellDef *extIncrYankDef;	/* Yank buffer being re-extracted */
+extern HashTable extDriverHash;	/* Path length drivers (ExtLength.c) */
+extern bool ExtIncrCell();
+extern void ExtIncrSave();
+extern void ExtIncrSaveLines();
+extern void extIncrNameNodes();
+
 
 /* ------------------ Connectivity table management ------------------- */
 
@@ -59,7 +59,7 @@ resMakePortBreakpoints(tile, list)
     {
 	x = pl->rp_loc.p_x;
 	y = pl->rp_loc.p_y;
-	resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+	resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
 	InitializeResNode(resptr, x, y, RES_NODE_ORIGIN);
 	resptr->rn_status = TRUE;
 	resptr->rn_noderes = 0;
@@ -102,7 +102,7 @@ ResStartTile(tile, x, y)
 {
     resNode	*resptr;
 
-    resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+    resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
     InitializeResNode(resptr, x, y, RES_NODE_ORIGIN);
     resptr->rn_status = TRUE;
     resptr->rn_noderes = 0;
@@ -191,9 +191,9 @@ ResEachTile(tile, devNodeTable)
 		int x = (LEFT(tile) + RIGHT(tile)) >> 1;
 		int y = (TOP(tile) + BOTTOM(tile)) >> 1;
 
-		resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+		resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
 		tstructs->deviceList->rd_fet_gate = resptr;
-		tcell = (tElement *) mallocMagic((unsigned)(sizeof(tElement)));
+		tcell = (tElement *) ResArenaAlloc((unsigned)(sizeof(tElement)));
 		tcell->te_thist = tstructs->deviceList;
 		tcell->te_nextt = NULL;
 
@@ -208,17 +208,13 @@ ResEachTile(tile, devNodeTable)
 
     /* Process all the contact points */
     ce = tstructs->contactList;
-    while (ce != (cElement *) NULL)
+    for (; ce != (cElement *) NULL; ce = ce->ce_nextc)
     {
 	ResContactPoint	*cp = ce->ce_thisc;
-	cElement	*oldce;
 	if (cp->cp_cnode[0] == (resNode *) NULL)
 	{
 	    ResDoContacts(cp, &ResNodeQueue, &ResResList);
 	}
-	oldce = ce;
-	ce = ce->ce_nextc;
-	freeMagic((char *)oldce);
     }
     tstructs->contactList = NULL;
 
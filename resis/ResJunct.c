@@ -84,7 +84,7 @@ ResNewTermDevice(tile, tp, n, xj, yj, direction, PendingList)
  
     if (resDev->rd_terminals[2 + n] == (resNode *)NULL)
     {
-	resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+	resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
 	newnode = TRUE;
 	resDev->rd_terminals[2 + n] = resptr;
     }
@@ -94,20 +94,20 @@ ResNewTermDevice(tile, tp, n, xj, yj, direction, PendingList)
     }
     else if ((n == 0) && (resDev->rd_terminals[3] == (resNode *)NULL))
     {
-	resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+	resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
 	newnode = TRUE;
 	resDev->rd_terminals[3] = resptr;
     }
     else if ((n == 1) && (resDev->rd_terminals[2] == (resNode *)NULL))
     {
-	resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+	resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
 	newnode = TRUE;
 	resDev->rd_terminals[2] = resptr;
     }
 
     if (newnode)
     {
-	tcell = (tElement *) mallocMagic((unsigned)(sizeof(tElement)));
+	tcell = (tElement *) ResArenaAlloc((unsigned)(sizeof(tElement)));
 	tcell->te_nextt = NULL;
 	tcell->te_thist = ri->deviceList;
 	InitializeResNode(resptr, xj, yj, RES_NODE_DEVICE);
@@ -151,7 +151,7 @@ ResNewSubDevice(tile, tp, xj, yj, direction, PendingList)
 
     if (resDev->rd_fet_subs == (resNode *)NULL)
     {
-	resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+	resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
 	newnode = TRUE;
 	resDev->rd_fet_subs = resptr;
     }
@@ -160,7 +160,7 @@ ResNewSubDevice(tile, tp, xj, yj, direction, PendingList)
 
     if (newnode)
     {
-	tcell = (tElement *) mallocMagic((unsigned)(sizeof(tElement)));
+	tcell = (tElement *) ResArenaAlloc((unsigned)(sizeof(tElement)));
 	tcell->te_nextt = NULL;
 	tcell->te_thist = ri->deviceList;
 	InitializeResNode(resptr, xj, yj, RES_NODE_DEVICE);
@@ -204,10 +204,10 @@ ResProcessJunction(tile, tp, xj, yj, NodeList)
     }
 #endif
     if (ri2->ri_status & RES_TILE_DONE) return;
-    resptr = (resNode *) mallocMagic((unsigned)(sizeof(resNode)));
+    resptr = (resNode *) ResArenaAlloc((unsigned)(sizeof(resNode)));
     resptr->rn_te = (tElement *) NULL;
-    junction = (ResJunction *) mallocMagic((unsigned)(sizeof(ResJunction)));
-    jcell = (jElement *) mallocMagic((unsigned)(sizeof(jElement)));
+    junction = (ResJunction *) ResArenaAlloc((unsigned)(sizeof(ResJunction)));
+    jcell = (jElement *) ResArenaAlloc((unsigned)(sizeof(jElement)));
     InitializeResNode(resptr, xj, yj, RES_NODE_JUNCTION);
     resptr->rn_je = jcell;
     ResAddToQueue(resptr, NodeList);
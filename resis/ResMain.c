@@ -26,6 +26,7 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 
 CellUse 		*ResUse = NULL;		/* Our use and def */
 CellDef 		*ResDef = NULL;
+CellUse			*resCellUse = NULL;	/* Use of the cell being extracted */
 TileTypeBitMask 	ResConnectWithSD[NT];	/* A mask that goes from  */
 						/* SD's to devices.	  */
 TileTypeBitMask 	ResCopyMask[NT];	/* Indicates which tiles  */
@@ -639,7 +640,7 @@ ResFindNewContactTiles(contacts)
 		resInfo *ri = (resInfo *)TiGetClientPTR(tile);
 		cElement *ce;
 
-		ce = (cElement *) mallocMagic((unsigned) (sizeof(cElement)));
+		ce = (cElement *) ResArenaAlloc((unsigned) (sizeof(cElement)));
 		contacts->cp_tile[contacts->cp_currentcontact] = tile;
 		ce->ce_thisc = contacts;
 		ce->ce_nextc = ri->contactList;
@@ -661,7 +662,7 @@ ResFindNewContactTiles(contacts)
 			resInfo *ri = (resInfo *)TiGetClientPTR(tile);
 			cElement *ce;
 
-			ce = (cElement *) mallocMagic((unsigned) (sizeof(cElement)));
+			ce = (cElement *) ResArenaAlloc((unsigned) (sizeof(cElement)));
 			contacts->cp_tile[contacts->cp_currentcontact] = tile;
 			ce->ce_thisc = contacts;
 			ce->ce_nextc = ri->contactList;
@@ -1179,6 +1180,35 @@ ResShaveContacts(tile, dinfo, def)
     return 0;
 }
 
+/*
+ *-------------------------------------------------------------------------
+ *
+ * ResFreeCellUse --
+ *
+ *	Release the use of the cell being extracted that ResExtractNet()
+ *	keeps from one net to the next, so that the cell is not left with
+ *	a stray parent use (which would, for example, prevent it from
+ *	being deleted).
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees resCellUse.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+ResFreeCellUse()
+{
+    if (resCellUse != NULL)
+    {
+	DBCellDeleteUse(resCellUse);
+	resCellUse = NULL;
+    }
+}
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -1248,8 +1278,16 @@ ResExtractNet(node, resisdata, cellname)
 	    TxError("Error:  No such cell \"%s\"\n", cellname);
 	    return TRUE;
 	}
-	scx.scx_use = DBCellNewUse(def, (char *)NULL);
-	DBSetTrans (scx.scx_use, &GeoIdentityTransform);
+	/* Keep one use of the cell across nets, rather than adding a
+	 * new (never freed) parent use to the cell for every net.
+	 */
+	if ((resCellUse == NULL) || (resCellUse->cu_def != def))
+	{
+	    if (resCellUse != NULL) DBCellDeleteUse(resCellUse);
+	    resCellUse = DBCellNewUse(def, (char *)NULL);
+	    DBSetTrans (resCellUse, &GeoIdentityTransform);
+	}
+	scx.scx_use = resCellUse;
 	scx.scx_trans = GeoIdentityTransform;
     }
     else
@@ -1516,6 +1554,120 @@ ResExtractNet(node, resisdata, cellname)
 }
 
 
+/*
+ * The nodes, resistors, breakpoints, junctions, contacts, and list
+ * elements that make up the network of one net, and the resInfo
+ * records hung on its tiles, are carved out of large arena chunks
+ * by ResArenaAlloc() rather than malloc'd one at a time.  They are
+ * never freed individually;  ResCleanUpEverything() releases all of
+ * them at once when the net is done.  One chunk is kept for the next
+ * net, so that small nets do not go to the allocator at all.
+ */
+
+static char *resArenaChunks = NULL;	/* Chunks, linked through 1st word */
+static char *resArenaNext = NULL;	/* Next free byte in current chunk */
+static char *resArenaEnd = NULL;	/* End of current chunk */
+static size_t resArenaUsed = 0;		/* Bytes handed out for this net */
+
+#define	RES_ARENA_CHUNK		(256 * 1024)
+#define	RES_ARENA_ALIGN(n)	(((n) + sizeof (double) - 1) & ~(sizeof (double) - 1))
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * ResArenaAlloc --
+ *
+ *	Allocate 'size' bytes for a network object of the current net.
+ *
+ * Results:
+ *	Pointer to the (double-aligned) storage.
+ *
+ * Side effects:
+ *	May allocate a new arena chunk.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+char *
+ResArenaAlloc(size)
+    unsigned size;
+{
+    char *chunk, *mem;
+    size_t chunkSize;
+
+    size = RES_ARENA_ALIGN(size);
+    if (resArenaNext == NULL || resArenaNext + size > resArenaEnd)
+    {
+	chunkSize = RES_ARENA_ALIGN(sizeof (char *)) + size;
+	if (chunkSize < RES_ARENA_CHUNK) chunkSize = RES_ARENA_CHUNK;
+	chunk = (char *) mallocMagic(chunkSize);
+	*((char **) chunk) = resArenaChunks;
+	resArenaChunks = chunk;
+	resArenaNext = chunk + RES_ARENA_ALIGN(sizeof (char *));
+	resArenaEnd = chunk + chunkSize;
+    }
+    mem = resArenaNext;
+    resArenaNext += size;
+    resArenaUsed += size;
+    return mem;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * ResArenaUsed --
+ *
+ *	Since nothing is freed before the end of a net, this is also
+ *	the high-water mark of the memory used by its network.
+ *
+ * Results:
+ *	The number of bytes allocated by ResArenaAlloc() for the
+ *	current net.
+ *
+ * Side effects:
+ *	None.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+size_t
+ResArenaUsed()
+{
+    return resArenaUsed;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * ResArenaRelease --
+ *
+ *	Release everything allocated by ResArenaAlloc().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees all arena chunks but the oldest, which is reset for reuse.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+ResArenaRelease()
+{
+    char *chunk;
+
+    if (resArenaChunks == NULL) return;
+    while ((chunk = *((char **) resArenaChunks)) != NULL)
+    {
+	freeMagic(resArenaChunks);
+	resArenaChunks = chunk;
+    }
+    resArenaNext = resArenaChunks + RES_ARENA_ALIGN(sizeof (char *));
+    resArenaEnd = resArenaChunks + RES_ARENA_CHUNK;
+    resArenaUsed = 0;
+}
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -1525,7 +1677,8 @@ ResExtractNet(node, resisdata, cellname)
  *
  * Results: none
  *
- * Side Effects: Frees up memory formerly occupied by network elements.
+ * Side Effects: Frees up memory formerly occupied by network elements,
+ *	releasing the arena in one shot.
  *
  *-------------------------------------------------------------------------
  */
@@ -1533,38 +1686,17 @@ ResExtractNet(node, resisdata, cellname)
 void
 ResCleanUpEverything()
 {
-
-    int		    pNum;
-    resResistor	    *oldRes;
     resDevice	    *oldDev;
-    ResContactPoint *oldCon;
 
-    /* Check integrity of internal database. Free up lists. */
+    /* The network itself and the resInfo records on the tiles are	*/
+    /* all in the arena, and the tiles go away with the def.		*/
 
-    for (pNum = PL_TECHDEPBASE; pNum < DBNumPlanes; pNum++)
-    {
-    	(void) DBSrPaintClient((Tile *)NULL, ResUse->cu_def->cd_planes[pNum],
-	 		&(ResUse->cu_def->cd_bbox), &DBAllButSpaceAndDRCBits,
-			(ClientData)CLIENTDEFAULT, ResRemovePlumbing,
-			(ClientData)NULL);
-    }
+    ResNodeList = ResNodeQueue = NULL;
+    ResResList = NULL;
+    ResContactList = NULL;
+    ResNodeAtOrigin = NULL;
+    ResArenaRelease();
 
-    while (ResNodeList != NULL)
-    {
-	ResCleanNode(ResNodeList, TRUE, &ResNodeList, &ResNodeQueue);
-    }
-    while (ResContactList != NULL)
-    {
-    	 oldCon = ResContactList;
-	 ResContactList = oldCon->cp_nextcontact;
-	 freeMagic((char *)oldCon);
-    }
-    while (ResResList != NULL)
-    {
-    	 oldRes = ResResList;
-	 ResResList = ResResList->rr_nextResistor;
-	 freeMagic((char *)oldRes);
-    }
     while (ResDevList != NULL)
     {
     	 oldDev = ResDevList;
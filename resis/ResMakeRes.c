@@ -140,15 +140,14 @@ ResCalcEastWest(tile, pendingList, doneList, resList)
     height = TOP(tile) - BOTTOM(tile);
 
     /*
-     * One Breakpoint?  No resistors need to be made.  Free up the first
-     * breakpoint, then return.
+     * One Breakpoint?  No resistors need to be made.  Drop the
+     * breakpoint (it is in the arena) and return.
      */
 
     p1 = info->breakList;
     if   (p1->br_next == NULL)
     {
 	p1->br_this->rn_float.rn_area += height * (RIGHT(tile) - LEFT(tile));
-	freeMagic((char *)p1);
 	info->breakList = NULL;
 	return(merged);
     }
@@ -206,7 +205,6 @@ ResCalcEastWest(tile, pendingList, doneList, resList)
 	    {
 		 currNode = NULL;
 		 p1->br_next = p2->br_next;
-		 freeMagic((char *)p2);
 		 p2 = p1;
 	    }
 	    else if (p2->br_this == resCurrentNode)
@@ -214,7 +212,6 @@ ResCalcEastWest(tile, pendingList, doneList, resList)
 		 currNode = p1->br_this;
 	    	 ResMergeNodes(p2->br_this, p1->br_this, pendingList, doneList);
 		 merged = TRUE;
-		 freeMagic((char *)p1);
 	    }
 	    else if (p1->br_this == resCurrentNode)
 	    {
@@ -222,14 +219,12 @@ ResCalcEastWest(tile, pendingList, doneList, resList)
 		 p1->br_next = p2->br_next;
 	    	 ResMergeNodes(p1->br_this, p2->br_this, pendingList, doneList);
 		 merged = TRUE;
-		 freeMagic((char *)p2);
 		 p2 = p1;
 	    }
 	    else
 	    {
 		 currNode = p1->br_this;
 	    	 ResMergeNodes(p2->br_this, p1->br_this, pendingList, doneList);
-		 freeMagic((char *)p1);
 	    }
 
 	    /*
@@ -267,18 +262,18 @@ ResCalcEastWest(tile, pendingList, doneList, resList)
 
 	else
 	{
-            resistor = (resResistor *)mallocMagic((unsigned)sizeof(resResistor));
+            resistor = (resResistor *)ResArenaAlloc((unsigned)sizeof(resResistor));
             resistor->rr_nextResistor = (*resList);
             resistor->rr_lastResistor = NULL;
             if ((*resList) != NULL) (*resList)->rr_lastResistor = resistor;
             (*resList) = resistor;
             resistor->rr_connection1 = p1->br_this;
             resistor->rr_connection2 = p2->br_this;
-            element = (resElement *)mallocMagic((unsigned)sizeof(resElement));
+            element = (resElement *)ResArenaAlloc((unsigned)sizeof(resElement));
             element->re_nextEl = p1->br_this->rn_re;
             element->re_thisEl = resistor;
             p1->br_this->rn_re = element;
-            element = (resElement *)mallocMagic((unsigned)sizeof(resElement));
+            element = (resElement *)ResArenaAlloc((unsigned)sizeof(resElement));
             element->re_nextEl = p2->br_this->rn_re;
             element->re_thisEl = resistor;
             p2->br_this->rn_re = element;
@@ -305,14 +300,12 @@ ResCalcEastWest(tile, pendingList, doneList, resList)
 	    resistor->rr_connection2->rn_float.rn_area += rArea;
 	    resistor->rr_float.rr_area = 0;
 
-	    freeMagic((char *)p1);
 	}
     }
 
     if (count >= 16) HashKill(&BreakTable);
 
     p2->br_this->rn_float.rn_area += height * (RIGHT(tile) - p2->br_loc.p_x);
-    freeMagic((char *)p2);
     info->breakList = NULL;
     return merged;
 }
@@ -352,15 +345,14 @@ ResCalcNorthSouth(tile, pendingList, doneList, resList)
     width = RIGHT(tile) - LEFT(tile);
 
     /*
-     * One Breakpoint? No resistors need to be made. Free up the first
-     * breakpoint, then return.
+     * One Breakpoint? No resistors need to be made. Drop the
+     * breakpoint (it is in the arena) and return.
      */
 
     p1 = info->breakList;
     if (p1->br_next == NULL)
     {
 	p1->br_this->rn_float.rn_area += width * (TOP(tile) - BOTTOM(tile));
-     	freeMagic((char *)p1);
 	info->breakList = NULL;
 	return(merged);
     }
@@ -418,14 +410,12 @@ ResCalcNorthSouth(tile, pendingList, doneList, resList)
 	    {
 		currNode = NULL;
 		p1->br_next = p2->br_next;
-		freeMagic((char *)p2);
 		p2 = p1;
 	    }
 	    else if (p2->br_this == resCurrentNode)
 	    {
 		currNode = p1->br_this;
 	    	ResMergeNodes(p2->br_this, p1->br_this, pendingList, doneList);
-		freeMagic((char *)p1);
 		merged = TRUE;
 	    }
 	    else if (p1->br_this == resCurrentNode)
@@ -434,14 +424,12 @@ ResCalcNorthSouth(tile, pendingList, doneList, resList)
 		p1->br_next = p2->br_next;
 	    	ResMergeNodes(p1->br_this, p2->br_this, pendingList, doneList);
 		merged = TRUE;
-		freeMagic((char *)p2);
 		p2 = p1;
 	    }
 	    else
 	    {
 		currNode = p1->br_this;
 	    	ResMergeNodes(p2->br_this, p1->br_this, pendingList, doneList);
-		freeMagic((char *)p1);
 	    }
 
 	    /*
@@ -479,18 +467,18 @@ ResCalcNorthSouth(tile, pendingList, doneList, resList)
 
 	else
 	{
-	    resistor = (resResistor *) mallocMagic((unsigned) (sizeof(resResistor)));
+	    resistor = (resResistor *) ResArenaAlloc((unsigned) (sizeof(resResistor)));
 	    resistor->rr_nextResistor = (*resList);
 	    resistor->rr_lastResistor = NULL;
 	    if ((*resList) != NULL) (*resList)->rr_lastResistor = resistor;
 	    (*resList) = resistor;
 	    resistor->rr_connection1 = p1->br_this;
 	    resistor->rr_connection2 = p2->br_this;
-	    element = (resElement *) mallocMagic((unsigned) (sizeof(resElement)));
+	    element = (resElement *) ResArenaAlloc((unsigned) (sizeof(resElement)));
 	    element->re_nextEl = p1->br_this->rn_re;
 	    element->re_thisEl = resistor;
 	    p1->br_this->rn_re = element;
-	    element = (resElement *) mallocMagic((unsigned) (sizeof(resElement)));
+	    element = (resElement *) ResArenaAlloc((unsigned) (sizeof(resElement)));
 	    element->re_nextEl = p2->br_this->rn_re;
 	    element->re_thisEl = resistor;
 	    p2->br_this->rn_re = element;
@@ -515,11 +503,9 @@ ResCalcNorthSouth(tile, pendingList, doneList, resList)
 	    resistor->rr_connection1->rn_float.rn_area += rArea;
 	    resistor->rr_connection2->rn_float.rn_area += rArea;
 	    resistor->rr_float.rr_area = 0;
-	    freeMagic((char *)p1);
 	}
     }
     p2->br_this->rn_float.rn_area += width * (TOP(tile) - p2->br_loc.p_y);
-    freeMagic((char *)p2);
     info->breakList = NULL;
     return(merged);
 }
@@ -558,13 +544,12 @@ ResCalcNearDevice(tile, pendingList, doneList, resList)
     merged = FALSE;
 
     /*
-     *  One Breakpoint?  No resistors need to be made.  Free up the first
-     *	breakpoint, then return.
+     *  One Breakpoint?  No resistors need to be made.  Drop the
+     *	breakpoint (it is in the arena) and return.
      */
 
     if (info->breakList->br_next == NULL)
     {
-     	freeMagic((char *)info->breakList);
 	info->breakList = NULL;
 	return(merged);
     }
@@ -775,13 +760,11 @@ ResCalcNearDevice(tile, pendingList, doneList, resList)
 			    if (p3 == NULL)
 			    {
 				info->breakList = p2->br_next;
-				freeMagic((char *) p2);
 				p2 = info->breakList;
 			    }
 			    else
 			    {
 				p3->br_next = p2->br_next;
-				freeMagic((char *) p2);
 				p2 = p3->br_next;
 			    }
 			}
@@ -815,13 +798,11 @@ ResCalcNearDevice(tile, pendingList, doneList, resList)
 			    if (p3 == NULL)
 			    {
 				info->breakList = p2->br_next;
-				freeMagic((char *) p2);
 				p2 = info->breakList;
 			    }
 			    else
 			    {
 				p3->br_next = p2->br_next;
-				freeMagic((char *) p2);
 				p2 = p3->br_next;
 			    }
 			}
@@ -875,11 +856,11 @@ ResDoContacts(contact, nodes, resList)
 	int x = contact->cp_center.p_x;
 	int y = contact->cp_center.p_y;
 
-	resptr = (resNode *) mallocMagic((unsigned) (sizeof(resNode)));
+	resptr = (resNode *) ResArenaAlloc((unsigned) (sizeof(resNode)));
 	InitializeResNode(resptr, x, y, RES_NODE_CONTACT);
 	ResAddToQueue(resptr, nodes);
 
- 	ccell = (cElement *) mallocMagic((unsigned) (sizeof(cElement)));
+ 	ccell = (cElement *) ResArenaAlloc((unsigned) (sizeof(cElement)));
 	ccell->ce_nextc = resptr->rn_ce;
 	resptr->rn_ce = ccell;
 	ccell->ce_thisc = contact;
@@ -928,13 +909,13 @@ ResDoContacts(contact, nodes, resList)
       	    int  y = contact->cp_center.p_y;
 	    Tile *tile = contact->cp_tile[tilenum];
 
-	    resptr = (resNode *) mallocMagic((unsigned) (sizeof(resNode)));
+	    resptr = (resNode *) ResArenaAlloc((unsigned) (sizeof(resNode)));
 	    InitializeResNode(resptr, x, y, RES_NODE_CONTACT);
 	    ResAddToQueue(resptr, nodes);
 
  	    /* Add contact pointer to node  */
 
-	    ccell = (cElement *) mallocMagic((unsigned) (sizeof(cElement)));
+	    ccell = (cElement *) ResArenaAlloc((unsigned) (sizeof(cElement)));
 	    ccell->ce_nextc = resptr->rn_ce;
 	    resptr->rn_ce = ccell;
 	    ccell->ce_thisc = contact;
@@ -947,7 +928,7 @@ ResDoContacts(contact, nodes, resList)
 
 	    if (tilenum > 0)
 	    {
-	        resistor = (resResistor *) mallocMagic((unsigned) (sizeof(resResistor)));
+	        resistor = (resResistor *) ResArenaAlloc((unsigned) (sizeof(resResistor)));
 	        resistor->rr_nextResistor = (*resList);
 	        resistor->rr_lastResistor = NULL;
 	        if ((*resList) != NULL) (*resList)->rr_lastResistor = resistor;
@@ -955,11 +936,11 @@ ResDoContacts(contact, nodes, resList)
 	        resistor->rr_connection1 = contact->cp_cnode[tilenum - 1];
 	        resistor->rr_connection2 = contact->cp_cnode[tilenum];
 
-	        element = (resElement *) mallocMagic((unsigned) (sizeof(resElement)));
+	        element = (resElement *) ResArenaAlloc((unsigned) (sizeof(resElement)));
 	        element->re_nextEl = contact->cp_cnode[tilenum - 1]->rn_re;
 	        element->re_thisEl = resistor;
 	        contact->cp_cnode[tilenum - 1]->rn_re = element;
-	        element = (resElement *) mallocMagic((unsigned)(sizeof(resElement)));
+	        element = (resElement *) ResArenaAlloc((unsigned)(sizeof(resElement)));
 	        element->re_nextEl = contact->cp_cnode[tilenum]->rn_re;
 	        element->re_thisEl = resistor;
 	        contact->cp_cnode[tilenum]->rn_re = element;
@@ -648,7 +648,7 @@ ResTriangleCheck(resptr)
 			rr2->rr_value = 0;
 			rr3->rr_value = 0;
 		    }
-		    n3 = (resNode *)mallocMagic((unsigned)(sizeof(resNode)));
+		    n3 = (resNode *)ResArenaAlloc((unsigned)(sizeof(resNode)));
 
 		    /* Where should the new node be put?  It    */
 		    /* is arbitrarily assigned to the location	*/
@@ -691,15 +691,15 @@ ResTriangleCheck(resptr)
 			ResDeleteResPointer(rr3->rr_connection1, rr3);
 			rr3->rr_connection1 = n3;
 		    }
-		    element = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+		    element = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
 		    element->re_nextEl = NULL;
 		    element->re_thisEl = rr1;
 		    n3->rn_re = element;
-		    element = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+		    element = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
 		    element->re_nextEl = n3->rn_re;
 		    element->re_thisEl = rr2;
 		    n3->rn_re = element;
-		    element = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+		    element = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
 		    element->re_nextEl = n3->rn_re;
 		    element->re_thisEl = rr3;
 		    n3->rn_re = element;
@@ -783,7 +783,7 @@ ResTriangleCheck(resptr)
 		    rr2->rr_value = 0;
 		    rr3->rr_value = 0;
 	        }
-		n3 = (resNode *)mallocMagic((unsigned)(sizeof(resNode)));
+		n3 = (resNode *)ResArenaAlloc((unsigned)(sizeof(resNode)));
 
 	      	/* Where should the new node be put?  It    */
 	        /* is arbitrarily assigned to the location  */
@@ -826,15 +826,15 @@ ResTriangleCheck(resptr)
 		    ResDeleteResPointer(rr3->rr_connection1, rr3);
 		    rr3->rr_connection1 = n3;
 		}
-		element = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+		element = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
 		element->re_nextEl = NULL;
 		element->re_thisEl = rr1;
 		n3->rn_re = element;
-		element = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+		element = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
 		element->re_nextEl = n3->rn_re;
 		element->re_thisEl = rr2;
 		n3->rn_re = element;
-		element = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+		element = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
 		element->re_nextEl = n3->rn_re;
 		element->re_thisEl = rr3;
 		n3->rn_re = element;
@@ -1015,12 +1015,6 @@ ResMergeNodes(node1, node2, pendingList, doneList)
     else
       	ResRemoveFromQueue(node2, pendingList);
 
-    if (node2->rn_client != (ClientData)NULL)
-    {
-	freeMagic((char *)node2->rn_client);
-	node2->rn_client = (ClientData)NULL;
-    }
-
     /* Don't merge away the ResNodeAtOrigin node */
     if (ResNodeAtOrigin == node2) ResNodeAtOrigin = node1;
 
@@ -1030,7 +1024,6 @@ ResMergeNodes(node1, node2, pendingList, doneList)
     node2->rn_te = (tElement   *)CLIENTDEFAULT;
     node2->rn_more = (resNode  *)CLIENTDEFAULT;
     node2->rn_less = (resNode  *)CLIENTDEFAULT;
-    freeMagic((char *)node2);
 }
 
 /*
@@ -1071,7 +1064,6 @@ ResDeleteResPointer(node, resistor)
 	    /* pointers to structure.				    */
 	    rcell2->re_thisEl = NULL;
 	    rcell2->re_nextEl = NULL;
-	    freeMagic((char *)rcell2);
 	    break;
 	}
 	rcell1 = rcell2;
@@ -1116,7 +1108,6 @@ ResEliminateResistor(resistor, homelist)
     resistor->rr_lastResistor = NULL;
     resistor->rr_connection1 = NULL;
     resistor->rr_connection2 = NULL;
-    freeMagic((char *)resistor);
 }
 
 /*
@@ -1124,11 +1115,13 @@ ResEliminateResistor(resistor, homelist)
  *
  * ResCleanNode--removes the linked lists of junctions and contacts after
  *		they are no longer needed. If the 'info' option is used,
- *		the node is eradicated.
+ *		the node is eradicated.  The lists and the node itself
+ *		are in the arena (see ResArenaAlloc()), so nothing is
+ *		freed here.
  *
  * Results: none.
  *
- * Side Effects: frees memory
+ * Side Effects: unlinks the node from its list if 'info' is TRUE.
  *
  *-------------------------------------------------------------------------
  */
@@ -1140,44 +1133,11 @@ ResCleanNode(resptr, info, homelist1, homelist2)
     resNode **homelist1;
     resNode **homelist2;
 {
-    resElement *rcell;
-    cElement *ccell;
-    jElement *jcell;
-    tElement *tcell;
-
-    /* free up contact and junction lists */
-    while (resptr->rn_ce != NULL)
-    {
-	ccell = resptr->rn_ce;
-	resptr->rn_ce = resptr->rn_ce->ce_nextc;
-	freeMagic((char *)ccell);
-    }
-    while (resptr->rn_je != NULL)
-    {
-	jcell = resptr->rn_je;
-	resptr->rn_je = resptr->rn_je->je_nextj;
-	freeMagic((char *)jcell->je_thisj);
-	freeMagic((char *)jcell);
-    }
+    resptr->rn_ce = NULL;
+    resptr->rn_je = NULL;
     if (info == TRUE)
     {
-	if (resptr->rn_client != (ClientData)NULL)
-	{
-	    freeMagic((char *)resptr->rn_client);
-	    resptr->rn_client = (ClientData)NULL;
-	}
-	while (resptr->rn_te != NULL)
-        {
-	    tcell = resptr->rn_te;
-	    resptr->rn_te = resptr->rn_te->te_nextt;
-	    freeMagic((char *)tcell);
-        }
-        while (resptr->rn_re != NULL)
-        {
-	    rcell = resptr->rn_re;
-	    resptr->rn_re = resptr->rn_re->re_nextEl;
-	    freeMagic((char *)rcell);
-        }
+	resptr->rn_client = (ClientData)NULL;
 	if (resptr->rn_less != NULL)
 	    resptr->rn_less->rn_more = resptr->rn_more;
 	else
@@ -1198,8 +1158,6 @@ ResCleanNode(resptr, info, homelist1, homelist2)
 	resptr->rn_te = (tElement   *) CLIENTDEFAULT;
 	resptr->rn_more = (resNode   *) CLIENTDEFAULT;
 	resptr->rn_less = (resNode   *) CLIENTDEFAULT;
-
-	freeMagic((char *)resptr);
     }
 }
 
@@ -1213,7 +1171,7 @@ ResCleanNode(resptr, info, homelist1, homelist2)
  *
  * Results: none
  *
- * Side Effects: may free up memory if breakpoint is already present.
+ * Side Effects: may drop the breakpoint if it is already present.
  *
  *-------------------------------------------------------------------------
  */
@@ -1255,7 +1213,6 @@ ResFixBreakPoint(sourcelist, origNode, newNode)
 		if (bp3->br_crect != NULL &&  bp4->br_crect == NULL)
 		    bp4->br_crect = bp3->br_crect;
 
-		freeMagic((char *)bp3);
 		continue;
 	    }
 	    else
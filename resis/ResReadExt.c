@@ -848,6 +848,10 @@ ResReadDevice(int argc,
     device->rs_ttype = extGetDevType(devptr->exts_deviceName);
     device->rs_wl = (l == 0) ? 0.0 : (float)w / (float)l;
 
+    device->rs_gate = device->gate;
+    device->rs_source = device->source;
+    device->rs_drain = device->drain;
+
     ResRDevList = device;
     device->layout = NULL;
     return 0;
@@ -925,6 +929,10 @@ ResReadFET(int argc,
     w = MAX(w, atoi(argv[FET_DRAIN_ATTR - 1]));
     device->rs_wl = (l == 0) ? 0.0 : (float)w / (float)l;
 
+    device->rs_gate = device->gate;
+    device->rs_source = device->source;
+    device->rs_drain = device->drain;
+
     ResRDevList = device;
     device->layout = NULL;
     return 0;
@@ -1070,6 +1078,7 @@ ResExtInitNode(entry)
     HashEntry	*entry;
 {
     ResExtNode	*node;
+    static int	nodeNumber = 0;
 
     if ((node = (ResExtNode *) HashGetValue(entry)) == NULL)
     {
@@ -1078,6 +1087,7 @@ ResExtInitNode(entry)
 	node->nextnode = ResOriginalNodes;
 	ResOriginalNodes = node;
 	node->status = FALSE;
+	node->number = nodeNumber++;
 	node->forward = (ResExtNode *) NULL;
 	node->capacitance = 0;
 	node->cap_couple = 0;
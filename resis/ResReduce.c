@@ -0,0 +1,598 @@
+/*
+ *-------------------------------------------------------------------------
+ *
+ * ResReduce.c -- Reduction of extracted resistor networks by node
+ *	elimination on a sparse conductance matrix.
+ *
+ *	This is an alternative to the local merges of ResSimplifyNet()
+ *	and ResScrunchNet(), selected with "extresist reduce".  The
+ *	network is turned into a sparse conductance matrix, and each
+ *	internal node whose time constant (node capacitance over total
+ *	conductance) is below a tolerance is removed by Gaussian
+ *	elimination, as in the TICER method:  eliminating node k
+ *	connects every pair of its neighbors i and j by a conductance
+ *	g_ik * g_jk / g_kk, and divides the capacitance of node k among
+ *	its neighbors in proportion to g_ik / g_kk.  The result is exact
+ *	at DC, the delay error is bounded by the time constant of the
+ *	eliminated nodes, and it works the same on trees and on meshes.
+ *	Nodes are eliminated lowest degree first, to limit fill-in.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "utils/magic.h"
+#include "utils/geometry.h"
+#include "tiles/tile.h"
+#include "utils/hash.h"
+#include "utils/heap.h"
+#include "database/database.h"
+#include "utils/malloc.h"
+#include "textio/textio.h"
+#include "extract/extract.h"
+#include "extract/extractInt.h"
+#include "windows/windows.h"
+#include "dbwind/dbwind.h"
+#include "utils/tech.h"
+#include "textio/txcommands.h"
+#include "resis/resis.h"
+
+/*
+ * One off-diagonal entry of the conductance matrix.  Each resistor
+ * (or set of parallel resistors) between nodes i and j is kept as
+ * two edges, one in the list of each node.
+ */
+
+typedef struct resredge
+{
+    struct resredge *rre_next;	/* Next edge of the same node */
+    int		    rre_node;	/* Index of the node at the other end */
+    double	    rre_g;	/* Conductance, in 1/milliohms */
+    TileType	    rre_type;	/* Type of a resistor making up the edge */
+} ResRedEdge;
+
+/* One row of the conductance matrix */
+
+typedef struct resrednode
+{
+    resNode	*rrn_node;	/* Node of the extracted network */
+    ResRedEdge	*rrn_edges;	/* Off-diagonal entries of the row */
+    int		rrn_degree;	/* Number of entries in rrn_edges */
+    double	rrn_cap;	/* Node capacitance */
+    int		rrn_status;	/* See below */
+} ResRedNode;
+
+/* "rrn_status" flags */
+
+#define RRN_KEEP	0x01	/* Node may not be eliminated */
+#define RRN_GONE	0x02	/* Node has been eliminated */
+
+/* Eliminating a node of degree d may add up to d(d-1)/2 resistors
+ * between its neighbors.  Nodes with more neighbors than this are
+ * eliminated only if that adds no resistors.
+ */
+
+#define RES_REDUCE_MAXDEGREE	32
+
+/* Resistors of zero value (in milliohms) are given this value instead */
+
+#define RES_REDUCE_MINRES	1.0
+
+/* Free list of edges, so that fill-in reuses the edges of eliminated nodes */
+
+static ResRedEdge *resRedFreeList = NULL;
+
+/* Number of resistors (pairs of edges) currently in the matrix */
+
+static int resRedEdgeCount;
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedNewEdge --
+ *
+ *	Add an entry for node j with conductance g to the row of rnode.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Takes an edge from the free list, or allocates one.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resRedNewEdge(rnode, j, g, type)
+    ResRedNode	*rnode;
+    int		j;
+    double	g;
+    TileType	type;
+{
+    ResRedEdge	*edge;
+
+    if (resRedFreeList != NULL)
+    {
+	edge = resRedFreeList;
+	resRedFreeList = edge->rre_next;
+    }
+    else
+	edge = (ResRedEdge *)ResArenaAlloc(sizeof(ResRedEdge));
+    edge->rre_node = j;
+    edge->rre_g = g;
+    edge->rre_type = type;
+    edge->rre_next = rnode->rrn_edges;
+    rnode->rrn_edges = edge;
+    rnode->rrn_degree++;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedAddEdge --
+ *
+ *	Add conductance g between nodes i and j of the matrix, creating
+ *	the entries if they do not exist yet.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May add an edge to the edge lists of both nodes.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resRedAddEdge(nodes, i, j, g, type)
+    ResRedNode	*nodes;
+    int		i, j;
+    double	g;
+    TileType	type;
+{
+    ResRedEdge	*edge;
+
+    if (i == j) return;
+
+    for (edge = nodes[i].rrn_edges; edge != NULL; edge = edge->rre_next)
+	if (edge->rre_node == j)
+	    break;
+
+    if (edge == NULL)
+    {
+	resRedNewEdge(&nodes[i], j, g, type);
+	resRedNewEdge(&nodes[j], i, g, type);
+	resRedEdgeCount++;
+	return;
+    }
+
+    edge->rre_g += g;
+    for (edge = nodes[j].rrn_edges; edge != NULL; edge = edge->rre_next)
+	if (edge->rre_node == i)
+	{
+	    edge->rre_g += g;
+	    break;
+	}
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedRemoveEdge --
+ *
+ *	Remove the entry for node j from the row of node i.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The edge is put on the free list.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resRedRemoveEdge(rnode, j)
+    ResRedNode	*rnode;
+    int		j;
+{
+    ResRedEdge	*edge, **prev;
+
+    for (prev = &rnode->rrn_edges; (edge = *prev) != NULL;
+		prev = &edge->rre_next)
+	if (edge->rre_node == j)
+	{
+	    *prev = edge->rre_next;
+	    edge->rre_next = resRedFreeList;
+	    resRedFreeList = edge;
+	    rnode->rrn_degree--;
+	    return;
+	}
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedGrowth --
+ *
+ *	Find how many resistors eliminating rnode would add to the
+ *	matrix:  one for each pair of its neighbors that is not yet
+ *	connected, less the resistors to rnode itself.
+ *
+ * Results:
+ *	The change in the number of resistors.  For nodes with more
+ *	than maxdegree neighbors, counting stops as soon as the result
+ *	is known to be positive.
+ *
+ * Side effects:
+ *	None.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+resRedGrowth(nodes, rnode, maxdegree)
+    ResRedNode	*nodes;
+    ResRedNode	*rnode;
+    int		maxdegree;
+{
+    ResRedEdge	*edge, *edge2, *e;
+    int		fill = 0;
+
+    for (edge = rnode->rrn_edges; edge != NULL; edge = edge->rre_next)
+	for (edge2 = edge->rre_next; edge2 != NULL; edge2 = edge2->rre_next)
+	{
+	    for (e = nodes[edge->rre_node].rrn_edges; e != NULL; e = e->rre_next)
+		if (e->rre_node == edge2->rre_node)
+		    break;
+	    if ((e == NULL) && (++fill > rnode->rrn_degree) &&
+			(rnode->rrn_degree > maxdegree))
+		return fill - rnode->rrn_degree;
+	}
+    return fill - rnode->rrn_degree;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedEliminate --
+ *
+ *	Eliminate node k from the matrix.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Adds fill-in conductances between the neighbors of node k and
+ *	moves its capacitance to them.  The edges of node k are freed.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resRedEliminate(nodes, k, gkk)
+    ResRedNode	*nodes;
+    int		k;
+    double	gkk;		/* Sum of the conductances of node k */
+{
+    ResRedNode	*rnode = &nodes[k], *nbr;
+    ResRedEdge	*edge, *edge2;
+
+    for (edge = rnode->rrn_edges; edge != NULL; edge = edge->rre_next)
+    {
+	nbr = &nodes[edge->rre_node];
+	nbr->rrn_cap += rnode->rrn_cap * edge->rre_g / gkk;
+	resRedRemoveEdge(nbr, k);
+    }
+    for (edge = rnode->rrn_edges; edge != NULL; edge = edge->rre_next)
+	for (edge2 = edge->rre_next; edge2 != NULL; edge2 = edge2->rre_next)
+	    resRedAddEdge(nodes, edge->rre_node, edge2->rre_node,
+			edge->rre_g * edge2->rre_g / gkk, edge->rre_type);
+
+    while ((edge = rnode->rrn_edges) != NULL)
+    {
+	rnode->rrn_edges = edge->rre_next;
+	edge->rre_next = resRedFreeList;
+	resRedFreeList = edge;
+	resRedEdgeCount--;
+    }
+    rnode->rrn_degree = 0;
+    rnode->rrn_status |= RRN_GONE;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedLoad --
+ *
+ *	(Re)load the matrix from the nodes and resistors of the network,
+ *	summing parallel resistors.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Any edges already in the matrix go back to the free list, and
+ *	eliminated nodes are restored.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resRedLoad(nodes, nnodes)
+    ResRedNode	*nodes;
+    int		nnodes;
+{
+    ResRedNode	*rnode;
+    ResRedEdge	*edge;
+    resResistor	*res;
+    int		k;
+
+    for (k = 0; k < nnodes; k++)
+    {
+	rnode = &nodes[k];
+	while ((edge = rnode->rrn_edges) != NULL)
+	{
+	    rnode->rrn_edges = edge->rre_next;
+	    edge->rre_next = resRedFreeList;
+	    resRedFreeList = edge;
+	}
+	rnode->rrn_degree = 0;
+	rnode->rrn_cap = rnode->rrn_node->rn_float.rn_area;
+	rnode->rrn_status &= ~RRN_GONE;
+    }
+
+    resRedEdgeCount = 0;
+    for (res = ResResList; res != NULL; res = res->rr_nextResistor)
+	resRedAddEdge(nodes, res->rr_connection1->rn_id,
+		res->rr_connection2->rn_id,
+		1.0 / MAX(res->rr_value, RES_REDUCE_MINRES), res->rr_tt);
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRedReduce --
+ *
+ *	Eliminate the nodes of the matrix whose time constant is less
+ *	than maxtau, in order of the number of resistors that their
+ *	elimination adds.  Nodes of degree above maxdegree are only
+ *	eliminated if that adds no resistors.
+ *
+ *	Keys go stale as the neighborhood of a node changes, so each
+ *	key is checked again when it comes off the heap and the node is
+ *	put back if it has changed.  A node may also become acceptable
+ *	after it has been refused, so passes are repeated until one
+ *	eliminates nothing.
+ *
+ * Results:
+ *	The largest time constant of an eliminated node.
+ *
+ * Side effects:
+ *	Eliminates nodes from the matrix.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+double
+resRedReduce(nodes, nnodes, maxtau, maxdegree)
+    ResRedNode	*nodes;
+    int		nnodes;
+    double	maxtau;
+    int		maxdegree;
+{
+    ResRedNode	*rnode;
+    ResRedEdge	*edge;
+    Heap	heap;
+    HeapEntry	he;
+    double	gkk, tau, worst = 0.0;
+    int		k, growth, eliminated;
+
+    HeapInitType(&heap, 64, FALSE, FALSE, HE_INT);
+    do
+    {
+	eliminated = 0;
+	for (k = 0; k < nnodes; k++)
+	    if ((nodes[k].rrn_status & (RRN_KEEP | RRN_GONE)) == 0)
+		HeapAddInt(&heap, resRedGrowth(nodes, &nodes[k], maxdegree),
+			(char *)&nodes[k]);
+
+	while (HeapRemoveTop(&heap, &he) != NULL)
+	{
+	    rnode = (ResRedNode *)he.he_id;
+	    if ((rnode->rrn_status & RRN_GONE) || (rnode->rrn_degree == 0))
+		continue;
+
+	    growth = resRedGrowth(nodes, rnode, maxdegree);
+	    if (growth != he.he_int)
+	    {
+		HeapAddInt(&heap, growth, (char *)rnode);
+		continue;
+	    }
+	    if ((growth > 0) && (rnode->rrn_degree > maxdegree))
+		continue;
+
+	    gkk = 0.0;
+	    for (edge = rnode->rrn_edges; edge != NULL; edge = edge->rre_next)
+		gkk += edge->rre_g;
+	    tau = rnode->rrn_cap / gkk;
+	    if (tau >= maxtau) continue;
+
+	    if (tau > worst) worst = tau;
+	    resRedEliminate(nodes, rnode - nodes, gkk);
+	    eliminated++;
+	}
+    } while (eliminated > 0);
+    HeapKill(&heap, (cb_heap_kill_t)NULL);
+
+    return worst;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * ResReduceNet --
+ *
+ *	Reduce the network in ResNodeList and ResResList by eliminating
+ *	internal nodes whose time constant is less than resisdata->maxtau.
+ *	Nodes with device terminals, ports, drivers and sinks, and named
+ *	nodes are always kept.  Must be called after
+ *	ResDistributeCapacitance(), when the node capacitance is in
+ *	rn_float.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Drops the eliminated nodes and replaces ResResList with the
+ *	resistors of the reduced matrix.  With "extresist stats", prints
+ *	the network size before and after, and the time taken.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+ResReduceNet(resisdata)
+    ResisData	*resisdata;
+{
+    ResRedNode	*nodes, *rnode;
+    ResRedEdge	*edge;
+    resNode	*node, *node1, *node2;
+    resResistor	*res, *lastres;
+    resElement	*rcell;
+    struct timeval start, now;
+    double	maxtau;
+    int		nnodes, nres, newnodes, newres, k;
+
+    if (ResOptionsFlags & ResOpt_Stats)
+	gettimeofday(&start, (struct timezone *)NULL);
+
+    nnodes = 0;
+    for (node = ResNodeList; node != NULL; node = node->rn_more)
+	nnodes++;
+    if (nnodes == 0) return;
+    nres = 0;
+    for (res = ResResList; res != NULL; res = res->rr_nextResistor)
+	nres++;
+
+    /* Number the nodes (rn_id is not assigned until output) */
+
+    nodes = (ResRedNode *)mallocMagic(nnodes * sizeof(ResRedNode));
+    k = 0;
+    for (node = ResNodeList; node != NULL; node = node->rn_more)
+    {
+	rnode = &nodes[k];
+	node->rn_id = k++;
+	rnode->rrn_node = node;
+	rnode->rrn_edges = NULL;
+	rnode->rrn_status = 0;
+	if ((node->rn_te != NULL) || (node->rn_name != NULL) ||
+		(node->rn_why & (RES_NODE_ORIGIN | RES_NODE_SINK)) ||
+		(node == ResNodeAtOrigin))
+	    rnode->rrn_status |= RRN_KEEP;
+    }
+
+    /* On a mesh, eliminating all of the internal nodes goes through a
+     * matrix denser than the network before it arrives at a small one.
+     * If it arrives at one with more resistors than the network had,
+     * start over and eliminate only the nodes that add no resistors.
+     */
+
+    resRedLoad(nodes, nnodes);
+    maxtau = resRedReduce(nodes, nnodes, (double)resisdata->maxtau,
+		RES_REDUCE_MAXDEGREE);
+    if (resRedEdgeCount > nres)
+    {
+	resRedLoad(nodes, nnodes);
+	maxtau = resRedReduce(nodes, nnodes, (double)resisdata->maxtau, 0);
+    }
+
+    /* Replace the network with what is left of the matrix */
+
+    ResResList = NULL;
+    newnodes = newres = 0;
+    lastres = NULL;
+    for (k = 0; k < nnodes; k++)
+    {
+	rnode = &nodes[k];
+	node1 = rnode->rrn_node;
+	node1->rn_re = NULL;
+	if (rnode->rrn_status & RRN_GONE)
+	{
+	    ResCleanNode(node1, TRUE, &ResNodeList, &ResNodeQueue);
+	    continue;
+	}
+	newnodes++;
+	node1->rn_float.rn_area = (float)rnode->rrn_cap;
+	node1->rn_id = 0;
+    }
+
+    for (k = 0; k < nnodes; k++)
+    {
+	rnode = &nodes[k];
+	if (rnode->rrn_status & RRN_GONE) continue;
+	node1 = rnode->rrn_node;
+
+	for (edge = rnode->rrn_edges; edge != NULL; edge = edge->rre_next)
+	{
+	    if (edge->rre_node < k) continue;
+	    node2 = nodes[edge->rre_node].rrn_node;
+
+	    res = (resResistor *)ResArenaAlloc(sizeof(resResistor));
+	    res->rr_value = (float)(1.0 / edge->rre_g);
+	    res->rr_status = 0;
+	    res->rr_float.rr_area = 0.0;
+	    res->rr_cl = 0;
+	    res->rr_width = 0;
+	    res->rr_tt = edge->rre_type;
+
+	    /* Point the resistor away from the driver */
+	    if (node2->rn_noderes < node1->rn_noderes)
+	    {
+		res->rr_connection1 = node2;
+		res->rr_connection2 = node1;
+	    }
+	    else
+	    {
+		res->rr_connection1 = node1;
+		res->rr_connection2 = node2;
+	    }
+
+	    res->rr_nextResistor = NULL;
+	    res->rr_lastResistor = lastres;
+	    if (lastres == NULL)
+		ResResList = res;
+	    else
+		lastres->rr_nextResistor = res;
+	    lastres = res;
+
+	    rcell = (resElement *)ResArenaAlloc(sizeof(resElement));
+	    rcell->re_thisEl = res;
+	    rcell->re_nextEl = node1->rn_re;
+	    node1->rn_re = rcell;
+	    rcell = (resElement *)ResArenaAlloc(sizeof(resElement));
+	    rcell->re_thisEl = res;
+	    rcell->re_nextEl = node2->rn_re;
+	    node2->rn_re = rcell;
+	    newres++;
+	}
+    }
+
+    resRedFreeList = NULL;
+    freeMagic((char *)nodes);
+
+    if (ResOptionsFlags & ResOpt_Stats)
+    {
+	gettimeofday(&now, (struct timezone *)NULL);
+	TxPrintf("%s: reduced %d nodes %d resistors to %d nodes %d resistors"
+		" (max tau %.3gps) in %.3f ms\n",
+		(ResCurrentNode != NULL) ? ResCurrentNode : "(net)",
+		nnodes, nres, newnodes, newres, maxtau * Z_TO_P,
+		(double)(now.tv_sec - start.tv_sec) * 1000.0 +
+		(double)(now.tv_usec - start.tv_usec) / 1000.0);
+    }
+}
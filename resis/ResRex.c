@@ -10,6 +10,7 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #include <ctype.h>
 #include <math.h>
 #include <float.h>
+#include <sys/time.h>
 
 #include "tcltk/tclmagic.h"
 #include "utils/magic.h"
@@ -31,18 +32,12 @@ static char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magic-8.0/
 #include "utils/tech.h"
 #include "textio/txcommands.h"
 #include "commands/commands.h"
+#include "utils/workers.h"
 #include "resis/resis.h"
 
 #define INITFLATSIZE		1024
 #define MAXNAME			1000
 
-/* Time constants are produced by multiplying attofarads by milliohms,  */
-/* giving zeptoseconds (yes, really.  Look it up).  This constant 	*/
-/* converts zeptoseconds to picoseconds.				*/
-
-#define Z_TO_P		1e-9
-#define P_TO_Z		1e9
-
 /* Table of nodes to ignore (manually specified) */
 HashTable 	ResIgnoreTable;	    /* Hash table of nodes to ignore  */
 
@@ -72,6 +67,30 @@ FILE	*ResFHFile;
 
 int	ResPortIndex;	/* Port ordering to backannotate into magic */
 
+int	ResJobs = 1;	/* Number of processes extracting nets at once */
+
+/* Per-net timing records kept for "extresist timing" */
+
+typedef struct resnettime
+{
+    char	*rnt_name;	/* Net name (owned by ResNodeTable) */
+    int		rnt_devices;	/* Number of device terminals on the net */
+    int		rnt_nodes;	/* Number of resistor network nodes */
+    int		rnt_resistors;	/* Number of resistors after simplify */
+    double	rnt_extract;	/* Milliseconds in ResExtractNet */
+    double	rnt_simplify;	/* Milliseconds in ResDoSimplify */
+    double	rnt_output;	/* Milliseconds writing .res.ext/.res.lump */
+    size_t	rnt_memory;	/* Bytes of network (arena high-water) */
+} ResNetTime;
+
+FILE		*ResTimeFile;		/* Per-net timing log (.res.time) */
+ResNetTime	*ResNetTimes = NULL;	/* Timing records for this cell */
+int		ResNetTimeCount = 0;	/* Number of records in use */
+int		ResNetTimeMax = 0;	/* Number of records allocated */
+
+/* Number of slowest nets to summarize after a timed run */
+#define RES_TIME_REPORT	10
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -224,6 +243,7 @@ ResInit()
 	resisdata->minres = 1000.0;
 	resisdata->mindelay = 1.0e9;	/* 1ps = 1.0e9zs
 	resisdata->frequency = 10e6;	/* 10 MHz default */
+	resisdata->maxtau = 1.0e8;	/* 0.1ps:  see "extresist reduce" */
 
 	HashInit(&ResIgnoreTable, INITFLATSIZE, HT_STRINGKEYS);
 	HashInit(&ResForceTable, INITFLATSIZE, HT_STRINGKEYS);
@@ -307,6 +327,9 @@ CmdExtResis(win, cmd)
 	"fasthenry [freq]     extract subcircuit network geometry into .fh file",
 	"geometry	      extract network centerline geometry (experimental)",
 	"stats		      print extresist statistics",
+	"timing   [on/off]    turn on/off logging of per-net extraction times",
+	"reduce   [on/off/tau] simplify by node elimination, up to tau (ps)",
+	"jobs     [n]         extract nets in up to n processes at once",
 	"help                 print this message",
 	NULL
     };
@@ -317,7 +340,7 @@ typedef enum {
 	RES_SIMP, RES_EXTOUT, RES_LUMPED, RES_SILENT, RES_DEBUG,
 	RES_SKIP, RES_FORCE, RES_IGNORE, RES_INCLUDE, RES_BOX,
 	RES_CELL, RES_BLACKBOX, RES_FASTHENRY, RES_GEOMETRY,
-	RES_STATS, RES_HELP, RES_RUN
+	RES_STATS, RES_TIMING, RES_REDUCE, RES_JOBS, RES_HELP, RES_RUN
 } ResOptions;
 
     resisdata = ResInit();
@@ -332,6 +355,7 @@ typedef enum {
 	case RES_LUMPED:
 	case RES_SILENT:
 	case RES_BLACKBOX:
+	case RES_TIMING:
 	    if (cmd->tx_argc > 2)
 	    {
 		value = Lookup(cmd->tx_argv[2], onOff);
@@ -479,6 +503,74 @@ typedef enum {
 	      	   ResOptionsFlags &= ~ResOpt_Stats;
 	    }
 	    return;
+	case RES_TIMING:
+	    if (cmd->tx_argc == 2)
+	    {
+		value = (ResOptionsFlags & ResOpt_Timing) ?
+			TRUE : FALSE;
+		TxPrintf("%s\n", onOff[value]);
+	    }
+	    else
+	    {
+		value = Lookup(cmd->tx_argv[2], onOff);
+		if (value)
+	      	   ResOptionsFlags |= ResOpt_Timing;
+		else
+	      	   ResOptionsFlags &= ~ResOpt_Timing;
+	    }
+	    return;
+	case RES_REDUCE:
+	    if (cmd->tx_argc == 2)
+	    {
+		value = (ResOptionsFlags & ResOpt_Reduce) ?
+			TRUE : FALSE;
+		TxPrintf("%s (tolerance %g ps)\n", onOff[value],
+			resisdata->maxtau * Z_TO_P);
+	    }
+	    else
+	    {
+		value = Lookup(cmd->tx_argv[2], onOff);
+		if (value < 0)
+		{
+		    /* A time constant tolerance implies "on" */
+		    double tmpf = strtod(cmd->tx_argv[2], &endptr);
+		    if ((endptr == cmd->tx_argv[2]) || (tmpf < 0))
+		    {
+			TxError("Usage:  %s reduce [on|off|tolerance]\n",
+				cmd->tx_argv[0]);
+			return;
+		    }
+		    resisdata->maxtau = (float)tmpf * P_TO_Z;
+		    value = TRUE;
+		}
+		if (value)
+	      	   ResOptionsFlags |= ResOpt_Reduce;
+		else
+	      	   ResOptionsFlags &= ~ResOpt_Reduce;
+	    }
+	    return;
+	case RES_JOBS:
+	    if (cmd->tx_argc == 2)
+	    {
+#ifdef MAGIC_WRAPPER
+		Tcl_SetObjResult(magicinterp, Tcl_NewIntObj(ResJobs));
+#else
+		TxPrintf("%d\n", ResJobs);
+#endif
+	    }
+	    else
+	    {
+		value = (int)strtol(cmd->tx_argv[2], &endptr, 0);
+		if ((endptr == cmd->tx_argv[2]) || (*endptr != '\0') ||
+			(value < 0))
+		{
+		    TxError("Usage:  %s jobs [n]\n", cmd->tx_argv[0]);
+		    return;
+		}
+		/* Zero means one process per processor */
+		ResJobs = value;
+	    }
+	    return;
 
 	case RES_SIMP:
 	    /* Enable or disable resistor network simplification.  Usually
@@ -1045,6 +1137,181 @@ ResCheckPorts(cellDef)
     return result;
 }
 
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resTimeStep --
+ *
+ *	Return the wall-clock time elapsed since *tv, and reset *tv to
+ *	the current time so that consecutive calls time consecutive steps.
+ *
+ * Results:
+ *	Elapsed time in milliseconds.
+ *
+ * Side effects:
+ *	Updates *tv.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+double
+resTimeStep(tv)
+    struct timeval *tv;
+{
+    struct timeval now;
+    double ms;
+
+    gettimeofday(&now, (struct timezone *)NULL);
+    ms = (double)(now.tv_sec - tv->tv_sec) * 1000.0
+		+ (double)(now.tv_usec - tv->tv_usec) / 1000.0;
+    *tv = now;
+    return ms;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resRecordNetTime --
+ *
+ *	Record the time spent extracting one net, along with the size
+ *	of its device list and resistor network and the memory taken
+ *	by the network, and write it to the
+ *	.res.time log.  Must be called before ResCleanUpEverything()
+ *	while the network for the net is still in place.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Appends a record to ResNetTimes and a line to ResTimeFile.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resRecordNetTime(node, extractTime, simplifyTime, outputTime)
+    ResExtNode	*node;
+    double	extractTime, simplifyTime, outputTime;
+{
+    ResNetTime	*rnt;
+    resNode	*rn;
+    resResistor	*rr;
+    devPtr	*dp;
+
+    if (ResNetTimeCount == ResNetTimeMax)
+    {
+	ResNetTime *newTimes;
+
+	ResNetTimeMax = (ResNetTimeMax == 0) ? 256 : ResNetTimeMax * 2;
+	newTimes = (ResNetTime *)mallocMagic(ResNetTimeMax * sizeof(ResNetTime));
+	if (ResNetTimeCount > 0)
+	{
+	    memcpy(newTimes, ResNetTimes, ResNetTimeCount * sizeof(ResNetTime));
+	    freeMagic((char *)ResNetTimes);
+	}
+	ResNetTimes = newTimes;
+    }
+    rnt = &ResNetTimes[ResNetTimeCount++];
+
+    rnt->rnt_name = node->name;
+    rnt->rnt_devices = rnt->rnt_nodes = rnt->rnt_resistors = 0;
+    for (dp = node->devices; dp != NULL; dp = dp->nextDev)
+	rnt->rnt_devices++;
+    for (rn = ResNodeList; rn != NULL; rn = rn->rn_more)
+	rnt->rnt_nodes++;
+    for (rr = ResResList; rr != NULL; rr = rr->rr_nextResistor)
+	rnt->rnt_resistors++;
+    rnt->rnt_extract = extractTime;
+    rnt->rnt_simplify = simplifyTime;
+    rnt->rnt_output = outputTime;
+    rnt->rnt_memory = ResArenaUsed();
+
+    if (ResTimeFile != NULL)
+	fprintf(ResTimeFile, "%s %d %d %d %.3f %.3f %.3f %.3f %lu\n",
+		rnt->rnt_name, rnt->rnt_devices, rnt->rnt_nodes,
+		rnt->rnt_resistors, extractTime, simplifyTime, outputTime,
+		extractTime + simplifyTime + outputTime,
+		(unsigned long)(rnt->rnt_memory + 1023) / 1024);
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resNetTimeCompare --
+ *
+ *	qsort() comparison function ordering ResNetTime records by
+ *	decreasing total time.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+resNetTimeCompare(a, b)
+    const void *a, *b;
+{
+    const ResNetTime *ra = (const ResNetTime *)a;
+    const ResNetTime *rb = (const ResNetTime *)b;
+    double ta, tb;
+
+    ta = ra->rnt_extract + ra->rnt_simplify + ra->rnt_output;
+    tb = rb->rnt_extract + rb->rnt_simplify + rb->rnt_output;
+    if (ta > tb) return -1;
+    if (ta < tb) return 1;
+    return 0;
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resReportNetTimes --
+ *
+ *	Print the slowest nets recorded by resRecordNetTime() for the
+ *	current cell, then discard the records.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Output to the terminal; frees ResNetTimes.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resReportNetTimes(celldef)
+    CellDef *celldef;
+{
+    ResNetTime *rnt;
+    double total = 0.0;
+    int i;
+
+    if (ResNetTimeCount == 0) return;
+
+    for (i = 0; i < ResNetTimeCount; i++)
+    {
+	rnt = &ResNetTimes[i];
+	total += rnt->rnt_extract + rnt->rnt_simplify + rnt->rnt_output;
+    }
+    qsort(ResNetTimes, ResNetTimeCount, sizeof(ResNetTime), resNetTimeCompare);
+
+    TxPrintf("Extraction time for %d nets in %s: %.1f ms\n",
+		ResNetTimeCount, celldef->cd_name, total);
+    TxPrintf("%-24s %6s %6s %6s %10s %10s %10s %8s\n", "Slowest nets", "devs",
+		"nodes", "res", "extract", "simplify", "output", "kbytes");
+    for (i = 0; i < ResNetTimeCount && i < RES_TIME_REPORT; i++)
+    {
+	rnt = &ResNetTimes[i];
+	TxPrintf("%-24s %6d %6d %6d %10.3f %10.3f %10.3f %8lu\n",
+		rnt->rnt_name, rnt->rnt_devices, rnt->rnt_nodes,
+		rnt->rnt_resistors, rnt->rnt_extract, rnt->rnt_simplify,
+		rnt->rnt_output, (unsigned long)(rnt->rnt_memory + 1023) / 1024);
+    }
+
+    freeMagic((char *)ResNetTimes);
+    ResNetTimes = NULL;
+    ResNetTimeCount = ResNetTimeMax = 0;
+}
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -1075,7 +1342,7 @@ ResProcessNode(
     devPtr	*ptr;
     int		totWL, maxWL = 0;
     int		nidx = 1, eidx = 1;	/* node & segment counters for geom. */
-    bool	processThis;
+    bool	processThis, result;
 
     /* Ignore or include specified nodes */
 
@@ -1153,9 +1420,11 @@ ResProcessNode(
 	    {
 		t1 = ptr->thisDev;
 		t2 = ptr->nextDev->thisDev;
-		if (t1->gate != t2->gate) break;
-		if ((t1->source != t2->source || t1->drain != t2->drain) &&
-			(t1->source != t2->drain || t1->drain != t2->source))
+		if (t1->rs_gate != t2->rs_gate) break;
+		if ((t1->rs_source != t2->rs_source ||
+			t1->rs_drain != t2->rs_drain) &&
+			(t1->rs_source != t2->rs_drain ||
+			t1->rs_drain != t2->rs_source))
 		    break;
 
 		/* Sum the W/L value of devices in parallel */
@@ -1256,6 +1525,11 @@ ResProcessNode(
     if (processThis)
     {
 	ResFixPoint fp;
+	struct timeval tv;
+	double extractTime = 0.0, simplifyTime = 0.0, outputTime = 0.0;
+
+	if (ResOptionsFlags & ResOpt_Timing)
+	    gettimeofday(&tv, (struct timezone *)NULL);
 
 	/* Diagnostic */
 	if (!(ResOptionsFlags & ResOpt_RunSilent))
@@ -1269,7 +1543,10 @@ ResProcessNode(
 	}
 
 	(*num_extracted)++;
-	if (ResExtractNet(node, resisdata, outfile) != 0)
+	result = ResExtractNet(node, resisdata, outfile);
+	if (ResOptionsFlags & ResOpt_Timing)
+	    extractTime = resTimeStep(&tv);
+	if (result != 0)
 	{
 	    /* On error, don't output this net, but keep going */
 	    if (node->type == TT_SPACE)
@@ -1281,21 +1558,615 @@ ResProcessNode(
 	else
 	{
 	    ResDoSimplify(resisdata);
+	    if (ResOptionsFlags & ResOpt_Timing)
+		simplifyTime = resTimeStep(&tv);
 	    if (ResOptionsFlags & ResOpt_DoLumpFile)
 		ResWriteLumpFile(node, resisdata);
 
 	    resNodeNum = 0;
 	    (*num_output) += ResWriteExtFile(celldef, node, resisdata,
 				&nidx, &eidx);
+	    if (ResOptionsFlags & ResOpt_Timing)
+		outputTime = resTimeStep(&tv);
 	}
 #ifdef PARANOID
 	ResSanityChecks(node->name, ResResList, ResNodeList, ResDevList);
 #endif
+	if (ResOptionsFlags & ResOpt_Timing)
+	    resRecordNetTime(node, extractTime, simplifyTime, outputTime);
 	ResCleanUpEverything();
     }
     return 1;
 }
 
+/* A range of nets extracted by a child process under "extresist jobs" */
+
+typedef struct resnetjob
+{
+    int		 rj_first;	/* First net of the range */
+    int		 rj_last;	/* One past the last net */
+    FILE	*rj_ext;	/* .res.ext output of the job */
+    FILE	*rj_lump;	/* .res.lump output of the job */
+    FILE	*rj_time;	/* .res.time output of the job */
+    FILE	*rj_out;	/* TxPrintf() output from the job */
+    FILE	*rj_err;	/* TxError() output from the job */
+    FILE	*rj_result;	/* Counts, timing and device records */
+    int		 rj_pid;	/* Process running the job, or 0 */
+} ResNetJob;
+
+/* Device changes passed back from a job (see resJobWriteDevices()).
+ * Only the fields of the layout record that ResPrintExtDev() writes
+ * are passed, as the rest point into the job's own memory.
+ */
+
+typedef struct resjobdev
+{
+    int		 rjd_index;	/* Position of the device in ResRDevList */
+    int		 rjd_terms;	/* Terminals renamed, by RT_* bit */
+    int		 rjd_perim;	/* rd_perim of the layout record */
+    int		 rjd_area;	/* rd_area */
+    int		 rjd_length;	/* rd_length */
+    int		 rjd_width;	/* rd_width */
+    int		 rjd_tiles;	/* rd_tiles */
+    int		 rjd_devtype;	/* rd_devtype */
+    Rect	 rjd_inside;	/* rd_inside */
+} ResJobDev;
+
+/* Timing record passed back from a job, followed by the net name */
+
+typedef struct resjobtime
+{
+    int		rjt_namelen;	/* Length of the net name that follows */
+    int		rjt_devices;	/* See ResNetTime */
+    int		rjt_nodes;
+    int		rjt_resistors;
+    double	rjt_extract;
+    double	rjt_simplify;
+    double	rjt_output;
+    size_t	rjt_memory;
+} ResJobTime;
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resJobCopy --
+ *
+ *	Append the contents of a job's temporary file to 'f', or to the
+ *	terminal if 'f' is NULL, and close the temporary file.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Output.  Closes 'tmpf'.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resJobCopy(tmpf, f, err)
+    FILE *tmpf;		/* Temporary file written by the job */
+    FILE *f;		/* Output file, or NULL for the terminal */
+    bool err;		/* If f is NULL, print with TxError() */
+{
+    char buf[8192];
+    size_t n;
+
+    if (tmpf == NULL) return;
+    rewind(tmpf);
+    while ((n = fread(buf, 1, sizeof buf - 1, tmpf)) > 0)
+    {
+	if (f != NULL)
+	    fwrite(buf, 1, n, f);
+	else
+	{
+	    buf[n] = '\0';
+	    if (err)
+		TxError("%s", buf);
+	    else
+		TxPrintf("%s", buf);
+	}
+    }
+    fclose(tmpf);
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resJobWriteTimes --
+ *
+ *	Called in a child process after its nets are done.  Write the
+ *	timing records of the job to 'f', each with the name of its net.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to 'f'.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resJobWriteTimes(f)
+    FILE	*f;
+{
+    ResNetTime	*rnt;
+    ResJobTime	rjt;
+    int		i;
+
+    for (i = 0; i < ResNetTimeCount; i++)
+    {
+	rnt = &ResNetTimes[i];
+	rjt.rjt_namelen = strlen(rnt->rnt_name);
+	rjt.rjt_devices = rnt->rnt_devices;
+	rjt.rjt_nodes = rnt->rnt_nodes;
+	rjt.rjt_resistors = rnt->rnt_resistors;
+	rjt.rjt_extract = rnt->rnt_extract;
+	rjt.rjt_simplify = rnt->rnt_simplify;
+	rjt.rjt_output = rnt->rnt_output;
+	rjt.rjt_memory = rnt->rnt_memory;
+	fwrite(&rjt, sizeof rjt, 1, f);
+	fwrite(rnt->rnt_name, 1, rjt.rjt_namelen, f);
+    }
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resJobReadTimes --
+ *
+ *	Add the 'count' timing records written by resJobWriteTimes() to
+ *	ResNetTimes.  Each net name is looked up in ResNodeTable, which
+ *	holds every net the job could have extracted.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Reads from 'f'; may reallocate ResNetTimes.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resJobReadTimes(f, count)
+    FILE	*f;
+    int		count;
+{
+    ResNetTime	*rnt;
+    ResJobTime	rjt;
+    HashEntry	*he;
+    char	name[MAXNAME + 1];
+    int		i;
+
+    for (i = 0; i < count; i++)
+    {
+	if ((fread(&rjt, sizeof rjt, 1, f) != 1) || (rjt.rjt_namelen < 0) ||
+		(rjt.rjt_namelen > MAXNAME) ||
+		(fread(name, 1, rjt.rjt_namelen, f) != rjt.rjt_namelen))
+	    break;
+	name[rjt.rjt_namelen] = '\0';
+	he = HashLookOnly(&ResNodeTable, name);
+	if ((he == NULL) || (HashGetValue(he) == NULL)) continue;
+
+	if (ResNetTimeCount == ResNetTimeMax)
+	{
+	    ResNetTime *newTimes;
+
+	    ResNetTimeMax = (ResNetTimeMax == 0) ? 256 : ResNetTimeMax * 2;
+	    newTimes = (ResNetTime *)mallocMagic(ResNetTimeMax *
+			sizeof(ResNetTime));
+	    if (ResNetTimeCount > 0)
+	    {
+		memcpy(newTimes, ResNetTimes, ResNetTimeCount *
+			sizeof(ResNetTime));
+		freeMagic((char *)ResNetTimes);
+	    }
+	    ResNetTimes = newTimes;
+	}
+	rnt = &ResNetTimes[ResNetTimeCount++];
+	rnt->rnt_name = ((ResExtNode *)HashGetValue(he))->name;
+	rnt->rnt_devices = rjt.rjt_devices;
+	rnt->rnt_nodes = rjt.rjt_nodes;
+	rnt->rnt_resistors = rjt.rjt_resistors;
+	rnt->rnt_extract = rjt.rjt_extract;
+	rnt->rnt_simplify = rjt.rjt_simplify;
+	rnt->rnt_output = rjt.rjt_output;
+	rnt->rnt_memory = rjt.rjt_memory;
+    }
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resJobWriteDevices --
+ *
+ *	Called in a child process after its nets are done.  Write a
+ *	record to 'f' for every device that ResFixUpConnections() has
+ *	changed, with the names of its renamed terminals.  The parent
+ *	did not change any device while the job ran, so comparing with
+ *	the terminals saved in 'terms' finds the changes made by the job.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Writes to 'f'.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resJobWriteDevices(f, terms)
+    FILE	*f;
+    ResExtNode	**terms;	/* Original terminals, 4 per device */
+{
+    RDev	*dev;
+    ResExtNode	*now[4];
+    ResJobDev	rjd;
+    int		i, t, len;
+
+    for (dev = ResRDevList, i = 0; dev != NULL; dev = dev->nextDev, i++)
+    {
+	if (!(dev->status & TRUE)) continue;
+
+	now[RT_GATE] = dev->gate;
+	now[RT_SUBS] = dev->subs;
+	now[RT_SOURCE] = dev->source;
+	now[RT_DRAIN] = dev->drain;
+
+	rjd.rjd_index = i;
+	rjd.rjd_terms = 0;
+	for (t = 0; t < 4; t++)
+	    if ((now[t] != terms[4 * i + t]) && (now[t] != NULL))
+		rjd.rjd_terms |= (1 << t);
+	rjd.rjd_perim = dev->layout->rd_perim;
+	rjd.rjd_area = dev->layout->rd_area;
+	rjd.rjd_length = dev->layout->rd_length;
+	rjd.rjd_width = dev->layout->rd_width;
+	rjd.rjd_tiles = dev->layout->rd_tiles;
+	rjd.rjd_devtype = dev->layout->rd_devtype;
+	rjd.rjd_inside = dev->layout->rd_inside;
+	fwrite(&rjd, sizeof rjd, 1, f);
+
+	for (t = 0; t < 4; t++)
+	    if (rjd.rjd_terms & (1 << t))
+	    {
+		len = strlen(now[t]->name);
+		fwrite(&len, sizeof len, 1, f);
+		fwrite(now[t]->name, 1, len, f);
+	    }
+    }
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resJobReadDevices --
+ *
+ *	Apply the device records written by resJobWriteDevices() to the
+ *	devices of this process.  Jobs are read in net order, and a
+ *	device keeps the layout record of the first net that reached it,
+ *	just as when the nets are extracted one after another.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Changes device terminals; may add nodes to ResNodeTable.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resJobReadDevices(f, devs)
+    FILE	*f;
+    RDev	**devs;		/* Devices indexed by position in ResRDevList */
+{
+    RDev	*dev;
+    ResExtNode	*node;
+    ResJobDev	rjd;
+    char	name[MAXNAME + 1];
+    int		t, len;
+
+    while (fread(&rjd, sizeof rjd, 1, f) == 1)
+    {
+	dev = devs[rjd.rjd_index];
+	dev->status |= TRUE;
+	if (dev->layout == NULL)
+	{
+	    dev->layout = (resDevice *)mallocMagic(sizeof(resDevice));
+	    dev->layout->rd_perim = rjd.rjd_perim;
+	    dev->layout->rd_area = rjd.rjd_area;
+	    dev->layout->rd_length = rjd.rjd_length;
+	    dev->layout->rd_width = rjd.rjd_width;
+	    dev->layout->rd_tiles = rjd.rjd_tiles;
+	    dev->layout->rd_devtype = rjd.rjd_devtype;
+	    dev->layout->rd_inside = rjd.rjd_inside;
+	    dev->layout->rd_status = RES_DEV_SAVE;
+	    dev->layout->rd_nextDev = NULL;
+	    dev->layout->rd_terminals = NULL;
+	    dev->layout->rd_nterms = 0;
+	    dev->layout->rd_tile = NULL;
+	}
+	for (t = 0; t < 4; t++)
+	{
+	    if (!(rjd.rjd_terms & (1 << t))) continue;
+	    if ((fread(&len, sizeof len, 1, f) != 1) || (len < 0) ||
+			(len > MAXNAME) || (fread(name, 1, len, f) != len))
+		return;
+	    name[len] = '\0';
+	    node = ResExtInitNode(HashFind(&ResNodeTable, name));
+	    switch (t)
+	    {
+		case RT_GATE:   dev->gate = node;   break;
+		case RT_SUBS:   dev->subs = node;   break;
+		case RT_SOURCE: dev->source = node; break;
+		case RT_DRAIN:  dev->drain = node;  break;
+	    }
+	}
+    }
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resJobFinish --
+ *
+ *	Wait for the process running 'job', if any, then copy its output
+ *	to the output files and the terminal and add its counts and
+ *	timing records to the totals.  Jobs are finished in order, so
+ *	the output is the same as extracting the nets in this process.
+ *	The device records are left in rj_result for resJobReadDevices().
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Output.  Closes all of the job's temporary files but rj_result.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+void
+resJobFinish(job, num_total, num_extracted, num_output)
+    ResNetJob	*job;
+    int		*num_total, *num_extracted, *num_output;
+{
+    int		counts[4], status;
+
+    if (job->rj_pid > 0)
+    {
+	if ((WaitPid(job->rj_pid, &status) < 0) || (status != 0))
+	    TxError("Error extracting nets %d to %d in a child process.\n",
+			job->rj_first + 1, job->rj_last);
+	job->rj_pid = 0;
+    }
+
+    resJobCopy(job->rj_ext, ResExtFile, FALSE);
+    resJobCopy(job->rj_lump, ResLumpFile, FALSE);
+    resJobCopy(job->rj_time, ResTimeFile, FALSE);
+    resJobCopy(job->rj_out, (FILE *)NULL, FALSE);
+    resJobCopy(job->rj_err, (FILE *)NULL, TRUE);
+
+    rewind(job->rj_result);
+    if (fread(counts, sizeof(int), 4, job->rj_result) != 4)
+    {
+	/* The job did not finish; skip its device records */
+	fseek(job->rj_result, 0L, SEEK_END);
+	return;
+    }
+    *num_total += counts[0];
+    *num_extracted += counts[1];
+    *num_output += counts[2];
+
+    resJobReadTimes(job->rj_result, counts[3]);
+}
+
+/*
+ *-------------------------------------------------------------------------
+ *
+ * resProcessAllNodes --
+ *
+ *	Run ResProcessNode() on every net of the cell.  With "extresist
+ *	jobs" set to more than one, the nets are split into consecutive
+ *	ranges that are extracted by child processes.  Each child has its
+ *	own copy of the layout, of the yank cell, and of the resistor
+ *	network lists, none of which could be shared by threads.  The
+ *	output of each range is collected in net order, and the device
+ *	terminals renamed by each range are applied to this process once
+ *	all ranges are done, so that every range starts from the devices
+ *	as they were read from the .ext file.
+ *
+ *	FastHenry output, centerline geometry, and statistics keep state
+ *	from one net to the next, so they are always done in one process.
+ *
+ * Results:
+ *	Number of nets processed.
+ *
+ * Side effects:
+ *	See ResProcessNode().
+ *
+ *-------------------------------------------------------------------------
+ */
+
+int
+resProcessAllNodes(celldef, resisdata, outfile, num_extracted, num_output)
+    CellDef	*celldef;
+    ResisData	*resisdata;
+    char	*outfile;
+    int		*num_extracted, *num_output;
+{
+    ResExtNode	*node, **nets, **terms;
+    ResNetJob	*jobs, *job;
+    RDev	*dev, **devs;
+    int		nnets, ndevs, nproc, njobs, running, next;
+    int		total = 0, counts[4], i, g, pid;
+
+    nnets = 0;
+    for (node = ResOriginalNodes; node != NULL; node = node->nextnode)
+	nnets++;
+
+    nproc = WorkerCount(ResJobs);
+    if ((nproc <= 1) || (nnets < 2) || (ResOptionsFlags &
+		(ResOpt_FastHenry | ResOpt_Geometry | ResOpt_Stats)))
+    {
+	for (node = ResOriginalNodes; node != NULL; node = node->nextnode)
+	{
+	    if (SigInterruptPending) break;
+	    total += ResProcessNode(node, celldef, resisdata, outfile,
+			num_extracted, num_output);
+	}
+	return total;
+    }
+
+    /* New nodes are added to the front of the list, so take the	*/
+    /* nets in list order now, as the serial loop would see them.	*/
+
+    nets = (ResExtNode **)mallocMagic(nnets * sizeof(ResExtNode *));
+    for (node = ResOriginalNodes, i = 0; node != NULL; node = node->nextnode)
+	nets[i++] = node;
+
+    ndevs = 0;
+    for (dev = ResRDevList; dev != NULL; dev = dev->nextDev)
+	ndevs++;
+    devs = (RDev **)mallocMagic((ndevs + 1) * sizeof(RDev *));
+    terms = (ResExtNode **)mallocMagic((4 * ndevs + 1) * sizeof(ResExtNode *));
+    for (dev = ResRDevList, i = 0; dev != NULL; dev = dev->nextDev, i++)
+    {
+	devs[i] = dev;
+	terms[4 * i + RT_GATE] = dev->gate;
+	terms[4 * i + RT_SUBS] = dev->subs;
+	terms[4 * i + RT_SOURCE] = dev->source;
+	terms[4 * i + RT_DRAIN] = dev->drain;
+    }
+
+    /* Several ranges per process keep the processes evenly loaded */
+    njobs = MIN(nnets, nproc * 4);
+    jobs = (ResNetJob *)mallocMagic(njobs * sizeof(ResNetJob));
+    for (i = 0; i < njobs; i++)
+    {
+	job = &jobs[i];
+	job->rj_first = (int)(((dlong)nnets * i) / njobs);
+	job->rj_last = (int)(((dlong)nnets * (i + 1)) / njobs);
+	job->rj_ext = job->rj_lump = job->rj_time = NULL;
+	job->rj_out = job->rj_err = NULL;
+	job->rj_pid = 0;
+	job->rj_result = tmpfile();
+    }
+
+    running = 0;
+    next = 0;
+    for (i = 0; i < njobs; i++)
+    {
+	job = &jobs[i];
+	while (running >= nproc)
+	{
+	    if (jobs[next].rj_pid > 0) running--;
+	    resJobFinish(&jobs[next++], &total, num_extracted, num_output);
+	}
+
+	/* Only the jobs in progress keep their output files open */
+	pid = -1;
+	if (job->rj_result != NULL)
+	{
+	    job->rj_out = tmpfile();
+	    job->rj_err = tmpfile();
+	    if (ResExtFile != NULL) job->rj_ext = tmpfile();
+	    if (ResLumpFile != NULL) job->rj_lump = tmpfile();
+	    if (ResTimeFile != NULL) job->rj_time = tmpfile();
+
+	    if ((job->rj_out != NULL) && (job->rj_err != NULL) &&
+			((ResExtFile == NULL) || (job->rj_ext != NULL)) &&
+			((ResLumpFile == NULL) || (job->rj_lump != NULL)) &&
+			((ResTimeFile == NULL) || (job->rj_time != NULL)))
+	    {
+		TxFlush();
+		if (ResExtFile != NULL) fflush(ResExtFile);
+		if (ResLumpFile != NULL) fflush(ResLumpFile);
+		if (ResTimeFile != NULL) fflush(ResTimeFile);
+		FORK_f(pid);
+	    }
+	}
+
+	if (pid == 0)
+	{
+	    TxDivert(job->rj_out, job->rj_err);
+	    ResExtFile = job->rj_ext;
+	    ResLumpFile = job->rj_lump;
+	    ResTimeFile = job->rj_time;
+	    ResNetTimeCount = 0;
+
+	    counts[0] = counts[1] = counts[2] = 0;
+	    for (g = job->rj_first; g < job->rj_last; g++)
+	    {
+		if (SigInterruptPending) break;
+		counts[0] += ResProcessNode(nets[g], celldef, resisdata,
+			outfile, &counts[1], &counts[2]);
+	    }
+	    counts[3] = ResNetTimeCount;
+	    fwrite(counts, sizeof(int), 4, job->rj_result);
+	    resJobWriteTimes(job->rj_result);
+	    resJobWriteDevices(job->rj_result, terms);
+
+	    fflush(job->rj_result);
+	    fflush(job->rj_out);
+	    fflush(job->rj_err);
+	    if (job->rj_ext != NULL) fflush(job->rj_ext);
+	    if (job->rj_lump != NULL) fflush(job->rj_lump);
+	    if (job->rj_time != NULL) fflush(job->rj_time);
+	    _exit(0);
+	}
+	else if (pid < 0)
+	{
+	    /* Could not fork:  finish the earlier jobs, then do this one */
+	    if (job->rj_out != NULL) fclose(job->rj_out);
+	    if (job->rj_err != NULL) fclose(job->rj_err);
+	    if (job->rj_ext != NULL) fclose(job->rj_ext);
+	    if (job->rj_lump != NULL) fclose(job->rj_lump);
+	    if (job->rj_time != NULL) fclose(job->rj_time);
+	    job->rj_out = job->rj_err = NULL;
+	    job->rj_ext = job->rj_lump = job->rj_time = NULL;
+
+	    for (; next < i; next++)
+		resJobFinish(&jobs[next], &total, num_extracted, num_output);
+	    running = 0;
+	    for (g = job->rj_first; g < job->rj_last; g++)
+	    {
+		if (SigInterruptPending) break;
+		total += ResProcessNode(nets[g], celldef, resisdata, outfile,
+			num_extracted, num_output);
+	    }
+	    if (job->rj_result != NULL) fclose(job->rj_result);
+	    job->rj_result = NULL;
+	    next = i + 1;
+	}
+	else
+	{
+	    job->rj_pid = pid;
+	    running++;
+	}
+    }
+    while (next < njobs)
+	resJobFinish(&jobs[next++], &total, num_extracted, num_output);
+
+    /* Now that no job is running, apply the device changes in order */
+    for (i = 0; i < njobs; i++)
+    {
+	job = &jobs[i];
+	if (job->rj_result == NULL) continue;
+	resJobReadDevices(job->rj_result, devs);
+	fclose(job->rj_result);
+    }
+
+    freeMagic((char *)jobs);
+    freeMagic((char *)terms);
+    freeMagic((char *)devs);
+    freeMagic((char *)nets);
+    return total;
+}
+
 /*
  *-------------------------------------------------------------------------
  *
@@ -1347,6 +2218,16 @@ ResCheckExtNodes(celldef, resisdata)
     else
      	ResLumpFile = NULL;
 
+    if (ResOptionsFlags & ResOpt_Timing)
+    {
+        ResTimeFile = PaOpen(outfile, "w", ".res.time", ".", (char *)NULL, (char **)NULL);
+	if (ResTimeFile != NULL)
+	    fprintf(ResTimeFile, "# net devices nodes resistors "
+			"extract simplify output total (ms) memory (kB)\n");
+    }
+    else
+     	ResTimeFile = NULL;
+
     if (ResOptionsFlags & ResOpt_FastHenry)
     {
 	char *geofilename;
@@ -1359,6 +2240,7 @@ ResCheckExtNodes(celldef, resisdata)
 
     if ((ResExtFile == NULL && (ResOptionsFlags & ResOpt_DoExtFile))
          || ((ResOptionsFlags & ResOpt_DoLumpFile) && ResLumpFile == NULL)
+         || ((ResOptionsFlags & ResOpt_Timing) && ResTimeFile == NULL)
          || ((ResOptionsFlags & ResOpt_FastHenry) && ResFHFile == NULL))
     {
      	TxError("Couldn't open output file\n");
@@ -1383,12 +2265,7 @@ ResCheckExtNodes(celldef, resisdata)
     if (ResOptionsFlags & ResOpt_FastHenry)
 	ResPrintReference(ResFHFile, ResRDevList, celldef);
 
-    for (node = ResOriginalNodes; node != NULL; node = node->nextnode)
-    {
-	if (SigInterruptPending) break;
-	total += ResProcessNode(node, celldef, resisdata, outfile,
-			&numext, &numout);
-    }
+    total = resProcessAllNodes(celldef, resisdata, outfile, &numext, &numout);
 
     /*
      * Print out all device which have had at least one terminal changed
@@ -1441,6 +2318,12 @@ ResCheckExtNodes(celldef, resisdata)
     if (ResExtFile != NULL) (void) fclose(ResExtFile);
     if (ResLumpFile != NULL) (void) fclose(ResLumpFile);
     if (ResFHFile != NULL) (void) fclose(ResFHFile);
+    if (ResTimeFile != NULL) (void) fclose(ResTimeFile);
+
+    ResFreeCellUse();
+
+    if (ResOptionsFlags & ResOpt_Timing)
+	resReportNetTimes(celldef);
 }
 
 /*
@@ -1871,7 +2754,10 @@ ResFixDevName(line, type, device, layoutnode)
  *
  * Returns:
  *	1 or -1 depending on comparison result.  The devices are sorted
- *	by gate first, then source or drain.
+ *	by gate first, then source or drain.  The terminals compared are
+ *	those read from the .ext file, in the order the nodes were made,
+ *	so that the order does not depend on which nets have already been
+ *	processed or on where the nodes are in memory.
  *
  * Side effects:
  *	qsort() reorders the indexed list of which dev1 and dev2 are
@@ -1880,6 +2766,9 @@ ResFixDevName(line, type, device, layoutnode)
  *-------------------------------------------------------------------------
  */
 
+/* Devices may be missing a source or drain */
+#define RES_NODE_NUMBER(n)	(((n) == NULL) ? -1 : (n)->number)
+
 int
 devSortFunc(rec1, rec2)
     devPtr **rec1, **rec2;
@@ -1893,37 +2782,37 @@ devSortFunc(rec1, rec2)
 	return 1;
     else if (dev2->terminal == GATE)
 	return -1;
-    else if (rd1->gate > rd2->gate)
+    else if (RES_NODE_NUMBER(rd1->rs_gate) > RES_NODE_NUMBER(rd2->rs_gate))
     	return 1;
-    else if (rd1->gate == rd2->gate)
+    else if (RES_NODE_NUMBER(rd1->rs_gate) == RES_NODE_NUMBER(rd2->rs_gate))
     {
 	if ((dev1->terminal == SOURCE &&
 		dev2->terminal == SOURCE &&
-		rd1->drain > rd2->drain)    ||
+		RES_NODE_NUMBER(rd1->rs_drain) > RES_NODE_NUMBER(rd2->rs_drain)) ||
 		(dev1->terminal == SOURCE &&
 		dev2->terminal == DRAIN &&
-		rd1->drain > rd2->source)    ||
+		RES_NODE_NUMBER(rd1->rs_drain) > RES_NODE_NUMBER(rd2->rs_source)) ||
 		(dev1->terminal == DRAIN &&
 		dev2->terminal == SOURCE &&
-		rd1->source > rd2->drain)    ||
+		RES_NODE_NUMBER(rd1->rs_source) > RES_NODE_NUMBER(rd2->rs_drain)) ||
 		(dev1->terminal == DRAIN &&
 		dev2->terminal == DRAIN &&
-		rd1->source >  rd2->source))
+		RES_NODE_NUMBER(rd1->rs_source) > RES_NODE_NUMBER(rd2->rs_source)))
 	{
 	    return 1;
 	}
 	else if ((dev1->terminal == SOURCE &&
 		dev2->terminal == SOURCE &&
-		rd1->drain == rd2->drain)    ||
+		RES_NODE_NUMBER(rd1->rs_drain) == RES_NODE_NUMBER(rd2->rs_drain)) ||
 		(dev1->terminal == SOURCE &&
 		dev2->terminal == DRAIN &&
-		rd1->drain == rd2->source)    ||
+		RES_NODE_NUMBER(rd1->rs_drain) == RES_NODE_NUMBER(rd2->rs_source)) ||
 		(dev1->terminal == DRAIN &&
 		dev2->terminal == SOURCE &&
-		rd1->source == rd2->drain)    ||
+		RES_NODE_NUMBER(rd1->rs_source) == RES_NODE_NUMBER(rd2->rs_drain)) ||
 		(dev1->terminal == DRAIN &&
 		dev2->terminal == DRAIN &&
-		rd1->source == rd2->source))
+		RES_NODE_NUMBER(rd1->rs_source) == RES_NODE_NUMBER(rd2->rs_source)))
 	{
 	    return 0;
 	}
@@ -2315,7 +3204,7 @@ ResNewBreak(resNode *node,
     resInfo *rX;
 
     rX = (resInfo *)((tile)->ti_client);
-    bp = (Breakpoint *)mallocMagic((unsigned)(sizeof(Breakpoint)));
+    bp = (Breakpoint *)ResArenaAlloc((unsigned)(sizeof(Breakpoint)));
     bp->br_next= rX->breakList;
     bp->br_this = node;
     bp->br_loc.p_x = px;
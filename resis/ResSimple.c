@@ -284,7 +284,7 @@ ResSimplifyNet(nodelist, biglist, reslist, tolerance)
 	else
 	    resistor1->rr_connection2 = node2;
 
-        resisptr = (resElement *)mallocMagic((unsigned)(sizeof(resElement)));
+        resisptr = (resElement *)ResArenaAlloc((unsigned)(sizeof(resElement)));
         resisptr->re_thisEl = resistor1;
         resisptr->re_nextEl = node2->rn_re;
         node2->rn_re = resisptr;
@@ -754,7 +754,7 @@ ResCalculateChildCapacitance(me)
     if (me->rn_client != (ClientData) NULL) /* we have a loop */
 	return(-1);
 
-    myC = (RCDelayStuff *) mallocMagic((unsigned) (sizeof(RCDelayStuff)));
+    myC = (RCDelayStuff *) ResArenaAlloc((unsigned) (sizeof(RCDelayStuff)));
     me->rn_client = (ClientData) myC;
 
     /* This following assumes that ResDistributeCapacitance has been run */
@@ -1001,6 +1001,14 @@ ResDoSimplify(resisdata)
 
     if (ResOptionsFlags & ResOpt_Simplify)
     {
+	/* Sparse-matrix node elimination, if selected, replaces the	*/
+	/* tree-based simplification below.				*/
+	if (ResOptionsFlags & ResOpt_Reduce)
+	{
+	    ResReduceNet(resisdata);
+	    return 0;
+	}
+
         /*
          * Start simplification at driver (R=0). Remove it from the done list
          * and add it to the pending list. Call ResSimplifyNet as long as
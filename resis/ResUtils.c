@@ -63,7 +63,7 @@ ResFirst(tile, dinfo, arg)
 
     if (DBIsContact(t))
     {
-	reg = (ResContactPoint *) mallocMagic((unsigned) (sizeof(ResContactPoint)));
+	reg = (ResContactPoint *) ResArenaAlloc((unsigned) (sizeof(ResContactPoint)));
 	reg->cp_center.p_x = (LEFT(tile) + RIGHT(tile)) >> 1;
 	reg->cp_center.p_y = (TOP(tile) + BOTTOM(tile)) >> 1;
 	reg->cp_status = FALSE;
@@ -805,34 +805,6 @@ ResAddDevPlumbing(
 	ResUnmarkTerminal(sourceTile, devptr, srcidx);
 }
 
-/*
- *-------------------------------------------------------------------------
- *
- * ResRemovePlumbing-- Removes and deallocates all the resInfo fields.
- *
- * Results: returns 0
- *
- * Side Effects: frees up memory; resets tile->ti_client fields to CLIENTDEFAULT
- *
- *-------------------------------------------------------------------------
- */
-
-int
-ResRemovePlumbing(tile, dinfo, arg)
-    Tile	*tile;
-    TileType	dinfo;		// Unused, but should be handled.
-    ClientData	*arg;
-
-{
-    ClientData ticlient = TiGetClient(tile);
-    if (ticlient != CLIENTDEFAULT)
-    {
-	freeMagic((char *)CD2PTR(ticlient));
-	TiSetClient(tile, CLIENTDEFAULT);
-    }
-    return(0);
-}
-
 /*
  *-------------------------------------------------------------------------
  *
@@ -1129,7 +1101,7 @@ resAddField(tile)
     resInfo *Info = (resInfo *)CD2PTR(ticlient);
     if (ticlient == CLIENTDEFAULT)
     {
-     	Info = (resInfo *) mallocMagic((unsigned) (sizeof(resInfo)));
+     	Info = (resInfo *) ResArenaAlloc((unsigned) (sizeof(resInfo)));
 	ResInfoInit(Info);
 	TiSetClientPTR(tile, Info);
     }
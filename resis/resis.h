@@ -289,6 +289,8 @@ typedef struct resoptions
     float	    mindelay;	/* Minimum network delay to output */
     float	    rthresh;	/* Minimum individual resistance */
     float	    frequency;	/* For FastHenry geometry extraction */
+    float	    maxtau;	/* Largest time constant of a node removed */
+				/* by "extresist reduce"		   */
     struct saveList *savePlanes;
     CellDef	    *mainDef;
 
@@ -329,6 +331,9 @@ typedef struct rdev
      struct resextnode	*source;
      struct resextnode	*drain;
      struct resextnode	*subs;		/* Used with subcircuit type only */
+     struct resextnode	*rs_gate;	/* Terminals as read from the	  */
+     struct resextnode	*rs_source;	/* .ext file, before any are	  */
+     struct resextnode	*rs_drain;	/* renamed by ResFixDevName().	  */
      Point		location;	/* Location of lower left point	  */
      					/* of the device.		  */
      TileType		rs_ttype;	/* tile type for device		  */
@@ -344,6 +349,7 @@ typedef struct resextnode
     struct resextnode	*nextnode;	/* next node in OriginalNodes 	  */
      					/* linked list.			  */
     int			status;
+    int			number;		/* Order in which nodes were made */
     struct resextnode	*forward;     	/* If node has been merged, this  */
      					/* points to the merged node.     */
     float		capacitance;	/* Capacitance between node and   */
@@ -498,6 +504,13 @@ typedef struct capval
 
 #define RES_INFINITY		0x3FFFFFFF
 
+/* Time constants are produced by multiplying attofarads by milliohms,  */
+/* giving zeptoseconds (yes, really.  Look it up).  This constant 	*/
+/* converts zeptoseconds to picoseconds.				*/
+
+#define Z_TO_P		1e-9
+#define P_TO_Z		1e9
+
 /* The following turns on and off various options */
 
 #define		ResOpt_ExtractAll	0x0001
@@ -513,6 +526,8 @@ typedef struct capval
 #define		ResOpt_Blackbox		0x0400
 #define 	ResOpt_DoSubstrate	0x0800
 #define		ResOpt_Box		0x1000
+#define		ResOpt_Timing		0x2000
+#define		ResOpt_Reduce		0x4000
 
 /* Assorted Variables */
 
@@ -561,7 +576,6 @@ extern int 			dbSrConnectStartFunc();
 extern int			ResEach();
 extern int			ResAddPlumbing();
 extern void			ResAddDevPlumbing();
-extern int			ResRemovePlumbing();
 extern float			ResCalculateChildCapacitance();
 extern ResDevTile		*DBTreeCopyConnectDCS();
 extern Tile			*ResFindTile();
@@ -593,6 +607,9 @@ extern void ResAddToQueue();
 extern bool ResCalcTileResistance();
 extern void ResCleanNode();
 extern void ResCleanUpEverything();
+extern char *ResArenaAlloc();
+extern size_t ResArenaUsed();
+extern void ResArenaRelease();
 extern void ResDeleteResPointer();
 extern void ResDoContacts();
 extern int  ResDoSimplify();
@@ -610,6 +627,8 @@ extern void ResPrintExtDev();
 extern void ResPrintReference();
 extern void ResPrintResistorList();
 extern void ResPrintStats();
+extern void ResReduceNet();
+extern void ResFreeCellUse();
 extern void ResProcessJunction();
 extern ResExtNode *ResReadNode(int argc, char *argv[]);
 extern int  ResReadExt();
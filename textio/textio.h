@@ -68,6 +68,7 @@ extern void TxFlushOut(void);
 extern void TxFlushErr(void);
 extern void TxUseMore(void);
 extern void TxStopMore(void);
+extern void TxDivert(FILE *, FILE *);
 
 /* printing procedures with variable arguments lists */
 extern void TxError(const char *, ...) ATTR_FORMAT_PRINTF_1;
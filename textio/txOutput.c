@@ -53,6 +53,12 @@ FILE * TxMoreFile = NULL;
 static int txMorePid;
 static bool txPrintFlag = TRUE;
 
+/* Files to which TxPrintf() and TxError() output is diverted, if
+ * not NULL (see TxDivert()).
+ */
+static FILE *txDivertOut = NULL;
+static FILE *txDivertErr = NULL;
+
 
 /*
  * ----------------------------------------------------------------------------
@@ -115,6 +121,13 @@ TxPrintf(const char *fmt, ...)
 
     if (txPrintFlag)
     {
+	if (txDivertOut != NULL)
+	{
+	    va_start(args, fmt);
+	    vfprintf(txDivertOut, fmt, args);
+	    va_end(args);
+	    return;
+	}
 	if (TxMoreFile != NULL)
 	{
 	    f = TxMoreFile;
@@ -237,6 +250,35 @@ TxPrintOff(void)
     return oldValue;
 }
 
+
+/*
+ * ----------------------------------------------------------------------------
+ * TxDivert --
+ *
+ *	Send all further TxPrintf() output to the file 'out' and all
+ *	TxError() output to 'err', bypassing the terminal or Tcl console.
+ *	Used by a forked process that must not touch the interpreter or
+ *	the display it shares with its parent.  Passing NULL for either
+ *	file restores normal output.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Changes where text is printed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+TxDivert(
+    FILE *out,
+    FILE *err)
+{
+    txDivertOut = out;
+    txDivertErr = err;
+}
+
 #ifndef MAGIC_WRAPPER
 
 
@@ -312,6 +354,11 @@ TxErrorV(const char *fmt, va_list args)
 {
     FILE *f;
 
+    if (txDivertErr != NULL)
+    {
+	vfprintf(txDivertErr, fmt, args);
+	return;
+    }
     TxFlushOut();
     if (TxMoreFile != NULL)
 	f = TxMoreFile;
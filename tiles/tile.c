@@ -29,6 +29,9 @@ static const char rcsid[] __attribute__ ((unused)) = "$Header: /usr/cvsroot/magi
 #include <stdlib.h>
 #ifdef HAVE_SYS_MMAN_H
 #include <sys/mman.h>
+#ifdef HAVE_WORKERS
+#include <pthread.h>
+#endif
 #endif
 
 #include "utils/magic.h"
@@ -68,13 +71,25 @@ global const Rect TiPlaneRect = { {MINFINITY+2, MINFINITY+2}, {INFINITY-2, INFIN
 
 #ifdef HAVE_SYS_MMAN_H
 
-Tile *TileStoreFreeList = NULL;
+/* Each thread allocates tiles from a store of its own, so that the
+ * tile routines may be used by worker threads (see TiStoreRelease()).
+ */
+
+THREAD_LOCAL Tile *TileStoreFreeList = NULL;
 
 /* The new Tile Allocation scheme (Magic 8.0) */
 
-static void *_block_begin = NULL;
-static void *_current_ptr = NULL;
-static void *_block_end = NULL;
+static THREAD_LOCAL void *_block_begin = NULL;
+static THREAD_LOCAL void *_current_ptr = NULL;
+static THREAD_LOCAL void *_block_end = NULL;
+
+#ifdef HAVE_WORKERS
+/* Free tiles handed back by threads through TiStoreRelease(), waiting
+ * to be claimed by the next thread that runs out of tiles.
+ */
+static Tile *tileStoreSpare = NULL;
+static pthread_mutex_t tileStoreLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 #endif /* HAVE_SYS_MMAN_H */
 
@@ -715,6 +730,21 @@ getTileFromTileStore(void)
          * the comparison is greater-than (instead of greater-than-or-equal-to)
          * so the last block/byte can be allocated
          */
+#ifdef HAVE_WORKERS
+	/* Before mapping more memory, claim any tiles that other
+	 * threads have released.
+	 */
+	pthread_mutex_lock(&tileStoreLock);
+	TileStoreFreeList = tileStoreSpare;
+	tileStoreSpare = NULL;
+	pthread_mutex_unlock(&tileStoreLock);
+	if (TileStoreFreeList)
+	{
+	    _return_tile = TileStoreFreeList;
+	    TileStoreFreeList = (Tile *)CD2PTR(TileStoreFreeList->ti_client);
+	    return _return_tile;
+	}
+#endif
 	 mmapTileStore();
 
 	/* _current_ptr will be updated, so recompute nextp */
@@ -731,6 +761,50 @@ getTileFromTileStore(void)
     return (Tile *)thisp;
 }
 
+/*
+ * --------------------------------------------------------------------
+ *
+ * TiStoreRelease --
+ *
+ *	Hand the free tiles of the calling thread, including what is
+ *	left of its current block, to the store shared by all threads.
+ *	Worker threads call this when they finish a job, so that the
+ *	tiles they freed are not lost when the thread exits.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Empties the free list of the calling thread.
+ *
+ * --------------------------------------------------------------------
+ */
+
+void
+TiStoreRelease(void)
+{
+#ifdef HAVE_WORKERS
+    Tile *tail;
+
+    while ((char *)_current_ptr + sizeof(Tile) <= (char *)_block_end)
+    {
+	TiFree((Tile *)_current_ptr);
+	_current_ptr = (char *)_current_ptr + sizeof(Tile);
+    }
+    if (TileStoreFreeList == NULL) return;
+
+    for (tail = TileStoreFreeList; TiGetClientPTR(tail) != NULL;
+		tail = (Tile *)TiGetClientPTR(tail))
+	/* find end of list */ ;
+
+    pthread_mutex_lock(&tileStoreLock);
+    TiSetClientPTR(tail, tileStoreSpare);
+    tileStoreSpare = TileStoreFreeList;
+    pthread_mutex_unlock(&tileStoreLock);
+    TileStoreFreeList = NULL;
+#endif
+}
+
 Tile *
 TiAlloc(void)
 {
@@ -763,6 +837,12 @@ TiAlloc(void)
     TiSetBody(newtile, 0);
     return newtile;
 }
+
+void
+TiStoreRelease(void)
+{
+    /* Tiles come from mallocMagic(), which needs no release */
+}
 #endif /* !HAVE_SYS_MMAN_H */
 
 #ifdef __GNUC_STDC_INLINE__
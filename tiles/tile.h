@@ -142,8 +142,17 @@ typedef struct
 				 */
 } Plane;
 
+/* Threads searching the same plane at the same time (see CIFGen) each
+ * move its hint.  Any tile of the plane is a valid hint, so access it
+ * atomically, but without ordering.
+ */
+#if defined(HAVE_THREAD_LOCAL) && (defined(__GNUC__) || defined(__clang__))
+#define PlaneGetHint(pl)        __atomic_load_n(&(pl)->pl_hint, __ATOMIC_RELAXED)
+#define PlaneSetHint(pl, ti)    __atomic_store_n(&(pl)->pl_hint, (ti), __ATOMIC_RELAXED)
+#else
 #define PlaneGetHint(pl)        ((pl)->pl_hint)
 #define PlaneSetHint(pl, ti)    ((pl)->pl_hint = (ti))
+#endif
 
 /*
  * The following coordinate, INFINITY, is used to represent a
@@ -264,13 +273,14 @@ extern Tile *TiSrPoint(Tile *hint, Plane *plane, const Point *point);
 #define	TiSetClientPTR(tp,cd)	((tp)->ti_client = PTR2CD((cd)))
 
 extern Tile *TiAlloc(void);
+extern void TiStoreRelease(void);
 
 #ifdef __GNUC_STDC_INLINE__
 
 /* Provide compiler visibility of STDC 'inline' semantics */
 
 #ifdef HAVE_SYS_MMAN_H
-extern Tile *TileStoreFreeList;
+extern THREAD_LOCAL Tile *TileStoreFreeList;
 
 inline void
 TiFree(Tile *tile)
@@ -209,6 +209,24 @@ extern char AbortMessage[];
  #define ANALYSER_RETURNS_NONNULL /* */
 #endif
 
+/* THREAD_LOCAL marks a global that each worker thread (utils/workers.h)
+ * keeps its own copy of.  HAVE_THREAD_LOCAL is defined only if the
+ * compiler supports it, in which case code that depends on per-thread
+ * state may run inside worker threads.  The "initial-exec" model keeps
+ * access as cheap as for an ordinary global, even in tclmagic.so;  the
+ * few bytes involved fit in the space the loader reserves for this.
+ */
+
+#if defined(HAVE_WORKERS) && (defined(__GNUC__) || defined(__clang__))
+ #define THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+ #define HAVE_THREAD_LOCAL 1
+#elif defined(HAVE_WORKERS) && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+ #define THREAD_LOCAL _Thread_local
+ #define HAVE_THREAD_LOCAL 1
+#else
+ #define THREAD_LOCAL /* */
+#endif
+
 /* ---------------- Start of Machine Configuration Section ----------------- */
 
     /* ------- Configuration:  Handle Missing Routines/Definitions ------- */
@@ -69,8 +69,10 @@ extern char *TxGetLine();
  */
 
 #ifndef SUPPORT_REMOVE_MALLOC_LEGACY
-/* Delay free'ing by one call, to accommodate Magic's needs. */
-static char *freeDelayedItem = NULL;
+/* Delay free'ing by one call, to accommodate Magic's needs.  Each
+ * thread delays its own item.
+ */
+static THREAD_LOCAL char *freeDelayedItem = NULL;
 
 /* Local definitions */
 
@@ -153,6 +155,26 @@ freeMagicLegacy(cp)
     freeDelayedItem=cp;
 }
 
+/*
+ *---------------------------------------------------------------------
+ * freeMagicFlush() --
+ *
+ *	Free the item whose release is being delayed, if any.  Worker
+ *	threads call this when they finish a job, since the delayed item
+ *	of a thread would otherwise be lost when the thread exits.
+ *---------------------------------------------------------------------
+ */
+
+void
+freeMagicFlush()
+{
+    if (freeDelayedItem)
+    {
+	FreeRoutine(freeDelayedItem);
+	freeDelayedItem = NULL;
+    }
+}
+
 /*
  *---------------------------------------------------------------------
  * callocMagicLegacy() --
@@ -36,6 +36,7 @@
 #define mallocMagic malloc
 #define callocMagic calloc
 #define freeMagic free
+#define freeMagicFlush() /* */
 
 #else /* SUPPORT_DIRECT_MALLOC */
 
@@ -51,6 +52,8 @@ extern void *callocMagicLegacy(size_t);
 extern void freeMagicLegacy(void *);
 #define freeMagic(ptr) freeMagicLegacy(ptr)
 
+extern void freeMagicFlush(void);
+
 #endif /* SUPPORT_DIRECT_MALLOC */
 
 
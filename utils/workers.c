@@ -0,0 +1,181 @@
+/*
+ * workers.c -
+ *
+ * A minimal pool of worker threads.  WorkerRun() hands out a fixed
+ * number of independent jobs to a set of threads and waits for all
+ * of them to finish.  If magic was built without thread support
+ * (see "--disable-workers" in configure), the jobs are simply run
+ * in order on the calling thread.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef HAVE_WORKERS
+#include <pthread.h>
+#endif
+
+#include "utils/magic.h"
+#include "utils/workers.h"
+
+/* Upper limit on the number of threads started by WorkerRun() */
+#define WORKER_MAX	64
+
+#ifdef HAVE_WORKERS
+
+/* State shared by the threads of one call to WorkerRun() */
+typedef struct
+{
+    pthread_mutex_t	 wp_lock;	/* Protects wp_next */
+    int			 wp_next;	/* Next job to hand out */
+    int			 wp_njobs;	/* Total number of jobs */
+    WorkerProc		 wp_proc;	/* Job procedure */
+    ClientData		 wp_cdata;	/* Passed to wp_proc */
+} WorkerPool;
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * workerLoop --
+ *
+ * Body of each worker thread:  take the next unclaimed job number
+ * from the pool and run it until there are none left.
+ *
+ * Results:
+ *	Always returns NULL.
+ *
+ * Side effects:
+ *	Whatever the job procedure does.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+static void *
+workerLoop(arg)
+    void *arg;
+{
+    WorkerPool *pool = (WorkerPool *)arg;
+    int job;
+
+    while (TRUE)
+    {
+	pthread_mutex_lock(&pool->wp_lock);
+	job = pool->wp_next++;
+	pthread_mutex_unlock(&pool->wp_lock);
+	if (job >= pool->wp_njobs) break;
+	(*pool->wp_proc)(job, pool->wp_cdata);
+    }
+    return NULL;
+}
+
+#endif	/* HAVE_WORKERS */
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * WorkerCount --
+ *
+ * Translate a requested number of threads into the number that
+ * WorkerRun() will actually use.  A request of zero or less means
+ * "one per online processor".
+ *
+ * Results:
+ *	Number of threads, always at least 1.  Always 1 if magic was
+ *	compiled without thread support.
+ *
+ * Side effects:
+ *	None.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+int
+WorkerCount(requested)
+    int requested;
+{
+#ifdef HAVE_WORKERS
+    if (requested <= 0)
+    {
+#ifdef _SC_NPROCESSORS_ONLN
+	requested = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (requested <= 0) requested = 1;
+    }
+    return (requested > WORKER_MAX) ? WORKER_MAX : requested;
+#else
+    return 1;
+#endif
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ *
+ * WorkerRun --
+ *
+ * Run jobs 0 .. njobs-1 by calling (*proc)(job, cdata) for each,
+ * spread over at most 'nthreads' threads (see WorkerCount()).  The
+ * order in which jobs run and complete is unspecified, so each job
+ * should leave its result in a slot of its own for the caller to
+ * collect once WorkerRun() returns.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the job procedure does.  Does not return until all
+ *	jobs have completed.
+ *
+ * ----------------------------------------------------------------------------
+ */
+
+void
+WorkerRun(nthreads, njobs, proc, cdata)
+    int nthreads;		/* Maximum number of threads to use */
+    int njobs;			/* Number of jobs */
+    WorkerProc proc;		/* Called once for each job */
+    ClientData cdata;		/* Passed to proc */
+{
+    int job;
+#ifdef HAVE_WORKERS
+    WorkerPool pool;
+    pthread_t threads[WORKER_MAX];
+    int n, started;
+
+    nthreads = WorkerCount(nthreads);
+    if (nthreads > njobs) nthreads = njobs;
+    if (nthreads > 1)
+    {
+	pthread_mutex_init(&pool.wp_lock, NULL);
+	pool.wp_next = 0;
+	pool.wp_njobs = njobs;
+	pool.wp_proc = proc;
+	pool.wp_cdata = cdata;
+
+	/* The calling thread does its share of the work too */
+	for (started = 0; started < nthreads - 1; started++)
+	    if (pthread_create(&threads[started], NULL, workerLoop,
+			(void *)&pool) != 0)
+		break;
+	workerLoop((void *)&pool);
+	for (n = 0; n < started; n++)
+	    pthread_join(threads[n], NULL);
+	pthread_mutex_destroy(&pool.wp_lock);
+	return;
+    }
+#endif
+    for (job = 0; job < njobs; job++)
+	(*proc)(job, cdata);
+}
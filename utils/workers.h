@@ -0,0 +1,43 @@
+/*
+ * workers.h --
+ *
+ * Interface to a minimal pool of worker threads, used to overlap
+ * file I/O and other self-contained jobs that do not touch the
+ * magic database.
+ *
+ *     *********************************************************************
+ *     * Copyright (C) 2026 Regents of the University of California.       *
+ *     * Permission to use, copy, modify, and distribute this              *
+ *     * software and its documentation for any purpose and without        *
+ *     * fee is hereby granted, provided that the above copyright          *
+ *     * notice appear in all copies.  The University of California        *
+ *     * makes no representations about the suitability of this            *
+ *     * software for any purpose.  It is provided "as is" without         *
+ *     * express or implied warranty.  Export of this software outside     *
+ *     * of the United States of America may require an export license.    *
+ *     *********************************************************************
+ */
+
+#ifndef	_MAGIC__UTILS__WORKERS_H
+#define	_MAGIC__UTILS__WORKERS_H
+
+#include "utils/magic.h"
+
+/*
+ * A job procedure has the form
+ *
+ *	void (*proc)(int job, ClientData cdata)
+ *
+ * and is called once for each job number 0 .. njobs-1.  Job procedures
+ * run concurrently and so must not call the hash routines, or anything
+ * that prints through TxPrintf().  Where HAVE_THREAD_LOCAL is defined,
+ * mallocMagic()/freeMagic() and the tile routines keep per-thread state
+ * and may be used, provided that each job ends by calling freeMagicFlush()
+ * and TiStoreRelease().
+ */
+typedef void (*WorkerProc)(int, ClientData);
+
+extern int  WorkerCount(int);
+extern void WorkerRun(int, int, WorkerProc, ClientData);
+
+#endif	/* _MAGIC__UTILS__WORKERS_H */